@@ -0,0 +1,276 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/container/compact_trie_map.h"
+#include "common/unit_test_util/unit_test_util.h"
+
+bool InsertTest() {
+    e8::CompactTrieMap<std::string, int> map;
+    TEST_CONDITION(map.size() == 0);
+    TEST_CONDITION(map.empty());
+
+    std::pair<e8::CompactTrieMap<std::string, int>::iterator, bool> insert_it =
+        map.insert(std::make_pair("A", 1));
+    TEST_CONDITION(map.size() == 1);
+    TEST_CONDITION(insert_it.second == true);
+
+    insert_it = map.insert(std::make_pair("ABC", 2));
+    TEST_CONDITION(map.size() == 2);
+    TEST_CONDITION(insert_it.second == true);
+
+    insert_it = map.insert(std::make_pair("AB", 3));
+    TEST_CONDITION(map.size() == 3);
+    TEST_CONDITION(insert_it.second == true);
+
+    insert_it = map.insert(std::make_pair("AC", 4));
+    TEST_CONDITION(map.size() == 4);
+    TEST_CONDITION(insert_it.second == true);
+
+    insert_it = map.insert(std::make_pair("", 5));
+    TEST_CONDITION(map.size() == 5);
+    TEST_CONDITION(insert_it.second == true);
+
+    insert_it = map.insert(std::make_pair("AB", 1000));
+    TEST_CONDITION(map.size() == 5);
+    TEST_CONDITION(insert_it.second == false);
+
+    return true;
+}
+
+bool InsertThenFindTest() {
+    e8::CompactTrieMap<std::string, int> map;
+    TEST_CONDITION(map.size() == 0);
+    TEST_CONDITION(map.empty());
+
+    std::pair<e8::CompactTrieMap<std::string, int>::iterator, bool> insert_it =
+        map.insert(std::make_pair("A", 1));
+    e8::CompactTrieMap<std::string, int>::iterator find_it = map.find("A");
+    TEST_CONDITION(find_it == insert_it.first);
+    TEST_CONDITION((*find_it).first == "A");
+    TEST_CONDITION((*find_it).second == 1);
+
+    insert_it = map.insert(std::make_pair("ABC", 2));
+    find_it = map.find("ABC");
+    TEST_CONDITION(find_it == insert_it.first);
+    TEST_CONDITION((*find_it).first == "ABC");
+    TEST_CONDITION((*find_it).second == 2);
+
+    insert_it = map.insert(std::make_pair("AB", 3));
+    find_it = map.find("AB");
+    TEST_CONDITION(find_it == insert_it.first);
+    TEST_CONDITION((*find_it).first == "AB");
+    TEST_CONDITION((*find_it).second == 3);
+
+    insert_it = map.insert(std::make_pair("AC", 4));
+    find_it = map.find("AC");
+    TEST_CONDITION(find_it == insert_it.first);
+    TEST_CONDITION((*find_it).first == "AC");
+    TEST_CONDITION((*find_it).second == 4);
+
+    insert_it = map.insert(std::make_pair("", 5));
+    find_it = map.find("");
+    TEST_CONDITION(find_it == insert_it.first);
+    TEST_CONDITION((*find_it).first == "");
+    TEST_CONDITION((*find_it).second == 5);
+
+    insert_it = map.insert(std::make_pair("AB", 1000));
+    find_it = map.find("AB");
+    TEST_CONDITION(find_it == insert_it.first);
+    TEST_CONDITION((*find_it).first == "AB");
+    TEST_CONDITION((*find_it).second == 1000);
+
+    return true;
+}
+
+bool InsertThenEraseThenFindTest() {
+    e8::CompactTrieMap<std::string, int> map;
+
+    auto insert_it = map.insert(std::make_pair("A", 1));
+    map.erase(insert_it.first);
+    TEST_CONDITION(map.size() == 0);
+    TEST_CONDITION(map.find("A") == map.end());
+
+    map.insert(std::make_pair("ABCD", 2));
+    map.insert(std::make_pair("AB", 3));
+    TEST_CONDITION(map.size() == 2);
+
+    auto abcd_it = map.find("ABCD");
+    map.erase(abcd_it);
+    TEST_CONDITION(map.size() == 1);
+    TEST_CONDITION(map.find("ABCD") == map.end());
+
+    auto ab_it = map.find("AB");
+    TEST_CONDITION(ab_it != map.end());
+    TEST_CONDITION((*ab_it).first == "AB");
+    TEST_CONDITION((*ab_it).second == 3);
+    map.erase(ab_it);
+    TEST_CONDITION(map.size() == 0);
+    TEST_CONDITION(map.find("AB") == map.end());
+
+    return true;
+}
+
+bool EraseKeepsLongerKeysTest() {
+    e8::CompactTrieMap<std::string, int> map;
+    map.insert(std::make_pair("AB", 1));
+    map.insert(std::make_pair("ABCD", 2));
+
+    auto ab_it = map.find("AB");
+    map.erase(ab_it);
+    TEST_CONDITION(map.size() == 1);
+    TEST_CONDITION(map.find("AB") == map.end());
+
+    auto abcd_it = map.find("ABCD");
+    TEST_CONDITION(abcd_it != map.end());
+    TEST_CONDITION((*abcd_it).second == 2);
+
+    return true;
+}
+
+bool IterateTest() {
+    e8::CompactTrieMap<std::string, int> map;
+    map.insert(std::make_pair("A", 1));
+    map.insert(std::make_pair("ABC", 2));
+    map.insert(std::make_pair("AC", 3));
+    map.insert(std::make_pair("B", 4));
+
+    std::set<std::string> keys;
+    for (auto it = map.begin(); it != map.end(); ++it) {
+        keys.insert((*it).first);
+    }
+    TEST_CONDITION((keys == std::set<std::string>{"A", "ABC", "AC", "B"}));
+
+    map.clear();
+    TEST_CONDITION(map.empty());
+    TEST_CONDITION(map.begin() == map.end());
+
+    return true;
+}
+
+bool VisitPrefixTest() {
+    e8::CompactTrieMap<std::string, int> map;
+    map.insert(std::make_pair("A", 1));
+    map.insert(std::make_pair("ABC", 2));
+    map.insert(std::make_pair("AB", 3));
+    map.insert(std::make_pair("AC", 4));
+    map.insert(std::make_pair("B", 5));
+
+    std::set<std::pair<std::string, int>> visited;
+    auto collect = [&visited](std::string const &key, int value) {
+        visited.insert(std::make_pair(key, value));
+        return true;
+    };
+
+    map.visit_prefix("AB", collect);
+    TEST_CONDITION((visited == std::set<std::pair<std::string, int>>{{"AB", 3}, {"ABC", 2}}));
+
+    visited.clear();
+    map.visit_prefix("", collect);
+    TEST_CONDITION(visited.size() == 5);
+
+    visited.clear();
+    map.visit_prefix("ABCD", collect);
+    TEST_CONDITION(visited.empty());
+
+    unsigned num_visited = 0;
+    map.visit_prefix("A", [&num_visited](std::string const & /*key*/, int /*value*/) {
+        ++num_visited;
+        return num_visited < 2;
+    });
+    TEST_CONDITION(num_visited == 2);
+
+    return true;
+}
+
+bool SplitLabelsTest() {
+    e8::CompactTrieMap<std::string, int> map;
+    map.insert(std::make_pair("ROMANE", 1));
+    map.insert(std::make_pair("ROMANUS", 2));
+    map.insert(std::make_pair("ROM", 3));
+    map.insert(std::make_pair("RUBENS", 4));
+    map.insert(std::make_pair("RUBER", 5));
+    TEST_CONDITION(map.size() == 5);
+
+    TEST_CONDITION(map.find("R") == map.end());
+    TEST_CONDITION(map.find("ROMA") == map.end());
+    TEST_CONDITION(map.find("ROMANES") == map.end());
+    TEST_CONDITION(map["ROMANE"] == 1);
+    TEST_CONDITION(map["ROMANUS"] == 2);
+    TEST_CONDITION(map["ROM"] == 3);
+    TEST_CONDITION(map["RUBENS"] == 4);
+    TEST_CONDITION(map["RUBER"] == 5);
+
+    // Chains of single-child nodes are collapsed.
+    TEST_CONDITION(map.num_nodes() < 10);
+
+    auto rom_it = map.find("ROM");
+    map.erase(rom_it);
+    TEST_CONDITION(map.find("ROM") == map.end());
+    TEST_CONDITION(map["ROMANE"] == 1);
+    TEST_CONDITION(map["ROMANUS"] == 2);
+
+    auto romane_it = map.find("ROMANE");
+    map.erase(romane_it);
+    auto romanus_it = map.find("ROMANUS");
+    map.erase(romanus_it);
+    TEST_CONDITION(map.size() == 2);
+    TEST_CONDITION(map["RUBER"] == 5);
+
+    return true;
+}
+
+bool OrderedIterationTest() {
+    e8::CompactTrieMap<std::string, int> map;
+    std::vector<std::string> keys{"B", "ABC", "", "AC", "A", "ABD"};
+    for (unsigned i = 0; i < keys.size(); ++i) {
+        map.insert(std::make_pair(keys[i], i));
+    }
+
+    std::vector<std::string> iterated_keys;
+    for (auto it = map.begin(); it != map.end(); ++it) {
+        iterated_keys.push_back((*it).first);
+        TEST_CONDITION((*it).second == map[(*it).first]);
+    }
+    TEST_CONDITION(
+        (iterated_keys == std::vector<std::string>{"", "A", "ABC", "ABD", "AC", "B"}));
+
+    e8::CompactTrieMap<std::string, int> copy = map;
+    TEST_CONDITION(copy == map);
+    copy.insert(std::make_pair("A", 1000));
+    TEST_CONDITION(copy != map);
+
+    return true;
+}
+
+int main() {
+    e8::BeginTestSuite("compact_trie_map");
+    e8::RunTest("InsertTest", InsertTest);
+    e8::RunTest("InsertThenFindTest", InsertThenFindTest);
+    e8::RunTest("InsertThenEraseThenFindTest", InsertThenEraseThenFindTest);
+    e8::RunTest("EraseKeepsLongerKeysTest", EraseKeepsLongerKeysTest);
+    e8::RunTest("IterateTest", IterateTest);
+    e8::RunTest("VisitPrefixTest", VisitPrefixTest);
+    e8::RunTest("SplitLabelsTest", SplitLabelsTest);
+    e8::RunTest("OrderedIterationTest", OrderedIterationTest);
+    e8::EndTestSuite();
+    return 0;
+}
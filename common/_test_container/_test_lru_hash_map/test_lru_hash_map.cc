@@ -15,6 +15,7 @@
  * not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <map>
 #include <optional>
 #include <string>
 
@@ -95,9 +96,102 @@ bool FetchAndClearTest() {
     return true;
 }
 
+bool EvictThenTouchTailTest() {
+    e8::LruHashMap<std::string, int, OnFetch, OnEvict> cache(/*max_size=*/2, OnFetch(), OnEvict());
+
+    // A, B, C evicts A and leaves B as the least recently used item. Touching B must relink it
+    // without following the evicted item.
+    cache.Fetch("A");
+    cache.Fetch("B");
+    cache.Fetch("C");
+    cache.Fetch("B");
+    cache.Fetch("D");
+
+    TEST_CONDITION(cache.EvictOperator().evict_freq.at('A') == 1);
+    TEST_CONDITION(cache.EvictOperator().evict_freq.at('C') == 1);
+    TEST_CONDITION(cache.EvictOperator().evict_freq.find('B') ==
+                   cache.EvictOperator().evict_freq.end());
+
+    std::optional<int> item_id = cache.Fetch("B");
+    TEST_CONDITION(item_id.has_value());
+    TEST_CONDITION(cache.FetchOperator().fetch_freq.at("B") == 1);
+
+    return true;
+}
+
+bool ClockSecondChanceTest() {
+    e8::LruHashMap<std::string, int, OnFetch, OnEvict, e8::ClockEvictionPolicy<std::string>> cache(
+        /*max_size=*/3, OnFetch(), OnEvict());
+
+    // A, B, C fill the clock. The hit on A sets its reference bit, so D evicts B instead of A.
+    cache.Fetch("A");
+    cache.Fetch("B");
+    cache.Fetch("C");
+    cache.Fetch("A");
+    cache.Fetch("D");
+
+    TEST_CONDITION(cache.EvictOperator().evict_freq.at('B') == 1);
+    TEST_CONDITION(cache.EvictOperator().evict_freq.find('A') ==
+                   cache.EvictOperator().evict_freq.end());
+
+    // The sweep cleared A's bit. Then E evicts C, which follows B's slot.
+    cache.Fetch("E");
+    TEST_CONDITION(cache.EvictOperator().evict_freq.at('C') == 1);
+
+    std::optional<int> item_id = cache.Fetch("A");
+    TEST_CONDITION(item_id.has_value());
+    TEST_CONDITION(item_id.value() == 'A');
+    TEST_CONDITION(cache.FetchOperator().fetch_freq.at("A") == 1);
+
+    cache.Clear();
+    TEST_CONDITION(cache.EvictOperator().evict_freq.at('A') == 1);
+    TEST_CONDITION(cache.EvictOperator().evict_freq.at('D') == 1);
+    TEST_CONDITION(cache.EvictOperator().evict_freq.at('E') == 1);
+
+    return true;
+}
+
+bool WTinyLfuScanResistanceTest() {
+    e8::LruHashMap<std::string, int, OnFetch, OnEvict, e8::WTinyLfuEvictionPolicy<std::string>>
+        cache(/*max_size=*/4, OnFetch(), OnEvict());
+
+    // A and B are used frequently.
+    for (unsigned i = 0; i < 4; ++i) {
+        cache.Fetch("A");
+        cache.Fetch("B");
+    }
+
+    // A scan of one-off keys must not flush them.
+    for (char c = 'C'; c <= 'Z'; ++c) {
+        cache.Fetch(std::string(1, c));
+    }
+
+    cache.Fetch("A");
+    cache.Fetch("B");
+    TEST_CONDITION(cache.FetchOperator().fetch_freq.at("A") == 1);
+    TEST_CONDITION(cache.FetchOperator().fetch_freq.at("B") == 1);
+
+    // The same workload flushes them out of an LRU cache.
+    e8::LruHashMap<std::string, int, OnFetch, OnEvict> lru(/*max_size=*/4, OnFetch(), OnEvict());
+    for (unsigned i = 0; i < 4; ++i) {
+        lru.Fetch("A");
+        lru.Fetch("B");
+    }
+    for (char c = 'C'; c <= 'Z'; ++c) {
+        lru.Fetch(std::string(1, c));
+    }
+    lru.Fetch("A");
+    TEST_CONDITION(lru.FetchOperator().fetch_freq.at("A") == 2);
+
+    return true;
+}
+
 int main() {
     e8::BeginTestSuite("lru_hash_map");
     e8::RunTest("FetchAndClearTest", FetchAndClearTest);
+    e8::RunTest("EvictThenTouchTailTest", EvictThenTouchTailTest);
+    e8::RunTest("ClockSecondChanceTest", ClockSecondChanceTest);
+    e8::RunTest("WTinyLfuScanResistanceTest", WTinyLfuScanResistanceTest);
     e8::EndTestSuite();
     return 0;
 }
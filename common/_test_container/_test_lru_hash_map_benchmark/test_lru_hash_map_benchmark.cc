@@ -0,0 +1,241 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/container/eviction_policy.h"
+#include "common/container/lru_hash_map.h"
+#include "common/container/sharded_lru_hash_map.h"
+#include "common/unit_test_util/unit_test_util.h"
+
+namespace {
+
+unsigned const kNumThreads = 8;
+unsigned const kNumKeys = 100000;
+unsigned const kNumFetchesPerThread = 50000;
+unsigned const kCacheSize = 8192;
+unsigned const kNumShards = 16;
+std::chrono::microseconds const kFetchLatency(50);
+
+/**
+ * @brief The SlowFetch struct Simulates a round trip to the database and counts the loads.
+ */
+struct SlowFetch {
+    std::optional<int64_t> operator()(int64_t key) const {
+        num_fetches->fetch_add(1);
+        std::this_thread::sleep_for(kFetchLatency);
+        return key * 2;
+    }
+
+    std::shared_ptr<std::atomic<uint64_t>> num_fetches =
+        std::make_shared<std::atomic<uint64_t>>(0);
+};
+
+struct NoEvict {
+    void operator()(int64_t) const {}
+};
+
+/**
+ * @brief The CountingFetch struct Loads instantly and counts the loads.
+ */
+struct CountingFetch {
+    std::optional<int64_t> operator()(int64_t key) {
+        ++*num_fetches;
+        return key * 2;
+    }
+
+    std::shared_ptr<uint64_t> num_fetches = std::make_shared<uint64_t>(0);
+};
+
+/**
+ * @brief GenerateTrace Draws keys from a Zipf-like distribution with exponent 1, so a small set of
+ * hot keys receives most of the fetches as in a real workload.
+ */
+std::vector<int64_t> GenerateTrace(unsigned num_fetches, unsigned seed) {
+    std::vector<double> weights(kNumKeys);
+    for (unsigned i = 0; i < kNumKeys; ++i) {
+        weights[i] = 1.0 / (i + 1);
+    }
+    std::discrete_distribution<int64_t> zipf(weights.begin(), weights.end());
+    std::mt19937 rng(seed);
+
+    std::vector<int64_t> trace(num_fetches);
+    for (auto &key : trace) {
+        key = zipf(rng);
+    }
+    return trace;
+}
+
+struct BenchmarkResult {
+    double fetches_per_second;
+    double hit_ratio;
+    bool correct;
+};
+
+template <typename Cache>
+BenchmarkResult RunWorkload(Cache *cache, SlowFetch const &fetch,
+                            std::vector<std::vector<int64_t>> const &traces) {
+    std::atomic<bool> correct(true);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < kNumThreads; ++t) {
+        threads.emplace_back([cache, &traces, &correct, t]() {
+            for (int64_t key : traces[t]) {
+                std::optional<int64_t> value = cache->Fetch(key);
+                if (!value.has_value() || *value != key * 2) {
+                    correct = false;
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double num_fetches = static_cast<double>(kNumThreads) * kNumFetchesPerThread;
+    BenchmarkResult result;
+    result.fetches_per_second = num_fetches / seconds;
+    result.hit_ratio = 1.0 - fetch.num_fetches->load() / num_fetches;
+    result.correct = correct;
+    return result;
+}
+
+void PrintResult(std::string const &name, BenchmarkResult const &result) {
+    std::cout << std::fixed << std::setprecision(3) << name
+              << ": fetches/s=" << result.fetches_per_second << " hit_ratio=" << result.hit_ratio
+              << std::endl;
+}
+
+bool ConcurrentSkewedFetchTest() {
+    std::vector<std::vector<int64_t>> traces;
+    for (unsigned t = 0; t < kNumThreads; ++t) {
+        traces.push_back(GenerateTrace(kNumFetchesPerThread, /*seed=*/t + 1));
+    }
+
+    SlowFetch lru_fetch;
+    e8::LruHashMap<int64_t, int64_t, SlowFetch, NoEvict> lru(kCacheSize, lru_fetch, NoEvict());
+    BenchmarkResult lru_result = RunWorkload(&lru, lru_fetch, traces);
+
+    SlowFetch sharded_fetch;
+    e8::ShardedLruHashMap<int64_t, int64_t, SlowFetch, NoEvict> sharded(
+        kNumShards, kCacheSize / kNumShards, sharded_fetch, NoEvict());
+    BenchmarkResult sharded_result = RunWorkload(&sharded, sharded_fetch, traces);
+
+    PrintResult("LruHashMap", lru_result);
+    PrintResult("ShardedLruHashMap", sharded_result);
+
+    e8::ShardedLruHashMap<int64_t, int64_t, SlowFetch, NoEvict>::Stats stats = sharded.GetStats();
+    std::cout << "ShardedLruHashMap: hits=" << stats.num_hits << " misses=" << stats.num_misses
+              << " evictions=" << stats.num_evictions << std::endl;
+
+    TEST_CONDITION(lru_result.correct);
+    TEST_CONDITION(sharded_result.correct);
+    TEST_CONDITION(stats.num_hits + stats.num_misses ==
+                   static_cast<uint64_t>(kNumThreads) * kNumFetchesPerThread);
+    TEST_CONDITION(sharded_result.fetches_per_second > lru_result.fetches_per_second);
+
+    return true;
+}
+
+/**
+ * @brief GenerateScanTrace Mixes the skewed trace with sequential scans over keys which are never
+ * used again, similar to a batch job running alongside the interactive traffic.
+ */
+std::vector<int64_t> GenerateScanTrace(unsigned num_fetches, unsigned seed) {
+    std::vector<int64_t> skewed = GenerateTrace(num_fetches, seed);
+    std::vector<int64_t> trace;
+    int64_t next_scanned_key = kNumKeys;
+    for (unsigned i = 0; trace.size() < num_fetches; ++i) {
+        trace.push_back(skewed[i]);
+        if (i % 20000 == 19999) {
+            for (unsigned j = 0; j < 2 * kCacheSize && trace.size() < num_fetches; ++j) {
+                trace.push_back(next_scanned_key++);
+            }
+        }
+    }
+    return trace;
+}
+
+template <typename EvictionPolicy>
+BenchmarkResult ReplayTrace(std::vector<int64_t> const &trace) {
+    CountingFetch fetch;
+    e8::LruHashMap<int64_t, int64_t, CountingFetch, NoEvict, EvictionPolicy> cache(
+        kCacheSize, fetch, NoEvict());
+
+    bool correct = true;
+    auto start = std::chrono::steady_clock::now();
+    for (int64_t key : trace) {
+        std::optional<int64_t> value = cache.Fetch(key);
+        correct = correct && value.has_value() && *value == key * 2;
+    }
+    double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    BenchmarkResult result;
+    result.fetches_per_second = trace.size() / seconds;
+    result.hit_ratio = 1.0 - static_cast<double>(*fetch.num_fetches) / trace.size();
+    result.correct = correct;
+    return result;
+}
+
+bool EvictionPolicyTraceTest() {
+    std::vector<std::pair<std::string, std::vector<int64_t>>> traces;
+    traces.push_back(std::make_pair("zipf", GenerateTrace(/*num_fetches=*/2000000, /*seed=*/1)));
+    traces.push_back(
+        std::make_pair("zipf+scan", GenerateScanTrace(/*num_fetches=*/2000000, /*seed=*/1)));
+
+    for (auto const &[name, trace] : traces) {
+        BenchmarkResult lru = ReplayTrace<e8::LruEvictionPolicy<int64_t>>(trace);
+        BenchmarkResult clock = ReplayTrace<e8::ClockEvictionPolicy<int64_t>>(trace);
+        BenchmarkResult tiny_lfu = ReplayTrace<e8::WTinyLfuEvictionPolicy<int64_t>>(trace);
+
+        PrintResult(name + " LRU", lru);
+        PrintResult(name + " CLOCK", clock);
+        PrintResult(name + " W-TinyLFU", tiny_lfu);
+
+        TEST_CONDITION(lru.correct);
+        TEST_CONDITION(clock.correct);
+        TEST_CONDITION(tiny_lfu.correct);
+        TEST_CONDITION(tiny_lfu.hit_ratio > lru.hit_ratio);
+    }
+
+    return true;
+}
+
+} // namespace
+
+int main() {
+    e8::BeginTestSuite("lru_hash_map_benchmark");
+    e8::RunTest("ConcurrentSkewedFetchTest", ConcurrentSkewedFetchTest);
+    e8::RunTest("EvictionPolicyTraceTest", EvictionPolicyTraceTest);
+    e8::EndTestSuite();
+    return 0;
+}
@@ -0,0 +1,258 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/container/sharded_lru_hash_map.h"
+#include "common/unit_test_util/unit_test_util.h"
+
+struct OnFetch {
+    std::optional<int> operator()(std::string const &key) {
+        if (key.length() != 1) {
+            return std::nullopt;
+        }
+
+        fetch_freq[key]++;
+        return key[0];
+    }
+
+    std::map<std::string, int> fetch_freq;
+};
+
+struct OnEvict {
+    void operator()(int value) { evict_freq[value]++; }
+
+    std::map<int, int> evict_freq;
+};
+
+/**
+ * @brief The GatedFetch struct Blocks the fetch of key "A" until the gate is opened. The fetch
+ * throws once the gate opens if it's set to fail.
+ */
+struct GatedFetch {
+    struct Gate {
+        bool open = false;
+        bool fail = false;
+        unsigned num_fetches = 0;
+        std::mutex mutex;
+        std::condition_variable opened;
+    };
+
+    std::optional<int> operator()(std::string const &key) const {
+        std::unique_lock<std::mutex> lock(gate->mutex);
+        ++gate->num_fetches;
+        if (key == "A") {
+            gate->opened.wait(lock, [this] { return gate->open; });
+            if (gate->fail) {
+                throw std::runtime_error("Failed to fetch.");
+            }
+        }
+        return key[0];
+    }
+
+    Gate *gate;
+};
+
+struct NoEvict {
+    void operator()(int) const {}
+};
+
+bool FetchAndClearTest() {
+    e8::ShardedLruHashMap<std::string, int, OnFetch, OnEvict> cache(
+        /*num_shards=*/1, /*max_size_per_shard=*/2, OnFetch(), OnEvict());
+
+    // A, B, A, C, B
+    // A and C will be fetched once whereas B will be fetched twice.
+    TEST_CONDITION(!cache.Fetch("").has_value());
+    TEST_CONDITION(cache.Fetch("A").value() == 'A');
+    TEST_CONDITION(cache.Fetch("A").value() == 'A');
+    TEST_CONDITION(cache.Fetch("B").value() == 'B');
+    TEST_CONDITION(cache.Fetch("A").value() == 'A');
+    TEST_CONDITION(cache.Fetch("C").value() == 'C');
+    TEST_CONDITION(cache.Fetch("B").value() == 'B');
+
+    TEST_CONDITION(cache.FetchOperator().fetch_freq.at("A") == 1);
+    TEST_CONDITION(cache.FetchOperator().fetch_freq.at("B") == 2);
+    TEST_CONDITION(cache.FetchOperator().fetch_freq.at("C") == 1);
+
+    TEST_CONDITION(cache.EvictOperator().evict_freq.at('A') == 1);
+    TEST_CONDITION(cache.EvictOperator().evict_freq.at('B') == 1);
+    TEST_CONDITION(cache.EvictOperator().evict_freq.find('C') ==
+                   cache.EvictOperator().evict_freq.end());
+
+    e8::ShardedLruHashMap<std::string, int, OnFetch, OnEvict>::Stats stats = cache.GetStats();
+    TEST_CONDITION(stats.num_hits == 2);
+    TEST_CONDITION(stats.num_misses == 5);
+    TEST_CONDITION(stats.num_evictions == 2);
+
+    cache.Clear();
+
+    TEST_CONDITION(cache.EvictOperator().evict_freq.at('A') == 1);
+    TEST_CONDITION(cache.EvictOperator().evict_freq.at('B') == 2);
+    TEST_CONDITION(cache.EvictOperator().evict_freq.at('C') == 1);
+
+    return true;
+}
+
+bool ShardsTest() {
+    e8::ShardedLruHashMap<std::string, int, OnFetch, OnEvict> cache(
+        /*num_shards=*/4, /*max_size_per_shard=*/8, OnFetch(), OnEvict());
+
+    std::string const keys = "ABCDEFGH";
+    for (unsigned round = 0; round < 2; ++round) {
+        for (char key : keys) {
+            TEST_CONDITION(cache.Fetch(std::string(1, key)).value() == key);
+        }
+    }
+
+    // Every shard has room for all the keys.
+    e8::ShardedLruHashMap<std::string, int, OnFetch, OnEvict>::Stats stats = cache.GetStats();
+    TEST_CONDITION(stats.num_hits == keys.size());
+    TEST_CONDITION(stats.num_misses == keys.size());
+    TEST_CONDITION(stats.num_evictions == 0);
+
+    return true;
+}
+
+bool SingleFlightTest() {
+    GatedFetch::Gate gate;
+    e8::ShardedLruHashMap<std::string, int, GatedFetch, NoEvict> cache(
+        /*num_shards=*/1, /*max_size_per_shard=*/4, GatedFetch{&gate}, NoEvict());
+
+    unsigned const kNumThreads = 8;
+    std::atomic<unsigned> num_correct(0);
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < kNumThreads; ++i) {
+        threads.emplace_back([&cache, &num_correct] {
+            if (cache.Fetch("A") == 'A') {
+                ++num_correct;
+            }
+        });
+    }
+
+    // Lets the threads pile up on the in-flight fetch.
+    while (cache.GetStats().num_misses < kNumThreads) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    gate.mutex.lock();
+    gate.open = true;
+    gate.mutex.unlock();
+    gate.opened.notify_all();
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    TEST_CONDITION(num_correct == kNumThreads);
+    TEST_CONDITION(gate.num_fetches == 1);
+
+    return true;
+}
+
+bool FailedFetchTest() {
+    GatedFetch::Gate gate;
+    gate.fail = true;
+    e8::ShardedLruHashMap<std::string, int, GatedFetch, NoEvict> cache(
+        /*num_shards=*/1, /*max_size_per_shard=*/4, GatedFetch{&gate}, NoEvict());
+
+    unsigned const kNumThreads = 8;
+    std::atomic<unsigned> num_failures(0);
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < kNumThreads; ++i) {
+        threads.emplace_back([&cache, &num_failures] {
+            try {
+                cache.Fetch("A");
+            } catch (std::runtime_error const &) {
+                ++num_failures;
+            }
+        });
+    }
+
+    while (cache.GetStats().num_misses < kNumThreads) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    gate.mutex.lock();
+    gate.open = true;
+    gate.mutex.unlock();
+    gate.opened.notify_all();
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    // The loader and all the threads waiting for it see the error.
+    TEST_CONDITION(num_failures == kNumThreads);
+    TEST_CONDITION(gate.num_fetches == 1);
+
+    // The failed load doesn't block the next one.
+    gate.mutex.lock();
+    gate.fail = false;
+    gate.mutex.unlock();
+    TEST_CONDITION(cache.Fetch("A") == 'A');
+    TEST_CONDITION(gate.num_fetches == 2);
+
+    return true;
+}
+
+bool MissDoesNotBlockHitsTest() {
+    GatedFetch::Gate gate;
+    e8::ShardedLruHashMap<std::string, int, GatedFetch, NoEvict> cache(
+        /*num_shards=*/1, /*max_size_per_shard=*/4, GatedFetch{&gate}, NoEvict());
+
+    TEST_CONDITION(cache.Fetch("B") == 'B');
+
+    std::thread slow_miss([&cache] { cache.Fetch("A"); });
+    while (cache.GetStats().num_misses < 2) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // The load of "A" is still in flight in the same shard.
+    TEST_CONDITION(cache.Fetch("B") == 'B');
+    TEST_CONDITION(cache.Fetch("C") == 'C');
+
+    gate.mutex.lock();
+    gate.open = true;
+    gate.mutex.unlock();
+    gate.opened.notify_all();
+    slow_miss.join();
+
+    TEST_CONDITION(cache.GetStats().num_hits == 1);
+
+    return true;
+}
+
+int main() {
+    e8::BeginTestSuite("sharded_lru_hash_map");
+    e8::RunTest("FetchAndClearTest", FetchAndClearTest);
+    e8::RunTest("ShardsTest", ShardsTest);
+    e8::RunTest("SingleFlightTest", SingleFlightTest);
+    e8::RunTest("FailedFetchTest", FailedFetchTest);
+    e8::RunTest("MissDoesNotBlockHitsTest", MissDoesNotBlockHitsTest);
+    e8::EndTestSuite();
+    return 0;
+}
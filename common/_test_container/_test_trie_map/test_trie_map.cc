@@ -15,6 +15,7 @@
  * not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <set>
 #include <string>
 #include <utility>
 
@@ -127,11 +128,86 @@ bool InsertThenEraseThenFindTest() {
     return true;
 }
 
+bool EraseKeepsLongerKeysTest() {
+    e8::TrieMap<std::string, int> map;
+    map.insert(std::make_pair("AB", 1));
+    map.insert(std::make_pair("ABCD", 2));
+
+    auto ab_it = map.find("AB");
+    map.erase(ab_it);
+    TEST_CONDITION(map.size() == 1);
+    TEST_CONDITION(map.find("AB") == map.end());
+
+    auto abcd_it = map.find("ABCD");
+    TEST_CONDITION(abcd_it != map.end());
+    TEST_CONDITION((*abcd_it).second == 2);
+
+    return true;
+}
+
+bool IterateTest() {
+    e8::TrieMap<std::string, int> map;
+    map.insert(std::make_pair("A", 1));
+    map.insert(std::make_pair("ABC", 2));
+    map.insert(std::make_pair("AC", 3));
+    map.insert(std::make_pair("B", 4));
+
+    std::set<std::string> keys;
+    for (auto it = map.begin(); it != map.end(); ++it) {
+        keys.insert((*it).first);
+    }
+    TEST_CONDITION((keys == std::set<std::string>{"A", "ABC", "AC", "B"}));
+
+    map.clear();
+    TEST_CONDITION(map.empty());
+    TEST_CONDITION(map.begin() == map.end());
+
+    return true;
+}
+
+bool VisitPrefixTest() {
+    e8::TrieMap<std::string, int> map;
+    map.insert(std::make_pair("A", 1));
+    map.insert(std::make_pair("ABC", 2));
+    map.insert(std::make_pair("AB", 3));
+    map.insert(std::make_pair("AC", 4));
+    map.insert(std::make_pair("B", 5));
+
+    std::set<std::pair<std::string, int>> visited;
+    auto collect = [&visited](std::string const &key, int value) {
+        visited.insert(std::make_pair(key, value));
+        return true;
+    };
+
+    map.visit_prefix("AB", collect);
+    TEST_CONDITION((visited == std::set<std::pair<std::string, int>>{{"AB", 3}, {"ABC", 2}}));
+
+    visited.clear();
+    map.visit_prefix("", collect);
+    TEST_CONDITION(visited.size() == 5);
+
+    visited.clear();
+    map.visit_prefix("ABCD", collect);
+    TEST_CONDITION(visited.empty());
+
+    unsigned num_visited = 0;
+    map.visit_prefix("A", [&num_visited](std::string const & /*key*/, int /*value*/) {
+        ++num_visited;
+        return num_visited < 2;
+    });
+    TEST_CONDITION(num_visited == 2);
+
+    return true;
+}
+
 int main() {
     e8::BeginTestSuite("trie_map");
     e8::RunTest("InsertTest", InsertTest);
     e8::RunTest("InsertThenFindTest", InsertThenFindTest);
     e8::RunTest("InsertThenEraseThenFindTest", InsertThenEraseThenFindTest);
+    e8::RunTest("EraseKeepsLongerKeysTest", EraseKeepsLongerKeysTest);
+    e8::RunTest("IterateTest", IterateTest);
+    e8::RunTest("VisitPrefixTest", VisitPrefixTest);
     e8::EndTestSuite();
     return 0;
 }
@@ -0,0 +1,233 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/container/compact_trie_map.h"
+#include "common/container/trie_map.h"
+#include "common/unit_test_util/unit_test_util.h"
+
+namespace {
+
+size_t g_num_allocated_bytes = 0;
+
+} // namespace
+
+void *operator new(size_t size) {
+    // Prefixes the block with its size so the deallocation can account for it.
+    size_t *block = static_cast<size_t *>(std::malloc(size + sizeof(size_t)));
+    if (block == nullptr) {
+        throw std::bad_alloc();
+    }
+    block[0] = size;
+    g_num_allocated_bytes += size;
+    return block + 1;
+}
+
+void operator delete(void *ptr) noexcept {
+    if (ptr == nullptr) {
+        return;
+    }
+    size_t *block = static_cast<size_t *>(ptr) - 1;
+    g_num_allocated_bytes -= block[0];
+    std::free(block);
+}
+
+void operator delete(void *ptr, size_t /*size*/) noexcept { operator delete(ptr); }
+
+namespace {
+
+unsigned const kNumKeys = 200000;
+unsigned const kNumLookups = 1000000;
+
+/**
+ * @brief GenerateKeys Mixes numeric user ID strings with lowercase words, similar to the terms
+ * indexed for the user search.
+ */
+std::vector<std::string> GenerateKeys(unsigned num_keys, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::uniform_int_distribution<unsigned> length(3, 12);
+    std::uniform_int_distribution<long> user_id(10000000L, 99999999L);
+
+    std::vector<std::string> keys;
+    for (unsigned i = 0; i < num_keys; ++i) {
+        if (i % 2 == 0) {
+            keys.push_back(std::to_string(user_id(rng)));
+            continue;
+        }
+        std::string word;
+        unsigned word_length = length(rng);
+        for (unsigned j = 0; j < word_length; ++j) {
+            word.push_back(static_cast<char>(letter(rng)));
+        }
+        keys.push_back(word);
+    }
+    return keys;
+}
+
+double SecondsSince(std::chrono::steady_clock::time_point const &start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct BenchmarkResult {
+    double bytes_per_key;
+    double inserts_per_second;
+    double hit_lookups_per_second;
+    double miss_lookups_per_second;
+    unsigned num_hits;
+    unsigned num_misses;
+};
+
+template <typename MapType>
+BenchmarkResult RunWorkload(std::vector<std::string> const &keys,
+                            std::vector<std::string> const &absent_keys) {
+    BenchmarkResult result;
+
+    size_t num_bytes_before = g_num_allocated_bytes;
+    auto start = std::chrono::steady_clock::now();
+
+    MapType map;
+    for (unsigned i = 0; i < keys.size(); ++i) {
+        map.insert(std::make_pair(keys[i], i));
+    }
+
+    result.inserts_per_second = keys.size() / SecondsSince(start);
+    result.bytes_per_key =
+        static_cast<double>(g_num_allocated_bytes - num_bytes_before) / map.size();
+
+    result.num_hits = 0;
+    start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < kNumLookups; ++i) {
+        if (map.find(keys[i % keys.size()]) != map.end()) {
+            ++result.num_hits;
+        }
+    }
+    result.hit_lookups_per_second = kNumLookups / SecondsSince(start);
+
+    result.num_misses = 0;
+    start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < kNumLookups; ++i) {
+        if (map.find(absent_keys[i % absent_keys.size()]) == map.end()) {
+            ++result.num_misses;
+        }
+    }
+    result.miss_lookups_per_second = kNumLookups / SecondsSince(start);
+
+    return result;
+}
+
+void PrintResult(std::string const &name, BenchmarkResult const &result) {
+    std::cout << std::fixed << std::setprecision(1) << name
+              << ": bytes/key=" << result.bytes_per_key
+              << " inserts/s=" << result.inserts_per_second
+              << " hit lookups/s=" << result.hit_lookups_per_second
+              << " miss lookups/s=" << result.miss_lookups_per_second << std::endl;
+}
+
+} // namespace
+
+bool MemoryAndLookupThroughputTest() {
+    std::vector<std::string> keys = GenerateKeys(kNumKeys, /*seed=*/1);
+    std::vector<std::string> absent_keys = GenerateKeys(kNumKeys, /*seed=*/2);
+    for (auto &key : absent_keys) {
+        // Keeps the common prefixes but makes sure the keys are absent.
+        key.push_back('#');
+    }
+
+    BenchmarkResult trie = RunWorkload<e8::TrieMap<std::string, unsigned>>(keys, absent_keys);
+    BenchmarkResult compact_trie =
+        RunWorkload<e8::CompactTrieMap<std::string, unsigned>>(keys, absent_keys);
+
+    PrintResult("TrieMap", trie);
+    PrintResult("CompactTrieMap", compact_trie);
+
+    TEST_CONDITION(trie.num_hits == kNumLookups);
+    TEST_CONDITION(compact_trie.num_hits == kNumLookups);
+    TEST_CONDITION(trie.num_misses == kNumLookups);
+    TEST_CONDITION(compact_trie.num_misses == kNumLookups);
+    TEST_CONDITION(compact_trie.bytes_per_key < trie.bytes_per_key);
+
+    return true;
+}
+
+bool PrefixVisitThroughputTest() {
+    std::vector<std::string> keys = GenerateKeys(kNumKeys, /*seed=*/1);
+
+    e8::TrieMap<std::string, unsigned> trie;
+    e8::CompactTrieMap<std::string, unsigned> compact_trie;
+    for (unsigned i = 0; i < keys.size(); ++i) {
+        trie.insert(std::make_pair(keys[i], i));
+        compact_trie.insert(std::make_pair(keys[i], i));
+    }
+
+    std::vector<std::string> prefixes;
+    for (char c = 'a'; c <= 'z'; ++c) {
+        prefixes.push_back(std::string(1, c) + "b");
+    }
+    for (char c = '1'; c <= '9'; ++c) {
+        prefixes.push_back(std::string(1, c) + "23");
+    }
+
+    unsigned trie_num_visited = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (auto const &prefix : prefixes) {
+        trie.visit_prefix(prefix, [&trie_num_visited](std::string const &, unsigned) {
+            ++trie_num_visited;
+            return true;
+        });
+    }
+    double trie_seconds = SecondsSince(start);
+
+    unsigned compact_trie_num_visited = 0;
+    start = std::chrono::steady_clock::now();
+    for (auto const &prefix : prefixes) {
+        compact_trie.visit_prefix(prefix,
+                                  [&compact_trie_num_visited](std::string const &, unsigned) {
+                                      ++compact_trie_num_visited;
+                                      return true;
+                                  });
+    }
+    double compact_trie_seconds = SecondsSince(start);
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "TrieMap: visited keys/s=" << trie_num_visited / trie_seconds << std::endl
+              << "CompactTrieMap: visited keys/s="
+              << compact_trie_num_visited / compact_trie_seconds << std::endl;
+
+    TEST_CONDITION(trie_num_visited == compact_trie_num_visited);
+    TEST_CONDITION(trie_num_visited > 0);
+
+    return true;
+}
+
+int main() {
+    e8::BeginTestSuite("trie_map_benchmark");
+    e8::RunTest("MemoryAndLookupThroughputTest", MemoryAndLookupThroughputTest);
+    e8::RunTest("PrefixVisitThroughputTest", PrefixVisitThroughputTest);
+    e8::EndTestSuite();
+    return 0;
+}
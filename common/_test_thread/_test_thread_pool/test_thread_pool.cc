@@ -15,12 +15,15 @@
  * not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <atomic>
 #include <cassert>
 #include <memory>
+#include <thread>
 #include <unordered_set>
 #include <vector>
 
 #include "common/thread/thread_pool.h"
+#include "common/thread/work_stealing_deque.h"
 #include "common/unit_test_util/unit_test_util.h"
 
 class Operand : public e8::TaskStorageInterface {
@@ -77,9 +80,171 @@ bool ScheduleTaskAndWaitForResultTest() {
     return true;
 }
 
+bool ScheduleManyTest() {
+    unsigned const kNumDataEntries = 1000;
+
+    e8::ThreadPool thread_pool(/*num_workers=*/4);
+
+    std::vector<std::unique_ptr<e8::TaskStorageInterface>> operands;
+    for (unsigned i = 0; i < kNumDataEntries; ++i) {
+        operands.push_back(std::make_unique<Operand>(i));
+    }
+    thread_pool.ScheduleMany(std::make_shared<AddOneTask>(), std::move(operands));
+
+    std::unordered_set<unsigned> operand_values;
+    for (unsigned i = 0; i < kNumDataEntries; ++i) {
+        std::unique_ptr<e8::TaskStorageInterface> result = thread_pool.WaitForNextCompleted();
+        Operand const *operand = static_cast<Operand const *>(result.get());
+        operand_values.insert(operand->operand);
+
+        TEST_CONDITION(operand->result == operand->operand + 1);
+    }
+
+    TEST_CONDITION(operand_values.size() == kNumDataEntries);
+
+    return true;
+}
+
+bool CompletionChannelTest() {
+    unsigned const kNumSubmitters = 4;
+    unsigned const kNumDataEntries = 1000;
+
+    e8::ThreadPool thread_pool(/*num_workers=*/4);
+    std::shared_ptr<AddOneTask> task = std::make_shared<AddOneTask>();
+
+    // Each submitter must only receive its own operands.
+    std::atomic<bool> correct(true);
+    std::vector<std::thread> submitters;
+    for (unsigned s = 0; s < kNumSubmitters; ++s) {
+        submitters.emplace_back([&thread_pool, &task, &correct, s]() {
+            e8::TaskCompletionChannel channel;
+            for (unsigned i = 0; i < kNumDataEntries; ++i) {
+                thread_pool.Schedule(task, std::make_unique<Operand>(s * kNumDataEntries + i),
+                                     &channel);
+            }
+            for (unsigned i = 0; i < kNumDataEntries; ++i) {
+                std::unique_ptr<e8::TaskStorageInterface> result = channel.WaitForNextCompleted();
+                Operand const *operand = static_cast<Operand const *>(result.get());
+                if (operand->operand / kNumDataEntries != s ||
+                    operand->result != operand->operand + 1) {
+                    correct = false;
+                }
+            }
+        });
+    }
+    for (auto &submitter : submitters) {
+        submitter.join();
+    }
+
+    TEST_CONDITION(correct);
+
+    return true;
+}
+
+class Counter : public e8::TaskStorageInterface {
+  public:
+    std::atomic<unsigned> count = 0;
+};
+
+class FanOutTask : public e8::TaskInterface {
+  public:
+    FanOutTask(e8::ThreadPool *thread_pool, Counter *counter, unsigned depth)
+        : thread_pool_(thread_pool), counter_(counter), depth_(depth) {}
+
+    void Run(e8::TaskStorageInterface *) const override {
+        counter_->count.fetch_add(1);
+        if (depth_ == 0) {
+            return;
+        }
+        for (unsigned i = 0; i < 2; ++i) {
+            thread_pool_->Schedule(
+                std::make_shared<FanOutTask>(thread_pool_, counter_, depth_ - 1));
+        }
+    }
+
+    bool DropResourceOnCompletion() const override { return true; }
+
+  private:
+    e8::ThreadPool *thread_pool_;
+    Counter *counter_;
+    unsigned depth_;
+};
+
+bool NestedScheduleTest() {
+    unsigned const kDepth = 12;
+
+    Counter counter;
+    {
+        e8::ThreadPool thread_pool(/*num_workers=*/4);
+        thread_pool.Schedule(std::make_shared<FanOutTask>(&thread_pool, &counter, kDepth));
+
+        // The tree of tasks has 2^(depth+1) - 1 nodes.
+        while (counter.count.load() < (1U << (kDepth + 1)) - 1) {
+            std::this_thread::yield();
+        }
+    }
+
+    TEST_CONDITION(counter.count.load() == (1U << (kDepth + 1)) - 1);
+
+    return true;
+}
+
+bool WorkStealingDequeTest() {
+    unsigned const kNumItems = 100000;
+    unsigned const kNumThieves = 3;
+
+    std::vector<unsigned> items(kNumItems);
+    std::vector<std::atomic<unsigned>> num_takes(kNumItems);
+    e8::WorkStealingDeque<unsigned> deque(/*initial_capacity=*/16);
+
+    std::atomic<bool> done(false);
+    std::vector<std::thread> thieves;
+    for (unsigned t = 0; t < kNumThieves; ++t) {
+        thieves.emplace_back([&deque, &items, &num_takes, &done]() {
+            while (!done.load()) {
+                unsigned *item = deque.Steal();
+                if (item != nullptr) {
+                    num_takes[item - items.data()].fetch_add(1);
+                }
+            }
+        });
+    }
+
+    // The owner interleaves pushes and pops while the thieves steal.
+    for (unsigned i = 0; i < kNumItems; ++i) {
+        deque.Push(&items[i]);
+        if (i % 3 == 0) {
+            unsigned *item = deque.Pop();
+            if (item != nullptr) {
+                num_takes[item - items.data()].fetch_add(1);
+            }
+        }
+    }
+    for (unsigned *item = deque.Pop(); item != nullptr; item = deque.Pop()) {
+        num_takes[item - items.data()].fetch_add(1);
+    }
+    while (!deque.Empty()) {
+        std::this_thread::yield();
+    }
+    done = true;
+    for (auto &thief : thieves) {
+        thief.join();
+    }
+
+    for (unsigned i = 0; i < kNumItems; ++i) {
+        TEST_CONDITION(num_takes[i].load() == 1);
+    }
+
+    return true;
+}
+
 int main() {
     e8::BeginTestSuite("thread_pool");
     e8::RunTest("ScheduleTaskAndWaitForResultTest", ScheduleTaskAndWaitForResultTest);
+    e8::RunTest("ScheduleManyTest", ScheduleManyTest);
+    e8::RunTest("CompletionChannelTest", CompletionChannelTest);
+    e8::RunTest("NestedScheduleTest", NestedScheduleTest);
+    e8::RunTest("WorkStealingDequeTest", WorkStealingDequeTest);
     e8::EndTestSuite();
     return 0;
 }
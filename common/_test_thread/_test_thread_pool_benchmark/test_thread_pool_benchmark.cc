@@ -0,0 +1,100 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "common/thread/thread_pool.h"
+#include "common/unit_test_util/unit_test_util.h"
+
+class Rollout : public e8::TaskStorageInterface {
+  public:
+    unsigned seed;
+    unsigned result = 0;
+
+    Rollout(unsigned seed) : seed(seed) {}
+};
+
+/**
+ * @brief The RolloutTask class A small CPU bound task, similar in size to a light rollout.
+ */
+class RolloutTask : public e8::TaskInterface {
+  public:
+    void Run(e8::TaskStorageInterface *storage) const override {
+        Rollout *rollout = static_cast<Rollout *>(storage);
+        unsigned x = rollout->seed + 1;
+        for (unsigned i = 0; i < 20000; ++i) {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+        }
+        rollout->result = x;
+    }
+
+    bool DropResourceOnCompletion() const override { return false; }
+};
+
+bool ScalingBenchmarkTest() {
+    unsigned const kNumSteps = 200;
+    unsigned const kNumRolloutsPerStep = 256;
+
+    std::shared_ptr<RolloutTask> task = std::make_shared<RolloutTask>();
+
+    double single_worker_throughput = 0;
+    for (unsigned num_workers = 1; num_workers <= std::thread::hardware_concurrency();
+         num_workers *= 2) {
+        e8::ThreadPool thread_pool(num_workers);
+        e8::TaskCompletionChannel channel;
+
+        // Mimics the rollout evaluator: schedule a batch of small tasks and wait for all of them.
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned step = 0; step < kNumSteps; ++step) {
+            std::vector<std::unique_ptr<e8::TaskStorageInterface>> rollouts;
+            for (unsigned i = 0; i < kNumRolloutsPerStep; ++i) {
+                rollouts.push_back(std::make_unique<Rollout>(step * kNumRolloutsPerStep + i));
+            }
+            thread_pool.ScheduleMany(task, std::move(rollouts), &channel);
+            for (unsigned i = 0; i < kNumRolloutsPerStep; ++i) {
+                std::unique_ptr<e8::TaskStorageInterface> rollout = channel.WaitForNextCompleted();
+                TEST_CONDITION(static_cast<Rollout *>(rollout.get())->result != 0);
+            }
+        }
+        double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        double throughput = kNumSteps * kNumRolloutsPerStep / seconds;
+        if (num_workers == 1) {
+            single_worker_throughput = throughput;
+        }
+        std::cout << std::fixed << std::setprecision(2) << "num_workers=" << num_workers
+                  << " tasks/s=" << throughput
+                  << " speedup=" << throughput / single_worker_throughput << std::endl;
+    }
+
+    return true;
+}
+
+int main() {
+    e8::BeginTestSuite("thread_pool_benchmark");
+    e8::RunTest("ScalingBenchmarkTest", ScalingBenchmarkTest);
+    e8::EndTestSuite();
+    return 0;
+}
@@ -11,8 +11,13 @@ SUBDIRS = \
     _test_random/_test_random_source \
     _test_random/_test_uniform_distribution \
     _test_thread/_test_thread_pool \
+    _test_thread/_test_thread_pool_benchmark/_test_thread_pool_benchmark.pro \
     _test_container/_test_trie_map/_test_trie_map.pro \
+    _test_container/_test_compact_trie_map/_test_compact_trie_map.pro \
+    _test_container/_test_trie_map_benchmark/_test_trie_map_benchmark.pro \
     _test_container/_test_lru_hash_map/_test_lru_hash_map.pro \
+    _test_container/_test_sharded_lru_hash_map/_test_sharded_lru_hash_map.pro \
+    _test_container/_test_lru_hash_map_benchmark/_test_lru_hash_map_benchmark.pro \
     _test_container/_test_mutable_priority_queue
 
 CONFIG += ordered
@@ -0,0 +1,680 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPACT_TRIE_MAP_H
+#define COMPACT_TRIE_MAP_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace e8 {
+
+/**
+ * @brief The CompactTrieMap class Implements the map abstract data type using a path compressed
+ * prefix tree (radix tree), with the same interface as TrieMap. Instead of a hash table and a heap
+ * allocation per key element, the nodes, the edge labels and the values are each stored in a
+ * contiguous arena and refer to each other by 32-bit indices. A node keeps its children in a
+ * sibling list sorted by the first element of their labels, and a chain of single-child nodes is
+ * collapsed into one node labeled by the whole chain.
+ *
+ * Iterators stay valid until the entry they point to is erased. Erasing recycles the nodes and the
+ * value slots but not the label storage, which is only reclaimed by clear(). This map does not
+ * guarantee thread safety.
+ */
+template <typename KeyType, typename ValueType> class CompactTrieMap {
+  public:
+    using key_type = KeyType;
+    using mapped_type = ValueType;
+    using value_type = std::pair<KeyType, ValueType>;
+    using KeyElementType = typename KeyType::value_type;
+    using NodeIndex = uint32_t;
+
+    static constexpr NodeIndex kNil = std::numeric_limits<NodeIndex>::max();
+    static constexpr NodeIndex kRoot = 0;
+
+    /**
+     * @brief The Node struct A node of the radix tree. Its label is the key fragment on the edge
+     * from its parent.
+     */
+    struct Node {
+        uint32_t label_begin = 0;
+        uint32_t label_size = 0;
+        NodeIndex parent = kNil;
+        NodeIndex first_child = kNil;
+        NodeIndex next_sibling = kNil;
+        uint32_t value = kNil;
+    };
+
+    template <typename MapType, typename IteratorValueType> class iterator_base {
+      public:
+        iterator_base() = default;
+
+        /**
+         * @brief iterator_base Points to the node whose path from the root forms the key.
+         */
+        iterator_base(MapType *map, NodeIndex node, KeyType const &key);
+        iterator_base(iterator_base const &) = default;
+
+        ~iterator_base() = default;
+
+        /**
+         * @brief operator == Two iterators are equal if they point to the same node.
+         */
+        bool operator==(iterator_base const &rhs) const;
+
+        /**
+         * @brief operator != Negation of the equality operator.
+         */
+        bool operator!=(iterator_base const &rhs) const;
+
+        /**
+         * @brief operator ++ Prefix increment. Move the iterator to the next element in the map.
+         * The order of iteration is that of a pre-order traversal of the prefix tree, which is
+         * alphabetical.
+         *
+         * @return This iterator which points to the next position.
+         */
+        iterator_base &operator++();
+
+        /**
+         * @brief operator * de-reference operator.
+         * @return mapped value at the current key, or the iterator position.
+         */
+        std::pair<KeyType const &, IteratorValueType &> const operator*();
+
+      public:
+        MapType *map_ = nullptr;
+        NodeIndex node_ = kNil;
+        KeyType key_;
+    };
+
+    using const_iterator = iterator_base<CompactTrieMap const, ValueType const>;
+    using iterator = iterator_base<CompactTrieMap, ValueType>;
+
+    CompactTrieMap();
+    CompactTrieMap(CompactTrieMap const &other) = default;
+    ~CompactTrieMap() = default;
+
+    CompactTrieMap &operator=(CompactTrieMap const &rhs) = default;
+
+    /**
+     * @brief operator == Two maps are equal if they both contain the same set of key-value pairs.
+     */
+    bool operator==(CompactTrieMap const &rhs) const;
+
+    /**
+     * @brief operator != The negation of the equality operator.
+     */
+    bool operator!=(CompactTrieMap const &rhs) const;
+
+    /**
+     * @brief operator [] Taking the key as the index and returns the corresponding reference to the
+     * value. The behavior of this operator is undefined if the key doesn't exist in the map.
+     */
+    ValueType &operator[](KeyType const &key);
+
+    /**
+     * @brief operator [] Constant version of the above operator.
+     */
+    ValueType operator[](KeyType const &key) const;
+
+    /**
+     * @brief size The number of key value pairs.
+     */
+    size_t size() const;
+
+    /**
+     * @brief empty Test if the map contains nothing.
+     */
+    bool empty() const;
+
+    /**
+     * @brief clear Removes all the key-value pairs in the map and releases the arenas.
+     */
+    void clear();
+
+    /**
+     * @brief find Retrieves an iterator in the map that points the key value pair.
+     * @return Iterator pointing to the key-value pair if it exists. If not, it returns an iterator
+     * pointing to the end().
+     */
+    iterator find(KeyType const &key);
+
+    /**
+     * @brief find Constant version of the above function.
+     */
+    const_iterator find(KeyType const &key) const;
+
+    /**
+     * @brief insert Inserts a key-value pair into the map. It overrides the exsting value if the
+     * key has already existed.
+     * @return the iterator pointing to the insertion and an new entry indicator. The new entry
+     * indicator is true if the key doesn't exist in the map, otherwise, false.
+     */
+    std::pair<iterator, bool> insert(std::pair<KeyType, ValueType> const &entry);
+
+    /**
+     * @brief visit_prefix Visits the key-value pairs whose key starts with the prefix, in
+     * alphabetical order.
+     * @param visitor A functor-like object that takes the key and the value, and returns whether
+     * the traversal should continue. Example signature: bool(KeyType const&, ValueType const&).
+     */
+    template <typename Visitor> void visit_prefix(KeyType const &prefix, Visitor &&visitor) const;
+
+    /**
+     * @brief erase Erase a key-value pair from the map.
+     * @param it An iterator pointing to the key-value pair which is going to be removed.
+     */
+    void erase(iterator &it);
+
+    /**
+     * @brief begin Returns an iterator pointing to the first entry in the map. If the map is empty,
+     * it equals to the end().
+     */
+    iterator begin();
+
+    /**
+     * @brief begin Constant version of the above function.
+     */
+    const_iterator begin() const;
+
+    /**
+     * @brief end Returns an iterator pointing to the next position after the last key-value pair in
+     * the map.
+     */
+    iterator end();
+
+    /**
+     * @brief end Constant version of the above function.
+     */
+    const_iterator end() const;
+
+    /**
+     * @brief num_nodes The number of live nodes, including the root.
+     */
+    size_t num_nodes() const;
+
+    /**
+     * @brief memory_usage The number of bytes reserved by the arenas.
+     */
+    size_t memory_usage() const;
+
+  private:
+    template <typename Visitor>
+    bool VisitSubtree(NodeIndex node, KeyType *key, Visitor &visitor) const;
+
+    /**
+     * @brief FindNode Returns the node whose path from the root forms the key, if it exists.
+     */
+    NodeIndex FindNode(KeyType const &key) const;
+
+    /**
+     * @brief FindChild Returns the child whose label starts with the key element. Otherwise, it
+     * returns kNil and sets prev_sibling to where the child would be linked after.
+     */
+    NodeIndex FindChild(NodeIndex node, KeyElementType const &key_elm,
+                        NodeIndex *prev_sibling) const;
+
+    NodeIndex NewNode(NodeIndex parent, uint32_t label_begin, uint32_t label_size);
+    void LinkChild(NodeIndex parent, NodeIndex prev_sibling, NodeIndex child);
+    void UnlinkChild(NodeIndex parent, NodeIndex child);
+
+    /**
+     * @brief SplitNode Shortens the label of the node to label_size and moves the rest of the
+     * label, the value and the children to a new child node.
+     */
+    void SplitNode(NodeIndex node, uint32_t label_size);
+
+    uint32_t NewValue(ValueType const &value);
+
+    std::vector<Node> nodes_;
+    std::vector<KeyElementType> labels_;
+    std::vector<ValueType> values_;
+    std::vector<NodeIndex> free_nodes_;
+    std::vector<uint32_t> free_values_;
+    size_t num_elements_ = 0;
+};
+
+template <typename KeyType, typename ValueType>
+template <typename MapType, typename IteratorValueType>
+CompactTrieMap<KeyType, ValueType>::iterator_base<MapType, IteratorValueType>::iterator_base(
+    MapType *map, NodeIndex node, KeyType const &key)
+    : map_(map), node_(node), key_(key) {}
+
+template <typename KeyType, typename ValueType>
+template <typename MapType, typename IteratorValueType>
+bool CompactTrieMap<KeyType, ValueType>::iterator_base<MapType, IteratorValueType>::operator==(
+    iterator_base const &rhs) const {
+    return node_ == rhs.node_;
+}
+
+template <typename KeyType, typename ValueType>
+template <typename MapType, typename IteratorValueType>
+bool CompactTrieMap<KeyType, ValueType>::iterator_base<MapType, IteratorValueType>::operator!=(
+    iterator_base const &rhs) const {
+    return !(*this == rhs);
+}
+
+template <typename KeyType, typename ValueType>
+template <typename MapType, typename IteratorValueType>
+typename CompactTrieMap<KeyType, ValueType>::template iterator_base<MapType, IteratorValueType> &
+CompactTrieMap<KeyType, ValueType>::iterator_base<MapType, IteratorValueType>::operator++() {
+    assert(node_ != kNil);
+
+    auto const &nodes = map_->nodes_;
+    auto const &labels = map_->labels_;
+
+    NodeIndex cur = node_;
+    do {
+        if (nodes[cur].first_child != kNil) {
+            cur = nodes[cur].first_child;
+        } else {
+            while (cur != kRoot && nodes[cur].next_sibling == kNil) {
+                key_.resize(key_.size() - nodes[cur].label_size);
+                cur = nodes[cur].parent;
+            }
+            if (cur == kRoot) {
+                node_ = kNil;
+                key_ = KeyType();
+                return *this;
+            }
+            key_.resize(key_.size() - nodes[cur].label_size);
+            cur = nodes[cur].next_sibling;
+        }
+        key_.insert(key_.end(), labels.begin() + nodes[cur].label_begin,
+                    labels.begin() + nodes[cur].label_begin + nodes[cur].label_size);
+    } while (nodes[cur].value == kNil);
+
+    node_ = cur;
+    return *this;
+}
+
+template <typename KeyType, typename ValueType>
+template <typename MapType, typename IteratorValueType>
+std::pair<KeyType const &, IteratorValueType &> const
+    CompactTrieMap<KeyType, ValueType>::iterator_base<MapType, IteratorValueType>::operator*() {
+    assert(node_ != kNil);
+    uint32_t value = map_->nodes_[node_].value;
+    assert(value != kNil);
+    return std::pair<KeyType const &, IteratorValueType &>(key_, map_->values_[value]);
+}
+
+template <typename KeyType, typename ValueType>
+CompactTrieMap<KeyType, ValueType>::CompactTrieMap() : nodes_(1) {}
+
+template <typename KeyType, typename ValueType>
+bool CompactTrieMap<KeyType, ValueType>::operator==(CompactTrieMap const &rhs) const {
+    if (num_elements_ != rhs.num_elements_) {
+        return false;
+    }
+    for (auto it = this->begin(); it != this->end(); ++it) {
+        auto rhs_it = rhs.find((*it).first);
+        if (rhs_it == rhs.end() || !((*rhs_it).second == (*it).second)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename KeyType, typename ValueType>
+bool CompactTrieMap<KeyType, ValueType>::operator!=(CompactTrieMap const &rhs) const {
+    return !(*this == rhs);
+}
+
+template <typename KeyType, typename ValueType>
+ValueType &CompactTrieMap<KeyType, ValueType>::operator[](KeyType const &key) {
+    NodeIndex node = this->FindNode(key);
+    assert(node != kNil);
+    return values_[nodes_[node].value];
+}
+
+template <typename KeyType, typename ValueType>
+ValueType CompactTrieMap<KeyType, ValueType>::operator[](KeyType const &key) const {
+    NodeIndex node = this->FindNode(key);
+    assert(node != kNil);
+    return values_[nodes_[node].value];
+}
+
+template <typename KeyType, typename ValueType>
+size_t CompactTrieMap<KeyType, ValueType>::size() const {
+    return num_elements_;
+}
+
+template <typename KeyType, typename ValueType>
+bool CompactTrieMap<KeyType, ValueType>::empty() const {
+    return size() == 0;
+}
+
+template <typename KeyType, typename ValueType> void CompactTrieMap<KeyType, ValueType>::clear() {
+    nodes_ = std::vector<Node>(1);
+    labels_ = std::vector<KeyElementType>();
+    values_ = std::vector<ValueType>();
+    free_nodes_ = std::vector<NodeIndex>();
+    free_values_ = std::vector<uint32_t>();
+    num_elements_ = 0;
+}
+
+template <typename KeyType, typename ValueType>
+typename CompactTrieMap<KeyType, ValueType>::NodeIndex
+CompactTrieMap<KeyType, ValueType>::FindChild(NodeIndex node, KeyElementType const &key_elm,
+                                              NodeIndex *prev_sibling) const {
+    NodeIndex prev = kNil;
+    NodeIndex child = nodes_[node].first_child;
+    while (child != kNil && labels_[nodes_[child].label_begin] < key_elm) {
+        prev = child;
+        child = nodes_[child].next_sibling;
+    }
+    if (prev_sibling != nullptr) {
+        *prev_sibling = prev;
+    }
+    if (child == kNil || !(labels_[nodes_[child].label_begin] == key_elm)) {
+        return kNil;
+    }
+    return child;
+}
+
+template <typename KeyType, typename ValueType>
+typename CompactTrieMap<KeyType, ValueType>::NodeIndex
+CompactTrieMap<KeyType, ValueType>::FindNode(KeyType const &key) const {
+    NodeIndex cur = kRoot;
+    auto key_it = key.begin();
+    while (key_it != key.end()) {
+        cur = this->FindChild(cur, *key_it, /*prev_sibling=*/nullptr);
+        if (cur == kNil) {
+            return kNil;
+        }
+
+        Node const &node = nodes_[cur];
+        if (static_cast<size_t>(key.end() - key_it) < node.label_size) {
+            return kNil;
+        }
+        for (uint32_t i = 0; i < node.label_size; ++i, ++key_it) {
+            if (!(labels_[node.label_begin + i] == *key_it)) {
+                return kNil;
+            }
+        }
+    }
+    if (nodes_[cur].value == kNil) {
+        return kNil;
+    }
+    return cur;
+}
+
+template <typename KeyType, typename ValueType>
+typename CompactTrieMap<KeyType, ValueType>::iterator
+CompactTrieMap<KeyType, ValueType>::find(KeyType const &key) {
+    NodeIndex node = this->FindNode(key);
+    if (node == kNil) {
+        return this->end();
+    }
+    return iterator(this, node, key);
+}
+
+template <typename KeyType, typename ValueType>
+typename CompactTrieMap<KeyType, ValueType>::const_iterator
+CompactTrieMap<KeyType, ValueType>::find(KeyType const &key) const {
+    NodeIndex node = this->FindNode(key);
+    if (node == kNil) {
+        return this->end();
+    }
+    return const_iterator(this, node, key);
+}
+
+template <typename KeyType, typename ValueType>
+typename CompactTrieMap<KeyType, ValueType>::NodeIndex
+CompactTrieMap<KeyType, ValueType>::NewNode(NodeIndex parent, uint32_t label_begin,
+                                            uint32_t label_size) {
+    Node node;
+    node.label_begin = label_begin;
+    node.label_size = label_size;
+    node.parent = parent;
+
+    if (!free_nodes_.empty()) {
+        NodeIndex index = free_nodes_.back();
+        free_nodes_.pop_back();
+        nodes_[index] = node;
+        return index;
+    }
+
+    assert(nodes_.size() < kNil);
+    nodes_.push_back(node);
+    return static_cast<NodeIndex>(nodes_.size() - 1);
+}
+
+template <typename KeyType, typename ValueType>
+void CompactTrieMap<KeyType, ValueType>::LinkChild(NodeIndex parent, NodeIndex prev_sibling,
+                                                   NodeIndex child) {
+    if (prev_sibling == kNil) {
+        nodes_[child].next_sibling = nodes_[parent].first_child;
+        nodes_[parent].first_child = child;
+    } else {
+        nodes_[child].next_sibling = nodes_[prev_sibling].next_sibling;
+        nodes_[prev_sibling].next_sibling = child;
+    }
+}
+
+template <typename KeyType, typename ValueType>
+void CompactTrieMap<KeyType, ValueType>::UnlinkChild(NodeIndex parent, NodeIndex child) {
+    if (nodes_[parent].first_child == child) {
+        nodes_[parent].first_child = nodes_[child].next_sibling;
+        return;
+    }
+
+    NodeIndex prev = nodes_[parent].first_child;
+    while (nodes_[prev].next_sibling != child) {
+        prev = nodes_[prev].next_sibling;
+        assert(prev != kNil);
+    }
+    nodes_[prev].next_sibling = nodes_[child].next_sibling;
+}
+
+template <typename KeyType, typename ValueType>
+void CompactTrieMap<KeyType, ValueType>::SplitNode(NodeIndex node, uint32_t label_size) {
+    assert(label_size > 0 && label_size < nodes_[node].label_size);
+
+    NodeIndex tail = this->NewNode(node, nodes_[node].label_begin + label_size,
+                                   nodes_[node].label_size - label_size);
+    nodes_[tail].first_child = nodes_[node].first_child;
+    nodes_[tail].value = nodes_[node].value;
+    for (NodeIndex child = nodes_[tail].first_child; child != kNil;
+         child = nodes_[child].next_sibling) {
+        nodes_[child].parent = tail;
+    }
+
+    nodes_[node].label_size = label_size;
+    nodes_[node].first_child = tail;
+    nodes_[node].value = kNil;
+}
+
+template <typename KeyType, typename ValueType>
+uint32_t CompactTrieMap<KeyType, ValueType>::NewValue(ValueType const &value) {
+    if (!free_values_.empty()) {
+        uint32_t index = free_values_.back();
+        free_values_.pop_back();
+        values_[index] = value;
+        return index;
+    }
+
+    assert(values_.size() < kNil);
+    values_.push_back(value);
+    return static_cast<uint32_t>(values_.size() - 1);
+}
+
+template <typename KeyType, typename ValueType>
+std::pair<typename CompactTrieMap<KeyType, ValueType>::iterator, bool>
+CompactTrieMap<KeyType, ValueType>::insert(std::pair<KeyType, ValueType> const &entry) {
+    auto const &[key, value] = entry;
+
+    NodeIndex cur = kRoot;
+    auto key_it = key.begin();
+    while (key_it != key.end()) {
+        NodeIndex prev_sibling;
+        NodeIndex child = this->FindChild(cur, *key_it, &prev_sibling);
+        if (child == kNil) {
+            // Hangs the rest of the key as a leaf.
+            uint32_t label_begin = static_cast<uint32_t>(labels_.size());
+            labels_.insert(labels_.end(), key_it, key.end());
+            NodeIndex leaf = this->NewNode(cur, label_begin,
+                                           static_cast<uint32_t>(labels_.size() - label_begin));
+            this->LinkChild(cur, prev_sibling, leaf);
+            cur = leaf;
+            break;
+        }
+
+        uint32_t num_matched = 0;
+        while (num_matched < nodes_[child].label_size && key_it != key.end() &&
+               labels_[nodes_[child].label_begin + num_matched] == *key_it) {
+            ++num_matched;
+            ++key_it;
+        }
+        if (num_matched < nodes_[child].label_size) {
+            this->SplitNode(child, num_matched);
+        }
+        cur = child;
+    }
+
+    if (nodes_[cur].value != kNil) {
+        values_[nodes_[cur].value] = value;
+        return std::make_pair(iterator(this, cur, key), false);
+    }
+
+    nodes_[cur].value = this->NewValue(value);
+    ++num_elements_;
+    return std::make_pair(iterator(this, cur, key), true);
+}
+
+template <typename KeyType, typename ValueType>
+template <typename Visitor>
+bool CompactTrieMap<KeyType, ValueType>::VisitSubtree(NodeIndex node, KeyType *key,
+                                                      Visitor &visitor) const {
+    if (nodes_[node].value != kNil &&
+        !visitor(static_cast<KeyType const &>(*key), values_[nodes_[node].value])) {
+        return false;
+    }
+    for (NodeIndex child = nodes_[node].first_child; child != kNil;
+         child = nodes_[child].next_sibling) {
+        Node const &child_node = nodes_[child];
+        key->insert(key->end(), labels_.begin() + child_node.label_begin,
+                    labels_.begin() + child_node.label_begin + child_node.label_size);
+        bool should_continue = this->VisitSubtree(child, key, visitor);
+        key->resize(key->size() - child_node.label_size);
+        if (!should_continue) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename KeyType, typename ValueType>
+template <typename Visitor>
+void CompactTrieMap<KeyType, ValueType>::visit_prefix(KeyType const &prefix,
+                                                      Visitor &&visitor) const {
+    KeyType key;
+    NodeIndex cur = kRoot;
+    auto prefix_it = prefix.begin();
+    while (prefix_it != prefix.end()) {
+        cur = this->FindChild(cur, *prefix_it, /*prev_sibling=*/nullptr);
+        if (cur == kNil) {
+            return;
+        }
+
+        // The prefix may end in the middle of the label.
+        Node const &node = nodes_[cur];
+        for (uint32_t i = 0; i < node.label_size; ++i) {
+            KeyElementType const &label_elm = labels_[node.label_begin + i];
+            if (prefix_it != prefix.end()) {
+                if (!(label_elm == *prefix_it)) {
+                    return;
+                }
+                ++prefix_it;
+            }
+            key.push_back(label_elm);
+        }
+    }
+
+    this->VisitSubtree(cur, &key, visitor);
+}
+
+template <typename KeyType, typename ValueType>
+void CompactTrieMap<KeyType, ValueType>::erase(iterator &it) {
+    assert(it != this->end());
+
+    NodeIndex cur = it.node_;
+    assert(nodes_[cur].value != kNil);
+    free_values_.push_back(nodes_[cur].value);
+    nodes_[cur].value = kNil;
+
+    // Prunes the branch which no longer leads to any value.
+    while (cur != kRoot && nodes_[cur].value == kNil && nodes_[cur].first_child == kNil) {
+        NodeIndex parent = nodes_[cur].parent;
+        this->UnlinkChild(parent, cur);
+        free_nodes_.push_back(cur);
+        cur = parent;
+    }
+
+    --num_elements_;
+}
+
+template <typename KeyType, typename ValueType>
+typename CompactTrieMap<KeyType, ValueType>::iterator CompactTrieMap<KeyType, ValueType>::begin() {
+    iterator it(this, kRoot, KeyType());
+    if (nodes_[kRoot].value == kNil) {
+        ++it;
+    }
+    return it;
+}
+
+template <typename KeyType, typename ValueType>
+typename CompactTrieMap<KeyType, ValueType>::const_iterator
+CompactTrieMap<KeyType, ValueType>::begin() const {
+    const_iterator it(this, kRoot, KeyType());
+    if (nodes_[kRoot].value == kNil) {
+        ++it;
+    }
+    return it;
+}
+
+template <typename KeyType, typename ValueType>
+typename CompactTrieMap<KeyType, ValueType>::iterator CompactTrieMap<KeyType, ValueType>::end() {
+    return iterator(this, kNil, KeyType());
+}
+
+template <typename KeyType, typename ValueType>
+typename CompactTrieMap<KeyType, ValueType>::const_iterator
+CompactTrieMap<KeyType, ValueType>::end() const {
+    return const_iterator(this, kNil, KeyType());
+}
+
+template <typename KeyType, typename ValueType>
+size_t CompactTrieMap<KeyType, ValueType>::num_nodes() const {
+    return nodes_.size() - free_nodes_.size();
+}
+
+template <typename KeyType, typename ValueType>
+size_t CompactTrieMap<KeyType, ValueType>::memory_usage() const {
+    return nodes_.capacity() * sizeof(Node) + labels_.capacity() * sizeof(KeyElementType) +
+           values_.capacity() * sizeof(ValueType) + free_nodes_.capacity() * sizeof(NodeIndex) +
+           free_values_.capacity() * sizeof(uint32_t);
+}
+
+} // namespace e8
+
+#endif // COMPACT_TRIE_MAP_H
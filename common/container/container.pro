@@ -24,13 +24,19 @@ DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs depr
 INCLUDEPATH += ../../
 
 SOURCES += \
+    compact_trie_map.cc \
+    eviction_policy.cc \
     lru_hash_map.cc \
     mutable_priority_queue.cc \
+    sharded_lru_hash_map.cc \
     trie_map.cc
 
 HEADERS += \
+    compact_trie_map.h \
+    eviction_policy.h \
     lru_hash_map.h \
     mutable_priority_queue.h \
+    sharded_lru_hash_map.h \
     trie_map.h
 
 unix {
@@ -0,0 +1,366 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EVICTION_POLICY_H
+#define EVICTION_POLICY_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <vector>
+
+namespace e8 {
+
+/**
+ * An eviction policy decides which cached key LruHashMap gives up when it's full. It only keeps
+ * track of pointers to the keys owned by the cache, which stay valid until the cache erases them,
+ * and has to provide:
+ *
+ * using Handle = ...; A per-item reference the cache stores next to the value.
+ * EvictionPolicy(uint32_t max_size);
+ * void Access(KeyType const &key); Called on every cached fetch, hit or miss.
+ * Handle Insert(KeyType const *key); Starts tracking a newly cached key.
+ * void Touch(Handle handle); Called on a cache hit.
+ * KeyType const *Victim(); Chooses the key to evict. Only called when the cache is full.
+ * void Erase(Handle handle); Stops tracking the key.
+ * void Clear();
+ */
+
+/**
+ * @brief The LruEvictionPolicy class Evicts the least recently used key. Every hit relinks the key
+ * to the front of the recency list.
+ */
+template <typename KeyType> class LruEvictionPolicy {
+  public:
+    using Handle = typename std::list<KeyType const *>::iterator;
+
+    LruEvictionPolicy(uint32_t max_size);
+
+    void Access(KeyType const &key);
+    Handle Insert(KeyType const *key);
+    void Touch(Handle handle);
+    KeyType const *Victim();
+    void Erase(Handle handle);
+    void Clear();
+
+  private:
+    std::list<KeyType const *> recency_;
+};
+
+/**
+ * @brief The ClockEvictionPolicy class Approximates LRU with the CLOCK algorithm. A hit only sets
+ * the reference bit of the key's slot. The eviction sweeps the slots in a circle, giving every
+ * referenced key a second chance by clearing its bit, and evicts the first unreferenced one.
+ */
+template <typename KeyType> class ClockEvictionPolicy {
+  public:
+    using Handle = uint32_t;
+
+    ClockEvictionPolicy(uint32_t max_size);
+
+    void Access(KeyType const &key);
+    Handle Insert(KeyType const *key);
+    void Touch(Handle handle);
+    KeyType const *Victim();
+    void Erase(Handle handle);
+    void Clear();
+
+  private:
+    struct Slot {
+        KeyType const *key = nullptr;
+        bool referenced = false;
+    };
+
+    std::vector<Slot> slots_;
+    std::vector<Handle> free_slots_;
+    Handle hand_ = 0;
+};
+
+/**
+ * @brief The WTinyLfuEvictionPolicy class Implements W-TinyLFU. New keys enter a small LRU window
+ * (1% of the capacity). A key leaving the window is admitted into the main segmented LRU only if it
+ * has been accessed more often than the main victim according to a count-min frequency sketch, so
+ * that a scan of one-off keys can't flush the frequently used ones. The main segment is split into
+ * a probation (20%) and a protected (80%) LRU; a hit on probation promotes the key into protected.
+ * The sketch halves its counters periodically so stale popularity fades.
+ */
+template <typename KeyType> class WTinyLfuEvictionPolicy {
+  private:
+    enum Segment { WINDOW, PROBATION, PROTECTED };
+
+    struct Entry {
+        KeyType const *key;
+        Segment segment;
+    };
+
+  public:
+    using Handle = typename std::list<Entry>::iterator;
+
+    WTinyLfuEvictionPolicy(uint32_t max_size);
+
+    void Access(KeyType const &key);
+    Handle Insert(KeyType const *key);
+    void Touch(Handle handle);
+    KeyType const *Victim();
+    void Erase(Handle handle);
+    void Clear();
+
+  private:
+    static unsigned const kNumSketchRows = 4;
+    static uint8_t const kMaxFrequency = 15;
+
+    std::list<Entry> *ListOf(Segment segment);
+    uint8_t *Counter(unsigned row, size_t hash);
+    unsigned Frequency(KeyType const &key);
+
+    std::list<Entry> window_;
+    std::list<Entry> probation_;
+    std::list<Entry> protected_;
+
+    uint32_t window_capacity_;
+    uint32_t main_capacity_;
+    uint32_t protected_capacity_;
+
+    std::vector<uint8_t> sketch_;
+    size_t sketch_mask_;
+    uint64_t num_samples_ = 0;
+    uint64_t sample_period_;
+};
+
+template <typename KeyType>
+LruEvictionPolicy<KeyType>::LruEvictionPolicy(uint32_t /*max_size*/) {}
+
+template <typename KeyType> void LruEvictionPolicy<KeyType>::Access(KeyType const & /*key*/) {}
+
+template <typename KeyType>
+typename LruEvictionPolicy<KeyType>::Handle
+LruEvictionPolicy<KeyType>::Insert(KeyType const *key) {
+    recency_.push_front(key);
+    return recency_.begin();
+}
+
+template <typename KeyType> void LruEvictionPolicy<KeyType>::Touch(Handle handle) {
+    recency_.splice(recency_.begin(), recency_, handle);
+}
+
+template <typename KeyType> KeyType const *LruEvictionPolicy<KeyType>::Victim() {
+    assert(!recency_.empty());
+    return recency_.back();
+}
+
+template <typename KeyType> void LruEvictionPolicy<KeyType>::Erase(Handle handle) {
+    recency_.erase(handle);
+}
+
+template <typename KeyType> void LruEvictionPolicy<KeyType>::Clear() { recency_.clear(); }
+
+template <typename KeyType> ClockEvictionPolicy<KeyType>::ClockEvictionPolicy(uint32_t max_size) {
+    slots_.reserve(max_size);
+}
+
+template <typename KeyType> void ClockEvictionPolicy<KeyType>::Access(KeyType const & /*key*/) {}
+
+template <typename KeyType>
+typename ClockEvictionPolicy<KeyType>::Handle
+ClockEvictionPolicy<KeyType>::Insert(KeyType const *key) {
+    Handle handle;
+    if (!free_slots_.empty()) {
+        handle = free_slots_.back();
+        free_slots_.pop_back();
+    } else {
+        handle = static_cast<Handle>(slots_.size());
+        slots_.push_back(Slot());
+    }
+    slots_[handle].key = key;
+    slots_[handle].referenced = false;
+    return handle;
+}
+
+template <typename KeyType> void ClockEvictionPolicy<KeyType>::Touch(Handle handle) {
+    slots_[handle].referenced = true;
+}
+
+template <typename KeyType> KeyType const *ClockEvictionPolicy<KeyType>::Victim() {
+    assert(free_slots_.size() < slots_.size());
+    while (true) {
+        if (hand_ >= slots_.size()) {
+            hand_ = 0;
+        }
+        Slot *slot = &slots_[hand_];
+        if (slot->key != nullptr && !slot->referenced) {
+            // The slot will be reused by the next insertion. Moves the hand past it so that the new
+            // key survives a full revolution.
+            ++hand_;
+            return slot->key;
+        }
+        slot->referenced = false;
+        ++hand_;
+    }
+}
+
+template <typename KeyType> void ClockEvictionPolicy<KeyType>::Erase(Handle handle) {
+    slots_[handle].key = nullptr;
+    slots_[handle].referenced = false;
+    free_slots_.push_back(handle);
+}
+
+template <typename KeyType> void ClockEvictionPolicy<KeyType>::Clear() {
+    slots_.clear();
+    free_slots_.clear();
+    hand_ = 0;
+}
+
+template <typename KeyType>
+WTinyLfuEvictionPolicy<KeyType>::WTinyLfuEvictionPolicy(uint32_t max_size)
+    : window_capacity_(std::max(1U, max_size / 100)),
+      main_capacity_(max_size - std::min(max_size, window_capacity_)),
+      protected_capacity_(main_capacity_ * 4 / 5), sample_period_(10ULL * max_size) {
+    size_t width = 16;
+    while (width < max_size) {
+        width <<= 1;
+    }
+    sketch_.resize(kNumSketchRows * width, 0);
+    sketch_mask_ = width - 1;
+}
+
+template <typename KeyType>
+uint8_t *WTinyLfuEvictionPolicy<KeyType>::Counter(unsigned row, size_t hash) {
+    // Derives an independent index for each row by remixing the hash with a row-specific odd
+    // multiplier.
+    uint64_t mixed = (static_cast<uint64_t>(hash) + row) * (0x9E3779B97F4A7C15ULL + 2 * row);
+    mixed ^= mixed >> 32;
+    return &sketch_[row * (sketch_mask_ + 1) + (mixed & sketch_mask_)];
+}
+
+template <typename KeyType>
+unsigned WTinyLfuEvictionPolicy<KeyType>::Frequency(KeyType const &key) {
+    size_t hash = std::hash<KeyType>{}(key);
+    unsigned frequency = kMaxFrequency;
+    for (unsigned row = 0; row < kNumSketchRows; ++row) {
+        frequency = std::min(frequency, static_cast<unsigned>(*this->Counter(row, hash)));
+    }
+    return frequency;
+}
+
+template <typename KeyType> void WTinyLfuEvictionPolicy<KeyType>::Access(KeyType const &key) {
+    size_t hash = std::hash<KeyType>{}(key);
+    for (unsigned row = 0; row < kNumSketchRows; ++row) {
+        uint8_t *counter = this->Counter(row, hash);
+        if (*counter < kMaxFrequency) {
+            ++*counter;
+        }
+    }
+
+    if (++num_samples_ == sample_period_) {
+        // Ages the sketch.
+        for (uint8_t &counter : sketch_) {
+            counter >>= 1;
+        }
+        num_samples_ = 0;
+    }
+}
+
+template <typename KeyType>
+std::list<typename WTinyLfuEvictionPolicy<KeyType>::Entry> *
+WTinyLfuEvictionPolicy<KeyType>::ListOf(Segment segment) {
+    switch (segment) {
+    case WINDOW:
+        return &window_;
+    case PROBATION:
+        return &probation_;
+    case PROTECTED:
+        return &protected_;
+    }
+    assert(false);
+    return nullptr;
+}
+
+template <typename KeyType>
+typename WTinyLfuEvictionPolicy<KeyType>::Handle
+WTinyLfuEvictionPolicy<KeyType>::Insert(KeyType const *key) {
+    if (window_.size() == window_capacity_ &&
+        probation_.size() + protected_.size() < main_capacity_) {
+        // The cache isn't full yet, so the window's least recently used key moves to the main
+        // segment without competing.
+        window_.back().segment = PROBATION;
+        probation_.splice(probation_.begin(), window_, std::prev(window_.end()));
+    }
+
+    window_.push_front(Entry{key, WINDOW});
+    return window_.begin();
+}
+
+template <typename KeyType> void WTinyLfuEvictionPolicy<KeyType>::Touch(Handle handle) {
+    switch (handle->segment) {
+    case WINDOW: {
+        window_.splice(window_.begin(), window_, handle);
+        break;
+    }
+    case PROBATION: {
+        handle->segment = PROTECTED;
+        protected_.splice(protected_.begin(), probation_, handle);
+        if (protected_.size() > protected_capacity_) {
+            protected_.back().segment = PROBATION;
+            probation_.splice(probation_.begin(), protected_, std::prev(protected_.end()));
+        }
+        break;
+    }
+    case PROTECTED: {
+        protected_.splice(protected_.begin(), protected_, handle);
+        break;
+    }
+    }
+}
+
+template <typename KeyType> KeyType const *WTinyLfuEvictionPolicy<KeyType>::Victim() {
+    std::list<Entry> *main = probation_.empty() ? &protected_ : &probation_;
+    if (window_.empty()) {
+        assert(!main->empty());
+        return main->back().key;
+    }
+    if (main->empty()) {
+        return window_.back().key;
+    }
+
+    // The window's least recently used key competes with the main victim for admission.
+    Entry candidate = window_.back();
+    Entry victim = main->back();
+    if (this->Frequency(*candidate.key) > this->Frequency(*victim.key)) {
+        window_.back().segment = PROBATION;
+        probation_.splice(probation_.begin(), window_, std::prev(window_.end()));
+        return victim.key;
+    }
+    return candidate.key;
+}
+
+template <typename KeyType> void WTinyLfuEvictionPolicy<KeyType>::Erase(Handle handle) {
+    this->ListOf(handle->segment)->erase(handle);
+}
+
+template <typename KeyType> void WTinyLfuEvictionPolicy<KeyType>::Clear() {
+    window_.clear();
+    probation_.clear();
+    protected_.clear();
+    std::fill(sketch_.begin(), sketch_.end(), 0);
+    num_samples_ = 0;
+}
+
+} // namespace e8
+
+#endif // EVICTION_POLICY_H
@@ -19,40 +19,23 @@
 #define LRU_TRIE_MAP_H
 
 #include <cassert>
-#include <list>
-#include <memory>
+#include <cstdint>
 #include <mutex>
 #include <optional>
+#include <unordered_map>
 #include <utility>
 
-#include "common/container/trie_map.h"
+#include "common/container/eviction_policy.h"
 
 namespace e8 {
-namespace {
-/**
- * @brief LruCacheItem struct A trie node list element ordered by cache hit recency.
- */
-template <typename KeyType, typename ValueType> struct LruCacheItem {
-    LruCacheItem(KeyType const &key, ValueType const &value);
-
-    KeyType key; // TODO: Avoid storing an extra key here. It should use a pointer to the hash map's
-                 // location instead.
-    ValueType value;
-    LruCacheItem *next = nullptr;
-    LruCacheItem *prev = nullptr;
-};
-
-template <typename KeyType, typename ValueType>
-LruCacheItem<KeyType, ValueType>::LruCacheItem(KeyType const &key, ValueType const &value)
-    : key(key), value(value) {}
-
-} // namespace
 
 /**
- * @brief The LruHashMap class An in-memory least-recently used cache, for which the underlying
- * key-value implementation uses a hash map. This cache guarantees thread safety.
+ * @brief The LruHashMap class An in-memory cache, for which the underlying key-value implementation
+ * uses a hash map. Which item is evicted when the cache is full is decided by the EvictionPolicy,
+ * see eviction_policy.h. It defaults to least-recently used. This cache guarantees thread safety.
  */
-template <typename KeyType, typename ValueType, typename OnFetch, typename OnEvict>
+template <typename KeyType, typename ValueType, typename OnFetch, typename OnEvict,
+          typename EvictionPolicy = LruEvictionPolicy<KeyType>>
 class LruHashMap {
   public:
     /**
@@ -74,7 +57,7 @@ class LruHashMap {
      * @brief Fetch Fetches the value of an item which associates with the key.
      * If the key doesn't exist in the cache, it will load the item into the cache. If the item
      * still couldn't be found in the source storage, it will return an nullopt. If the cache
-     * exceeds the size limit, an LRU item will be evicted.
+     * exceeds the size limit, the item chosen by the eviction policy will be evicted.
      *
      * @param key Unique key that maps to the value.
      * @param cache_on Whether to cache the key-value pair. If not, it will always load from the
@@ -110,17 +93,19 @@ class LruHashMap {
     OnEvict const &EvictOperator() const;
 
   private:
-    using Item = LruCacheItem<KeyType, ValueType>;
+    struct Item {
+        ValueType value;
+        typename EvictionPolicy::Handle handle;
+    };
 
     Item *CacheNewItem(KeyType const &key, ValueType const &value);
-    void SetMostRecentlyUsed(Item *most_recent_node);
 
-    std::unordered_map<KeyType, std::unique_ptr<Item>> cache_;
+    // The eviction policy refers to the keys stored by the hash map nodes, which are stable across
+    // rehashing, so the keys aren't stored twice.
+    std::unordered_map<KeyType, Item> cache_;
+    EvictionPolicy policy_;
     std::mutex mutex_;
 
-    Item *head_ = nullptr;
-    Item *tail_ = nullptr;
-
     uint32_t max_size_;
     int32_t padding_;
 
@@ -128,78 +113,54 @@ class LruHashMap {
     OnEvict on_evict_;
 };
 
-template <typename KeyType, typename ValueType, typename OnFetch, typename OnEvict>
-typename LruHashMap<KeyType, ValueType, OnFetch, OnEvict>::Item *
-LruHashMap<KeyType, ValueType, OnFetch, OnEvict>::CacheNewItem(KeyType const &key,
-                                                               ValueType const &value) {
+template <typename KeyType, typename ValueType, typename OnFetch, typename OnEvict,
+          typename EvictionPolicy>
+typename LruHashMap<KeyType, ValueType, OnFetch, OnEvict, EvictionPolicy>::Item *
+LruHashMap<KeyType, ValueType, OnFetch, OnEvict, EvictionPolicy>::CacheNewItem(
+    KeyType const &key, ValueType const &value) {
     if (cache_.size() == max_size_) {
-        // Need to remove the least frequently used item.
-        Item *to_be_removed = tail_;
+        // Need to remove the item chosen by the eviction policy.
+        auto to_be_removed = cache_.find(*policy_.Victim());
+        assert(to_be_removed != cache_.end());
 
-        // There is no need to handle the head pointer because it's assumed that max_size_ must be
-        // greater than 1.
-        tail_ = tail_->prev;
-
-        on_evict_(to_be_removed->value);
-        cache_.erase(to_be_removed->key);
+        policy_.Erase(to_be_removed->second.handle);
+        on_evict_(to_be_removed->second.value);
+        cache_.erase(to_be_removed);
     }
     assert(cache_.size() < max_size_);
 
-    auto insertion = cache_.insert(std::make_pair(key, std::make_unique<Item>(key, value)));
+    auto insertion = cache_.insert(std::make_pair(key, Item{value, {}}));
     assert(insertion.second == true);
-    Item *item = insertion.first->second.get();
-
-    if (head_ == nullptr) {
-        head_ = item;
-        tail_ = item;
-    } else {
-        item->next = head_;
-        head_->prev = item;
-        head_ = item;
-    }
+    Item *item = &insertion.first->second;
+    item->handle = policy_.Insert(&insertion.first->first);
 
     return item;
 }
 
-template <typename KeyType, typename ValueType, typename OnFetch, typename OnEvict>
-void LruHashMap<KeyType, ValueType, OnFetch, OnEvict>::SetMostRecentlyUsed(Item *most_recent_node) {
-    if (most_recent_node->prev == nullptr) {
-        // It has already been the most recently used item.
-        return;
-    }
-    if (most_recent_node->next != nullptr) {
-        most_recent_node->prev->next = most_recent_node->next;
-        most_recent_node->next->prev = most_recent_node->prev;
-    } else {
-        most_recent_node->prev->next = nullptr;
-        tail_ = most_recent_node->prev;
-    }
-    most_recent_node->prev = nullptr;
-    most_recent_node->next = head_;
-    head_->prev = most_recent_node;
-    head_ = most_recent_node;
-}
-
-template <typename KeyType, typename ValueType, typename OnFetch, typename OnEvict>
-LruHashMap<KeyType, ValueType, OnFetch, OnEvict>::LruHashMap(uint32_t max_size,
-                                                             OnFetch const &on_fetch,
-                                                             OnEvict const &on_evict)
-    : max_size_(max_size), on_fetch_(on_fetch), on_evict_(on_evict) {}
-
-template <typename KeyType, typename ValueType, typename OnFetch, typename OnEvict>
-std::optional<ValueType> LruHashMap<KeyType, ValueType, OnFetch, OnEvict>::Fetch(KeyType const &key,
-                                                                                 bool cache_on) {
+template <typename KeyType, typename ValueType, typename OnFetch, typename OnEvict,
+          typename EvictionPolicy>
+LruHashMap<KeyType, ValueType, OnFetch, OnEvict, EvictionPolicy>::LruHashMap(
+    uint32_t max_size, OnFetch const &on_fetch, OnEvict const &on_evict)
+    : policy_(max_size), max_size_(max_size), on_fetch_(on_fetch), on_evict_(on_evict) {}
+
+template <typename KeyType, typename ValueType, typename OnFetch, typename OnEvict,
+          typename EvictionPolicy>
+std::optional<ValueType>
+LruHashMap<KeyType, ValueType, OnFetch, OnEvict, EvictionPolicy>::Fetch(KeyType const &key,
+                                                                        bool cache_on) {
     if (!cache_on) {
         return on_fetch_(key);
     }
 
     mutex_.lock();
 
+    policy_.Access(key);
+
     auto it = cache_.find(key);
     if (it != cache_.end()) {
         // Cache hit.
-        Item *item = it->second.get();
-        this->SetMostRecentlyUsed(item);
+        Item *item = &it->second;
+        policy_.Touch(item->handle);
 
         mutex_.unlock();
         return item->value;
@@ -218,36 +179,40 @@ std::optional<ValueType> LruHashMap<KeyType, ValueType, OnFetch, OnEvict>::Fetch
     return item->value;
 }
 
-template <typename KeyType, typename ValueType, typename OnFetch, typename OnEvict>
-void LruHashMap<KeyType, ValueType, OnFetch, OnEvict>::Finish(ValueType const &value,
-                                                              bool cache_on) {
+template <typename KeyType, typename ValueType, typename OnFetch, typename OnEvict,
+          typename EvictionPolicy>
+void LruHashMap<KeyType, ValueType, OnFetch, OnEvict, EvictionPolicy>::Finish(
+    ValueType const &value, bool cache_on) {
     if (!cache_on) {
         on_evict_(value);
     }
 }
 
-template <typename KeyType, typename ValueType, typename OnFetch, typename OnEvict>
-void LruHashMap<KeyType, ValueType, OnFetch, OnEvict>::Clear() {
+template <typename KeyType, typename ValueType, typename OnFetch, typename OnEvict,
+          typename EvictionPolicy>
+void LruHashMap<KeyType, ValueType, OnFetch, OnEvict, EvictionPolicy>::Clear() {
     mutex_.lock();
 
     for (auto const &[key, item] : cache_) {
-        on_evict_(item->value);
+        on_evict_(item.value);
     }
     cache_.clear();
-
-    head_ = nullptr;
-    tail_ = nullptr;
+    policy_.Clear();
 
     mutex_.unlock();
 }
 
-template <typename KeyType, typename ValueType, typename OnFetch, typename OnEvict>
-OnFetch const &LruHashMap<KeyType, ValueType, OnFetch, OnEvict>::FetchOperator() const {
+template <typename KeyType, typename ValueType, typename OnFetch, typename OnEvict,
+          typename EvictionPolicy>
+OnFetch const &
+LruHashMap<KeyType, ValueType, OnFetch, OnEvict, EvictionPolicy>::FetchOperator() const {
     return on_fetch_;
 }
 
-template <typename KeyType, typename ValueType, typename OnFetch, typename OnEvict>
-OnEvict const &LruHashMap<KeyType, ValueType, OnFetch, OnEvict>::EvictOperator() const {
+template <typename KeyType, typename ValueType, typename OnFetch, typename OnEvict,
+          typename EvictionPolicy>
+OnEvict const &
+LruHashMap<KeyType, ValueType, OnFetch, OnEvict, EvictionPolicy>::EvictOperator() const {
     return on_evict_;
 }
 
@@ -0,0 +1,316 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SHARDED_LRU_HASH_MAP_H
+#define SHARDED_LRU_HASH_MAP_H
+
+#include <cassert>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace e8 {
+
+/**
+ * @brief The ShardedLruHashMap class An in-memory least-recently used cache with the same interface
+ * as LruHashMap, but split into independently locked shards by the key hash, each of which keeps
+ * its own recency list. The source-of-truth load runs outside of any lock, so a slow miss doesn't
+ * block hits or misses on other keys. Concurrent misses on the same key share one load
+ * (single-flight). This cache guarantees thread safety, and the fetch operator has to be thread
+ * safe as well since it can be invoked concurrently for different keys.
+ */
+template <typename KeyType, typename ValueType, typename OnFetch, typename OnEvict>
+class ShardedLruHashMap {
+  public:
+    /**
+     * @brief The Stats struct Cache effectiveness counters summed over all shards.
+     */
+    struct Stats {
+        uint64_t num_hits = 0;
+        uint64_t num_misses = 0;
+        uint64_t num_evictions = 0;
+    };
+
+    /**
+     * @brief ShardedLruHashMap Constructs an empty cache.
+     *
+     * @param num_shards The number of independently locked shards.
+     * @param max_size_per_shard The maximum number of items each shard can store.
+     * @param on_fetch See LruHashMap. It's invoked outside of the shard lock.
+     * @param on_evict See LruHashMap. It's invoked outside of the shard lock.
+     */
+    ShardedLruHashMap(uint32_t num_shards, uint32_t max_size_per_shard, OnFetch const &on_fetch,
+                      OnEvict const &on_evict);
+    ShardedLruHashMap(ShardedLruHashMap const &other) = delete;
+    ~ShardedLruHashMap() = default;
+
+    /**
+     * @brief Fetch Fetches the value of an item which associates with the key. See LruHashMap.
+     * If another thread is already loading the key, it waits for and shares that load instead of
+     * loading it again. If the load throws, the loading thread and all the waiting threads throw
+     * the same error, and the next fetch of the key loads it again.
+     */
+    std::optional<ValueType> Fetch(KeyType const &key, bool cache_on = true);
+
+    /**
+     * @brief Finish See LruHashMap.
+     */
+    void Finish(ValueType const &value, bool cache_on = true);
+
+    /**
+     * @brief Clear Empties the cache to its original empty state. All the existing values will be
+     * evicted. Loads in flight are not affected.
+     */
+    void Clear();
+
+    /**
+     * @brief GetStats Returns a snapshot of the cache effectiveness counters.
+     */
+    Stats GetStats();
+
+    /**
+     * @brief FetchOperator For testing purpose, it's useful to be able to return the fetch
+     * operator.
+     */
+    OnFetch const &FetchOperator() const;
+
+    /**
+     * @brief EvictOperator For testing purpose, it's useful to be able to return the eviction
+     * operator.
+     */
+    OnEvict const &EvictOperator() const;
+
+  private:
+    struct Item {
+        ValueType value;
+
+        // Points to the key stored by the hash map node, which is stable across rehashing, so the
+        // key isn't stored twice.
+        typename std::list<KeyType const *>::iterator recency_it;
+    };
+
+    struct InFlightFetch {
+        bool done = false;
+        std::optional<ValueType> value;
+        std::exception_ptr error;
+        std::condition_variable fetched;
+    };
+
+    struct Shard {
+        std::unordered_map<KeyType, Item> items;
+        std::list<KeyType const *> recency;
+        std::unordered_map<KeyType, std::shared_ptr<InFlightFetch>> in_flight;
+        Stats stats;
+        std::mutex mutex;
+    };
+
+    Shard *ShardOf(KeyType const &key);
+
+    /**
+     * @brief Install Caches the loaded value, and returns the evicted value, if any. The shard has
+     * to be locked.
+     */
+    std::optional<ValueType> Install(Shard *shard, KeyType const &key, ValueType const &value);
+
+    /**
+     * @brief CompleteInFlight Hands the result of the load over to the waiting threads and lets the
+     * next miss of the key load it again. The shard has to be locked.
+     */
+    void CompleteInFlight(Shard *shard, KeyType const &key, InFlightFetch *in_flight,
+                          std::optional<ValueType> const &value, std::exception_ptr error);
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    uint32_t max_size_per_shard_;
+
+    OnFetch on_fetch_;
+    OnEvict on_evict_;
+};
+
+template <typename KeyType, typename ValueType, typename OnFetch, typename OnEvict>
+ShardedLruHashMap<KeyType, ValueType, OnFetch, OnEvict>::ShardedLruHashMap(
+    uint32_t num_shards, uint32_t max_size_per_shard, OnFetch const &on_fetch,
+    OnEvict const &on_evict)
+    : max_size_per_shard_(max_size_per_shard), on_fetch_(on_fetch), on_evict_(on_evict) {
+    assert(num_shards > 0);
+    assert(max_size_per_shard > 0);
+
+    for (uint32_t i = 0; i < num_shards; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+}
+
+template <typename KeyType, typename ValueType, typename OnFetch, typename OnEvict>
+typename ShardedLruHashMap<KeyType, ValueType, OnFetch, OnEvict>::Shard *
+ShardedLruHashMap<KeyType, ValueType, OnFetch, OnEvict>::ShardOf(KeyType const &key) {
+    return shards_[std::hash<KeyType>{}(key) % shards_.size()].get();
+}
+
+template <typename KeyType, typename ValueType, typename OnFetch, typename OnEvict>
+std::optional<ValueType>
+ShardedLruHashMap<KeyType, ValueType, OnFetch, OnEvict>::Install(Shard *shard, KeyType const &key,
+                                                                 ValueType const &value) {
+    std::optional<ValueType> evicted;
+    if (shard->items.size() == max_size_per_shard_) {
+        // Evict the least recently used item.
+        auto it = shard->items.find(*shard->recency.back());
+        evicted = std::move(it->second.value);
+        shard->recency.pop_back();
+        shard->items.erase(it);
+        ++shard->stats.num_evictions;
+    }
+    assert(shard->items.size() < max_size_per_shard_);
+
+    auto insertion = shard->items.insert(std::make_pair(key, Item{value, {}}));
+    assert(insertion.second);
+    shard->recency.push_front(&insertion.first->first);
+    insertion.first->second.recency_it = shard->recency.begin();
+
+    return evicted;
+}
+
+template <typename KeyType, typename ValueType, typename OnFetch, typename OnEvict>
+void ShardedLruHashMap<KeyType, ValueType, OnFetch, OnEvict>::CompleteInFlight(
+    Shard *shard, KeyType const &key, InFlightFetch *in_flight,
+    std::optional<ValueType> const &value, std::exception_ptr error) {
+    shard->in_flight.erase(key);
+    in_flight->value = value;
+    in_flight->error = error;
+    in_flight->done = true;
+    in_flight->fetched.notify_all();
+}
+
+template <typename KeyType, typename ValueType, typename OnFetch, typename OnEvict>
+std::optional<ValueType>
+ShardedLruHashMap<KeyType, ValueType, OnFetch, OnEvict>::Fetch(KeyType const &key,
+                                                               bool cache_on) {
+    if (!cache_on) {
+        return on_fetch_(key);
+    }
+
+    Shard *shard = this->ShardOf(key);
+    std::unique_lock<std::mutex> lock(shard->mutex);
+
+    auto it = shard->items.find(key);
+    if (it != shard->items.end()) {
+        // Cache hit.
+        Item *item = &it->second;
+        shard->recency.splice(shard->recency.begin(), shard->recency, item->recency_it);
+        ++shard->stats.num_hits;
+        return item->value;
+    }
+
+    // Cache miss.
+    ++shard->stats.num_misses;
+
+    auto in_flight_it = shard->in_flight.find(key);
+    if (in_flight_it != shard->in_flight.end()) {
+        // Another thread is loading the same key.
+        std::shared_ptr<InFlightFetch> in_flight = in_flight_it->second;
+        in_flight->fetched.wait(lock, [&in_flight] { return in_flight->done; });
+        if (in_flight->error != nullptr) {
+            std::rethrow_exception(in_flight->error);
+        }
+        return in_flight->value;
+    }
+
+    auto in_flight = std::make_shared<InFlightFetch>();
+    shard->in_flight.insert(std::make_pair(key, in_flight));
+    lock.unlock();
+
+    std::optional<ValueType> fetched;
+    try {
+        fetched = on_fetch_(key);
+    } catch (...) {
+        // Otherwise, the waiting threads and all later fetches of the key would block forever.
+        lock.lock();
+        this->CompleteInFlight(shard, key, in_flight.get(), std::nullopt, std::current_exception());
+        throw;
+    }
+
+    lock.lock();
+    this->CompleteInFlight(shard, key, in_flight.get(), fetched, /*error=*/nullptr);
+
+    std::optional<ValueType> evicted;
+    if (fetched.has_value() && shard->items.find(key) == shard->items.end()) {
+        evicted = this->Install(shard, key, *fetched);
+    }
+    lock.unlock();
+
+    if (evicted.has_value()) {
+        on_evict_(*evicted);
+    }
+    return fetched;
+}
+
+template <typename KeyType, typename ValueType, typename OnFetch, typename OnEvict>
+void ShardedLruHashMap<KeyType, ValueType, OnFetch, OnEvict>::Finish(ValueType const &value,
+                                                                     bool cache_on) {
+    if (!cache_on) {
+        on_evict_(value);
+    }
+}
+
+template <typename KeyType, typename ValueType, typename OnFetch, typename OnEvict>
+void ShardedLruHashMap<KeyType, ValueType, OnFetch, OnEvict>::Clear() {
+    for (auto &shard : shards_) {
+        shard->mutex.lock();
+        std::unordered_map<KeyType, Item> items = std::move(shard->items);
+        shard->items.clear();
+        shard->recency.clear();
+        shard->mutex.unlock();
+
+        for (auto const &[key, item] : items) {
+            on_evict_(item.value);
+        }
+    }
+}
+
+template <typename KeyType, typename ValueType, typename OnFetch, typename OnEvict>
+typename ShardedLruHashMap<KeyType, ValueType, OnFetch, OnEvict>::Stats
+ShardedLruHashMap<KeyType, ValueType, OnFetch, OnEvict>::GetStats() {
+    Stats stats;
+    for (auto &shard : shards_) {
+        shard->mutex.lock();
+        stats.num_hits += shard->stats.num_hits;
+        stats.num_misses += shard->stats.num_misses;
+        stats.num_evictions += shard->stats.num_evictions;
+        shard->mutex.unlock();
+    }
+    return stats;
+}
+
+template <typename KeyType, typename ValueType, typename OnFetch, typename OnEvict>
+OnFetch const &ShardedLruHashMap<KeyType, ValueType, OnFetch, OnEvict>::FetchOperator() const {
+    return on_fetch_;
+}
+
+template <typename KeyType, typename ValueType, typename OnFetch, typename OnEvict>
+OnEvict const &ShardedLruHashMap<KeyType, ValueType, OnFetch, OnEvict>::EvictOperator() const {
+    return on_evict_;
+}
+
+} // namespace e8
+
+#endif // SHARDED_LRU_HASH_MAP_H
@@ -64,7 +64,7 @@ bool TrieNode<KeyElementType, ValueType>::operator==(TrieNode const &rhs) const
     if (value != rhs.value) {
         return false;
     }
-    if (children.size() != rhs.size()) {
+    if (children.size() != rhs.children.size()) {
         return false;
     }
 
@@ -247,6 +247,17 @@ class TrieMap {
      */
     std::pair<iterator, bool> insert(std::pair<KeyType, ValueType> const &entry);
 
+    /**
+     * @brief visit_prefix Visits the key-value pairs whose key starts with the prefix, in the order
+     * of a pre-order traversal of the prefix tree. The cost is proportional to the length of the
+     * prefix plus the size of the sub-tree under it rather than the size of the map.
+     * @param prefix The prefix every visited key has to start with. An empty prefix visits the
+     * whole map.
+     * @param visitor A functor-like object that takes the key and the value, and returns whether
+     * the traversal should continue. Example signature: bool(KeyType const&, ValueType const&).
+     */
+    template <typename Visitor> void visit_prefix(KeyType const &prefix, Visitor &&visitor) const;
+
     /**
      * @brief erase Erase a key-value pair from the map.
      * @param it An iterator pointing to the key-value pair which is going to be removed.
@@ -276,6 +287,9 @@ class TrieMap {
     const_iterator end() const;
 
   protected:
+    template <typename Visitor>
+    static bool VisitSubtree(NodeType const &node, KeyType *key, Visitor &visitor);
+
     template <typename PathletNodeType>
     static Pathlet<PathletNodeType> *NextPathlet(KeyType *key,
                                                  std::vector<Pathlet<PathletNodeType>> *path);
@@ -325,11 +339,12 @@ TrieMap<KeyType, ValueType, NodeType>::NextPathlet(KeyType *key,
 
     Pathlet<PathletNodeType> *cur_pathlet = &path->back();
     while (cur_pathlet->children_it == cur_pathlet->children_end_it) {
-        key->pop_back();
         path->pop_back();
         if (path->empty()) {
             return nullptr;
         }
+        // The root has no key element.
+        key->pop_back();
         cur_pathlet = &path->back();
         ++cur_pathlet->children_it;
     }
@@ -362,6 +377,11 @@ TrieMap<KeyType, ValueType, NodeType>::iterator_base<
     if (root.node != nullptr && !root.node->value.has_value()) {
         // Need to move to the first node that forms a complete key.
         TrieMap<KeyType, ValueType, NodeType>::NextKeyPath(&key_, &path_);
+        if (path_.empty()) {
+            // The map is empty.
+            path_.push_back(Pathlet<PathletNodeType>(/*node=*/nullptr, root.children_end_it,
+                                                     root.children_end_it));
+        }
     }
 }
 
@@ -395,7 +415,13 @@ typename TrieMap<KeyType, ValueType, NodeType>::template iterator_base<PathletNo
                                                                        IteratorValueType> &
 TrieMap<KeyType, ValueType, NodeType>::iterator_base<PathletNodeType,
                                                      IteratorValueType>::operator++() {
-    this->NextValuePathFrom(&key_, &path_);
+    Pathlet<PathletNodeType> root = path_.front();
+    TrieMap<KeyType, ValueType, NodeType>::NextKeyPath(&key_, &path_);
+    if (path_.empty()) {
+        // Reached the end().
+        path_.push_back(
+            Pathlet<PathletNodeType>(/*node=*/nullptr, root.children_end_it, root.children_end_it));
+    }
     return *this;
 }
 
@@ -484,7 +510,7 @@ bool TrieMap<KeyType, ValueType, NodeType>::empty() const {
 
 template <typename KeyType, typename ValueType, typename NodeType>
 void TrieMap<KeyType, ValueType, NodeType>::clear() {
-    root_.clear();
+    root_ = std::make_unique<NodeType>();
     num_elements_ = 0;
 }
 
@@ -556,8 +582,8 @@ TrieMap<KeyType, ValueType, NodeType>::insert(std::pair<KeyType, ValueType> cons
         last_pathlet.children_end_it = exterior_node->children.end();
 
         auto inserted_node = new_node_it.first->second.get();
-        path_info.path.push_back(Pathlet<NodeType>(inserted_node, exterior_node->children.begin(),
-                                                   exterior_node->children.end()));
+        path_info.path.push_back(Pathlet<NodeType>(inserted_node, inserted_node->children.begin(),
+                                                   inserted_node->children.end()));
     }
     path_info.path.back().node->value = value;
 
@@ -565,6 +591,41 @@ TrieMap<KeyType, ValueType, NodeType>::insert(std::pair<KeyType, ValueType> cons
     return std::make_pair(iterator(key, path_info.path), true);
 }
 
+template <typename KeyType, typename ValueType, typename NodeType>
+template <typename Visitor>
+bool TrieMap<KeyType, ValueType, NodeType>::VisitSubtree(NodeType const &node, KeyType *key,
+                                                         Visitor &visitor) {
+    if (node.value.has_value() && !visitor(static_cast<KeyType const &>(*key), *node.value)) {
+        return false;
+    }
+    for (auto const &[key_elm, child] : node.children) {
+        key->push_back(key_elm);
+        bool should_continue = TrieMap::VisitSubtree(*child, key, visitor);
+        key->pop_back();
+        if (!should_continue) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename KeyType, typename ValueType, typename NodeType>
+template <typename Visitor>
+void TrieMap<KeyType, ValueType, NodeType>::visit_prefix(KeyType const &prefix,
+                                                         Visitor &&visitor) const {
+    NodeType const *cur_node = root_.get();
+    for (auto const &key_elm : prefix) {
+        auto it = cur_node->children.find(key_elm);
+        if (it == cur_node->children.end()) {
+            return;
+        }
+        cur_node = it->second.get();
+    }
+
+    KeyType key = prefix;
+    TrieMap::VisitSubtree(*cur_node, &key, visitor);
+}
+
 template <typename KeyType, typename ValueType, typename NodeType>
 void TrieMap<KeyType, ValueType, NodeType>::erase(iterator &it) {
     assert(it != this->end());
@@ -574,7 +635,8 @@ void TrieMap<KeyType, ValueType, NodeType>::erase(iterator &it) {
     node->value = std::nullopt;
 
     while (true) {
-        if (node->children.empty() && node->value.has_value()) {
+        if (!node->children.empty() || node->value.has_value()) {
+            // The node is still part of other keys.
             break;
         }
 
@@ -595,14 +657,14 @@ void TrieMap<KeyType, ValueType, NodeType>::erase(iterator &it) {
 template <typename KeyType, typename ValueType, typename NodeType>
 typename TrieMap<KeyType, ValueType, NodeType>::iterator
 TrieMap<KeyType, ValueType, NodeType>::begin() {
-    return iterator(Pathlet<NodeType>(root_.get(), root_->children.begin(), root_.children.end()));
+    return iterator(Pathlet<NodeType>(root_.get(), root_->children.begin(), root_->children.end()));
 }
 
 template <typename KeyType, typename ValueType, typename NodeType>
 typename TrieMap<KeyType, ValueType, NodeType>::const_iterator
 TrieMap<KeyType, ValueType, NodeType>::begin() const {
     return const_iterator(
-        Pathlet<NodeType const>(root_.get(), root_->children.begin(), root_.children.end()));
+        Pathlet<NodeType const>(root_.get(), root_->children.begin(), root_->children.end()));
 }
 
 template <typename KeyType, typename ValueType, typename NodeType>
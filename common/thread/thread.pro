@@ -19,7 +19,8 @@ SOURCES += \
     thread_pool.cc
 
 HEADERS += \
-    thread_pool.h
+    thread_pool.h \
+    work_stealing_deque.h
 
 # Default rules for deployment.
 unix {
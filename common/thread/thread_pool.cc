@@ -15,151 +15,269 @@
  * not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <condition_variable>
+#include <deque>
 #include <mutex>
 #include <queue>
-#include <semaphore.h>
 #include <thread>
 #include <vector>
 
 #include "common/thread/thread_pool.h"
+#include "common/thread/work_stealing_deque.h"
 
 namespace e8 {
 
 struct TaskInfo {
     std::shared_ptr<TaskInterface> task;
     std::unique_ptr<TaskStorageInterface> task_data;
-
-    TaskInfo(std::shared_ptr<TaskInterface> const &task,
-             std::unique_ptr<TaskStorageInterface> &&task_data);
-    TaskInfo(TaskInfo const &) = delete;
-    TaskInfo(TaskInfo &&other);
+    TaskCompletionChannel *channel;
 };
 
-TaskInfo::TaskInfo(std::shared_ptr<TaskInterface> const &task,
-                   std::unique_ptr<TaskStorageInterface> &&task_data)
-    : task(task), task_data(std::move(task_data)) {}
+struct TaskCompletionChannel::TaskCompletionChannelInternal {
+    void Deliver(std::unique_ptr<TaskStorageInterface> &&task_data);
+
+    std::mutex lock;
+    std::condition_variable completed;
+    std::queue<std::unique_ptr<TaskStorageInterface>> completed_task_data;
+};
 
-TaskInfo::TaskInfo(TaskInfo &&other) {
-    std::swap(other.task, task);
-    std::swap(other.task_data, task_data);
+void TaskCompletionChannel::TaskCompletionChannelInternal::Deliver(
+    std::unique_ptr<TaskStorageInterface> &&task_data) {
+    lock.lock();
+    completed_task_data.push(std::move(task_data));
+    // Notifies under the lock since the waiter may destroy the channel as soon as it gets the
+    // last task data.
+    completed.notify_one();
+    lock.unlock();
 }
 
+struct Worker {
+    WorkStealingDeque<TaskInfo> tasks;
+    std::thread thread;
+};
+
 struct ThreadPool::ThreadPoolInternal {
     ThreadPoolInternal(unsigned num_workers);
     ~ThreadPoolInternal();
 
-    std::vector<std::thread> worker_threads;
+    /**
+     * @brief Enqueue Hands the tasks to the workers and wakes up idle ones.
+     */
+    void Enqueue(TaskInfo **tasks, size_t num_tasks);
+
+    std::vector<std::unique_ptr<Worker>> workers;
 
-    sem_t task_resource;
-    sem_t sink_resource;
+    std::mutex injection_lock;
+    std::deque<TaskInfo *> injected_tasks;
 
-    std::mutex source_lock;
-    std::mutex sink_lock;
+    // The number of tasks which have been scheduled but not yet taken by a worker.
+    std::atomic<int64_t> num_queued;
+    std::atomic<unsigned> num_idle;
+    std::mutex idle_lock;
+    std::condition_variable work_available;
 
-    std::queue<TaskInfo> tasks;
-    std::queue<TaskInfo> completed_tasks;
+    std::atomic<bool> running;
 
-    bool running = true;
+    TaskCompletionChannel completion_channel;
 };
 
-template <typename OnFoundTaskFn>
-bool HasTaskAndRun(ThreadPool::ThreadPoolInternal *this_, OnFoundTaskFn on_found_task_fn) {
-    this_->source_lock.lock();
+namespace {
 
-    if (this_->tasks.empty()) {
-        this_->source_lock.unlock();
-        return false;
-    }
+// The pool and the index of the worker the current thread runs, if it's a worker thread.
+thread_local ThreadPool::ThreadPoolInternal *tls_current_pool = nullptr;
+thread_local unsigned tls_current_worker = 0;
 
-    TaskInfo info = std::move(this_->tasks.front());
-    this_->tasks.pop();
+TaskInfo *TakeTask(ThreadPool::ThreadPoolInternal *this_, unsigned worker_index) {
+    Worker *worker = this_->workers[worker_index].get();
 
-    this_->source_lock.unlock();
+    TaskInfo *task_info = worker->tasks.Pop();
+    if (task_info != nullptr) {
+        return task_info;
+    }
 
-    on_found_task_fn(std::move(info));
+    this_->injection_lock.lock();
+    if (!this_->injected_tasks.empty()) {
+        // Takes a fair share of the injected tasks so the rest of them can be stolen from this
+        // worker rather than contending for the injection queue.
+        size_t num_taken =
+            std::max(size_t{1}, this_->injected_tasks.size() / this_->workers.size());
+        task_info = this_->injected_tasks.front();
+        this_->injected_tasks.pop_front();
+        for (size_t i = 1; i < num_taken; ++i) {
+            worker->tasks.Push(this_->injected_tasks.front());
+            this_->injected_tasks.pop_front();
+        }
+    }
+    this_->injection_lock.unlock();
+    if (task_info != nullptr) {
+        return task_info;
+    }
 
-    return true;
+    for (unsigned i = 1; i < this_->workers.size(); ++i) {
+        Worker *victim = this_->workers[(worker_index + i) % this_->workers.size()].get();
+        task_info = victim->tasks.Steal();
+        if (task_info != nullptr) {
+            return task_info;
+        }
+    }
+
+    return nullptr;
 }
 
-void RunThreadPoolWorker(ThreadPool::ThreadPoolInternal *this_) {
-    auto run_task_fn = [this_](TaskInfo &&task_info) {
-        task_info.task->Run(task_info.task_data.get());
+void RunTask(ThreadPool::ThreadPoolInternal *this_, TaskInfo *task_info) {
+    task_info->task->Run(task_info->task_data.get());
 
-        if (!task_info.task->DropResourceOnCompletion()) {
-            this_->sink_lock.lock();
-            this_->completed_tasks.push(std::move(task_info));
-            this_->sink_lock.unlock();
+    if (!task_info->task->DropResourceOnCompletion()) {
+        TaskCompletionChannel *channel = task_info->channel != nullptr
+                                             ? task_info->channel
+                                             : &this_->completion_channel;
+        channel->pimpl_->Deliver(std::move(task_info->task_data));
+    }
 
-            sem_post(&this_->sink_resource);
-        }
-    };
+    delete task_info;
+}
 
-    do {
-        sem_wait(&this_->task_resource);
+void RunThreadPoolWorker(ThreadPool::ThreadPoolInternal *this_, unsigned worker_index) {
+    tls_current_pool = this_;
+    tls_current_worker = worker_index;
 
-        while (HasTaskAndRun(this_, run_task_fn)) {
-            // Do nothing.
+    while (true) {
+        TaskInfo *task_info = TakeTask(this_, worker_index);
+        if (task_info != nullptr) {
+            this_->num_queued.fetch_sub(1);
+            RunTask(this_, task_info);
+            continue;
         }
-    } while (this_->running);
+
+        // Announces being idle before checking for work so that Enqueue() either sees this
+        // worker idle or this worker sees the enqueued tasks.
+        this_->num_idle.fetch_add(1);
+        std::unique_lock<std::mutex> lock(this_->idle_lock);
+        this_->work_available.wait(
+            lock, [this_] { return this_->num_queued.load() > 0 || !this_->running.load(); });
+        lock.unlock();
+        this_->num_idle.fetch_sub(1);
+
+        if (!this_->running.load() && this_->num_queued.load() <= 0) {
+            break;
+        }
+    }
 }
 
-ThreadPool::ThreadPoolInternal::ThreadPoolInternal(unsigned num_workers) {
-    sem_init(&task_resource, 0, 0);
-    sem_init(&sink_resource, 0, 0);
+} // namespace
+
+ThreadPool::ThreadPoolInternal::ThreadPoolInternal(unsigned num_workers)
+    : num_queued(0), num_idle(0), running(true) {
+    assert(num_workers > 0);
 
     for (unsigned i = 0; i < num_workers; ++i) {
-        worker_threads.push_back(std::thread(RunThreadPoolWorker, this));
+        workers.push_back(std::make_unique<Worker>());
+    }
+    for (unsigned i = 0; i < num_workers; ++i) {
+        workers[i]->thread = std::thread(RunThreadPoolWorker, this, i);
     }
 }
 
 ThreadPool::ThreadPoolInternal::~ThreadPoolInternal() {
+    idle_lock.lock();
     running = false;
+    idle_lock.unlock();
+    work_available.notify_all();
 
-    for (unsigned i = 0; i < worker_threads.size(); ++i) {
-        sem_post(&task_resource);
+    for (auto &worker : workers) {
+        worker->thread.join();
     }
 
-    for (auto &worker : worker_threads) {
-        worker.join();
+    for (auto &worker : workers) {
+        for (TaskInfo *task_info = worker->tasks.Pop(); task_info != nullptr;
+             task_info = worker->tasks.Pop()) {
+            delete task_info;
+        }
+    }
+    for (TaskInfo *task_info : injected_tasks) {
+        delete task_info;
     }
+}
 
-    sem_destroy(&task_resource);
-    sem_destroy(&sink_resource);
+void ThreadPool::ThreadPoolInternal::Enqueue(TaskInfo **tasks, size_t num_tasks) {
+    num_queued.fetch_add(num_tasks);
+
+    if (tls_current_pool == this) {
+        // Scheduled by a running task. Keeps the tasks local to this worker; the idle ones will
+        // steal them.
+        Worker *worker = workers[tls_current_worker].get();
+        for (size_t i = 0; i < num_tasks; ++i) {
+            worker->tasks.Push(tasks[i]);
+        }
+    } else {
+        injection_lock.lock();
+        injected_tasks.insert(injected_tasks.end(), tasks, tasks + num_tasks);
+        injection_lock.unlock();
+    }
+
+    if (num_idle.load() > 0) {
+        // Makes sure the idle worker is either waiting or will see the new tasks.
+        idle_lock.lock();
+        idle_lock.unlock();
+
+        if (num_tasks == 1) {
+            work_available.notify_one();
+        } else {
+            work_available.notify_all();
+        }
+    }
 }
 
 TaskStorageInterface::~TaskStorageInterface() {}
 
 TaskInterface::~TaskInterface() {}
 
+TaskCompletionChannel::TaskCompletionChannel()
+    : pimpl_(std::make_unique<TaskCompletionChannelInternal>()) {}
+
+TaskCompletionChannel::~TaskCompletionChannel() {}
+
+std::unique_ptr<TaskStorageInterface> TaskCompletionChannel::WaitForNextCompleted() {
+    std::unique_lock<std::mutex> lock(pimpl_->lock);
+    pimpl_->completed.wait(lock, [this] { return !pimpl_->completed_task_data.empty(); });
+
+    std::unique_ptr<TaskStorageInterface> task_data =
+        std::move(pimpl_->completed_task_data.front());
+    pimpl_->completed_task_data.pop();
+
+    return task_data;
+}
+
 ThreadPool::ThreadPool(unsigned num_workers)
     : pimpl_(std::make_unique<ThreadPoolInternal>(num_workers)) {}
 
 ThreadPool::~ThreadPool() {}
 
 void ThreadPool::Schedule(std::shared_ptr<TaskInterface> task,
-                          std::unique_ptr<TaskStorageInterface> &&task_data) {
-    pimpl_->source_lock.lock();
-    pimpl_->tasks.push(TaskInfo(task, std::move(task_data)));
-    pimpl_->source_lock.unlock();
+                          std::unique_ptr<TaskStorageInterface> &&task_data,
+                          TaskCompletionChannel *channel) {
+    TaskInfo *task_info = new TaskInfo{std::move(task), std::move(task_data), channel};
+    pimpl_->Enqueue(&task_info, 1);
+}
 
-    sem_post(&pimpl_->task_resource);
+void ThreadPool::ScheduleMany(std::shared_ptr<TaskInterface> const &task,
+                              std::vector<std::unique_ptr<TaskStorageInterface>> &&task_data,
+                              TaskCompletionChannel *channel) {
+    std::vector<TaskInfo *> task_infos;
+    task_infos.reserve(task_data.size());
+    for (auto &data : task_data) {
+        task_infos.push_back(new TaskInfo{task, std::move(data), channel});
+    }
+    pimpl_->Enqueue(task_infos.data(), task_infos.size());
 }
 
 std::unique_ptr<TaskStorageInterface> ThreadPool::WaitForNextCompleted() {
-    sem_wait(&pimpl_->sink_resource);
-
-    pimpl_->sink_lock.lock();
-
-    assert(!pimpl_->completed_tasks.empty());
-    TaskInfo task_info = std::move(pimpl_->completed_tasks.front());
-    pimpl_->completed_tasks.pop();
-
-    pimpl_->sink_lock.unlock();
-
-    return std::move(task_info.task_data);
+    return pimpl_->completion_channel.WaitForNextCompleted();
 }
 
-unsigned ThreadPool::NumWorkers() const { return pimpl_->worker_threads.size(); }
+unsigned ThreadPool::NumWorkers() const { return pimpl_->workers.size(); }
 
 } // namespace e8
@@ -20,6 +20,7 @@
 
 #include <memory>
 #include <thread>
+#include <vector>
 
 namespace e8 {
 
@@ -53,7 +54,35 @@ class TaskInterface {
 };
 
 /**
- * @brief The ThreadPool class A pool of native worker threads invoking tasks in parallel.
+ * @brief The TaskCompletionChannel class Receives the task storages of completed tasks. A
+ * submitter that shares a thread pool with others schedules its tasks with its own channel, so
+ * the results it waits for can't be taken by someone else.
+ */
+class TaskCompletionChannel {
+  public:
+    TaskCompletionChannel();
+    TaskCompletionChannel(TaskCompletionChannel const &) = delete;
+    ~TaskCompletionChannel();
+
+    /**
+     * @brief WaitForNextCompleted Wait for the next task scheduled with this channel to be
+     * completed and return the tasks' data. If there isn't and won't be any task being scheduled
+     * with this channel, calling this function will result in dead lock.
+     */
+    std::unique_ptr<TaskStorageInterface> WaitForNextCompleted();
+
+  public:
+    struct TaskCompletionChannelInternal;
+
+    std::unique_ptr<TaskCompletionChannelInternal> pimpl_;
+};
+
+/**
+ * @brief The ThreadPool class A pool of native worker threads invoking tasks in parallel. Each
+ * worker keeps a work-stealing deque of tasks. Tasks scheduled from outside of the pool land in a
+ * shared injection queue which idle workers drain in chunks, and tasks scheduled by a running task
+ * go straight into the deque of the worker running it. A worker which runs out of tasks steals
+ * from the others before going to sleep.
  */
 class ThreadPool {
   public:
@@ -64,20 +93,34 @@ class ThreadPool {
     ~ThreadPool();
 
     /**
-     * @brief Schedule Add the task into a queue hence the task will be scheduled in a
-     * first-come-first-serve manner. One can make multiple Run() call with the same task but
-     * different task_data, so that a single task can process different data.
+     * @brief Schedule Add the task into a queue hence the task will be scheduled. Tasks scheduled
+     * from outside of the pool are picked up roughly in a first-come-first-serve manner. One can
+     * make multiple Run() call with the same task but different task_data, so that a single task
+     * can process different data.
      *
      * @param task Task to be scheduled and invoked.
      * @param task_data Task data to pass in with the given task.
+     * @param channel The channel to deliver the task data to on completion. If it's nullptr, the
+     * data will be delivered to the pool's own channel, see WaitForNextCompleted(). It's ignored
+     * if the task drops its resource on completion.
      */
     void Schedule(std::shared_ptr<TaskInterface> task,
-                  std::unique_ptr<TaskStorageInterface> &&task_data = nullptr);
+                  std::unique_ptr<TaskStorageInterface> &&task_data = nullptr,
+                  TaskCompletionChannel *channel = nullptr);
+
+    /**
+     * @brief ScheduleMany Schedules the task once for each of the task data in one go. It's
+     * equivalent to calling Schedule() on each of the task data, but contends for the queue only
+     * once.
+     */
+    void ScheduleMany(std::shared_ptr<TaskInterface> const &task,
+                      std::vector<std::unique_ptr<TaskStorageInterface>> &&task_data,
+                      TaskCompletionChannel *channel = nullptr);
 
     /**
-     * @brief WaitForNextCompleted Wait for the next task to be completed and return the tasks'
-     * data. If there isn't and won't be any task being scheduled, calling this function will result
-     * in dead lock.
+     * @brief WaitForNextCompleted Wait for the next task scheduled without a channel to be
+     * completed and return the tasks' data. If there isn't and won't be any task being scheduled,
+     * calling this function will result in dead lock.
      */
     std::unique_ptr<TaskStorageInterface> WaitForNextCompleted();
 
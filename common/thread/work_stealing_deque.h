@@ -0,0 +1,181 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WORK_STEALING_DEQUE_H
+#define WORK_STEALING_DEQUE_H
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace e8 {
+
+/**
+ * @brief The WorkStealingDeque class A Chase-Lev work-stealing deque of pointers. The owner thread
+ * pushes and pops at the bottom without taking a lock, while any other thread can steal from the
+ * top. Only the top end is contended. The ring buffer grows on demand; the outgrown buffers are
+ * kept until the deque is destroyed since a thief may still be reading from them.
+ */
+template <typename T> class WorkStealingDeque {
+  public:
+    /**
+     * @brief WorkStealingDeque Constructs an empty deque.
+     *
+     * @param initial_capacity Must be a power of 2.
+     */
+    WorkStealingDeque(int64_t initial_capacity = 256);
+    WorkStealingDeque(WorkStealingDeque const &) = delete;
+    ~WorkStealingDeque() = default;
+
+    /**
+     * @brief Push Adds an item to the bottom. It can only be called by the owner.
+     */
+    void Push(T *item);
+
+    /**
+     * @brief Pop Takes the most recently pushed item. It can only be called by the owner.
+     *
+     * @return nullptr if the deque is empty.
+     */
+    T *Pop();
+
+    /**
+     * @brief Steal Takes the least recently pushed item. It can be called by any thread.
+     *
+     * @return nullptr if the deque is empty or another thread has taken the item concurrently.
+     */
+    T *Steal();
+
+    /**
+     * @brief Empty Whether the deque looks empty at the moment.
+     */
+    bool Empty() const;
+
+  private:
+    struct Buffer {
+        Buffer(int64_t capacity);
+
+        T *Get(int64_t i) const;
+        void Put(int64_t i, T *item);
+
+        int64_t const capacity;
+        std::unique_ptr<std::atomic<T *>[]> slots;
+    };
+
+    Buffer *Grow(Buffer *buffer, int64_t bottom, int64_t top);
+
+    std::atomic<int64_t> top_;
+    std::atomic<int64_t> bottom_;
+    std::atomic<Buffer *> buffer_;
+    std::vector<std::unique_ptr<Buffer>> buffers_;
+};
+
+template <typename T>
+WorkStealingDeque<T>::Buffer::Buffer(int64_t capacity)
+    : capacity(capacity), slots(std::make_unique<std::atomic<T *>[]>(capacity)) {
+    assert((capacity & (capacity - 1)) == 0);
+}
+
+template <typename T> T *WorkStealingDeque<T>::Buffer::Get(int64_t i) const {
+    // The acquire load pairs with the release store in Put() so that whatever the pushing thread
+    // has written into the item is visible to the thief.
+    return slots[i & (capacity - 1)].load(std::memory_order_acquire);
+}
+
+template <typename T> void WorkStealingDeque<T>::Buffer::Put(int64_t i, T *item) {
+    slots[i & (capacity - 1)].store(item, std::memory_order_release);
+}
+
+template <typename T>
+WorkStealingDeque<T>::WorkStealingDeque(int64_t initial_capacity) : top_(0), bottom_(0) {
+    buffers_.push_back(std::make_unique<Buffer>(initial_capacity));
+    buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+}
+
+template <typename T>
+typename WorkStealingDeque<T>::Buffer *WorkStealingDeque<T>::Grow(Buffer *buffer, int64_t bottom,
+                                                                  int64_t top) {
+    auto grown = std::make_unique<Buffer>(buffer->capacity * 2);
+    for (int64_t i = top; i < bottom; ++i) {
+        grown->Put(i, buffer->Get(i));
+    }
+    buffers_.push_back(std::move(grown));
+    buffer_.store(buffers_.back().get(), std::memory_order_release);
+    return buffers_.back().get();
+}
+
+template <typename T> void WorkStealingDeque<T>::Push(T *item) {
+    int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    int64_t top = top_.load(std::memory_order_acquire);
+    Buffer *buffer = buffer_.load(std::memory_order_relaxed);
+    if (bottom - top > buffer->capacity - 1) {
+        buffer = this->Grow(buffer, bottom, top);
+    }
+    buffer->Put(bottom, item);
+    bottom_.store(bottom + 1, std::memory_order_release);
+}
+
+template <typename T> T *WorkStealingDeque<T>::Pop() {
+    int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    Buffer *buffer = buffer_.load(std::memory_order_relaxed);
+    bottom_.store(bottom, std::memory_order_seq_cst);
+    int64_t top = top_.load(std::memory_order_seq_cst);
+
+    if (top > bottom) {
+        // Empty.
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    T *item = buffer->Get(bottom);
+    if (top == bottom) {
+        // The last item, which a thief may be taking at the same time.
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            item = nullptr;
+        }
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return item;
+}
+
+template <typename T> T *WorkStealingDeque<T>::Steal() {
+    int64_t top = top_.load(std::memory_order_seq_cst);
+    int64_t bottom = bottom_.load(std::memory_order_seq_cst);
+    if (top >= bottom) {
+        return nullptr;
+    }
+
+    Buffer *buffer = buffer_.load(std::memory_order_acquire);
+    T *item = buffer->Get(top);
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+        // Lost the race against the owner or another thief.
+        return nullptr;
+    }
+    return item;
+}
+
+template <typename T> bool WorkStealingDeque<T>::Empty() const {
+    return top_.load(std::memory_order_relaxed) >= bottom_.load(std::memory_order_relaxed);
+}
+
+} // namespace e8
+
+#endif // WORK_STEALING_DEQUE_H
@@ -24,6 +24,7 @@
 #include "demoweb_service/demoweb/common_entity/user_entity.h"
 #include "demoweb_service/demoweb/environment/test_environment_context.h"
 #include "demoweb_service/demoweb/module/chat_message.h"
+#include "demoweb_service/demoweb/module/chat_message_cache.h"
 #include "demoweb_service/demoweb/module/chat_message_group_storage.h"
 #include "demoweb_service/demoweb/module/message_channel_storage.h"
 #include "demoweb_service/demoweb/module/user_storage.h"
@@ -52,8 +53,9 @@ bool SendAndGetChatMessageTest() {
     std::optional<e8::SendChatMessageResult> result = e8::SendChatMessage(
         *user->id.Value(), *chat_message_group->id.Value(), /*texts=*/{"message1"},
         /*media_file_formats=*/std::vector<e8::FileFormat>(),
-        /*binary_file_formats=*/std::vector<e8::FileFormat>(), env.MessageChannelPbac(),
-        env.KeyGen(), env.DemowebDatabase());
+        /*binary_file_formats=*/std::vector<e8::FileFormat>(), env.CurrentHostId(),
+        env.ClientPushMessagePublishers(), env.BackgroundTasks(), env.MessageChannelPbac(),
+        env.KeyGen(), /*cache=*/nullptr, env.PublicProfiles(), env.DemowebDatabase());
 
     TEST_CONDITION(result.has_value());
     TEST_CONDITION(result->message.message_seq_id() != 0);
@@ -68,11 +70,15 @@ bool SendAndGetChatMessageTest() {
     e8::SendChatMessage(*user->id.Value(), *chat_message_group->id.Value(), /*texts=*/{"message2"},
                         /*media_file_formats=*/std::vector<e8::FileFormat>(),
                         /*binary_file_formats=*/std::vector<e8::FileFormat>(),
-                        env.MessageChannelPbac(), env.KeyGen(), env.DemowebDatabase());
+                        env.CurrentHostId(), env.ClientPushMessagePublishers(),
+                        env.BackgroundTasks(), env.MessageChannelPbac(), env.KeyGen(),
+                        /*cache=*/nullptr, env.PublicProfiles(), env.DemowebDatabase());
     e8::SendChatMessage(*user->id.Value(), *chat_message_group->id.Value(), /*texts=*/{"message3"},
                         /*media_file_formats=*/std::vector<e8::FileFormat>(),
                         /*binary_file_formats=*/std::vector<e8::FileFormat>(),
-                        env.MessageChannelPbac(), env.KeyGen(), env.DemowebDatabase());
+                        env.CurrentHostId(), env.ClientPushMessagePublishers(),
+                        env.BackgroundTasks(), env.MessageChannelPbac(), env.KeyGen(),
+                        /*cache=*/nullptr, env.PublicProfiles(), env.DemowebDatabase());
 
     // Fetch those messages back.
     e8::Pagination page1;
@@ -81,7 +87,8 @@ bool SendAndGetChatMessageTest() {
 
     std::vector<e8::ChatMessageEntry> page1_messages =
         e8::GetChatMessages(*user->id.Value(), *chat_message_group->id.Value(), page1,
-                            env.MessageChannelPbac(), env.KeyGen(), env.DemowebDatabase());
+                            env.MessageChannelPbac(), env.KeyGen(), /*cache=*/nullptr,
+                            env.PublicProfiles(), env.DemowebDatabase());
 
     TEST_CONDITION(page1_messages.size() == 2);
 
@@ -102,7 +109,8 @@ bool SendAndGetChatMessageTest() {
 
     std::vector<e8::ChatMessageEntry> page2_messages =
         e8::GetChatMessages(*user->id.Value(), *chat_message_group->id.Value(), page2,
-                            env.MessageChannelPbac(), env.KeyGen(), env.DemowebDatabase());
+                            env.MessageChannelPbac(), env.KeyGen(), /*cache=*/nullptr,
+                            env.PublicProfiles(), env.DemowebDatabase());
 
     TEST_CONDITION(page2_messages.size() == 1);
 
@@ -112,9 +120,101 @@ bool SendAndGetChatMessageTest() {
     return true;
 }
 
+bool CachedGetChatMessagesTest() {
+    e8::DemoWebTestEnvironmentContext env;
+    e8::ChatMessageCache cache(/*max_num_groups=*/10, /*max_num_messages_per_group=*/2,
+                               /*time_to_live=*/60LL * 1000 * 1000);
+
+    std::optional<e8::UserEntity> user = e8::CreateUser(
+        /*security_key=*/std::string(), /*user_group_names=*/std::vector<std::string>(),
+        /*user_id=*/1L, env.CurrentHostId(), env.DemowebDatabase());
+    e8::MessageChannelEntity message_channel =
+        e8::CreateMessageChannel(/*channe_name=*/std::string(), /*description=*/std::string(),
+                                 /*encrypted=*/false, /*close_group_channel=*/false,
+                                 env.CurrentHostId(), env.DemowebDatabase());
+    e8::CreateMessageChannelMembership(*message_channel.id.Value(), *user->id.Value(),
+                                       /*member_type=*/e8::MCMT_ADMIN, env.DemowebDatabase());
+    std::optional<e8::ChatMessageGroupEntity> chat_message_group = e8::CreateChatMessageGroup(
+        *user->id.Value(), *message_channel.id.Value(),
+        /*group_title=*/std::string(), /*thread_type=*/e8::CMTT_TEMPORAL, env.CurrentHostId(),
+        env.MessageChannelPbac(), env.DemowebDatabase());
+
+    for (char const *text : {"message1", "message2", "message3"}) {
+        e8::SendChatMessage(*user->id.Value(), *chat_message_group->id.Value(), /*texts=*/{text},
+                            /*media_file_formats=*/std::vector<e8::FileFormat>(),
+                            /*binary_file_formats=*/std::vector<e8::FileFormat>(),
+                            env.CurrentHostId(), env.ClientPushMessagePublishers(),
+                            env.BackgroundTasks(), env.MessageChannelPbac(), env.KeyGen(), &cache,
+                            env.PublicProfiles(), env.DemowebDatabase());
+    }
+
+    e8::Pagination page2;
+    page2.set_page_number(1);
+    page2.set_result_per_page(2);
+
+    // The first read fills the cache from the database.
+    std::vector<e8::ChatMessageEntry> uncached_messages =
+        e8::GetChatMessages(*user->id.Value(), *chat_message_group->id.Value(), page2,
+                            env.MessageChannelPbac(), env.KeyGen(), &cache, env.PublicProfiles(),
+                            env.DemowebDatabase());
+    TEST_CONDITION(cache.GetStats().num_misses == 1);
+    TEST_CONDITION(cache.GetStats().num_hits == 0);
+
+    std::vector<e8::ChatMessageEntry> cached_messages =
+        e8::GetChatMessages(*user->id.Value(), *chat_message_group->id.Value(), page2,
+                            env.MessageChannelPbac(), env.KeyGen(), &cache, env.PublicProfiles(),
+                            env.DemowebDatabase());
+    TEST_CONDITION(cache.GetStats().num_hits == 1);
+
+    TEST_CONDITION(uncached_messages.size() == 1);
+    TEST_CONDITION(cached_messages.size() == 1);
+    TEST_CONDITION(cached_messages[0].message_seq_id() == uncached_messages[0].message_seq_id());
+    TEST_CONDITION(cached_messages[0].texts()[0] == "message3");
+
+    // The first page is older than what the cache keeps.
+    e8::Pagination page1;
+    page1.set_page_number(0);
+    page1.set_result_per_page(2);
+
+    std::vector<e8::ChatMessageEntry> page1_messages =
+        e8::GetChatMessages(*user->id.Value(), *chat_message_group->id.Value(), page1,
+                            env.MessageChannelPbac(), env.KeyGen(), &cache, env.PublicProfiles(),
+                            env.DemowebDatabase());
+    TEST_CONDITION(cache.GetStats().num_misses == 2);
+    TEST_CONDITION(page1_messages.size() == 2);
+    TEST_CONDITION(page1_messages[0].texts()[0] == "message1");
+
+    // New messages are written through.
+    e8::SendChatMessage(*user->id.Value(), *chat_message_group->id.Value(), /*texts=*/{"message4"},
+                        /*media_file_formats=*/std::vector<e8::FileFormat>(),
+                        /*binary_file_formats=*/std::vector<e8::FileFormat>(),
+                        env.CurrentHostId(), env.ClientPushMessagePublishers(),
+                        env.BackgroundTasks(), env.MessageChannelPbac(), env.KeyGen(), &cache,
+                        env.PublicProfiles(), env.DemowebDatabase());
+
+    std::vector<e8::ChatMessageEntry> written_through_messages =
+        e8::GetChatMessages(*user->id.Value(), *chat_message_group->id.Value(), page2,
+                            env.MessageChannelPbac(), env.KeyGen(), &cache, env.PublicProfiles(),
+                            env.DemowebDatabase());
+    TEST_CONDITION(cache.GetStats().num_hits == 2);
+    TEST_CONDITION(written_through_messages.size() == 2);
+    TEST_CONDITION(written_through_messages[0].texts()[0] == "message3");
+    TEST_CONDITION(written_through_messages[1].texts()[0] == "message4");
+
+    // Readers outside of the message channel can't read from the cache.
+    std::vector<e8::ChatMessageEntry> denied_messages = e8::GetChatMessages(
+        /*viewer_id=*/*user->id.Value() + 1, *chat_message_group->id.Value(), page2,
+        env.MessageChannelPbac(), env.KeyGen(), &cache, env.PublicProfiles(),
+        env.DemowebDatabase());
+    TEST_CONDITION(denied_messages.empty());
+
+    return true;
+}
+
 int main() {
     e8::BeginTestSuite("chat_message");
     e8::RunTest("SendAndGetChatMessageTest", SendAndGetChatMessageTest);
+    e8::RunTest("CachedGetChatMessagesTest", CachedGetChatMessagesTest);
     e8::EndTestSuite();
     return 0;
 }
@@ -0,0 +1,235 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "common/unit_test_util/unit_test_util.h"
+#include "demoweb_service/demoweb/module/chat_message_cache.h"
+#include "proto_cc/chat_message.pb.h"
+#include "proto_cc/pagination.pb.h"
+
+namespace {
+
+e8::ChatMessageGroupId const kGroupId = 1;
+e8::MessageChannelId const kChannelId = 2;
+e8::TimestampMicros const kTimeToLive = 60LL * 1000 * 1000;
+
+e8::ChatMessageEntry MakeEntry(e8::ChatMessageGroupId const group_id, int64_t const seq_id) {
+    e8::ChatMessageEntry entry;
+    entry.set_thread_id(group_id);
+    entry.set_message_seq_id(seq_id);
+    return entry;
+}
+
+std::vector<e8::ChatMessageEntry> MakeEntries(e8::ChatMessageGroupId const group_id,
+                                              int64_t const first_seq_id,
+                                              int64_t const last_seq_id) {
+    std::vector<e8::ChatMessageEntry> entries;
+    for (int64_t seq_id = first_seq_id; seq_id <= last_seq_id; ++seq_id) {
+        entries.push_back(MakeEntry(group_id, seq_id));
+    }
+    return entries;
+}
+
+e8::Pagination MakePage(unsigned const page_number, unsigned const result_per_page) {
+    e8::Pagination page;
+    page.set_page_number(page_number);
+    page.set_result_per_page(result_per_page);
+    return page;
+}
+
+} // namespace
+
+bool ReadWithinWindowTest() {
+    e8::ChatMessageCache cache(/*max_num_groups=*/10, /*max_num_messages_per_group=*/4,
+                               kTimeToLive);
+
+    TEST_CONDITION(!cache.Read(kGroupId, MakePage(0, 2)).has_value());
+
+    e8::ChatMessageCache::FillTicket ticket = cache.BeginFill(kGroupId);
+    cache.CompleteFill(kGroupId, ticket, kChannelId, MakeEntries(kGroupId, 7, 10),
+                       /*num_messages=*/10);
+
+    // Messages of indices [6, 10) are cached.
+    std::optional<e8::ChatMessageCache::CachedPage> last_page =
+        cache.Read(kGroupId, MakePage(/*page_number=*/3, /*result_per_page=*/3));
+    TEST_CONDITION(last_page.has_value());
+    TEST_CONDITION(last_page->channel_id == kChannelId);
+    TEST_CONDITION(last_page->entries.size() == 1);
+    TEST_CONDITION(last_page->entries[0].message_seq_id() == 10);
+
+    std::optional<e8::ChatMessageCache::CachedPage> middle_page =
+        cache.Read(kGroupId, MakePage(/*page_number=*/2, /*result_per_page=*/3));
+    TEST_CONDITION(middle_page.has_value());
+    TEST_CONDITION(middle_page->entries.size() == 3);
+    TEST_CONDITION(middle_page->entries[0].message_seq_id() == 7);
+    TEST_CONDITION(middle_page->entries[2].message_seq_id() == 9);
+
+    std::optional<e8::ChatMessageCache::CachedPage> beyond_page =
+        cache.Read(kGroupId, MakePage(/*page_number=*/5, /*result_per_page=*/3));
+    TEST_CONDITION(beyond_page.has_value());
+    TEST_CONDITION(beyond_page->entries.empty());
+
+    TEST_CONDITION(!cache.Read(kGroupId, MakePage(/*page_number=*/1, /*result_per_page=*/3))
+                        .has_value());
+    TEST_CONDITION(!cache.Read(kGroupId, /*pagination=*/std::nullopt).has_value());
+
+    e8::ChatMessageCache::Stats stats = cache.GetStats();
+    TEST_CONDITION(stats.num_hits == 3);
+    TEST_CONDITION(stats.num_misses == 3);
+    TEST_CONDITION(stats.HitRatio() == 0.5f);
+
+    return true;
+}
+
+bool ReadWholeGroupTest() {
+    e8::ChatMessageCache cache(/*max_num_groups=*/10, /*max_num_messages_per_group=*/4,
+                               kTimeToLive);
+
+    e8::ChatMessageCache::FillTicket ticket = cache.BeginFill(kGroupId);
+    cache.CompleteFill(kGroupId, ticket, kChannelId, MakeEntries(kGroupId, 1, 3),
+                       /*num_messages=*/3);
+
+    std::optional<e8::ChatMessageCache::CachedPage> page =
+        cache.Read(kGroupId, /*pagination=*/std::nullopt);
+    TEST_CONDITION(page.has_value());
+    TEST_CONDITION(page->entries.size() == 3);
+
+    return true;
+}
+
+bool AppendTest() {
+    e8::ChatMessageCache cache(/*max_num_groups=*/10, /*max_num_messages_per_group=*/3,
+                               kTimeToLive);
+
+    e8::ChatMessageCache::FillTicket ticket = cache.BeginFill(kGroupId);
+    cache.CompleteFill(kGroupId, ticket, kChannelId, MakeEntries(kGroupId, 1, 2),
+                       /*num_messages=*/2);
+
+    // Out of order and duplicated appends.
+    cache.Append(MakeEntry(kGroupId, 4));
+    cache.Append(MakeEntry(kGroupId, 3));
+    cache.Append(MakeEntry(kGroupId, 4));
+
+    std::optional<e8::ChatMessageCache::CachedPage> page =
+        cache.Read(kGroupId, MakePage(/*page_number=*/1, /*result_per_page=*/2));
+    TEST_CONDITION(page.has_value());
+    TEST_CONDITION(page->entries.size() == 2);
+    TEST_CONDITION(page->entries[0].message_seq_id() == 3);
+    TEST_CONDITION(page->entries[1].message_seq_id() == 4);
+
+    // The window slides forward.
+    TEST_CONDITION(!cache.Read(kGroupId, MakePage(/*page_number=*/0, /*result_per_page=*/2))
+                        .has_value());
+
+    // Appending to an uncached group has no effect.
+    cache.Append(MakeEntry(kGroupId + 1, 1));
+    TEST_CONDITION(!cache.Contains(kGroupId + 1));
+
+    return true;
+}
+
+bool AppendOlderThanWindowTest() {
+    e8::ChatMessageCache cache(/*max_num_groups=*/10, /*max_num_messages_per_group=*/2,
+                               kTimeToLive);
+
+    e8::ChatMessageCache::FillTicket ticket = cache.BeginFill(kGroupId);
+    cache.CompleteFill(kGroupId, ticket, kChannelId, MakeEntries(kGroupId, 5, 6),
+                       /*num_messages=*/6);
+
+    cache.Append(MakeEntry(kGroupId, 4));
+    TEST_CONDITION(!cache.Contains(kGroupId));
+
+    return true;
+}
+
+bool FillRacingWithAppendTest() {
+    e8::ChatMessageCache cache(/*max_num_groups=*/10, /*max_num_messages_per_group=*/4,
+                               kTimeToLive);
+
+    e8::ChatMessageCache::FillTicket ticket = cache.BeginFill(kGroupId);
+    cache.Append(MakeEntry(kGroupId, 3));
+    cache.CompleteFill(kGroupId, ticket, kChannelId, MakeEntries(kGroupId, 1, 2),
+                       /*num_messages=*/2);
+    TEST_CONDITION(!cache.Contains(kGroupId));
+
+    // A stale fill can't override a newer one.
+    e8::ChatMessageCache::FillTicket stale_ticket = cache.BeginFill(kGroupId);
+    e8::ChatMessageCache::FillTicket fresh_ticket = cache.BeginFill(kGroupId);
+    cache.CompleteFill(kGroupId, stale_ticket, kChannelId, MakeEntries(kGroupId, 1, 2),
+                       /*num_messages=*/2);
+    TEST_CONDITION(!cache.Contains(kGroupId));
+    cache.CompleteFill(kGroupId, fresh_ticket, kChannelId, MakeEntries(kGroupId, 1, 3),
+                       /*num_messages=*/3);
+    TEST_CONDITION(cache.Contains(kGroupId));
+
+    return true;
+}
+
+bool EvictionTest() {
+    e8::ChatMessageCache cache(/*max_num_groups=*/2, /*max_num_messages_per_group=*/4,
+                               kTimeToLive);
+
+    for (e8::ChatMessageGroupId group_id = 1; group_id <= 2; ++group_id) {
+        e8::ChatMessageCache::FillTicket ticket = cache.BeginFill(group_id);
+        cache.CompleteFill(group_id, ticket, kChannelId, MakeEntries(group_id, 1, 2),
+                           /*num_messages=*/2);
+    }
+
+    // Makes group 1 the most recently used one.
+    TEST_CONDITION(cache.Read(/*group_id=*/1, std::nullopt).has_value());
+
+    e8::ChatMessageCache::FillTicket ticket = cache.BeginFill(/*group_id=*/3);
+    cache.CompleteFill(/*group_id=*/3, ticket, kChannelId, MakeEntries(/*group_id=*/3, 1, 2),
+                       /*num_messages=*/2);
+
+    TEST_CONDITION(cache.Contains(/*group_id=*/1));
+    TEST_CONDITION(!cache.Contains(/*group_id=*/2));
+    TEST_CONDITION(cache.Contains(/*group_id=*/3));
+    TEST_CONDITION(cache.GetStats().num_evictions == 1);
+
+    return true;
+}
+
+bool ExpirationTest() {
+    e8::ChatMessageCache cache(/*max_num_groups=*/10, /*max_num_messages_per_group=*/4,
+                               /*time_to_live=*/-1);
+
+    e8::ChatMessageCache::FillTicket ticket = cache.BeginFill(kGroupId);
+    cache.CompleteFill(kGroupId, ticket, kChannelId, MakeEntries(kGroupId, 1, 2),
+                       /*num_messages=*/2);
+
+    TEST_CONDITION(!cache.Read(kGroupId, std::nullopt).has_value());
+    TEST_CONDITION(!cache.Contains(kGroupId));
+
+    return true;
+}
+
+int main() {
+    e8::BeginTestSuite("chat_message_cache");
+    e8::RunTest("ReadWithinWindowTest", ReadWithinWindowTest);
+    e8::RunTest("ReadWholeGroupTest", ReadWholeGroupTest);
+    e8::RunTest("AppendTest", AppendTest);
+    e8::RunTest("AppendOlderThanWindowTest", AppendOlderThanWindowTest);
+    e8::RunTest("FillRacingWithAppendTest", FillRacingWithAppendTest);
+    e8::RunTest("EvictionTest", EvictionTest);
+    e8::RunTest("ExpirationTest", ExpirationTest);
+    e8::EndTestSuite();
+    return 0;
+}
@@ -122,14 +122,15 @@ bool GetChatMessageGroupsWithChatMessageSummaryListTest() {
         e8::GetChatMessageGroupsWithChatMessageSummaryList(
             *creator->id.Value(), *empty_message_channel.id.Value(),
             /*max_num_messages_per_group=*/2, page1, env.MessageChannelPbac(), env.KeyGen(),
-            env.DemowebDatabase());
+            env.PublicProfiles(), env.DemowebDatabase());
 
     TEST_CONDITION(fetched_empty_page1.empty());
 
     std::vector<e8::ChatMessageThread> fetched_page1 =
         e8::GetChatMessageGroupsWithChatMessageSummaryList(
             *creator->id.Value(), *message_channel.id.Value(), /*max_num_messages_per_group=*/2,
-            page1, env.MessageChannelPbac(), env.KeyGen(), env.DemowebDatabase());
+            page1, env.MessageChannelPbac(), env.KeyGen(), env.PublicProfiles(),
+            env.DemowebDatabase());
 
     TEST_CONDITION(fetched_page1.size() == 2);
 
@@ -159,7 +160,8 @@ bool GetChatMessageGroupsWithChatMessageSummaryListTest() {
     std::vector<e8::ChatMessageThread> fetched_page2 =
         e8::GetChatMessageGroupsWithChatMessageSummaryList(
             *creator->id.Value(), *message_channel.id.Value(), /*max_num_messages_per_group=*/2,
-            page2, env.MessageChannelPbac(), env.KeyGen(), env.DemowebDatabase());
+            page2, env.MessageChannelPbac(), env.KeyGen(), env.PublicProfiles(),
+            env.DemowebDatabase());
 
     TEST_CONDITION(fetched_page2.size() == 1);
 
@@ -17,9 +17,12 @@
 
 #include <optional>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include "common/unit_test_util/unit_test_util.h"
+#include "demoweb_service/demoweb/common_entity/chat_message_entity.h"
+#include "demoweb_service/demoweb/common_entity/chat_message_group_entity.h"
 #include "demoweb_service/demoweb/common_entity/user_entity.h"
 #include "demoweb_service/demoweb/environment/test_environment_context.h"
 #include "demoweb_service/demoweb/module/chat_message_group_storage.h"
@@ -67,9 +70,56 @@ bool CreateAndFetchChatMessageTest() {
     return true;
 }
 
+bool CreateChatMessageAndTouchGroupTest() {
+    e8::DemoWebTestEnvironmentContext env;
+
+    std::optional<e8::UserEntity> user =
+        e8::CreateUser(/*security_key=*/"", /*user_group_names=*/std::vector<std::string>(),
+                       /*user_id=*/1L, /*host_id=*/env.CurrentHostId(), env.DemowebDatabase());
+
+    e8::MessageChannelEntity channel = e8::CreateMessageChannel(
+        /*channel_name=*/std::nullopt, /*description=*/std::nullopt, /*encrypted=*/false,
+        /*close_group_channel=*/false, env.CurrentHostId(), env.DemowebDatabase());
+
+    e8::ChatMessageGroupEntity group =
+        e8::CreateChatMessageGroup(*user->id.Value(), *channel.id.Value(),
+                                   /*group_title=*/"Test chat message group", e8::CMTT_POPUP,
+                                   env.CurrentHostId(), env.DemowebDatabase());
+
+    auto [chat_message, sender] = e8::CreateChatMessageAndTouchGroup(
+        *group.id.Value(), *user->id.Value(),
+        /*text_entries=*/std::vector<std::string>{"Hey", "Good morning."},
+        /*binary_content_paths=*/std::vector<std::string>(), /*touch_group=*/true,
+        env.DemowebDatabase());
+
+    TEST_CONDITION(*sender.id.Value() == *user->id.Value());
+    TEST_CONDITION(*chat_message.sender_id.Value() == *user->id.Value());
+    TEST_CONDITION(*chat_message.created_at.Value() > 0);
+
+    std::optional<e8::ChatMessageEntity> fetched = e8::FetchChatMessage(
+        std::make_tuple(*chat_message.group_id.Value(), *chat_message.message_seq_id.Value()),
+        env.DemowebDatabase());
+
+    TEST_CONDITION(fetched.has_value());
+    TEST_CONDITION(*fetched->group_id.Value() == group.id.Value());
+    TEST_CONDITION(fetched->text_entries.Value().size() == 2);
+    TEST_CONDITION(fetched->text_entries.Value()[0] == "Hey");
+    TEST_CONDITION(fetched->text_entries.Value()[1] == "Good morning.");
+    TEST_CONDITION(*fetched->created_at.Value() == *chat_message.created_at.Value());
+
+    std::optional<e8::ChatMessageGroupEntity> touched_group =
+        e8::FetchChatMessageGroup(*group.id.Value(), env.DemowebDatabase());
+    TEST_CONDITION(touched_group.has_value());
+    TEST_CONDITION(*touched_group->last_interaction_at.Value() ==
+                   *chat_message.created_at.Value());
+
+    return true;
+}
+
 int main() {
     e8::BeginTestSuite("chat_message_storage");
     e8::RunTest("CreateAndFetchChatMessageTest", CreateAndFetchChatMessageTest);
+    e8::RunTest("CreateChatMessageAndTouchGroupTest", CreateChatMessageAndTouchGroupTest);
     e8::EndTestSuite();
     return 0;
 }
@@ -0,0 +1,91 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "common/time_util/time_util.h"
+#include "common/unit_test_util/unit_test_util.h"
+#include "demoweb_service/demoweb/common_entity/chat_message_entity.h"
+#include "demoweb_service/demoweb/common_entity/chat_message_group_entity.h"
+#include "demoweb_service/demoweb/common_entity/user_entity.h"
+#include "demoweb_service/demoweb/constant/demoweb_database.h"
+#include "demoweb_service/demoweb/environment/test_environment_context.h"
+#include "demoweb_service/demoweb/module/chat_message_group_storage.h"
+#include "demoweb_service/demoweb/module/chat_message_storage.h"
+#include "demoweb_service/demoweb/module/message_channel_storage.h"
+#include "demoweb_service/demoweb/module/user_storage.h"
+#include "postgres/query_runner/sql_runner.h"
+
+bool SendChatMessageLatencyTest() {
+    e8::DemoWebTestEnvironmentContext env;
+
+    std::optional<e8::UserEntity> user =
+        e8::CreateUser(/*security_key=*/"", /*user_group_names=*/std::vector<std::string>(),
+                       /*user_id=*/1L, /*host_id=*/env.CurrentHostId(), env.DemowebDatabase());
+
+    e8::MessageChannelEntity channel = e8::CreateMessageChannel(
+        /*channel_name=*/std::nullopt, /*description=*/std::nullopt, /*encrypted=*/false,
+        /*close_group_channel=*/false, env.CurrentHostId(), env.DemowebDatabase());
+
+    e8::ChatMessageGroupEntity group =
+        e8::CreateChatMessageGroup(*user->id.Value(), *channel.id.Value(),
+                                   /*group_title=*/"Test chat message group", e8::CMTT_POPUP,
+                                   env.CurrentHostId(), env.DemowebDatabase());
+
+    unsigned const kNumMessages = 200;
+    std::vector<std::string> const texts{"Hey"};
+
+    // Separate round trips for inserting the message, touching the group and reading the sender.
+    e8::TimestampMicros begin = e8::CurrentTimestampMicros();
+    for (unsigned i = 0; i < kNumMessages; ++i) {
+        e8::ChatMessageEntity chat_message =
+            e8::CreateChatMessage(*group.id.Value(), *user->id.Value(), texts,
+                                  /*binary_content_paths=*/std::vector<std::string>(),
+                                  env.DemowebDatabase());
+        *group.last_interaction_at.ValuePtr() = *chat_message.created_at.Value();
+        e8::Update(group, e8::TableNames::ChatMessageGroup(), /*replace=*/true,
+                   env.DemowebDatabase());
+        std::optional<e8::UserEntity> sender =
+            e8::FetchUser(*user->id.Value(), env.DemowebDatabase());
+        TEST_CONDITION(sender.has_value());
+    }
+    e8::TimestampMicros separate_duration = e8::CurrentTimestampMicros() - begin;
+
+    begin = e8::CurrentTimestampMicros();
+    for (unsigned i = 0; i < kNumMessages; ++i) {
+        e8::CreateChatMessageAndTouchGroup(*group.id.Value(), *user->id.Value(), texts,
+                                           /*binary_content_paths=*/std::vector<std::string>(),
+                                           /*touch_group=*/true, env.DemowebDatabase());
+    }
+    e8::TimestampMicros fused_duration = e8::CurrentTimestampMicros() - begin;
+
+    std::cout << "Separate round trips: " << separate_duration / kNumMessages
+              << "us/message, single round trip: " << fused_duration / kNumMessages
+              << "us/message" << std::endl;
+
+    return true;
+}
+
+int main() {
+    e8::BeginTestSuite("chat_message_storage_benchmark");
+    e8::RunTest("SendChatMessageLatencyTest", SendChatMessageLatencyTest);
+    e8::EndTestSuite();
+    return 0;
+}
@@ -57,7 +57,7 @@ bool SendInvitationStorageTest() {
     bool result = e8::SendInvitation(*user1->id.Value(), *user2->id.Value(),
                                      /*send_message_anyway=*/false, env.CurrentHostId(),
                                      std::vector<e8::MessagePublisherInterface *>{&publisher},
-                                     env.KeyGen(), env.DemowebDatabase());
+                                     env.KeyGen(), env.PublicProfiles(), env.DemowebDatabase());
     TEST_CONDITION(result);
     TEST_CONDITION(publisher.published_messages_.size() == 1);
     TEST_CONDITION(publisher.published_messages_[0].target_user_id() == *user2->id.Value());
@@ -97,13 +97,14 @@ bool ProcessInvitationAcceptTest() {
     e8::SendInvitation(*user1->id.Value(), *user2->id.Value(),
                        /*send_message_anyway=*/false, env.CurrentHostId(),
                        std::vector<e8::MessagePublisherInterface *>(), env.KeyGen(),
-                       env.DemowebDatabase());
+                       env.PublicProfiles(), env.DemowebDatabase());
 
     MockMessagePublisher publisher;
     bool result = e8::ProcessInvitation(*user2->id.Value(), *user1->id.Value(),
                                         /*accept=*/true, env.CurrentHostId(),
                                         std::vector<e8::MessagePublisherInterface *>{&publisher},
-                                        env.KeyGen(), env.DemowebDatabase());
+                                        env.KeyGen(), env.PublicProfiles(),
+                                        env.DemowebDatabase());
     TEST_CONDITION(result);
     TEST_CONDITION(publisher.published_messages_.size() == 1);
     TEST_CONDITION(publisher.published_messages_[0].target_user_id() == *user1->id.Value());
@@ -0,0 +1,381 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "common/unit_test_util/unit_test_util.h"
+#include "demoweb_service/demoweb/common_entity/file_blob_entity.h"
+#include "demoweb_service/demoweb/common_entity/file_metadata_entity.h"
+#include "demoweb_service/demoweb/constant/file_transfer.h"
+#include "demoweb_service/demoweb/environment/test_environment_context.h"
+#include "demoweb_service/demoweb/module/file_access_validator.h"
+#include "demoweb_service/demoweb/module/file_blob.h"
+#include "demoweb_service/demoweb/module/file_io.h"
+#include "file_system/file_interface.h"
+#include "proto_cc/file.pb.h"
+#include "proto_cc/identity.pb.h"
+
+bool ResolveFileDescriptorTest() {
+    e8::DemoWebTestEnvironmentContext env;
+
+    e8::Identity viewer;
+    viewer.set_user_id(123L);
+    std::string file_path = "/user/123/avatar/1.png";
+
+    e8::FileDescriptor readwrite_descriptor;
+    readwrite_descriptor.mutable_file_token_access()->set_access_token(e8::SignFileAccessToken(
+        viewer.user_id(), file_path, e8::FileAccessMode::FAM_READWRITE, env.KeyGen()));
+
+    // A read-write access can be used to both read and write.
+    std::optional<std::string> resolved = e8::ResolveFileDescriptor(
+        viewer, readwrite_descriptor, e8::FAM_WRITE, env.KeyGen(), env.DemowebDatabase());
+    TEST_CONDITION(resolved == file_path);
+    resolved = e8::ResolveFileDescriptor(viewer, readwrite_descriptor, e8::FAM_READ, env.KeyGen(),
+                                         env.DemowebDatabase());
+    TEST_CONDITION(resolved == file_path);
+
+    // A read access can't be used to write.
+    e8::FileDescriptor read_descriptor;
+    read_descriptor.mutable_file_token_access()->set_access_token(e8::SignFileAccessToken(
+        viewer.user_id(), file_path, e8::FileAccessMode::FAM_READ, env.KeyGen()));
+    resolved = e8::ResolveFileDescriptor(viewer, read_descriptor, e8::FAM_WRITE, env.KeyGen(),
+                                         env.DemowebDatabase());
+    TEST_CONDITION(!resolved.has_value());
+
+    // Impersonation.
+    e8::Identity impersonator;
+    impersonator.set_user_id(viewer.user_id() + 1);
+    resolved = e8::ResolveFileDescriptor(impersonator, readwrite_descriptor, e8::FAM_READ,
+                                         env.KeyGen(), env.DemowebDatabase());
+    TEST_CONDITION(!resolved.has_value());
+
+    // Missing access method.
+    resolved = e8::ResolveFileDescriptor(viewer, e8::FileDescriptor(), e8::FAM_READ, env.KeyGen(),
+                                         env.DemowebDatabase());
+    TEST_CONDITION(!resolved.has_value());
+
+    return true;
+}
+
+bool ChunkedUploadThenDownloadTest() {
+    e8::DemoWebTestEnvironmentContext env;
+
+    std::string file_path = "/user/123/avatar/1.png";
+    std::string file_content(2 * e8::kFileChunkSize + 100, 'a');
+    file_content[e8::kFileChunkSize] = 'b';
+    file_content.back() = 'c';
+
+    std::unique_ptr<e8::FileUpload> upload = e8::BeginFileUpload(file_path, env.FileStore());
+    TEST_CONDITION(upload != nullptr);
+
+    // Upload the chunks in reverse order.
+    for (int32_t i = e8::NumFileChunks(file_content.size()) - 1; i >= 0; --i) {
+        e8::FileChunk chunk;
+        chunk.set_chunk_number(i);
+        chunk.set_data(file_content.substr(i * e8::kFileChunkSize, e8::kFileChunkSize));
+        TEST_CONDITION(e8::WriteFileChunk(chunk, upload.get()));
+    }
+
+    std::optional<e8::FileMetadataEntity> metadata =
+        e8::CompleteFileUpload(file_path, upload.get(), env.FileStore(), env.DemowebDatabase());
+    TEST_CONDITION(metadata.has_value());
+    TEST_CONDITION(*metadata->storage_size.Value() == static_cast<int64_t>(file_content.size()));
+    TEST_CONDITION(*metadata->format.Value() == e8::FFMT_IMAGE_PNG);
+    TEST_CONDITION(metadata->content_hash.Value() == e8::FileContentHash(file_content));
+
+    std::unique_ptr<e8::FileInterface> download =
+        e8::OpenStoredFile(file_path, env.FileStore(), env.DemowebDatabase());
+    TEST_CONDITION(download != nullptr);
+    std::optional<std::string_view> content = download->Content();
+    TEST_CONDITION(content.has_value());
+
+    int32_t num_chunks = e8::NumFileChunks(content->size());
+    TEST_CONDITION(num_chunks == 3);
+
+    std::string downloaded;
+    for (int32_t i = 0; i < num_chunks; ++i) {
+        e8::FileChunk chunk;
+        e8::ReadFileChunk(*content, i, &chunk);
+        TEST_CONDITION(chunk.chunk_number() == i);
+        downloaded += chunk.data();
+    }
+    TEST_CONDITION(downloaded == file_content);
+
+    return true;
+}
+
+bool RejectMalformedFileChunkTest() {
+    e8::DemoWebTestEnvironmentContext env;
+
+    std::unique_ptr<e8::FileUpload> upload =
+        e8::BeginFileUpload("/user/123/avatar/1.png", env.FileStore());
+    TEST_CONDITION(upload != nullptr);
+
+    e8::FileChunk negative_chunk;
+    negative_chunk.set_chunk_number(-1);
+    negative_chunk.set_data("a");
+    TEST_CONDITION(!e8::WriteFileChunk(negative_chunk, upload.get()));
+
+    e8::FileChunk oversized_chunk;
+    oversized_chunk.set_chunk_number(0);
+    oversized_chunk.set_data(std::string(e8::kFileChunkSize + 1, 'a'));
+    TEST_CONDITION(!e8::WriteFileChunk(oversized_chunk, upload.get()));
+
+    e8::FileChunk last_chunk;
+    last_chunk.set_chunk_number(e8::NumFileChunks(e8::kMaxFileSize) - 1);
+    last_chunk.set_data(std::string(e8::kFileChunkSize, 'a'));
+    TEST_CONDITION(e8::WriteFileChunk(last_chunk, upload.get()));
+
+    e8::FileChunk out_of_range_chunk;
+    out_of_range_chunk.set_chunk_number(e8::NumFileChunks(e8::kMaxFileSize));
+    out_of_range_chunk.set_data("a");
+    TEST_CONDITION(!e8::WriteFileChunk(out_of_range_chunk, upload.get()));
+
+    return true;
+}
+
+bool ConcurrentUploadStagingTest() {
+    e8::DemoWebTestEnvironmentContext env;
+
+    std::string file_path = "/user/123/avatar/1.png";
+    std::unique_ptr<e8::FileUpload> first = e8::BeginFileUpload(file_path, env.FileStore());
+    std::unique_ptr<e8::FileUpload> second = e8::BeginFileUpload(file_path, env.FileStore());
+    TEST_CONDITION(first != nullptr);
+    TEST_CONDITION(second != nullptr);
+    TEST_CONDITION(first->staging_path != second->staging_path);
+
+    e8::FileChunk chunk;
+    chunk.set_chunk_number(0);
+    chunk.set_data("first");
+    TEST_CONDITION(e8::WriteFileChunk(chunk, first.get()));
+    chunk.set_data("second");
+    TEST_CONDITION(e8::WriteFileChunk(chunk, second.get()));
+
+    // An abandoned upload leaves no staging file behind.
+    std::string abandoned_staging_path = second->staging_path;
+    second = nullptr;
+    TEST_CONDITION(env.FileStore()->OpenFile(abandoned_staging_path) == nullptr);
+
+    std::optional<e8::FileMetadataEntity> metadata =
+        e8::CompleteFileUpload(file_path, first.get(), env.FileStore(), env.DemowebDatabase());
+    TEST_CONDITION(metadata.has_value());
+    TEST_CONDITION(metadata->content_hash.Value() == e8::FileContentHash("first"));
+
+    return true;
+}
+
+namespace {
+
+std::optional<e8::FileMetadataEntity> UploadWholeFile(std::string const &file_path,
+                                                      std::string const &file_content,
+                                                      e8::DemoWebTestEnvironmentContext *env) {
+    std::unique_ptr<e8::FileUpload> upload = e8::BeginFileUpload(file_path, env->FileStore());
+    if (upload == nullptr) {
+        return std::nullopt;
+    }
+
+    e8::FileChunk chunk;
+    chunk.set_chunk_number(0);
+    chunk.set_data(file_content);
+    if (!e8::WriteFileChunk(chunk, upload.get())) {
+        return std::nullopt;
+    }
+
+    return e8::CompleteFileUpload(file_path, upload.get(), env->FileStore(),
+                                  env->DemowebDatabase());
+}
+
+} // namespace
+
+bool DeduplicateIdenticalUploadsTest() {
+    e8::DemoWebTestEnvironmentContext env;
+
+    std::string file_content = "gif content";
+    std::string content_hash = e8::FileContentHash(file_content);
+    TEST_CONDITION(e8::IsValidFileContentHash(content_hash));
+
+    TEST_CONDITION(UploadWholeFile("/user/1/forward/1.gif", file_content, &env).has_value());
+    TEST_CONDITION(UploadWholeFile("/user/2/forward/1.gif", file_content, &env).has_value());
+
+    // Both locations share one blob.
+    std::optional<e8::FileBlobEntity> blob = e8::FetchFileBlob(content_hash, env.DemowebDatabase());
+    TEST_CONDITION(blob.has_value());
+    TEST_CONDITION(*blob->ref_count.Value() == 2);
+    TEST_CONDITION(*blob->committed.Value());
+    TEST_CONDITION(*blob->storage_size.Value() == static_cast<int64_t>(file_content.size()));
+
+    for (char const *file_path : {"/user/1/forward/1.gif", "/user/2/forward/1.gif"}) {
+        std::unique_ptr<e8::FileInterface> file =
+            e8::OpenStoredFile(file_path, env.FileStore(), env.DemowebDatabase());
+        TEST_CONDITION(file != nullptr);
+        TEST_CONDITION(file->Content() == file_content);
+    }
+
+    // Overwriting a location drops its reference to the old blob.
+    TEST_CONDITION(UploadWholeFile("/user/1/forward/1.gif", "new content", &env).has_value());
+    blob = e8::FetchFileBlob(content_hash, env.DemowebDatabase());
+    TEST_CONDITION(blob.has_value());
+    TEST_CONDITION(*blob->ref_count.Value() == 1);
+
+    // The blob is removed along with its last reference.
+    TEST_CONDITION(UploadWholeFile("/user/2/forward/1.gif", "new content", &env).has_value());
+    TEST_CONDITION(!e8::FetchFileBlob(content_hash, env.DemowebDatabase()).has_value());
+    TEST_CONDITION(env.FileStore()->OpenFile(e8::FileBlobPath(content_hash)) == nullptr);
+
+    blob = e8::FetchFileBlob(e8::FileContentHash("new content"), env.DemowebDatabase());
+    TEST_CONDITION(blob.has_value());
+    TEST_CONDITION(*blob->ref_count.Value() == 2);
+
+    return true;
+}
+
+bool LinkKnownFileContentTest() {
+    e8::DemoWebTestEnvironmentContext env;
+
+    std::string file_content = "png content";
+    std::string content_hash = e8::FileContentHash(file_content);
+
+    // Unknown and malformed content hashes require an upload.
+    TEST_CONDITION(!e8::LinkKnownFileContent("/user/1/avatar/1.png", content_hash, env.FileStore(),
+                                             env.DemowebDatabase())
+                        .has_value());
+    TEST_CONDITION(!e8::FetchFileBlob(content_hash, env.DemowebDatabase()).has_value());
+    TEST_CONDITION(!e8::LinkKnownFileContent("/user/1/avatar/1.png", "../../escaped",
+                                             env.FileStore(), env.DemowebDatabase())
+                        .has_value());
+
+    TEST_CONDITION(UploadWholeFile("/user/1/avatar/1.png", file_content, &env).has_value());
+
+    std::optional<e8::FileMetadataEntity> metadata = e8::LinkKnownFileContent(
+        "/user/2/avatar/1.png", content_hash, env.FileStore(), env.DemowebDatabase());
+    TEST_CONDITION(metadata.has_value());
+    TEST_CONDITION(*metadata->storage_size.Value() == static_cast<int64_t>(file_content.size()));
+    TEST_CONDITION(metadata->content_hash.Value() == content_hash);
+
+    std::unique_ptr<e8::FileInterface> file =
+        e8::OpenStoredFile("/user/2/avatar/1.png", env.FileStore(), env.DemowebDatabase());
+    TEST_CONDITION(file != nullptr);
+    TEST_CONDITION(file->Content() == file_content);
+
+    std::optional<e8::FileBlobEntity> blob = e8::FetchFileBlob(content_hash, env.DemowebDatabase());
+    TEST_CONDITION(blob.has_value());
+    TEST_CONDITION(*blob->ref_count.Value() == 2);
+
+    return true;
+}
+
+bool ConcurrentRelinkTest() {
+    e8::DemoWebTestEnvironmentContext env;
+
+    std::string const contents[] = {"first png content", "second png content"};
+    TEST_CONDITION(UploadWholeFile("/user/1/avatar/1.png", contents[0], &env).has_value());
+    TEST_CONDITION(UploadWholeFile("/user/1/avatar/2.png", contents[1], &env).has_value());
+
+    // Every link to the shared location drops exactly the reference it replaced.
+    std::vector<std::thread> linkers;
+    for (unsigned i = 0; i < 8; ++i) {
+        linkers.emplace_back([&env, &contents, i] {
+            for (unsigned j = 0; j < 16; ++j) {
+                e8::LinkKnownFileContent("/user/2/avatar/1.png",
+                                         e8::FileContentHash(contents[(i + j) % 2]),
+                                         env.FileStore(), env.DemowebDatabase());
+            }
+        });
+    }
+    for (std::thread &linker : linkers) {
+        linker.join();
+    }
+
+    int64_t num_refs = 0;
+    for (std::string const &content : contents) {
+        std::optional<e8::FileBlobEntity> blob =
+            e8::FetchFileBlob(e8::FileContentHash(content), env.DemowebDatabase());
+        TEST_CONDITION(blob.has_value());
+        num_refs += *blob->ref_count.Value();
+    }
+    TEST_CONDITION(num_refs == 3);
+
+    return true;
+}
+
+bool UncommittedFileBlobTest() {
+    e8::DemoWebTestEnvironmentContext env;
+
+    std::string file_content = "jpg content";
+    std::string content_hash = e8::FileContentHash(file_content);
+
+    // Another upload of the content has created the blob but hasn't stored the content yet.
+    e8::FileBlobEntity pending = e8::AcquireFileBlob(content_hash, file_content.size(),
+                                                     env.FileStore(), env.DemowebDatabase());
+    TEST_CONDITION(*pending.ref_count.Value() == 1);
+    TEST_CONDITION(!*pending.committed.Value());
+
+    // The content can't be linked to until it's committed.
+    TEST_CONDITION(!e8::LinkKnownFileContent("/user/1/avatar/1.jpg", content_hash, env.FileStore(),
+                                             env.DemowebDatabase())
+                        .has_value());
+    std::optional<e8::FileBlobEntity> blob = e8::FetchFileBlob(content_hash, env.DemowebDatabase());
+    TEST_CONDITION(blob.has_value());
+    TEST_CONDITION(*blob->ref_count.Value() == 1);
+
+    // An upload of the same content stores it rather than trusting the pending blob.
+    TEST_CONDITION(UploadWholeFile("/user/2/avatar/1.jpg", file_content, &env).has_value());
+    blob = e8::FetchFileBlob(content_hash, env.DemowebDatabase());
+    TEST_CONDITION(blob.has_value());
+    TEST_CONDITION(*blob->ref_count.Value() == 2);
+    TEST_CONDITION(*blob->committed.Value());
+
+    std::unique_ptr<e8::FileInterface> file =
+        e8::OpenStoredFile("/user/2/avatar/1.jpg", env.FileStore(), env.DemowebDatabase());
+    TEST_CONDITION(file != nullptr);
+    TEST_CONDITION(file->Content() == file_content);
+
+    // The pending upload giving up leaves the stored content in place.
+    TEST_CONDITION(!e8::ReleaseFileBlob(content_hash, env.FileStore(), env.DemowebDatabase()));
+    file = e8::OpenStoredFile("/user/2/avatar/1.jpg", env.FileStore(), env.DemowebDatabase());
+    TEST_CONDITION(file != nullptr);
+    TEST_CONDITION(file->Content() == file_content);
+
+    TEST_CONDITION(e8::LinkKnownFileContent("/user/1/avatar/1.jpg", content_hash, env.FileStore(),
+                                            env.DemowebDatabase())
+                       .has_value());
+    blob = e8::FetchFileBlob(content_hash, env.DemowebDatabase());
+    TEST_CONDITION(blob.has_value());
+    TEST_CONDITION(*blob->ref_count.Value() == 2);
+
+    return true;
+}
+
+int main() {
+    e8::BeginTestSuite("file_io");
+    e8::RunTest("ResolveFileDescriptorTest", ResolveFileDescriptorTest);
+    e8::RunTest("ChunkedUploadThenDownloadTest", ChunkedUploadThenDownloadTest);
+    e8::RunTest("RejectMalformedFileChunkTest", RejectMalformedFileChunkTest);
+    e8::RunTest("ConcurrentUploadStagingTest", ConcurrentUploadStagingTest);
+    e8::RunTest("DeduplicateIdenticalUploadsTest", DeduplicateIdenticalUploadsTest);
+    e8::RunTest("LinkKnownFileContentTest", LinkKnownFileContentTest);
+    e8::RunTest("ConcurrentRelinkTest", ConcurrentRelinkTest);
+    e8::RunTest("UncommittedFileBlobTest", UncommittedFileBlobTest);
+    e8::EndTestSuite();
+    return 0;
+}
@@ -26,11 +26,13 @@
 #include "demoweb_service/demoweb/common_entity/message_channel_has_user_entity.h"
 #include "demoweb_service/demoweb/common_entity/user_entity.h"
 #include "demoweb_service/demoweb/environment/test_environment_context.h"
+#include "demoweb_service/demoweb/module/contact_storage.h"
 #include "demoweb_service/demoweb/module/message_channel.h"
 #include "demoweb_service/demoweb/module/message_channel_storage.h"
 #include "demoweb_service/demoweb/module/user_storage.h"
 #include "proto_cc/message_channel.pb.h"
 #include "proto_cc/pagination.pb.h"
+#include "proto_cc/user_relation.pb.h"
 
 static e8::UserId const kCreatorId = 1;
 static e8::UserId const kRegularMemberId = 2;
@@ -115,6 +117,8 @@ bool CreateAndListMessageChannelTest() {
     TEST_CONDITION(*retrieved_channels[0].message_channel.close_group_channel.Value() == true);
     TEST_CONDITION(*retrieved_channels[0].message_channel.created_at.Value() > 0);
     TEST_CONDITION(retrieved_channels[0].member_type == e8::MessageChannelMemberType::MCMT_ADMIN);
+    TEST_CONDITION(retrieved_channels[0].most_active_members.empty());
+    TEST_CONDITION(retrieved_channels[0].most_active_users.empty());
 
     return true;
 }
@@ -338,14 +342,15 @@ bool ToMessageChannelOverviewsTest() {
     e8::DemoWebTestEnvironmentContext env;
 
     CreateNewChannelInfo channel_info = CreateChannel1(&env);
+    TEST_CONDITION(e8::CreateContact(kCreatorId, kRegularMemberId, env.DemowebDatabase()));
 
     std::vector<e8::SearchedMessageChannel> retrieved_channels = e8::SearchMessageChannels(
         kCreatorId,
         /*contains_member_ids=*/{}, /*any_channel_ids=*/{}, /*search_text=*/std::nullopt,
         /*active_member_fetch_limit=*/10, std::nullopt, env.DemowebDatabase());
 
-    std::vector<e8::MessageChannelOverview> overviews = e8::ToMessageChannelOverviews(
-        kCreatorId, retrieved_channels, env.KeyGen(), env.DemowebDatabase());
+    std::vector<e8::MessageChannelOverview> overviews =
+        e8::ToMessageChannelOverviews(retrieved_channels, env.KeyGen(), env.PublicProfiles());
 
     TEST_CONDITION(overviews.size() == 1);
     TEST_CONDITION(overviews[0].channel().channel_id() == *channel_info.message_channel.id.Value());
@@ -362,7 +367,9 @@ bool ToMessageChannelOverviewsTest() {
     TEST_CONDITION(std::find_if(overviews[0].most_active_users().begin(),
                                 overviews[0].most_active_users().end(),
                                 [](e8::UserPublicProfile const &member) {
-                                    return member.user_id() == kRegularMemberId;
+                                    return member.user_id() == kRegularMemberId &&
+                                           member.relations().size() == 1 &&
+                                           member.relations(0).relation() == e8::URL_CONTACT;
                                 }) != overviews[0].most_active_users().end());
 
     return true;
@@ -0,0 +1,113 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "common/time_util/time_util.h"
+#include "common/unit_test_util/unit_test_util.h"
+#include "demoweb_service/demoweb/common_entity/message_channel_entity.h"
+#include "demoweb_service/demoweb/common_entity/user_entity.h"
+#include "demoweb_service/demoweb/environment/test_environment_context.h"
+#include "demoweb_service/demoweb/module/contact_storage.h"
+#include "demoweb_service/demoweb/module/message_channel.h"
+#include "demoweb_service/demoweb/module/message_channel_storage.h"
+#include "demoweb_service/demoweb/module/user_storage.h"
+#include "proto_cc/message_channel.pb.h"
+#include "proto_cc/pagination.pb.h"
+
+namespace {
+
+e8::UserId const kViewerId = 1;
+unsigned const kNumMembersPerChannel = 5;
+unsigned const kActiveMemberFetchLimit = 3;
+unsigned const kNumRepeats = 20;
+
+/**
+ * @brief CreateChannels Creates the channels the viewer is an admin of. Every channel has the same
+ * members, half of whom are the viewer's contacts.
+ */
+void CreateChannels(unsigned const num_channels, e8::DemoWebTestEnvironmentContext *env) {
+    for (e8::UserId user_id = kViewerId; user_id < kViewerId + kNumMembersPerChannel; ++user_id) {
+        std::optional<e8::UserEntity> user =
+            e8::CreateUser(/*security_key=*/"", /*user_group_names=*/std::vector<std::string>(),
+                           user_id, env->CurrentHostId(), env->DemowebDatabase());
+        assert(user.has_value());
+
+        if (user_id != kViewerId && user_id % 2 == 0) {
+            bool rc = e8::CreateContact(kViewerId, user_id, env->DemowebDatabase());
+            assert(rc);
+        }
+    }
+
+    for (unsigned i = 0; i < num_channels; ++i) {
+        e8::MessageChannelEntity channel = e8::CreateMessageChannel(
+            /*channel_name=*/"channel" + std::to_string(i), /*description=*/std::nullopt,
+            /*encrypted=*/false, /*close_group_channel=*/false, env->CurrentHostId(),
+            env->DemowebDatabase());
+
+        for (e8::UserId user_id = kViewerId; user_id < kViewerId + kNumMembersPerChannel;
+             ++user_id) {
+            bool rc = e8::CreateMessageChannelMembership(
+                *channel.id.Value(), user_id,
+                user_id == kViewerId ? e8::MCMT_ADMIN : e8::MCMT_MEMBER, env->DemowebDatabase());
+            assert(rc);
+        }
+    }
+}
+
+bool SearchMessageChannelsLatencyTest() {
+    for (unsigned num_channels : {10, 50, 100}) {
+        e8::DemoWebTestEnvironmentContext env;
+        CreateChannels(num_channels, &env);
+
+        e8::Pagination pagination;
+        pagination.set_page_number(0);
+        pagination.set_result_per_page(num_channels);
+
+        e8::TimestampMicros begin = e8::CurrentTimestampMicros();
+        for (unsigned i = 0; i < kNumRepeats; ++i) {
+            std::vector<e8::SearchedMessageChannel> channels = e8::SearchMessageChannels(
+                kViewerId, /*contains_member_ids=*/{}, /*any_channel_ids=*/{},
+                /*search_text=*/std::nullopt, kActiveMemberFetchLimit, pagination,
+                env.DemowebDatabase());
+            TEST_CONDITION(channels.size() == num_channels);
+
+            std::vector<e8::MessageChannelOverview> overviews =
+                e8::ToMessageChannelOverviews(channels, env.KeyGen(), env.PublicProfiles());
+            TEST_CONDITION(overviews.size() == num_channels);
+        }
+        e8::TimestampMicros duration = e8::CurrentTimestampMicros() - begin;
+
+        std::cout << num_channels << " channels: " << duration / kNumRepeats << "us/request"
+                  << std::endl;
+    }
+
+    return true;
+}
+
+} // namespace
+
+int main() {
+    e8::BeginTestSuite("message_channel_benchmark");
+    e8::RunTest("SearchMessageChannelsLatencyTest", SearchMessageChannelsLatencyTest);
+    e8::EndTestSuite();
+    return 0;
+}
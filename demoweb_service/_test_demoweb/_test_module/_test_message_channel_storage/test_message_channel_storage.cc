@@ -15,10 +15,103 @@
  * not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <vector>
+
 #include "common/unit_test_util/unit_test_util.h"
+#include "demoweb_service/demoweb/common_entity/message_channel_entity.h"
+#include "demoweb_service/demoweb/common_entity/user_entity.h"
+#include "demoweb_service/demoweb/environment/test_environment_context.h"
+#include "demoweb_service/demoweb/module/message_channel.h"
+#include "demoweb_service/demoweb/module/message_channel_storage.h"
+#include "demoweb_service/demoweb/module/user_storage.h"
+#include "proto_cc/message_channel.pb.h"
+
+namespace {
+
+e8::MessageChannelMembership Membership(e8::MessageChannelId const channel_id,
+                                        e8::UserId const user_id,
+                                        e8::MessageChannelMemberType const member_type) {
+    e8::MessageChannelMembership membership;
+    membership.set_channel_id(channel_id);
+    membership.set_user_id(user_id);
+    membership.set_member_type(member_type);
+    return membership;
+}
+
+std::optional<e8::MessageChannelMemberType>
+MemberType(std::vector<e8::MessageChannelMember> const &members, e8::UserId const user_id) {
+    auto it = std::find_if(members.begin(), members.end(),
+                           [user_id](e8::MessageChannelMember const &member) {
+                               return *member.member.id.Value() == user_id;
+                           });
+    if (it == members.end()) {
+        return std::nullopt;
+    }
+    return it->member_type;
+}
+
+} // namespace
+
+bool ApplyMessageChannelMembershipChangesTest() {
+    e8::DemoWebTestEnvironmentContext env;
+
+    unsigned const kNumUsers = 100;
+    for (e8::UserId user_id = 1; user_id <= kNumUsers + 1; ++user_id) {
+        e8::CreateUser(/*security_key=*/"", /*user_group_names=*/std::vector<std::string>(),
+                       user_id, env.CurrentHostId(), env.DemowebDatabase());
+    }
+
+    e8::MessageChannelEntity channel = e8::CreateMessageChannel(
+        /*channel_name=*/std::nullopt, /*description=*/std::nullopt, /*encrypted=*/false,
+        /*close_group_channel=*/false, env.CurrentHostId(), env.DemowebDatabase());
+    e8::MessageChannelId channel_id = *channel.id.Value();
+
+    // Add every user at once. The last one has already been a member.
+    TEST_CONDITION(e8::CreateMessageChannelMembership(channel_id, kNumUsers, e8::MCMT_MEMBER,
+                                                      env.DemowebDatabase()));
+    std::vector<e8::MessageChannelMembership> to_be_added;
+    for (e8::UserId user_id = 1; user_id <= kNumUsers; ++user_id) {
+        to_be_added.push_back(Membership(channel_id, user_id, e8::MCMT_MEMBER));
+    }
+    e8::NumMembershipChanges changes = e8::ApplyMessageChannelMembershipChanges(
+        channel_id, to_be_added, /*to_be_updated=*/{}, /*to_be_removed=*/{},
+        env.DemowebDatabase());
+    TEST_CONDITION(changes.num_added == kNumUsers - 1);
+    TEST_CONDITION(changes.num_updated == 0);
+    TEST_CONDITION(changes.num_removed == 0);
+
+    std::vector<e8::MessageChannelMember> members = e8::GetMessageChannelMembers(
+        channel_id, /*pagination=*/std::nullopt, env.DemowebDatabase());
+    TEST_CONDITION(members.size() == kNumUsers);
+
+    // Promote, remove and add in one go.
+    changes = e8::ApplyMessageChannelMembershipChanges(
+        channel_id, /*to_be_added=*/{Membership(channel_id, kNumUsers + 1, e8::MCMT_MEMBER)},
+        /*to_be_updated=*/{Membership(channel_id, 1, e8::MCMT_ADMIN)},
+        /*to_be_removed=*/{2, 3, kNumUsers + 2}, env.DemowebDatabase());
+    TEST_CONDITION(changes.num_added == 1);
+    TEST_CONDITION(changes.num_updated == 1);
+    TEST_CONDITION(changes.num_removed == 2);
+
+    members = e8::GetMessageChannelMembers(channel_id, /*pagination=*/std::nullopt,
+                                           env.DemowebDatabase());
+    TEST_CONDITION(members.size() == kNumUsers - 1);
+    TEST_CONDITION(MemberType(members, 1) == e8::MCMT_ADMIN);
+    TEST_CONDITION(MemberType(members, 4) == e8::MCMT_MEMBER);
+    TEST_CONDITION(MemberType(members, kNumUsers + 1) == e8::MCMT_MEMBER);
+    TEST_CONDITION(!MemberType(members, 2).has_value());
+    TEST_CONDITION(!MemberType(members, 3).has_value());
+
+    return true;
+}
 
 int main() {
     e8::BeginTestSuite("message_channel_storage");
+    e8::RunTest("ApplyMessageChannelMembershipChangesTest",
+                ApplyMessageChannelMembershipChangesTest);
     e8::EndTestSuite();
     return 0;
 }
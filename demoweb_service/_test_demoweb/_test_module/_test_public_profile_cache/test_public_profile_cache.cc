@@ -0,0 +1,141 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <optional>
+#include <string>
+
+#include "common/unit_test_util/unit_test_util.h"
+#include "demoweb_service/demoweb/common_entity/user_entity.h"
+#include "demoweb_service/demoweb/module/public_profile_cache.h"
+#include "proto_cc/user_profile.pb.h"
+
+namespace {
+
+e8::TimestampMicros const kTimeToLive = 60LL * 1000 * 1000;
+
+e8::UserEntity MakeUser(e8::UserId const user_id, std::string const &alias) {
+    e8::UserEntity user;
+    *user.id.ValuePtr() = user_id;
+    *user.alias.ValuePtr() = alias;
+    *user.created_at.ValuePtr() = 1;
+    return user;
+}
+
+e8::UserPublicProfile MakeProfile(e8::UserEntity const &user) {
+    e8::UserPublicProfile profile;
+    profile.set_user_id(*user.id.Value());
+    profile.mutable_alias()->set_value(*user.alias.Value());
+    return profile;
+}
+
+} // namespace
+
+bool FetchAfterPutTest() {
+    e8::PublicProfileCache cache(/*num_shards=*/4, /*max_num_profiles_per_shard=*/10, kTimeToLive);
+
+    e8::UserEntity user = MakeUser(/*user_id=*/1L, "alias");
+    TEST_CONDITION(!cache.Fetch(user).has_value());
+
+    cache.Put(user, MakeProfile(user));
+
+    std::optional<e8::UserPublicProfile> profile = cache.Fetch(user);
+    TEST_CONDITION(profile.has_value());
+    TEST_CONDITION(profile->user_id() == 1L);
+    TEST_CONDITION(profile->alias().value() == "alias");
+
+    e8::PublicProfileCache::Stats stats = cache.GetStats();
+    TEST_CONDITION(stats.num_hits == 1);
+    TEST_CONDITION(stats.num_misses == 1);
+
+    return true;
+}
+
+bool StaleEntityTest() {
+    e8::PublicProfileCache cache(/*num_shards=*/4, /*max_num_profiles_per_shard=*/10, kTimeToLive);
+
+    e8::UserEntity user = MakeUser(/*user_id=*/1L, "alias");
+    cache.Put(user, MakeProfile(user));
+
+    // The profile was updated elsewhere.
+    e8::UserEntity updated_user = MakeUser(/*user_id=*/1L, "new alias");
+    TEST_CONDITION(!cache.Fetch(updated_user).has_value());
+
+    // Avatar changes are detected too.
+    cache.Put(updated_user, MakeProfile(updated_user));
+    *updated_user.avatar_path.ValuePtr() = "/user/1/avatar/1.png";
+    TEST_CONDITION(!cache.Fetch(updated_user).has_value());
+
+    return true;
+}
+
+bool InvalidateTest() {
+    e8::PublicProfileCache cache(/*num_shards=*/4, /*max_num_profiles_per_shard=*/10, kTimeToLive);
+
+    e8::UserEntity user = MakeUser(/*user_id=*/1L, "alias");
+    cache.Put(user, MakeProfile(user));
+    cache.Invalidate(/*user_id=*/1L);
+
+    TEST_CONDITION(!cache.Fetch(user).has_value());
+
+    return true;
+}
+
+bool EvictionTest() {
+    e8::PublicProfileCache cache(/*num_shards=*/1, /*max_num_profiles_per_shard=*/2, kTimeToLive);
+
+    e8::UserEntity user1 = MakeUser(/*user_id=*/1L, "alias1");
+    e8::UserEntity user2 = MakeUser(/*user_id=*/2L, "alias2");
+    e8::UserEntity user3 = MakeUser(/*user_id=*/3L, "alias3");
+
+    cache.Put(user1, MakeProfile(user1));
+    cache.Put(user2, MakeProfile(user2));
+
+    // Makes user 1 the most recently used.
+    TEST_CONDITION(cache.Fetch(user1).has_value());
+
+    cache.Put(user3, MakeProfile(user3));
+
+    TEST_CONDITION(cache.Fetch(user1).has_value());
+    TEST_CONDITION(!cache.Fetch(user2).has_value());
+    TEST_CONDITION(cache.Fetch(user3).has_value());
+    TEST_CONDITION(cache.GetStats().num_evictions == 1);
+
+    return true;
+}
+
+bool ExpirationTest() {
+    e8::PublicProfileCache cache(/*num_shards=*/4, /*max_num_profiles_per_shard=*/10,
+                                 /*time_to_live=*/-1);
+
+    e8::UserEntity user = MakeUser(/*user_id=*/1L, "alias");
+    cache.Put(user, MakeProfile(user));
+
+    TEST_CONDITION(!cache.Fetch(user).has_value());
+
+    return true;
+}
+
+int main() {
+    e8::BeginTestSuite("public_profile_cache");
+    e8::RunTest("FetchAfterPutTest", FetchAfterPutTest);
+    e8::RunTest("StaleEntityTest", StaleEntityTest);
+    e8::RunTest("InvalidateTest", InvalidateTest);
+    e8::RunTest("EvictionTest", EvictionTest);
+    e8::RunTest("ExpirationTest", ExpirationTest);
+    e8::EndTestSuite();
+    return 0;
+}
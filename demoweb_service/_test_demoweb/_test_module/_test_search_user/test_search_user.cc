@@ -28,6 +28,7 @@
 #include "demoweb_service/demoweb/module/contact_storage.h"
 #include "demoweb_service/demoweb/module/search_user.h"
 #include "demoweb_service/demoweb/module/user_profile.h"
+#include "demoweb_service/demoweb/module/user_search_index.h"
 #include "postgres/query_runner/connection/connection_reservoir_interface.h"
 #include "proto_cc/pagination.pb.h"
 #include "proto_cc/user_relation.pb.h"
@@ -58,7 +59,8 @@ bool SearchUserByIdPrefixTest() {
     std::vector<e8::UserEntity> page0 = e8::SearchUser(
         std::optional<e8::UserId>(),
         /*query=*/std::to_string(123L),
-        /*oneof_user_relations=*/std::unordered_set<e8::UserRelation>(), pagination, db_conns);
+        /*oneof_user_relations=*/std::unordered_set<e8::UserRelation>(), pagination,
+        /*search_index=*/nullptr, db_conns);
     TEST_CONDITION(page0.size() == 2);
     TEST_CONDITION(page0[0].id.Value().value() == 12300L);
     TEST_CONDITION(page0[1].id.Value().value() == 12301L);
@@ -68,7 +70,8 @@ bool SearchUserByIdPrefixTest() {
     std::vector<e8::UserEntity> page1 = e8::SearchUser(
         std::optional<e8::UserId>(),
         /*query=*/std::to_string(123L),
-        /*oneof_user_relations=*/std::unordered_set<e8::UserRelation>(), pagination, db_conns);
+        /*oneof_user_relations=*/std::unordered_set<e8::UserRelation>(), pagination,
+        /*search_index=*/nullptr, db_conns);
     TEST_CONDITION(page1.size() == 2);
     TEST_CONDITION(page1[0].id.Value().value() == 12302L);
     TEST_CONDITION(page1[1].id.Value().value() == 12303L);
@@ -78,7 +81,8 @@ bool SearchUserByIdPrefixTest() {
     std::vector<e8::UserEntity> page2 = e8::SearchUser(
         std::optional<e8::UserId>(),
         /*query=*/std::to_string(123L),
-        /*oneof_user_relations=*/std::unordered_set<e8::UserRelation>(), pagination, db_conns);
+        /*oneof_user_relations=*/std::unordered_set<e8::UserRelation>(), pagination,
+        /*search_index=*/nullptr, db_conns);
     TEST_CONDITION(page2.empty());
 
     return true;
@@ -91,27 +95,32 @@ bool SearchUserByIdAliasTest() {
     e8::UserEntity user0 = e8::CreateBaselineUser(/*security_key=*/"PASS", /*user_id=*/1L,
                                                   env.CurrentHostId(), db_conns)
                                .value();
-    e8::UpdateProfile(/*alias=*/"John Jr. A", std::nullopt, &user0, db_conns);
+    e8::UpdateProfile(/*alias=*/"John Jr. A", std::nullopt, &user0, /*profile_cache=*/nullptr,
+                      /*search_index=*/nullptr, db_conns);
 
     e8::UserEntity user1 = e8::CreateBaselineUser(/*security_key=*/"PASS", /*userId=*/2L,
                                                   env.CurrentHostId(), db_conns)
                                .value();
-    e8::UpdateProfile(/*alias=*/"John Jr. A", std::nullopt, &user1, db_conns);
+    e8::UpdateProfile(/*alias=*/"John Jr. A", std::nullopt, &user1, /*profile_cache=*/nullptr,
+                      /*search_index=*/nullptr, db_conns);
 
     e8::UserEntity user2 = e8::CreateBaselineUser(/*security_key=*/"PASS", /*userId=*/3L,
                                                   env.CurrentHostId(), db_conns)
                                .value();
-    e8::UpdateProfile(/*alias=*/"John Jr. B", std::nullopt, &user2, db_conns);
+    e8::UpdateProfile(/*alias=*/"John Jr. B", std::nullopt, &user2, /*profile_cache=*/nullptr,
+                      /*search_index=*/nullptr, db_conns);
 
     e8::UserEntity user3 = e8::CreateBaselineUser(/*security_key=*/"PASS", /*userId=*/4L,
                                                   env.CurrentHostId(), db_conns)
                                .value();
-    e8::UpdateProfile(/*alias=*/"John Jr. C", std::nullopt, &user3, db_conns);
+    e8::UpdateProfile(/*alias=*/"John Jr. C", std::nullopt, &user3, /*profile_cache=*/nullptr,
+                      /*search_index=*/nullptr, db_conns);
 
     e8::UserEntity user4 = e8::CreateBaselineUser(/*security_key=*/"PASS", /*userId=*/5L,
                                                   env.CurrentHostId(), db_conns)
                                .value();
-    e8::UpdateProfile(/*alias=*/"Stieve Jr. A", std::nullopt, &user4, db_conns);
+    e8::UpdateProfile(/*alias=*/"Stieve Jr. A", std::nullopt, &user4, /*profile_cache=*/nullptr,
+                      /*search_index=*/nullptr, db_conns);
 
     e8::Pagination pagination;
     pagination.set_page_number(0);
@@ -119,7 +128,7 @@ bool SearchUserByIdAliasTest() {
     std::vector<e8::UserEntity> page0 = e8::SearchUser(
         std::optional<e8::UserId>(),
         /*query=*/"John Jr.", /*oneof_user_relations=*/std::unordered_set<e8::UserRelation>(),
-        pagination, db_conns);
+        pagination, /*search_index=*/nullptr, db_conns);
     TEST_CONDITION(page0.size() == 2);
     TEST_CONDITION(page0[0].id.Value().value() == 1L);
     TEST_CONDITION(page0[1].id.Value().value() == 2L);
@@ -129,7 +138,7 @@ bool SearchUserByIdAliasTest() {
     std::vector<e8::UserEntity> page1 = e8::SearchUser(
         std::optional<e8::UserId>(),
         /*query=*/"John Jr.", /*oneof_user_relations=*/std::unordered_set<e8::UserRelation>(),
-        pagination, db_conns);
+        pagination, /*search_index=*/nullptr, db_conns);
     TEST_CONDITION(page1.size() == 2);
     TEST_CONDITION(page1[0].id.Value().value() == 3L);
     TEST_CONDITION(page1[1].id.Value().value() == 4L);
@@ -139,7 +148,7 @@ bool SearchUserByIdAliasTest() {
     std::vector<e8::UserEntity> page2 = e8::SearchUser(
         std::optional<e8::UserId>(),
         /*query=*/"John Jr.", /*oneof_user_relations=*/std::unordered_set<e8::UserRelation>(),
-        pagination, db_conns);
+        pagination, /*search_index=*/nullptr, db_conns);
     TEST_CONDITION(page2.empty());
 
     return true;
@@ -166,7 +175,7 @@ bool SearchUserByRelationTest() {
         /*viewer_id=*/*user0.id.Value(),
         /*query=*/std::nullopt,
         /*oneof_user_relations=*/std::unordered_set<e8::UserRelation>{e8::URL_CONTACT}, pagination,
-        db_conns);
+        /*search_index=*/nullptr, db_conns);
 
     TEST_CONDITION(searched_users.size() == 1);
     TEST_CONDITION(*searched_users[0].id.Value() == *user1.id.Value());
@@ -174,11 +183,102 @@ bool SearchUserByRelationTest() {
     return true;
 }
 
+bool SearchUserWithIndexTest() {
+    e8::DemoWebTestEnvironmentContext env;
+    e8::ConnectionReservoirInterface *db_conns = env.DemowebDatabase();
+    e8::UserSearchIndex *search_index = env.SearchableUsers();
+
+    e8::UserEntity user0 = e8::CreateBaselineUser(/*security_key=*/"PASS", /*user_id=*/1L,
+                                                  env.CurrentHostId(), db_conns)
+                               .value();
+    e8::UserEntity user1 = e8::CreateBaselineUser(/*security_key=*/"PASS", /*userId=*/2L,
+                                                  env.CurrentHostId(), db_conns)
+                               .value();
+    e8::UserEntity user2 = e8::CreateBaselineUser(/*security_key=*/"PASS", /*userId=*/3L,
+                                                  env.CurrentHostId(), db_conns)
+                               .value();
+    e8::UpdateProfile(/*alias=*/"John Jr. B", std::nullopt, &user0, /*profile_cache=*/nullptr,
+                      search_index, db_conns);
+
+    // The index is built after some of the users were created.
+    e8::BuildUserSearchIndex(/*batch_size=*/2, search_index, db_conns);
+    TEST_CONDITION(search_index->Warm());
+
+    e8::UpdateProfile(/*alias=*/"John Jr. A", std::nullopt, &user1, /*profile_cache=*/nullptr,
+                      search_index, db_conns);
+    e8::UpdateProfile(/*alias=*/"Stieve Jr. A", std::nullopt, &user2, /*profile_cache=*/nullptr,
+                      search_index, db_conns);
+
+    bool rc = e8::CreateContact(*user2.id.Value(), *user0.id.Value(), db_conns);
+    TEST_CONDITION(rc == true);
+
+    e8::Pagination pagination;
+    pagination.set_page_number(0);
+    pagination.set_result_per_page(2);
+    std::vector<e8::UserEntity> page0 = e8::SearchUser(
+        std::optional<e8::UserId>(),
+        /*query=*/"John Jr.", /*oneof_user_relations=*/std::unordered_set<e8::UserRelation>(),
+        pagination, search_index, db_conns);
+    TEST_CONDITION(page0.size() == 2);
+    TEST_CONDITION(page0[0].id.Value().value() == 2L);
+    TEST_CONDITION(page0[1].id.Value().value() == 1L);
+
+    std::vector<e8::UserEntity> contacts = e8::SearchUser(
+        /*viewer_id=*/*user2.id.Value(), /*query=*/"Jo",
+        /*oneof_user_relations=*/std::unordered_set<e8::UserRelation>{e8::URL_CONTACT},
+        pagination, search_index, db_conns);
+    TEST_CONDITION(contacts.size() == 1);
+    TEST_CONDITION(contacts[0].id.Value().value() == 1L);
+
+    std::vector<e8::UserEntity> no_match = e8::SearchUser(
+        std::optional<e8::UserId>(),
+        /*query=*/"Alice", /*oneof_user_relations=*/std::unordered_set<e8::UserRelation>(),
+        pagination, search_index, db_conns);
+    TEST_CONDITION(no_match.empty());
+
+    // A user updated through another host is missing from the index but still found.
+    e8::UpdateProfile(/*alias=*/"Alice", std::nullopt, &user2, /*profile_cache=*/nullptr,
+                      /*search_index=*/nullptr, db_conns);
+    std::vector<e8::UserEntity> remote_update = e8::SearchUser(
+        std::optional<e8::UserId>(),
+        /*query=*/"Alice", /*oneof_user_relations=*/std::unordered_set<e8::UserRelation>(),
+        pagination, search_index, db_conns);
+    TEST_CONDITION(remote_update.size() == 1);
+    TEST_CONDITION(remote_update[0].id.Value().value() == 3L);
+
+    // The index still matches user1 by its stale alias, but the database doesn't.
+    e8::UpdateProfile(/*alias=*/"Bob", std::nullopt, &user1, /*profile_cache=*/nullptr,
+                      /*search_index=*/nullptr, db_conns);
+    std::vector<e8::UserEntity> stale_alias = e8::SearchUser(
+        std::optional<e8::UserId>(),
+        /*query=*/"John Jr.", /*oneof_user_relations=*/std::unordered_set<e8::UserRelation>(),
+        pagination, search_index, db_conns);
+    TEST_CONDITION(stale_alias.size() == 1);
+    TEST_CONDITION(stale_alias[0].id.Value().value() == 1L);
+
+    // A user created through another host after the build is found next to the indexed matches.
+    e8::UserEntity user3 = e8::CreateBaselineUser(/*security_key=*/"PASS", /*userId=*/4L,
+                                                  env.CurrentHostId(), db_conns)
+                               .value();
+    e8::UpdateProfile(/*alias=*/"John Jr. C", std::nullopt, &user3, /*profile_cache=*/nullptr,
+                      /*search_index=*/nullptr, db_conns);
+    std::vector<e8::UserEntity> remote_create = e8::SearchUser(
+        std::optional<e8::UserId>(),
+        /*query=*/"John Jr.", /*oneof_user_relations=*/std::unordered_set<e8::UserRelation>(),
+        pagination, search_index, db_conns);
+    TEST_CONDITION(remote_create.size() == 2);
+    TEST_CONDITION(remote_create[0].id.Value().value() == 1L);
+    TEST_CONDITION(remote_create[1].id.Value().value() == 4L);
+
+    return true;
+}
+
 int main() {
     e8::BeginTestSuite("search_user");
     e8::RunTest("SearchUserByIdPrefixTest", SearchUserByIdPrefixTest);
     e8::RunTest("SearchUserByIdAliasTest", SearchUserByIdAliasTest);
     e8::RunTest("SearchUserByRelationTest", SearchUserByRelationTest);
+    e8::RunTest("SearchUserWithIndexTest", SearchUserWithIndexTest);
     e8::EndTestSuite();
     return 0;
 }
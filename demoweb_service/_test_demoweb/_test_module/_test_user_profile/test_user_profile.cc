@@ -15,11 +15,16 @@
  * not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <optional>
 #include <string>
+#include <vector>
 
 #include "common/unit_test_util/unit_test_util.h"
+#include "demoweb_service/demoweb/common_entity/user_entity.h"
+#include "demoweb_service/demoweb/module/public_profile_cache.h"
 #include "demoweb_service/demoweb/module/user_profile.h"
 #include "proto_cc/file.pb.h"
+#include "proto_cc/user_profile.pb.h"
 
 // TODO: enrich this test suite.
 
@@ -39,11 +44,38 @@ bool AllocateNewAvatarLocationWithOldPathTest() {
     return true;
 }
 
+bool BuildPublicProfilesWithCacheTest() {
+    e8::PublicProfileCache cache(/*num_shards=*/4, /*max_num_profiles_per_shard=*/10,
+                                 /*time_to_live=*/60LL * 1000 * 1000);
+
+    e8::UserEntity user;
+    *user.id.ValuePtr() = 1L;
+    *user.alias.ValuePtr() = "alias";
+    *user.created_at.ValuePtr() = 1;
+
+    std::vector<e8::UserPublicProfile> first_profiles = e8::BuildPublicProfiles(
+        /*viewer_id=*/std::nullopt, {user}, /*key_gen=*/nullptr, &cache, /*db_conns=*/nullptr);
+    std::vector<e8::UserPublicProfile> second_profiles = e8::BuildPublicProfiles(
+        /*viewer_id=*/std::nullopt, {user}, /*key_gen=*/nullptr, &cache, /*db_conns=*/nullptr);
+
+    TEST_CONDITION(cache.GetStats().num_misses == 1);
+    TEST_CONDITION(cache.GetStats().num_hits == 1);
+
+    TEST_CONDITION(first_profiles.size() == 1);
+    TEST_CONDITION(second_profiles.size() == 1);
+    TEST_CONDITION(second_profiles[0].user_id() == 1L);
+    TEST_CONDITION(second_profiles[0].alias().value() == "alias");
+    TEST_CONDITION(second_profiles[0].relations().empty());
+
+    return true;
+}
+
 int main() {
     e8::BeginTestSuite("user_profile");
     e8::RunTest("AllocateNewAvatarLocationTest", AllocateNewAvatarLocationTest);
     e8::RunTest("AllocateNewAvatarLocationWithOldPathTest",
                 AllocateNewAvatarLocationWithOldPathTest);
+    e8::RunTest("BuildPublicProfilesWithCacheTest", BuildPublicProfilesWithCacheTest);
     e8::EndTestSuite();
     return 0;
 }
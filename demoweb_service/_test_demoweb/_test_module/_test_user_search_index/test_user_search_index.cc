@@ -0,0 +1,159 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "common/unit_test_util/unit_test_util.h"
+#include "demoweb_service/demoweb/common_entity/user_entity.h"
+#include "demoweb_service/demoweb/module/user_search_index.h"
+
+namespace {
+
+unsigned const kMaxNumCandidates = 10;
+
+e8::UserEntity MakeUser(e8::UserId const user_id, std::string const &alias) {
+    e8::UserEntity user;
+    *user.id.ValuePtr() = user_id;
+    *user.id_str.ValuePtr() = std::to_string(user_id);
+    *user.alias.ValuePtr() = alias;
+    return user;
+}
+
+e8::UserSearchIndex *MakeWarm(e8::UserSearchIndex *index) {
+    index->BeginBuild();
+    index->CompleteBuild();
+    return index;
+}
+
+} // namespace
+
+bool TokenizeTest() {
+    TEST_CONDITION((e8::UserSearchIndex::Tokenize("  John Jr.  A,b ") ==
+                    std::vector<std::string>{"john", "jr", "a", "b"}));
+    TEST_CONDITION(e8::UserSearchIndex::Tokenize(" .. ").empty());
+    return true;
+}
+
+bool ColdIndexTest() {
+    e8::UserSearchIndex index(kMaxNumCandidates);
+    index.Put(MakeUser(/*user_id=*/1L, "John"));
+
+    TEST_CONDITION(!index.Warm());
+    TEST_CONDITION(!index.Search("John").has_value());
+
+    return true;
+}
+
+bool PrefixSearchTest() {
+    e8::UserSearchIndex index(kMaxNumCandidates);
+    MakeWarm(&index);
+
+    index.Put(MakeUser(/*user_id=*/12300L, "John Jr. A"));
+    index.Put(MakeUser(/*user_id=*/12301L, "John Jr. B"));
+    index.Put(MakeUser(/*user_id=*/22300L, "Johnny Sr."));
+
+    std::optional<std::unordered_set<e8::UserId>> result = index.Search("123");
+    TEST_CONDITION(result.has_value());
+    TEST_CONDITION((*result == std::unordered_set<e8::UserId>{12300L, 12301L}));
+
+    result = index.Search("jOhN");
+    TEST_CONDITION((*result == std::unordered_set<e8::UserId>{12300L, 12301L, 22300L}));
+
+    // Every word but the last has to be matched exactly.
+    result = index.Search("John Jr.");
+    TEST_CONDITION((*result == std::unordered_set<e8::UserId>{12300L, 12301L}));
+
+    result = index.Search("John s");
+    TEST_CONDITION(result->empty());
+
+    result = index.Search("Jo B");
+    TEST_CONDITION(result->empty());
+
+    result = index.Search("");
+    TEST_CONDITION(result.has_value());
+    TEST_CONDITION(result->empty());
+
+    return true;
+}
+
+bool UpdateTest() {
+    e8::UserSearchIndex index(kMaxNumCandidates);
+    MakeWarm(&index);
+
+    index.Put(MakeUser(/*user_id=*/1L, "John"));
+    index.Put(MakeUser(/*user_id=*/1L, "Stieve"));
+
+    TEST_CONDITION(index.Search("John")->empty());
+    TEST_CONDITION((*index.Search("Stie") == std::unordered_set<e8::UserId>{1L}));
+
+    e8::UserEntity user = MakeUser(/*user_id=*/1L, "Stieve");
+    *user.alias.ValuePtr() = std::nullopt;
+    *user.biography.ValuePtr() = "Loves chess";
+    index.Put(user);
+
+    TEST_CONDITION(index.Search("Stie")->empty());
+    TEST_CONDITION((*index.Search("chess") == std::unordered_set<e8::UserId>{1L}));
+
+    return true;
+}
+
+bool BuildTest() {
+    e8::UserSearchIndex index(kMaxNumCandidates);
+
+    index.BeginBuild();
+    // Updated while the snapshot is being loaded.
+    index.Put(MakeUser(/*user_id=*/1L, "New"));
+    index.Load({MakeUser(/*user_id=*/1L, "Old"), MakeUser(/*user_id=*/2L, "Other")});
+    TEST_CONDITION(!index.Warm());
+    index.CompleteBuild();
+
+    TEST_CONDITION(index.Warm());
+    TEST_CONDITION((*index.Search("new") == std::unordered_set<e8::UserId>{1L}));
+    TEST_CONDITION(index.Search("old")->empty());
+    TEST_CONDITION((*index.Search("other") == std::unordered_set<e8::UserId>{2L}));
+
+    return true;
+}
+
+bool TooBroadQueryTest() {
+    e8::UserSearchIndex index(/*max_num_candidates=*/2);
+    MakeWarm(&index);
+
+    index.Put(MakeUser(/*user_id=*/1L, "John A"));
+    index.Put(MakeUser(/*user_id=*/2L, "John B"));
+    index.Put(MakeUser(/*user_id=*/3L, "Johnny"));
+
+    TEST_CONDITION(!index.Search("Jo").has_value());
+    TEST_CONDITION((*index.Search("John a") == std::unordered_set<e8::UserId>{1L}));
+
+    return true;
+}
+
+int main() {
+    e8::BeginTestSuite("user_search_index");
+    e8::RunTest("TokenizeTest", TokenizeTest);
+    e8::RunTest("ColdIndexTest", ColdIndexTest);
+    e8::RunTest("PrefixSearchTest", PrefixSearchTest);
+    e8::RunTest("UpdateTest", UpdateTest);
+    e8::RunTest("BuildTest", BuildTest);
+    e8::RunTest("TooBroadQueryTest", TooBroadQueryTest);
+    e8::EndTestSuite();
+    return 0;
+}
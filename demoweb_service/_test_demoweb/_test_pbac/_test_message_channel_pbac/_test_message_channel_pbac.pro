@@ -28,6 +28,16 @@ unix:!macx: LIBS += -L$$OUT_PWD/../../../../common/time_util/ -ltime_util
 INCLUDEPATH += $$PWD/../../../../common/time_util
 DEPENDPATH += $$PWD/../../../../common/time_util
 
+unix:!macx: LIBS += -L$$OUT_PWD/../../../../common/thread/ -lthread
+
+INCLUDEPATH += $$PWD/../../../../common/thread
+DEPENDPATH += $$PWD/../../../../common/thread
+
+unix:!macx: LIBS += -L$$OUT_PWD/../../../../file_system/ -lfilesystem
+
+INCLUDEPATH += $$PWD/../../../../file_system
+DEPENDPATH += $$PWD/../../../../file_system
+
 unix:!macx: LIBS += -L$$OUT_PWD/../../../../postgres/query_runner/ -lquery_runner
 
 INCLUDEPATH += $$PWD/../../../../postgres/query_runner
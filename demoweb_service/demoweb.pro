@@ -5,17 +5,23 @@ SUBDIRS = \
     _test_demoweb/_test_module/_test_baseline_user/_test_baseline_user.pro \
     _test_demoweb/_test_module/_test_message_channel_storage/_test_message_channel_storage.pro \
     _test_demoweb/_test_module/_test_message_channel/_test_message_channel.pro \
+    _test_demoweb/_test_module/_test_message_channel_benchmark/_test_message_channel_benchmark.pro \
     _test_demoweb/_test_module/_test_user_storage/_test_user_storage.pro \
     _test_demoweb/_test_module/_test_user_identity/_test_user_identity.pro \
     _test_demoweb/_test_module/_test_user_profile/_test_user_profile.pro \
     _test_demoweb/_test_module/_test_file_access_validator/_test_file_access_validator.pro \
+    _test_demoweb/_test_module/_test_file_io/_test_file_io.pro \
     _test_demoweb/_test_module/_test_contact_invitation/_test_contact_invitation.pro \
     _test_demoweb/_test_module/_test_contact_storage/_test_contact_storage.pro \
     _test_demoweb/_test_module/_test_search_user/_test_search_user.pro \
     _test_demoweb/_test_module/_test_chat_message_group_storage/_test_chat_message_group_storage.pro \
     _test_demoweb/_test_module/_test_chat_message_group/_test_chat_message_group.pro \
     _test_demoweb/_test_module/_test_chat_message_storage/_test_chat_message_storage.pro \
+    _test_demoweb/_test_module/_test_chat_message_storage_benchmark/_test_chat_message_storage_benchmark.pro \
     _test_demoweb/_test_module/_test_chat_message/_test_chat_message.pro \
+    _test_demoweb/_test_module/_test_chat_message_cache/_test_chat_message_cache.pro \
+    _test_demoweb/_test_module/_test_public_profile_cache/_test_public_profile_cache.pro \
+    _test_demoweb/_test_module/_test_user_search_index/_test_user_search_index.pro \
     _test_demoweb/_test_pbac/_test_message_channel_attributes/_test_message_channel_attributes.pro \
     _test_demoweb/_test_pbac/_test_message_channel_member_attributes/_test_message_channel_member_attributes.pro \
     _test_demoweb/_test_pbac/_test_message_channel_pbac/_test_message_channel_pbac.pro
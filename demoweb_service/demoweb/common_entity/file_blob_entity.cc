@@ -0,0 +1,43 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "demoweb_service/demoweb/common_entity/file_blob_entity.h"
+#include "postgres/query_runner/reflection/sql_entity_interface.h"
+
+namespace e8 {
+
+FileBlobEntity::FileBlobEntity()
+    : SqlEntityInterface({&content_hash, &storage_size, &ref_count, &committed, &created_at}) {}
+
+FileBlobEntity::FileBlobEntity(FileBlobEntity const &other) : FileBlobEntity() {
+    content_hash = other.content_hash;
+    storage_size = other.storage_size;
+    ref_count = other.ref_count;
+    committed = other.committed;
+    created_at = other.created_at;
+}
+
+FileBlobEntity &FileBlobEntity::operator=(FileBlobEntity const &other) {
+    content_hash = other.content_hash;
+    storage_size = other.storage_size;
+    ref_count = other.ref_count;
+    committed = other.committed;
+    created_at = other.created_at;
+    return *this;
+}
+
+} // namespace e8
@@ -0,0 +1,47 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FILEBLOBENTITY_H
+#define FILEBLOBENTITY_H
+
+#include "postgres/query_runner/reflection/sql_entity_interface.h"
+#include "postgres/query_runner/reflection/sql_primitives.h"
+
+namespace e8 {
+
+/**
+ * @brief The FileBlobEntity class C++ class representation of the database table
+ * "file_blob".
+ */
+class FileBlobEntity : public SqlEntityInterface {
+  public:
+    FileBlobEntity();
+    FileBlobEntity(FileBlobEntity const &other);
+    ~FileBlobEntity() = default;
+
+    FileBlobEntity &operator=(FileBlobEntity const &other);
+
+    SqlStr content_hash = SqlStr("content_hash");
+    SqlLong storage_size = SqlLong("storage_size");
+    SqlInt ref_count = SqlInt("ref_count");
+    SqlBool committed = SqlBool("committed");
+    SqlTimestamp created_at = SqlTimestamp("created_at");
+};
+
+} // namespace e8
+
+#endif // FILEBLOBENTITY_H
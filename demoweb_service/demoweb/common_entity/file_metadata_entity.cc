@@ -21,14 +21,15 @@
 namespace e8 {
 
 FileMetadataEntity::FileMetadataEntity()
-    : SqlEntityInterface({&path, &format, &encryption_key_source, &storage_size, &created_at,
-                          &last_modified_at}) {}
+    : SqlEntityInterface({&path, &format, &encryption_key_source, &storage_size, &content_hash,
+                          &created_at, &last_modified_at}) {}
 
 FileMetadataEntity::FileMetadataEntity(FileMetadataEntity const &other) : FileMetadataEntity() {
     path = other.path;
     format = other.format;
     encryption_key_source = other.encryption_key_source;
     storage_size = other.storage_size;
+    content_hash = other.content_hash;
     created_at = other.created_at;
     last_modified_at = other.last_modified_at;
 }
@@ -38,6 +39,7 @@ FileMetadataEntity &FileMetadataEntity::operator=(FileMetadataEntity const &othe
     format = other.format;
     encryption_key_source = other.encryption_key_source;
     storage_size = other.storage_size;
+    content_hash = other.content_hash;
     created_at = other.created_at;
     last_modified_at = other.last_modified_at;
     return *this;
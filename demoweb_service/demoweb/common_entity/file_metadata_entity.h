@@ -39,6 +39,7 @@ class FileMetadataEntity : public SqlEntityInterface {
     SqlInt format = SqlInt("format");
     SqlInt encryption_key_source = SqlInt("encryption_key_source");
     SqlLong storage_size = SqlLong("storage_size");
+    SqlStr content_hash = SqlStr("content_hash");
     SqlTimestamp created_at = SqlTimestamp("created_at");
     SqlTimestamp last_modified_at = SqlTimestamp("last_modified_at");
 };
@@ -0,0 +1,40 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include "common/time_util/time_util.h"
+
+namespace e8 {
+
+static unsigned const kChatMessageCacheMaxNumGroups = 4096;
+static unsigned const kChatMessageCacheMaxNumMessagesPerGroup = 64;
+
+// Has to be shorter than the valid duration of file access tokens since cached entries carry them.
+static TimestampMicros const kChatMessageCacheTimeToLiveMicros = 5LL * 60 * 1000 * 1000;
+
+static unsigned const kPublicProfileCacheNumShards = 16;
+static unsigned const kPublicProfileCacheMaxNumProfilesPerShard = 1024;
+static TimestampMicros const kPublicProfileCacheTimeToLiveMicros = 5LL * 60 * 1000 * 1000;
+
+static unsigned const kUserSearchIndexMaxNumCandidates = 1024;
+static unsigned const kUserSearchIndexBuildBatchSize = 1024;
+
+} // namespace e8
+
+#endif // CACHE_H
@@ -30,6 +30,7 @@ static char const kDemowebDatabaseName[] = "demoweb";
 struct TableNames {
     static std::string AUser() { return "auser"; }
     static std::string FileMetadata() { return "file_metadata"; }
+    static std::string FileBlob() { return "file_blob"; }
     static std::string KeyPersistence() { return "key_persistence"; }
     static std::string EmailSet() { return "email_set"; }
     static std::string UserGroup() { return "user_group"; }
@@ -22,6 +22,8 @@ namespace e8 {
 
 static char const kUserDataPathPrefix[] = "user";
 static char const kAvatarPathPrefix[] = "avatar";
+static char const kFileBlobPathPrefix[] = "blob";
+static char const kFileStagingPathPrefix[] = "staging";
 
 } // namespace e8
 
@@ -0,0 +1,34 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FILE_TRANSFER_H
+#define FILE_TRANSFER_H
+
+#include <cstdint>
+
+namespace e8 {
+
+// All the file chunks but the last one of a file must be of this size. It stays well below the
+// default 4MB gRPC message size limit.
+static uint64_t const kFileChunkSize = 256 * 1024;
+
+// Uploads can't grow a file beyond this size.
+static uint64_t const kMaxFileSize = 1024 * kFileChunkSize;
+
+} // namespace e8
+
+#endif // FILE_TRANSFER_H
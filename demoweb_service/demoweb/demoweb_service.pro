@@ -18,14 +18,18 @@ HEADERS += \
     common_entity/chat_message_entity.h \
     common_entity/chat_message_group_entity.h \
     common_entity/contact_relation_entity.h \
+    common_entity/file_blob_entity.h \
     common_entity/file_metadata_entity.h \
     common_entity/message_channel_entity.h \
     common_entity/message_channel_has_user_entity.h \
     common_entity/user_entity.h \
     common_entity/user_group_entity.h \
     common_entity/user_group_has_file_entity.h \
+    constant/background_task.h \
+    constant/cache.h \
     constant/demoweb_database.h \
     constant/file_path.h \
+    constant/file_transfer.h \
     constant/pagination.h \
     environment/environment_context_interface.h \
     environment/host_id.h \
@@ -33,17 +37,21 @@ HEADERS += \
     environment/test_environment_context.h \
     module/baseline_user.h \
     module/chat_message.h \
+    module/chat_message_cache.h \
     module/chat_message_group.h \
     module/chat_message_group_storage.h \
     module/chat_message_storage.h \
     module/contact_invitation.h \
     module/contact_storage.h \
     module/file_access_validator.h \
+    module/file_blob.h \
     module/file_io.h \
     module/file_metadata.h \
     module/file_util.h \
     module/message_channel.h \
     module/message_channel_storage.h \
+    module/public_profile_cache.h \
+    module/user_search_index.h \
     module/push_message.h \
     module/search_user.h \
     module/system_user_group.h \
@@ -64,6 +72,7 @@ SOURCES += \
     common_entity/chat_message_entity.cc \
     common_entity/chat_message_group_entity.cc \
     common_entity/contact_relation_entity.cc \
+    common_entity/file_blob_entity.cc \
     common_entity/file_metadata_entity.cc \
     common_entity/message_channel_entity.cc \
     common_entity/message_channel_has_user_entity.cc \
@@ -76,17 +85,21 @@ SOURCES += \
     environment/test_environment_context.cc \
     module/baseline_user.cc \
     module/chat_message.cc \
+    module/chat_message_cache.cc \
     module/chat_message_group.cc \
     module/chat_message_group_storage.cc \
     module/chat_message_storage.cc \
     module/contact_invitation.cc \
     module/contact_storage.cc \
     module/file_access_validator.cc \
+    module/file_blob.cc \
     module/file_io.cc \
     module/file_metadata.cc \
     module/file_util.cc \
     module/message_channel.cc \
     module/message_channel_storage.cc \
+    module/public_profile_cache.cc \
+    module/user_search_index.cc \
     module/push_message.cc \
     module/search_user.cc \
     module/user_identity.cc \
@@ -107,6 +120,16 @@ unix:!macx: LIBS += -L$$OUT_PWD/../../common/time_util/ -ltime_util
 INCLUDEPATH += $$PWD/../../common/time_util
 DEPENDPATH += $$PWD/../../common/time_util
 
+unix:!macx: LIBS += -L$$OUT_PWD/../../common/thread/ -lthread
+
+INCLUDEPATH += $$PWD/../../common/thread
+DEPENDPATH += $$PWD/../../common/thread
+
+unix:!macx: LIBS += -L$$OUT_PWD/../../file_system/ -lfilesystem
+
+INCLUDEPATH += $$PWD/../../file_system
+DEPENDPATH += $$PWD/../../file_system
+
 unix:!macx: LIBS += -L$$OUT_PWD/../../postgres/query_runner/ -lquery_runner
 
 INCLUDEPATH += $$PWD/../../postgres/query_runner
@@ -20,8 +20,13 @@
 
 #include <vector>
 
+#include "common/thread/thread_pool.h"
 #include "demoweb_service/demoweb/environment/host_id.h"
+#include "demoweb_service/demoweb/module/chat_message_cache.h"
+#include "demoweb_service/demoweb/module/public_profile_cache.h"
+#include "demoweb_service/demoweb/module/user_search_index.h"
 #include "demoweb_service/demoweb/pbac/message_channel_pbac.h"
+#include "file_system/file_system_interface.h"
 #include "keygen/key_generator_interface.h"
 #include "message_queue/publisher/publisher.h"
 #include "postgres/query_runner/connection/connection_reservoir_interface.h"
@@ -71,6 +76,32 @@ class DemoWebEnvironmentContextInterface {
      * @brief MessageChannelPbac Message channel access controller.
      */
     virtual MessageChannelPbacInterface *MessageChannelPbac() = 0;
+
+    /**
+     * @brief RecentChatMessages Cache of the latest chat messages of active chat message groups.
+     */
+    virtual ChatMessageCache *RecentChatMessages() = 0;
+
+    /**
+     * @brief PublicProfiles Cache of the viewer-independent part of user public profiles.
+     */
+    virtual PublicProfileCache *PublicProfiles() = 0;
+
+    /**
+     * @brief SearchableUsers In-memory index of the users for the text search.
+     */
+    virtual UserSearchIndex *SearchableUsers() = 0;
+
+    /**
+     * @brief BackgroundTasks Worker threads for the work that doesn't have to finish before
+     * responding to the client, such as pushing notifications.
+     */
+    virtual ThreadPool *BackgroundTasks() = 0;
+
+    /**
+     * @brief FileStore Storage of the uploaded files.
+     */
+    virtual FileSystemInterface *FileStore() = 0;
 };
 
 /**
@@ -19,11 +19,16 @@
 #include <memory>
 #include <vector>
 
+#include "common/thread/thread_pool.h"
 #include "constant/demoweb_database.h"
+#include "demoweb_service/demoweb/constant/background_task.h"
+#include "demoweb_service/demoweb/constant/cache.h"
 #include "demoweb_service/demoweb/environment/host_id.h"
 #include "demoweb_service/demoweb/environment/prod_environment_context.h"
+#include "demoweb_service/demoweb/module/search_user.h"
 #include "demoweb_service/demoweb/pbac/message_channel_pbac.h"
 #include "distributor/store/default_node_state_store.h"
+#include "file_system/local_file_system.h"
 #include "keygen/persistent_key_generator.h"
 #include "postgres/query_runner/connection/connection_factory.h"
 #include "postgres/query_runner/connection/pooled_connection_reservoir.h"
@@ -33,7 +38,7 @@ namespace e8 {
 
 DemoWebProductionEnvironmentContext::DemoWebProductionEnvironmentContext(
     std::string const &db_hostname, std::string const &node_state_db_path,
-    MessageQueueServicePort const message_queue_port) {
+    MessageQueueServicePort const message_queue_port, std::string const &file_store_path) {
     InitDefaultNodeStateStoreProvider(node_state_db_path);
 
     ConnectionFactory fact(ConnectionFactory::PQ, db_hostname, kDemowebDatabaseName);
@@ -50,6 +55,22 @@ DemoWebProductionEnvironmentContext::DemoWebProductionEnvironmentContext(
         std::make_unique<E8MessagePublisher>(DefaultNodeStateStore(), message_queue_port);
 
     message_channel_pbac_ = std::make_unique<MessageChannelPbacImpl>(demoweb_database_.get());
+
+    recent_chat_messages_ = std::make_unique<ChatMessageCache>(
+        kChatMessageCacheMaxNumGroups, kChatMessageCacheMaxNumMessagesPerGroup,
+        kChatMessageCacheTimeToLiveMicros);
+
+    public_profiles_ = std::make_unique<PublicProfileCache>(
+        kPublicProfileCacheNumShards, kPublicProfileCacheMaxNumProfilesPerShard,
+        kPublicProfileCacheTimeToLiveMicros);
+
+    searchable_users_ = std::make_unique<UserSearchIndex>(kUserSearchIndexMaxNumCandidates);
+
+    background_tasks_ = std::make_unique<ThreadPool>(kNumBackgroundTaskWorkers);
+    background_tasks_->Schedule(std::make_shared<BuildUserSearchIndexTask>(
+        kUserSearchIndexBuildBatchSize, searchable_users_.get(), demoweb_database_.get()));
+
+    file_store_ = std::make_unique<LocalFileSystem>(file_store_path);
 }
 
 DemoWebEnvironmentContextInterface::Environment
@@ -74,4 +95,22 @@ MessageChannelPbacInterface *DemoWebProductionEnvironmentContext::MessageChannel
     return message_channel_pbac_.get();
 }
 
+ChatMessageCache *DemoWebProductionEnvironmentContext::RecentChatMessages() {
+    return recent_chat_messages_.get();
+}
+
+PublicProfileCache *DemoWebProductionEnvironmentContext::PublicProfiles() {
+    return public_profiles_.get();
+}
+
+UserSearchIndex *DemoWebProductionEnvironmentContext::SearchableUsers() {
+    return searchable_users_.get();
+}
+
+ThreadPool *DemoWebProductionEnvironmentContext::BackgroundTasks() {
+    return background_tasks_.get();
+}
+
+FileSystemInterface *DemoWebProductionEnvironmentContext::FileStore() { return file_store_.get(); }
+
 } // namespace e8
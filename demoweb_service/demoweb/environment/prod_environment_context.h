@@ -23,9 +23,14 @@
 #include <string>
 #include <vector>
 
+#include "common/thread/thread_pool.h"
 #include "demoweb_service/demoweb/environment/environment_context_interface.h"
 #include "demoweb_service/demoweb/environment/host_id.h"
+#include "demoweb_service/demoweb/module/chat_message_cache.h"
+#include "demoweb_service/demoweb/module/public_profile_cache.h"
+#include "demoweb_service/demoweb/module/user_search_index.h"
 #include "demoweb_service/demoweb/pbac/message_channel_pbac.h"
+#include "file_system/file_system_interface.h"
 #include "keygen/key_generator_interface.h"
 #include "message_queue/common/entity.h"
 #include "message_queue/publisher/publisher.h"
@@ -41,7 +46,8 @@ class DemoWebProductionEnvironmentContext : public DemoWebEnvironmentContextInte
   public:
     DemoWebProductionEnvironmentContext(std::string const &demoweb_db_hostname,
                                         std::string const &node_state_db_path,
-                                        MessageQueueServicePort const message_queue_port);
+                                        MessageQueueServicePort const message_queue_port,
+                                        std::string const &file_store_path);
     ~DemoWebProductionEnvironmentContext() override = default;
 
     Environment EnvironmentType() const override;
@@ -56,11 +62,26 @@ class DemoWebProductionEnvironmentContext : public DemoWebEnvironmentContextInte
 
     MessageChannelPbacInterface *MessageChannelPbac() override;
 
+    ChatMessageCache *RecentChatMessages() override;
+
+    PublicProfileCache *PublicProfiles() override;
+
+    UserSearchIndex *SearchableUsers() override;
+
+    ThreadPool *BackgroundTasks() override;
+
+    FileSystemInterface *FileStore() override;
+
   private:
     std::unique_ptr<ConnectionReservoirInterface> demoweb_database_;
     std::unique_ptr<KeyGeneratorInterface> key_gen_;
     std::unique_ptr<E8MessagePublisher> e8_message_publisher_;
     std::unique_ptr<MessageChannelPbacInterface> message_channel_pbac_;
+    std::unique_ptr<ChatMessageCache> recent_chat_messages_;
+    std::unique_ptr<PublicProfileCache> public_profiles_;
+    std::unique_ptr<UserSearchIndex> searchable_users_;
+    std::unique_ptr<ThreadPool> background_tasks_;
+    std::unique_ptr<FileSystemInterface> file_store_;
     unsigned host_id_;
     int32_t padding_;
 };
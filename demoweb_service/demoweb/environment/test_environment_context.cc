@@ -16,13 +16,18 @@
  */
 
 #include <cassert>
+#include <filesystem>
 #include <memory>
 #include <vector>
 
+#include "common/thread/thread_pool.h"
 #include "constant/demoweb_database.h"
+#include "demoweb_service/demoweb/constant/background_task.h"
+#include "demoweb_service/demoweb/constant/cache.h"
 #include "demoweb_service/demoweb/environment/host_id.h"
 #include "demoweb_service/demoweb/environment/test_environment_context.h"
 #include "demoweb_service/demoweb/pbac/message_channel_pbac.h"
+#include "file_system/local_file_system.h"
 #include "keygen/persistent_key_generator.h"
 #include "postgres/query_runner/connection/connection_factory.h"
 #include "postgres/query_runner/connection/pooled_connection_reservoir.h"
@@ -43,6 +48,23 @@ DemoWebTestEnvironmentContext::DemoWebTestEnvironmentContext() {
 
     message_channel_pbac_ = std::make_unique<MessageChannelPbacImpl>(demoweb_database_.get());
 
+    recent_chat_messages_ = std::make_unique<ChatMessageCache>(
+        kChatMessageCacheMaxNumGroups, kChatMessageCacheMaxNumMessagesPerGroup,
+        kChatMessageCacheTimeToLiveMicros);
+
+    public_profiles_ = std::make_unique<PublicProfileCache>(
+        kPublicProfileCacheNumShards, kPublicProfileCacheMaxNumProfilesPerShard,
+        kPublicProfileCacheTimeToLiveMicros);
+
+    searchable_users_ = std::make_unique<UserSearchIndex>(kUserSearchIndexMaxNumCandidates);
+
+    background_tasks_ = std::make_unique<ThreadPool>(kNumBackgroundTaskWorkers);
+
+    std::filesystem::path file_store_path =
+        std::filesystem::temp_directory_path() / "demoweb_test_file_store";
+    std::filesystem::remove_all(file_store_path);
+    file_store_ = std::make_unique<LocalFileSystem>(file_store_path.string());
+
     host_id_ = 0;
 }
 
@@ -68,4 +90,20 @@ MessageChannelPbacInterface *DemoWebTestEnvironmentContext::MessageChannelPbac()
     return message_channel_pbac_.get();
 }
 
+ChatMessageCache *DemoWebTestEnvironmentContext::RecentChatMessages() {
+    return recent_chat_messages_.get();
+}
+
+PublicProfileCache *DemoWebTestEnvironmentContext::PublicProfiles() {
+    return public_profiles_.get();
+}
+
+UserSearchIndex *DemoWebTestEnvironmentContext::SearchableUsers() {
+    return searchable_users_.get();
+}
+
+ThreadPool *DemoWebTestEnvironmentContext::BackgroundTasks() { return background_tasks_.get(); }
+
+FileSystemInterface *DemoWebTestEnvironmentContext::FileStore() { return file_store_.get(); }
+
 } // namespace e8
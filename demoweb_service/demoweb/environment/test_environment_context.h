@@ -22,9 +22,14 @@
 #include <memory>
 #include <vector>
 
+#include "common/thread/thread_pool.h"
 #include "demoweb_service/demoweb/environment/environment_context_interface.h"
 #include "demoweb_service/demoweb/environment/host_id.h"
+#include "demoweb_service/demoweb/module/chat_message_cache.h"
+#include "demoweb_service/demoweb/module/public_profile_cache.h"
+#include "demoweb_service/demoweb/module/user_search_index.h"
 #include "demoweb_service/demoweb/pbac/message_channel_pbac.h"
+#include "file_system/file_system_interface.h"
 #include "keygen/key_generator_interface.h"
 #include "message_queue/publisher/publisher.h"
 #include "postgres/query_runner/connection/connection_reservoir_interface.h"
@@ -52,10 +57,25 @@ class DemoWebTestEnvironmentContext : public DemoWebEnvironmentContextInterface
 
     MessageChannelPbacInterface *MessageChannelPbac() override;
 
+    ChatMessageCache *RecentChatMessages() override;
+
+    PublicProfileCache *PublicProfiles() override;
+
+    UserSearchIndex *SearchableUsers() override;
+
+    ThreadPool *BackgroundTasks() override;
+
+    FileSystemInterface *FileStore() override;
+
   private:
     std::unique_ptr<ConnectionReservoirInterface> demoweb_database_;
     std::unique_ptr<KeyGeneratorInterface> key_gen_;
     std::unique_ptr<MessageChannelPbacInterface> message_channel_pbac_;
+    std::unique_ptr<ChatMessageCache> recent_chat_messages_;
+    std::unique_ptr<PublicProfileCache> public_profiles_;
+    std::unique_ptr<UserSearchIndex> searchable_users_;
+    std::unique_ptr<ThreadPool> background_tasks_;
+    std::unique_ptr<FileSystemInterface> file_store_;
     unsigned host_id_;
     int32_t padding_;
 };
@@ -20,10 +20,12 @@
 #include <grpcpp/ext/proto_server_reflection_plugin.h>
 #include <grpcpp/grpcpp.h>
 #include <grpcpp/health_check_service_interface.h>
+#include <grpcpp/resource_quota.h>
 #include <iostream>
 #include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "common/flags/parse_flags.h"
 #include "demoweb_service/demoweb/environment/environment_context_interface.h"
@@ -35,6 +37,7 @@
 #include "demoweb_service/demoweb/service/user_service.h"
 #include "message_queue/subscriber/environment/environment_context_interface.h"
 #include "message_queue/subscriber/environment/prod_environment_context.h"
+#include "message_queue/subscriber/service/message_subscriber_async_service.h"
 #include "message_queue/subscriber/service/message_subscriber_service.h"
 
 namespace {
@@ -44,8 +47,17 @@ static char const kGrpcWebProxyFlag[] = "grpc_web_proxy";
 static char const kDemowebDbHostNameFlag[] = "demoweb_db_host_name";
 static char const kNodeStateDbPathFlag[] = "node_state_db_path";
 static char const kMessageQueueServicePortFlag[] = "message_queue_service_port";
+static char const kFileStorePathFlag[] = "file_store_path";
+static char const kAsyncServerFlag[] = "async_server";
+static char const kNumCompletionQueuesFlag[] = "num_completion_queues";
+static char const kNumCompletionQueueThreadsFlag[] = "num_completion_queue_threads";
+static char const kMaxServerThreadsFlag[] = "max_server_threads";
 
 static int const kDefaultPort = 50051;
+static bool const kDefaultAsyncServer = true;
+static int const kDefaultNumCompletionQueues = 1;
+static int const kDefaultNumCompletionQueueThreads = 2;
+static int const kDefaultMaxServerThreads = 64;
 
 static e8::UserServiceImpl gUserService;
 static e8::FileServiceImpl gFileService;
@@ -53,6 +65,7 @@ static e8::SocialNetworkServiceImpl gSocialNetworkService;
 static e8::MessageChannelServiceImpl gMessageChannelService;
 static e8::ChatMessageServiceImpl gChatMessageService;
 static e8::MessageSubscriberServiceImpl gMessageSubscriberService;
+static e8::MessageSubscriberAsyncServiceImpl gMessageSubscriberAsyncService;
 
 std::unique_ptr<e8::DemoWebProductionEnvironmentContext> BuildDemoWebEnvironmentContext() {
     std::string demoweb_db_host_name =
@@ -67,8 +80,12 @@ std::unique_ptr<e8::DemoWebProductionEnvironmentContext> BuildDemoWebEnvironment
         kMessageQueueServicePortFlag, e8::MessageQueueServicePort(), e8::FromString<uint32_t>);
     assert(message_queue_service_port != 0);
 
+    std::string file_store_path =
+        e8::ReadFlag(kFileStorePathFlag, std::string(), e8::FromString<std::string>);
+    assert(!file_store_path.empty());
+
     auto context = std::make_unique<e8::DemoWebProductionEnvironmentContext>(
-        demoweb_db_host_name, node_state_db_path, message_queue_service_port);
+        demoweb_db_host_name, node_state_db_path, message_queue_service_port, file_store_path);
 
     return context;
 }
@@ -117,11 +134,50 @@ int main(int argc, char *argv[]) {
     builder.RegisterService(&gSocialNetworkService);
     builder.RegisterService(&gMessageChannelService);
     builder.RegisterService(&gChatMessageService);
-    builder.RegisterService(&gMessageSubscriberService);
+
+    // In the async mode, real-time message subscriptions are served off the completion queues so
+    // that idle subscribers don't hold any thread. The rest of the services block on the database,
+    // so they stay synchronous but run in a bounded thread pool. gRPC rejects the requests which
+    // arrive at a saturated pool with RESOURCE_EXHAUSTED.
+    bool async_server = e8::ReadFlag(kAsyncServerFlag, kDefaultAsyncServer, e8::FromString<bool>);
+    int num_cqs =
+        e8::ReadFlag(kNumCompletionQueuesFlag, kDefaultNumCompletionQueues, e8::FromString<int>);
+    std::vector<std::unique_ptr<grpc::ServerCompletionQueue>> cqs;
+    if (async_server) {
+        assert(num_cqs > 0);
+
+        int max_server_threads =
+            e8::ReadFlag(kMaxServerThreadsFlag, kDefaultMaxServerThreads, e8::FromString<int>);
+        assert(max_server_threads > 0);
+
+        grpc::ResourceQuota quota;
+        quota.SetMaxThreads(max_server_threads);
+        builder.SetResourceQuota(quota);
+        builder.SetSyncServerOption(grpc::ServerBuilder::SyncServerOption::NUM_CQS, num_cqs);
+
+        builder.RegisterService(&gMessageSubscriberAsyncService);
+        for (int i = 0; i < num_cqs; ++i) {
+            cqs.push_back(builder.AddCompletionQueue());
+        }
+    } else {
+        builder.RegisterService(&gMessageSubscriberService);
+    }
 
     std::unique_ptr<grpc::Server> server = builder.BuildAndStart();
     std::cout << "Server listening on " << server_address << std::endl;
 
+    if (async_server) {
+        int num_cq_threads = e8::ReadFlag(kNumCompletionQueueThreadsFlag,
+                                          kDefaultNumCompletionQueueThreads, e8::FromString<int>);
+        assert(num_cq_threads > 0);
+
+        std::vector<grpc::ServerCompletionQueue *> cq_ptrs;
+        for (auto const &cq : cqs) {
+            cq_ptrs.push_back(cq.get());
+        }
+        gMessageSubscriberAsyncService.Serve(cq_ptrs, static_cast<unsigned>(num_cq_threads));
+    }
+
     // Run GRPC web proxy.
     std::string grpc_web_proxy =
         e8::ReadFlag(kGrpcWebProxyFlag, std::string(), e8::FromString<std::string>);
@@ -15,6 +15,7 @@
  * not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <memory>
@@ -25,28 +26,36 @@
 #include <unordered_set>
 #include <vector>
 
+#include "common/thread/thread_pool.h"
 #include "demoweb_service/demoweb/common_entity/chat_message_group_entity.h"
+#include "demoweb_service/demoweb/common_entity/message_channel_has_user_entity.h"
 #include "demoweb_service/demoweb/common_entity/user_entity.h"
 #include "demoweb_service/demoweb/constant/demoweb_database.h"
 #include "demoweb_service/demoweb/module/chat_message.h"
+#include "demoweb_service/demoweb/module/chat_message_cache.h"
+#include "demoweb_service/demoweb/module/chat_message_group.h"
 #include "demoweb_service/demoweb/module/chat_message_group_storage.h"
 #include "demoweb_service/demoweb/module/chat_message_storage.h"
+#include "demoweb_service/demoweb/module/public_profile_cache.h"
+#include "demoweb_service/demoweb/module/push_message.h"
 #include "demoweb_service/demoweb/module/user_profile.h"
-#include "demoweb_service/demoweb/module/user_storage.h"
 #include "demoweb_service/demoweb/pbac/message_channel_pbac.h"
+#include "message_queue/publisher/publisher.h"
 #include "postgres/query_runner/connection/connection_reservoir_interface.h"
 #include "postgres/query_runner/reflection/sql_primitives.h"
 #include "postgres/query_runner/sql_query_builder.h"
 #include "postgres/query_runner/sql_runner.h"
 #include "proto_cc/chat_message.pb.h"
 #include "proto_cc/file.pb.h"
+#include "proto_cc/real_time_message.pb.h"
 
 namespace e8 {
 namespace {
 
 std::vector<ChatMessageEntry>
 ToChatMessageEntries(std::vector<std::tuple<ChatMessageEntity, UserEntity>> const &entities,
-                     KeyGeneratorInterface *key_gen, ConnectionReservoirInterface *conns) {
+                     KeyGeneratorInterface *key_gen, PublicProfileCache *profile_cache,
+                     ConnectionReservoirInterface *conns) {
     std::unordered_set<UserId> unique_sender_ids;
     std::vector<UserEntity> unqiue_senders;
     for (auto const &[_, sender] : entities) {
@@ -58,7 +67,8 @@ ToChatMessageEntries(std::vector<std::tuple<ChatMessageEntity, UserEntity>> cons
     }
 
     std::vector<UserPublicProfile> sender_profiles =
-        BuildPublicProfiles(/*viewer_id=*/std::nullopt, unqiue_senders, key_gen, conns);
+        BuildPublicProfiles(/*viewer_id=*/std::nullopt, unqiue_senders, key_gen, profile_cache,
+                            conns);
     std::unordered_map<UserId, UserPublicProfile const *> sender_profile_lookup(
         sender_profiles.size());
     for (auto const &sender_profile : sender_profiles) {
@@ -80,13 +90,164 @@ ToChatMessageEntries(std::vector<std::tuple<ChatMessageEntity, UserEntity>> cons
     return entries;
 }
 
+std::vector<std::tuple<ChatMessageEntity, UserEntity>>
+FetchChatMessages(ChatMessageGroupId const group_id, bool latest_first,
+                  std::optional<unsigned> const limit, std::optional<unsigned> const offset,
+                  ConnectionReservoirInterface *conns) {
+    SqlQueryBuilder query;
+    SqlQueryBuilder::Placeholder<SqlLong> group_id_ph;
+    query.QueryPiece(TableNames::ChatMessage())
+        .QueryPiece(" cm JOIN ")
+        .QueryPiece(TableNames::AUser())
+        .QueryPiece(" sender ON sender.id = cm.sender_id WHERE cm.group_id=")
+        .Holder(&group_id_ph);
+
+    if (latest_first) {
+        query.QueryPiece(" ORDER BY cm.message_seq_id DESC");
+    } else {
+        query.QueryPiece(" ORDER BY cm.message_seq_id ASC");
+    }
+
+    if (limit.has_value()) {
+        SqlQueryBuilder::Placeholder<SqlInt> limit_ph;
+        query.QueryPiece(" LIMIT ").Holder(&limit_ph);
+        query.SetValueToPlaceholder(limit_ph, std::make_shared<SqlInt>(*limit));
+    }
+    if (offset.has_value()) {
+        SqlQueryBuilder::Placeholder<SqlInt> offset_ph;
+        query.QueryPiece(" OFFSET ").Holder(&offset_ph);
+        query.SetValueToPlaceholder(offset_ph, std::make_shared<SqlInt>(*offset));
+    }
+
+    query.SetValueToPlaceholder(group_id_ph, std::make_shared<SqlLong>(group_id));
+
+    return Query<ChatMessageEntity, UserEntity>(query, {"cm", "sender"}, conns);
+}
+
+/**
+ * @brief FillChatMessageCache Loads the latest messages of the group into the cache. The page the
+ * reader has just fetched tells the number of messages when it reaches the end of the group, and
+ * is installed as is when it also covers the cached window.
+ *
+ * @param ticket The ticket returned by BeginFill() before the page was fetched.
+ * @param page_offset Offset of the page in the group.
+ * @param page_limit The maximum number of entries the page was fetched with, if any.
+ * @param page The page in ascending order of message sequence ID.
+ */
+void FillChatMessageCache(ChatMessageGroupEntity const &group,
+                          ChatMessageCache::FillTicket const ticket, unsigned const page_offset,
+                          std::optional<unsigned> const page_limit,
+                          std::vector<ChatMessageEntry> const &page, KeyGeneratorInterface *key_gen,
+                          ChatMessageCache *cache, PublicProfileCache *profile_cache,
+                          ConnectionReservoirInterface *conns) {
+    ChatMessageGroupId group_id = *group.id.Value();
+    unsigned max_num_messages = cache->MaxNumMessagesPerGroup();
+
+    // An empty page past the first one may lie beyond the end of the group.
+    std::optional<uint64_t> num_messages;
+    if ((!page_limit.has_value() || page.size() < *page_limit) &&
+        (!page.empty() || page_offset == 0)) {
+        num_messages = page_offset + page.size();
+        if (page.size() >= std::min(static_cast<uint64_t>(max_num_messages), *num_messages)) {
+            cache->CompleteFill(group_id, ticket, *group.channel_id.Value(), page, *num_messages);
+            return;
+        }
+    }
+
+    std::vector<std::tuple<ChatMessageEntity, UserEntity>> latest_messages =
+        FetchChatMessages(group_id, /*latest_first=*/true,
+                          /*limit=*/max_num_messages, /*offset=*/std::nullopt, conns);
+    std::reverse(latest_messages.begin(), latest_messages.end());
+
+    if (!num_messages.has_value() && latest_messages.size() < max_num_messages) {
+        num_messages = latest_messages.size();
+    }
+    if (!num_messages.has_value()) {
+        SqlQueryBuilder count_query;
+        SqlQueryBuilder::Placeholder<SqlLong> group_id_ph;
+        count_query.QueryPiece(TableNames::ChatMessage())
+            .QueryPiece(" cm WHERE cm.group_id=")
+            .Holder(&group_id_ph);
+        count_query.SetValueToPlaceholder(group_id_ph, std::make_shared<SqlLong>(group_id));
+        num_messages = Count(count_query, conns);
+    }
+
+    cache->CompleteFill(group_id, ticket, *group.channel_id.Value(),
+                        ToChatMessageEntries(latest_messages, key_gen, profile_cache, conns),
+                        std::max(*num_messages, static_cast<uint64_t>(latest_messages.size())));
+}
+
+/**
+ * @brief The PushUnreadChatMessageTask class Notifies every member of the message channel except
+ * the sender about the newly sent chat message.
+ */
+class PushUnreadChatMessageTask : public TaskInterface {
+  public:
+    PushUnreadChatMessageTask(UserId const sender_id, ChatMessageGroupEntity const &group,
+                              ChatMessageEntry const &entry, HostId const host_id,
+                              std::vector<MessagePublisherInterface *> const &publishers,
+                              ConnectionReservoirInterface *conns);
+
+    void Run(TaskStorageInterface *storage) const override;
+    bool DropResourceOnCompletion() const override;
+
+  private:
+    UserId sender_id_;
+    ChatMessageGroupEntity group_;
+    ChatMessageEntry entry_;
+    HostId host_id_;
+    std::vector<MessagePublisherInterface *> publishers_;
+    ConnectionReservoirInterface *conns_;
+};
+
+PushUnreadChatMessageTask::PushUnreadChatMessageTask(
+    UserId const sender_id, ChatMessageGroupEntity const &group, ChatMessageEntry const &entry,
+    HostId const host_id, std::vector<MessagePublisherInterface *> const &publishers,
+    ConnectionReservoirInterface *conns)
+    : sender_id_(sender_id), group_(group), entry_(entry), host_id_(host_id),
+      publishers_(publishers), conns_(conns) {}
+
+void PushUnreadChatMessageTask::Run(TaskStorageInterface * /*storage*/) const {
+    SqlQueryBuilder query;
+    SqlQueryBuilder::Placeholder<SqlLong> channel_id_ph;
+    SqlQueryBuilder::Placeholder<SqlLong> sender_id_ph;
+    query.QueryPiece(TableNames::MessageChannelHasUser())
+        .QueryPiece(" mchu WHERE mchu.channel_id=")
+        .Holder(&channel_id_ph)
+        .QueryPiece(" AND mchu.user_id<>")
+        .Holder(&sender_id_ph);
+
+    query.SetValueToPlaceholder(channel_id_ph,
+                                std::make_shared<SqlLong>(*group_.channel_id.Value()));
+    query.SetValueToPlaceholder(sender_id_ph, std::make_shared<SqlLong>(sender_id_));
+
+    std::vector<std::tuple<MessageChannelHasUserEntity>> members =
+        Query<MessageChannelHasUserEntity>(query, {"mchu"}, conns_);
+    if (members.empty()) {
+        return;
+    }
+
+    RealTimeMessageContent message;
+    ChatMessageThread *thread = message.mutable_unread_chat()->add_message_threads();
+    *thread = ToChatMessageThread(group_);
+    *thread->add_messages() = entry_;
+
+    for (auto const &[member] : members) {
+        PushMessageContent(*member.user_id.Value(), message, host_id_, publishers_);
+    }
+}
+
+bool PushUnreadChatMessageTask::DropResourceOnCompletion() const { return true; }
+
 } // namespace
 
 std::optional<SendChatMessageResult> SendChatMessage(
     UserId const sender_id, ChatMessageGroupId const group_id,
     std::vector<std::string> const &texts, std::vector<FileFormat> const & /*media_file_formats*/,
-    std::vector<FileFormat> const & /*binary_file_formats*/, MessageChannelPbacInterface *pbac,
-    KeyGeneratorInterface *key_gen, ConnectionReservoirInterface *conns) {
+    std::vector<FileFormat> const & /*binary_file_formats*/, HostId const host_id,
+    std::vector<MessagePublisherInterface *> const &publishers, ThreadPool *background_tasks,
+    MessageChannelPbacInterface *pbac, KeyGeneratorInterface *key_gen, ChatMessageCache *cache,
+    PublicProfileCache *profile_cache, ConnectionReservoirInterface *conns) {
     std::optional<ChatMessageGroupEntity> group = FetchChatMessageGroup(group_id, conns);
     if (!group.has_value()) {
         return std::nullopt;
@@ -95,15 +256,11 @@ std::optional<SendChatMessageResult> SendChatMessage(
         return std::nullopt;
     }
 
-    ChatMessageEntity entity =
-        CreateChatMessage(group_id, sender_id, texts,
-                          /*binary_content_paths=*/std::vector<std::string>(), conns);
-
+    bool touch_group = false;
     switch (*group->group_type.Value()) {
     case CMTT_POPUP: {
-        *group->last_interaction_at.ValuePtr() = *entity.created_at.Value();
-        int64_t rows = Update(*group, TableNames::ChatMessageGroup(), /*replace=*/true, conns);
-        assert(rows == 1);
+        // Pops the group up to the top.
+        touch_group = true;
         break;
     }
     case CMTT_TEMPORAL: {
@@ -112,12 +269,32 @@ std::optional<SendChatMessageResult> SendChatMessage(
     }
     }
 
+    std::tuple<ChatMessageEntity, UserEntity> message_and_sender = CreateChatMessageAndTouchGroup(
+        group_id, sender_id, texts,
+        /*binary_content_paths=*/std::vector<std::string>(), touch_group, conns);
+    if (touch_group) {
+        *group->last_interaction_at.ValuePtr() =
+            *std::get<0>(message_and_sender).created_at.Value();
+    }
+
     SendChatMessageResult result;
-    std::optional<UserEntity> sender = FetchUser(sender_id, conns);
-    assert(sender.has_value());
     result.message = ToChatMessageEntries(
-        std::vector<std::tuple<ChatMessageEntity, UserEntity>>{std::make_tuple(entity, *sender)},
-        key_gen, conns)[0];
+        std::vector<std::tuple<ChatMessageEntity, UserEntity>>{message_and_sender}, key_gen,
+        profile_cache, conns)[0];
+
+    if (cache != nullptr) {
+        cache->Append(result.message);
+    }
+
+    if (!publishers.empty()) {
+        auto push_task = std::make_shared<PushUnreadChatMessageTask>(
+            sender_id, *group, result.message, host_id, publishers, conns);
+        if (background_tasks != nullptr) {
+            background_tasks->Schedule(push_task);
+        } else {
+            push_task->Run(/*storage=*/nullptr);
+        }
+    }
 
     return result;
 }
@@ -125,7 +302,19 @@ std::optional<SendChatMessageResult> SendChatMessage(
 std::vector<ChatMessageEntry>
 GetChatMessages(UserId const viewer_id, ChatMessageGroupId const group_id,
                 std::optional<Pagination> const &pagination, MessageChannelPbacInterface *pbac,
-                KeyGeneratorInterface *key_gen, ConnectionReservoirInterface *conns) {
+                KeyGeneratorInterface *key_gen, ChatMessageCache *cache,
+                PublicProfileCache *profile_cache, ConnectionReservoirInterface *conns) {
+    if (cache != nullptr) {
+        std::optional<ChatMessageCache::CachedPage> cached_page =
+            cache->Read(group_id, pagination);
+        if (cached_page.has_value()) {
+            if (!pbac->AllowReadChatMessageGroup(viewer_id, cached_page->channel_id)) {
+                return std::vector<ChatMessageEntry>();
+            }
+            return cached_page->entries;
+        }
+    }
+
     std::optional<ChatMessageGroupEntity> group = FetchChatMessageGroup(group_id, conns);
     if (!group.has_value()) {
         return std::vector<ChatMessageEntry>();
@@ -134,34 +323,30 @@ GetChatMessages(UserId const viewer_id, ChatMessageGroupId const group_id,
         return std::vector<ChatMessageEntry>();
     }
 
-    SqlQueryBuilder query;
-    SqlQueryBuilder::Placeholder<SqlLong> group_id_ph;
-    query.QueryPiece(TableNames::ChatMessage())
-        .QueryPiece(" cm JOIN ")
-        .QueryPiece(TableNames::AUser())
-        .QueryPiece(" sender ON sender.id = cm.sender_id WHERE cm.group_id=")
-        .Holder(&group_id_ph)
-        .QueryPiece(" ORDER BY cm.message_seq_id ASC");
-
+    std::optional<unsigned> limit;
+    std::optional<unsigned> offset;
     if (pagination.has_value()) {
-        SqlQueryBuilder::Placeholder<SqlInt> limit_ph;
-        SqlQueryBuilder::Placeholder<SqlInt> offset_ph;
-        query.QueryPiece(" LIMIT ").Holder(&limit_ph);
-        query.QueryPiece(" OFFSET ").Holder(&offset_ph);
-
-        query.SetValueToPlaceholder(limit_ph,
-                                    std::make_shared<SqlInt>(pagination->result_per_page()));
-        query.SetValueToPlaceholder(
-            offset_ph,
-            std::make_shared<SqlInt>(pagination->page_number() * pagination->result_per_page()));
+        limit = pagination->result_per_page();
+        offset = pagination->page_number() * pagination->result_per_page();
     }
 
-    query.SetValueToPlaceholder(group_id_ph, std::make_shared<SqlLong>(group_id));
+    // The page is older than the cached window if the group is cached.
+    std::optional<ChatMessageCache::FillTicket> fill_ticket;
+    if (cache != nullptr && !cache->Contains(group_id)) {
+        fill_ticket = cache->BeginFill(group_id);
+    }
 
     std::vector<std::tuple<ChatMessageEntity, UserEntity>> query_results =
-        Query<ChatMessageEntity, UserEntity>(query, {"cm", "sender"}, conns);
+        FetchChatMessages(group_id, /*latest_first=*/false, limit, offset, conns);
+    std::vector<ChatMessageEntry> entries =
+        ToChatMessageEntries(query_results, key_gen, profile_cache, conns);
+
+    if (fill_ticket.has_value()) {
+        FillChatMessageCache(*group, *fill_ticket, /*page_offset=*/offset.value_or(0), limit,
+                             entries, key_gen, cache, profile_cache, conns);
+    }
 
-    return ToChatMessageEntries(query_results, key_gen, conns);
+    return entries;
 }
 
 } // namespace e8
@@ -22,12 +22,16 @@
 #include <string>
 #include <vector>
 
+#include "common/thread/thread_pool.h"
 #include "demoweb_service/demoweb/common_entity/chat_message_entity.h"
 #include "demoweb_service/demoweb/common_entity/chat_message_group_entity.h"
 #include "demoweb_service/demoweb/common_entity/user_entity.h"
 #include "demoweb_service/demoweb/environment/host_id.h"
+#include "demoweb_service/demoweb/module/chat_message_cache.h"
+#include "demoweb_service/demoweb/module/public_profile_cache.h"
 #include "demoweb_service/demoweb/pbac/message_channel_pbac.h"
 #include "keygen/key_generator_interface.h"
+#include "message_queue/publisher/publisher.h"
 #include "postgres/query_runner/connection/connection_reservoir_interface.h"
 #include "proto_cc/chat_message.pb.h"
 #include "proto_cc/file.pb.h"
@@ -59,9 +63,15 @@ struct SendChatMessageResult {
  * formats, if any.
  * @param binary_file_formats Requests a list of general binary file location access of the
  * specified file formats, if any.
+ * @param host_id The ID of the host which runs this function.
+ * @param publishers Message publishers for notifying the other members of the message channel.
+ * @param background_tasks Optional worker threads to notify the other members on. If it's absent,
+ * the notifications will be pushed before the function returns.
  * @param pbac Policy based access controller for the associated message channel.
  * @param key_gen Key generator for signing the avatar path as well as file paths associated with
  * the chat message.
+ * @param cache Optional cache of the latest chat messages to write the sent message through.
+ * @param profile_cache Optional cache of public profiles for building the sender profiles.
  * @param conns Database connections.
  * @return The sent messages and corresponding file location accesses if the group ID is valid and
  * the sender pass the evaluation provided by the PBAC.
@@ -69,8 +79,10 @@ struct SendChatMessageResult {
 std::optional<SendChatMessageResult> SendChatMessage(
     UserId const sender_id, ChatMessageGroupId const group_id,
     std::vector<std::string> const &texts, std::vector<FileFormat> const &media_file_formats,
-    std::vector<FileFormat> const &binary_file_formats, MessageChannelPbacInterface *pbac,
-    KeyGeneratorInterface *key_gen, ConnectionReservoirInterface *conns);
+    std::vector<FileFormat> const &binary_file_formats, HostId const host_id,
+    std::vector<MessagePublisherInterface *> const &publishers, ThreadPool *background_tasks,
+    MessageChannelPbacInterface *pbac, KeyGeneratorInterface *key_gen, ChatMessageCache *cache,
+    PublicProfileCache *profile_cache, ConnectionReservoirInterface *conns);
 
 /**
  * @brief GetChatMessages Get chat message entries from the specified chat message group which
@@ -83,6 +95,10 @@ std::optional<SendChatMessageResult> SendChatMessage(
  * @param pbac Policy based access controller for the associated message channel.
  * @param key_gen Key generator for signing the avatar path as well as file paths associated with
  * the chat message.
+ * @param cache Optional cache of the latest chat messages. Pages covered by the cache are served
+ * without querying the messages from the database. Otherwise, the cache is filled with the latest
+ * messages of the group after the page has been read.
+ * @param profile_cache Optional cache of public profiles for building the sender profiles.
  * @param conns Database connections.
  * @return The message entries returned based on the criteria specified by the arguments. If the
  * message group doesn't exist or the viewer doesn't have the privilege to read from the message
@@ -91,7 +107,8 @@ std::optional<SendChatMessageResult> SendChatMessage(
 std::vector<ChatMessageEntry>
 GetChatMessages(UserId const viewer_id, ChatMessageGroupId const group_id,
                 std::optional<Pagination> const &pagination, MessageChannelPbacInterface *pbac,
-                KeyGeneratorInterface *key_gen, ConnectionReservoirInterface *conns);
+                KeyGeneratorInterface *key_gen, ChatMessageCache *cache,
+                PublicProfileCache *profile_cache, ConnectionReservoirInterface *conns);
 
 } // namespace e8
 
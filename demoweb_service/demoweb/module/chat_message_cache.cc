@@ -0,0 +1,227 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "common/time_util/time_util.h"
+#include "demoweb_service/demoweb/common_entity/chat_message_group_entity.h"
+#include "demoweb_service/demoweb/common_entity/message_channel_entity.h"
+#include "demoweb_service/demoweb/module/chat_message_cache.h"
+#include "proto_cc/chat_message.pb.h"
+#include "proto_cc/pagination.pb.h"
+
+namespace e8 {
+
+float ChatMessageCache::Stats::HitRatio() const {
+    uint64_t num_reads = num_hits + num_misses;
+    if (num_reads == 0) {
+        return 0.0f;
+    }
+    return static_cast<float>(num_hits) / num_reads;
+}
+
+ChatMessageCache::ChatMessageCache(unsigned max_num_groups, unsigned max_num_messages_per_group,
+                                   TimestampMicros time_to_live)
+    : max_num_groups_(max_num_groups), max_num_messages_per_group_(max_num_messages_per_group),
+      time_to_live_(time_to_live) {
+    assert(max_num_groups_ > 0);
+    assert(max_num_messages_per_group_ > 0);
+}
+
+std::optional<ChatMessageCache::CachedPage>
+ChatMessageCache::Read(ChatMessageGroupId const group_id,
+                       std::optional<Pagination> const &pagination) {
+    mutex_.lock();
+
+    auto it = groups_.find(group_id);
+    if (it == groups_.end()) {
+        ++stats_.num_misses;
+        mutex_.unlock();
+        return std::nullopt;
+    }
+
+    HotGroup *group = &it->second;
+    if (CurrentTimestampMicros() - group->filled_at > time_to_live_) {
+        this->EraseGroup(it);
+        ++stats_.num_misses;
+        mutex_.unlock();
+        return std::nullopt;
+    }
+
+    // The cached window holds the messages of indices [window_begin, num_messages) in the
+    // ascending order of message sequence ID.
+    uint64_t window_begin = group->num_messages - group->latest_entries.size();
+    uint64_t page_begin = 0;
+    uint64_t page_end = group->num_messages;
+    if (pagination.has_value()) {
+        page_begin = static_cast<uint64_t>(pagination->page_number()) *
+                     static_cast<uint64_t>(pagination->result_per_page());
+        page_end = std::min(page_begin + static_cast<uint64_t>(pagination->result_per_page()),
+                            group->num_messages);
+    }
+
+    if (page_begin < window_begin) {
+        // The page is older than what the window covers.
+        ++stats_.num_misses;
+        mutex_.unlock();
+        return std::nullopt;
+    }
+
+    CachedPage page;
+    page.channel_id = group->channel_id;
+    for (uint64_t i = page_begin; i < page_end; ++i) {
+        page.entries.push_back(group->latest_entries[i - window_begin]);
+    }
+
+    recency_.splice(recency_.begin(), recency_, group->recency_it);
+    ++stats_.num_hits;
+
+    mutex_.unlock();
+    return page;
+}
+
+bool ChatMessageCache::Contains(ChatMessageGroupId const group_id) {
+    mutex_.lock();
+    bool contains = groups_.find(group_id) != groups_.end();
+    mutex_.unlock();
+    return contains;
+}
+
+ChatMessageCache::FillTicket ChatMessageCache::BeginFill(ChatMessageGroupId const group_id) {
+    mutex_.lock();
+
+    FillTicket ticket = next_ticket_++;
+    pending_fills_[group_id] = ticket;
+
+    mutex_.unlock();
+    return ticket;
+}
+
+void ChatMessageCache::CompleteFill(ChatMessageGroupId const group_id, FillTicket const ticket,
+                                    MessageChannelId const channel_id,
+                                    std::vector<ChatMessageEntry> const &latest_entries,
+                                    uint64_t const num_messages) {
+    mutex_.lock();
+
+    auto pending_it = pending_fills_.find(group_id);
+    if (pending_it == pending_fills_.end() || pending_it->second != ticket) {
+        // Either an append or a newer fill has taken over.
+        mutex_.unlock();
+        return;
+    }
+    pending_fills_.erase(pending_it);
+
+    auto it = groups_.find(group_id);
+    if (it != groups_.end()) {
+        this->EraseGroup(it);
+    }
+    if (groups_.size() == max_num_groups_) {
+        // Evict the least recently used group.
+        this->EraseGroup(groups_.find(recency_.back()));
+        ++stats_.num_evictions;
+    }
+    assert(groups_.size() < max_num_groups_);
+
+    unsigned num_kept = std::min(static_cast<unsigned>(latest_entries.size()),
+                                 max_num_messages_per_group_);
+    assert(num_messages >= num_kept);
+
+    recency_.push_front(group_id);
+
+    HotGroup *group = &groups_[group_id];
+    group->channel_id = channel_id;
+    group->latest_entries.assign(latest_entries.end() - num_kept, latest_entries.end());
+    group->num_messages = num_messages;
+    group->filled_at = CurrentTimestampMicros();
+    group->recency_it = recency_.begin();
+
+    mutex_.unlock();
+}
+
+void ChatMessageCache::Append(ChatMessageEntry const &entry) {
+    mutex_.lock();
+
+    // Whatever a concurrent fill has loaded may or may not contain this entry.
+    pending_fills_.erase(entry.thread_id());
+
+    auto it = groups_.find(entry.thread_id());
+    if (it == groups_.end()) {
+        mutex_.unlock();
+        return;
+    }
+
+    HotGroup *group = &it->second;
+
+    // Message sequence IDs from concurrent senders may arrive slightly out of order.
+    auto insertion_it = std::upper_bound(
+        group->latest_entries.begin(), group->latest_entries.end(), entry.message_seq_id(),
+        [](int64_t seq_id, ChatMessageEntry const &e) { return seq_id < e.message_seq_id(); });
+    if (insertion_it != group->latest_entries.begin() &&
+        (insertion_it - 1)->message_seq_id() == entry.message_seq_id()) {
+        // The entry had been loaded by a fill which completed before this append.
+        mutex_.unlock();
+        return;
+    }
+    if (insertion_it == group->latest_entries.begin() &&
+        group->latest_entries.size() < group->num_messages) {
+        // It's older than the window, so it can't be told whether the count includes it.
+        this->EraseGroup(it);
+        mutex_.unlock();
+        return;
+    }
+
+    group->latest_entries.insert(insertion_it, entry);
+    ++group->num_messages;
+    if (group->latest_entries.size() > max_num_messages_per_group_) {
+        group->latest_entries.pop_front();
+    }
+
+    mutex_.unlock();
+}
+
+void ChatMessageCache::Invalidate(ChatMessageGroupId const group_id) {
+    mutex_.lock();
+
+    pending_fills_.erase(group_id);
+
+    auto it = groups_.find(group_id);
+    if (it != groups_.end()) {
+        this->EraseGroup(it);
+    }
+
+    mutex_.unlock();
+}
+
+unsigned ChatMessageCache::MaxNumMessagesPerGroup() const { return max_num_messages_per_group_; }
+
+ChatMessageCache::Stats ChatMessageCache::GetStats() {
+    mutex_.lock();
+    Stats stats = stats_;
+    mutex_.unlock();
+    return stats;
+}
+
+void ChatMessageCache::EraseGroup(std::unordered_map<ChatMessageGroupId, HotGroup>::iterator it) {
+    recency_.erase(it->second.recency_it);
+    groups_.erase(it);
+}
+
+} // namespace e8
@@ -0,0 +1,178 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHAT_MESSAGE_CACHE_H
+#define CHAT_MESSAGE_CACHE_H
+
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "common/time_util/time_util.h"
+#include "demoweb_service/demoweb/common_entity/chat_message_group_entity.h"
+#include "demoweb_service/demoweb/common_entity/message_channel_entity.h"
+#include "proto_cc/chat_message.pb.h"
+#include "proto_cc/pagination.pb.h"
+
+namespace e8 {
+
+/**
+ * @brief The ChatMessageCache class Keeps the latest chat message entries of the most recently used
+ * chat message groups in memory so that reading the newest messages of an active thread doesn't
+ * need to go to the database. At most max_num_groups groups are cached. Each of them holds a
+ * bounded window of its latest max_num_messages_per_group entries as well as the total number of
+ * messages in the group, so a page can be served whenever it falls entirely into the window.
+ *
+ * The cache is filled by readers through BeginFill()/CompleteFill() and kept up to date by writers
+ * through Append(). A fill which races with an append is discarded rather than installing a window
+ * that may miss the appended message. Cached entries expire after time_to_live so the signed
+ * access tokens carried in the sender profiles never go stale. This cache guarantees thread safety.
+ */
+class ChatMessageCache {
+  public:
+    /**
+     * @brief The Stats struct Cache effectiveness counters.
+     */
+    struct Stats {
+        uint64_t num_hits = 0;
+        uint64_t num_misses = 0;
+        uint64_t num_evictions = 0;
+
+        /**
+         * @brief HitRatio Fraction of reads served from the cache. Returns 0 when there is no read
+         * yet.
+         */
+        float HitRatio() const;
+    };
+
+    /**
+     * @brief The CachedPage struct A page of chat message entries served from the cache as well
+     * as the message channel the chat message group belongs to. The caller is responsible for
+     * checking the read access against the channel before handing out the entries.
+     */
+    struct CachedPage {
+        MessageChannelId channel_id;
+        std::vector<ChatMessageEntry> entries;
+    };
+
+    using FillTicket = uint64_t;
+
+    /**
+     * @brief ChatMessageCache Constructs an empty cache.
+     *
+     * @param max_num_groups The maximum number of chat message groups can be stored in the cache.
+     * @param max_num_messages_per_group The maximum number of the latest messages kept for each
+     * group.
+     * @param time_to_live Duration after which a cached group has to be refilled.
+     */
+    ChatMessageCache(unsigned max_num_groups, unsigned max_num_messages_per_group,
+                     TimestampMicros time_to_live);
+    ChatMessageCache(ChatMessageCache const &) = delete;
+    ~ChatMessageCache() = default;
+
+    /**
+     * @brief Read Reads a page of chat message entries, ordered by message sequence ID in
+     * ascending order, from the cache.
+     *
+     * @param group_id ID of the chat message group to read from.
+     * @param pagination Optional page to read. If it's absent, the whole group is requested.
+     * @return The cached page if the group is cached and the page is covered by the cached window.
+     * Otherwise, nullopt.
+     */
+    std::optional<CachedPage> Read(ChatMessageGroupId const group_id,
+                                   std::optional<Pagination> const &pagination);
+
+    /**
+     * @brief Contains Whether the group is currently cached.
+     */
+    bool Contains(ChatMessageGroupId const group_id);
+
+    /**
+     * @brief BeginFill Declares that the caller is about to load the latest messages of the group
+     * from the source of truth. It must be called before the load starts.
+     *
+     * @return A ticket to be handed to CompleteFill().
+     */
+    FillTicket BeginFill(ChatMessageGroupId const group_id);
+
+    /**
+     * @brief CompleteFill Installs the loaded window into the cache unless a message has been
+     * appended to the group since the corresponding BeginFill() call.
+     *
+     * @param group_id ID of the chat message group being filled.
+     * @param ticket The ticket returned by BeginFill().
+     * @param channel_id ID of the message channel the group belongs to.
+     * @param latest_entries The latest entries of the group in ascending order of message sequence
+     * ID. Only the last max_num_messages_per_group entries will be kept.
+     * @param num_messages The total number of messages in the group.
+     */
+    void CompleteFill(ChatMessageGroupId const group_id, FillTicket const ticket,
+                      MessageChannelId const channel_id,
+                      std::vector<ChatMessageEntry> const &latest_entries,
+                      uint64_t const num_messages);
+
+    /**
+     * @brief Append Writes through a newly persisted chat message entry. It has no effect on the
+     * cached content if the group isn't cached.
+     */
+    void Append(ChatMessageEntry const &entry);
+
+    /**
+     * @brief Invalidate Removes the group from the cache, if it exists.
+     */
+    void Invalidate(ChatMessageGroupId const group_id);
+
+    /**
+     * @brief MaxNumMessagesPerGroup The maximum number of the latest messages kept for each group.
+     */
+    unsigned MaxNumMessagesPerGroup() const;
+
+    /**
+     * @brief GetStats Returns a snapshot of the cache effectiveness counters.
+     */
+    Stats GetStats();
+
+  private:
+    struct HotGroup {
+        MessageChannelId channel_id;
+        std::deque<ChatMessageEntry> latest_entries;
+        uint64_t num_messages;
+        TimestampMicros filled_at;
+        std::list<ChatMessageGroupId>::iterator recency_it;
+    };
+
+    void EraseGroup(std::unordered_map<ChatMessageGroupId, HotGroup>::iterator it);
+
+    std::unordered_map<ChatMessageGroupId, HotGroup> groups_;
+    std::list<ChatMessageGroupId> recency_;
+    std::unordered_map<ChatMessageGroupId, FillTicket> pending_fills_;
+    FillTicket next_ticket_ = 0;
+    Stats stats_;
+    std::mutex mutex_;
+
+    unsigned max_num_groups_;
+    unsigned max_num_messages_per_group_;
+    TimestampMicros time_to_live_;
+};
+
+} // namespace e8
+
+#endif // CHAT_MESSAGE_CACHE_H
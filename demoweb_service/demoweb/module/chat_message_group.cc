@@ -30,6 +30,7 @@
 #include "demoweb_service/demoweb/environment/host_id.h"
 #include "demoweb_service/demoweb/module/chat_message_group.h"
 #include "demoweb_service/demoweb/module/chat_message_group_storage.h"
+#include "demoweb_service/demoweb/module/public_profile_cache.h"
 #include "demoweb_service/demoweb/module/user_profile.h"
 #include "demoweb_service/demoweb/pbac/message_channel_pbac.h"
 #include "keygen/key_generator_interface.h"
@@ -41,7 +42,8 @@ namespace e8 {
 namespace {
 std::vector<std::tuple<ChatMessageThread, std::optional<ChatMessageEntry>>> ToChatMessageEntries(
     std::vector<std::tuple<ChatMessageGroupEntity, ChatMessageEntity, UserEntity>> const &entities,
-    KeyGeneratorInterface *key_gen, ConnectionReservoirInterface *conns) {
+    KeyGeneratorInterface *key_gen, PublicProfileCache *profile_cache,
+    ConnectionReservoirInterface *conns) {
     std::unordered_set<UserId> unique_sender_ids;
     std::vector<UserEntity> unqiue_senders;
     for (auto const &[_, chat_message, sender] : entities) {
@@ -57,7 +59,8 @@ std::vector<std::tuple<ChatMessageThread, std::optional<ChatMessageEntry>>> ToCh
     }
 
     std::vector<UserPublicProfile> sender_profiles =
-        BuildPublicProfiles(/*viewer_id=*/std::nullopt, unqiue_senders, key_gen, conns);
+        BuildPublicProfiles(/*viewer_id=*/std::nullopt, unqiue_senders, key_gen, profile_cache,
+                            conns);
     std::unordered_map<UserId, UserPublicProfile const *> sender_profile_lookup(
         sender_profiles.size());
     for (auto const &sender_profile : sender_profiles) {
@@ -151,7 +154,7 @@ std::vector<ChatMessageThread> GetChatMessageGroupsWithChatMessageSummaryList(
     UserId const viewer_id, MessageChannelId const channel_id,
     int32_t const max_num_messages_per_group, Pagination const pagination,
     MessageChannelPbacInterface *pbac, KeyGeneratorInterface *key_gen,
-    ConnectionReservoirInterface *conns) {
+    PublicProfileCache *profile_cache, ConnectionReservoirInterface *conns) {
     if (!pbac->AllowReadChatMessageGroup(viewer_id, channel_id)) {
         return std::vector<ChatMessageThread>();
     }
@@ -206,7 +209,7 @@ std::vector<ChatMessageThread> GetChatMessageGroupsWithChatMessageSummaryList(
             query, {"paginated_cmg", "cm", "sender"}, conns);
 
     std::vector<std::tuple<ChatMessageThread, std::optional<ChatMessageEntry>>>
-        chat_message_entries = ToChatMessageEntries(query_result, key_gen, conns);
+        chat_message_entries = ToChatMessageEntries(query_result, key_gen, profile_cache, conns);
 
     return GroupByMessageGroup(chat_message_entries);
 }
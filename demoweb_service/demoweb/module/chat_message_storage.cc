@@ -17,6 +17,7 @@
 
 #include <cassert>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -55,6 +56,69 @@ ChatMessageEntity CreateChatMessage(ChatMessageGroupId const chat_message_group_
     return chat_message;
 }
 
+std::tuple<ChatMessageEntity, UserEntity>
+CreateChatMessageAndTouchGroup(ChatMessageGroupId const chat_message_group_id,
+                               UserId const sender_id, std::vector<std::string> const &text_entries,
+                               std::vector<std::string> const &binary_content_paths,
+                               bool touch_group, ConnectionReservoirInterface *conns) {
+    SqlQueryBuilder query;
+    SqlQueryBuilder::Placeholder<SqlLong> group_id_ph;
+    SqlQueryBuilder::Placeholder<SqlLong> message_seq_id_ph;
+    SqlQueryBuilder::Placeholder<SqlLong> sender_id_ph;
+    SqlQueryBuilder::Placeholder<SqlStrArr> text_entries_ph;
+    SqlQueryBuilder::Placeholder<SqlStrArr> binary_content_paths_ph;
+    SqlQueryBuilder::Placeholder<SqlTimestamp> timestamp_ph;
+
+    query.QueryPiece("WITH new_message AS (INSERT INTO ")
+        .QueryPiece(TableNames::ChatMessage())
+        .QueryPiece("(group_id,message_seq_id,sender_id,text_content,binary_content_paths,"
+                    "created_at,last_interaction_at)VALUES(")
+        .Holder(&group_id_ph)
+        .QueryPiece(",")
+        .Holder(&message_seq_id_ph)
+        .QueryPiece(",")
+        .Holder(&sender_id_ph)
+        .QueryPiece(",")
+        .Holder(&text_entries_ph)
+        .QueryPiece(",")
+        .Holder(&binary_content_paths_ph)
+        .QueryPiece(",")
+        .Holder(&timestamp_ph)
+        .QueryPiece(",")
+        .Holder(&timestamp_ph)
+        .QueryPiece(")RETURNING *)");
+    if (touch_group) {
+        // Data-modifying statements in WITH are executed whether or not they are referenced.
+        query.QueryPiece(",touched_group AS (UPDATE ")
+            .QueryPiece(TableNames::ChatMessageGroup())
+            .QueryPiece(" SET last_interaction_at=")
+            .Holder(&timestamp_ph)
+            .QueryPiece(" WHERE id=")
+            .Holder(&group_id_ph)
+            .QueryPiece(")");
+    }
+    query.QueryPiece(" ")
+        .EndWithClause()
+        .QueryPiece("new_message cm JOIN ")
+        .QueryPiece(TableNames::AUser())
+        .QueryPiece(" sender ON sender.id=cm.sender_id");
+
+    query.SetValueToPlaceholder(group_id_ph, std::make_shared<SqlLong>(chat_message_group_id));
+    query.SetValueToPlaceholder(message_seq_id_ph, std::make_shared<SqlLong>(e8::TemporalId()));
+    query.SetValueToPlaceholder(sender_id_ph, std::make_shared<SqlLong>(sender_id));
+    query.SetValueToPlaceholder(text_entries_ph, std::make_shared<SqlStrArr>(text_entries));
+    query.SetValueToPlaceholder(binary_content_paths_ph,
+                                std::make_shared<SqlStrArr>(binary_content_paths));
+    query.SetValueToPlaceholder(timestamp_ph,
+                                std::make_shared<SqlTimestamp>(CurrentTimestampMicros()));
+
+    std::vector<std::tuple<ChatMessageEntity, UserEntity>> query_result =
+        Query<ChatMessageEntity, UserEntity>(query, {"cm", "sender"}, conns);
+    assert(query_result.size() == 1);
+
+    return query_result[0];
+}
+
 std::optional<ChatMessageEntity> FetchChatMessage(ChatMessageId const chat_message_id,
                                                   ConnectionReservoirInterface *conns) {
     SqlQueryBuilder query;
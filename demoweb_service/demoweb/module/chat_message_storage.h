@@ -20,6 +20,7 @@
 
 #include <optional>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include "demoweb_service/demoweb/common_entity/chat_message_entity.h"
@@ -43,6 +44,21 @@ ChatMessageEntity CreateChatMessage(ChatMessageGroupId const chat_message_group_
                                     std::vector<std::string> const &binary_content_paths,
                                     ConnectionReservoirInterface *conns);
 
+/**
+ * @brief CreateChatMessageAndTouchGroup Similar to CreateChatMessage(), but it completes in a
+ * single database round trip. Within the same statement, it can bump the last interaction time of
+ * the chat message group to the creation time of the message, and it reads back the sender of the
+ * message.
+ *
+ * @param touch_group Whether to update the last interaction time of the chat message group.
+ * @return The newly created chat message and its sender.
+ */
+std::tuple<ChatMessageEntity, UserEntity>
+CreateChatMessageAndTouchGroup(ChatMessageGroupId const chat_message_group_id,
+                               UserId const sender_id, std::vector<std::string> const &text_entries,
+                               std::vector<std::string> const &binary_content_paths,
+                               bool touch_group, ConnectionReservoirInterface *conns);
+
 /**
  * @brief FetchChatMessage Fetch a chat message by ID, if one exists.
  */
@@ -27,6 +27,7 @@
 #include "demoweb_service/demoweb/constant/demoweb_database.h"
 #include "demoweb_service/demoweb/module/contact_invitation.h"
 #include "demoweb_service/demoweb/module/contact_storage.h"
+#include "demoweb_service/demoweb/module/public_profile_cache.h"
 #include "demoweb_service/demoweb/module/push_message.h"
 #include "demoweb_service/demoweb/module/user_profile.h"
 #include "demoweb_service/demoweb/module/user_storage.h"
@@ -41,12 +42,13 @@ namespace {
 
 UserPublicProfile FetchUserProfile(UserId const viewer_id, UserId const user_id,
                                    KeyGeneratorInterface *key_gen,
+                                   PublicProfileCache *profile_cache,
                                    ConnectionReservoirInterface *conns) {
     std::optional<UserEntity> user = FetchUser(user_id, conns);
     assert(user.has_value());
 
-    std::vector<UserPublicProfile> inviter_profile =
-        BuildPublicProfiles(viewer_id, std::vector<UserEntity>{*user}, key_gen, conns);
+    std::vector<UserPublicProfile> inviter_profile = BuildPublicProfiles(
+        viewer_id, std::vector<UserEntity>{*user}, key_gen, profile_cache, conns);
     assert(inviter_profile.size() == 1);
 
     return inviter_profile[0];
@@ -57,7 +59,8 @@ UserPublicProfile FetchUserProfile(UserId const viewer_id, UserId const user_id,
 bool SendInvitation(UserId inviter_id, UserId invitee_id, bool send_message_anyway,
                     HostId const host_id,
                     std::vector<MessagePublisherInterface *> const &publishers,
-                    KeyGeneratorInterface *key_gen, ConnectionReservoirInterface *conns) {
+                    KeyGeneratorInterface *key_gen, PublicProfileCache *profile_cache,
+                    ConnectionReservoirInterface *conns) {
     bool first_time_invitation = true;
 
     TimestampMicros timestamp = CurrentTimestampMicros();
@@ -88,7 +91,7 @@ bool SendInvitation(UserId inviter_id, UserId invitee_id, bool send_message_anyw
     if (send_message_anyway || first_time_invitation) {
         RealTimeMessageContent message;
         *message.mutable_invitation_received()->mutable_inviter() =
-            FetchUserProfile(invitee_id, inviter_id, key_gen, conns);
+            FetchUserProfile(invitee_id, inviter_id, key_gen, profile_cache, conns);
 
         PushMessageContent(invitee_id, message, host_id, publishers);
     }
@@ -98,7 +101,8 @@ bool SendInvitation(UserId inviter_id, UserId invitee_id, bool send_message_anyw
 
 bool ProcessInvitation(UserId invitee_id, UserId inviter_id, bool accept, HostId const host_id,
                        std::vector<MessagePublisherInterface *> const &publishers,
-                       KeyGeneratorInterface *key_gen, ConnectionReservoirInterface *conns) {
+                       KeyGeneratorInterface *key_gen, PublicProfileCache *profile_cache,
+                       ConnectionReservoirInterface *conns) {
     SqlQueryBuilder::Placeholder<SqlLong> invitee_id_ph;
     SqlQueryBuilder::Placeholder<SqlLong> inviter_id_ph;
     SqlQueryBuilder::Placeholder<SqlInt> foward_relation_ph;
@@ -140,7 +144,7 @@ bool ProcessInvitation(UserId invitee_id, UserId inviter_id, bool accept, HostId
     // Send the invitation accepted message.
     RealTimeMessageContent message;
     *message.mutable_invitation_accepted()->mutable_invitee() =
-        FetchUserProfile(inviter_id, invitee_id, key_gen, conns);
+        FetchUserProfile(inviter_id, invitee_id, key_gen, profile_cache, conns);
 
     PushMessageContent(inviter_id, message, host_id, publishers);
 
@@ -22,6 +22,7 @@
 
 #include "demoweb_service/demoweb/common_entity/user_entity.h"
 #include "demoweb_service/demoweb/environment/host_id.h"
+#include "demoweb_service/demoweb/module/public_profile_cache.h"
 #include "keygen/key_generator_interface.h"
 #include "message_queue/publisher/publisher.h"
 #include "postgres/query_runner/connection/connection_reservoir_interface.h"
@@ -34,24 +35,28 @@ namespace e8 {
  *
  * @param send_message_anyway Send message even if a message has already been sent before if this
  * parameter is set to true.
+ * @param profile_cache Optional cache of public profiles for building the inviter's profile.
  * @return true if it an invitation has not been sent before or it hasn't been accepted, otherwise,
  * false.
  */
 bool SendInvitation(UserId inviter_id, UserId invitee_id, bool send_message_anyway,
                     HostId const host_id,
                     std::vector<MessagePublisherInterface *> const &publishers,
-                    KeyGeneratorInterface *key_gen, ConnectionReservoirInterface *conns);
+                    KeyGeneratorInterface *key_gen, PublicProfileCache *profile_cache,
+                    ConnectionReservoirInterface *conns);
 
 /**
  * @brief ProcessInvitation Accepts or rejects an invitation. If accepted, the invitation will be
  * removed and a contact relation will be established between the invitee and inviter. Otherwise,
  * the invitation will be removed and an invitation rejection relation will be established instead.
  *
+ * @param profile_cache Optional cache of public profiles for building the invitee's profile.
  * @return false if the invitation can't be found.
  */
 bool ProcessInvitation(UserId invitee_id, UserId inviter_id, bool accept, HostId const host_id,
                        std::vector<MessagePublisherInterface *> const &publishers,
-                       KeyGeneratorInterface *key_gen, ConnectionReservoirInterface *conns);
+                       KeyGeneratorInterface *key_gen, PublicProfileCache *profile_cache,
+                       ConnectionReservoirInterface *conns);
 
 } // namespace e8
 
@@ -0,0 +1,262 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <chrono>
+#include <cryptopp/sha.h>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "common/time_util/time_util.h"
+#include "demoweb_service/demoweb/common_entity/file_blob_entity.h"
+#include "demoweb_service/demoweb/constant/demoweb_database.h"
+#include "demoweb_service/demoweb/constant/file_path.h"
+#include "demoweb_service/demoweb/module/file_blob.h"
+#include "file_system/file_system_interface.h"
+#include "postgres/query_runner/connection/connection_reservoir_interface.h"
+#include "postgres/query_runner/sql_runner.h"
+
+namespace e8 {
+namespace {
+
+char const kHexDigits[] = "0123456789abcdef";
+
+// How long an acquisition waits for the deletion of a blob to finish before taking it over.
+TimestampMicros const kMaxFileBlobDeletionWait = 1000000;
+
+/**
+ * @brief DeleteUnreferencedFileBlob Removes the physical file, then the row, of a blob claimed for
+ * deletion. Claimed blobs have a negative reference count and can't be acquired, so nobody writes
+ * the physical file until the row is gone.
+ */
+void DeleteUnreferencedFileBlob(std::string const &content_hash, FileSystemInterface *file_system,
+                                ConnectionReservoirInterface *db_conns) {
+    file_system->DeleteFile(FileBlobPath(content_hash));
+
+    SqlQueryBuilder claimed;
+    SqlQueryBuilder::Placeholder<SqlStr> content_hash_ph;
+    claimed.QueryPiece("WHERE content_hash=")
+        .Holder(&content_hash_ph)
+        .QueryPiece(" AND ref_count<0");
+
+    claimed.SetValueToPlaceholder(content_hash_ph,
+                                  std::make_shared<SqlStr>(content_hash, /*field_name=*/""));
+
+    Delete(TableNames::FileBlob(), claimed, db_conns);
+}
+
+} // namespace
+
+std::string FileContentHash(std::string_view content) {
+    CryptoPP::byte digest[CryptoPP::SHA256::DIGESTSIZE];
+    CryptoPP::SHA256().CalculateDigest(
+        digest, reinterpret_cast<CryptoPP::byte const *>(content.data()), content.size());
+
+    std::string content_hash;
+    content_hash.reserve(2 * CryptoPP::SHA256::DIGESTSIZE);
+    for (CryptoPP::byte b : digest) {
+        content_hash.push_back(kHexDigits[b >> 4]);
+        content_hash.push_back(kHexDigits[b & 0xf]);
+    }
+    return content_hash;
+}
+
+bool IsValidFileContentHash(std::string const &content_hash) {
+    if (content_hash.size() != 2 * CryptoPP::SHA256::DIGESTSIZE) {
+        return false;
+    }
+    for (char c : content_hash) {
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string FileBlobPath(std::string const &content_hash) {
+    assert(IsValidFileContentHash(content_hash));
+    // Fans the blobs out to subdirectories to keep the directories small.
+    return std::string("/") + kFileBlobPathPrefix + "/" + content_hash.substr(0, 2) + "/" +
+           content_hash;
+}
+
+std::optional<FileBlobEntity> FetchFileBlob(std::string const &content_hash,
+                                            ConnectionReservoirInterface *db_conns) {
+    SqlQueryBuilder query;
+    SqlQueryBuilder::Placeholder<SqlStr> content_hash_ph;
+    query.QueryPiece(TableNames::FileBlob())
+        .QueryPiece(" fb WHERE fb.content_hash=")
+        .Holder(&content_hash_ph);
+
+    query.SetValueToPlaceholder(content_hash_ph,
+                                std::make_shared<SqlStr>(content_hash, /*field_name=*/""));
+
+    std::vector<std::tuple<FileBlobEntity>> query_result =
+        Query<FileBlobEntity>(query, {"fb"}, db_conns);
+    if (query_result.empty()) {
+        return std::nullopt;
+    }
+
+    return std::get<0>(query_result[0]);
+}
+
+FileBlobEntity AcquireFileBlob(std::string const &content_hash, uint64_t storage_size,
+                               FileSystemInterface *file_system,
+                               ConnectionReservoirInterface *db_conns) {
+    SqlQueryBuilder query;
+    SqlQueryBuilder::Placeholder<SqlStr> content_hash_ph;
+    SqlQueryBuilder::Placeholder<SqlLong> storage_size_ph;
+    SqlQueryBuilder::Placeholder<SqlTimestamp> timestamp_ph;
+
+    // Creating and referencing the blob is a single upsert so that concurrent uploads of the same
+    // content agree on who creates the blob. A blob being deleted can't be referenced.
+    query.QueryPiece("WITH acquired AS (INSERT INTO ")
+        .QueryPiece(TableNames::FileBlob())
+        .QueryPiece("(content_hash,storage_size,ref_count,committed,created_at)VALUES(")
+        .Holder(&content_hash_ph)
+        .QueryPiece(",")
+        .Holder(&storage_size_ph)
+        .QueryPiece(",1,false,")
+        .Holder(&timestamp_ph)
+        .QueryPiece(")ON CONFLICT (content_hash) DO UPDATE SET ref_count=")
+        .QueryPiece(TableNames::FileBlob())
+        .QueryPiece(".ref_count+1 WHERE ")
+        .QueryPiece(TableNames::FileBlob())
+        .QueryPiece(".ref_count>=0 RETURNING *) ")
+        .EndWithClause()
+        .QueryPiece("acquired fb");
+
+    query.SetValueToPlaceholder(content_hash_ph,
+                                std::make_shared<SqlStr>(content_hash, /*field_name=*/""));
+    query.SetValueToPlaceholder(storage_size_ph, std::make_shared<SqlLong>(storage_size));
+    query.SetValueToPlaceholder(timestamp_ph,
+                                std::make_shared<SqlTimestamp>(CurrentTimestampMicros()));
+
+    TimestampMicros wait_start = CurrentTimestampMicros();
+    while (true) {
+        std::vector<std::tuple<FileBlobEntity>> query_result =
+            Query<FileBlobEntity>(query, {"fb"}, db_conns);
+        if (!query_result.empty()) {
+            assert(query_result.size() == 1);
+            return std::get<0>(query_result[0]);
+        }
+
+        // The blob is being deleted. The releaser only has the physical file left to remove, so
+        // it's likely to have died if it takes this long.
+        if (CurrentTimestampMicros() - wait_start > kMaxFileBlobDeletionWait) {
+            DeleteUnreferencedFileBlob(content_hash, file_system, db_conns);
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+std::optional<FileBlobEntity> AcquireCommittedFileBlob(std::string const &content_hash,
+                                                       ConnectionReservoirInterface *db_conns) {
+    SqlQueryBuilder query;
+    SqlQueryBuilder::Placeholder<SqlStr> content_hash_ph;
+    query.QueryPiece("WITH acquired AS (UPDATE ")
+        .QueryPiece(TableNames::FileBlob())
+        .QueryPiece(" SET ref_count=ref_count+1 WHERE content_hash=")
+        .Holder(&content_hash_ph)
+        .QueryPiece(" AND committed RETURNING *) ")
+        .EndWithClause()
+        .QueryPiece("acquired fb");
+
+    query.SetValueToPlaceholder(content_hash_ph,
+                                std::make_shared<SqlStr>(content_hash, /*field_name=*/""));
+
+    std::vector<std::tuple<FileBlobEntity>> query_result =
+        Query<FileBlobEntity>(query, {"fb"}, db_conns);
+    if (query_result.empty()) {
+        return std::nullopt;
+    }
+
+    return std::get<0>(query_result[0]);
+}
+
+void CommitFileBlob(std::string const &content_hash, ConnectionReservoirInterface *db_conns) {
+    SqlQueryBuilder query;
+    SqlQueryBuilder::Placeholder<SqlStr> content_hash_ph;
+    query.QueryPiece("WITH committed AS (UPDATE ")
+        .QueryPiece(TableNames::FileBlob())
+        .QueryPiece(" SET committed=true WHERE content_hash=")
+        .Holder(&content_hash_ph)
+        .QueryPiece(" AND ref_count>0 RETURNING *) ")
+        .EndWithClause()
+        .QueryPiece("committed fb");
+
+    query.SetValueToPlaceholder(content_hash_ph,
+                                std::make_shared<SqlStr>(content_hash, /*field_name=*/""));
+
+    std::vector<std::tuple<FileBlobEntity>> query_result =
+        Query<FileBlobEntity>(query, {"fb"}, db_conns);
+    // The caller's reference keeps the blob alive.
+    assert(query_result.size() == 1);
+}
+
+bool ReleaseFileBlob(std::string const &content_hash, FileSystemInterface *file_system,
+                     ConnectionReservoirInterface *db_conns) {
+    SqlQueryBuilder query;
+    SqlQueryBuilder::Placeholder<SqlStr> content_hash_ph;
+    query.QueryPiece("WITH released AS (UPDATE ")
+        .QueryPiece(TableNames::FileBlob())
+        .QueryPiece(" SET ref_count=ref_count-1 WHERE content_hash=")
+        .Holder(&content_hash_ph)
+        .QueryPiece(" AND ref_count>0 RETURNING *) ")
+        .EndWithClause()
+        .QueryPiece("released fb");
+
+    query.SetValueToPlaceholder(content_hash_ph,
+                                std::make_shared<SqlStr>(content_hash, /*field_name=*/""));
+
+    std::vector<std::tuple<FileBlobEntity>> query_result =
+        Query<FileBlobEntity>(query, {"fb"}, db_conns);
+    if (query_result.empty() || *std::get<0>(query_result[0]).ref_count.Value() > 0) {
+        return false;
+    }
+
+    // A concurrent acquisition may have revived the blob in the meantime, in which case the claim
+    // fails.
+    SqlQueryBuilder claim;
+    SqlQueryBuilder::Placeholder<SqlStr> claim_content_hash_ph;
+    claim.QueryPiece("WITH claimed AS (UPDATE ")
+        .QueryPiece(TableNames::FileBlob())
+        .QueryPiece(" SET ref_count=-1,committed=false WHERE content_hash=")
+        .Holder(&claim_content_hash_ph)
+        .QueryPiece(" AND ref_count=0 RETURNING *) ")
+        .EndWithClause()
+        .QueryPiece("claimed fb");
+
+    claim.SetValueToPlaceholder(claim_content_hash_ph,
+                                std::make_shared<SqlStr>(content_hash, /*field_name=*/""));
+
+    if (Query<FileBlobEntity>(claim, {"fb"}, db_conns).empty()) {
+        return false;
+    }
+
+    DeleteUnreferencedFileBlob(content_hash, file_system, db_conns);
+    return true;
+}
+
+} // namespace e8
@@ -0,0 +1,106 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FILE_BLOB_H
+#define FILE_BLOB_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "demoweb_service/demoweb/common_entity/file_blob_entity.h"
+#include "file_system/file_system_interface.h"
+#include "postgres/query_runner/connection/connection_reservoir_interface.h"
+
+namespace e8 {
+
+/**
+ * File contents are stored once per distinct content, in file blobs keyed by the SHA-256 hash of
+ * the content. A file path whose metadata carries a content hash points to the shared blob instead
+ * of owning a physical file. Each blob counts the file paths pointing to it, and the blob is
+ * removed along with its physical file when the last of them goes away. A blob is committed once
+ * its content is in place, and only committed blobs are trusted to have their content.
+ */
+
+/**
+ * @brief FileContentHash Computes the content hash, the SHA-256 digest in lowercase hex, of the
+ * file content.
+ */
+std::string FileContentHash(std::string_view content);
+
+/**
+ * @brief IsValidFileContentHash Checks if the string is well-formed as a content hash.
+ */
+bool IsValidFileContentHash(std::string const &content_hash);
+
+/**
+ * @brief FileBlobPath Location of the physical file which stores the blob content.
+ */
+std::string FileBlobPath(std::string const &content_hash);
+
+/**
+ * @brief FetchFileBlob Fetches the blob of the specified content hash.
+ *
+ * @return The blob if it exists.
+ */
+std::optional<FileBlobEntity> FetchFileBlob(std::string const &content_hash,
+                                            ConnectionReservoirInterface *db_conns);
+
+/**
+ * @brief AcquireFileBlob Adds a reference to the blob of the specified content hash. The blob will
+ * be created with one reference if it doesn't exist. As long as the returned blob isn't committed,
+ * the caller is responsible for putting the content to FileBlobPath() then calling
+ * CommitFileBlob(). Concurrent callers may all do so since they store the same content. If the
+ * blob is being deleted, it waits for the deletion to finish.
+ *
+ * @param storage_size Size of the content. It's only used when the blob is created.
+ * @return The blob after the reference is added.
+ */
+FileBlobEntity AcquireFileBlob(std::string const &content_hash, uint64_t storage_size,
+                               FileSystemInterface *file_system,
+                               ConnectionReservoirInterface *db_conns);
+
+/**
+ * @brief AcquireCommittedFileBlob Adds a reference to the blob of the specified content hash only
+ * if its content has been committed. Otherwise, nothing changes.
+ *
+ * @return The blob after the reference is added if the committed blob exists.
+ */
+std::optional<FileBlobEntity> AcquireCommittedFileBlob(std::string const &content_hash,
+                                                       ConnectionReservoirInterface *db_conns);
+
+/**
+ * @brief CommitFileBlob Marks the content of the blob as stored at FileBlobPath(). The caller must
+ * hold a reference to the blob.
+ */
+void CommitFileBlob(std::string const &content_hash, ConnectionReservoirInterface *db_conns);
+
+/**
+ * @brief ReleaseFileBlob Drops a reference to the blob of the specified content hash. The blob is
+ * deleted, along with its physical file, when no reference is left. The blob can't be acquired
+ * until the physical file is removed, so a concurrent upload of the same content never has its
+ * content removed.
+ *
+ * @return true if the blob has been deleted.
+ */
+bool ReleaseFileBlob(std::string const &content_hash, FileSystemInterface *file_system,
+                     ConnectionReservoirInterface *db_conns);
+
+} // namespace e8
+
+#endif // FILE_BLOB_H
@@ -15,6 +15,207 @@
  * not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "common/time_util/time_util.h"
+#include "demoweb_service/demoweb/common_entity/file_blob_entity.h"
+#include "demoweb_service/demoweb/common_entity/file_metadata_entity.h"
+#include "demoweb_service/demoweb/constant/file_path.h"
+#include "demoweb_service/demoweb/constant/file_transfer.h"
+#include "demoweb_service/demoweb/module/file_access_validator.h"
+#include "demoweb_service/demoweb/module/file_blob.h"
 #include "demoweb_service/demoweb/module/file_io.h"
+#include "demoweb_service/demoweb/module/file_metadata.h"
+#include "file_system/file_interface.h"
+#include "file_system/file_system_interface.h"
+#include "keygen/key_generator_interface.h"
+#include "postgres/query_runner/connection/connection_reservoir_interface.h"
+#include "proto_cc/file.pb.h"
+#include "proto_cc/identity.pb.h"
+
+namespace e8 {
+namespace {
+
+// Tells apart the uploads which start within the same microsecond.
+std::atomic<uint64_t> num_started_uploads(0);
+
+std::string FileUploadStagingPath(std::string const &file_path) {
+    std::string staging_path = std::string("/") + kFileStagingPathPrefix;
+    if (file_path.empty() || file_path.front() != '/') {
+        staging_path += "/";
+    }
+    return staging_path + file_path + "." + std::to_string(TemporalId()) + "." +
+           std::to_string(num_started_uploads.fetch_add(1, std::memory_order_relaxed));
+}
+
+/**
+ * @brief LinkFileToBlob Points the location to the blob which the caller has acquired a reference
+ * to. The reference is handed over to the location, and the one the location held before is
+ * dropped. Concurrent links to the same location each drop the reference they replaced.
+ */
+std::optional<FileMetadataEntity> LinkFileToBlob(std::string const &file_path,
+                                                 FileBlobEntity const &blob,
+                                                 FileSystemInterface *file_system,
+                                                 ConnectionReservoirInterface *db_conns) {
+    std::string const &content_hash = *blob.content_hash.Value();
+
+    std::optional<std::string> previous_content_hash;
+    std::optional<FileMetadataEntity> metadata =
+        SwapFileContentHash(file_path, *blob.storage_size.Value(), content_hash,
+                            &previous_content_hash, db_conns);
+    if (!metadata.has_value()) {
+        ReleaseFileBlob(content_hash, file_system, db_conns);
+        return std::nullopt;
+    }
+
+    if (previous_content_hash.has_value()) {
+        ReleaseFileBlob(*previous_content_hash, file_system, db_conns);
+    }
+
+    return metadata;
+}
+
+} // namespace
+
+std::optional<std::string> ResolveFileDescriptor(Identity const &viewer,
+                                                 FileDescriptor const &descriptor,
+                                                 FileAccessMode access_mode,
+                                                 KeyGeneratorInterface *key_gen,
+                                                 ConnectionReservoirInterface *db_conns) {
+    switch (descriptor.AccessMethod_case()) {
+    case FileDescriptor::kFileTokenAccess: {
+        FileAccessToken const &access_token = descriptor.file_token_access().access_token();
+        std::optional<std::string> file_path =
+            ValidateFileAccessToken(viewer.user_id(), access_mode, access_token, key_gen);
+        if (!file_path.has_value() && access_mode != FAM_READWRITE) {
+            // Tokens are signed for the exact access mode.
+            file_path =
+                ValidateFileAccessToken(viewer.user_id(), FAM_READWRITE, access_token, key_gen);
+        }
+        return file_path;
+    }
+    case FileDescriptor::kFileDirectAccess: {
+        std::string const &file_path = descriptor.file_direct_access().path();
+        if (!ValidateDirectFileAccess(viewer, file_path, access_mode, db_conns)) {
+            return std::nullopt;
+        }
+        return file_path;
+    }
+    default: {
+        return std::nullopt;
+    }
+    }
+}
+
+FileUpload::~FileUpload() {
+    file = nullptr;
+    // The staging file is gone if the upload has been completed.
+    file_system->DeleteFile(staging_path);
+}
+
+std::unique_ptr<FileUpload> BeginFileUpload(std::string const &file_path,
+                                            FileSystemInterface *file_system) {
+    std::string staging_path = FileUploadStagingPath(file_path);
+    if (!file_system->CreateFile(staging_path)) {
+        return nullptr;
+    }
+
+    auto upload = std::make_unique<FileUpload>();
+    upload->staging_path = staging_path;
+    upload->file_system = file_system;
+    upload->file = file_system->OpenFile(staging_path);
+    if (upload->file == nullptr) {
+        return nullptr;
+    }
+    return upload;
+}
+
+bool WriteFileChunk(FileChunk const &chunk, FileUpload *upload) {
+    if (chunk.chunk_number() < 0 || chunk.data().size() > kFileChunkSize) {
+        return false;
+    }
+    uint64_t offset = static_cast<uint64_t>(chunk.chunk_number()) * kFileChunkSize;
+    if (offset + chunk.data().size() > kMaxFileSize) {
+        return false;
+    }
+    return upload->file->WriteAt(offset, chunk.data());
+}
+
+std::optional<FileMetadataEntity> CompleteFileUpload(std::string const &file_path,
+                                                     FileUpload *upload,
+                                                     FileSystemInterface *file_system,
+                                                     ConnectionReservoirInterface *db_conns) {
+    std::optional<std::string_view> content = upload->file->Content();
+    if (!content.has_value()) {
+        return std::nullopt;
+    }
+
+    std::string content_hash = FileContentHash(*content);
+    std::string const &staging_path = upload->staging_path;
+
+    FileBlobEntity blob = AcquireFileBlob(content_hash, content->size(), file_system, db_conns);
+    if (!*blob.committed.Value()) {
+        // Either this is the first copy of the content or the first uploader hasn't stored it yet.
+        // Storing the same content twice is harmless.
+        if (!file_system->RenameFile(staging_path, FileBlobPath(content_hash))) {
+            ReleaseFileBlob(content_hash, file_system, db_conns);
+            return std::nullopt;
+        }
+        CommitFileBlob(content_hash, db_conns);
+    } else {
+        file_system->DeleteFile(staging_path);
+    }
+
+    return LinkFileToBlob(file_path, blob, file_system, db_conns);
+}
+
+std::optional<FileMetadataEntity> LinkKnownFileContent(std::string const &file_path,
+                                                       std::string const &content_hash,
+                                                       FileSystemInterface *file_system,
+                                                       ConnectionReservoirInterface *db_conns) {
+    if (!IsValidFileContentHash(content_hash)) {
+        return std::nullopt;
+    }
+
+    std::optional<FileBlobEntity> blob = AcquireCommittedFileBlob(content_hash, db_conns);
+    if (!blob.has_value()) {
+        // Nobody has stored the content.
+        return std::nullopt;
+    }
+
+    return LinkFileToBlob(file_path, *blob, file_system, db_conns);
+}
+
+std::unique_ptr<FileInterface> OpenStoredFile(std::string const &file_path,
+                                              FileSystemInterface *file_system,
+                                              ConnectionReservoirInterface *db_conns) {
+    std::optional<FileMetadataEntity> metadata = FetchFileMetadata(file_path, db_conns);
+    if (!metadata.has_value()) {
+        return nullptr;
+    }
+
+    std::optional<std::string> const &content_hash = metadata->content_hash.Value();
+    if (!content_hash.has_value()) {
+        // The file was stored before its content went to a blob.
+        return file_system->OpenFile(file_path);
+    }
+    return file_system->OpenFile(FileBlobPath(*content_hash));
+}
+
+int32_t NumFileChunks(uint64_t file_size) {
+    return static_cast<int32_t>((file_size + kFileChunkSize - 1) / kFileChunkSize);
+}
+
+void ReadFileChunk(std::string_view file_content, int32_t chunk_number, FileChunk *chunk) {
+    chunk->set_chunk_number(chunk_number);
+    std::string_view data =
+        file_content.substr(static_cast<uint64_t>(chunk_number) * kFileChunkSize, kFileChunkSize);
+    chunk->set_data(data.data(), data.size());
+}
 
-namespace e8 {}
+} // namespace e8
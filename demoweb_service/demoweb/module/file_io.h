@@ -18,6 +18,115 @@
 #ifndef FILE_IO_H
 #define FILE_IO_H
 
-namespace e8 {}
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "demoweb_service/demoweb/common_entity/file_metadata_entity.h"
+#include "file_system/file_interface.h"
+#include "file_system/file_system_interface.h"
+#include "keygen/key_generator_interface.h"
+#include "postgres/query_runner/connection/connection_reservoir_interface.h"
+#include "proto_cc/file.pb.h"
+#include "proto_cc/identity.pb.h"
+
+namespace e8 {
+
+/**
+ * @brief ResolveFileDescriptor Validates the viewer's access to the file location referred by the
+ * file descriptor and extracts the location. A read-write access satisfies both the read and the
+ * write access mode.
+ *
+ * @param viewer Identity of the user who requests the file access.
+ * @param descriptor Either a token access signed by ValidateFileAccessToken() or a direct access.
+ * @param access_mode The access mode the viewer needs.
+ * @param key_gen Key generator that holds the public signature verification key.
+ * @param db_conns Connections to the DemoWeb database.
+ * @return The file location if the access is granted.
+ */
+std::optional<std::string> ResolveFileDescriptor(Identity const &viewer,
+                                                 FileDescriptor const &descriptor,
+                                                 FileAccessMode access_mode,
+                                                 KeyGeneratorInterface *key_gen,
+                                                 ConnectionReservoirInterface *db_conns);
+
+/**
+ * @brief The FileUpload struct An upload in progress. The uploaded chunks go to a staging file of
+ * its own, which is deleted along with the upload unless CompleteFileUpload() has moved it.
+ */
+struct FileUpload {
+    ~FileUpload();
+
+    std::string staging_path;
+    std::unique_ptr<FileInterface> file;
+    FileSystemInterface *file_system;
+};
+
+/**
+ * @brief BeginFileUpload Creates an empty staging file for the location to receive the uploaded
+ * file chunks. Concurrent uploads to the same location get different staging files. The content
+ * only becomes visible at the location after CompleteFileUpload().
+ *
+ * @return The upload if the staging file can be created.
+ */
+std::unique_ptr<FileUpload> BeginFileUpload(std::string const &file_path,
+                                            FileSystemInterface *file_system);
+
+/**
+ * @brief WriteFileChunk Writes the chunk into the staging file at the offset given by its chunk
+ * number. Chunks can be written in any order.
+ *
+ * @return false if the chunk is malformed, it lies beyond kMaxFileSize or it can't be written.
+ */
+bool WriteFileChunk(FileChunk const &chunk, FileUpload *upload);
+
+/**
+ * @brief CompleteFileUpload Moves the uploaded content into its file blob, or discards it if an
+ * identical content has been stored, then points the location to the blob and records the
+ * metadata of the uploaded file.
+ *
+ * @param file_path The location passed to BeginFileUpload().
+ * @param upload The upload returned by BeginFileUpload().
+ * @return The metadata of the uploaded file if it can be recorded.
+ */
+std::optional<FileMetadataEntity> CompleteFileUpload(std::string const &file_path,
+                                                     FileUpload *upload,
+                                                     FileSystemInterface *file_system,
+                                                     ConnectionReservoirInterface *db_conns);
+
+/**
+ * @brief LinkKnownFileContent Points the location to the already stored content of the specified
+ * content hash so that the content doesn't have to be uploaded again.
+ *
+ * @return The metadata of the file if the content is known. Otherwise, nullopt and the content
+ * has to be uploaded.
+ */
+std::optional<FileMetadataEntity> LinkKnownFileContent(std::string const &file_path,
+                                                       std::string const &content_hash,
+                                                       FileSystemInterface *file_system,
+                                                       ConnectionReservoirInterface *db_conns);
+
+/**
+ * @brief OpenStoredFile Opens the physical file which stores the content of the location.
+ *
+ * @return The file handle if the content exists.
+ */
+std::unique_ptr<FileInterface> OpenStoredFile(std::string const &file_path,
+                                              FileSystemInterface *file_system,
+                                              ConnectionReservoirInterface *db_conns);
+
+/**
+ * @brief NumFileChunks The number of chunks a file of the specified size is split into.
+ */
+int32_t NumFileChunks(uint64_t file_size);
+
+/**
+ * @brief ReadFileChunk Copies the chunk of the specified number out of the file content.
+ */
+void ReadFileChunk(std::string_view file_content, int32_t chunk_number, FileChunk *chunk);
+
+} // namespace e8
 
 #endif // FILE_IO_H
@@ -18,8 +18,11 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
+#include <tuple>
+#include <vector>
 
 #include "demoweb_service/demoweb/common_entity/file_metadata_entity.h"
 #include "demoweb_service/demoweb/constant/demoweb_database.h"
@@ -33,7 +36,7 @@ namespace e8 {
 namespace {
 
 std::optional<FileFormat> DetectFileFormat(std::string const &file_path) {
-    std::string path;
+    std::string path(file_path.size(), '\0');
     std::transform(file_path.begin(), file_path.end(), path.begin(),
                    [](unsigned char c) { return std::tolower(c); });
 
@@ -42,35 +45,143 @@ std::optional<FileFormat> DetectFileFormat(std::string const &file_path) {
         return std::nullopt;
     }
 
-    std::string suffix = path.substr(pos);
+    std::string suffix = path.substr(pos + 1);
     if (suffix == "jpeg" || suffix == "jpg") {
         return FileFormat::FFMT_IMAGE_JPEG;
-    } else if (path == "png") {
+    } else if (suffix == "png") {
         return FileFormat::FFMT_IMAGE_PNG;
-    } else if (path == "mp4") {
+    } else if (suffix == "mp4") {
         return FileFormat::FFMT_VIDEO_MPEG4;
-    } else if (path == "gif") {
+    } else if (suffix == "gif") {
         return FileFormat::FFMT_VIDEO_GIF;
-    } else if (path == "ogv") {
+    } else if (suffix == "ogv") {
         return FileFormat::FFMT_VIDEO_OGV;
-    } else if (path == "mp3") {
+    } else if (suffix == "mp3") {
         return FileFormat::FFMT_AUDIO_MP3;
-    } else if (path == "ogg") {
+    } else if (suffix == "ogg") {
         return FileFormat::FFMT_AUDIO_OGG;
     } else {
         return std::nullopt;
     }
 }
 
+/**
+ * @brief UpdateFileContentHash Points the existing metadata to the content hash.
+ *
+ * @return The updated metadata and the one it replaced, or nullopt if the file has no metadata.
+ */
+std::optional<std::tuple<FileMetadataEntity, FileMetadataEntity>>
+UpdateFileContentHash(FileMetadataEntity const &file, ConnectionReservoirInterface *db_conns) {
+    SqlQueryBuilder query;
+    SqlQueryBuilder::Placeholder<SqlStr> file_path_ph;
+    SqlQueryBuilder::Placeholder<SqlInt> format_ph;
+    SqlQueryBuilder::Placeholder<SqlLong> storage_size_ph;
+    SqlQueryBuilder::Placeholder<SqlStr> content_hash_ph;
+    SqlQueryBuilder::Placeholder<SqlTimestamp> timestamp_ph;
+
+    // Locking the row before updating it makes the previous metadata the latest committed one
+    // rather than the one in the statement's snapshot.
+    query.QueryPiece("WITH previous AS (SELECT * FROM ")
+        .QueryPiece(TableNames::FileMetadata())
+        .QueryPiece(" WHERE path=")
+        .Holder(&file_path_ph)
+        .QueryPiece(" FOR UPDATE),swapped AS (UPDATE ")
+        .QueryPiece(TableNames::FileMetadata())
+        .QueryPiece(" fm SET format=")
+        .Holder(&format_ph)
+        .QueryPiece(",encryption_key_source=")
+        .QueryPiece(std::to_string(EncryptionSource::ESRC_NONE))
+        .QueryPiece(",storage_size=")
+        .Holder(&storage_size_ph)
+        .QueryPiece(",content_hash=")
+        .Holder(&content_hash_ph)
+        .QueryPiece(",last_modified_at=")
+        .Holder(&timestamp_ph)
+        .QueryPiece(" FROM previous WHERE fm.path=previous.path RETURNING fm.*) ")
+        .EndWithClause()
+        .QueryPiece("swapped fm,previous old");
+
+    query.SetValueToPlaceholder(file_path_ph,
+                                std::make_shared<SqlStr>(*file.path.Value(), /*field_name=*/""));
+    query.SetValueToPlaceholder(format_ph, std::make_shared<SqlInt>(*file.format.Value()));
+    query.SetValueToPlaceholder(storage_size_ph,
+                                std::make_shared<SqlLong>(*file.storage_size.Value()));
+    query.SetValueToPlaceholder(
+        content_hash_ph, std::make_shared<SqlStr>(*file.content_hash.Value(), /*field_name=*/""));
+    query.SetValueToPlaceholder(
+        timestamp_ph, std::make_shared<SqlTimestamp>(*file.last_modified_at.Value()));
+
+    std::vector<std::tuple<FileMetadataEntity, FileMetadataEntity>> query_result =
+        Query<FileMetadataEntity, FileMetadataEntity>(query, {"fm", "old"}, db_conns);
+    if (query_result.empty()) {
+        return std::nullopt;
+    }
+
+    assert(query_result.size() == 1);
+    return query_result[0];
+}
+
+/**
+ * @brief CreateFileMetadata Inserts the metadata unless the file already has one.
+ *
+ * @return true if the metadata is inserted.
+ */
+bool CreateFileMetadata(FileMetadataEntity const &file, ConnectionReservoirInterface *db_conns) {
+    SqlQueryBuilder query;
+    SqlQueryBuilder::Placeholder<SqlStr> file_path_ph;
+    SqlQueryBuilder::Placeholder<SqlInt> format_ph;
+    SqlQueryBuilder::Placeholder<SqlLong> storage_size_ph;
+    SqlQueryBuilder::Placeholder<SqlStr> content_hash_ph;
+    SqlQueryBuilder::Placeholder<SqlTimestamp> created_at_ph;
+    SqlQueryBuilder::Placeholder<SqlTimestamp> last_modified_at_ph;
+
+    query.QueryPiece("WITH created AS (INSERT INTO ")
+        .QueryPiece(TableNames::FileMetadata())
+        .QueryPiece("(path,format,encryption_key_source,storage_size,content_hash,created_at,"
+                    "last_modified_at)VALUES(")
+        .Holder(&file_path_ph)
+        .QueryPiece(",")
+        .Holder(&format_ph)
+        .QueryPiece(",")
+        .QueryPiece(std::to_string(EncryptionSource::ESRC_NONE))
+        .QueryPiece(",")
+        .Holder(&storage_size_ph)
+        .QueryPiece(",")
+        .Holder(&content_hash_ph)
+        .QueryPiece(",")
+        .Holder(&created_at_ph)
+        .QueryPiece(",")
+        .Holder(&last_modified_at_ph)
+        .QueryPiece(")ON CONFLICT (path) DO NOTHING RETURNING *) ")
+        .EndWithClause()
+        .QueryPiece("created fm");
+
+    query.SetValueToPlaceholder(file_path_ph,
+                                std::make_shared<SqlStr>(*file.path.Value(), /*field_name=*/""));
+    query.SetValueToPlaceholder(format_ph, std::make_shared<SqlInt>(*file.format.Value()));
+    query.SetValueToPlaceholder(storage_size_ph,
+                                std::make_shared<SqlLong>(*file.storage_size.Value()));
+    query.SetValueToPlaceholder(
+        content_hash_ph, std::make_shared<SqlStr>(*file.content_hash.Value(), /*field_name=*/""));
+    query.SetValueToPlaceholder(created_at_ph,
+                                std::make_shared<SqlTimestamp>(*file.created_at.Value()));
+    query.SetValueToPlaceholder(
+        last_modified_at_ph, std::make_shared<SqlTimestamp>(*file.last_modified_at.Value()));
+
+    return !Query<FileMetadataEntity>(query, {"fm"}, db_conns).empty();
+}
+
 } // namespace
 
-std::optional<FileMetadataEntity> AttachMetadataForFile(std::string const &file_path,
-                                                        uint64_t file_size,
-                                                        EncryptionSource encryption_source,
-                                                        ConnectionReservoirInterface *db_conns) {
+std::optional<FileMetadataEntity>
+AttachMetadataForFile(std::string const &file_path, uint64_t file_size,
+                      EncryptionSource encryption_source,
+                      std::optional<std::string> const &content_hash,
+                      ConnectionReservoirInterface *db_conns) {
     FileMetadataEntity file;
     *file.path.ValuePtr() = file_path;
     *file.storage_size.ValuePtr() = file_size;
+    *file.content_hash.ValuePtr() = content_hash;
 
     std::optional<FileFormat> format = DetectFileFormat(file_path);
     if (!format.has_value()) {
@@ -90,4 +201,62 @@ std::optional<FileMetadataEntity> AttachMetadataForFile(std::string const &file_
     return file;
 }
 
+std::optional<FileMetadataEntity>
+SwapFileContentHash(std::string const &file_path, uint64_t file_size,
+                    std::string const &content_hash,
+                    std::optional<std::string> *previous_content_hash,
+                    ConnectionReservoirInterface *db_conns) {
+    FileMetadataEntity file;
+    *file.path.ValuePtr() = file_path;
+    *file.storage_size.ValuePtr() = file_size;
+    *file.content_hash.ValuePtr() = content_hash;
+
+    std::optional<FileFormat> format = DetectFileFormat(file_path);
+    if (!format.has_value()) {
+        return std::nullopt;
+    }
+    *file.format.ValuePtr() = format.value();
+    *file.encryption_key_source.ValuePtr() = EncryptionSource::ESRC_NONE;
+
+    TimestampMicros timestamp = CurrentTimestampMicros();
+    *file.created_at.ValuePtr() = timestamp;
+    *file.last_modified_at.ValuePtr() = timestamp;
+
+    // Whoever creates the metadata of a new file replaces nothing. The others retry the update
+    // against the created metadata.
+    while (true) {
+        std::optional<std::tuple<FileMetadataEntity, FileMetadataEntity>> swapped =
+            UpdateFileContentHash(file, db_conns);
+        if (swapped.has_value()) {
+            *previous_content_hash = std::get<1>(*swapped).content_hash.Value();
+            return std::get<0>(*swapped);
+        }
+
+        if (CreateFileMetadata(file, db_conns)) {
+            *previous_content_hash = std::nullopt;
+            return file;
+        }
+    }
+}
+
+std::optional<FileMetadataEntity> FetchFileMetadata(std::string const &file_path,
+                                                    ConnectionReservoirInterface *db_conns) {
+    SqlQueryBuilder query;
+    SqlQueryBuilder::Placeholder<SqlStr> file_path_ph;
+    query.QueryPiece(TableNames::FileMetadata())
+        .QueryPiece(" fm WHERE fm.path=")
+        .Holder(&file_path_ph);
+
+    query.SetValueToPlaceholder(file_path_ph,
+                                std::make_shared<SqlStr>(file_path, /*field_name=*/""));
+
+    std::vector<std::tuple<FileMetadataEntity>> query_result =
+        Query<FileMetadataEntity>(query, {"fm"}, db_conns);
+    if (query_result.empty()) {
+        return std::nullopt;
+    }
+
+    return std::get<0>(query_result[0]);
+}
+
 } // namespace e8
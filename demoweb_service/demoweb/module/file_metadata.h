@@ -34,13 +34,41 @@ namespace e8 {
  *
  * @param file_path Path to the file to attach metadata to.
  * @param encryption_source Who holds the key to encrypt/decrypt the file.
+ * @param content_hash If present, the file content is stored in the shared file blob of this
+ * content hash rather than at the file path. See file_blob.h.
  * @param db_conns Connections to the DemoWeb database.
  * @return The saved file metadata if the attachment succeed.
  */
-std::optional<FileMetadataEntity> AttachMetadataForFile(std::string const &file_path,
-                                                        uint64_t file_size,
-                                                        EncryptionSource encryption_source,
-                                                        ConnectionReservoirInterface *db_conns);
+std::optional<FileMetadataEntity>
+AttachMetadataForFile(std::string const &file_path, uint64_t file_size,
+                      EncryptionSource encryption_source,
+                      std::optional<std::string> const &content_hash,
+                      ConnectionReservoirInterface *db_conns);
+
+/**
+ * @brief SwapFileContentHash Creates or updates the metadata of the file so that its content is
+ * stored in the file blob of the specified content hash. The metadata is locked while the content
+ * hash is swapped, so concurrent callers each get back the content hash they replaced.
+ *
+ * @param file_path Path to the file to attach metadata to.
+ * @param content_hash The content hash of the file blob. See file_blob.h.
+ * @param previous_content_hash Receives the content hash the file had before, if any.
+ * @param db_conns Connections to the DemoWeb database.
+ * @return The saved file metadata if the attachment succeed.
+ */
+std::optional<FileMetadataEntity>
+SwapFileContentHash(std::string const &file_path, uint64_t file_size,
+                    std::string const &content_hash,
+                    std::optional<std::string> *previous_content_hash,
+                    ConnectionReservoirInterface *db_conns);
+
+/**
+ * @brief FetchFileMetadata Fetches the metadata attached to the file path.
+ *
+ * @return The file metadata if it exists.
+ */
+std::optional<FileMetadataEntity> FetchFileMetadata(std::string const &file_path,
+                                                    ConnectionReservoirInterface *db_conns);
 
 } // namespace e8
 
@@ -15,7 +15,6 @@
  * not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <memory>
@@ -24,58 +23,98 @@
 #include <tuple>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
+#include "demoweb_service/demoweb/common_entity/contact_relation_entity.h"
 #include "demoweb_service/demoweb/common_entity/message_channel_entity.h"
 #include "demoweb_service/demoweb/common_entity/message_channel_has_user_entity.h"
 #include "demoweb_service/demoweb/common_entity/user_entity.h"
 #include "demoweb_service/demoweb/constant/demoweb_database.h"
 #include "demoweb_service/demoweb/environment/host_id.h"
+#include "demoweb_service/demoweb/module/contact_storage.h"
 #include "demoweb_service/demoweb/module/message_channel.h"
 #include "demoweb_service/demoweb/module/message_channel_storage.h"
+#include "demoweb_service/demoweb/module/public_profile_cache.h"
 #include "demoweb_service/demoweb/module/user_profile.h"
-#include "demoweb_service/demoweb/module/user_storage.h"
 #include "postgres/query_runner/connection/connection_reservoir_interface.h"
+#include "postgres/query_runner/reflection/sql_entity_interface.h"
+#include "postgres/query_runner/reflection/sql_primitives.h"
 #include "postgres/query_runner/sql_query_builder.h"
 #include "postgres/query_runner/sql_runner.h"
 #include "proto_cc/message_channel.pb.h"
 #include "proto_cc/pagination.pb.h"
 #include "proto_cc/user_profile.pb.h"
+#include "proto_cc/user_relation.pb.h"
 
 namespace e8 {
+namespace {
+
+class ProposedMembershipEntity : public SqlEntityInterface {
+  public:
+    ProposedMembershipEntity() : SqlEntityInterface{&user_id, &ownership} {}
+    ProposedMembershipEntity(ProposedMembershipEntity const &other)
+        : SqlEntityInterface{&user_id, &ownership}, user_id(other.user_id),
+          ownership(other.ownership) {}
+
+    SqlLong user_id = SqlLong("user_id");
+    SqlInt ownership = SqlInt("ownership");
+};
+
+} // namespace
+
 namespace message_channel_internal {
 
 MessageChannelMembershipDelta ComputeMessageChannelMembershipDelta(
     MessageChannelId const channel_id,
     std::vector<MessageChannelMembership> const &proposed_memberships,
     ConnectionReservoirInterface *conns) {
-    SqlQueryBuilder message_channel_member_query;
-    SqlQueryBuilder::Placeholder<SqlLong> channel_id_ph;
-    message_channel_member_query.QueryPiece(TableNames::MessageChannelHasUser())
-        .QueryPiece(" mchu")
-        .QueryPiece(" WHERE mchu.channel_id=")
-        .Holder(&channel_id_ph);
-
-    message_channel_member_query.SetValueToPlaceholder(channel_id_ph,
-                                                       std::make_shared<SqlLong>(channel_id));
-
-    std::vector<std::tuple<MessageChannelHasUserEntity>> members =
-        Query<MessageChannelHasUserEntity>(message_channel_member_query, {"mchu"}, conns);
-    std::unordered_map<UserId, MessageChannelHasUserEntity> current_members;
-    for (auto const &member : members) {
-        MessageChannelHasUserEntity const &entity = std::get<0>(member);
-        current_members[*entity.user_id.Value()] = entity;
-    }
-
+    // A later proposal for the same user overrides the earlier ones.
     std::unordered_map<UserId, MessageChannelMembership> proposed_members;
     for (auto const &membership : proposed_memberships) {
         proposed_members[membership.user_id()] = membership;
     }
 
+    std::vector<int64_t> proposed_user_ids;
+    std::vector<int32_t> proposed_member_types;
+    for (auto const &[user_id, membership] : proposed_members) {
+        proposed_user_ids.push_back(user_id);
+        proposed_member_types.push_back(membership.member_type());
+    }
+
+    // Let the database diff the current members against the proposal so that only the differences
+    // are returned.
+    SqlQueryBuilder delta_query;
+    SqlQueryBuilder::Placeholder<SqlLong> channel_id_ph;
+    SqlQueryBuilder::Placeholder<SqlLongArr> proposed_user_ids_ph;
+    SqlQueryBuilder::Placeholder<SqlIntArr> proposed_member_types_ph;
+    delta_query.QueryPiece("(SELECT * FROM ")
+        .QueryPiece(TableNames::MessageChannelHasUser())
+        .QueryPiece(" WHERE channel_id=")
+        .Holder(&channel_id_ph)
+        .QueryPiece(") AS mchu")
+        .QueryPiece(" FULL OUTER JOIN UNNEST(")
+        .Holder(&proposed_user_ids_ph)
+        .QueryPiece("::BIGINT[],")
+        .Holder(&proposed_member_types_ph)
+        .QueryPiece("::INT[]) AS proposed(user_id,ownership)")
+        .QueryPiece(" ON proposed.user_id=mchu.user_id")
+        .QueryPiece(" WHERE mchu.user_id IS NULL OR proposed.user_id IS NULL")
+        .QueryPiece(" OR proposed.ownership<>mchu.ownership");
+
+    delta_query.SetValueToPlaceholder(channel_id_ph, std::make_shared<SqlLong>(channel_id));
+    delta_query.SetValueToPlaceholder(proposed_user_ids_ph,
+                                      std::make_shared<SqlLongArr>(proposed_user_ids));
+    delta_query.SetValueToPlaceholder(proposed_member_types_ph,
+                                      std::make_shared<SqlIntArr>(proposed_member_types));
+
+    std::vector<std::tuple<MessageChannelHasUserEntity, ProposedMembershipEntity>> differences =
+        Query<MessageChannelHasUserEntity, ProposedMembershipEntity>(delta_query,
+                                                                     {"mchu", "proposed"}, conns);
+
     MessageChannelMembershipDelta delta;
-    for (auto const &[member_id, current_member] : current_members) {
-        auto it = proposed_members.find(member_id);
-        if (it == proposed_members.end()) {
+    for (auto const &[current_member, proposed_member] : differences) {
+        if (!proposed_member.user_id.Value().has_value()) {
             // To be removed.
             MessageChannelMembership to_be_removed;
             to_be_removed.set_user_id(*current_member.user_id.Value());
@@ -83,18 +122,12 @@ MessageChannelMembershipDelta ComputeMessageChannelMembershipDelta(
             to_be_removed.set_member_type(
                 static_cast<MessageChannelMemberType>(*current_member.ownership.Value()));
             delta.to_be_removed.push_back(to_be_removed);
-        } else {
-            if (it->second.member_type() != *current_member.ownership.Value()) {
-                // To be modified.
-                delta.to_be_modified.push_back(it->second);
-            }
-        }
-    }
-    for (auto const &[proposed_member_id, proposed_member] : proposed_members) {
-        auto it = current_members.find(proposed_member_id);
-        if (it == current_members.end()) {
+        } else if (!current_member.user_id.Value().has_value()) {
             // To be added.
-            delta.to_be_added.push_back(proposed_member);
+            delta.to_be_added.push_back(proposed_members[*proposed_member.user_id.Value()]);
+        } else {
+            // To be modified.
+            delta.to_be_modified.push_back(proposed_members[*proposed_member.user_id.Value()]);
         }
     }
 
@@ -105,55 +138,36 @@ MessageChannelMembershipDelta ComputeMessageChannelMembershipDelta(
 
 namespace {
 
-std::vector<std::vector<MessageChannelHasUserEntity>>
-FetchMostActiveMembers(std::vector<MessageChannelId> const &message_channel_ids,
-                       unsigned active_member_fetch_limit, ConnectionReservoirInterface *conns) {
-    if (active_member_fetch_limit == 0) {
-        return std::vector<std::vector<MessageChannelHasUserEntity>>(message_channel_ids.size());
-    }
-
-    SqlQueryBuilder member_query;
-    SqlQueryBuilder::Placeholder<SqlLongArr> channel_ids_ph;
-    member_query.QueryPiece(TableNames::MessageChannelHasUser())
-        .QueryPiece(" mchu WHERE mchu.channel_id=ANY(")
-        .Holder(&channel_ids_ph)
-        .QueryPiece(")");
-
-    member_query.SetValueToPlaceholder(channel_ids_ph,
-                                       std::make_shared<SqlLongArr>(message_channel_ids));
-
-    std::vector<std::tuple<MessageChannelHasUserEntity>> members =
-        Query<MessageChannelHasUserEntity>(member_query, {"mchu"}, conns);
-
-    // Group by channel ID.
-    std::unordered_map<MessageChannelId, std::vector<MessageChannelHasUserEntity>> group_by_channel;
-    for (auto const &entry : members) {
-        MessageChannelHasUserEntity const &member = std::get<0>(entry);
-        group_by_channel[*member.channel_id.Value()].push_back(member);
-    }
-
-    std::vector<std::vector<MessageChannelHasUserEntity>> result(message_channel_ids.size());
-    for (unsigned i = 0; i < message_channel_ids.size(); ++i) {
-        MessageChannelId channel_id = message_channel_ids[i];
-
-        // Use last interaction timestamp as a criteria for activeness.
-        std::vector<MessageChannelHasUserEntity> *members = &group_by_channel[channel_id];
-        std::sort(members->begin(), members->end(),
-                  [](MessageChannelHasUserEntity const &a, MessageChannelHasUserEntity const &b) {
-                      return *a.last_interaction_at.Value() > *b.last_interaction_at.Value();
-                  });
-
-        // Trim to the limit and write out the IDs.
-        std::vector<MessageChannelHasUserEntity>::iterator end_it;
-        if (active_member_fetch_limit < members->size()) {
-            end_it = members->begin() + active_member_fetch_limit;
-            result[i].resize(active_member_fetch_limit);
-        } else {
-            end_it = members->end();
-            result[i].resize(members->size());
+using SearchedChannelGroup = std::tuple<MessageChannelEntity, MessageChannelHasUserEntity>;
+using ActiveMemberElement =
+    std::tuple<MessageChannelHasUserEntity, UserEntity, ContactRelationEntity>;
+
+SearchedMessageChannel
+ToSearchedMessageChannel(SearchedChannelGroup const &channel_and_viewer,
+                         std::vector<ActiveMemberElement> const &active_members) {
+    SearchedMessageChannel result;
+    result.message_channel = std::get<0>(channel_and_viewer);
+    result.member_type =
+        static_cast<MessageChannelMemberType>(*std::get<1>(channel_and_viewer).ownership.Value());
+    result.join_at = *std::get<1>(channel_and_viewer).created_at.Value();
+
+    // Every relation the viewer has towards a member yields a record. They are adjacent and
+    // ordered by the relation creation timestamp in descending order.
+    for (auto const &[member, user, relation] : active_members) {
+        UserId member_id = *member.user_id.Value();
+        if (result.most_active_members.empty() ||
+            *result.most_active_members.back().user_id.Value() != member_id) {
+            result.most_active_members.push_back(member);
+            result.most_active_users.push_back(user);
         }
 
-        std::copy(members->begin(), end_it, result[i].begin());
+        if (!relation.relation.Value().has_value()) {
+            continue;
+        }
+        UserRelationRecord record;
+        record.set_relation(static_cast<UserRelation>(*relation.relation.Value()));
+        record.set_created_at(*relation.created_at.Value());
+        result.most_active_user_relations[member_id].push_back(record);
     }
 
     return result;
@@ -188,10 +202,22 @@ MessageChannelEntity CreateMessageChannel(UserId creator_id,
     MessageChannelEntity message_channel = CreateMessageChannel(
         channel_name, description, encrypted, close_group_channel, host_id, conns);
 
-    UpdateMessageChannelMembership(*message_channel.id.Value(), creator_id, MCMT_ADMIN, conns);
+    std::vector<MessageChannelMembership> memberships;
     for (UserId const user_id : to_be_member_ids) {
-        UpdateMessageChannelMembership(*message_channel.id.Value(), user_id, MCMT_ADMIN, conns);
+        MessageChannelMembership membership;
+        membership.set_user_id(user_id);
+        membership.set_channel_id(*message_channel.id.Value());
+        membership.set_member_type(MCMT_ADMIN);
+        memberships.push_back(membership);
     }
+    MessageChannelMembership creator;
+    creator.set_user_id(creator_id);
+    creator.set_channel_id(*message_channel.id.Value());
+    creator.set_member_type(MCMT_ADMIN);
+    memberships.push_back(creator);
+
+    ApplyMessageChannelMembershipChanges(*message_channel.id.Value(), memberships,
+                                         /*to_be_updated=*/{}, /*to_be_removed=*/{}, conns);
 
     return message_channel;
 }
@@ -233,17 +259,14 @@ bool UpdateMessageChannelMembership(UserId const viewer_id, MessageChannelId con
     }
 
     // Apply the delta.
-    for (auto const &membership : delta.to_be_modified) {
-        UpdateMessageChannelMembership(channel_id, membership.user_id(), membership.member_type(),
-                                       conns);
-    }
-    for (auto const &membership : delta.to_be_added) {
-        all_successful &= CreateMessageChannelMembership(channel_id, membership.user_id(),
-                                                         membership.member_type(), conns);
-    }
+    std::vector<UserId> removed_user_ids;
     for (auto const &membership : delta.to_be_removed) {
-        all_successful &= DeleteMessageChannelMembership(channel_id, membership.user_id(), conns);
+        removed_user_ids.push_back(membership.user_id());
     }
+    NumMembershipChanges num_changes = ApplyMessageChannelMembershipChanges(
+        channel_id, delta.to_be_added, delta.to_be_modified, removed_user_ids, conns);
+    all_successful &= num_changes.num_added == delta.to_be_added.size();
+    all_successful &= num_changes.num_removed == delta.to_be_removed.size();
 
     return all_successful;
 }
@@ -269,12 +292,16 @@ std::vector<SearchedMessageChannel> SearchMessageChannels(
         must_have_user_ids.push_back(viewer_id);
     }
 
-    // Search message channels.
-    SqlQueryBuilder message_channel_query;
+    // Search a page of message channels.
+    SqlQueryBuilder query;
     SqlQueryBuilder::Placeholder<SqlLongArr> contains_member_ids_ph;
     SqlQueryBuilder::Placeholder<SqlInt> must_have_user_count_ph;
     SqlQueryBuilder::Placeholder<SqlLong> viewer_id_ph;
-    message_channel_query.QueryPiece("(SELECT mc.* FROM ")
+    SqlQueryBuilder::Placeholder<SqlInt> active_member_fetch_limit_ph;
+    query.QueryPiece("WITH page AS (SELECT qualified_channel.id AS channel_id,")
+        .QueryPiece(" ROW_NUMBER() OVER (ORDER BY viewer.last_interaction_at DESC)")
+        .QueryPiece(" AS page_position")
+        .QueryPiece(" FROM (SELECT mc.id FROM ")
         .QueryPiece(TableNames::MessageChannel())
         .QueryPiece(" mc")
         .QueryPiece(" JOIN ")
@@ -287,15 +314,21 @@ std::vector<SearchedMessageChannel> SearchMessageChannels(
 
     if (!any_channel_ids.empty()) {
         SqlQueryBuilder::Placeholder<SqlLongArr> any_channel_ids_ph;
-        message_channel_query.QueryPiece(" AND mc.id=ANY(")
-            .Holder(&any_channel_ids_ph)
-            .QueryPiece(")");
-        message_channel_query.SetValueToPlaceholder(
-            any_channel_ids_ph, std::make_shared<SqlLongArr>(std::vector<MessageChannelId>{
-                                    any_channel_ids.begin(), any_channel_ids.end()}));
+        query.QueryPiece(" AND mc.id=ANY(").Holder(&any_channel_ids_ph).QueryPiece(")");
+        query.SetValueToPlaceholder(any_channel_ids_ph,
+                                    std::make_shared<SqlLongArr>(std::vector<MessageChannelId>{
+                                        any_channel_ids.begin(), any_channel_ids.end()}));
     }
 
-    message_channel_query.QueryPiece(" GROUP BY mc.id HAVING COUNT(required_member.user_id)=")
+    if (query_text.has_value()) {
+        SqlQueryBuilder::Placeholder<SqlStr> ts_query_ph;
+        query.QueryPiece(" AND mc.search_terms@@TO_TSQUERY(").Holder(&ts_query_ph).QueryPiece(")");
+        query.SetValueToPlaceholder(
+            ts_query_ph, std::make_shared<SqlStr>(sql_runner_internal::ToTsQuery(
+                             *query_text, /*prefix_search=*/true)));
+    }
+
+    query.QueryPiece(" GROUP BY mc.id HAVING COUNT(required_member.user_id)=")
         .Holder(&must_have_user_count_ph)
         .QueryPiece(") AS qualified_channel")
         .QueryPiece(" JOIN ")
@@ -305,101 +338,81 @@ std::vector<SearchedMessageChannel> SearchMessageChannels(
         .Holder(&viewer_id_ph)
         .QueryPiece(" ORDER BY viewer.last_interaction_at DESC");
 
-    message_channel_query.SetValueToPlaceholder(contains_member_ids_ph,
-                                                std::make_shared<SqlLongArr>(must_have_user_ids));
-    message_channel_query.SetValueToPlaceholder(
-        must_have_user_count_ph, std::make_shared<SqlInt>(must_have_user_ids.size()));
-    message_channel_query.SetValueToPlaceholder(viewer_id_ph, std::make_shared<SqlLong>(viewer_id));
-
-    std::vector<std::tuple<MessageChannelEntity, MessageChannelHasUserEntity>> channel_and_viewer;
-
-    if (query_text.has_value()) {
-        channel_and_viewer = Search<MessageChannelEntity, MessageChannelHasUserEntity>(
-            message_channel_query, /*entity_aliases=*/{"qualified_channel", "viewer"},
-            /*search_target_entity=*/{"qualified_channel"}, *query_text, /*prefix_search=*/true,
-            /*rank_result=*/false, pagination->result_per_page(),
-            pagination->result_per_page() * pagination->page_number(), conns);
-    } else {
-        if (pagination.has_value()) {
-            SqlQueryBuilder::Placeholder<SqlInt> limit_ph;
-            SqlQueryBuilder::Placeholder<SqlInt> offset_ph;
-            message_channel_query.QueryPiece(" LIMIT ")
-                .Holder(&limit_ph)
-                .QueryPiece(" OFFSET ")
-                .Holder(&offset_ph);
-            message_channel_query.SetValueToPlaceholder(
-                limit_ph, std::make_shared<SqlInt>(pagination->result_per_page()));
-            message_channel_query.SetValueToPlaceholder(
-                offset_ph, std::make_shared<SqlInt>(pagination->page_number() *
-                                                    pagination->result_per_page()));
-        }
-        channel_and_viewer = Query<MessageChannelEntity, MessageChannelHasUserEntity>(
-            message_channel_query, {"qualified_channel", "viewer"}, conns);
-    }
-
-    // Fetch the most active members for each message channel.
-    std::vector<MessageChannelId> message_channel_ids(channel_and_viewer.size());
-    for (unsigned i = 0; i < channel_and_viewer.size(); i++) {
-        message_channel_ids[i] = *std::get<0>(channel_and_viewer[i]).id.Value();
+    if (pagination.has_value()) {
+        SqlQueryBuilder::Placeholder<SqlInt> limit_ph;
+        SqlQueryBuilder::Placeholder<SqlInt> offset_ph;
+        query.QueryPiece(" LIMIT ").Holder(&limit_ph).QueryPiece(" OFFSET ").Holder(&offset_ph);
+        query.SetValueToPlaceholder(limit_ph,
+                                    std::make_shared<SqlInt>(pagination->result_per_page()));
+        query.SetValueToPlaceholder(
+            offset_ph,
+            std::make_shared<SqlInt>(pagination->page_number() * pagination->result_per_page()));
     }
-    std::vector<std::vector<MessageChannelHasUserEntity>> most_active_members =
-        FetchMostActiveMembers(message_channel_ids, active_member_fetch_limit, conns);
 
-    // Combine results.
-    std::vector<SearchedMessageChannel> results(channel_and_viewer.size());
-    for (unsigned i = 0; i < channel_and_viewer.size(); ++i) {
-        auto const &entry = channel_and_viewer[i];
+    query.QueryPiece(") ").EndWithClause();
 
-        SearchedMessageChannel result;
-        result.message_channel = std::get<0>(entry);
-        result.member_type =
-            static_cast<MessageChannelMemberType>(*std::get<1>(entry).ownership.Value());
-        result.join_at = *std::get<1>(entry).created_at.Value();
-        result.most_active_members = most_active_members[i];
-
-        results[i] = result;
+    // Join in the most active members of each channel on the page as well as the viewer's
+    // relations towards them. A channel without any member to show keeps a single record with
+    // NULL member columns.
+    query.QueryPiece("page JOIN ")
+        .QueryPiece(TableNames::MessageChannel())
+        .QueryPiece(" mc ON mc.id=page.channel_id")
+        .QueryPiece(" JOIN ")
+        .QueryPiece(TableNames::MessageChannelHasUser())
+        .QueryPiece(" viewer ON viewer.channel_id=mc.id AND viewer.user_id=")
+        .Holder(&viewer_id_ph)
+        .QueryPiece(" LEFT JOIN LATERAL (SELECT active_member.* FROM ")
+        .QueryPiece(TableNames::MessageChannelHasUser())
+        .QueryPiece(" active_member WHERE active_member.channel_id=mc.id")
+        .QueryPiece(" ORDER BY active_member.last_interaction_at DESC LIMIT ")
+        .Holder(&active_member_fetch_limit_ph)
+        .QueryPiece(") AS top_member ON TRUE")
+        .QueryPiece(" LEFT JOIN ")
+        .QueryPiece(TableNames::AUser())
+        .QueryPiece(" u ON u.id=top_member.user_id")
+        .QueryPiece(" LEFT JOIN ")
+        .QueryPiece(TableNames::ContactRelation())
+        .QueryPiece(" cr ON cr.dst_user_id=top_member.user_id AND cr.src_user_id=")
+        .Holder(&viewer_id_ph)
+        .QueryPiece(" ORDER BY page.page_position, top_member.last_interaction_at DESC,")
+        .QueryPiece(" top_member.user_id, cr.created_at DESC");
+
+    query.SetValueToPlaceholder(contains_member_ids_ph,
+                                std::make_shared<SqlLongArr>(must_have_user_ids));
+    query.SetValueToPlaceholder(must_have_user_count_ph,
+                                std::make_shared<SqlInt>(must_have_user_ids.size()));
+    query.SetValueToPlaceholder(viewer_id_ph, std::make_shared<SqlLong>(viewer_id));
+    query.SetValueToPlaceholder(active_member_fetch_limit_ph,
+                                std::make_shared<SqlInt>(active_member_fetch_limit));
+
+    std::vector<std::pair<SearchedChannelGroup, std::vector<ActiveMemberElement>>> channels =
+        GroupedQuery<SearchedChannelGroup, ActiveMemberElement>(
+            query, {"mc", "viewer", "top_member", "u", "cr"}, conns);
+
+    std::vector<SearchedMessageChannel> results;
+    for (auto const &[channel_and_viewer, active_members] : channels) {
+        results.push_back(ToSearchedMessageChannel(channel_and_viewer, active_members));
     }
 
     return results;
 }
 
 std::vector<MessageChannelOverview>
-ToMessageChannelOverviews(UserId const viewer_id,
-                          std::vector<SearchedMessageChannel> const &searched_message_channels,
-                          KeyGeneratorInterface *key_gen, ConnectionReservoirInterface *conns) {
-    // Construct member profiles.
-    std::unordered_map<UserId, UserPublicProfile> active_member_profiles;
-    std::vector<UserId> unique_active_member_ids;
-    for (auto const &searched_channel : searched_message_channels) {
-        for (MessageChannelHasUserEntity const member : searched_channel.most_active_members) {
-            UserId const member_id = *member.user_id.Value();
-            auto it = active_member_profiles.find(member_id);
-            if (it == active_member_profiles.end()) {
-                active_member_profiles[member_id] = UserPublicProfile();
-                unique_active_member_ids.push_back(member_id);
-            }
-        }
-    }
-
-    std::vector<UserEntity> members = FetchUsers(unique_active_member_ids, conns);
-    std::vector<UserPublicProfile> member_profiles =
-        BuildPublicProfiles(viewer_id, members, key_gen, conns);
-    for (auto const &profile : member_profiles) {
-        active_member_profiles[profile.user_id()] = profile;
-    }
-
-    // Compose the overiew.
+ToMessageChannelOverviews(std::vector<SearchedMessageChannel> const &searched_message_channels,
+                          KeyGeneratorInterface *key_gen, PublicProfileCache *profile_cache) {
     std::vector<MessageChannelOverview> result(searched_message_channels.size());
     for (unsigned i = 0; i < searched_message_channels.size(); ++i) {
+        SearchedMessageChannel const &searched_channel = searched_message_channels[i];
+
         MessageChannelOverview overview;
-        *overview.mutable_channel() = GetMessageChannel(searched_message_channels[i]);
-        *overview.mutable_channel_relation() =
-            GetMessageChannelRelation(searched_message_channels[i]);
-        overview.set_channel_last_interacted_at(searched_message_channels[i].join_at);
-        for (auto const &member : searched_message_channels[i].most_active_members) {
-            *overview.mutable_most_active_users()->Add() =
-                active_member_profiles[*member.user_id.Value()];
-        }
+        *overview.mutable_channel() = GetMessageChannel(searched_channel);
+        *overview.mutable_channel_relation() = GetMessageChannelRelation(searched_channel);
+        overview.set_channel_last_interacted_at(searched_channel.join_at);
+
+        std::vector<UserPublicProfile> member_profiles = BuildPublicProfiles(
+            searched_channel.most_active_users, searched_channel.most_active_user_relations,
+            key_gen, profile_cache);
+        *overview.mutable_most_active_users() = {member_profiles.begin(), member_profiles.end()};
 
         result[i] = overview;
     }
@@ -29,6 +29,8 @@
 #include "demoweb_service/demoweb/common_entity/message_channel_has_user_entity.h"
 #include "demoweb_service/demoweb/common_entity/user_entity.h"
 #include "demoweb_service/demoweb/environment/host_id.h"
+#include "demoweb_service/demoweb/module/contact_storage.h"
+#include "demoweb_service/demoweb/module/public_profile_cache.h"
 #include "demoweb_service/demoweb/pbac/message_channel_pbac.h"
 #include "keygen/key_generator_interface.h"
 #include "postgres/query_runner/connection/connection_reservoir_interface.h"
@@ -114,6 +116,12 @@ struct SearchedMessageChannel {
     MessageChannelMemberType member_type;
     std::time_t join_at;
     std::vector<MessageChannelHasUserEntity> most_active_members;
+
+    // User entities of the most active members, in the same order as above.
+    std::vector<UserEntity> most_active_users;
+
+    // The viewer's relations towards the most active members.
+    std::unordered_map<UserId, UserRelations> most_active_user_relations;
 };
 
 /**
@@ -129,7 +137,8 @@ struct SearchedMessageChannel {
  * ID in this set. If this set is empty, then this parameter is ignored.
  * @param query_text Use raw text to search on channel title and description.
  * @param active_member_fetch_limit Maximum number of active member user IDs to be fetched for each
- * message channel.
+ * message channel. The users behind those members and the viewer's relations towards them are
+ * fetched alongside, so that the whole search takes a single database round trip.
  */
 std::vector<SearchedMessageChannel> SearchMessageChannels(
     UserId const viewer_id, std::unordered_set<UserId> const &contains_member_ids,
@@ -139,12 +148,13 @@ std::vector<SearchedMessageChannel> SearchMessageChannels(
 
 /**
  * @brief ToMessageChannelOverviews Converts message channel entities with user joining information
- * to message channel overview proto messages.
+ * to message channel overview proto messages. The active member profiles are built from what
+ * SearchMessageChannels() has fetched, so it doesn't access the database. The optional profile
+ * cache is used for building the active member profiles.
  */
 std::vector<MessageChannelOverview>
-ToMessageChannelOverviews(UserId const viewer_id,
-                          std::vector<SearchedMessageChannel> const &searched_message_channels,
-                          KeyGeneratorInterface *key_gen, ConnectionReservoirInterface *conns);
+ToMessageChannelOverviews(std::vector<SearchedMessageChannel> const &searched_message_channels,
+                          KeyGeneratorInterface *key_gen, PublicProfileCache *profile_cache);
 
 struct MessageChannelMember {
     UserEntity member;
@@ -18,8 +18,10 @@
 #include <cassert>
 #include <cstdint>
 #include <optional>
+#include <memory>
 #include <string>
 #include <tuple>
+#include <vector>
 
 #include "demoweb_service/demoweb/common_entity/message_channel_entity.h"
 #include "demoweb_service/demoweb/common_entity/message_channel_has_user_entity.h"
@@ -28,7 +30,11 @@
 #include "demoweb_service/demoweb/environment/host_id.h"
 #include "demoweb_service/demoweb/module/message_channel_storage.h"
 #include "postgres/query_runner/connection/connection_reservoir_interface.h"
+#include "postgres/query_runner/reflection/sql_entity_interface.h"
+#include "postgres/query_runner/reflection/sql_primitives.h"
+#include "postgres/query_runner/sql_query_builder.h"
 #include "postgres/query_runner/sql_runner.h"
+#include "proto_cc/message_channel.pb.h"
 
 namespace e8 {
 namespace {
@@ -48,6 +54,26 @@ ToMessageChannelHasUserEntity(MessageChannelId channel_id, UserId const user_id,
     return channel_member;
 }
 
+class NumMembershipChangesEntity : public SqlEntityInterface {
+  public:
+    NumMembershipChangesEntity() : SqlEntityInterface{&num_added, &num_updated, &num_removed} {}
+    NumMembershipChangesEntity(NumMembershipChangesEntity const &other)
+        : SqlEntityInterface{&num_added, &num_updated, &num_removed}, num_added(other.num_added),
+          num_updated(other.num_updated), num_removed(other.num_removed) {}
+
+    SqlLong num_added = SqlLong("num_added");
+    SqlLong num_updated = SqlLong("num_updated");
+    SqlLong num_removed = SqlLong("num_removed");
+};
+
+void SplitMemberships(std::vector<MessageChannelMembership> const &memberships,
+                      std::vector<int64_t> *user_ids, std::vector<int32_t> *member_types) {
+    for (auto const &membership : memberships) {
+        user_ids->push_back(membership.user_id());
+        member_types->push_back(membership.member_type());
+    }
+}
+
 } // namespace
 
 MessageChannelEntity CreateMessageChannel(std::optional<std::string> const &channel_name,
@@ -147,4 +173,87 @@ bool DeleteMessageChannelMembership(MessageChannelId const channel_id, UserId co
     return 1L == Delete(TableNames::MessageChannelHasUser(), removal_query, conns);
 }
 
+NumMembershipChanges
+ApplyMessageChannelMembershipChanges(MessageChannelId const channel_id,
+                                     std::vector<MessageChannelMembership> const &to_be_added,
+                                     std::vector<MessageChannelMembership> const &to_be_updated,
+                                     std::vector<UserId> const &to_be_removed,
+                                     ConnectionReservoirInterface *conns) {
+    std::vector<int64_t> added_user_ids;
+    std::vector<int32_t> added_member_types;
+    SplitMemberships(to_be_added, &added_user_ids, &added_member_types);
+
+    std::vector<int64_t> updated_user_ids;
+    std::vector<int32_t> updated_member_types;
+    SplitMemberships(to_be_updated, &updated_user_ids, &updated_member_types);
+
+    SqlQueryBuilder query;
+    SqlQueryBuilder::Placeholder<SqlLong> channel_id_ph;
+    SqlQueryBuilder::Placeholder<SqlLongArr> added_user_ids_ph;
+    SqlQueryBuilder::Placeholder<SqlIntArr> added_member_types_ph;
+    SqlQueryBuilder::Placeholder<SqlTimestamp> timestamp_ph;
+    SqlQueryBuilder::Placeholder<SqlLongArr> updated_user_ids_ph;
+    SqlQueryBuilder::Placeholder<SqlIntArr> updated_member_types_ph;
+    SqlQueryBuilder::Placeholder<SqlLongArr> removed_user_ids_ph;
+
+    query.QueryPiece("WITH added AS (INSERT INTO ")
+        .QueryPiece(TableNames::MessageChannelHasUser())
+        .QueryPiece("(channel_id,user_id,ownership,created_at,last_interaction_at)SELECT ")
+        .Holder(&channel_id_ph)
+        .QueryPiece(",delta.user_id,delta.ownership,")
+        .Holder(&timestamp_ph)
+        .QueryPiece("::TIMESTAMP,")
+        .Holder(&timestamp_ph)
+        .QueryPiece("::TIMESTAMP FROM UNNEST(")
+        .Holder(&added_user_ids_ph)
+        .QueryPiece("::BIGINT[],")
+        .Holder(&added_member_types_ph)
+        .QueryPiece("::INT[]) AS delta(user_id,ownership)")
+        .QueryPiece(" ON CONFLICT DO NOTHING RETURNING user_id),")
+        .QueryPiece(" updated AS (UPDATE ")
+        .QueryPiece(TableNames::MessageChannelHasUser())
+        .QueryPiece(" mchu SET ownership=delta.ownership FROM UNNEST(")
+        .Holder(&updated_user_ids_ph)
+        .QueryPiece("::BIGINT[],")
+        .Holder(&updated_member_types_ph)
+        .QueryPiece("::INT[]) AS delta(user_id,ownership)")
+        .QueryPiece(" WHERE mchu.channel_id=")
+        .Holder(&channel_id_ph)
+        .QueryPiece(" AND mchu.user_id=delta.user_id RETURNING mchu.user_id),")
+        .QueryPiece(" removed AS (DELETE FROM ")
+        .QueryPiece(TableNames::MessageChannelHasUser())
+        .QueryPiece(" WHERE channel_id=")
+        .Holder(&channel_id_ph)
+        .QueryPiece(" AND user_id=ANY(")
+        .Holder(&removed_user_ids_ph)
+        .QueryPiece(") RETURNING user_id) ")
+        .EndWithClause()
+        .QueryPiece("(SELECT (SELECT COUNT(*) FROM added) AS num_added,")
+        .QueryPiece(" (SELECT COUNT(*) FROM updated) AS num_updated,")
+        .QueryPiece(" (SELECT COUNT(*) FROM removed) AS num_removed) AS changes");
+
+    query.SetValueToPlaceholder(channel_id_ph, std::make_shared<SqlLong>(channel_id));
+    query.SetValueToPlaceholder(added_user_ids_ph, std::make_shared<SqlLongArr>(added_user_ids));
+    query.SetValueToPlaceholder(added_member_types_ph,
+                                std::make_shared<SqlIntArr>(added_member_types));
+    query.SetValueToPlaceholder(timestamp_ph,
+                                std::make_shared<SqlTimestamp>(CurrentTimestampMicros()));
+    query.SetValueToPlaceholder(updated_user_ids_ph,
+                                std::make_shared<SqlLongArr>(updated_user_ids));
+    query.SetValueToPlaceholder(updated_member_types_ph,
+                                std::make_shared<SqlIntArr>(updated_member_types));
+    query.SetValueToPlaceholder(removed_user_ids_ph, std::make_shared<SqlLongArr>(to_be_removed));
+
+    std::vector<std::tuple<NumMembershipChangesEntity>> query_result =
+        Query<NumMembershipChangesEntity>(query, {"changes"}, conns);
+    assert(query_result.size() == 1);
+
+    NumMembershipChangesEntity const &changes = std::get<0>(query_result[0]);
+    NumMembershipChanges result;
+    result.num_added = *changes.num_added.Value();
+    result.num_updated = *changes.num_updated.Value();
+    result.num_removed = *changes.num_removed.Value();
+    return result;
+}
+
 } // namespace e8
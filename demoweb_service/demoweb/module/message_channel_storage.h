@@ -18,8 +18,10 @@
 #ifndef MESSAGE_CHANNEL_STORAGE_H
 #define MESSAGE_CHANNEL_STORAGE_H
 
+#include <cstdint>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "demoweb_service/demoweb/common_entity/message_channel_entity.h"
 #include "demoweb_service/demoweb/common_entity/user_entity.h"
@@ -81,6 +83,35 @@ void UpdateMessageChannelMembership(MessageChannelId const channel_id, UserId co
 bool DeleteMessageChannelMembership(MessageChannelId const channel_id, UserId const user_id,
                                     ConnectionReservoirInterface *conns);
 
+/**
+ * @brief The NumMembershipChanges struct The number of memberships that have actually been added,
+ * updated and removed.
+ */
+struct NumMembershipChanges {
+    uint64_t num_added = 0;
+    uint64_t num_updated = 0;
+    uint64_t num_removed = 0;
+};
+
+/**
+ * @brief ApplyMessageChannelMembershipChanges Adds, updates and removes memberships of the
+ * specified message channel in bulk. All the changes are applied by one statement, so either all
+ * or none of them take effect, and it takes a single round trip regardless of the number of
+ * memberships involved. A membership to be added is skipped if it already exists, and so is a
+ * membership to be updated or removed if it doesn't exist.
+ *
+ * @param to_be_added New memberships to be created.
+ * @param to_be_updated Existing memberships whose member type is to be changed.
+ * @param to_be_removed IDs of the users whose memberships are to be deleted.
+ * @return The number of memberships that have been changed.
+ */
+NumMembershipChanges
+ApplyMessageChannelMembershipChanges(MessageChannelId const channel_id,
+                                     std::vector<MessageChannelMembership> const &to_be_added,
+                                     std::vector<MessageChannelMembership> const &to_be_updated,
+                                     std::vector<UserId> const &to_be_removed,
+                                     ConnectionReservoirInterface *conns);
+
 } // namespace e8
 
 #endif // MESSAGE_CHANNEL_STORAGE_H
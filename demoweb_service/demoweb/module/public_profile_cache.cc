@@ -0,0 +1,139 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "common/time_util/time_util.h"
+#include "demoweb_service/demoweb/common_entity/user_entity.h"
+#include "demoweb_service/demoweb/module/public_profile_cache.h"
+#include "proto_cc/user_profile.pb.h"
+
+namespace e8 {
+
+PublicProfileCache::PublicProfileCache(unsigned num_shards, unsigned max_num_profiles_per_shard,
+                                       TimestampMicros time_to_live)
+    : max_num_profiles_per_shard_(max_num_profiles_per_shard), time_to_live_(time_to_live) {
+    assert(num_shards > 0);
+    assert(max_num_profiles_per_shard > 0);
+
+    for (unsigned i = 0; i < num_shards; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+}
+
+std::optional<UserPublicProfile> PublicProfileCache::Fetch(UserEntity const &user) {
+    UserId user_id = *user.id.Value();
+    Shard *shard = this->ShardOf(user_id);
+
+    shard->mutex.lock();
+
+    auto it = shard->profiles.find(user_id);
+    if (it == shard->profiles.end()) {
+        ++shard->stats.num_misses;
+        shard->mutex.unlock();
+        return std::nullopt;
+    }
+
+    CachedProfile *cached = &it->second;
+    if (CurrentTimestampMicros() - cached->cached_at > time_to_live_ ||
+        cached->alias != user.alias.Value() || cached->avatar_path != user.avatar_path.Value() ||
+        cached->avatar_preview_path != user.avatar_preview_path.Value()) {
+        // Either the tokens are about to expire or the profile has been updated since.
+        shard->recency.erase(cached->recency_it);
+        shard->profiles.erase(it);
+        ++shard->stats.num_misses;
+        shard->mutex.unlock();
+        return std::nullopt;
+    }
+
+    shard->recency.splice(shard->recency.begin(), shard->recency, cached->recency_it);
+    ++shard->stats.num_hits;
+
+    UserPublicProfile profile = cached->profile;
+    shard->mutex.unlock();
+    return profile;
+}
+
+void PublicProfileCache::Put(UserEntity const &user, UserPublicProfile const &profile) {
+    UserId user_id = *user.id.Value();
+    Shard *shard = this->ShardOf(user_id);
+
+    shard->mutex.lock();
+
+    auto it = shard->profiles.find(user_id);
+    if (it != shard->profiles.end()) {
+        shard->recency.erase(it->second.recency_it);
+        shard->profiles.erase(it);
+    } else if (shard->profiles.size() == max_num_profiles_per_shard_) {
+        // Evict the least recently used profile.
+        shard->profiles.erase(shard->recency.back());
+        shard->recency.pop_back();
+        ++shard->stats.num_evictions;
+    }
+    assert(shard->profiles.size() < max_num_profiles_per_shard_);
+
+    shard->recency.push_front(user_id);
+
+    CachedProfile *cached = &shard->profiles[user_id];
+    cached->profile = profile;
+    cached->alias = user.alias.Value();
+    cached->avatar_path = user.avatar_path.Value();
+    cached->avatar_preview_path = user.avatar_preview_path.Value();
+    cached->cached_at = CurrentTimestampMicros();
+    cached->recency_it = shard->recency.begin();
+
+    shard->mutex.unlock();
+}
+
+void PublicProfileCache::Invalidate(UserId const user_id) {
+    Shard *shard = this->ShardOf(user_id);
+
+    shard->mutex.lock();
+
+    auto it = shard->profiles.find(user_id);
+    if (it != shard->profiles.end()) {
+        shard->recency.erase(it->second.recency_it);
+        shard->profiles.erase(it);
+    }
+
+    shard->mutex.unlock();
+}
+
+PublicProfileCache::Stats PublicProfileCache::GetStats() {
+    Stats total;
+    for (auto const &shard : shards_) {
+        shard->mutex.lock();
+        total.num_hits += shard->stats.num_hits;
+        total.num_misses += shard->stats.num_misses;
+        total.num_evictions += shard->stats.num_evictions;
+        shard->mutex.unlock();
+    }
+    return total;
+}
+
+PublicProfileCache::Shard *PublicProfileCache::ShardOf(UserId const user_id) {
+    // User IDs are byte-reversed timestamps whose bits are far from uniform, so mix them up first.
+    uint64_t mixed = static_cast<uint64_t>(user_id) * 0x9E3779B97F4A7C15ULL;
+    return shards_[(mixed >> 32) % shards_.size()].get();
+}
+
+} // namespace e8
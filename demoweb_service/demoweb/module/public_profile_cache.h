@@ -0,0 +1,121 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PUBLIC_PROFILE_CACHE_H
+#define PUBLIC_PROFILE_CACHE_H
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/time_util/time_util.h"
+#include "demoweb_service/demoweb/common_entity/user_entity.h"
+#include "proto_cc/user_profile.pb.h"
+
+namespace e8 {
+
+/**
+ * @brief The PublicProfileCache class Keeps the viewer-independent part of the recently built
+ * public profiles, i.e. everything except the user relations, so that building a profile doesn't
+ * need to sign the avatar access tokens again. The cache is split into shards by user ID, each of
+ * which has its own lock and evicts its least recently used profile when it's full.
+ *
+ * Each cached profile remembers the user entity fields it was built from. A cached profile is only
+ * served when these fields still agree with the user entity the caller has just loaded, so profile
+ * updates made through another process don't need an explicit invalidation. Profiles also expire
+ * after time_to_live so that the signed access tokens never go stale. This cache guarantees thread
+ * safety.
+ */
+class PublicProfileCache {
+  public:
+    /**
+     * @brief The Stats struct Cache effectiveness counters summed over all shards.
+     */
+    struct Stats {
+        uint64_t num_hits = 0;
+        uint64_t num_misses = 0;
+        uint64_t num_evictions = 0;
+    };
+
+    /**
+     * @brief PublicProfileCache Constructs an empty cache.
+     *
+     * @param num_shards The number of independently locked shards.
+     * @param max_num_profiles_per_shard The maximum number of profiles each shard can store.
+     * @param time_to_live Duration after which a cached profile has to be rebuilt.
+     */
+    PublicProfileCache(unsigned num_shards, unsigned max_num_profiles_per_shard,
+                       TimestampMicros time_to_live);
+    PublicProfileCache(PublicProfileCache const &) = delete;
+    ~PublicProfileCache() = default;
+
+    /**
+     * @brief Fetch Looks up the viewer-independent profile of the user.
+     *
+     * @param user The up-to-date user entity.
+     * @return The cached profile if it exists and was built from the same user entity fields.
+     * Otherwise, nullopt.
+     */
+    std::optional<UserPublicProfile> Fetch(UserEntity const &user);
+
+    /**
+     * @brief Put Caches the viewer-independent profile built from the user entity.
+     */
+    void Put(UserEntity const &user, UserPublicProfile const &profile);
+
+    /**
+     * @brief Invalidate Removes the profile of the specified user, if it exists.
+     */
+    void Invalidate(UserId const user_id);
+
+    /**
+     * @brief GetStats Returns a snapshot of the cache effectiveness counters.
+     */
+    Stats GetStats();
+
+  private:
+    struct CachedProfile {
+        UserPublicProfile profile;
+        std::optional<std::string> alias;
+        std::optional<std::string> avatar_path;
+        std::optional<std::string> avatar_preview_path;
+        TimestampMicros cached_at;
+        std::list<UserId>::iterator recency_it;
+    };
+
+    struct Shard {
+        std::unordered_map<UserId, CachedProfile> profiles;
+        std::list<UserId> recency;
+        Stats stats;
+        std::mutex mutex;
+    };
+
+    Shard *ShardOf(UserId const user_id);
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    unsigned max_num_profiles_per_shard_;
+    TimestampMicros time_to_live_;
+};
+
+} // namespace e8
+
+#endif // PUBLIC_PROFILE_CACHE_H
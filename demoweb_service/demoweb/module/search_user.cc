@@ -23,9 +23,11 @@
 #include <unordered_set>
 #include <vector>
 
+#include "common/thread/thread_pool.h"
 #include "demoweb_service/demoweb/common_entity/user_entity.h"
 #include "demoweb_service/demoweb/constant/demoweb_database.h"
 #include "demoweb_service/demoweb/module/search_user.h"
+#include "demoweb_service/demoweb/module/user_search_index.h"
 #include "postgres/query_runner/connection/connection_reservoir_interface.h"
 #include "postgres/query_runner/reflection/sql_primitives.h"
 #include "postgres/query_runner/sql_query_builder.h"
@@ -37,12 +39,25 @@ namespace e8 {
 std::vector<UserEntity> SearchUser(std::optional<UserId> const &viewer_id,
                                    std::optional<std::string> const &query_text,
                                    std::unordered_set<UserRelation> const &oneof_user_relations,
-                                   Pagination const &pagination,
+                                   Pagination const &pagination, UserSearchIndex *search_index,
                                    ConnectionReservoirInterface *db_conns) {
+    std::optional<std::unordered_set<UserId>> indexed_user_ids;
+    UserId loaded_user_id_bound = 0;
+    if (query_text.has_value() && search_index != nullptr) {
+        loaded_user_id_bound = search_index->LoadedUserIdBound();
+        indexed_user_ids = search_index->Search(*query_text);
+        if (indexed_user_ids.has_value() && indexed_user_ids->empty()) {
+            // The index only sees the users created or updated through this process, so the
+            // database has the final say on a miss.
+            indexed_user_ids = std::nullopt;
+        }
+    }
+
     SqlQueryBuilder query;
     query.QueryPiece(TableNames::AUser());
     query.QueryPiece(" u");
 
+    char const *conjunction = " WHERE ";
     if (viewer_id.has_value()) {
         SqlQueryBuilder::Placeholder<SqlInt> viewer_id_ph;
 
@@ -58,6 +73,7 @@ std::vector<UserEntity> SearchUser(std::optional<UserId> const &viewer_id,
             query.QueryPiece(" WHERE cr.relation=ANY(");
             query.Holder(&oneof_user_relations_ph);
             query.QueryPiece(")");
+            conjunction = " AND ";
 
             query.SetValueToPlaceholder(
                 oneof_user_relations_ph,
@@ -66,6 +82,20 @@ std::vector<UserEntity> SearchUser(std::optional<UserId> const &viewer_id,
         }
     }
 
+    if (indexed_user_ids.has_value()) {
+        // Users created through other hosts since the index was built are missing from the index,
+        // so they stay candidates as well. The text search below has the final say.
+        SqlQueryBuilder::Placeholder<SqlLongArr> user_ids_ph;
+        SqlQueryBuilder::Placeholder<SqlLong> loaded_user_id_bound_ph;
+        query.QueryPiece(conjunction).QueryPiece("(u.id=ANY(").Holder(&user_ids_ph);
+        query.QueryPiece(") OR u.id>").Holder(&loaded_user_id_bound_ph).QueryPiece(")");
+        query.SetValueToPlaceholder(
+            user_ids_ph, std::make_shared<SqlLongArr>(std::vector<int64_t>(
+                             indexed_user_ids->begin(), indexed_user_ids->end())));
+        query.SetValueToPlaceholder(loaded_user_id_bound_ph,
+                                    std::make_shared<SqlLong>(loaded_user_id_bound));
+    }
+
     if (viewer_id.has_value()) {
         query.QueryPiece(" ORDER BY cr.last_interaction_at DESC, u.alias ASC, u.id ASC");
     } else {
@@ -98,4 +128,51 @@ std::vector<UserEntity> SearchUser(std::optional<UserId> const &viewer_id,
     return results;
 }
 
+void BuildUserSearchIndex(unsigned batch_size, UserSearchIndex *search_index,
+                          ConnectionReservoirInterface *db_conns) {
+    assert(batch_size > 0);
+
+    search_index->BeginBuild();
+
+    std::optional<UserId> last_user_id;
+    while (true) {
+        SqlQueryBuilder query;
+        SqlQueryBuilder::Placeholder<SqlLong> last_user_id_ph;
+        SqlQueryBuilder::Placeholder<SqlInt> limit_ph;
+        query.QueryPiece(TableNames::AUser()).QueryPiece(" u");
+        if (last_user_id.has_value()) {
+            query.QueryPiece(" WHERE u.id>").Holder(&last_user_id_ph);
+            query.SetValueToPlaceholder(last_user_id_ph, std::make_shared<SqlLong>(*last_user_id));
+        }
+        query.QueryPiece(" ORDER BY u.id ASC LIMIT ").Holder(&limit_ph);
+        query.SetValueToPlaceholder(limit_ph, std::make_shared<SqlInt>(batch_size));
+
+        std::vector<std::tuple<UserEntity>> batch = Query<UserEntity>(query, {"u"}, db_conns);
+
+        std::vector<UserEntity> users(batch.size());
+        for (unsigned i = 0; i < batch.size(); i++) {
+            users[i] = std::get<0>(batch[i]);
+        }
+        search_index->Load(users);
+
+        if (batch.size() < batch_size) {
+            break;
+        }
+        last_user_id = *users.back().id.Value();
+    }
+
+    search_index->CompleteBuild();
+}
+
+BuildUserSearchIndexTask::BuildUserSearchIndexTask(unsigned batch_size,
+                                                   UserSearchIndex *search_index,
+                                                   ConnectionReservoirInterface *db_conns)
+    : batch_size_(batch_size), search_index_(search_index), db_conns_(db_conns) {}
+
+void BuildUserSearchIndexTask::Run(TaskStorageInterface * /*storage*/) const {
+    BuildUserSearchIndex(batch_size_, search_index_, db_conns_);
+}
+
+bool BuildUserSearchIndexTask::DropResourceOnCompletion() const { return true; }
+
 } // namespace e8
@@ -23,7 +23,9 @@
 #include <unordered_set>
 #include <vector>
 
+#include "common/thread/thread_pool.h"
 #include "demoweb_service/demoweb/common_entity/user_entity.h"
+#include "demoweb_service/demoweb/module/user_search_index.h"
 #include "postgres/query_runner/connection/connection_reservoir_interface.h"
 #include "proto_cc/pagination.pb.h"
 #include "proto_cc/user_relation.pb.h"
@@ -41,15 +43,45 @@ namespace e8 {
  * @param oneof_user_relations specifies that the result must contain at least one of these
  * directional relations from the viewer. If no viewer is provided, this filter is ignored.
  * @param pagination Pagination constraint.
+ * @param search_index Optional in-memory index to look the query text up. The index only narrows
+ * down the users the database text search goes through, to those it matches and those created
+ * since it was built. The search goes through every user when the index is absent, cold, the query
+ * is too broad or nobody in the index matches, since users updated through other hosts may be
+ * missing from the index.
  * @param db_conns Connections to the DemoWeb DB server.
  * @return The search result is a list of user entities.
  */
 std::vector<UserEntity> SearchUser(std::optional<UserId> const &viewer_id,
                                    std::optional<std::string> const &query_text,
                                    std::unordered_set<UserRelation> const &oneof_user_relations,
-                                   Pagination const &pagination,
+                                   Pagination const &pagination, UserSearchIndex *search_index,
                                    ConnectionReservoirInterface *db_conns);
 
+/**
+ * @brief BuildUserSearchIndex Loads every user into the search index in batches of batch_size
+ * users. The index is warm when it returns.
+ */
+void BuildUserSearchIndex(unsigned batch_size, UserSearchIndex *search_index,
+                          ConnectionReservoirInterface *db_conns);
+
+/**
+ * @brief The BuildUserSearchIndexTask class Builds the search index in the background so that the
+ * server can start answering searches from the database right away.
+ */
+class BuildUserSearchIndexTask : public TaskInterface {
+  public:
+    BuildUserSearchIndexTask(unsigned batch_size, UserSearchIndex *search_index,
+                             ConnectionReservoirInterface *db_conns);
+
+    void Run(TaskStorageInterface *storage) const override;
+    bool DropResourceOnCompletion() const override;
+
+  private:
+    unsigned batch_size_;
+    UserSearchIndex *search_index_;
+    ConnectionReservoirInterface *db_conns_;
+};
+
 } // namespace e8
 
 #endif // SEARCH_USER_H
@@ -31,7 +31,9 @@
 #include "demoweb_service/demoweb/module/file_metadata.h"
 #include "demoweb_service/demoweb/module/file_util.h"
 #include "demoweb_service/demoweb/module/contact_storage.h"
+#include "demoweb_service/demoweb/module/public_profile_cache.h"
 #include "demoweb_service/demoweb/module/user_profile.h"
+#include "demoweb_service/demoweb/module/user_search_index.h"
 #include "proto_cc/file.pb.h"
 #include "proto_cc/user_profile.pb.h"
 #include "proto_cc/user_relation.pb.h"
@@ -63,13 +65,11 @@ std::string AllocateNewAvatarLocation(std::string const &user_id_str, FileFormat
     return avatar_dir_path + std::to_string(counter) + "." + suffix.value();
 }
 
-UserPublicProfile BuildPublicProfile(UserEntity const &user, UserRelations const &relations,
-                                     KeyGeneratorInterface *key_gen) {
+UserPublicProfile BuildPublicProfile(UserEntity const &user, KeyGeneratorInterface *key_gen) {
     UserPublicProfile profile;
     profile.set_user_id(user.id.Value().value());
     assert(user.created_at.Value().has_value());
     profile.set_join_at(user.created_at.Value().value());
-    *profile.mutable_relations() = {relations.begin(), relations.end()};
 
     if (user.alias.Value().has_value()) {
         profile.mutable_alias()->set_value(user.alias.Value().value());
@@ -96,62 +96,105 @@ UserPublicProfile BuildPublicProfile(UserEntity const &user, UserRelations const
     return profile;
 }
 
+UserPublicProfile BuildPublicProfile(UserEntity const &user, KeyGeneratorInterface *key_gen,
+                                     PublicProfileCache *profile_cache) {
+    if (profile_cache == nullptr) {
+        return BuildPublicProfile(user, key_gen);
+    }
+
+    std::optional<UserPublicProfile> cached_profile = profile_cache->Fetch(user);
+    if (cached_profile.has_value()) {
+        return *cached_profile;
+    }
+
+    UserPublicProfile profile = BuildPublicProfile(user, key_gen);
+    profile_cache->Put(user, profile);
+    return profile;
+}
+
 } // namespace profile_internal
 
 bool UpdateProfile(std::optional<std::string> const &alias,
                    std::optional<std::string> const &biography, UserEntity *user,
+                   PublicProfileCache *profile_cache, UserSearchIndex *search_index,
                    ConnectionReservoirInterface *db_conns) {
     *user->alias.ValuePtr() = alias;
     *user->biography.ValuePtr() = biography;
 
     int num_rows_updated = Update(*user, TableNames::AUser(), /*override=*/true, db_conns);
+    if (profile_cache != nullptr) {
+        profile_cache->Invalidate(*user->id.Value());
+    }
     if (num_rows_updated == 0) {
         return false;
     }
 
     assert(num_rows_updated == 1);
 
+    if (search_index != nullptr) {
+        search_index->Put(*user);
+    }
+
     return true;
 }
 
 std::vector<UserPublicProfile> BuildPublicProfiles(std::optional<UserId> viewer_id,
                                                    std::vector<UserEntity> const &users,
                                                    KeyGeneratorInterface *key_gen,
+                                                   PublicProfileCache *profile_cache,
                                                    ConnectionReservoirInterface *db_conns) {
-    std::vector<UserId> target_user_ids;
+    std::vector<UserPublicProfile> profiles;
     for (auto const &user : users) {
-        target_user_ids.push_back(user.id.Value().value());
+        profiles.push_back(profile_internal::BuildPublicProfile(user, key_gen, profile_cache));
     }
 
-    std::vector<UserPublicProfile> profiles;
-
     if (viewer_id.has_value()) {
+        // User relations are viewer-specific, so they are merged in after the profiles are built.
+        std::vector<UserId> target_user_ids;
+        for (auto const &user : users) {
+            target_user_ids.push_back(user.id.Value().value());
+        }
+
         std::unordered_map<UserId, UserRelations> users_relations =
             GetUsersRelations(viewer_id.value(), target_user_ids, db_conns);
 
-        for (auto const &user : users) {
-            UserPublicProfile profile = profile_internal::BuildPublicProfile(
-                user, users_relations[user.id.Value().value()], key_gen);
-            profiles.push_back(profile);
-        }
-    } else {
-        for (auto const &user : users) {
-            UserPublicProfile profile =
-                profile_internal::BuildPublicProfile(user, UserRelations(), key_gen);
-            profiles.push_back(profile);
+        for (auto &profile : profiles) {
+            UserRelations const &relations = users_relations[profile.user_id()];
+            *profile.mutable_relations() = {relations.begin(), relations.end()};
         }
     }
 
     return profiles;
 }
 
+std::vector<UserPublicProfile>
+BuildPublicProfiles(std::vector<UserEntity> const &users,
+                    std::unordered_map<UserId, UserRelations> const &users_relations,
+                    KeyGeneratorInterface *key_gen, PublicProfileCache *profile_cache) {
+    std::vector<UserPublicProfile> profiles;
+    for (auto const &user : users) {
+        UserPublicProfile profile =
+            profile_internal::BuildPublicProfile(user, key_gen, profile_cache);
+
+        auto it = users_relations.find(profile.user_id());
+        if (it != users_relations.end()) {
+            *profile.mutable_relations() = {it->second.begin(), it->second.end()};
+        }
+
+        profiles.push_back(profile);
+    }
+    return profiles;
+}
+
 AvatarSetup SetUpNewProfileAvatar(UserEntity const &user, FileFormat file_format,
                                   KeyGeneratorInterface *key_gen,
+                                  PublicProfileCache *profile_cache,
                                   ConnectionReservoirInterface *db_conns) {
     std::string location = profile_internal::AllocateNewAvatarLocation(
         user.id_str.Value().value(), file_format, user.avatar_path.Value());
     std::optional<FileMetadataEntity> avatar_file =
-        AttachMetadataForFile(location, /*file_size=*/0, EncryptionSource::ESRC_NONE, db_conns);
+        AttachMetadataForFile(location, /*file_size=*/0, EncryptionSource::ESRC_NONE,
+                              /*content_hash=*/std::nullopt, db_conns);
     assert(avatar_file.has_value());
     assert(*avatar_file.value().path.Value() == location);
 
@@ -161,6 +204,10 @@ AvatarSetup SetUpNewProfileAvatar(UserEntity const &user, FileFormat file_format
     uint64_t num_rows = Update(updated_user, TableNames::AUser(), /*replace=*/true, db_conns);
     assert(num_rows == 1);
 
+    if (profile_cache != nullptr) {
+        profile_cache->Invalidate(*user.id.Value());
+    }
+
     // Sign an access token.
     FileAccessToken access_token = SignFileAccessToken(user.id.Value().value(), location,
                                                        FileAccessMode::FAM_READWRITE, key_gen);
@@ -20,10 +20,14 @@
 
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "demoweb_service/demoweb/common_entity/user_entity.h"
+#include "demoweb_service/demoweb/module/contact_storage.h"
 #include "demoweb_service/demoweb/module/file_access_validator.h"
+#include "demoweb_service/demoweb/module/public_profile_cache.h"
+#include "demoweb_service/demoweb/module/user_search_index.h"
 #include "proto_cc/file.pb.h"
 #include "proto_cc/user_profile.pb.h"
 #include "keygen/key_generator_interface.h"
@@ -39,12 +43,16 @@ namespace e8 {
  *
  * @param user Table entity of the user whose profile needs to be updated. The content of this
  * entity will be updated with the specified parameters after the function call.
+ * @param profile_cache Optional cache of public profiles from which the user's profile will be
+ * removed.
+ * @param search_index Optional user search index in which the user will be re-indexed.
  * @param db_conns Connections to the DemoWeb DB server.
  * @return If the user pointed to by the ID of the entity doesn't exist, it will return false.
  * Otherwise, it returns true.
  */
 bool UpdateProfile(std::optional<std::string> const &alias,
                    std::optional<std::string> const &biography, UserEntity *user,
+                   PublicProfileCache *profile_cache, UserSearchIndex *search_index,
                    ConnectionReservoirInterface *db_conns);
 
 /**
@@ -55,14 +63,30 @@ bool UpdateProfile(std::optional<std::string> const &alias,
  * provided, user relation will not be fetched.
  * @param users A list of user to extract public profile from.
  * @param key_gen Key generator for signing the avatar path.
+ * @param profile_cache Optional cache of the viewer-independent part of the public profiles. The
+ * user relations are always fetched and merged in afterwards.
  * @param db_conns Connections to the DemoWeb DB server.
  * @return The extracted public profile.
  */
 std::vector<UserPublicProfile> BuildPublicProfiles(std::optional<UserId> viewer_id,
                                                    std::vector<UserEntity> const &users,
                                                    KeyGeneratorInterface *key_gen,
+                                                   PublicProfileCache *profile_cache,
                                                    ConnectionReservoirInterface *db_conns);
 
+/**
+ * @brief BuildPublicProfiles Similar to the function above, but the viewer's relations towards
+ * the users have already been fetched, e.g. joined into the query which loaded the users, so it
+ * doesn't access the database.
+ *
+ * @param users_relations Relations of the viewer towards each user, keyed by the user's ID. Users
+ * absent from this map have no relation with the viewer.
+ */
+std::vector<UserPublicProfile>
+BuildPublicProfiles(std::vector<UserEntity> const &users,
+                    std::unordered_map<UserId, UserRelations> const &users_relations,
+                    KeyGeneratorInterface *key_gen, PublicProfileCache *profile_cache);
+
 /**
  * @brief The AvatarSetup struct Contains the user entity updated with the new avatar path and a
  * read/write file path access token for the newly assigned avatar path.
@@ -79,11 +103,14 @@ struct AvatarSetup {
  * @param user User to set avatar for.
  * @param file_format The format of the new avatar file.
  * @param key_gen Key generator for signing a new avatar path.
+ * @param profile_cache Optional cache of public profiles from which the user's profile will be
+ * removed.
  * @param db_conns Connections to the DemoWeb DB server.
  * @return See the above.
  */
 AvatarSetup SetUpNewProfileAvatar(UserEntity const &user, FileFormat file_format,
                                   KeyGeneratorInterface *key_gen,
+                                  PublicProfileCache *profile_cache,
                                   ConnectionReservoirInterface *db_conns);
 
 /**
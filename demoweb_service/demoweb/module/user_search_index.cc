@@ -0,0 +1,224 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "common/container/trie_map.h"
+#include "demoweb_service/demoweb/common_entity/user_entity.h"
+#include "demoweb_service/demoweb/module/user_search_index.h"
+
+namespace e8 {
+namespace {
+
+bool StartsWith(std::string const &word, std::string const &prefix) {
+    return word.compare(0, prefix.size(), prefix) == 0;
+}
+
+} // namespace
+
+UserSearchIndex::UserSearchIndex(unsigned max_num_candidates)
+    : max_num_candidates_(max_num_candidates) {}
+
+std::optional<std::unordered_set<UserId>> UserSearchIndex::Search(std::string const &query_text) {
+    std::vector<std::string> words = UserSearchIndex::Tokenize(query_text);
+
+    mutex_.lock();
+
+    if (!warm_) {
+        mutex_.unlock();
+        return std::nullopt;
+    }
+    if (words.empty()) {
+        mutex_.unlock();
+        return std::unordered_set<UserId>();
+    }
+
+    // Every word but the last has to be matched exactly.
+    std::optional<std::unordered_set<UserId>> candidates;
+    for (unsigned i = 0; i + 1 < words.size(); ++i) {
+        auto it = users_by_word_.find(words[i]);
+        if (it == users_by_word_.end()) {
+            mutex_.unlock();
+            return std::unordered_set<UserId>();
+        }
+
+        std::unordered_set<UserId> const &user_ids = (*it).second;
+        if (!candidates.has_value()) {
+            candidates = user_ids;
+            continue;
+        }
+        for (auto candidate_it = candidates->begin(); candidate_it != candidates->end();) {
+            if (user_ids.find(*candidate_it) == user_ids.end()) {
+                candidate_it = candidates->erase(candidate_it);
+            } else {
+                ++candidate_it;
+            }
+        }
+    }
+
+    std::unordered_set<UserId> matches;
+    std::string const &prefix = words.back();
+    if (candidates.has_value()) {
+        // The exact words have narrowed down the search, so check the prefix on each candidate.
+        for (UserId const user_id : *candidates) {
+            for (std::string const &word : words_by_user_[user_id]) {
+                if (StartsWith(word, prefix)) {
+                    matches.insert(user_id);
+                    break;
+                }
+            }
+        }
+    } else {
+        auto collect = [this, &matches](std::string const & /*word*/,
+                                        std::unordered_set<UserId> const &user_ids) {
+            matches.insert(user_ids.begin(), user_ids.end());
+            // Stops early once the query turns out to be too broad.
+            return matches.size() <= max_num_candidates_;
+        };
+        users_by_word_.visit_prefix(prefix, collect);
+    }
+
+    mutex_.unlock();
+
+    if (matches.size() > max_num_candidates_) {
+        return std::nullopt;
+    }
+    return matches;
+}
+
+void UserSearchIndex::Put(UserEntity const &user) {
+    mutex_.lock();
+
+    if (building_) {
+        put_during_build_.insert(*user.id.Value());
+    }
+    this->Index(user);
+
+    mutex_.unlock();
+}
+
+void UserSearchIndex::BeginBuild() {
+    mutex_.lock();
+
+    building_ = true;
+    put_during_build_.clear();
+
+    mutex_.unlock();
+}
+
+void UserSearchIndex::Load(std::vector<UserEntity> const &users) {
+    mutex_.lock();
+
+    for (auto const &user : users) {
+        loaded_user_id_bound_ = std::max(loaded_user_id_bound_, *user.id.Value());
+        if (put_during_build_.find(*user.id.Value()) != put_during_build_.end()) {
+            // The loaded user may be older than what has been put.
+            continue;
+        }
+        this->Index(user);
+    }
+
+    mutex_.unlock();
+}
+
+void UserSearchIndex::CompleteBuild() {
+    mutex_.lock();
+
+    building_ = false;
+    put_during_build_.clear();
+    warm_ = true;
+
+    mutex_.unlock();
+}
+
+bool UserSearchIndex::Warm() {
+    mutex_.lock();
+    bool warm = warm_;
+    mutex_.unlock();
+    return warm;
+}
+
+UserId UserSearchIndex::LoadedUserIdBound() {
+    mutex_.lock();
+    UserId bound = loaded_user_id_bound_;
+    mutex_.unlock();
+    return bound;
+}
+
+std::vector<std::string> UserSearchIndex::Tokenize(std::string const &text) {
+    std::vector<std::string> words;
+    std::string word;
+    for (char const c : text) {
+        unsigned char uc = static_cast<unsigned char>(c);
+        if (std::isalnum(uc) || uc >= 0x80) {
+            // Bytes of multi-byte UTF-8 characters are kept as part of the word.
+            word.push_back(static_cast<char>(std::tolower(uc)));
+        } else if (!word.empty()) {
+            words.push_back(word);
+            word.clear();
+        }
+    }
+    if (!word.empty()) {
+        words.push_back(word);
+    }
+    return words;
+}
+
+void UserSearchIndex::Index(UserEntity const &user) {
+    UserId user_id = *user.id.Value();
+
+    auto indexed_it = words_by_user_.find(user_id);
+    if (indexed_it != words_by_user_.end()) {
+        for (std::string const &word : indexed_it->second) {
+            auto it = users_by_word_.find(word);
+            (*it).second.erase(user_id);
+            if ((*it).second.empty()) {
+                users_by_word_.erase(it);
+            }
+        }
+    }
+
+    std::unordered_set<std::string> unique_words;
+    for (SqlStr const *field : {&user.id_str, &user.alias, &user.biography}) {
+        if (!field->Value().has_value()) {
+            continue;
+        }
+        for (std::string const &word : UserSearchIndex::Tokenize(*field->Value())) {
+            unique_words.insert(word);
+        }
+    }
+
+    for (std::string const &word : unique_words) {
+        auto it = users_by_word_.find(word);
+        if (it == users_by_word_.end()) {
+            users_by_word_.insert(std::make_pair(word, std::unordered_set<UserId>{user_id}));
+        } else {
+            (*it).second.insert(user_id);
+        }
+    }
+    words_by_user_[user_id] = std::vector<std::string>(unique_words.begin(), unique_words.end());
+}
+
+} // namespace e8
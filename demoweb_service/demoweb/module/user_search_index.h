@@ -0,0 +1,125 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef USER_SEARCH_INDEX_H
+#define USER_SEARCH_INDEX_H
+
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "common/container/trie_map.h"
+#include "demoweb_service/demoweb/common_entity/user_entity.h"
+
+namespace e8 {
+
+/**
+ * @brief The UserSearchIndex class An in-memory inverted index from the words of the user ID
+ * string, alias and biography to the users, so that a prefix search over users doesn't need a full
+ * text query to the database. The words are kept in a prefix tree so every word starting with the
+ * prefix the user is typing can be found without scanning the vocabulary.
+ *
+ * The index starts cold and only answers queries after it's loaded with every user through
+ * BeginBuild(), Load() and CompleteBuild(). Users created or updated in the meantime are written
+ * through by Put(), and Load() doesn't override them with a possibly older snapshot. Words are
+ * lowercased and split on punctuations but not stemmed, so it approximates rather than replicates
+ * the postgres text search. It only sees the updates made through this process, so its matches
+ * narrow down the candidates of a text search rather than replace it. This index guarantees thread
+ * safety.
+ */
+class UserSearchIndex {
+  public:
+    /**
+     * @brief UserSearchIndex Constructs a cold and empty index.
+     *
+     * @param max_num_candidates The maximum number of users a query may match. A broader query
+     * isn't answered by the index since it wouldn't narrow down the search much.
+     */
+    explicit UserSearchIndex(unsigned max_num_candidates);
+    UserSearchIndex(UserSearchIndex const &) = delete;
+    ~UserSearchIndex() = default;
+
+    /**
+     * @brief Search Finds the users matching every word of the query text, where the last word
+     * only needs to be a prefix, the same way as a prefix text search does.
+     *
+     * @return IDs of the matching users, in no particular order. It returns nullopt when the index
+     * is cold or the query matches more than max_num_candidates users.
+     */
+    std::optional<std::unordered_set<UserId>> Search(std::string const &query_text);
+
+    /**
+     * @brief Put Indexes the user or re-indexes it when it has been indexed. It has to be called
+     * after every user creation and update.
+     */
+    void Put(UserEntity const &user);
+
+    /**
+     * @brief BeginBuild Declares that the caller is about to load every user from the source of
+     * truth. It must be called before the load starts.
+     */
+    void BeginBuild();
+
+    /**
+     * @brief Load Indexes a batch of the loaded users except those that have been put since
+     * BeginBuild().
+     */
+    void Load(std::vector<UserEntity> const &users);
+
+    /**
+     * @brief CompleteBuild Declares that every user has been loaded so that the index can start
+     * answering queries.
+     */
+    void CompleteBuild();
+
+    /**
+     * @brief Warm Whether the index answers queries.
+     */
+    bool Warm();
+
+    /**
+     * @brief LoadedUserIdBound The largest user ID loaded by the builds so far, or zero if there
+     * is none. Users with a larger ID may have been created through other hosts since and be
+     * missing from the index.
+     */
+    UserId LoadedUserIdBound();
+
+    /**
+     * @brief Tokenize Splits the text into lowercased words.
+     */
+    static std::vector<std::string> Tokenize(std::string const &text);
+
+  private:
+    void Index(UserEntity const &user);
+
+    TrieMap<std::string, std::unordered_set<UserId>> users_by_word_;
+    std::unordered_map<UserId, std::vector<std::string>> words_by_user_;
+    std::unordered_set<UserId> put_during_build_;
+    bool building_ = false;
+    bool warm_ = false;
+    UserId loaded_user_id_bound_ = 0;
+    std::mutex mutex_;
+
+    unsigned max_num_candidates_;
+};
+
+} // namespace e8
+
+#endif // USER_SEARCH_INDEX_H
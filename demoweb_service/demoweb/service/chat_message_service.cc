@@ -68,8 +68,10 @@ grpc::Status ChatMessageServiceImpl::SendChatMessage(grpc::ServerContext *contex
         std::vector<std::string>(request->texts().begin(), request->texts().end()),
         IntsToEnums<FileFormat>(request->media_file_formats()),
         IntsToEnums<FileFormat>(request->binary_file_formats()),
-        DemoWebEnvironment()->MessageChannelPbac(), DemoWebEnvironment()->KeyGen(),
-        DemoWebEnvironment()->DemowebDatabase());
+        DemoWebEnvironment()->CurrentHostId(), DemoWebEnvironment()->ClientPushMessagePublishers(),
+        DemoWebEnvironment()->BackgroundTasks(), DemoWebEnvironment()->MessageChannelPbac(),
+        DemoWebEnvironment()->KeyGen(), DemoWebEnvironment()->RecentChatMessages(),
+        DemoWebEnvironment()->PublicProfiles(), DemoWebEnvironment()->DemowebDatabase());
     if (!result.has_value()) {
         return grpc::Status(grpc::StatusCode::PERMISSION_DENIED,
                             "You don't have enough privilege to send a chat message in the "
@@ -97,6 +99,7 @@ grpc::Status ChatMessageServiceImpl::GetChatMessages(grpc::ServerContext *contex
     std::vector<ChatMessageEntry> result = e8::GetChatMessages(
         identity->user_id(), request->thread_id(), request->pagination(),
         DemoWebEnvironment()->MessageChannelPbac(), DemoWebEnvironment()->KeyGen(),
+        DemoWebEnvironment()->RecentChatMessages(), DemoWebEnvironment()->PublicProfiles(),
         DemoWebEnvironment()->DemowebDatabase());
 
     *response->mutable_messages() = {result.begin(), result.end()};
@@ -117,7 +120,8 @@ ChatMessageServiceImpl::GetChatMessageThreads(grpc::ServerContext *context,
     std::vector<ChatMessageThread> result = GetChatMessageGroupsWithChatMessageSummaryList(
         identity->user_id(), request->channel_id(), request->limit_per_thread(),
         request->pagination(), DemoWebEnvironment()->MessageChannelPbac(),
-        DemoWebEnvironment()->KeyGen(), DemoWebEnvironment()->DemowebDatabase());
+        DemoWebEnvironment()->KeyGen(), DemoWebEnvironment()->PublicProfiles(),
+        DemoWebEnvironment()->DemowebDatabase());
 
     *response->mutable_threads() = {result.begin(), result.end()};
 
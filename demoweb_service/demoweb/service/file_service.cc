@@ -15,20 +15,128 @@
  * not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <cstdint>
 #include <grpcpp/grpcpp.h>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
 
+#include "demoweb_service/demoweb/environment/environment_context_interface.h"
+#include "demoweb_service/demoweb/module/file_io.h"
+#include "demoweb_service/demoweb/service/file_service.h"
+#include "demoweb_service/demoweb/service/service_util.h"
+#include "file_system/file_interface.h"
+#include "proto_cc/file.pb.h"
+#include "proto_cc/identity.pb.h"
 #include "proto_cc/service_file.grpc.pb.h"
 #include "proto_cc/service_file.pb.h"
-#include "demoweb_service/demoweb/service/file_service.h"
 
 namespace e8 {
 
 grpc::Status FileServiceImpl::Upload(grpc::ServerContext *context,
                                      grpc::ServerReader<UploadFileRequest> *reader,
-                                     UploadFileResponse *response) {}
+                                     UploadFileResponse *response) {
+    grpc::Status status;
+    std::optional<Identity> identity = ExtractIdentityFromContext(*context, &status);
+    if (!identity.has_value()) {
+        return status;
+    }
+
+    std::optional<std::string> file_path;
+    // Deletes the staging file on every return but a completed upload.
+    std::unique_ptr<FileUpload> upload;
+
+    UploadFileRequest request;
+    while (reader->Read(&request)) {
+        if (upload == nullptr) {
+            // The first request determines where the chunks go.
+            file_path = ResolveFileDescriptor(*identity, request.file_descriptor(), FAM_WRITE,
+                                              DemoWebEnvironment()->KeyGen(),
+                                              DemoWebEnvironment()->DemowebDatabase());
+            if (!file_path.has_value()) {
+                return grpc::Status(grpc::StatusCode::PERMISSION_DENIED,
+                                    "You don't have write access to the file.");
+            }
+
+            if (!request.content_hash().empty() &&
+                LinkKnownFileContent(*file_path, request.content_hash(),
+                                     DemoWebEnvironment()->FileStore(),
+                                     DemoWebEnvironment()->DemowebDatabase())
+                    .has_value()) {
+                // Skips the transfer.
+                response->set_deduplicated(true);
+                return grpc::Status::OK;
+            }
+
+            upload = BeginFileUpload(*file_path, DemoWebEnvironment()->FileStore());
+            if (upload == nullptr) {
+                return grpc::Status(grpc::StatusCode::INTERNAL, "Failed to create the file.");
+            }
+        }
+
+        if (!WriteFileChunk(request.current_chunk(), upload.get())) {
+            return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Invalid file chunk.");
+        }
+    }
+
+    if (upload == nullptr) {
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "No file chunk was uploaded.");
+    }
+
+    if (!CompleteFileUpload(*file_path, upload.get(), DemoWebEnvironment()->FileStore(),
+                            DemoWebEnvironment()->DemowebDatabase())
+             .has_value()) {
+        return grpc::Status(grpc::StatusCode::INTERNAL, "Failed to record the uploaded file.");
+    }
+
+    return grpc::Status::OK;
+}
 
 grpc::Status FileServiceImpl::Download(grpc::ServerContext *context,
                                        DownloadFileRequest const *request,
-                                       grpc::ServerWriter<DownloadFileResponse> *writer) {}
+                                       grpc::ServerWriter<DownloadFileResponse> *writer) {
+    grpc::Status status;
+    std::optional<Identity> identity = ExtractIdentityFromContext(*context, &status);
+    if (!identity.has_value()) {
+        return status;
+    }
+
+    std::optional<std::string> file_path = ResolveFileDescriptor(
+        *identity, request->file_descriptor(), FAM_READ, DemoWebEnvironment()->KeyGen(),
+        DemoWebEnvironment()->DemowebDatabase());
+    if (!file_path.has_value()) {
+        return grpc::Status(grpc::StatusCode::PERMISSION_DENIED,
+                            "You don't have read access to the file.");
+    }
+
+    std::unique_ptr<FileInterface> file = OpenStoredFile(
+        *file_path, DemoWebEnvironment()->FileStore(), DemoWebEnvironment()->DemowebDatabase());
+    if (file == nullptr) {
+        return grpc::Status(grpc::StatusCode::NOT_FOUND, "The file doesn't exist.");
+    }
+
+    // Chunks are copied straight out of the mapped file into the outgoing messages.
+    std::optional<std::string_view> content = file->Content();
+    if (!content.has_value()) {
+        return grpc::Status(grpc::StatusCode::INTERNAL, "Failed to read the file.");
+    }
+
+    DownloadFileResponse response;
+    *response.mutable_file_descriptor() = request->file_descriptor();
+    // An empty file still gets one empty chunk to carry the file descriptor.
+    int32_t num_chunks = std::max(NumFileChunks(content->size()), 1);
+    for (int32_t i = 0; i < num_chunks; ++i) {
+        ReadFileChunk(*content, i, response.mutable_current_chunk());
+        if (!writer->Write(response)) {
+            // The client has gone away.
+            return grpc::Status(grpc::StatusCode::CANCELLED, "The download was interrupted.");
+        }
+        response.clear_file_descriptor();
+    }
+
+    return grpc::Status::OK;
+}
 
 } // namespace e8
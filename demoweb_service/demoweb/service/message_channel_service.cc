@@ -146,9 +146,8 @@ MessageChannelServiceImpl::SearchMessageChannels(grpc::ServerContext *context,
         identity->user_id(), contains_member_ids, any_channel_ids, query_text,
         request->active_member_fetch_limit(), pagination, DemoWebEnvironment()->DemowebDatabase());
 
-    std::vector<MessageChannelOverview> results =
-        ToMessageChannelOverviews(identity->user_id(), channels, DemoWebEnvironment()->KeyGen(),
-                                  DemoWebEnvironment()->DemowebDatabase());
+    std::vector<MessageChannelOverview> results = ToMessageChannelOverviews(
+        channels, DemoWebEnvironment()->KeyGen(), DemoWebEnvironment()->PublicProfiles());
     *response->mutable_channels() = {results.begin(), results.end()};
 
     return grpc::Status::OK;
@@ -177,6 +176,7 @@ MessageChannelServiceImpl::GetMessageChannelMembers(grpc::ServerContext *context
     }
     std::vector<UserPublicProfile> profiles =
         BuildPublicProfiles(identity->user_id(), users, DemoWebEnvironment()->KeyGen(),
+                            DemoWebEnvironment()->PublicProfiles(),
                             DemoWebEnvironment()->DemowebDatabase());
     *response->mutable_user_profiles() = {profiles.begin(), profiles.end()};
 
@@ -73,7 +73,8 @@ grpc::Status SocialNetworkServiceImpl::SendInvitation(grpc::ServerContext *conte
     ::e8::SendInvitation(identity.value().user_id(), request->invitee_user_id(),
                          /*send_message_anyway=*/true, DemoWebEnvironment()->CurrentHostId(),
                          DemoWebEnvironment()->ClientPushMessagePublishers(),
-                         DemoWebEnvironment()->KeyGen(), DemoWebEnvironment()->DemowebDatabase());
+                         DemoWebEnvironment()->KeyGen(), DemoWebEnvironment()->PublicProfiles(),
+                         DemoWebEnvironment()->DemowebDatabase());
 
     return grpc::Status::OK;
 }
@@ -101,12 +102,12 @@ SocialNetworkServiceImpl::SearchRelatedUserList(grpc::ServerContext *context,
         request->has_search_terms() ? std::optional<std::string>(request->search_terms().value())
                                     : std::nullopt;
 
-    std::vector<UserEntity> related_users =
-        SearchUser(identity.value().user_id(), search_terms, relation_filter, request->pagination(),
-                   DemoWebEnvironment()->DemowebDatabase());
+    std::vector<UserEntity> related_users = SearchUser(
+        identity.value().user_id(), search_terms, relation_filter, request->pagination(),
+        DemoWebEnvironment()->SearchableUsers(), DemoWebEnvironment()->DemowebDatabase());
     std::vector<UserPublicProfile> related_profiles = BuildPublicProfiles(
         identity.value().user_id(), related_users, DemoWebEnvironment()->KeyGen(),
-        DemoWebEnvironment()->DemowebDatabase());
+        DemoWebEnvironment()->PublicProfiles(), DemoWebEnvironment()->DemowebDatabase());
 
     *response->mutable_user_profiles() = {related_profiles.begin(), related_profiles.end()};
 
@@ -126,6 +127,7 @@ grpc::Status SocialNetworkServiceImpl::ProcessInvitation(grpc::ServerContext *co
                                DemoWebEnvironment()->CurrentHostId(),
                                DemoWebEnvironment()->ClientPushMessagePublishers(),
                                DemoWebEnvironment()->KeyGen(),
+                               DemoWebEnvironment()->PublicProfiles(),
                                DemoWebEnvironment()->DemowebDatabase())) {
         return grpc::Status(grpc::StatusCode::FAILED_PRECONDITION, "Invitation does not exist.");
     }
@@ -51,6 +51,7 @@ grpc::Status UserServiceImpl::Register(grpc::ServerContext * /*context*/,
         return grpc::Status(grpc::StatusCode::INTERNAL,
                             "User ID conflicts when it shouldn't happen");
     }
+    DemoWebEnvironment()->SearchableUsers()->Put(*user);
 
     response->set_user_id(*user->id.Value());
     response->set_error_type(RegistrationResponse::RET_NoError);
@@ -98,10 +99,12 @@ grpc::Status UserServiceImpl::GetPublicProfile(grpc::ServerContext *context,
     if (identity.has_value()) {
         profiles = BuildPublicProfiles(identity.value().user_id(), {user.value()},
                                        DemoWebEnvironment()->KeyGen(),
+                                       DemoWebEnvironment()->PublicProfiles(),
                                        DemoWebEnvironment()->DemowebDatabase());
     } else {
         profiles = BuildPublicProfiles(std::optional<UserId>(), {user.value()},
                                        DemoWebEnvironment()->KeyGen(),
+                                       DemoWebEnvironment()->PublicProfiles(),
                                        DemoWebEnvironment()->DemowebDatabase());
     }
     assert(profiles.size() == 1);
@@ -131,10 +134,12 @@ grpc::Status UserServiceImpl::UpdatePublicProfile(grpc::ServerContext *context,
     std::optional<std::string> biography =
         request->has_biography() ? std::optional<std::string>(request->biography().value())
                                  : std::nullopt;
-    UpdateProfile(alias, biography, &user.value(), DemoWebEnvironment()->DemowebDatabase());
+    UpdateProfile(alias, biography, &user.value(), DemoWebEnvironment()->PublicProfiles(),
+                  DemoWebEnvironment()->SearchableUsers(), DemoWebEnvironment()->DemowebDatabase());
 
     std::vector<UserPublicProfile> profiles =
         BuildPublicProfiles(user_id, {user.value()}, DemoWebEnvironment()->KeyGen(),
+                            DemoWebEnvironment()->PublicProfiles(),
                             DemoWebEnvironment()->DemowebDatabase());
     assert(profiles.size() == 1);
     *response->mutable_profile() = profiles[0];
@@ -157,10 +162,12 @@ grpc::Status UserServiceImpl::Search(grpc::ServerContext *context, SearchUserReq
     std::vector<UserEntity> user_entities =
         SearchUser(identity->user_id(), request->query(),
                    /*oneof_user_relations=*/std::unordered_set<UserRelation>(),
-                   request->pagination(), DemoWebEnvironment()->DemowebDatabase());
+                   request->pagination(), DemoWebEnvironment()->SearchableUsers(),
+                   DemoWebEnvironment()->DemowebDatabase());
 
     std::vector<UserPublicProfile> profiles =
         BuildPublicProfiles(identity->user_id(), user_entities, DemoWebEnvironment()->KeyGen(),
+                            DemoWebEnvironment()->PublicProfiles(),
                             DemoWebEnvironment()->DemowebDatabase());
 
     *response->mutable_user_profiles() = {profiles.begin(), profiles.end()};
@@ -186,6 +193,7 @@ grpc::Status UserServiceImpl::PrepareNewAvatar(grpc::ServerContext *context,
 
     AvatarSetup setup =
         SetUpNewProfileAvatar(user.value(), request->file_format(), DemoWebEnvironment()->KeyGen(),
+                              DemoWebEnvironment()->PublicProfiles(),
                               DemoWebEnvironment()->DemowebDatabase());
     response->mutable_avatar_readwrite_access()->set_access_token(setup.avatar_path_access_token);
 
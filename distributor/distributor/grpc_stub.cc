@@ -15,7 +15,11 @@
  * not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <grpcpp/grpcpp.h>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
 #include "distributor/distributor/grpc_stub.h"
 #include "proto_cc/node.pb.h"
@@ -43,4 +47,28 @@ std::string NodeToTargetStr(NodeState const &target, int port) {
 }
 
 } // namespace grpc_stub_internal
+
+namespace {
+
+std::unordered_map<std::string, std::shared_ptr<grpc::Channel>> gSharedChannels;
+std::mutex gSharedChannelsLock;
+
+} // namespace
+
+std::shared_ptr<grpc::Channel> SharedGrpcChannel(NodeState const &target, int port) {
+    std::string target_str = grpc_stub_internal::NodeToTargetStr(target, port);
+
+    gSharedChannelsLock.lock();
+
+    std::shared_ptr<grpc::Channel> &channel = gSharedChannels[target_str];
+    if (channel == nullptr) {
+        channel = grpc::CreateChannel(target_str, grpc::InsecureChannelCredentials());
+    }
+    std::shared_ptr<grpc::Channel> shared = channel;
+
+    gSharedChannelsLock.unlock();
+
+    return shared;
+}
+
 } // namespace e8
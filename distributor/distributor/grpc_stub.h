@@ -31,6 +31,13 @@ std::string NodeToTargetStr(NodeState const &target, int port);
 
 } // namespace grpc_stub_internal
 
+/**
+ * @brief SharedGrpcChannel Returns the channel to the service given the host location and port
+ * number. The channel is created on the first request and shared by all the subsequent requests
+ * to the same target, so that the calls to a node are multiplexed over one connection.
+ */
+std::shared_ptr<grpc::Channel> SharedGrpcChannel(NodeState const &target, int port);
+
 /**
  * Create a grpc stub to the service given the host location and port number.
  */
@@ -39,6 +46,13 @@ std::string NodeToTargetStr(NodeState const &target, int port);
         grpc::CreateChannel(grpc_stub_internal::NodeToTargetStr(target__, port__),                 \
                             grpc::InsecureChannelCredentials())))
 
+/**
+ * Create a grpc stub to the service given the host location and port number. The stub uses the
+ * channel shared by the target.
+ */
+#define CREATE_SHARED_GRPC_STUB(service_type__, target__, port__)                                  \
+    (service_type__::NewStub(SharedGrpcChannel(target__, port__)))
+
 } // namespace e8
 
 #endif // GRPC_STUB_H
@@ -0,0 +1,124 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "common/unit_test_util/unit_test_util.h"
+#include "file_system/file_interface.h"
+#include "file_system/local_file_system.h"
+
+namespace {
+
+std::string TestRootPath() {
+    return (std::filesystem::temp_directory_path() / "e8_test_local_file_system").string();
+}
+
+} // namespace
+
+bool CreateWriteAndReadFileTest() {
+    std::filesystem::remove_all(TestRootPath());
+    e8::LocalFileSystem file_system(TestRootPath());
+
+    TEST_CONDITION(file_system.OpenFile("/user/1/avatar/1.png") == nullptr);
+    TEST_CONDITION(file_system.CreateFile("/user/1/avatar/1.png"));
+
+    std::unique_ptr<e8::FileInterface> file = file_system.OpenFile("/user/1/avatar/1.png");
+    TEST_CONDITION(file != nullptr);
+    TEST_CONDITION(file->Size() == 0UL);
+
+    std::optional<std::string_view> empty_content = file->Content();
+    TEST_CONDITION(empty_content.has_value());
+    TEST_CONDITION(empty_content->empty());
+
+    // Chunks may arrive out of order.
+    TEST_CONDITION(file->WriteAt(/*offset=*/4, "5678"));
+    TEST_CONDITION(file->WriteAt(/*offset=*/0, "1234"));
+    TEST_CONDITION(file->Size() == 8UL);
+
+    std::optional<std::string_view> content = file->Content();
+    TEST_CONDITION(content.has_value());
+    TEST_CONDITION(*content == "12345678");
+
+    // Re-creating the file truncates it.
+    file.reset();
+    TEST_CONDITION(file_system.CreateFile("/user/1/avatar/1.png"));
+    file = file_system.OpenFile("/user/1/avatar/1.png");
+    TEST_CONDITION(file != nullptr);
+    TEST_CONDITION(file->Size() == 0UL);
+
+    std::filesystem::remove_all(TestRootPath());
+
+    return true;
+}
+
+bool RejectEscapingPathTest() {
+    std::filesystem::remove_all(TestRootPath());
+    e8::LocalFileSystem file_system(TestRootPath());
+
+    TEST_CONDITION(!file_system.CreateFile("/user/../../escaped.png"));
+    TEST_CONDITION(file_system.OpenFile("/user/../../escaped.png") == nullptr);
+
+    std::filesystem::remove_all(TestRootPath());
+
+    return true;
+}
+
+bool RenameAndDeleteFileTest() {
+    std::filesystem::remove_all(TestRootPath());
+    e8::LocalFileSystem file_system(TestRootPath());
+
+    TEST_CONDITION(file_system.CreateFile("/staging/1.png"));
+    std::unique_ptr<e8::FileInterface> file = file_system.OpenFile("/staging/1.png");
+    TEST_CONDITION(file != nullptr);
+    TEST_CONDITION(file->WriteAt(/*offset=*/0, "1234"));
+
+    // The destination directory is created on demand.
+    TEST_CONDITION(file_system.RenameFile("/staging/1.png", "/blob/ab/abcd"));
+    TEST_CONDITION(file_system.OpenFile("/staging/1.png") == nullptr);
+
+    // The opened handle follows the file.
+    std::optional<std::string_view> content = file->Content();
+    TEST_CONDITION(content.has_value());
+    TEST_CONDITION(*content == "1234");
+
+    std::unique_ptr<e8::FileInterface> renamed = file_system.OpenFile("/blob/ab/abcd");
+    TEST_CONDITION(renamed != nullptr);
+    TEST_CONDITION(renamed->Size() == 4UL);
+
+    TEST_CONDITION(file_system.DeleteFile("/blob/ab/abcd"));
+    TEST_CONDITION(!file_system.DeleteFile("/blob/ab/abcd"));
+    TEST_CONDITION(file_system.OpenFile("/blob/ab/abcd") == nullptr);
+
+    TEST_CONDITION(!file_system.RenameFile("/staging/1.png", "/user/../../escaped.png"));
+
+    std::filesystem::remove_all(TestRootPath());
+
+    return true;
+}
+
+int main() {
+    e8::BeginTestSuite("local_file_system");
+    e8::RunTest("CreateWriteAndReadFileTest", CreateWriteAndReadFileTest);
+    e8::RunTest("RejectEscapingPathTest", RejectEscapingPathTest);
+    e8::RunTest("RenameAndDeleteFileTest", RenameAndDeleteFileTest);
+    e8::EndTestSuite();
+    return 0;
+}
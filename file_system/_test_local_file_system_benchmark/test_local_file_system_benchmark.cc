@@ -0,0 +1,88 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common/time_util/time_util.h"
+#include "common/unit_test_util/unit_test_util.h"
+#include "file_system/file_interface.h"
+#include "file_system/local_file_system.h"
+
+namespace {
+
+std::string TestRootPath() {
+    return (std::filesystem::temp_directory_path() / "e8_local_file_system_benchmark").string();
+}
+
+} // namespace
+
+bool ChunkedTransferThroughputTest() {
+    std::filesystem::remove_all(TestRootPath());
+    e8::LocalFileSystem file_system(TestRootPath());
+
+    uint64_t const kChunkSize = 256 * 1024;
+    std::vector<uint64_t> const file_sizes{1024, 1024 * 1024, 10 * 1024 * 1024,
+                                           100 * 1024 * 1024};
+
+    for (uint64_t file_size : file_sizes) {
+        std::string const chunk(std::min(kChunkSize, file_size), 'x');
+
+        e8::TimestampMicros begin = e8::CurrentTimestampMicros();
+        TEST_CONDITION(file_system.CreateFile("/blob"));
+        std::unique_ptr<e8::FileInterface> file = file_system.OpenFile("/blob");
+        TEST_CONDITION(file != nullptr);
+        for (uint64_t offset = 0; offset < file_size; offset += chunk.size()) {
+            TEST_CONDITION(file->WriteAt(offset, chunk));
+        }
+        e8::TimestampMicros upload_duration = e8::CurrentTimestampMicros() - begin;
+
+        begin = e8::CurrentTimestampMicros();
+        std::optional<std::string_view> content = file->Content();
+        TEST_CONDITION(content.has_value());
+        TEST_CONDITION(content->size() == file_size);
+        uint64_t num_downloaded = 0;
+        for (uint64_t offset = 0; offset < content->size(); offset += kChunkSize) {
+            // Each chunk is copied once into the outgoing message.
+            std::string chunk_data(content->substr(offset, kChunkSize));
+            num_downloaded += chunk_data.size();
+        }
+        e8::TimestampMicros download_duration = e8::CurrentTimestampMicros() - begin;
+        TEST_CONDITION(num_downloaded == file_size);
+
+        std::cout << "file_size=" << file_size << "B upload=" << upload_duration
+                  << "us download=" << download_duration << "us" << std::endl;
+    }
+
+    std::filesystem::remove_all(TestRootPath());
+
+    return true;
+}
+
+int main() {
+    e8::BeginTestSuite("local_file_system_benchmark");
+    e8::RunTest("ChunkedTransferThroughputTest", ChunkedTransferThroughputTest);
+    e8::EndTestSuite();
+    return 0;
+}
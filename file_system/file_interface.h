@@ -18,15 +18,44 @@
 #ifndef FILE_INTERFACE_H
 #define FILE_INTERFACE_H
 
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
 namespace e8 {
 
 /**
- * @brief The FileInterface class
+ * @brief The FileInterface class Handle to an opened file.
  */
 class FileInterface {
   public:
     FileInterface() = default;
     virtual ~FileInterface() = default;
+
+    /**
+     * @brief Size Returns the current size of the file in bytes.
+     *
+     * @return The file size if it can be determined.
+     */
+    virtual std::optional<uint64_t> Size() = 0;
+
+    /**
+     * @brief WriteAt Writes the data to the file starting at the specified byte offset. The file
+     * is extended if the data goes beyond the end of the file. Writes to disjoint ranges can be
+     * issued in any order.
+     *
+     * @return true if all the data has been written.
+     */
+    virtual bool WriteAt(uint64_t offset, std::string const &data) = 0;
+
+    /**
+     * @brief Content Maps the whole file into memory for reading without copying it into a user
+     * space buffer. The returned view stays valid until the file handle is destroyed.
+     *
+     * @return The content of the file if it can be mapped.
+     */
+    virtual std::optional<std::string_view> Content() = 0;
 };
 
 } // namespace e8
@@ -45,9 +45,25 @@ class FileSystemInterface {
      * Opens the file at the specified location.
      *
      * @param file_path Location of the file to open.
-     * @return The file handle pointing to the opened file.
+     * @return The file handle pointing to the opened file, or nullptr if the file can't be
+     * opened.
      */
     virtual std::unique_ptr<FileInterface> OpenFile(std::string const &file_path) = 0;
+
+    /**
+     * Moves the file to the destination path. It overrides the file at the destination if it has
+     * already existed. Handles opened on the source file stay valid.
+     *
+     * @return true if no error occurred.
+     */
+    virtual bool RenameFile(std::string const &source_path, std::string const &dest_path) = 0;
+
+    /**
+     * Removes the file at the specified location. Handles opened on the file stay valid.
+     *
+     * @return true if the file existed and has been removed.
+     */
+    virtual bool DeleteFile(std::string const &file_path) = 0;
 };
 
 } // namespace e8
@@ -1,5 +1,7 @@
 TEMPLATE = subdirs
 SUBDIRS = \
-    filesystem.pro
+    filesystem.pro \
+    _test_local_file_system/_test_local_file_system.pro \
+    _test_local_file_system_benchmark/_test_local_file_system_benchmark.pro
 
 CONFIG += ordered
@@ -0,0 +1,191 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <fcntl.h>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "file_system/file_interface.h"
+#include "file_system/local_file_system.h"
+
+namespace e8 {
+namespace {
+
+class LocalFile : public FileInterface {
+  public:
+    explicit LocalFile(int fd);
+    ~LocalFile() override;
+
+    std::optional<uint64_t> Size() override;
+    bool WriteAt(uint64_t offset, std::string const &data) override;
+    std::optional<std::string_view> Content() override;
+
+  private:
+    void Unmap();
+
+    int fd_;
+    void *mapped_ = nullptr;
+    uint64_t mapped_size_ = 0;
+};
+
+LocalFile::LocalFile(int fd) : fd_(fd) {}
+
+LocalFile::~LocalFile() {
+    this->Unmap();
+    close(fd_);
+}
+
+std::optional<uint64_t> LocalFile::Size() {
+    struct stat file_stat;
+    if (fstat(fd_, &file_stat) != 0) {
+        return std::nullopt;
+    }
+    return static_cast<uint64_t>(file_stat.st_size);
+}
+
+bool LocalFile::WriteAt(uint64_t offset, std::string const &data) {
+    uint64_t num_written = 0;
+    while (num_written < data.size()) {
+        ssize_t rc = pwrite(fd_, data.data() + num_written, data.size() - num_written,
+                            static_cast<off_t>(offset + num_written));
+        if (rc < 0) {
+            return false;
+        }
+        num_written += static_cast<uint64_t>(rc);
+    }
+    return true;
+}
+
+std::optional<std::string_view> LocalFile::Content() {
+    std::optional<uint64_t> size = this->Size();
+    if (!size.has_value()) {
+        return std::nullopt;
+    }
+    if (*size == 0) {
+        // Empty files can't be mapped.
+        return std::string_view();
+    }
+    if (mapped_ != nullptr && mapped_size_ == *size) {
+        return std::string_view(static_cast<char const *>(mapped_), mapped_size_);
+    }
+
+    this->Unmap();
+    void *mapped = mmap(/*addr=*/nullptr, *size, PROT_READ, MAP_SHARED, fd_, /*offset=*/0);
+    if (mapped == MAP_FAILED) {
+        return std::nullopt;
+    }
+    // Content is served front to back.
+    madvise(mapped, *size, MADV_SEQUENTIAL);
+
+    mapped_ = mapped;
+    mapped_size_ = *size;
+    return std::string_view(static_cast<char const *>(mapped_), mapped_size_);
+}
+
+void LocalFile::Unmap() {
+    if (mapped_ != nullptr) {
+        munmap(mapped_, mapped_size_);
+        mapped_ = nullptr;
+        mapped_size_ = 0;
+    }
+}
+
+} // namespace
+
+LocalFileSystem::LocalFileSystem(std::string const &root_path) : root_path_(root_path) {
+    std::filesystem::create_directories(root_path_);
+}
+
+bool LocalFileSystem::CreateFile(std::string const &file_path) {
+    std::optional<std::string> local_path = this->ToLocalPath(file_path);
+    if (!local_path.has_value()) {
+        return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(*local_path).parent_path(), ec);
+    if (ec) {
+        return false;
+    }
+
+    int fd = open(local_path->c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    close(fd);
+
+    return true;
+}
+
+std::unique_ptr<FileInterface> LocalFileSystem::OpenFile(std::string const &file_path) {
+    std::optional<std::string> local_path = this->ToLocalPath(file_path);
+    if (!local_path.has_value()) {
+        return nullptr;
+    }
+
+    int fd = open(local_path->c_str(), O_RDWR);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    return std::make_unique<LocalFile>(fd);
+}
+
+bool LocalFileSystem::RenameFile(std::string const &source_path, std::string const &dest_path) {
+    std::optional<std::string> local_source_path = this->ToLocalPath(source_path);
+    std::optional<std::string> local_dest_path = this->ToLocalPath(dest_path);
+    if (!local_source_path.has_value() || !local_dest_path.has_value()) {
+        return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(*local_dest_path).parent_path(), ec);
+    if (ec) {
+        return false;
+    }
+
+    return rename(local_source_path->c_str(), local_dest_path->c_str()) == 0;
+}
+
+bool LocalFileSystem::DeleteFile(std::string const &file_path) {
+    std::optional<std::string> local_path = this->ToLocalPath(file_path);
+    if (!local_path.has_value()) {
+        return false;
+    }
+    return unlink(local_path->c_str()) == 0;
+}
+
+std::optional<std::string> LocalFileSystem::ToLocalPath(std::string const &file_path) const {
+    std::filesystem::path path(file_path);
+    for (auto const &component : path) {
+        if (component == "..") {
+            // Escapes from the root directory.
+            return std::nullopt;
+        }
+    }
+    return (std::filesystem::path(root_path_) / path.relative_path()).string();
+}
+
+} // namespace e8
@@ -0,0 +1,177 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "common/unit_test_util/unit_test_util.h"
+#include "gomoku/agent/heuristics/batching_evaluator.h"
+#include "gomoku/agent/heuristics/evaluator.h"
+#include "gomoku/game/board_state.h"
+
+namespace {
+
+/**
+ * @brief The RecordingEvaluator class Derives the evaluation from the state ID and records whether
+ * it has ever been called concurrently.
+ */
+class RecordingEvaluator : public e8::GomokuEvaluatorInterface {
+  public:
+    float EvaluateReward(e8::GomokuBoardState const & /*state*/,
+                         std::optional<e8::MctNodeId> /*parent_state_id*/,
+                         e8::MctNodeId state_id) override {
+        this->Enter();
+        float reward = static_cast<float>(state_id % 1000) / 1000;
+        this->Leave();
+        return reward;
+    }
+
+    std::unordered_map<e8::GomokuActionId, float>
+    EvaluatePolicy(e8::GomokuBoardState const & /*state*/,
+                   std::optional<e8::MctNodeId> /*parent_state_id*/,
+                   e8::MctNodeId state_id) override {
+        this->Enter();
+        std::unordered_map<e8::GomokuActionId, float> policy{
+            {static_cast<e8::GomokuActionId>(state_id % 100), 1.0f}};
+        this->Leave();
+        return policy;
+    }
+
+    std::vector<e8::GomokuEvaluation>
+    EvaluateBatch(std::vector<e8::GomokuEvaluationRequest> const &requests) override {
+        ++num_batch_calls;
+        return GomokuEvaluatorInterface::EvaluateBatch(requests);
+    }
+
+    float ExplorationFactor() const override { return 1; }
+
+    unsigned NumSimulations() const override { return 100; }
+
+    void ClearCache() override {}
+
+    std::atomic<unsigned> num_batch_calls = 0;
+    std::atomic<bool> called_concurrently = false;
+
+  private:
+    void Enter() {
+        if (in_use_.exchange(true)) {
+            called_concurrently = true;
+        }
+        // Widens the window for overlapping calls.
+        std::this_thread::sleep_for(std::chrono::microseconds(10));
+    }
+
+    void Leave() { in_use_ = false; }
+
+    std::atomic<bool> in_use_ = false;
+};
+
+bool MergeTest() {
+    auto evaluator = std::make_shared<RecordingEvaluator>();
+    e8::GomokuBatchingEvaluator batching_evaluator(evaluator, /*max_batch_size=*/32,
+                                                   /*max_delay=*/100'000);
+
+    unsigned const num_searchers = 8;
+    unsigned const num_calls = 50;
+    unsigned const batch_size = 4;
+
+    std::atomic<bool> correct = true;
+    std::vector<std::thread> searchers;
+    for (unsigned i = 0; i < num_searchers; ++i) {
+        searchers.emplace_back([&batching_evaluator, &correct, i]() {
+            e8::GomokuBoardState state(/*width=*/11, /*height=*/11);
+            for (unsigned j = 0; j < num_calls; ++j) {
+                std::vector<e8::GomokuEvaluationRequest> requests;
+                for (unsigned k = 0; k < batch_size; ++k) {
+                    e8::MctNodeId state_id = (i * num_calls + j) * batch_size + k;
+                    requests.push_back(e8::GomokuEvaluationRequest{
+                        &state, /*parent_state_id=*/std::nullopt, state_id,
+                        /*reward_needed=*/true});
+                }
+
+                std::vector<e8::GomokuEvaluation> evaluations =
+                    batching_evaluator.EvaluateBatch(requests);
+                if (evaluations.size() != requests.size()) {
+                    correct = false;
+                    continue;
+                }
+                for (unsigned k = 0; k < batch_size; ++k) {
+                    e8::MctNodeId state_id = requests[k].state_id;
+                    if (evaluations[k].reward != static_cast<float>(state_id % 1000) / 1000 ||
+                        evaluations[k].policy.size() != 1 ||
+                        evaluations[k].policy.begin()->first != state_id % 100) {
+                        correct = false;
+                    }
+                }
+            }
+        });
+    }
+    for (std::thread &searcher : searchers) {
+        searcher.join();
+    }
+
+    e8::GomokuBatchingEvaluator::Stats stats = batching_evaluator.GetStats();
+    TEST_CONDITION(correct);
+    TEST_CONDITION(!evaluator->called_concurrently);
+    TEST_CONDITION(stats.num_calls == num_searchers * num_calls);
+    TEST_CONDITION(stats.num_requests == num_searchers * num_calls * batch_size);
+    TEST_CONDITION(stats.num_batches == evaluator->num_batch_calls);
+
+    // Every searcher has a call queued most of the time, so the batches are full.
+    TEST_CONDITION(stats.MeanBatchSize() > 2 * batch_size);
+
+    return true;
+}
+
+bool DelayTest() {
+    auto evaluator = std::make_shared<RecordingEvaluator>();
+    e8::GomokuBatchingEvaluator batching_evaluator(evaluator, /*max_batch_size=*/64,
+                                                   /*max_delay=*/5'000);
+
+    e8::GomokuBoardState state(/*width=*/11, /*height=*/11);
+    std::vector<e8::GomokuEvaluationRequest> requests{e8::GomokuEvaluationRequest{
+        &state, /*parent_state_id=*/std::nullopt, /*state_id=*/42, /*reward_needed=*/false}};
+
+    // The queue never fills up with a single searcher.
+    auto start = std::chrono::steady_clock::now();
+    std::vector<e8::GomokuEvaluation> evaluations = batching_evaluator.EvaluateBatch(requests);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    TEST_CONDITION(evaluations.size() == 1);
+    TEST_CONDITION(evaluations[0].policy.begin()->first == 42);
+    TEST_CONDITION(elapsed >= std::chrono::microseconds(5'000));
+    TEST_CONDITION(elapsed < std::chrono::seconds(1));
+    TEST_CONDITION(batching_evaluator.GetStats().num_batches == 1);
+
+    return true;
+}
+
+} // namespace
+
+int main() {
+    e8::BeginTestSuite("batching_evaluator");
+    e8::RunTest("MergeTest", MergeTest);
+    e8::RunTest("DelayTest", DelayTest);
+    e8::EndTestSuite();
+    return 0;
+}
@@ -0,0 +1,190 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "common/unit_test_util/unit_test_util.h"
+#include "gomoku/agent/heuristics/batching_evaluator.h"
+#include "gomoku/agent/heuristics/evaluator.h"
+#include "gomoku/agent/mcts_agent_player.h"
+#include "gomoku/agent/search/mct_search.h"
+#include "gomoku/game/board_state.h"
+#include "gomoku/game/game.h"
+#include "gomoku/game/game_instance_container.h"
+
+namespace {
+
+/**
+ * @brief The InferenceCostEvaluator class Simulates a neural network evaluator running on an
+ * accelerator, where a batch costs a fixed launch overhead plus a little per state. The policy is
+ * uniform over the empty cells next to a stone and the reward is a hash of the position.
+ */
+class InferenceCostEvaluator : public e8::GomokuEvaluatorInterface {
+  public:
+    float EvaluateReward(e8::GomokuBoardState const &state,
+                         std::optional<e8::MctNodeId> /*parent_state_id*/,
+                         e8::MctNodeId /*state_id*/) override {
+        uint64_t mixed = state.Hash() * 0x9e3779b97f4a7c15ULL;
+        return static_cast<float>(mixed >> 40) / (1 << 24) - 0.5f;
+    }
+
+    std::unordered_map<e8::GomokuActionId, float>
+    EvaluatePolicy(e8::GomokuBoardState const &state,
+                   std::optional<e8::MctNodeId> /*parent_state_id*/,
+                   e8::MctNodeId /*state_id*/) override {
+        std::vector<e8::GomokuActionId> candidates;
+        for (auto const &[action_id, action] : state.LegalActions()) {
+            if (!action.stone_pos.has_value() || NextToStone(state, *action.stone_pos)) {
+                candidates.push_back(action_id);
+            }
+        }
+
+        std::unordered_map<e8::GomokuActionId, float> policy;
+        for (e8::GomokuActionId action_id : candidates) {
+            policy[action_id] = 1.0f / candidates.size();
+        }
+        return policy;
+    }
+
+    std::vector<e8::GomokuEvaluation>
+    EvaluateBatch(std::vector<e8::GomokuEvaluationRequest> const &requests) override {
+        std::this_thread::sleep_for(std::chrono::microseconds(kLaunchMicros) +
+                                    std::chrono::microseconds(kPerStateMicros) * requests.size());
+        return GomokuEvaluatorInterface::EvaluateBatch(requests);
+    }
+
+    unsigned EvaluationBatchSize() const override { return 8; }
+
+    float ExplorationFactor() const override { return 2; }
+
+    unsigned NumSimulations() const override { return 64; }
+
+    void ClearCache() override {}
+
+  private:
+    static unsigned const kLaunchMicros = 1000;
+    static unsigned const kPerStateMicros = 2;
+
+    static bool NextToStone(e8::GomokuBoardState const &state, e8::MovePosition const &pos) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                int x = pos.x + dx;
+                int y = pos.y + dy;
+                if (x >= 0 && x < state.Width() && y >= 0 && y < state.Height() &&
+                    *state.ChessPieceStateAt(e8::MovePosition(x, y)) != e8::ST_NONE) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+};
+
+/**
+ * @brief The SinglePlayAgentPlayer class Plays one game only.
+ */
+class SinglePlayAgentPlayer : public e8::MctsAgentPlayer {
+  public:
+    using MctsAgentPlayer::MctsAgentPlayer;
+
+    bool WantAnotherGame() override { return false; }
+};
+
+struct FarmResult {
+    double games_per_hour;
+    float mean_batch_size;
+};
+
+/**
+ * @brief RunSelfPlayFarm Plays num_games self-play games at the same time, each with its own
+ * searcher, all sharing one batching evaluator.
+ */
+FarmResult RunSelfPlayFarm(unsigned num_games) {
+    auto evaluator = std::make_shared<InferenceCostEvaluator>();
+    auto batching_evaluator = std::make_shared<e8::GomokuBatchingEvaluator>(
+        evaluator, num_games * evaluator->EvaluationBatchSize(), /*max_delay=*/2000);
+
+    e8::GameInstanceContainer container(num_games);
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<e8::GameInstanceContainer::ScheduleId> schedule_ids;
+    for (unsigned i = 0; i < num_games; ++i) {
+        auto searcher = std::make_shared<e8::MctSearcher>(batching_evaluator,
+                                                          /*print_stats=*/false);
+        auto game = std::make_unique<e8::GomokuGame>(
+            std::make_shared<SinglePlayAgentPlayer>(e8::PS_PLAYER_A, searcher,
+                                                    /*shared_searcher=*/true),
+            std::make_shared<SinglePlayAgentPlayer>(e8::PS_PLAYER_B, searcher,
+                                                    /*shared_searcher=*/true));
+
+        e8::GameInstanceContainer::ScheduleId schedule_id;
+        do {
+            schedule_id = e8::AllocateGameInstanceContainerScheduleId();
+        } while (!schedule_ids.empty() && schedule_id <= schedule_ids.back());
+        schedule_ids.push_back(schedule_id);
+
+        container.ScheduleToRun(schedule_id, std::move(game));
+    }
+
+    for (e8::GameInstanceContainer::ScheduleId schedule_id : schedule_ids) {
+        while (container.ScheduledGame(schedule_id) != nullptr) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
+    double elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return FarmResult{num_games * 3600 / elapsed, batching_evaluator->GetStats().MeanBatchSize()};
+}
+
+bool SelfPlayFarmTest() {
+    std::cout << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+
+    std::optional<double> single_game_throughput;
+    for (unsigned num_games : {1, 4, 16, 64}) {
+        FarmResult result = RunSelfPlayFarm(num_games);
+        std::cout << std::fixed << std::setprecision(1) << num_games
+                  << " concurrent games: " << result.games_per_hour
+                  << " games/hour mean_batch_size=" << result.mean_batch_size << std::endl;
+
+        if (!single_game_throughput.has_value()) {
+            single_game_throughput = result.games_per_hour;
+        } else {
+            TEST_CONDITION(result.games_per_hour > *single_game_throughput);
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+int main() {
+    e8::BeginTestSuite("batching_evaluator_benchmark");
+    e8::RunTest("SelfPlayFarmTest", SelfPlayFarmTest);
+    e8::EndTestSuite();
+    return 0;
+}
@@ -19,6 +19,7 @@
 #include <memory>
 #include <optional>
 #include <unordered_map>
+#include <vector>
 
 #include "common/unit_test_util/unit_test_util.h"
 #include "gomoku/agent/heuristics/tf_zero_prior_evaluator.h"
@@ -83,9 +84,58 @@ bool EvaluationResultPythonConsistencyTest() {
     return true;
 }
 
+bool BatchConsistencyTest() {
+    // Boards of 4 to 8 stones along a diagonal.
+    std::vector<e8::GomokuBoardState> boards;
+    e8::GomokuBoardState board(/*width=*/11, /*height=*/11);
+    board.ApplyAction(board.MovePositionToActionId(e8::MovePosition(/*x=*/5, /*y=*/5)),
+                      /*cached_game_result=*/std::nullopt);
+    board.ApplyAction(board.MovePositionToActionId(e8::MovePosition(/*x=*/6, /*y=*/6)),
+                      /*cached_game_result=*/std::nullopt);
+    board.ApplyAction(board.MovePositionToActionId(e8::MovePosition(/*x=*/4, /*y=*/5)),
+                      /*cached_game_result=*/std::nullopt);
+    board.ApplyAction(board.Swap2DecisionToActionId(e8::Swap2Decision::SW2D_CHOOSE_WHITE),
+                      /*cached_game_result=*/std::nullopt);
+    for (int8_t i = 0; i < 5; ++i) {
+        board.ApplyAction(board.MovePositionToActionId(e8::MovePosition(/*x=*/i, /*y=*/i)),
+                          /*cached_game_result=*/std::nullopt);
+        boards.push_back(board);
+    }
+
+    e8::GomokuTfZeroPriorEvaluator evaluator(
+        /*model_path=*/"./gomoku/agent_classroom/tfmodel/gomoku_cnn_shared_i11");
+
+    std::vector<e8::GomokuEvaluationRequest> requests;
+    for (unsigned i = 0; i < boards.size(); ++i) {
+        requests.push_back(e8::GomokuEvaluationRequest{&boards[i],
+                                                       /*parent_state_id=*/std::nullopt,
+                                                       /*state_id=*/static_cast<e8::MctNodeId>(i),
+                                                       /*reward_needed=*/true});
+    }
+    std::vector<e8::GomokuEvaluation> batched = evaluator.EvaluateBatch(requests);
+    TEST_CONDITION(batched.size() == boards.size());
+
+    evaluator.ClearCache();
+    for (unsigned i = 0; i < boards.size(); ++i) {
+        float reward = evaluator.EvaluateReward(boards[i], /*parent_state_id=*/std::nullopt,
+                                                /*state_id=*/i);
+        std::unordered_map<e8::GomokuActionId, float> policy = evaluator.EvaluatePolicy(
+            boards[i], /*parent_state_id=*/std::nullopt, /*state_id=*/i);
+
+        TEST_CONDITION(std::abs(reward - batched[i].reward) < 1e-4f);
+        TEST_CONDITION(policy.size() == batched[i].policy.size());
+        for (auto const &[action_id, p] : policy) {
+            TEST_CONDITION(std::abs(p - batched[i].policy.at(action_id)) < 1e-4f);
+        }
+    }
+
+    return true;
+}
+
 int main() {
     e8::BeginTestSuite("tf_zero_prior_evalutor");
     e8::RunTest("EvaluationResultPythonConsistencyTest", EvaluationResultPythonConsistencyTest);
+    e8::RunTest("BatchConsistencyTest", BatchConsistencyTest);
     e8::EndTestSuite();
     return 0;
 }
@@ -0,0 +1,130 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "common/unit_test_util/unit_test_util.h"
+#include "gomoku/agent/heuristics/evaluator.h"
+#include "gomoku/agent/heuristics/tf_zero_prior_evaluator.h"
+#include "gomoku/agent/search/mct_node.h"
+#include "gomoku/game/board_state.h"
+
+namespace {
+
+unsigned const kNumBoards = 1024;
+unsigned const kNumMovesPerBoard = 12;
+
+/**
+ * @brief RandomBoards Distinct boards of the standard gomoku phase, each of which has a few random
+ * moves played after the swap2 opening.
+ */
+std::vector<e8::GomokuBoardState> RandomBoards() {
+    std::mt19937 rng(13);
+    std::vector<e8::GomokuBoardState> boards;
+    while (boards.size() < kNumBoards) {
+        e8::GomokuBoardState board(/*width=*/11, /*height=*/11);
+        board.ApplyAction(board.MovePositionToActionId(e8::MovePosition(/*x=*/5, /*y=*/5)),
+                          /*cached_game_result=*/std::nullopt);
+        board.ApplyAction(board.MovePositionToActionId(e8::MovePosition(/*x=*/6, /*y=*/6)),
+                          /*cached_game_result=*/std::nullopt);
+        board.ApplyAction(board.MovePositionToActionId(e8::MovePosition(/*x=*/4, /*y=*/5)),
+                          /*cached_game_result=*/std::nullopt);
+        board.ApplyAction(board.Swap2DecisionToActionId(e8::Swap2Decision::SW2D_CHOOSE_WHITE),
+                          /*cached_game_result=*/std::nullopt);
+
+        for (unsigned i = 0;
+             i < kNumMovesPerBoard && board.CurrentGameResult() == e8::GR_UNDETERMINED; ++i) {
+            std::vector<e8::GomokuActionId> legal_actions;
+            for (auto const &[action_id, _] : board.LegalActions()) {
+                legal_actions.push_back(action_id);
+            }
+            std::uniform_int_distribution<size_t> pick(0, legal_actions.size() - 1);
+            board.ApplyAction(legal_actions[pick(rng)], /*cached_game_result=*/std::nullopt);
+        }
+
+        if (board.CurrentGameResult() == e8::GR_UNDETERMINED) {
+            boards.push_back(board);
+        }
+    }
+    return boards;
+}
+
+/**
+ * @brief EvaluationsPerSecond Evaluates all the boards through EvaluateBatch() calls of the
+ * specified batch size.
+ */
+double EvaluationsPerSecond(std::vector<e8::GomokuBoardState> const &boards,
+                            unsigned const batch_size, e8::GomokuTfZeroPriorEvaluator *evaluator) {
+    evaluator->ClearCache();
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned begin = 0; begin < boards.size(); begin += batch_size) {
+        unsigned end = std::min(begin + batch_size, static_cast<unsigned>(boards.size()));
+
+        std::vector<e8::GomokuEvaluationRequest> requests;
+        for (unsigned i = begin; i < end; ++i) {
+            requests.push_back(e8::GomokuEvaluationRequest{
+                &boards[i], /*parent_state_id=*/std::nullopt,
+                /*state_id=*/static_cast<e8::MctNodeId>(boards[i].Hash()),
+                /*reward_needed=*/true});
+        }
+        evaluator->EvaluateBatch(requests);
+    }
+    double elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    return boards.size() / elapsed;
+}
+
+bool BatchSizeTest() {
+    std::vector<e8::GomokuBoardState> boards = RandomBoards();
+
+    e8::GomokuTfZeroPriorEvaluator evaluator(
+        /*model_path=*/"./gomoku/agent_classroom/tfmodel/gomoku_cnn_shared_i11");
+
+    // Warms the session up.
+    EvaluationsPerSecond(boards, /*batch_size=*/64, &evaluator);
+
+    double single = 0;
+    for (unsigned batch_size : {1, 2, 4, 8, 16, 32, 64}) {
+        double evaluations_per_second = EvaluationsPerSecond(boards, batch_size, &evaluator);
+        if (batch_size == 1) {
+            single = evaluations_per_second;
+        }
+
+        std::cout << std::fixed << std::setprecision(0) << "batch size " << batch_size << ": "
+                  << evaluations_per_second << " evaluations/s (" << std::setprecision(2)
+                  << evaluations_per_second / single << "x)" << std::endl;
+    }
+
+    return true;
+}
+
+} // namespace
+
+int main() {
+    e8::BeginTestSuite("tf_zero_prior_evaluator_benchmark");
+    e8::RunTest("BatchSizeTest", BatchSizeTest);
+    e8::EndTestSuite();
+    return 0;
+}
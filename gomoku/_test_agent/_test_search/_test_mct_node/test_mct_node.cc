@@ -0,0 +1,142 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <optional>
+
+#include "common/unit_test_util/unit_test_util.h"
+#include "gomoku/agent/search/mct_node.h"
+#include "gomoku/game/board_state.h"
+
+bool AllocateTest() {
+    e8::MctNodeArena arena;
+
+    std::optional<e8::MctNodeIndex> root = arena.Allocate(1);
+    TEST_CONDITION(root.has_value());
+    arena.InitializeRoot(*root);
+    TEST_CONDITION(arena.NumChildren(*root) == 0);
+    TEST_CONDITION(arena.NumBanditPulls(*root) == 0);
+
+    // Spans of children are contiguous and never straddle two blocks.
+    unsigned const num_children = 225;
+    for (unsigned i = 0; i < 100; ++i) {
+        std::optional<e8::MctNodeIndex> first_child = arena.Allocate(num_children);
+        TEST_CONDITION(first_child.has_value());
+        TEST_CONDITION((*first_child >> e8::kLog2MctNodeBlockSize) ==
+                       ((*first_child + num_children - 1) >> e8::kLog2MctNodeBlockSize));
+        for (unsigned c = 0; c < num_children; ++c) {
+            arena.Initialize(*first_child + c, /*arrived_thru_action_id=*/c, e8::PS_PLAYER_B,
+                             e8::GR_UNDETERMINED, /*heuristic_policy_weight=*/1.0f / num_children);
+        }
+    }
+    TEST_CONDITION(arena.NumNodes() > 100 * num_children);
+    TEST_CONDITION(arena.NumNodes() < 100 * num_children + 2 * e8::kMctNodeBlockSize);
+
+    // Clearing keeps the blocks.
+    uint64_t const memory_usage = arena.MemoryUsage();
+    arena.Clear();
+    TEST_CONDITION(arena.NumNodes() == 0);
+    TEST_CONDITION(arena.MemoryUsage() == memory_usage);
+    TEST_CONDITION(arena.Allocate(1) == 0);
+
+    return true;
+}
+
+bool ClearTest() {
+    e8::MctNodeArena arena;
+
+    for (unsigned i = 0; i < e8::kNumRetainedMctNodeBlocks; ++i) {
+        TEST_CONDITION(arena.Allocate(e8::kMctNodeBlockSize).has_value());
+    }
+    uint64_t const retained_memory_usage = arena.MemoryUsage();
+
+    for (unsigned i = 0; i < 2 * e8::kNumRetainedMctNodeBlocks; ++i) {
+        TEST_CONDITION(arena.Allocate(e8::kMctNodeBlockSize).has_value());
+    }
+    TEST_CONDITION(arena.MemoryUsage() > retained_memory_usage);
+
+    // Clearing frees the blocks beyond the retained ones, which are reallocated on demand.
+    arena.Clear();
+    TEST_CONDITION(arena.NumNodes() == 0);
+    TEST_CONDITION(arena.MemoryUsage() == retained_memory_usage);
+    for (unsigned i = 0; i < 3 * e8::kNumRetainedMctNodeBlocks; ++i) {
+        std::optional<e8::MctNodeIndex> first = arena.Allocate(e8::kMctNodeBlockSize);
+        TEST_CONDITION(first.has_value());
+        arena.InitializeRoot(*first + e8::kMctNodeBlockSize - 1);
+    }
+    TEST_CONDITION(arena.NumNodes() == 3 * e8::kNumRetainedMctNodeBlocks * e8::kMctNodeBlockSize);
+
+    return true;
+}
+
+bool CopySubtreeTest() {
+    e8::MctNodeArena source;
+
+    // root -> {a, b}, a -> {c, d, e}.
+    e8::MctNodeIndex root = *source.Allocate(1);
+    source.InitializeRoot(root);
+
+    e8::MctNodeIndex a = *source.Allocate(2);
+    e8::MctNodeIndex b = a + 1;
+    source.Initialize(a, /*arrived_thru_action_id=*/10, e8::PS_PLAYER_A, e8::GR_UNDETERMINED,
+                      /*heuristic_policy_weight=*/0.75f);
+    source.Initialize(b, /*arrived_thru_action_id=*/11, e8::PS_PLAYER_A, e8::GR_UNDETERMINED,
+                      /*heuristic_policy_weight=*/0.25f);
+    source.SetChildren(root, a, 2);
+
+    e8::MctNodeIndex c = *source.Allocate(3);
+    for (unsigned i = 0; i < 3; ++i) {
+        source.Initialize(c + i, /*arrived_thru_action_id=*/20 + i, e8::PS_PLAYER_B,
+                          i == 2 ? e8::GR_PLAYER_B_WIN : e8::GR_UNDETERMINED,
+                          /*heuristic_policy_weight=*/1.0f / 3);
+    }
+    source.SetChildren(a, c, 3);
+
+    source.SummedReward(a) = 1.5f;
+    source.NumBanditPulls(a) = 3;
+    source.SummedReward(c + 2) = -1.0f;
+    source.NumBanditPulls(c + 2) = 1;
+
+    e8::MctNodeArena destination;
+    std::optional<e8::MctNodeIndex> copied_a = destination.CopySubtree(source, a);
+    TEST_CONDITION(copied_a.has_value());
+    TEST_CONDITION(destination.NumNodes() == 4);
+    TEST_CONDITION(destination.ArrivedThruActionId(*copied_a) == 10);
+    TEST_CONDITION(destination.HeuristicPolicyWeight(*copied_a) == 0.75f);
+    TEST_CONDITION(destination.SummedReward(*copied_a) == 1.5f);
+    TEST_CONDITION(destination.NumBanditPulls(*copied_a) == 3);
+    TEST_CONDITION(destination.NumChildren(*copied_a) == 3);
+
+    e8::MctNodeIndex copied_e = destination.FirstChild(*copied_a) + 2;
+    TEST_CONDITION(destination.ArrivedThruActionId(copied_e) == 22);
+    TEST_CONDITION(destination.ActionPerformedBy(copied_e) == e8::PS_PLAYER_B);
+    TEST_CONDITION(destination.GameResultAt(copied_e) == e8::GR_PLAYER_B_WIN);
+    TEST_CONDITION(destination.SummedReward(copied_e) == -1.0f);
+    TEST_CONDITION(destination.NumBanditPulls(copied_e) == 1);
+    TEST_CONDITION(destination.NumChildren(copied_e) == 0);
+
+    return true;
+}
+
+int main() {
+    e8::BeginTestSuite("mct_node");
+    e8::RunTest("AllocateTest", AllocateTest);
+    e8::RunTest("ClearTest", ClearTest);
+    e8::RunTest("CopySubtreeTest", CopySubtreeTest);
+    e8::EndTestSuite();
+    return 0;
+}
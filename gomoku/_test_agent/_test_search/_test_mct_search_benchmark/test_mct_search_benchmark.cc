@@ -0,0 +1,612 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "common/unit_test_util/unit_test_util.h"
+#include "gomoku/agent/heuristics/evaluator.h"
+#include "gomoku/agent/search/mct_node.h"
+#include "gomoku/agent/search/mct_search.h"
+#include "gomoku/agent/search/puct_selection.h"
+#include "gomoku/game/board_state.h"
+
+namespace {
+
+/**
+ * @brief The CountingEvaluator class A cheap deterministic evaluator which counts how many times
+ * it's called. The reward is a hash of the position and the policy is uniform over the empty cells
+ * next to a stone, so the search goes deep enough to run into transpositions. It's thread safe.
+ */
+class CountingEvaluator : public e8::GomokuEvaluatorInterface {
+  public:
+    explicit CountingEvaluator(unsigned batch_size = 1) : batch_size_(batch_size) {}
+
+    float EvaluateReward(e8::GomokuBoardState const &state,
+                         std::optional<e8::MctNodeId> /*parent_state_id*/,
+                         e8::MctNodeId /*state_id*/) override {
+        ++num_reward_calls;
+        uint64_t mixed = state.Hash() * 0x9e3779b97f4a7c15ULL;
+        return static_cast<float>(mixed >> 40) / (1 << 24) - 0.5f;
+    }
+
+    std::unordered_map<e8::GomokuActionId, float>
+    EvaluatePolicy(e8::GomokuBoardState const &state,
+                   std::optional<e8::MctNodeId> /*parent_state_id*/,
+                   e8::MctNodeId /*state_id*/) override {
+        ++num_policy_calls;
+
+        std::vector<e8::GomokuActionId> candidates;
+        for (auto const &[action_id, action] : state.LegalActions()) {
+            if (!action.stone_pos.has_value() || NextToStone(state, *action.stone_pos)) {
+                candidates.push_back(action_id);
+            }
+        }
+
+        std::unordered_map<e8::GomokuActionId, float> policy;
+        for (e8::GomokuActionId action_id : candidates) {
+            policy[action_id] = 1.0f / candidates.size();
+        }
+        return policy;
+    }
+
+    std::vector<e8::GomokuEvaluation>
+    EvaluateBatch(std::vector<e8::GomokuEvaluationRequest> const &requests) override {
+        ++num_batch_calls;
+        return GomokuEvaluatorInterface::EvaluateBatch(requests);
+    }
+
+    unsigned EvaluationBatchSize() const override { return batch_size_; }
+
+    float ExplorationFactor() const override { return 2; }
+
+    unsigned NumSimulations() const override { return 20000; }
+
+    void ClearCache() override {}
+
+    bool ThreadSafe() const override { return true; }
+
+    std::atomic<unsigned> num_reward_calls = 0;
+    std::atomic<unsigned> num_policy_calls = 0;
+    std::atomic<unsigned> num_batch_calls = 0;
+
+  private:
+    static bool NextToStone(e8::GomokuBoardState const &state, e8::MovePosition const &pos) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                int x = pos.x + dx;
+                int y = pos.y + dy;
+                if (x >= 0 && x < state.Width() && y >= 0 && y < state.Height() &&
+                    *state.ChessPieceStateAt(e8::MovePosition(x, y)) != e8::ST_NONE) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    unsigned const batch_size_;
+};
+
+/**
+ * @brief FixedPosition Plays the swap2 opening then the listed moves.
+ */
+e8::GomokuBoardState FixedPosition(int16_t const size, std::vector<e8::MovePosition> const &moves) {
+    e8::GomokuBoardState board(size, size);
+    int8_t const center = size / 2;
+    board.ApplyAction(board.MovePositionToActionId(e8::MovePosition(center, center)),
+                      /*cached_game_result=*/std::nullopt);
+    board.ApplyAction(board.MovePositionToActionId(e8::MovePosition(center + 1, center + 1)),
+                      /*cached_game_result=*/std::nullopt);
+    board.ApplyAction(board.MovePositionToActionId(e8::MovePosition(center + 1, center)),
+                      /*cached_game_result=*/std::nullopt);
+    board.ApplyAction(board.Swap2DecisionToActionId(e8::Swap2Decision::SW2D_CHOOSE_WHITE),
+                      /*cached_game_result=*/std::nullopt);
+    for (e8::MovePosition const &move : moves) {
+        board.ApplyAction(board.MovePositionToActionId(move), /*cached_game_result=*/std::nullopt);
+    }
+    return board;
+}
+
+struct SearchResult {
+    double simulations_per_second;
+    unsigned num_reward_calls;
+    unsigned num_policy_calls;
+    unsigned num_batch_calls;
+    bool valid_policy;
+};
+
+SearchResult BenchmarkSearch(e8::GomokuBoardState const &board, bool use_transposition_table,
+                             unsigned num_search_threads = 1,
+                             e8::GomokuActionId *best_action = nullptr,
+                             unsigned batch_size = 1) {
+    auto evaluator = std::make_shared<CountingEvaluator>(batch_size);
+    e8::MctSearcher searcher(std::static_pointer_cast<e8::GomokuEvaluatorInterface>(evaluator),
+                             /*print_stats=*/false, use_transposition_table, num_search_threads);
+
+    auto start = std::chrono::steady_clock::now();
+    std::unordered_map<e8::GomokuActionId, float> policy =
+        searcher.SearchFrom(board, /*temperature=*/1.0f);
+    double elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    float total_probability = 0.0f;
+    for (auto const &[_, probability] : policy) {
+        total_probability += probability;
+    }
+    if (best_action != nullptr) {
+        *best_action = e8::BestAction(policy);
+    }
+
+    return SearchResult{evaluator->NumSimulations() / elapsed, evaluator->num_reward_calls,
+                        evaluator->num_policy_calls, evaluator->num_batch_calls,
+                        std::abs(total_probability - 1.0f) < 1e-3f};
+}
+
+e8::GomokuBoardState MidGamePosition() {
+    return FixedPosition(/*size=*/15, {e8::MovePosition(6, 6), e8::MovePosition(8, 6),
+                                       e8::MovePosition(6, 8), e8::MovePosition(9, 9),
+                                       e8::MovePosition(5, 7)});
+}
+
+bool TranspositionTableTest() {
+    std::vector<e8::GomokuBoardState> positions{
+        FixedPosition(/*size=*/11, {e8::MovePosition(4, 6)}),
+        MidGamePosition(),
+    };
+
+    for (auto const &board : positions) {
+        SearchResult tree = BenchmarkSearch(board, /*use_transposition_table=*/false);
+        SearchResult transposition = BenchmarkSearch(board, /*use_transposition_table=*/true);
+
+        std::cout << std::fixed << std::setprecision(0) << board.Width() << "x" << board.Height()
+                  << ": tree " << tree.simulations_per_second
+                  << " simulations/s reward_calls=" << tree.num_reward_calls
+                  << " policy_calls=" << tree.num_policy_calls << " | transposition "
+                  << transposition.simulations_per_second
+                  << " simulations/s reward_calls=" << transposition.num_reward_calls
+                  << " policy_calls=" << transposition.num_policy_calls << std::endl;
+
+        TEST_CONDITION(tree.valid_policy);
+        TEST_CONDITION(transposition.valid_policy);
+        TEST_CONDITION(transposition.num_reward_calls < tree.num_reward_calls);
+    }
+
+    return true;
+}
+
+/**
+ * @brief WinnablePosition The player to move has an open four in the column x=3, which every search
+ * should find.
+ */
+e8::GomokuBoardState WinnablePosition() {
+    return FixedPosition(
+        /*size=*/15, {e8::MovePosition(3, 3), e8::MovePosition(12, 1), e8::MovePosition(3, 4),
+                      e8::MovePosition(12, 3), e8::MovePosition(3, 5), e8::MovePosition(12, 5),
+                      e8::MovePosition(3, 6), e8::MovePosition(12, 9)});
+}
+
+bool ParallelSearchTest() {
+    e8::GomokuBoardState mid_game = MidGamePosition();
+    e8::GomokuBoardState winnable = WinnablePosition();
+    e8::GomokuLegalActionSet winning_actions =
+        winnable.WinningActions(winnable.CurrentPlayerSide());
+    TEST_CONDITION(winning_actions.size() == 2);
+
+    for (unsigned num_search_threads : {1, 2, 4, 8, 16}) {
+        SearchResult result =
+            BenchmarkSearch(mid_game, /*use_transposition_table=*/true, num_search_threads);
+
+        std::cout << std::fixed << std::setprecision(0) << num_search_threads
+                  << " threads: " << result.simulations_per_second
+                  << " simulations/s reward_calls=" << result.num_reward_calls
+                  << " policy_calls=" << result.num_policy_calls << std::endl;
+        TEST_CONDITION(result.valid_policy);
+
+        e8::GomokuActionId best_action;
+        result = BenchmarkSearch(winnable, /*use_transposition_table=*/true, num_search_threads,
+                                 &best_action);
+        TEST_CONDITION(result.valid_policy);
+        TEST_CONDITION(winning_actions.contains(best_action));
+    }
+
+    return true;
+}
+
+bool BatchedSearchTest() {
+    e8::GomokuBoardState mid_game = MidGamePosition();
+    e8::GomokuBoardState winnable = WinnablePosition();
+    e8::GomokuLegalActionSet winning_actions =
+        winnable.WinningActions(winnable.CurrentPlayerSide());
+
+    for (unsigned batch_size : {1, 4, 16, 64}) {
+        SearchResult result =
+            BenchmarkSearch(mid_game, /*use_transposition_table=*/true,
+                            /*num_search_threads=*/1, /*best_action=*/nullptr, batch_size);
+
+        std::cout << std::fixed << std::setprecision(0) << "batch size " << batch_size << ": "
+                  << result.simulations_per_second
+                  << " simulations/s reward_calls=" << result.num_reward_calls
+                  << " policy_calls=" << result.num_policy_calls
+                  << " batch_calls=" << result.num_batch_calls << std::endl;
+        TEST_CONDITION(result.valid_policy);
+        TEST_CONDITION(result.num_batch_calls <= result.num_policy_calls / batch_size + 1);
+
+        e8::GomokuActionId best_action;
+        result = BenchmarkSearch(winnable, /*use_transposition_table=*/true,
+                                 /*num_search_threads=*/1, &best_action, batch_size);
+        TEST_CONDITION(result.valid_policy);
+        TEST_CONDITION(winning_actions.contains(best_action));
+    }
+
+    return true;
+}
+
+bool NodeStorageTest() {
+    e8::MctNodeArena arena;
+
+    // Expands nodes the way a search on a 15x15 board does.
+    unsigned const num_children = 225;
+    auto start = std::chrono::steady_clock::now();
+    while (arena.NumNodes() + num_children <= (1 << 20)) {
+        std::optional<e8::MctNodeIndex> first_child = arena.Allocate(num_children);
+        TEST_CONDITION(first_child.has_value());
+        for (unsigned i = 0; i < num_children; ++i) {
+            arena.Initialize(*first_child + i, /*arrived_thru_action_id=*/i, e8::PS_PLAYER_A,
+                             e8::GR_UNDETERMINED, /*heuristic_policy_weight=*/1.0f / num_children);
+        }
+    }
+    double elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << std::fixed << std::setprecision(1) << arena.NumNodes() << " nodes: "
+              << static_cast<double>(arena.MemoryUsage()) / arena.NumNodes() << " bytes/node "
+              << elapsed * 1e9 / arena.NumNodes() << " ns/node" << std::endl;
+    TEST_CONDITION(arena.MemoryUsage() < 40 * arena.NumNodes());
+
+    // Keeps the subtree of the selected action then searches on.
+    auto evaluator = std::make_shared<CountingEvaluator>();
+    e8::MctSearcher searcher(std::static_pointer_cast<e8::GomokuEvaluatorInterface>(evaluator),
+                             /*print_stats=*/false);
+    e8::GomokuBoardState board = MidGamePosition();
+    for (unsigned i = 0; i < 3; ++i) {
+        std::unordered_map<e8::GomokuActionId, float> policy =
+            searcher.SearchFrom(board, /*temperature=*/1.0f);
+        e8::GomokuActionId best_action = e8::BestAction(policy);
+
+        start = std::chrono::steady_clock::now();
+        searcher.SelectAction(board, best_action);
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        board.ApplyAction(best_action, /*cached_game_result=*/std::nullopt);
+
+        std::cout << std::fixed << std::setprecision(1) << "select action " << i << ": "
+                  << elapsed * 1e6 << " us" << std::endl;
+    }
+
+    return true;
+}
+
+/**
+ * @brief The SyntheticNode struct A node whose children are bandits with fixed win probabilities.
+ * Besides the statistics, it keeps the score of each child as of when the child was last pulled,
+ * which is what the children priority queue used to be ordered by.
+ */
+struct SyntheticNode {
+    std::vector<float> win_probabilities;
+    std::vector<float> summed_rewards;
+    std::vector<unsigned> num_bandit_pulls;
+    std::vector<unsigned> num_virtual_losses;
+    std::vector<float> heuristic_policy_weights;
+    std::vector<float> cached_scores;
+    unsigned num_parent_pulls = 0;
+
+    e8::PuctChildren Children() const {
+        return e8::PuctChildren{summed_rewards.data(), num_bandit_pulls.data(),
+                                num_virtual_losses.data(), heuristic_policy_weights.data(),
+                                static_cast<unsigned>(summed_rewards.size())};
+    }
+
+    unsigned HighestCachedScore() const {
+        unsigned best = 0;
+        for (unsigned i = 1; i < cached_scores.size(); ++i) {
+            if (cached_scores[i] > cached_scores[best]) {
+                best = i;
+            }
+        }
+        return best;
+    }
+};
+
+SyntheticNode MakeSyntheticNode(unsigned const num_children, float const exploration_factor,
+                                std::mt19937 *random_source) {
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    SyntheticNode node;
+    float total_weight = 0.0f;
+    for (unsigned i = 0; i < num_children; ++i) {
+        node.win_probabilities.push_back(unit(*random_source));
+        node.heuristic_policy_weights.push_back(unit(*random_source));
+        total_weight += node.heuristic_policy_weights.back();
+    }
+    for (float &weight : node.heuristic_policy_weights) {
+        weight /= total_weight;
+    }
+
+    node.summed_rewards.resize(num_children, 0.0f);
+    node.num_bandit_pulls.resize(num_children, 0);
+    node.num_virtual_losses.resize(num_children, 0);
+    for (unsigned i = 0; i < num_children; ++i) {
+        node.cached_scores.push_back(
+            e8::PuctScore(exploration_factor, /*parent_num_bandit_pulls=*/0,
+                          /*summed_reward=*/0.0f, /*num_bandit_pulls=*/0,
+                          /*num_virtual_losses=*/0, node.heuristic_policy_weights[i]));
+    }
+    return node;
+}
+
+/**
+ * @brief SelectionKernelTest Pulls the children of a synthetic node by either the exact PUCT
+ * score or the cached scores, and counts how often the cached scores pick a child other than the
+ * one of the highest exact score. Then times each way of selecting a child.
+ */
+bool SelectionKernelTest() {
+    unsigned const num_children = 225;
+    unsigned const num_pulls = 20000;
+    float const exploration_factor = 2.0f;
+
+    for (bool exact : {false, true}) {
+        std::mt19937 random_source(7);
+        SyntheticNode node = MakeSyntheticNode(num_children, exploration_factor, &random_source);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+        unsigned num_stale_selections = 0;
+        for (unsigned t = 0; t < num_pulls; ++t) {
+            unsigned exact_choice =
+                e8::HighestPuctScore(exploration_factor, node.num_parent_pulls, node.Children());
+            unsigned cached_choice = node.HighestCachedScore();
+            if (exact_choice != cached_choice) {
+                ++num_stale_selections;
+            }
+
+            unsigned choice = exact ? exact_choice : cached_choice;
+            node.summed_rewards[choice] +=
+                unit(random_source) < node.win_probabilities[choice] ? 1.0f : -1.0f;
+            ++node.num_bandit_pulls[choice];
+            ++node.num_parent_pulls;
+            node.cached_scores[choice] = e8::PuctScore(
+                exploration_factor, node.num_parent_pulls, node.summed_rewards[choice],
+                node.num_bandit_pulls[choice], /*num_virtual_losses=*/0,
+                node.heuristic_policy_weights[choice]);
+        }
+
+        unsigned best_child = 0;
+        for (unsigned i = 1; i < num_children; ++i) {
+            if (node.win_probabilities[i] > node.win_probabilities[best_child]) {
+                best_child = i;
+            }
+        }
+        float regret = 0.0f;
+        for (unsigned i = 0; i < num_children; ++i) {
+            regret += node.num_bandit_pulls[i] *
+                      (node.win_probabilities[best_child] - node.win_probabilities[i]);
+        }
+
+        std::cout << std::fixed << std::setprecision(3)
+                  << (exact ? "exact scores: " : "cached scores: ")
+                  << "stale selections=" << static_cast<float>(num_stale_selections) / num_pulls
+                  << " regret/pull=" << regret / num_pulls << std::endl;
+
+        if (!exact) {
+            continue;
+        }
+
+        // Times the selection over the final statistics.
+        unsigned const num_selections = 100000;
+        unsigned checksum = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < num_selections; ++i) {
+            checksum += node.HighestCachedScore();
+        }
+        double cached_ns = std::chrono::duration<double, std::nano>(
+                               std::chrono::steady_clock::now() - start)
+                               .count() /
+                           num_selections;
+
+        start = std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < num_selections; ++i) {
+            checksum += e8::HighestPuctScoreScalar(exploration_factor, node.num_parent_pulls + i,
+                                                   node.Children());
+        }
+        double scalar_ns = std::chrono::duration<double, std::nano>(
+                               std::chrono::steady_clock::now() - start)
+                               .count() /
+                           num_selections;
+
+        start = std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < num_selections; ++i) {
+            checksum += e8::HighestPuctScore(exploration_factor, node.num_parent_pulls + i,
+                                             node.Children());
+        }
+        double vectorized_ns = std::chrono::duration<double, std::nano>(
+                                   std::chrono::steady_clock::now() - start)
+                                   .count() /
+                               num_selections;
+
+        std::cout << std::fixed << std::setprecision(1) << "cached scan " << cached_ns
+                  << " ns | exact scalar " << scalar_ns << " ns | exact vectorized "
+                  << vectorized_ns << " ns | speedup " << scalar_ns / vectorized_ns
+                  << "x (checksum " << checksum << ")" << std::endl;
+    }
+
+    return true;
+}
+
+std::shared_ptr<e8::GomokuEvaluatorInterface> NewCountingEvaluator() {
+    return std::static_pointer_cast<e8::GomokuEvaluatorInterface>(
+        std::make_shared<CountingEvaluator>());
+}
+
+void PrintSearchStats(char const *label, e8::SearchStats const &stats) {
+    std::cout << std::fixed << std::setprecision(1) << label << ": " << stats.latency / 1000.0
+              << " ms simulations=" << stats.num_simulations
+              << " reused=" << stats.num_reused_simulations
+              << " stopped_early=" << stats.stopped_early << std::endl;
+}
+
+bool SearchBudgetTest() {
+    e8::GomokuBoardState mid_game = MidGamePosition();
+
+    // Node budget.
+    e8::MctSearcher node_budgeted(NewCountingEvaluator(), /*print_stats=*/false);
+    e8::SearchBudget budget;
+    budget.max_num_simulations = 5000;
+    budget.early_stopping = false;
+    node_budgeted.SearchFrom(mid_game, /*temperature=*/1.0f, budget);
+    PrintSearchStats("5000 simulations", node_budgeted.LastSearchStats());
+    TEST_CONDITION(node_budgeted.LastSearchStats().num_simulations == 5000);
+
+    // Time budget.
+    for (unsigned num_search_threads : {1, 4}) {
+        e8::MctSearcher time_budgeted(NewCountingEvaluator(), /*print_stats=*/false,
+                                      /*use_transposition_table=*/true, num_search_threads);
+        budget.max_num_simulations = std::nullopt;
+        budget.max_duration = 100'000;
+        for (unsigned i = 0; i < 3; ++i) {
+            std::unordered_map<e8::GomokuActionId, float> policy =
+                time_budgeted.SearchFrom(mid_game, /*temperature=*/1.0f, budget);
+            e8::SearchStats stats = time_budgeted.LastSearchStats();
+            PrintSearchStats("100 ms", stats);
+            TEST_CONDITION(!policy.empty());
+            TEST_CONDITION(stats.latency >= 100'000);
+            TEST_CONDITION(stats.latency < 150'000);
+        }
+    }
+
+    // Early stopping.
+    e8::GomokuBoardState winnable = WinnablePosition();
+    e8::GomokuLegalActionSet winning_actions =
+        winnable.WinningActions(winnable.CurrentPlayerSide());
+    e8::MctSearcher early_stopped(NewCountingEvaluator(), /*print_stats=*/false);
+    budget.max_num_simulations = 20000;
+    budget.max_duration = std::nullopt;
+    budget.early_stopping = true;
+    std::unordered_map<e8::GomokuActionId, float> policy =
+        early_stopped.SearchFrom(winnable, /*temperature=*/1.0f, budget);
+    PrintSearchStats("early stopping", early_stopped.LastSearchStats());
+    TEST_CONDITION(early_stopped.LastSearchStats().stopped_early);
+    TEST_CONDITION(early_stopped.LastSearchStats().num_simulations < 20000);
+    TEST_CONDITION(winning_actions.contains(e8::BestAction(policy)));
+
+    // Stopped from another thread.
+    e8::MctSearcher stopped(NewCountingEvaluator(), /*print_stats=*/false);
+    budget.max_num_simulations = std::nullopt;
+    budget.max_duration = 60'000'000;
+    budget.early_stopping = false;
+    std::thread stopper([&stopped]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        stopped.Stop();
+    });
+    policy = stopped.SearchFrom(mid_game, /*temperature=*/1.0f, budget);
+    stopper.join();
+    PrintSearchStats("stopped", stopped.LastSearchStats());
+    TEST_CONDITION(!policy.empty());
+    TEST_CONDITION(stopped.LastSearchStats().latency < 1'000'000);
+
+    return true;
+}
+
+bool PonderingTest() {
+    e8::MctSearcher searcher(NewCountingEvaluator(), /*print_stats=*/false);
+    e8::GomokuBoardState board = MidGamePosition();
+
+    e8::SearchBudget budget;
+    budget.max_duration = 50'000;
+    budget.early_stopping = false;
+
+    for (unsigned i = 0; i < 3; ++i) {
+        std::unordered_map<e8::GomokuActionId, float> policy =
+            searcher.SearchFrom(board, /*temperature=*/1.0f, budget);
+        PrintSearchStats("move", searcher.LastSearchStats());
+        if (i > 0) {
+            TEST_CONDITION(searcher.LastSearchStats().num_reused_simulations > 0);
+        }
+
+        e8::GomokuActionId action_id = e8::BestAction(policy);
+        searcher.SelectAction(board, action_id);
+        board.ApplyAction(action_id, /*cached_game_result=*/std::nullopt);
+        if (board.CurrentGameResult() != e8::GR_UNDETERMINED) {
+            break;
+        }
+
+        // Ponders on the opponent's time.
+        searcher.StartPondering(board);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        searcher.StopPondering();
+
+        // The opponent plays whatever the pondering has found the most promising.
+        policy = searcher.SearchFrom(board, /*temperature=*/1.0f, budget);
+        PrintSearchStats("opponent move", searcher.LastSearchStats());
+        TEST_CONDITION(searcher.LastSearchStats().num_reused_simulations > 0);
+
+        action_id = e8::BestAction(policy);
+        searcher.SelectAction(board, action_id);
+        board.ApplyAction(action_id, /*cached_game_result=*/std::nullopt);
+        if (board.CurrentGameResult() != e8::GR_UNDETERMINED) {
+            break;
+        }
+    }
+
+    // The game is over, so neither searching nor pondering has anything to do.
+    if (board.CurrentGameResult() != e8::GR_UNDETERMINED) {
+        TEST_CONDITION(searcher.SearchFrom(board, /*temperature=*/1.0f, budget).empty());
+        TEST_CONDITION(searcher.LastSearchStats().num_simulations == 0);
+        searcher.StartPondering(board);
+        searcher.StopPondering();
+        return true;
+    }
+
+    // Destroying the searcher while pondering stops it.
+    searcher.StartPondering(board);
+
+    return true;
+}
+
+} // namespace
+
+int main() {
+    e8::BeginTestSuite("mct_search_benchmark");
+    e8::RunTest("TranspositionTableTest", TranspositionTableTest);
+    e8::RunTest("ParallelSearchTest", ParallelSearchTest);
+    e8::RunTest("BatchedSearchTest", BatchedSearchTest);
+    e8::RunTest("NodeStorageTest", NodeStorageTest);
+    e8::RunTest("SelectionKernelTest", SelectionKernelTest);
+    e8::RunTest("SearchBudgetTest", SearchBudgetTest);
+    e8::RunTest("PonderingTest", PonderingTest);
+    e8::EndTestSuite();
+    return 0;
+}
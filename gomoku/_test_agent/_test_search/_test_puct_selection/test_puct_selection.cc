@@ -0,0 +1,150 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "common/unit_test_util/unit_test_util.h"
+#include "gomoku/agent/search/puct_selection.h"
+
+namespace {
+
+struct Children {
+    std::vector<float> summed_rewards;
+    std::vector<unsigned> num_bandit_pulls;
+    std::vector<unsigned> num_virtual_losses;
+    std::vector<float> heuristic_policy_weights;
+
+    e8::PuctChildren View() const {
+        return e8::PuctChildren{summed_rewards.data(), num_bandit_pulls.data(),
+                                num_virtual_losses.data(), heuristic_policy_weights.data(),
+                                static_cast<unsigned>(summed_rewards.size())};
+    }
+};
+
+Children RandomChildren(unsigned const num_children, std::mt19937 *random_source) {
+    std::uniform_int_distribution<unsigned> pulls(0, 50);
+    std::uniform_int_distribution<unsigned> virtual_losses(0, 2);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    Children children;
+    for (unsigned i = 0; i < num_children; ++i) {
+        unsigned num_bandit_pulls = pulls(*random_source) < 10 ? 0 : pulls(*random_source);
+        children.num_bandit_pulls.push_back(num_bandit_pulls);
+        children.summed_rewards.push_back(num_bandit_pulls * (2 * unit(*random_source) - 1));
+        children.num_virtual_losses.push_back(virtual_losses(*random_source));
+        children.heuristic_policy_weights.push_back(unit(*random_source) / num_children);
+    }
+    return children;
+}
+
+float ScoreOf(Children const &children, unsigned const parent_num_bandit_pulls,
+              unsigned const i) {
+    return e8::PuctScore(/*exploration_factor=*/2.0f, parent_num_bandit_pulls,
+                         children.summed_rewards[i], children.num_bandit_pulls[i],
+                         children.num_virtual_losses[i], children.heuristic_policy_weights[i]);
+}
+
+} // namespace
+
+bool PuctScoreTest() {
+    // Never pulled.
+    TEST_CONDITION(e8::PuctScore(/*exploration_factor=*/2.0f, /*parent_num_bandit_pulls=*/8,
+                                 /*summed_reward=*/0.0f, /*num_bandit_pulls=*/0,
+                                 /*num_virtual_losses=*/0, /*heuristic_policy_weight=*/0.5f) ==
+                   1.0f);
+
+    // q = 2/4, u = 2*sqrt(9)/4.
+    TEST_CONDITION(e8::PuctScore(/*exploration_factor=*/2.0f, /*parent_num_bandit_pulls=*/8,
+                                 /*summed_reward=*/2.0f, /*num_bandit_pulls=*/4,
+                                 /*num_virtual_losses=*/0, /*heuristic_policy_weight=*/0.5f) ==
+                   0.5f + 0.5f * 1.5f);
+
+    // A virtual loss counts as a pull with a reward of -1. q = (2-4)/8, u = 2*sqrt(9)/8.
+    TEST_CONDITION(e8::PuctScore(/*exploration_factor=*/2.0f, /*parent_num_bandit_pulls=*/8,
+                                 /*summed_reward=*/2.0f, /*num_bandit_pulls=*/4,
+                                 /*num_virtual_losses=*/4, /*heuristic_policy_weight=*/0.5f) ==
+                   -0.25f + 0.5f * 0.75f);
+
+    return true;
+}
+
+bool HighestPuctScoreTest() {
+    std::mt19937 random_source(1);
+
+    for (unsigned num_children : {1, 2, 7, 8, 9, 31, 64, 225, 226}) {
+        for (unsigned trial = 0; trial < 100; ++trial) {
+            Children children = RandomChildren(num_children, &random_source);
+            unsigned const parent_num_bandit_pulls = 1000;
+
+            unsigned scalar = e8::HighestPuctScoreScalar(/*exploration_factor=*/2.0f,
+                                                         parent_num_bandit_pulls, children.View());
+            unsigned vectorized = e8::HighestPuctScore(/*exploration_factor=*/2.0f,
+                                                       parent_num_bandit_pulls, children.View());
+            TEST_CONDITION(scalar < num_children);
+            TEST_CONDITION(vectorized < num_children);
+
+            float best_score = ScoreOf(children, parent_num_bandit_pulls, scalar);
+            for (unsigned i = 0; i < num_children; ++i) {
+                TEST_CONDITION(ScoreOf(children, parent_num_bandit_pulls, i) <= best_score);
+            }
+            TEST_CONDITION(std::abs(ScoreOf(children, parent_num_bandit_pulls, vectorized) -
+                                    best_score) < 1e-6f);
+        }
+    }
+
+    return true;
+}
+
+bool TieTest() {
+    // Every child has the same score.
+    Children children;
+    for (unsigned i = 0; i < 20; ++i) {
+        children.summed_rewards.push_back(0.0f);
+        children.num_bandit_pulls.push_back(0);
+        children.num_virtual_losses.push_back(0);
+        children.heuristic_policy_weights.push_back(0.05f);
+    }
+    TEST_CONDITION(e8::HighestPuctScoreScalar(/*exploration_factor=*/2.0f,
+                                              /*parent_num_bandit_pulls=*/0,
+                                              children.View()) == 0);
+    TEST_CONDITION(e8::HighestPuctScore(/*exploration_factor=*/2.0f,
+                                        /*parent_num_bandit_pulls=*/0, children.View()) == 0);
+
+    // Of two best children, the first one is picked.
+    children.heuristic_policy_weights[3] = 0.5f;
+    children.heuristic_policy_weights[11] = 0.5f;
+    TEST_CONDITION(e8::HighestPuctScore(/*exploration_factor=*/2.0f,
+                                        /*parent_num_bandit_pulls=*/0, children.View()) == 3);
+
+    // The best child is in the remainder which doesn't fill up a vector.
+    children.heuristic_policy_weights[18] = 0.75f;
+    TEST_CONDITION(e8::HighestPuctScore(/*exploration_factor=*/2.0f,
+                                        /*parent_num_bandit_pulls=*/0, children.View()) == 18);
+
+    return true;
+}
+
+int main() {
+    e8::BeginTestSuite("puct_selection");
+    e8::RunTest("PuctScoreTest", PuctScoreTest);
+    e8::RunTest("HighestPuctScoreTest", HighestPuctScoreTest);
+    e8::RunTest("TieTest", TieTest);
+    e8::EndTestSuite();
+    return 0;
+}
@@ -0,0 +1,110 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "common/unit_test_util/unit_test_util.h"
+#include "gomoku/agent/search/transposition_table.h"
+
+bool ProbeAndAccumulateTest() {
+    e8::TranspositionTable table(/*log2_num_slots=*/4);
+
+    uint64_t const key = 0x123456789abcdef3ULL;
+    TEST_CONDITION(!table.Probe(key).has_value());
+
+    table.Accumulate(key, /*reward=*/0.5f);
+    table.Accumulate(key, /*reward=*/-0.25f);
+    std::optional<e8::TranspositionStats> stats = table.Probe(key);
+    TEST_CONDITION(stats.has_value());
+    TEST_CONDITION(stats->num_visits == 2);
+    TEST_CONDITION(stats->summed_reward == 0.25f);
+
+    // Another key in a different slot doesn't interfere.
+    uint64_t const other_slot_key = key + 1;
+    TEST_CONDITION(!table.Probe(other_slot_key).has_value());
+    table.Accumulate(other_slot_key, /*reward=*/1.0f);
+    TEST_CONDITION(table.Probe(key)->num_visits == 2);
+
+    // A colliding key replaces the resident of the slot.
+    uint64_t const colliding_key = key ^ (uint64_t(1) << 60);
+    TEST_CONDITION(!table.Probe(colliding_key).has_value());
+    table.Accumulate(colliding_key, /*reward=*/1.0f);
+    TEST_CONDITION(!table.Probe(key).has_value());
+    TEST_CONDITION(table.Probe(colliding_key)->num_visits == 1);
+
+    table.Clear();
+    TEST_CONDITION(!table.Probe(colliding_key).has_value());
+    TEST_CONDITION(!table.Probe(other_slot_key).has_value());
+
+    return true;
+}
+
+bool SaturationTest() {
+    e8::TranspositionTable table(/*log2_num_slots=*/4);
+
+    uint64_t const key = 42;
+    for (unsigned i = 0; i < 0x10000; ++i) {
+        table.Accumulate(key, /*reward=*/0.5f);
+    }
+
+    std::optional<e8::TranspositionStats> stats = table.Probe(key);
+    TEST_CONDITION(stats.has_value());
+    TEST_CONDITION(stats->num_visits == 0x8000);
+    TEST_CONDITION(stats->summed_reward / stats->num_visits == 0.5f);
+
+    return true;
+}
+
+bool ConcurrentAccumulateTest() {
+    e8::TranspositionTable table(/*log2_num_slots=*/4);
+
+    uint64_t const key = 7;
+    unsigned const num_threads = 4;
+    unsigned const num_visits_per_thread = 10000;
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&table, key, num_visits_per_thread]() {
+            for (unsigned j = 0; j < num_visits_per_thread; ++j) {
+                table.Accumulate(key, /*reward=*/1.0f);
+                table.Probe(key);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    std::optional<e8::TranspositionStats> stats = table.Probe(key);
+    TEST_CONDITION(stats.has_value());
+    TEST_CONDITION(stats->num_visits == num_threads * num_visits_per_thread);
+    TEST_CONDITION(stats->summed_reward == num_threads * num_visits_per_thread);
+
+    return true;
+}
+
+int main() {
+    e8::BeginTestSuite("transposition_table");
+    e8::RunTest("ProbeAndAccumulateTest", ProbeAndAccumulateTest);
+    e8::RunTest("SaturationTest", SaturationTest);
+    e8::RunTest("ConcurrentAccumulateTest", ConcurrentAccumulateTest);
+    e8::EndTestSuite();
+    return 0;
+}
@@ -448,6 +448,150 @@ bool HistoryRecordTest() {
     return true;
 }
 
+bool LegalActionSetTest() {
+    e8::GomokuLegalActionSet set(/*width=*/5, /*height=*/4);
+    TEST_CONDITION(set.empty());
+
+    e8::GomokuBoardState board(/*width=*/5, /*height=*/4);
+    e8::GomokuActionId cell = board.MovePositionToActionId(e8::MovePosition(/*x=*/3, /*y=*/2));
+    e8::GomokuActionId decision =
+        board.Swap2DecisionToActionId(e8::Swap2Decision::SW2D_CHOOSE_WHITE);
+    set.insert(decision);
+    set.insert(cell);
+    TEST_CONDITION(set.size() == 2);
+    TEST_CONDITION(set.contains(cell));
+    TEST_CONDITION(set.find(decision) != set.end());
+
+    // Iterates from the most recently inserted action.
+    auto it = set.begin();
+    TEST_CONDITION(it->first == cell);
+    TEST_CONDITION(it->second.stone_pos.has_value());
+    TEST_CONDITION(it->second.stone_pos->x == 3 && it->second.stone_pos->y == 2);
+    ++it;
+    TEST_CONDITION((*it).first == decision);
+    TEST_CONDITION(set.at(decision).swap2_decision == e8::Swap2Decision::SW2D_CHOOSE_WHITE);
+    ++it;
+    TEST_CONDITION(it == set.end());
+
+    // Re-inserting an action moves it to the front.
+    set.erase(decision);
+    set.insert(decision);
+    TEST_CONDITION(set.begin()->first == decision);
+
+    set.erase(cell);
+    TEST_CONDITION(set.size() == 1);
+    TEST_CONDITION(!set.contains(cell));
+    TEST_CONDITION(set.find(cell) == set.end());
+
+    return true;
+}
+
+bool WinningActionsTest() {
+    e8::GomokuBoardState board(/*width=*/11, /*height=*/11);
+    auto place = [&board](int8_t x, int8_t y) {
+        return board.ApplyAction(board.MovePositionToActionId(e8::MovePosition(x, y)),
+                                 /*cached_game_result=*/std::nullopt);
+    };
+    auto id = [&board](int8_t x, int8_t y) {
+        return board.MovePositionToActionId(e8::MovePosition(x, y));
+    };
+
+    place(/*x=*/0, /*y=*/10);
+    place(/*x=*/10, /*y=*/10);
+    TEST_CONDITION(board.WinningActions(e8::PlayerSide::PS_PLAYER_A).empty());
+    place(/*x=*/10, /*y=*/0);
+    board.ApplyAction(board.Swap2DecisionToActionId(e8::Swap2Decision::SW2D_CHOOSE_WHITE),
+                      /*cached_game_result=*/std::nullopt);
+    TEST_CONDITION(board.CurrentPlayerSide() == e8::PlayerSide::PS_PLAYER_B);
+
+    // White (player B) makes an open four while black (player A) makes a three.
+    for (int8_t x = 2; x <= 4; ++x) {
+        place(x, /*y=*/5);
+        place(x, /*y=*/2);
+    }
+    place(/*x=*/5, /*y=*/5);
+    TEST_CONDITION(board.WinningActions(e8::PlayerSide::PS_PLAYER_A).empty());
+    e8::GomokuLegalActionSet white_wins = board.WinningActions(e8::PlayerSide::PS_PLAYER_B);
+    TEST_CONDITION(white_wins.size() == 2);
+    TEST_CONDITION(white_wins.contains(id(/*x=*/1, /*y=*/5)));
+    TEST_CONDITION(white_wins.contains(id(/*x=*/6, /*y=*/5)));
+    TEST_CONDITION(board.GameResultAfter(id(/*x=*/6, /*y=*/5)) ==
+                   e8::GameResult::GR_UNDETERMINED);
+
+    // Black makes a four too, then white plays with a gap so that one end becomes an overline.
+    place(/*x=*/5, /*y=*/2);
+    TEST_CONDITION(board.WinningActions(e8::PlayerSide::PS_PLAYER_A).size() == 2);
+    TEST_CONDITION(board.GameResultAfter(id(/*x=*/6, /*y=*/5)) ==
+                   e8::GameResult::GR_PLAYER_B_WIN);
+    place(/*x=*/7, /*y=*/5);
+    place(/*x=*/0, /*y=*/0);
+    white_wins = board.WinningActions(e8::PlayerSide::PS_PLAYER_B);
+    TEST_CONDITION(white_wins.size() == 1);
+    TEST_CONDITION(white_wins.contains(id(/*x=*/1, /*y=*/5)));
+    TEST_CONDITION(board.GameResultAfter(id(/*x=*/6, /*y=*/5)) == e8::GameResult::GR_TIE);
+    TEST_CONDITION(place(/*x=*/6, /*y=*/5) == e8::GameResult::GR_TIE);
+    TEST_CONDITION(board.WinningActions(e8::PlayerSide::PS_PLAYER_B).empty());
+
+    // The tables are restored by retracting.
+    board.RetractAction();
+    TEST_CONDITION(board.WinningActions(e8::PlayerSide::PS_PLAYER_B).size() == 1);
+    TEST_CONDITION(place(/*x=*/1, /*y=*/5) == e8::GameResult::GR_PLAYER_B_WIN);
+    board.RetractAction();
+    board.RetractAction();
+    board.RetractAction();
+    TEST_CONDITION(board.WinningActions(e8::PlayerSide::PS_PLAYER_B).size() == 2);
+
+    return true;
+}
+
+bool HashTest() {
+    e8::GomokuBoardState board(/*width=*/11, /*height=*/11);
+    auto apply = [&board](e8::GomokuActionId action_id) {
+        board.ApplyAction(action_id, /*cached_game_result=*/std::nullopt);
+    };
+    auto id = [&board](int8_t x, int8_t y) {
+        return board.MovePositionToActionId(e8::MovePosition(x, y));
+    };
+
+    uint64_t const initial_hash = board.Hash();
+    apply(id(/*x=*/5, /*y=*/5));
+    TEST_CONDITION(board.Hash() != initial_hash);
+    apply(id(/*x=*/6, /*y=*/5));
+    apply(id(/*x=*/5, /*y=*/6));
+    apply(board.Swap2DecisionToActionId(e8::Swap2Decision::SW2D_CHOOSE_WHITE));
+    uint64_t const opening_hash = board.Hash();
+
+    // Two move orders transposing into the same position.
+    apply(id(/*x=*/1, /*y=*/1));
+    apply(id(/*x=*/2, /*y=*/2));
+    apply(id(/*x=*/3, /*y=*/3));
+    uint64_t const transposed_hash = board.Hash();
+    board.RetractAction();
+    board.RetractAction();
+    board.RetractAction();
+    TEST_CONDITION(board.Hash() == opening_hash);
+
+    apply(id(/*x=*/3, /*y=*/3));
+    apply(id(/*x=*/2, /*y=*/2));
+    apply(id(/*x=*/1, /*y=*/1));
+    TEST_CONDITION(board.Hash() == transposed_hash);
+
+    // Any other position has a different key.
+    board.RetractAction();
+    apply(id(/*x=*/0, /*y=*/0));
+    apply(id(/*x=*/1, /*y=*/1));
+    TEST_CONDITION(board.Hash() != transposed_hash);
+
+    // Copies carry the key.
+    e8::GomokuBoardState copy(board);
+    TEST_CONDITION(copy.Hash() == board.Hash());
+    while (board.RetractAction().has_value()) {
+    }
+    TEST_CONDITION(board.Hash() == initial_hash);
+
+    return true;
+}
+
 int main() {
     e8::BeginTestSuite("board_state");
     e8::RunTest("BasicGameStateTest", BasicGameStateTest);
@@ -455,6 +599,9 @@ int main() {
     e8::RunTest("GameResultTest", GameResultTest);
     e8::RunTest("GameResultTest2", GameResultTest2);
     e8::RunTest("HistoryRecordTest", HistoryRecordTest);
+    e8::RunTest("LegalActionSetTest", LegalActionSetTest);
+    e8::RunTest("WinningActionsTest", WinningActionsTest);
+    e8::RunTest("HashTest", HashTest);
     e8::EndTestSuite();
     return 0;
 }
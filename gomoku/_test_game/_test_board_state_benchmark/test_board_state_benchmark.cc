@@ -0,0 +1,239 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "common/unit_test_util/unit_test_util.h"
+#include "gomoku/game/board_state.h"
+
+namespace {
+
+unsigned const kNumPlayouts = 2000;
+unsigned const kNumCopies = 200000;
+
+/**
+ * @brief OpenGame Plays the swap2 opening so that the board enters the standard gomoku phase.
+ */
+void OpenGame(e8::GomokuBoardState *board) {
+    int8_t const center_x = board->Width() / 2;
+    int8_t const center_y = board->Height() / 2;
+    board->ApplyAction(board->MovePositionToActionId(e8::MovePosition(center_x, center_y)),
+                       /*cached_game_result=*/std::nullopt);
+    board->ApplyAction(board->MovePositionToActionId(e8::MovePosition(center_x + 1, center_y)),
+                       /*cached_game_result=*/std::nullopt);
+    board->ApplyAction(board->MovePositionToActionId(e8::MovePosition(center_x, center_y + 1)),
+                       /*cached_game_result=*/std::nullopt);
+    board->ApplyAction(board->Swap2DecisionToActionId(e8::Swap2Decision::SW2D_CHOOSE_BLACK),
+                       /*cached_game_result=*/std::nullopt);
+}
+
+struct ApplyRetractResult {
+    double ops_per_second;
+    bool correct;
+};
+
+/**
+ * @brief BenchmarkApplyRetract Plays random games to the end then retracts them back to the
+ * opening. Each ApplyAction() and RetractAction() call counts as an operation.
+ */
+ApplyRetractResult BenchmarkApplyRetract(int16_t const width, int16_t const height) {
+    e8::GomokuBoardState board(width, height);
+    OpenGame(&board);
+    size_t const num_opening_actions = board.LegalActions().size();
+    size_t const history_size = board.History().size();
+
+    std::vector<e8::GomokuActionId> cells;
+    for (int8_t y = 0; y < height; ++y) {
+        for (int8_t x = 0; x < width; ++x) {
+            cells.push_back(board.MovePositionToActionId(e8::MovePosition(x, y)));
+        }
+    }
+
+    std::mt19937 rng(13);
+    std::vector<std::vector<e8::GomokuActionId>> playouts(kNumPlayouts, cells);
+    for (auto &playout : playouts) {
+        std::shuffle(playout.begin(), playout.end(), rng);
+    }
+
+    bool correct = true;
+    uint64_t num_ops = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (auto const &playout : playouts) {
+        unsigned num_steps = 0;
+        for (e8::GomokuActionId action_id : playout) {
+            if (board.LegalActions().find(action_id) == board.LegalActions().end()) {
+                continue;
+            }
+            ++num_steps;
+            if (board.ApplyAction(action_id, /*cached_game_result=*/std::nullopt) !=
+                e8::GameResult::GR_UNDETERMINED) {
+                break;
+            }
+        }
+        for (unsigned i = 0; i < num_steps; ++i) {
+            board.RetractAction();
+        }
+        num_ops += 2 * num_steps;
+        correct = correct && board.LegalActions().size() == num_opening_actions &&
+                  board.History().size() == history_size;
+    }
+    double elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    return ApplyRetractResult{num_ops / elapsed, correct};
+}
+
+/**
+ * @brief BenchmarkCopy Measures the cost of copying a board in the middle of a game, which is what
+ * every rollout pays before it starts.
+ */
+double BenchmarkCopyNanos(int16_t const width, int16_t const height) {
+    e8::GomokuBoardState board(width, height);
+    OpenGame(&board);
+    for (int8_t x = 0; x < width; x += 2) {
+        board.ApplyAction(board.MovePositionToActionId(e8::MovePosition(x, /*y=*/0)),
+                          /*cached_game_result=*/std::nullopt);
+        board.ApplyAction(board.MovePositionToActionId(e8::MovePosition(x, height - 1)),
+                          /*cached_game_result=*/std::nullopt);
+    }
+
+    size_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < kNumCopies; ++i) {
+        e8::GomokuBoardState copy(board);
+        checksum += copy.LegalActions().size();
+    }
+    double elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (checksum != kNumCopies * board.LegalActions().size()) {
+        return -1;
+    }
+    return elapsed * 1e9 / kNumCopies;
+}
+
+bool ApplyRetractAndCopyTest() {
+    for (int16_t size : {11, 15}) {
+        ApplyRetractResult result = BenchmarkApplyRetract(size, size);
+        double copy_nanos = BenchmarkCopyNanos(size, size);
+
+        std::cout << std::fixed << std::setprecision(1) << size << "x" << size
+                  << ": apply/retract=" << result.ops_per_second / 1e6 << "M ops/s"
+                  << " copy=" << copy_nanos << "ns" << std::endl;
+
+        TEST_CONDITION(result.correct);
+        TEST_CONDITION(copy_nanos > 0);
+    }
+
+    return true;
+}
+
+/**
+ * @brief MidGameBoards Plays random games into the middle so that there are runs to be checked.
+ */
+std::vector<e8::GomokuBoardState> MidGameBoards(int16_t const width, int16_t const height,
+                                                unsigned const num_boards) {
+    std::mt19937 rng(17);
+    std::vector<e8::GomokuBoardState> boards;
+    while (boards.size() < num_boards) {
+        e8::GomokuBoardState board(width, height);
+        OpenGame(&board);
+
+        std::vector<e8::GomokuActionId> cells;
+        for (auto const &[action_id, _] : board.LegalActions()) {
+            cells.push_back(action_id);
+        }
+        std::shuffle(cells.begin(), cells.end(), rng);
+        cells.resize(cells.size() / 3);
+
+        bool ended = false;
+        for (e8::GomokuActionId action_id : cells) {
+            if (board.ApplyAction(action_id, /*cached_game_result=*/std::nullopt) !=
+                e8::GameResult::GR_UNDETERMINED) {
+                ended = true;
+                break;
+            }
+        }
+        if (!ended) {
+            boards.push_back(board);
+        }
+    }
+    return boards;
+}
+
+bool ExpansionTest() {
+    for (int16_t size : {11, 15}) {
+        std::vector<e8::GomokuBoardState> boards = MidGameBoards(size, size, /*num_boards=*/200);
+
+        // Learns the game result of every child by trial application.
+        std::vector<e8::GameResult> trial_results;
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < 20; ++i) {
+            trial_results.clear();
+            for (auto &board : boards) {
+                e8::GomokuLegalActionSet actions = board.LegalActions();
+                for (auto const &[action_id, _] : actions) {
+                    trial_results.push_back(
+                        board.ApplyAction(action_id, /*cached_game_result=*/std::nullopt));
+                    board.RetractAction();
+                }
+            }
+        }
+        double trial_elapsed =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // Predicts them from the run length tables.
+        std::vector<e8::GameResult> predicted_results;
+        start = std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < 20; ++i) {
+            predicted_results.clear();
+            for (auto const &board : boards) {
+                for (auto const &[action_id, _] : board.LegalActions()) {
+                    predicted_results.push_back(board.GameResultAfter(action_id));
+                }
+            }
+        }
+        double predicted_elapsed =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << std::fixed << std::setprecision(1) << size << "x" << size
+                  << ": trial=" << trial_elapsed * 1e9 / (20 * trial_results.size())
+                  << "ns/child predicted="
+                  << predicted_elapsed * 1e9 / (20 * predicted_results.size()) << "ns/child"
+                  << std::endl;
+
+        TEST_CONDITION(trial_results == predicted_results);
+    }
+
+    return true;
+}
+
+} // namespace
+
+int main() {
+    e8::BeginTestSuite("board_state_benchmark");
+    e8::RunTest("ApplyRetractAndCopyTest", ApplyRetractAndCopyTest);
+    e8::RunTest("ExpansionTest", ExpansionTest);
+    e8::EndTestSuite();
+    return 0;
+}
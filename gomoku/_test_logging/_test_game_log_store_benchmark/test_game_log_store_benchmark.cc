@@ -0,0 +1,191 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/unit_test_util/unit_test_util.h"
+#include "gomoku/game/board_state.h"
+#include "gomoku/logging/common_types.h"
+#include "gomoku/logging/game_log_store.h"
+#include "postgres/query_runner/connection/connection_interface.h"
+#include "postgres/query_runner/connection/connection_reservoir_interface.h"
+#include "postgres/query_runner/reflection/sql_primitives.h"
+#include "postgres/query_runner/resultset/mock_result_set.h"
+#include "postgres/query_runner/resultset/result_set_interface.h"
+
+namespace {
+
+unsigned const kRoundTripMicros = 200;
+unsigned const kPerRowMicros = 10;
+unsigned const kNumGames = 20;
+unsigned const kNumMovesPerGame = 60;
+
+/**
+ * @brief The RoundTripConnection class Simulates a database connection where every statement
+ * costs a network round trip plus a little for each row inserted. Queries return a single record
+ * with a fresh ID in the first cell. It can be used by multiple threads at the same time.
+ */
+class RoundTripConnection : public e8::ConnectionInterface {
+  public:
+    std::unique_ptr<e8::ResultSetInterface> RunQuery(ParameterizedQuery const & /*query*/,
+                                                     QueryParams const & /*params*/,
+                                                     bool /*cache_on*/) override {
+        ++num_statements;
+        std::this_thread::sleep_for(std::chrono::microseconds(kRoundTripMicros));
+
+        auto result = std::make_unique<e8::MockResultSet>(kMaxNumCells);
+        e8::MockResultSet::Record record(kMaxNumCells);
+        record[0] = std::make_shared<e8::SqlLong>(++next_id_);
+        result->AddRecord(record);
+        return result;
+    }
+
+    uint64_t RunUpdate(ParameterizedQuery const &query, QueryParams const & /*params*/,
+                       bool /*cache_on*/) override {
+        // Each row of the VALUES list starts with its first parameter.
+        uint64_t num_rows = 0;
+        for (size_t pos = query.find("($"); pos != std::string::npos;
+             pos = query.find("($", pos + 1)) {
+            ++num_rows;
+        }
+
+        ++num_statements;
+        num_rows_written += num_rows;
+        std::this_thread::sleep_for(std::chrono::microseconds(kRoundTripMicros) +
+                                    std::chrono::microseconds(kPerRowMicros) * num_rows);
+        return num_rows;
+    }
+
+    bool IsClosed() const override { return false; }
+
+    std::atomic<uint64_t> num_statements{0};
+    std::atomic<uint64_t> num_rows_written{0};
+
+  private:
+    static unsigned const kMaxNumCells = 16;
+
+    std::atomic<int64_t> next_id_{0};
+};
+
+/**
+ * @brief The SharedConnectionReservoir class Hands out the same thread-safe connection.
+ */
+class SharedConnectionReservoir : public e8::ConnectionReservoirInterface {
+  public:
+    explicit SharedConnectionReservoir(RoundTripConnection *conn) : conn_(conn) {}
+
+    e8::ConnectionInterface *Take() override { return conn_; }
+    void Put(e8::ConnectionInterface * /*conn*/) override {}
+    void CloseAll() override {}
+
+  private:
+    RoundTripConnection *conn_;
+};
+
+/**
+ * @brief PlayGames Logs what the learning material generator logs for kNumGames games of
+ * kNumMovesPerGame moves.
+ */
+void PlayGames(e8::GameLogStore *log_store) {
+    e8::GomokuBoardState board(/*width=*/11, /*height=*/11);
+    std::vector<float> shl_map(board.Width() * board.Height(), 0.5f);
+    std::vector<float> top_shl_features(32, 0.5f);
+    std::vector<float> stochastic_policy(board.Width() * board.Height(), 0.01f);
+
+    for (unsigned i = 0; i < kNumGames; ++i) {
+        e8::GameId game_id = log_store->LogNewGeneratorGame(e8::GLP_LEARNING_DATA,
+                                                            /*player_a_model_id=*/1,
+                                                            /*player_b_model_id=*/1);
+        for (e8::GameStepNumber step = 0; step < kNumMovesPerGame; ++step) {
+            log_store->LogGameAction(game_id, step, /*action_number=*/step,
+                                     step % 2 == 0 ? e8::PS_PLAYER_A : e8::PS_PLAYER_B,
+                                     step % 2 == 0 ? e8::ST_BLACK : e8::ST_WHITE, board,
+                                     e8::GP_STANDARD_GOMOKU, shl_map, top_shl_features,
+                                     stochastic_policy);
+        }
+        for (e8::GameStepNumber step = 0; step < kNumMovesPerGame; ++step) {
+            log_store->LogGameActionValue(game_id, step, step % 2 == 0 ? 1.0f : -1.0f);
+        }
+        log_store->LogGameEnd(game_id, kNumMovesPerGame, e8::GR_PLAYER_A_WIN);
+    }
+
+    log_store->Flush();
+}
+
+struct LoggingResult {
+    double moves_per_second;
+    uint64_t num_statements;
+    uint64_t num_rows_written;
+};
+
+LoggingResult RunLogging(std::optional<unsigned> max_num_pending_games) {
+    RoundTripConnection conn;
+    SharedConnectionReservoir conns(&conn);
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        std::unique_ptr<e8::GameLogStore> log_store;
+        if (max_num_pending_games.has_value()) {
+            log_store = std::make_unique<e8::GameLogStore>(&conns, *max_num_pending_games);
+        } else {
+            log_store = std::make_unique<e8::GameLogStore>(&conns);
+        }
+        PlayGames(log_store.get());
+    }
+    double elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    return LoggingResult{kNumGames * kNumMovesPerGame / elapsed, conn.num_statements,
+                         conn.num_rows_written};
+}
+
+bool BufferedLoggingTest() {
+    LoggingResult unbuffered = RunLogging(/*max_num_pending_games=*/std::nullopt);
+    LoggingResult buffered = RunLogging(/*max_num_pending_games=*/4);
+
+    std::cout << std::fixed << std::setprecision(1) << "unbuffered: " << unbuffered.moves_per_second
+              << " moves/s statements=" << unbuffered.num_statements
+              << " rows=" << unbuffered.num_rows_written << std::endl;
+    std::cout << std::fixed << std::setprecision(1) << "buffered: " << buffered.moves_per_second
+              << " moves/s statements=" << buffered.num_statements
+              << " rows=" << buffered.num_rows_written << std::endl;
+
+    // Buffering writes each game and action row exactly once.
+    TEST_CONDITION(buffered.num_rows_written == kNumGames * (1 + kNumMovesPerGame));
+    TEST_CONDITION(buffered.num_statements < unbuffered.num_statements / 10);
+    TEST_CONDITION(buffered.moves_per_second > unbuffered.moves_per_second);
+
+    return true;
+}
+
+} // namespace
+
+int main() {
+    e8::BeginTestSuite("game_log_store_benchmark");
+    e8::RunTest("BufferedLoggingTest", BufferedLoggingTest);
+    e8::EndTestSuite();
+    return 0;
+}
@@ -15,6 +15,7 @@ DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs depr
 INCLUDEPATH += $$PWD/../../
 
 SOURCES += \
+    heuristics/batching_evaluator.cc \
     heuristics/contour.cc \
     heuristics/evaluator.cc \
     heuristics/light_rollout_evaluator.cc \
@@ -25,9 +26,12 @@ SOURCES += \
     heuristics/tflite_zero_prior_evaluator.cc \
     mcts_agent_player.cc \
     search/mct_node.cc \
-    search/mct_search.cc
+    search/mct_search.cc \
+    search/puct_selection.cc \
+    search/transposition_table.cc
 
 HEADERS += \
+    heuristics/batching_evaluator.h \
     heuristics/contour.h \
     heuristics/evaluator.h \
     heuristics/light_rollout_evaluator.h \
@@ -38,7 +42,9 @@ HEADERS += \
     heuristics/tflite_zero_prior_evaluator.h \
     mcts_agent_player.h \
     search/mct_node.h \
-    search/mct_search.h
+    search/mct_search.h \
+    search/puct_selection.h \
+    search/transposition_table.h
 
 # Default rules for deployment.
 unix {
@@ -0,0 +1,168 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "common/time_util/time_util.h"
+#include "gomoku/agent/heuristics/batching_evaluator.h"
+#include "gomoku/agent/heuristics/evaluator.h"
+#include "gomoku/agent/search/mct_node.h"
+#include "gomoku/game/board_state.h"
+
+namespace e8 {
+
+float GomokuBatchingEvaluator::Stats::MeanBatchSize() const {
+    if (num_batches == 0) {
+        return 0.0f;
+    }
+    return static_cast<float>(num_requests) / num_batches;
+}
+
+GomokuBatchingEvaluator::GomokuBatchingEvaluator(
+    std::shared_ptr<GomokuEvaluatorInterface> const &evaluator, unsigned max_batch_size,
+    TimestampMicros max_delay)
+    : evaluator_(evaluator), max_batch_size_(max_batch_size), max_delay_(max_delay),
+      num_queued_requests_(0) {
+    assert(max_batch_size_ > 0);
+}
+
+float GomokuBatchingEvaluator::EvaluateReward(GomokuBoardState const &state,
+                                              std::optional<MctNodeId> parent_state_id,
+                                              MctNodeId state_id) {
+    this->LockEvaluator();
+    float reward = evaluator_->EvaluateReward(state, parent_state_id, state_id);
+    this->UnlockEvaluator();
+    return reward;
+}
+
+std::unordered_map<GomokuActionId, float>
+GomokuBatchingEvaluator::EvaluatePolicy(GomokuBoardState const &state,
+                                        std::optional<MctNodeId> parent_state_id,
+                                        MctNodeId state_id) {
+    this->LockEvaluator();
+    std::unordered_map<GomokuActionId, float> policy =
+        evaluator_->EvaluatePolicy(state, parent_state_id, state_id);
+    this->UnlockEvaluator();
+    return policy;
+}
+
+std::vector<GomokuEvaluation>
+GomokuBatchingEvaluator::EvaluateBatch(std::vector<GomokuEvaluationRequest> const &requests) {
+    QueuedCall call{&requests, /*evaluations=*/{}, /*taken=*/false, /*done=*/false};
+
+    std::unique_lock<std::mutex> lock(queue_lock_);
+
+    queue_.push_back(&call);
+    num_queued_requests_ += requests.size();
+    ++stats_.num_calls;
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(max_delay_);
+    while (!call.done) {
+        if (!call.taken && (num_queued_requests_ >= max_batch_size_ ||
+                            std::chrono::steady_clock::now() >= deadline)) {
+            this->RunMergedCall(&lock);
+        } else if (call.taken) {
+            calls_done_.wait(lock);
+        } else {
+            calls_done_.wait_until(lock, deadline);
+        }
+    }
+
+    return std::move(call.evaluations);
+}
+
+unsigned GomokuBatchingEvaluator::EvaluationBatchSize() const {
+    return evaluator_->EvaluationBatchSize();
+}
+
+float GomokuBatchingEvaluator::ExplorationFactor() const {
+    return evaluator_->ExplorationFactor();
+}
+
+unsigned GomokuBatchingEvaluator::NumSimulations() const { return evaluator_->NumSimulations(); }
+
+void GomokuBatchingEvaluator::ClearCache() {}
+
+bool GomokuBatchingEvaluator::ThreadSafe() const { return true; }
+
+GomokuBatchingEvaluator::Stats GomokuBatchingEvaluator::GetStats() {
+    queue_lock_.lock();
+    Stats stats = stats_;
+    queue_lock_.unlock();
+    return stats;
+}
+
+void GomokuBatchingEvaluator::RunMergedCall(std::unique_lock<std::mutex> *queue_lock) {
+    std::vector<QueuedCall *> calls;
+    calls.swap(queue_);
+    for (QueuedCall *call : calls) {
+        call->taken = true;
+    }
+
+    ++stats_.num_batches;
+    stats_.num_requests += num_queued_requests_;
+    num_queued_requests_ = 0;
+
+    queue_lock->unlock();
+
+    std::vector<GomokuEvaluationRequest> merged_requests;
+    for (QueuedCall const *call : calls) {
+        merged_requests.insert(merged_requests.end(), call->requests->begin(),
+                               call->requests->end());
+    }
+
+    this->LockEvaluator();
+    std::vector<GomokuEvaluation> evaluations = evaluator_->EvaluateBatch(merged_requests);
+    this->UnlockEvaluator();
+    assert(evaluations.size() == merged_requests.size());
+
+    // The callers don't look at their evaluations until they are marked done under the queue lock.
+    auto it = evaluations.begin();
+    for (QueuedCall *call : calls) {
+        auto end = it + call->requests->size();
+        call->evaluations.assign(std::make_move_iterator(it), std::make_move_iterator(end));
+        it = end;
+    }
+
+    queue_lock->lock();
+    for (QueuedCall *call : calls) {
+        call->done = true;
+    }
+    calls_done_.notify_all();
+}
+
+void GomokuBatchingEvaluator::LockEvaluator() {
+    if (!evaluator_->ThreadSafe()) {
+        evaluator_lock_.lock();
+    }
+}
+
+void GomokuBatchingEvaluator::UnlockEvaluator() {
+    if (!evaluator_->ThreadSafe()) {
+        evaluator_lock_.unlock();
+    }
+}
+
+} // namespace e8
@@ -0,0 +1,139 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BATCHING_EVALUATOR_H
+#define BATCHING_EVALUATOR_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "common/time_util/time_util.h"
+#include "gomoku/agent/heuristics/evaluator.h"
+#include "gomoku/agent/search/mct_node.h"
+#include "gomoku/game/board_state.h"
+
+namespace e8 {
+
+/**
+ * @brief The GomokuBatchingEvaluator class Lets many searchers, each running on its own thread,
+ * share one underlying evaluator through a single inference queue. The EvaluateBatch() calls from
+ * the searchers are queued and merged into one EvaluateBatch() call to the underlying evaluator
+ * once the queue holds max_batch_size requests, or the oldest queued call has waited for
+ * max_delay. Whichever caller triggers the merged call runs it, so there is no dedicated inference
+ * thread. The underlying evaluator is called by one thread at a time unless it's thread safe.
+ *
+ * It pays off for evaluators running a neural network, where the cost of a batch barely grows with
+ * its size. Rollout based evaluators are merely serialized by it.
+ */
+class GomokuBatchingEvaluator : public GomokuEvaluatorInterface {
+  public:
+    /**
+     * @brief The Stats struct Batching effectiveness counters.
+     */
+    struct Stats {
+        uint64_t num_calls = 0;
+        uint64_t num_batches = 0;
+        uint64_t num_requests = 0;
+
+        /**
+         * @brief MeanBatchSize The average number of requests sent to the underlying evaluator per
+         * merged call. Returns 0 when there is no call yet.
+         */
+        float MeanBatchSize() const;
+    };
+
+    /**
+     * @brief GomokuBatchingEvaluator Constructs a queue in front of the evaluator.
+     *
+     * @param evaluator The underlying evaluator.
+     * @param max_batch_size The number of queued requests which triggers a merged call. It's
+     * typically the number of searchers times the evaluator's EvaluationBatchSize().
+     * @param max_delay The longest time a call waits for the queue to fill up.
+     */
+    GomokuBatchingEvaluator(std::shared_ptr<GomokuEvaluatorInterface> const &evaluator,
+                            unsigned max_batch_size, TimestampMicros max_delay);
+    GomokuBatchingEvaluator(GomokuBatchingEvaluator const &) = delete;
+    ~GomokuBatchingEvaluator() override = default;
+
+    float EvaluateReward(GomokuBoardState const &state, std::optional<MctNodeId> parent_state_id,
+                         MctNodeId state_id) override;
+
+    std::unordered_map<GomokuActionId, float>
+    EvaluatePolicy(GomokuBoardState const &state, std::optional<MctNodeId> parent_state_id,
+                   MctNodeId state_id) override;
+
+    std::vector<GomokuEvaluation>
+    EvaluateBatch(std::vector<GomokuEvaluationRequest> const &requests) override;
+
+    unsigned EvaluationBatchSize() const override;
+
+    float ExplorationFactor() const override;
+
+    unsigned NumSimulations() const override;
+
+    /**
+     * @brief ClearCache Does nothing. Every searcher clears the cache once per move, which would
+     * throw away the evaluations the other searchers still reuse. Clear the cache of the underlying
+     * evaluator directly when it isn't shared anymore.
+     */
+    void ClearCache() override;
+
+    bool ThreadSafe() const override;
+
+    /**
+     * @brief GetStats Returns a snapshot of the batching effectiveness counters.
+     */
+    Stats GetStats();
+
+  private:
+    struct QueuedCall {
+        std::vector<GomokuEvaluationRequest> const *requests;
+        std::vector<GomokuEvaluation> evaluations;
+
+        // Whether a merged call has picked up the requests.
+        bool taken;
+
+        // Whether the evaluations have been filled.
+        bool done;
+    };
+
+    void RunMergedCall(std::unique_lock<std::mutex> *queue_lock);
+
+    void LockEvaluator();
+    void UnlockEvaluator();
+
+    std::shared_ptr<GomokuEvaluatorInterface> evaluator_;
+    unsigned const max_batch_size_;
+    TimestampMicros const max_delay_;
+
+    std::vector<QueuedCall *> queue_;
+    unsigned num_queued_requests_;
+    std::mutex queue_lock_;
+    std::condition_variable calls_done_;
+    Stats stats_;
+
+    std::mutex evaluator_lock_;
+};
+
+} // namespace e8
+
+#endif // BATCHING_EVALUATOR_H
@@ -15,6 +15,31 @@
  * not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <unordered_map>
+#include <vector>
+
 #include "gomoku/agent/heuristics/evaluator.h"
+#include "gomoku/game/board_state.h"
+
+namespace e8 {
+
+std::vector<GomokuEvaluation>
+GomokuEvaluatorInterface::EvaluateBatch(std::vector<GomokuEvaluationRequest> const &requests) {
+    std::vector<GomokuEvaluation> evaluations(requests.size());
+    for (unsigned i = 0; i < requests.size(); ++i) {
+        GomokuEvaluationRequest const &request = requests[i];
+        evaluations[i].policy =
+            this->EvaluatePolicy(*request.state, request.parent_state_id, request.state_id);
+        if (request.reward_needed) {
+            evaluations[i].reward =
+                this->EvaluateReward(*request.state, request.parent_state_id, request.state_id);
+        }
+    }
+    return evaluations;
+}
+
+unsigned GomokuEvaluatorInterface::EvaluationBatchSize() const { return 1; }
+
+bool GomokuEvaluatorInterface::ThreadSafe() const { return false; }
 
-namespace e8 {} // namespace e8
+} // namespace e8
@@ -21,12 +21,39 @@
 #include <cstdint>
 #include <optional>
 #include <unordered_map>
+#include <vector>
 
 #include "gomoku/agent/search/mct_node.h"
 #include "gomoku/game/board_state.h"
 
 namespace e8 {
 
+/**
+ * @brief The GomokuEvaluationRequest struct A state to be evaluated as part of a batch. See
+ * GomokuEvaluatorInterface::EvaluateBatch().
+ */
+struct GomokuEvaluationRequest {
+    GomokuBoardState const *state;
+    std::optional<MctNodeId> parent_state_id;
+    MctNodeId state_id;
+
+    // Whether the reward is needed on top of the policy.
+    bool reward_needed;
+};
+
+/**
+ * @brief The GomokuEvaluation struct The reward and policy estimation of a state, both in the
+ * perspective of the current player. The reward is left unspecified if it isn't requested.
+ */
+struct GomokuEvaluation {
+    float reward;
+    std::unordered_map<GomokuActionId, float> policy;
+};
+
+// The number of leaves the evaluators running a neural network prefer per EvaluateBatch() call.
+// Their input tensors aren't bound to it. See GomokuEvaluatorInterface::EvaluationBatchSize().
+unsigned const kNeuralNetworkEvaluationBatchSize = 8;
+
 /**
  * @brief The GomokuEvaluatorInterface class A gomoku agent heuristics is responsible for
  * estimating the reward and policy at a given game state.
@@ -43,7 +70,9 @@ class GomokuEvaluatorInterface {
      * @param parent_state_id ID of the parent state. This ID is supplied to this function just to
      * save computation by implementing incremental operations. The function should not depend on
      * this field for correct resuult.
-     * @param state_id Different states are guaranteed to have different state_id.
+     * @param state_id A hash of the position. Equal positions share an id, even when reached
+     * through different action sequences, while distinct positions collide with negligible
+     * probability.
      */
     virtual float EvaluateReward(GomokuBoardState const &state,
                                  std::optional<MctNodeId> parent_state_id, MctNodeId state_id) = 0;
@@ -55,12 +84,32 @@ class GomokuEvaluatorInterface {
      * @param parent_state_id ID of the parent state. This ID is supplied to this function just to
      * save computation by implementing incremental operations. The function should not depend on
      * this field for correct resuult.
-     * @param state_id Different states are guaranteed to have different state_id.
+     * @param state_id A hash of the position. Equal positions share an id, even when reached
+     * through different action sequences, while distinct positions collide with negligible
+     * probability.
      */
     virtual std::unordered_map<GomokuActionId, float>
     EvaluatePolicy(GomokuBoardState const &state, std::optional<MctNodeId> parent_state_id,
                    MctNodeId state_id) = 0;
 
+    /**
+     * @brief EvaluateBatch Estimate the policy, and the reward if requested, for a batch of states
+     * in one go. Evaluators running a neural network should override it to fill the network's
+     * input with the whole batch. By default, it calls EvaluatePolicy() then EvaluateReward() on
+     * each of the requests.
+     *
+     * @return Evaluations in the same order as the requests.
+     */
+    virtual std::vector<GomokuEvaluation>
+    EvaluateBatch(std::vector<GomokuEvaluationRequest> const &requests);
+
+    /**
+     * @brief EvaluationBatchSize The number of pending leaves the tree search should collect
+     * before evaluating them through EvaluateBatch(). The leaves are picked under virtual loss so
+     * the larger the batch, the more the search deviates from a sequential one.
+     */
+    virtual unsigned EvaluationBatchSize() const;
+
     /**
      * @brief ExplorationFactor How exaggerated the upper confidence bound should it be for this
      * heuristics.
@@ -77,6 +126,12 @@ class GomokuEvaluatorInterface {
      * @brief ClearCache Clears any cached information.
      */
     virtual void ClearCache() = 0;
+
+    /**
+     * @brief ThreadSafe Whether EvaluateReward() and EvaluatePolicy() can be called concurrently.
+     * If not, a multi-threaded tree search serializes the calls.
+     */
+    virtual bool ThreadSafe() const;
 };
 
 } // namespace e8
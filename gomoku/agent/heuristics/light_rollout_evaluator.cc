@@ -23,6 +23,7 @@
 #include <optional>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "common/random/random_distribution.h"
 #include "common/random/random_source.h"
@@ -170,6 +171,7 @@ bool RolloutTask::DropResourceOnCompletion() const { return false; }
 
 struct GomokuLightRolloutEvaluator::GomokuLightRolloutEvaluatorInternal {
     ThreadPool thread_pool;
+    TaskCompletionChannel rollout_channel;
     RandomSource random_source;
     std::unordered_map<MctNodeId, std::shared_ptr<ContourBuilder>> contour_cache;
 
@@ -222,17 +224,18 @@ float GomokuLightRolloutEvaluator::EvaluateReward(GomokuBoardState const &state,
 
         unsigned const num_parallelism = pimpl_->thread_pool.NumWorkers();
         // unsigned const num_parallelism = 1;
+        std::vector<std::unique_ptr<TaskStorageInterface>> rollouts;
         for (unsigned job_idx = 0; job_idx < num_parallelism; ++job_idx) {
-            auto rollout_data = std::make_unique<RolloutData>(
-                state, *contour_cache_it->second, kNumValueSamples / num_parallelism, job_idx);
-            pimpl_->thread_pool.Schedule(task, std::move(rollout_data));
+            rollouts.push_back(std::make_unique<RolloutData>(
+                state, *contour_cache_it->second, kNumValueSamples / num_parallelism, job_idx));
         }
+        pimpl_->thread_pool.ScheduleMany(task, std::move(rollouts), &pimpl_->rollout_channel);
 
         float reward_diff = 0.0f;
         float total_reward = 0.0f;
         for (unsigned i = 0; i < num_parallelism; ++i) {
             std::unique_ptr<TaskStorageInterface> rollout_data =
-                pimpl_->thread_pool.WaitForNextCompleted();
+                pimpl_->rollout_channel.WaitForNextCompleted();
             float wins = static_cast<RolloutData *>(rollout_data.get())
                              ->AccumulatedRewardFor(state.CurrentPlayerSide());
             float losses = static_cast<RolloutData *>(rollout_data.get())
@@ -18,11 +18,13 @@
 #include <cassert>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <memory>
 #include <optional>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "gomoku/agent/heuristics/evaluator.h"
@@ -40,13 +42,33 @@
 namespace e8 {
 namespace {
 
-void WriteBoard(GomokuBoardState const &state, TF_Tensor *board) {
-    assert(TF_NumDims(board) == 3);
-    assert(TF_Dim(board, /*dim_index=*/0) == 1);
-    assert(TF_Dim(board, /*dim_index=*/1) == state.Width());
-    assert(TF_Dim(board, /*dim_index=*/2) == state.Height());
+void DoNotDeallocate(void * /*data*/, size_t /*len*/, void * /*arg*/) {}
 
-    uint8_t *tensor_memory = static_cast<uint8_t *>(TF_TensorData(board));
+/**
+ * @brief LeadingRowsOf A tensor of the first rows of the batch tensor. It shares the memory of the
+ * batch tensor, which has to outlive it.
+ */
+TF_Tensor *LeadingRowsOf(TF_Tensor *batch, unsigned const num_rows) {
+    assert(TF_Dim(batch, /*dim_index=*/0) >= num_rows);
+
+    std::vector<int64_t> dims(TF_NumDims(batch));
+    dims[0] = num_rows;
+    for (unsigned i = 1; i < dims.size(); ++i) {
+        dims[i] = TF_Dim(batch, i);
+    }
+    size_t len = TF_TensorByteSize(batch) / TF_Dim(batch, /*dim_index=*/0) * num_rows;
+    return TF_NewTensor(TF_TensorType(batch), dims.data(), dims.size(), TF_TensorData(batch), len,
+                        DoNotDeallocate, /*deallocator_arg=*/nullptr);
+}
+
+void WriteBoard(GomokuBoardState const &state, unsigned const batch_idx, TF_Tensor *boards) {
+    assert(TF_NumDims(boards) == 3);
+    assert(TF_Dim(boards, /*dim_index=*/0) > batch_idx);
+    assert(TF_Dim(boards, /*dim_index=*/1) == state.Width());
+    assert(TF_Dim(boards, /*dim_index=*/2) == state.Height());
+
+    uint8_t *tensor_memory =
+        static_cast<uint8_t *>(TF_TensorData(boards)) + batch_idx * state.Width() * state.Height();
 
     for (int16_t y = 0; y < state.Height(); ++y) {
         for (int16_t x = 0; x < state.Width(); ++x) {
@@ -55,31 +77,34 @@ void WriteBoard(GomokuBoardState const &state, TF_Tensor *board) {
     }
 }
 
-void WriteGamePhase(GomokuBoardState const &state, TF_Tensor *game_phase) {
-    assert(TF_NumDims(game_phase) == 1);
-    assert(TF_Dim(game_phase, /*dim_index=*/0) == 1);
+void WriteGamePhase(GomokuBoardState const &state, unsigned const batch_idx,
+                    TF_Tensor *game_phases) {
+    assert(TF_NumDims(game_phases) == 1);
+    assert(TF_Dim(game_phases, /*dim_index=*/0) > batch_idx);
 
-    uint8_t *tensor_memory = static_cast<uint8_t *>(TF_TensorData(game_phase));
-    *tensor_memory = state.CurrentGamePhase();
+    uint8_t *tensor_memory = static_cast<uint8_t *>(TF_TensorData(game_phases));
+    tensor_memory[batch_idx] = state.CurrentGamePhase();
 }
 
-void WriteNextMoveStoneType(GomokuBoardState const &state, TF_Tensor *next_move_stone_type) {
-    assert(TF_NumDims(next_move_stone_type) == 1);
-    assert(TF_Dim(next_move_stone_type, /*dim_index=*/0) == 1);
+void WriteNextMoveStoneType(GomokuBoardState const &state, unsigned const batch_idx,
+                            TF_Tensor *next_move_stone_types) {
+    assert(TF_NumDims(next_move_stone_types) == 1);
+    assert(TF_Dim(next_move_stone_types, /*dim_index=*/0) > batch_idx);
 
-    uint8_t *tensor_memory = static_cast<uint8_t *>(TF_TensorData(next_move_stone_type));
-    *tensor_memory = state.PlayerStoneType(state.CurrentPlayerSide());
+    uint8_t *tensor_memory = static_cast<uint8_t *>(TF_TensorData(next_move_stone_types));
+    tensor_memory[batch_idx] = state.PlayerStoneType(state.CurrentPlayerSide());
 }
 
 void WriteShlMap(GomokuBoardState const &state, std::vector<float> const &shl_map,
-                 TF_Tensor *shl_map_tensor) {
+                 unsigned const batch_idx, TF_Tensor *shl_map_tensor) {
     assert(TF_NumDims(shl_map_tensor) == 4);
-    assert(TF_Dim(shl_map_tensor, /*dim_index=*/0) == 1);
+    assert(TF_Dim(shl_map_tensor, /*dim_index=*/0) > batch_idx);
     assert(TF_Dim(shl_map_tensor, /*dim_index=*/1) == state.Width());
     assert(TF_Dim(shl_map_tensor, /*dim_index=*/2) == state.Height());
     assert(TF_Dim(shl_map_tensor, /*dim_index=*/3) == 4);
 
-    float *tensor_memory = static_cast<float *>(TF_TensorData(shl_map_tensor));
+    float *tensor_memory = static_cast<float *>(TF_TensorData(shl_map_tensor)) +
+                           batch_idx * state.Width() * state.Height() * 4;
 
     for (int16_t y = 0; y < state.Height(); ++y) {
         for (int16_t x = 0; x < state.Width(); ++x) {
@@ -92,16 +117,18 @@ void WriteShlMap(GomokuBoardState const &state, std::vector<float> const &shl_ma
 }
 
 std::unordered_map<GomokuActionId, float> RenormalizePolicy(GomokuBoardState const &state,
+                                                            unsigned const batch_idx,
                                                             TF_Tensor const *policy_tensor) {
     std::unordered_map<GomokuActionId, float> policy;
 
     assert(TF_NumDims(policy_tensor) == 2);
-    assert(TF_Dim(policy_tensor, /*dim_index=*/0) == 1);
+    assert(TF_Dim(policy_tensor, /*dim_index=*/0) > batch_idx);
     auto [lo, hi] = state.ActionIdRange();
     assert(TF_Dim(policy_tensor, /*dim_index=*/1) == hi - lo + 1);
 
     // Re-normalizes and stores the policy into the map.
-    float *policy_tensor_memory = static_cast<float *>(TF_TensorData(policy_tensor));
+    float *policy_tensor_memory =
+        static_cast<float *>(TF_TensorData(policy_tensor)) + batch_idx * (hi - lo + 1);
 
     float norm_factor = 0;
     for (auto const &[action_id, _] : state.LegalActions()) {
@@ -120,8 +147,15 @@ struct GomokuShlModelEvaluator::GomokuShlModelEvaluatorInternal {
     GomokuShlModelEvaluatorInternal(std::string const &model_path);
     ~GomokuShlModelEvaluatorInternal();
 
-    std::unordered_map<GomokuActionId, float> ModelBasedPolicy(GomokuBoardState const &state,
-                                                               std::vector<float> const &shl_map);
+    std::vector<std::unordered_map<GomokuActionId, float>>
+    ModelBasedPolicies(std::vector<GomokuBoardState const *> const &states,
+                       std::vector<std::vector<float>> const &shl_maps);
+    void RunInference(std::vector<GomokuBoardState const *> const &states,
+                      std::vector<std::vector<float>> const &shl_maps,
+                      std::vector<std::unordered_map<GomokuActionId, float>> *policies);
+    void AllocateInputs(GomokuBoardState const &state, unsigned const num_rows);
+    std::vector<float> ShlMapOf(GomokuBoardState const &state,
+                                std::optional<MctNodeId> parent_state_id, MctNodeId state_id);
 
     TF_Session *session = nullptr;
     TF_Graph *graph = nullptr;
@@ -166,41 +200,89 @@ GomokuShlModelEvaluator::GomokuShlModelEvaluatorInternal::~GomokuShlModelEvaluat
     TF_DeleteStatus(status);
 }
 
-std::unordered_map<GomokuActionId, float>
-GomokuShlModelEvaluator::GomokuShlModelEvaluatorInternal::ModelBasedPolicy(
-    GomokuBoardState const &state, std::vector<float> const &shl_map) {
-    if (board_input_value == nullptr) {
-        // Allocate tensors when it's the first time running inference.
-        int64_t board_dims[] = {1, state.Height(), state.Width()};
-        board_input_value =
-            TF_AllocateTensor(TF_UINT8, board_dims,
-                              /*num_dims=*/sizeof(board_dims) / sizeof(int64_t),
-                              /*len=*/board_dims[0] * board_dims[1] * board_dims[2]);
-
-        int64_t game_phase_dims[] = {1};
-        game_phase_input_value =
-            TF_AllocateTensor(TF_UINT8, game_phase_dims,
-                              /*num_dims=*/sizeof(game_phase_dims) / sizeof(int64_t),
-                              /*len=*/game_phase_dims[0]);
-
-        int64_t next_move_stone_type_dims[] = {1};
-        next_move_stone_type_input_value =
-            TF_AllocateTensor(TF_UINT8, next_move_stone_type_dims,
-                              /*num_dims=*/sizeof(next_move_stone_type_dims) / sizeof(int64_t),
-                              /*len=*/next_move_stone_type_dims[0]);
-
-        int64_t shl_map_dims[] = {1, state.Height(), state.Width(), 4};
-        shl_map_input_value =
-            TF_AllocateTensor(TF_FLOAT, shl_map_dims,
-                              /*num_dims=*/sizeof(shl_map_dims) / sizeof(int64_t),
-                              /*len=*/shl_map_dims[0] * shl_map_dims[1] * shl_map_dims[2] *
-                                  shl_map_dims[3] * sizeof(float));
+void GomokuShlModelEvaluator::GomokuShlModelEvaluatorInternal::AllocateInputs(
+    GomokuBoardState const &state, unsigned const num_rows) {
+    if (board_input_value != nullptr) {
+        assert(TF_Dim(board_input_value, /*dim_index=*/1) == state.Height());
+        assert(TF_Dim(board_input_value, /*dim_index=*/2) == state.Width());
+        if (TF_Dim(board_input_value, /*dim_index=*/0) >= num_rows) {
+            return;
+        }
+
+        TF_DeleteTensor(board_input_value);
+        TF_DeleteTensor(game_phase_input_value);
+        TF_DeleteTensor(next_move_stone_type_input_value);
+        TF_DeleteTensor(shl_map_input_value);
     }
 
-    WriteBoard(state, board_input_value);
-    WriteGamePhase(state, game_phase_input_value);
-    WriteNextMoveStoneType(state, next_move_stone_type_input_value);
-    WriteShlMap(state, shl_map, shl_map_input_value);
+    // The tensors only grow, to the largest batch so far. A smaller batch runs on the leading rows
+    // of them. See LeadingRowsOf().
+    int64_t board_dims[] = {num_rows, state.Height(), state.Width()};
+    board_input_value =
+        TF_AllocateTensor(TF_UINT8, board_dims,
+                          /*num_dims=*/sizeof(board_dims) / sizeof(int64_t),
+                          /*len=*/board_dims[0] * board_dims[1] * board_dims[2]);
+    std::memset(TF_TensorData(board_input_value), 0, TF_TensorByteSize(board_input_value));
+
+    int64_t game_phase_dims[] = {num_rows};
+    game_phase_input_value =
+        TF_AllocateTensor(TF_UINT8, game_phase_dims,
+                          /*num_dims=*/sizeof(game_phase_dims) / sizeof(int64_t),
+                          /*len=*/game_phase_dims[0]);
+    std::memset(TF_TensorData(game_phase_input_value), 0,
+                TF_TensorByteSize(game_phase_input_value));
+
+    int64_t next_move_stone_type_dims[] = {num_rows};
+    next_move_stone_type_input_value =
+        TF_AllocateTensor(TF_UINT8, next_move_stone_type_dims,
+                          /*num_dims=*/sizeof(next_move_stone_type_dims) / sizeof(int64_t),
+                          /*len=*/next_move_stone_type_dims[0]);
+    std::memset(TF_TensorData(next_move_stone_type_input_value), 0,
+                TF_TensorByteSize(next_move_stone_type_input_value));
+
+    int64_t shl_map_dims[] = {num_rows, state.Height(), state.Width(), 4};
+    shl_map_input_value =
+        TF_AllocateTensor(TF_FLOAT, shl_map_dims,
+                          /*num_dims=*/sizeof(shl_map_dims) / sizeof(int64_t),
+                          /*len=*/shl_map_dims[0] * shl_map_dims[1] * shl_map_dims[2] *
+                              shl_map_dims[3] * sizeof(float));
+    std::memset(TF_TensorData(shl_map_input_value), 0, TF_TensorByteSize(shl_map_input_value));
+}
+
+std::vector<float> GomokuShlModelEvaluator::GomokuShlModelEvaluatorInternal::ShlMapOf(
+    GomokuBoardState const &state, std::optional<MctNodeId> parent_state_id, MctNodeId state_id) {
+    ShlFeatureBuilder const &feature_builder =
+        shl_rollout_evaluator.GetFeatureBuilderForState(state, parent_state_id, state_id);
+    return feature_builder.TopKMapDense(/*top_k=*/15, /*normalized=*/true,
+                                        /*next_move_stone_type=*/std::nullopt);
+}
+
+std::vector<std::unordered_map<GomokuActionId, float>>
+GomokuShlModelEvaluator::GomokuShlModelEvaluatorInternal::ModelBasedPolicies(
+    std::vector<GomokuBoardState const *> const &states,
+    std::vector<std::vector<float>> const &shl_maps) {
+    assert(!states.empty());
+    assert(states.size() == shl_maps.size());
+
+    std::vector<std::unordered_map<GomokuActionId, float>> policies;
+    policies.reserve(states.size());
+
+    this->AllocateInputs(*states[0], states.size());
+    this->RunInference(states, shl_maps, &policies);
+
+    return policies;
+}
+
+void GomokuShlModelEvaluator::GomokuShlModelEvaluatorInternal::RunInference(
+    std::vector<GomokuBoardState const *> const &states,
+    std::vector<std::vector<float>> const &shl_maps,
+    std::vector<std::unordered_map<GomokuActionId, float>> *policies) {
+    for (unsigned i = 0; i < states.size(); ++i) {
+        WriteBoard(*states[i], i, board_input_value);
+        WriteGamePhase(*states[i], i, game_phase_input_value);
+        WriteNextMoveStoneType(*states[i], i, next_move_stone_type_input_value);
+        WriteShlMap(*states[i], shl_maps[i], i, shl_map_input_value);
+    }
 
     TF_Operation *board_input_op = TF_GraphOperationByName(graph, /*oper_name=*/"inference_boards");
     assert(board_input_op != nullptr);
@@ -222,8 +304,10 @@ GomokuShlModelEvaluator::GomokuShlModelEvaluatorInternal::ModelBasedPolicy(
     TF_Output shl_map_input = TF_Output{shl_map_input_op, 0};
 
     TF_Output inputs[] = {board_input, game_phase_input, next_move_stone_type_input, shl_map_input};
-    TF_Tensor *input_values[] = {board_input_value, game_phase_input_value,
-                                 next_move_stone_type_input_value, shl_map_input_value};
+    TF_Tensor *input_values[] = {LeadingRowsOf(board_input_value, states.size()),
+                                 LeadingRowsOf(game_phase_input_value, states.size()),
+                                 LeadingRowsOf(next_move_stone_type_input_value, states.size()),
+                                 LeadingRowsOf(shl_map_input_value, states.size())};
 
     TF_Operation *output_op =
         TF_GraphOperationByName(graph, /*oper_name=*/"StatefulPartitionedCall");
@@ -242,13 +326,16 @@ GomokuShlModelEvaluator::GomokuShlModelEvaluatorInternal::ModelBasedPolicy(
     assert(TF_GetCode(status) == TF_OK);
     TF_DeleteStatus(status);
 
-    std::unordered_map<GomokuActionId, float> policy =
-        RenormalizePolicy(state, /*policy_tensor=*/output_values[0]);
+    for (TF_Tensor *input_value : input_values) {
+        TF_DeleteTensor(input_value);
+    }
+
+    for (unsigned i = 0; i < states.size(); ++i) {
+        policies->push_back(RenormalizePolicy(*states[i], i, /*policy_tensor=*/output_values[0]));
+    }
 
     TF_DeleteTensor(output_values[0]);
     TF_DeleteTensor(output_values[1]);
-
-    return policy;
 }
 
 GomokuShlModelEvaluator::GomokuShlModelEvaluator(std::string const &model_path)
@@ -264,13 +351,41 @@ float GomokuShlModelEvaluator::EvaluateReward(GomokuBoardState const &state,
 
 std::unordered_map<GomokuActionId, float> GomokuShlModelEvaluator::EvaluatePolicy(
     GomokuBoardState const &state, std::optional<MctNodeId> parent_state_id, MctNodeId state_id) {
-    ShlFeatureBuilder const &feature_builder =
-        pimpl_->shl_rollout_evaluator.GetFeatureBuilderForState(state, parent_state_id, state_id);
-    std::vector<float> shl_map =
-        feature_builder.TopKMapDense(/*top_k=*/15, /*normalized=*/true,
-                                     /*next_move_stone_type=*/std::nullopt);
+    std::vector<float> shl_map = pimpl_->ShlMapOf(state, parent_state_id, state_id);
+    return pimpl_->ModelBasedPolicies({&state}, {shl_map})[0];
+}
+
+std::vector<GomokuEvaluation>
+GomokuShlModelEvaluator::EvaluateBatch(std::vector<GomokuEvaluationRequest> const &requests) {
+    if (requests.empty()) {
+        return std::vector<GomokuEvaluation>();
+    }
+
+    std::vector<GomokuBoardState const *> states;
+    std::vector<std::vector<float>> shl_maps;
+    for (GomokuEvaluationRequest const &request : requests) {
+        states.push_back(request.state);
+        shl_maps.push_back(
+            pimpl_->ShlMapOf(*request.state, request.parent_state_id, request.state_id));
+    }
+    std::vector<std::unordered_map<GomokuActionId, float>> policies =
+        pimpl_->ModelBasedPolicies(states, shl_maps);
+
+    // Only the policy network runs in batches. The rewards still come from the rollouts.
+    std::vector<GomokuEvaluation> evaluations(requests.size());
+    for (unsigned i = 0; i < requests.size(); ++i) {
+        GomokuEvaluationRequest const &request = requests[i];
+        evaluations[i].policy = std::move(policies[i]);
+        if (request.reward_needed) {
+            evaluations[i].reward = pimpl_->shl_rollout_evaluator.EvaluateReward(
+                *request.state, request.parent_state_id, request.state_id);
+        }
+    }
+    return evaluations;
+}
 
-    return pimpl_->ModelBasedPolicy(state, shl_map);
+unsigned GomokuShlModelEvaluator::EvaluationBatchSize() const {
+    return kNeuralNetworkEvaluationBatchSize;
 }
 
 float GomokuShlModelEvaluator::ExplorationFactor() const { return 3.0f; }
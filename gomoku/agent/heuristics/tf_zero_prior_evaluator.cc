@@ -17,11 +17,13 @@
 
 #include <cassert>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <optional>
 #include <string>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "gomoku/agent/heuristics/evaluator.h"
 #include "gomoku/agent/heuristics/tf_zero_prior_evaluator.h"
@@ -35,18 +37,33 @@
 namespace e8 {
 namespace {
 
-struct EvaluationResult {
-    float reward;
-    std::unordered_map<GomokuActionId, float> policy;
-};
+void DoNotDeallocate(void * /*data*/, size_t /*len*/, void * /*arg*/) {}
+
+/**
+ * @brief LeadingRowsOf A tensor of the first rows of the batch tensor. It shares the memory of the
+ * batch tensor, which has to outlive it.
+ */
+TF_Tensor *LeadingRowsOf(TF_Tensor *batch, unsigned const num_rows) {
+    assert(TF_Dim(batch, /*dim_index=*/0) >= num_rows);
 
-void WriteBoard(GomokuBoardState const &state, TF_Tensor *board) {
-    assert(TF_NumDims(board) == 3);
-    assert(TF_Dim(board, /*dim_index=*/0) == 1);
-    assert(TF_Dim(board, /*dim_index=*/1) == state.Width());
-    assert(TF_Dim(board, /*dim_index=*/2) == state.Height());
+    std::vector<int64_t> dims(TF_NumDims(batch));
+    dims[0] = num_rows;
+    for (unsigned i = 1; i < dims.size(); ++i) {
+        dims[i] = TF_Dim(batch, i);
+    }
+    size_t len = TF_TensorByteSize(batch) / TF_Dim(batch, /*dim_index=*/0) * num_rows;
+    return TF_NewTensor(TF_TensorType(batch), dims.data(), dims.size(), TF_TensorData(batch), len,
+                        DoNotDeallocate, /*deallocator_arg=*/nullptr);
+}
 
-    uint8_t *tensor_memory = static_cast<uint8_t *>(TF_TensorData(board));
+void WriteBoard(GomokuBoardState const &state, unsigned const batch_idx, TF_Tensor *boards) {
+    assert(TF_NumDims(boards) == 3);
+    assert(TF_Dim(boards, /*dim_index=*/0) > batch_idx);
+    assert(TF_Dim(boards, /*dim_index=*/1) == state.Width());
+    assert(TF_Dim(boards, /*dim_index=*/2) == state.Height());
+
+    uint8_t *tensor_memory =
+        static_cast<uint8_t *>(TF_TensorData(boards)) + batch_idx * state.Width() * state.Height();
 
     for (int16_t y = 0; y < state.Height(); ++y) {
         for (int16_t x = 0; x < state.Width(); ++x) {
@@ -55,33 +72,35 @@ void WriteBoard(GomokuBoardState const &state, TF_Tensor *board) {
     }
 }
 
-void WriteGamePhase(GomokuBoardState const &state, TF_Tensor *game_phase) {
-    assert(TF_NumDims(game_phase) == 1);
-    assert(TF_Dim(game_phase, /*dim_index=*/0) == 1);
+void WriteGamePhase(GomokuBoardState const &state, unsigned const batch_idx,
+                    TF_Tensor *game_phases) {
+    assert(TF_NumDims(game_phases) == 1);
+    assert(TF_Dim(game_phases, /*dim_index=*/0) > batch_idx);
 
-    uint8_t *tensor_memory = static_cast<uint8_t *>(TF_TensorData(game_phase));
-    *tensor_memory = state.CurrentGamePhase();
+    uint8_t *tensor_memory = static_cast<uint8_t *>(TF_TensorData(game_phases));
+    tensor_memory[batch_idx] = state.CurrentGamePhase();
 }
 
-void WriteNextMoveStoneType(GomokuBoardState const &state, TF_Tensor *next_move_stone_type) {
-    assert(TF_NumDims(next_move_stone_type) == 1);
-    assert(TF_Dim(next_move_stone_type, /*dim_index=*/0) == 1);
+void WriteNextMoveStoneType(GomokuBoardState const &state, unsigned const batch_idx,
+                            TF_Tensor *next_move_stone_types) {
+    assert(TF_NumDims(next_move_stone_types) == 1);
+    assert(TF_Dim(next_move_stone_types, /*dim_index=*/0) > batch_idx);
 
-    uint8_t *tensor_memory = static_cast<uint8_t *>(TF_TensorData(next_move_stone_type));
-    *tensor_memory = state.PlayerStoneType(state.CurrentPlayerSide());
+    uint8_t *tensor_memory = static_cast<uint8_t *>(TF_TensorData(next_move_stone_types));
+    tensor_memory[batch_idx] = state.PlayerStoneType(state.CurrentPlayerSide());
 }
 
-EvaluationResult ToEvaluationResult(GomokuBoardState const &state, TF_Tensor const *policy_tensor,
-                                    TF_Tensor const *value_tensor) {
-    EvaluationResult evaluation;
+GomokuEvaluation ToEvaluation(GomokuBoardState const &state, unsigned const batch_idx,
+                              TF_Tensor const *policy_tensor, TF_Tensor const *value_tensor) {
+    GomokuEvaluation evaluation;
 
     assert(TF_NumDims(policy_tensor) == 2);
-    assert(TF_Dim(policy_tensor, /*dim_index=*/0) == 1);
+    assert(TF_Dim(policy_tensor, /*dim_index=*/0) > batch_idx);
     auto [lo, hi] = state.ActionIdRange();
     assert(TF_Dim(policy_tensor, /*dim_index=*/1) == hi - lo + 1);
 
     // Re-normalizes and stores the policy into the map.
-    float *policy = static_cast<float *>(TF_TensorData(policy_tensor));
+    float *policy = static_cast<float *>(TF_TensorData(policy_tensor)) + batch_idx * (hi - lo + 1);
 
     float norm_factor = 0;
     for (auto const &[action_id, _] : state.LegalActions()) {
@@ -92,11 +111,11 @@ EvaluationResult ToEvaluationResult(GomokuBoardState const &state, TF_Tensor con
     }
 
     assert(TF_NumDims(value_tensor) == 1);
-    assert(TF_Dim(value_tensor, /*dim_index=*/0) == 1);
+    assert(TF_Dim(value_tensor, /*dim_index=*/0) > batch_idx);
 
     // Value prediction can be treated as the expected reward.
     float *values = static_cast<float *>(TF_TensorData(value_tensor));
-    evaluation.reward = values[0];
+    evaluation.reward = values[batch_idx];
 
     return evaluation;
 }
@@ -107,7 +126,10 @@ struct GomokuTfZeroPriorEvaluator::TfModelBasedEvaluatorInternal {
     TfModelBasedEvaluatorInternal(std::string const &model_path);
     ~TfModelBasedEvaluatorInternal();
 
-    EvaluationResult Fetch(MctNodeId const state_id, GomokuBoardState const &state);
+    GomokuEvaluation Fetch(MctNodeId const state_id, GomokuBoardState const &state);
+    void FetchBatch(std::vector<GomokuEvaluationRequest> const &requests);
+    void RunInference(std::vector<GomokuEvaluationRequest const *> const &misses);
+    void AllocateInputs(GomokuBoardState const &state, unsigned const num_rows);
 
     TF_Session *session = nullptr;
     TF_Graph *graph = nullptr;
@@ -117,7 +139,7 @@ struct GomokuTfZeroPriorEvaluator::TfModelBasedEvaluatorInternal {
     TF_Tensor *game_phase_input_value = nullptr;
     TF_Tensor *next_move_stone_type_input_value = nullptr;
 
-    std::unordered_map<MctNodeId, EvaluationResult> cache;
+    std::unordered_map<MctNodeId, GomokuEvaluation> cache;
 };
 
 GomokuTfZeroPriorEvaluator::TfModelBasedEvaluatorInternal::TfModelBasedEvaluatorInternal(
@@ -150,38 +172,85 @@ GomokuTfZeroPriorEvaluator::TfModelBasedEvaluatorInternal::~TfModelBasedEvaluato
     TF_DeleteStatus(status);
 }
 
-EvaluationResult
+GomokuEvaluation
 GomokuTfZeroPriorEvaluator::TfModelBasedEvaluatorInternal::Fetch(MctNodeId const state_id,
                                                                  GomokuBoardState const &state) {
-    auto it = cache.find(state_id);
-    if (it != cache.end()) {
-        return it->second;
+    this->FetchBatch({GomokuEvaluationRequest{&state, /*parent_state_id=*/std::nullopt, state_id,
+                                              /*reward_needed=*/true}});
+    return cache.at(state_id);
+}
+
+void GomokuTfZeroPriorEvaluator::TfModelBasedEvaluatorInternal::AllocateInputs(
+    GomokuBoardState const &state, unsigned const num_rows) {
+    if (board_input_value != nullptr) {
+        assert(TF_Dim(board_input_value, /*dim_index=*/1) == state.Height());
+        assert(TF_Dim(board_input_value, /*dim_index=*/2) == state.Width());
+        if (TF_Dim(board_input_value, /*dim_index=*/0) >= num_rows) {
+            return;
+        }
+
+        TF_DeleteTensor(board_input_value);
+        TF_DeleteTensor(game_phase_input_value);
+        TF_DeleteTensor(next_move_stone_type_input_value);
     }
 
-    if (board_input_value == nullptr) {
-        // Allocate tensors when it's the first time running inference.
-        int64_t board_dims[] = {1, state.Height(), state.Width()};
-        board_input_value =
-            TF_AllocateTensor(TF_UINT8, board_dims,
-                              /*num_dims=*/sizeof(board_dims) / sizeof(int64_t),
-                              /*len=*/board_dims[0] * board_dims[1] * board_dims[2]);
-
-        int64_t game_phase_dims[] = {1};
-        game_phase_input_value =
-            TF_AllocateTensor(TF_UINT8, game_phase_dims,
-                              /*num_dims=*/sizeof(game_phase_dims) / sizeof(int64_t),
-                              /*len=*/game_phase_dims[0]);
-
-        int64_t next_move_stone_type_dims[] = {1};
-        next_move_stone_type_input_value =
-            TF_AllocateTensor(TF_UINT8, next_move_stone_type_dims,
-                              /*num_dims=*/sizeof(next_move_stone_type_dims) / sizeof(int64_t),
-                              /*len=*/next_move_stone_type_dims[0]);
+    // The tensors only grow, to the largest batch so far. A smaller batch runs on the leading rows
+    // of them. See LeadingRowsOf().
+    int64_t board_dims[] = {num_rows, state.Height(), state.Width()};
+    board_input_value =
+        TF_AllocateTensor(TF_UINT8, board_dims,
+                          /*num_dims=*/sizeof(board_dims) / sizeof(int64_t),
+                          /*len=*/board_dims[0] * board_dims[1] * board_dims[2]);
+    std::memset(TF_TensorData(board_input_value), 0, TF_TensorByteSize(board_input_value));
+
+    int64_t game_phase_dims[] = {num_rows};
+    game_phase_input_value =
+        TF_AllocateTensor(TF_UINT8, game_phase_dims,
+                          /*num_dims=*/sizeof(game_phase_dims) / sizeof(int64_t),
+                          /*len=*/game_phase_dims[0]);
+    std::memset(TF_TensorData(game_phase_input_value), 0,
+                TF_TensorByteSize(game_phase_input_value));
+
+    int64_t next_move_stone_type_dims[] = {num_rows};
+    next_move_stone_type_input_value =
+        TF_AllocateTensor(TF_UINT8, next_move_stone_type_dims,
+                          /*num_dims=*/sizeof(next_move_stone_type_dims) / sizeof(int64_t),
+                          /*len=*/next_move_stone_type_dims[0]);
+    std::memset(TF_TensorData(next_move_stone_type_input_value), 0,
+                TF_TensorByteSize(next_move_stone_type_input_value));
+}
+
+void GomokuTfZeroPriorEvaluator::TfModelBasedEvaluatorInternal::FetchBatch(
+    std::vector<GomokuEvaluationRequest> const &requests) {
+    // Runs inference only on the distinct states which haven't been cached.
+    std::vector<GomokuEvaluationRequest const *> misses;
+    for (GomokuEvaluationRequest const &request : requests) {
+        if (cache.find(request.state_id) != cache.end()) {
+            continue;
+        }
+        bool duplicate = false;
+        for (GomokuEvaluationRequest const *miss : misses) {
+            duplicate = duplicate || miss->state_id == request.state_id;
+        }
+        if (!duplicate) {
+            misses.push_back(&request);
+        }
     }
+    if (misses.empty()) {
+        return;
+    }
+
+    this->AllocateInputs(*misses[0]->state, misses.size());
+    this->RunInference(misses);
+}
 
-    WriteBoard(state, board_input_value);
-    WriteGamePhase(state, game_phase_input_value);
-    WriteNextMoveStoneType(state, next_move_stone_type_input_value);
+void GomokuTfZeroPriorEvaluator::TfModelBasedEvaluatorInternal::RunInference(
+    std::vector<GomokuEvaluationRequest const *> const &misses) {
+    for (unsigned i = 0; i < misses.size(); ++i) {
+        WriteBoard(*misses[i]->state, i, board_input_value);
+        WriteGamePhase(*misses[i]->state, i, game_phase_input_value);
+        WriteNextMoveStoneType(*misses[i]->state, i, next_move_stone_type_input_value);
+    }
 
     TF_Operation *board_input_op = TF_GraphOperationByName(graph, /*oper_name=*/"inference_boards");
     assert(board_input_op != nullptr);
@@ -198,8 +267,9 @@ GomokuTfZeroPriorEvaluator::TfModelBasedEvaluatorInternal::Fetch(MctNodeId const
     TF_Output next_move_stone_type_input = TF_Output{next_move_stone_type_input_op, 0};
 
     TF_Output inputs[] = {board_input, game_phase_input, next_move_stone_type_input};
-    TF_Tensor *input_values[] = {board_input_value, game_phase_input_value,
-                                 next_move_stone_type_input_value};
+    TF_Tensor *input_values[] = {LeadingRowsOf(board_input_value, misses.size()),
+                                 LeadingRowsOf(game_phase_input_value, misses.size()),
+                                 LeadingRowsOf(next_move_stone_type_input_value, misses.size())};
 
     TF_Operation *output_op =
         TF_GraphOperationByName(graph, /*oper_name=*/"StatefulPartitionedCall");
@@ -218,14 +288,19 @@ GomokuTfZeroPriorEvaluator::TfModelBasedEvaluatorInternal::Fetch(MctNodeId const
     assert(TF_GetCode(status) == TF_OK);
     TF_DeleteStatus(status);
 
-    EvaluationResult evaluation = ToEvaluationResult(state, /*policy_tensor=*/output_values[0],
-                                                     /*policy_tensor=*/output_values[1]);
-    cache.insert(std::make_pair(state_id, evaluation));
+    for (TF_Tensor *input_value : input_values) {
+        TF_DeleteTensor(input_value);
+    }
+
+    for (unsigned i = 0; i < misses.size(); ++i) {
+        GomokuEvaluation evaluation = ToEvaluation(*misses[i]->state, i,
+                                                   /*policy_tensor=*/output_values[0],
+                                                   /*value_tensor=*/output_values[1]);
+        cache.insert(std::make_pair(misses[i]->state_id, evaluation));
+    }
 
     TF_DeleteTensor(output_values[0]);
     TF_DeleteTensor(output_values[1]);
-
-    return evaluation;
 }
 
 GomokuTfZeroPriorEvaluator::GomokuTfZeroPriorEvaluator(std::string const &model_path)
@@ -246,6 +321,22 @@ GomokuTfZeroPriorEvaluator::EvaluatePolicy(GomokuBoardState const &state,
     return pimpl_->Fetch(state_id, state).policy;
 }
 
+std::vector<GomokuEvaluation>
+GomokuTfZeroPriorEvaluator::EvaluateBatch(std::vector<GomokuEvaluationRequest> const &requests) {
+    pimpl_->FetchBatch(requests);
+
+    std::vector<GomokuEvaluation> evaluations;
+    evaluations.reserve(requests.size());
+    for (GomokuEvaluationRequest const &request : requests) {
+        evaluations.push_back(pimpl_->cache.at(request.state_id));
+    }
+    return evaluations;
+}
+
+unsigned GomokuTfZeroPriorEvaluator::EvaluationBatchSize() const {
+    return kNeuralNetworkEvaluationBatchSize;
+}
+
 float GomokuTfZeroPriorEvaluator::ExplorationFactor() const { return 4.0f; }
 
 unsigned GomokuTfZeroPriorEvaluator::NumSimulations() const { return 2048; }
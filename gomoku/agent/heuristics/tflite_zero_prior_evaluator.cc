@@ -22,6 +22,7 @@
 #include <string>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "gomoku/agent/heuristics/evaluator.h"
 #include "gomoku/agent/heuristics/tflite_zero_prior_evaluator.h"
@@ -32,18 +33,14 @@
 namespace e8 {
 namespace {
 
-struct EvaluationResult {
-    float reward;
-    std::unordered_map<GomokuActionId, float> policy;
-};
-
-void WriteBoard(GomokuBoardState const &state, TfLiteTensor *board) {
-    assert(TfLiteTensorNumDims(board) == 3);
-    assert(TfLiteTensorDim(board, /*dim_index=*/0) == 1);
-    assert(TfLiteTensorDim(board, /*dim_index=*/1) == state.Width());
-    assert(TfLiteTensorDim(board, /*dim_index=*/2) == state.Height());
+void WriteBoard(GomokuBoardState const &state, unsigned const batch_idx, TfLiteTensor *boards) {
+    assert(TfLiteTensorNumDims(boards) == 3);
+    assert(TfLiteTensorDim(boards, /*dim_index=*/0) > static_cast<int>(batch_idx));
+    assert(TfLiteTensorDim(boards, /*dim_index=*/1) == state.Width());
+    assert(TfLiteTensorDim(boards, /*dim_index=*/2) == state.Height());
 
-    uint8_t *tensor_memory = static_cast<uint8_t *>(TfLiteTensorData(board));
+    uint8_t *tensor_memory = static_cast<uint8_t *>(TfLiteTensorData(boards)) +
+                             batch_idx * state.Width() * state.Height();
 
     for (int16_t y = 0; y < state.Height(); ++y) {
         for (int16_t x = 0; x < state.Width(); ++x) {
@@ -52,34 +49,36 @@ void WriteBoard(GomokuBoardState const &state, TfLiteTensor *board) {
     }
 }
 
-void WriteGamePhase(GomokuBoardState const &state, TfLiteTensor *game_phase) {
-    assert(TfLiteTensorNumDims(game_phase) == 1);
-    assert(TfLiteTensorDim(game_phase, /*dim_index=*/0) == 1);
+void WriteGamePhase(GomokuBoardState const &state, unsigned const batch_idx,
+                    TfLiteTensor *game_phases) {
+    assert(TfLiteTensorNumDims(game_phases) == 1);
+    assert(TfLiteTensorDim(game_phases, /*dim_index=*/0) > static_cast<int>(batch_idx));
 
-    uint8_t *tensor_memory = static_cast<uint8_t *>(TfLiteTensorData(game_phase));
-    *tensor_memory = state.CurrentGamePhase();
+    uint8_t *tensor_memory = static_cast<uint8_t *>(TfLiteTensorData(game_phases));
+    tensor_memory[batch_idx] = state.CurrentGamePhase();
 }
 
-void WriteNextMoveStoneType(GomokuBoardState const &state, TfLiteTensor *next_move_stone_type) {
-    assert(TfLiteTensorNumDims(next_move_stone_type) == 1);
-    assert(TfLiteTensorDim(next_move_stone_type, /*dim_index=*/0) == 1);
+void WriteNextMoveStoneType(GomokuBoardState const &state, unsigned const batch_idx,
+                            TfLiteTensor *next_move_stone_types) {
+    assert(TfLiteTensorNumDims(next_move_stone_types) == 1);
+    assert(TfLiteTensorDim(next_move_stone_types, /*dim_index=*/0) > static_cast<int>(batch_idx));
 
-    uint8_t *tensor_memory = static_cast<uint8_t *>(TfLiteTensorData(next_move_stone_type));
-    *tensor_memory = state.PlayerStoneType(state.CurrentPlayerSide());
+    uint8_t *tensor_memory = static_cast<uint8_t *>(TfLiteTensorData(next_move_stone_types));
+    tensor_memory[batch_idx] = state.PlayerStoneType(state.CurrentPlayerSide());
 }
 
-EvaluationResult ToEvaluationResult(GomokuBoardState const &state,
-                                    TfLiteTensor const *policy_tensor,
-                                    TfLiteTensor const *value_tensor) {
-    EvaluationResult evaluation;
+GomokuEvaluation ToEvaluation(GomokuBoardState const &state, unsigned const batch_idx,
+                              TfLiteTensor const *policy_tensor, TfLiteTensor const *value_tensor) {
+    GomokuEvaluation evaluation;
 
     assert(TfLiteTensorNumDims(policy_tensor) == 2);
-    assert(TfLiteTensorDim(policy_tensor, /*dim_index=*/0) == 1);
+    assert(TfLiteTensorDim(policy_tensor, /*dim_index=*/0) > static_cast<int>(batch_idx));
     auto [lo, hi] = state.ActionIdRange();
     assert(TfLiteTensorDim(policy_tensor, /*dim_index=*/1) == hi - lo + 1);
 
     // Re-normalizes and stores the policy into the map.
-    float *policy = static_cast<float *>(TfLiteTensorData(policy_tensor));
+    float *policy =
+        static_cast<float *>(TfLiteTensorData(policy_tensor)) + batch_idx * (hi - lo + 1);
 
     float norm_factor = 0;
     for (auto const &[action_id, _] : state.LegalActions()) {
@@ -90,11 +89,11 @@ EvaluationResult ToEvaluationResult(GomokuBoardState const &state,
     }
 
     assert(TfLiteTensorNumDims(value_tensor) == 1);
-    assert(TfLiteTensorDim(value_tensor, /*dim_index=*/0) == 1);
+    assert(TfLiteTensorDim(value_tensor, /*dim_index=*/0) > static_cast<int>(batch_idx));
 
     // Value prediction can be treated as the expected reward.
     float *values = static_cast<float *>(TfLiteTensorData(value_tensor));
-    evaluation.reward = values[0];
+    evaluation.reward = values[batch_idx];
 
     return evaluation;
 }
@@ -121,7 +120,10 @@ struct GomokuTfliteZeroPriorEvaluator::ModelBasedEvaluatorInternal {
     ModelBasedEvaluatorInternal(std::string const &model_path);
     ~ModelBasedEvaluatorInternal();
 
-    EvaluationResult Fetch(MctNodeId const state_id, GomokuBoardState const &state);
+    GomokuEvaluation Fetch(MctNodeId const state_id, GomokuBoardState const &state);
+    void FetchBatch(std::vector<GomokuEvaluationRequest> const &requests);
+    void RunInference(std::vector<GomokuEvaluationRequest const *> const &misses);
+    void ResizeInputs(GomokuBoardState const &state, int const num_rows);
 
     TfLiteModel *model;
     TfLiteInterpreterOptions *interpreter_options;
@@ -134,7 +136,9 @@ struct GomokuTfliteZeroPriorEvaluator::ModelBasedEvaluatorInternal {
     int policy_idx;
     int value_idx;
 
-    std::unordered_map<MctNodeId, EvaluationResult> cache;
+    int num_input_rows = 0;
+
+    std::unordered_map<MctNodeId, GomokuEvaluation> cache;
 };
 
 GomokuTfliteZeroPriorEvaluator::ModelBasedEvaluatorInternal::ModelBasedEvaluatorInternal(
@@ -177,23 +181,81 @@ GomokuTfliteZeroPriorEvaluator::ModelBasedEvaluatorInternal::~ModelBasedEvaluato
     TfLiteInterpreterOptionsDelete(interpreter_options);
 }
 
-EvaluationResult
+GomokuEvaluation
 GomokuTfliteZeroPriorEvaluator::ModelBasedEvaluatorInternal::Fetch(MctNodeId const state_id,
                                                                    GomokuBoardState const &state) {
-    auto it = cache.find(state_id);
-    if (it != cache.end()) {
-        return it->second;
+    this->FetchBatch({GomokuEvaluationRequest{&state, /*parent_state_id=*/std::nullopt, state_id,
+                                              /*reward_needed=*/true}});
+    return cache.at(state_id);
+}
+
+void GomokuTfliteZeroPriorEvaluator::ModelBasedEvaluatorInternal::ResizeInputs(
+    GomokuBoardState const &state, int const num_rows) {
+    if (num_input_rows == num_rows) {
+        return;
     }
 
-    TfLiteTensor *board_features = TfLiteInterpreterGetInputTensor(interpreter, board_idx);
-    WriteBoard(state, board_features);
+    // The interpreter runs every row of its inputs, so they're resized to the exact batch. Its
+    // memory arena only grows, so the tensors are reallocated only when a batch is the largest so
+    // far.
+    int board_dims[] = {num_rows, state.Width(), state.Height()};
+    TfLiteStatus status = TfLiteInterpreterResizeInputTensor(
+        interpreter, board_idx, board_dims, /*input_dims_size=*/sizeof(board_dims) / sizeof(int));
+    assert(status == TfLiteStatus::kTfLiteOk);
 
-    TfLiteTensor *game_phase = TfLiteInterpreterGetInputTensor(interpreter, game_phase_idx);
-    WriteGamePhase(state, game_phase);
+    int game_phase_dims[] = {num_rows};
+    status = TfLiteInterpreterResizeInputTensor(
+        interpreter, game_phase_idx, game_phase_dims,
+        /*input_dims_size=*/sizeof(game_phase_dims) / sizeof(int));
+    assert(status == TfLiteStatus::kTfLiteOk);
 
+    int next_move_stone_type_dims[] = {num_rows};
+    status = TfLiteInterpreterResizeInputTensor(
+        interpreter, next_move_stone_type_idx, next_move_stone_type_dims,
+        /*input_dims_size=*/sizeof(next_move_stone_type_dims) / sizeof(int));
+    assert(status == TfLiteStatus::kTfLiteOk);
+
+    status = TfLiteInterpreterAllocateTensors(interpreter);
+    assert(status == TfLiteStatus::kTfLiteOk);
+
+    num_input_rows = num_rows;
+}
+
+void GomokuTfliteZeroPriorEvaluator::ModelBasedEvaluatorInternal::FetchBatch(
+    std::vector<GomokuEvaluationRequest> const &requests) {
+    // Runs inference only on the distinct states which haven't been cached.
+    std::vector<GomokuEvaluationRequest const *> misses;
+    for (GomokuEvaluationRequest const &request : requests) {
+        if (cache.find(request.state_id) != cache.end()) {
+            continue;
+        }
+        bool duplicate = false;
+        for (GomokuEvaluationRequest const *miss : misses) {
+            duplicate = duplicate || miss->state_id == request.state_id;
+        }
+        if (!duplicate) {
+            misses.push_back(&request);
+        }
+    }
+    if (misses.empty()) {
+        return;
+    }
+
+    this->ResizeInputs(*misses[0]->state, misses.size());
+    this->RunInference(misses);
+}
+
+void GomokuTfliteZeroPriorEvaluator::ModelBasedEvaluatorInternal::RunInference(
+    std::vector<GomokuEvaluationRequest const *> const &misses) {
+    TfLiteTensor *board_features = TfLiteInterpreterGetInputTensor(interpreter, board_idx);
+    TfLiteTensor *game_phase = TfLiteInterpreterGetInputTensor(interpreter, game_phase_idx);
     TfLiteTensor *next_move_stone_type =
         TfLiteInterpreterGetInputTensor(interpreter, next_move_stone_type_idx);
-    WriteNextMoveStoneType(state, next_move_stone_type);
+    for (unsigned i = 0; i < misses.size(); ++i) {
+        WriteBoard(*misses[i]->state, i, board_features);
+        WriteGamePhase(*misses[i]->state, i, game_phase);
+        WriteNextMoveStoneType(*misses[i]->state, i, next_move_stone_type);
+    }
 
     TfLiteStatus status = TfLiteInterpreterInvoke(interpreter);
     assert(status == TfLiteStatus::kTfLiteOk);
@@ -201,10 +263,10 @@ GomokuTfliteZeroPriorEvaluator::ModelBasedEvaluatorInternal::Fetch(MctNodeId con
     TfLiteTensor const *policy = TfLiteInterpreterGetOutputTensor(interpreter, policy_idx);
     TfLiteTensor const *value = TfLiteInterpreterGetOutputTensor(interpreter, value_idx);
 
-    EvaluationResult evaluation = ToEvaluationResult(state, policy, value);
-    cache.insert(std::make_pair(state_id, evaluation));
-
-    return evaluation;
+    for (unsigned i = 0; i < misses.size(); ++i) {
+        cache.insert(std::make_pair(misses[i]->state_id,
+                                    ToEvaluation(*misses[i]->state, i, policy, value)));
+    }
 }
 
 GomokuTfliteZeroPriorEvaluator::GomokuTfliteZeroPriorEvaluator(std::string const &model_path)
@@ -225,6 +287,22 @@ GomokuTfliteZeroPriorEvaluator::EvaluatePolicy(GomokuBoardState const &state,
     return pimpl_->Fetch(state_id, state).policy;
 }
 
+std::vector<GomokuEvaluation> GomokuTfliteZeroPriorEvaluator::EvaluateBatch(
+    std::vector<GomokuEvaluationRequest> const &requests) {
+    pimpl_->FetchBatch(requests);
+
+    std::vector<GomokuEvaluation> evaluations;
+    evaluations.reserve(requests.size());
+    for (GomokuEvaluationRequest const &request : requests) {
+        evaluations.push_back(pimpl_->cache.at(request.state_id));
+    }
+    return evaluations;
+}
+
+unsigned GomokuTfliteZeroPriorEvaluator::EvaluationBatchSize() const {
+    return kNeuralNetworkEvaluationBatchSize;
+}
+
 float GomokuTfliteZeroPriorEvaluator::ExplorationFactor() const { return 5.0f; }
 
 unsigned GomokuTfliteZeroPriorEvaluator::NumSimulations() const { return 2000; }
@@ -23,6 +23,7 @@
 #include <optional>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "gomoku/agent/heuristics/evaluator.h"
 #include "gomoku/agent/search/mct_node.h"
@@ -50,6 +51,11 @@ class GomokuTfliteZeroPriorEvaluator : public GomokuEvaluatorInterface {
     EvaluatePolicy(GomokuBoardState const &state, std::optional<MctNodeId> parent_state_id,
                    MctNodeId state_id) override;
 
+    std::vector<GomokuEvaluation>
+    EvaluateBatch(std::vector<GomokuEvaluationRequest> const &requests) override;
+
+    unsigned EvaluationBatchSize() const override;
+
     float ExplorationFactor() const override;
 
     unsigned NumSimulations() const override;
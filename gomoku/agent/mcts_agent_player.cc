@@ -30,16 +30,22 @@
 namespace e8 {
 
 MctsAgentPlayer::MctsAgentPlayer(PlayerSide const player_side,
-                                 std::shared_ptr<MctSearcher> const &searcher, bool shared_searcher)
-    : player_side_(player_side), searcher_(searcher), shared_searcher_(shared_searcher) {}
+                                 std::shared_ptr<MctSearcher> const &searcher, bool shared_searcher,
+                                 std::optional<SearchBudget> const &budget, bool ponder)
+    : player_side_(player_side), searcher_(searcher), shared_searcher_(shared_searcher),
+      budget_(budget), ponder_(ponder && !shared_searcher) {}
 
 void MctsAgentPlayer::OnGomokuGameBegin(GomokuBoardState const & /*board_state*/) {
     searcher_->Reset();
 }
 
 GomokuActionId MctsAgentPlayer::NextPlayerAction(GomokuBoardState const &board_state) {
-    std::unordered_map<GomokuActionId, float> optimal_policy =
-        searcher_->SearchFrom(board_state, /*temperature=*/1.0f);
+    std::unordered_map<GomokuActionId, float> optimal_policy;
+    if (budget_.has_value()) {
+        optimal_policy = searcher_->SearchFrom(board_state, /*temperature=*/1.0f, *budget_);
+    } else {
+        optimal_policy = searcher_->SearchFrom(board_state, /*temperature=*/1.0f);
+    }
 
     return BestAction(optimal_policy);
 }
@@ -52,9 +58,16 @@ void MctsAgentPlayer::BeforeGomokuActionApplied(GomokuBoardState const &board_st
     }
 }
 
-void MctsAgentPlayer::AfterGomokuActionApplied(GomokuBoardState const & /*board_state*/) {}
+void MctsAgentPlayer::AfterGomokuActionApplied(GomokuBoardState const &board_state) {
+    if (ponder_ && board_state.CurrentPlayerSide() != player_side_ &&
+        board_state.CurrentGameResult() == GR_UNDETERMINED) {
+        searcher_->StartPondering(board_state);
+    }
+}
 
-void MctsAgentPlayer::OnGameEnded(GomokuBoardState const & /*board_state*/) {}
+void MctsAgentPlayer::OnGameEnded(GomokuBoardState const & /*board_state*/) {
+    searcher_->StopPondering();
+}
 
 bool MctsAgentPlayer::WantAnotherGame() { return true; }
 
@@ -42,9 +42,14 @@ class MctsAgentPlayer : public GomokuPlayerInterface {
      * @param searcher The search algorithm.
      * @param shared_searcher Whether the search algorithm states are shared by the oppponent as
      * well.
+     * @param budget The budget of each move's search. If it's absent, each move runs the
+     * evaluator's NumSimulations().
+     * @param ponder Whether to keep searching on the opponent's time. It has no effect when the
+     * searcher is shared.
      */
     MctsAgentPlayer(PlayerSide const player_side, std::shared_ptr<MctSearcher> const &searcher,
-                    bool shared_searcher);
+                    bool shared_searcher, std::optional<SearchBudget> const &budget = std::nullopt,
+                    bool ponder = false);
     ~MctsAgentPlayer() override = default;
 
     GomokuActionId NextPlayerAction(GomokuBoardState const &board_state) override;
@@ -65,6 +70,8 @@ class MctsAgentPlayer : public GomokuPlayerInterface {
     PlayerSide const player_side_;
     std::shared_ptr<MctSearcher> searcher_;
     bool const shared_searcher_;
+    std::optional<SearchBudget> const budget_;
+    bool const ponder_;
 };
 
 } // namespace e8
@@ -15,40 +15,153 @@
  * not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <mutex>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <memory>
 #include <optional>
+#include <utility>
+#include <vector>
 
-#include "common/container/mutable_priority_queue.h"
 #include "gomoku/agent/search/mct_node.h"
 #include "gomoku/game/board_state.h"
 
 namespace e8 {
 namespace {
 
-std::mutex gNextNodeIdLock;
-MctNodeId gNextNodeId = 1;
+// Caps the arena at 2^26 nodes.
+unsigned const kMaxNumMctNodeBlocks = 1 << 14;
 
 } // namespace
 
-MctNode::MctNode() : id(0), game_result(GR_UNDETERMINED), heuristic_policy_weight(-1.0f) {}
+MctNodeArena::MctNodeArena()
+    : blocks_(kMaxNumMctNodeBlocks), num_allocated_blocks_(0), num_nodes_(0) {}
 
-MctNode::MctNode(MctNodeId const id, std::optional<GomokuActionId> const arrived_thru_action_id,
-                 std::optional<PlayerSide> const action_performed_by, GameResult const game_result,
-                 float const heuristic_policy_weight)
-    : id(id), arrived_thru_action_id(arrived_thru_action_id),
-      action_performed_by(action_performed_by), game_result(game_result),
-      heuristic_policy_weight(heuristic_policy_weight) {}
+std::optional<MctNodeIndex> MctNodeArena::Allocate(unsigned const num_nodes) {
+    assert(num_nodes > 0 && num_nodes <= kMctNodeBlockSize);
 
-bool MctNode::operator<(MctNode const &rhs) const {
-    return upper_confidence_bound < rhs.upper_confidence_bound;
+    mutex_.lock();
+
+    MctNodeIndex first = num_nodes_;
+    unsigned const offset = first & (kMctNodeBlockSize - 1);
+    if (offset > 0 && offset + num_nodes > kMctNodeBlockSize) {
+        // Skips the rest of the block so that the span doesn't straddle two blocks.
+        first += kMctNodeBlockSize - offset;
+    }
+
+    unsigned const block = first >> kLog2MctNodeBlockSize;
+    if (block == kMaxNumMctNodeBlocks) {
+        mutex_.unlock();
+        return std::nullopt;
+    }
+    if (block == num_allocated_blocks_) {
+        blocks_[block] = std::make_unique<MctNodeBlock>();
+        ++num_allocated_blocks_;
+    }
+    num_nodes_ = first + num_nodes;
+
+    mutex_.unlock();
+    return first;
+}
+
+void MctNodeArena::Initialize(MctNodeIndex const node, GomokuActionId const arrived_thru_action_id,
+                              PlayerSide const action_performed_by, GameResult const game_result,
+                              float const heuristic_policy_weight) {
+    MctNodeBlock *block = this->BlockOf(node);
+    unsigned const i = node & (kMctNodeBlockSize - 1);
+
+    block->summed_reward[i] = 0.0f;
+    block->num_bandit_pulls[i].store(0, std::memory_order_relaxed);
+    block->num_virtual_losses[i] = 0;
+    block->heuristic_policy_weight[i] = heuristic_policy_weight;
+    block->arrived_thru_action_id[i] = arrived_thru_action_id;
+    block->action_performed_by[i] = action_performed_by;
+    block->game_result[i] = game_result;
+    block->first_child[i] = 0;
+    block->num_children[i] = 0;
+}
+
+void MctNodeArena::InitializeRoot(MctNodeIndex const node) {
+    this->Initialize(node, /*arrived_thru_action_id=*/-1, /*action_performed_by=*/PS_PLAYER_A,
+                     GR_UNDETERMINED,
+                     /*heuristic_policy_weight=*/std::numeric_limits<float>::infinity());
+}
+
+std::optional<MctNodeIndex> MctNodeArena::CopySubtree(MctNodeArena const &source,
+                                                      MctNodeIndex const root) {
+    std::optional<MctNodeIndex> copied_root = this->Allocate(1);
+    if (!copied_root.has_value()) {
+        return std::nullopt;
+    }
+
+    // Pairs of the source node and its copy, whose children are yet to be copied.
+    std::vector<std::pair<MctNodeIndex, MctNodeIndex>> frontier{{root, *copied_root}};
+    for (unsigned k = 0; k < frontier.size(); ++k) {
+        auto [node, copy] = frontier[k];
+
+        MctNodeBlock const *node_block = source.BlockOf(node);
+        MctNodeBlock *copy_block = this->BlockOf(copy);
+        unsigned const i = node & (kMctNodeBlockSize - 1);
+        unsigned const j = copy & (kMctNodeBlockSize - 1);
+
+        copy_block->summed_reward[j] = node_block->summed_reward[i];
+        copy_block->num_bandit_pulls[j].store(
+            node_block->num_bandit_pulls[i].load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
+        copy_block->num_virtual_losses[j] = node_block->num_virtual_losses[i];
+        copy_block->heuristic_policy_weight[j] = node_block->heuristic_policy_weight[i];
+        copy_block->arrived_thru_action_id[j] = node_block->arrived_thru_action_id[i];
+        copy_block->action_performed_by[j] = node_block->action_performed_by[i];
+        copy_block->game_result[j] = node_block->game_result[i];
+        copy_block->first_child[j] = 0;
+        copy_block->num_children[j] = 0;
+
+        unsigned const num_children = node_block->num_children[i];
+        if (num_children == 0) {
+            continue;
+        }
+
+        std::optional<MctNodeIndex> copied_children = this->Allocate(num_children);
+        if (!copied_children.has_value()) {
+            return std::nullopt;
+        }
+        this->SetChildren(copy, *copied_children, num_children);
+
+        MctNodeIndex const first_child = node_block->first_child[i];
+        for (unsigned c = 0; c < num_children; ++c) {
+            frontier.push_back(std::make_pair(first_child + c, *copied_children + c));
+        }
+    }
+
+    return copied_root;
+}
+
+void MctNodeArena::Clear() {
+    for (unsigned block = kNumRetainedMctNodeBlocks; block < num_allocated_blocks_; ++block) {
+        blocks_[block].reset();
+    }
+    num_allocated_blocks_ = std::min(num_allocated_blocks_, kNumRetainedMctNodeBlocks);
+    num_nodes_ = 0;
+}
+
+unsigned MctNodeArena::NumNodes() const { return num_nodes_; }
+
+uint64_t MctNodeArena::MemoryUsage() const {
+    return sizeof(MctNodeArena) + blocks_.size() * sizeof(std::unique_ptr<MctNodeBlock>) +
+           static_cast<uint64_t>(num_allocated_blocks_) * sizeof(MctNodeBlock);
 }
 
-MctNodeId AllocateMctNodeId() {
-    gNextNodeIdLock.lock();
-    MctNodeId allocation = gNextNodeId++;
-    gNextNodeIdLock.unlock();
+void MctNodeArena::SetChildren(MctNodeIndex const node, MctNodeIndex const first_child,
+                               unsigned const num_children) {
+    assert((first_child >> kLog2MctNodeBlockSize) ==
+           ((first_child + num_children - 1) >> kLog2MctNodeBlockSize));
 
-    return allocation;
+    MctNodeBlock *block = this->BlockOf(node);
+    unsigned const i = node & (kMctNodeBlockSize - 1);
+    block->first_child[i] = first_child;
+    block->num_children[i] = num_children;
 }
 
 } // namespace e8
@@ -18,10 +18,13 @@
 #ifndef MCT_NODE_H
 #define MCT_NODE_H
 
+#include <atomic>
 #include <cstdint>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <vector>
 
-#include "common/container/mutable_priority_queue.h"
 #include "gomoku/game/board_state.h"
 
 namespace e8 {
@@ -29,71 +32,206 @@ namespace e8 {
 // The number zero is reserved. Any valid ID should not be a zero value.
 using MctNodeId = int64_t;
 
+// Position of a node in its MctNodeArena.
+using MctNodeIndex = uint32_t;
+
+unsigned const kLog2MctNodeBlockSize = 12;
+unsigned const kMctNodeBlockSize = 1 << kLog2MctNodeBlockSize;
+
+// Number of blocks an arena keeps across Clear() calls.
+unsigned const kNumRetainedMctNodeBlocks = 16;
+
 /**
- * @brief The MctNode struct An abstract game state which stores statistics and action information
- * during monte carlo tree search.
+ * @brief The MctNodeBlock struct A fixed number of consecutive arena nodes laid out as a structure
+ * of arrays, so the statistics of sibling nodes are contiguous.
  */
-struct MctNode {
-    // This id should be unique in the entire search tree.
-    MctNodeId const id;
+struct MctNodeBlock {
+    // The below values can be used to calculate the Q value. The pull count is read by the children
+    // when they recompute their upper confidence bound, so it's atomic for a parallel search.
+    float summed_reward[kMctNodeBlockSize];
+    std::atomic<unsigned> num_bandit_pulls[kMctNodeBlockSize];
+
+    // The number of searches currently descending through the node. Each of them counts as a lost
+    // pull so that concurrent searches are steered towards different paths.
+    unsigned num_virtual_losses[kMctNodeBlockSize];
+
+    // Policy weight given by the heuristics used to rank the action leading to the node's state.
+    float heuristic_policy_weight[kMctNodeBlockSize];
+
+    // How did the node's state arrive from the parent state, by which player, and the game result
+    // after that. They are left unspecified for a root node.
+    GomokuActionId arrived_thru_action_id[kMctNodeBlockSize];
+    uint8_t action_performed_by[kMctNodeBlockSize];
+    uint8_t game_result[kMctNodeBlockSize];
+
+    // Child states obtained by applying exactly one action from the node's state.
+    MctNodeIndex first_child[kMctNodeBlockSize];
+    uint16_t num_children[kMctNodeBlockSize];
+};
 
-    std::optional<GomokuActionId> const arrived_thru_action_id;
-    std::optional<PlayerSide> const action_performed_by;
+/**
+ * @brief The MctNodeArena class Stores the nodes of a Monte Carlo search tree in blocks of
+ * kMctNodeBlockSize nodes. The children of a node are allocated as one contiguous span which never
+ * straddles two blocks, so each statistics array of the children can be scanned linearly. Nodes
+ * are never freed individually. Instead, the whole arena is cleared at once while the first
+ * kNumRetainedMctNodeBlocks blocks are kept for reuse, and a subtree worth keeping is compacted
+ * into another arena beforehand. See CopySubtree(). Allocation is thread safe. Accessing a node
+ * is thread safe as long as the accesses to the same node are synchronized by the caller.
+ */
+class MctNodeArena {
+  public:
+    MctNodeArena();
+    MctNodeArena(MctNodeArena const &) = delete;
+    ~MctNodeArena() = default;
 
-    // Game result at the current game state.
-    GameResult const game_result;
+    /**
+     * @brief Allocate Allocates num_nodes contiguous nodes. The nodes have to be initialized by
+     * Initialize() before use.
+     *
+     * @return The index of the first node, or nullopt if the arena is full.
+     */
+    std::optional<MctNodeIndex> Allocate(unsigned const num_nodes);
 
-    // Policy weight given by the heuristics used to rank the action leading to the current
-    // state.
-    float const heuristic_policy_weight;
+    /**
+     * @brief Initialize Resets the node's statistics and gives it no child.
+     *
+     * @param arrived_thru_action_id How did the node's state arrive from the parent state.
+     * @param action_performed_by Which player performed the action.
+     * @param game_result Game result at the node's state.
+     * @param heuristic_policy_weight Policy weight given by the heuristics used to rank the action
+     * leading to the node's state.
+     */
+    void Initialize(MctNodeIndex const node, GomokuActionId const arrived_thru_action_id,
+                    PlayerSide const action_performed_by, GameResult const game_result,
+                    float const heuristic_policy_weight);
 
-    // The below values can be used to calculate the Q value.
-    float summed_reward = 0.0f;
-    unsigned num_bandit_pulls = 0;
+    /**
+     * @brief InitializeRoot Resets the node's statistics and gives it no child. The root never
+     * gets selected so it has an infinite policy weight.
+     */
+    void InitializeRoot(MctNodeIndex const node);
 
-    // Upper confidence bound on the Q value.
-    float upper_confidence_bound = 0.0f;
+    /**
+     * @brief CopySubtree Copies the subtree of the source arena rooted at the node into this arena
+     * in breadth-first order. It must not run concurrently with other operations on either arena.
+     *
+     * @return The index of the copied root, or nullopt if this arena runs out of space.
+     */
+    std::optional<MctNodeIndex> CopySubtree(MctNodeArena const &source, MctNodeIndex const root);
 
-    // Child states obtained by applying exactly one action from the current state.
-    MutablePriorityQueue<MctNode> children;
+    /**
+     * @brief Clear Releases every node. The first kNumRetainedMctNodeBlocks blocks are kept for the
+     * nodes allocated afterwards, and the rest are freed so that a large search doesn't pin its
+     * peak memory. It must not run concurrently with other operations.
+     */
+    void Clear();
 
     /**
-     * @brief MctNode Used by the container to fill up space. Otherwise, the node will be at an
-     * invalid state.
+     * @brief NumNodes The number of nodes allocated since the arena was last cleared, including
+     * the slots skipped to keep a span of children within a block.
      */
-    MctNode();
+    unsigned NumNodes() const;
 
     /**
-     * @brief MctNode The only valid constructor.
-     *
-     * @param id Uhique identity in the entire search tree.
-     * @param arrived_thru_action_id How did the current state arrive from the parent state. Set
-     * this to nullopt if it's a the root state.
-     * @param action_performed_by Which player performed the action. Set this ot nullopt if it's the
-     * root state.
-     * @param game_result Game state at the current state.
-     * @param heuristic_policy_weight Policy weight given by the heuristics used to rank the action
-     * leading to the current state.
+     * @brief MemoryUsage The number of bytes held by the arena.
      */
-    MctNode(MctNodeId const id, std::optional<GomokuActionId> const arrived_thru_action_id,
-            std::optional<PlayerSide> const action_performed_by, GameResult const game_result,
-            float const heuristic_policy_weight);
+    uint64_t MemoryUsage() const;
+
+    float &SummedReward(MctNodeIndex const node);
+    float const &SummedReward(MctNodeIndex const node) const;
+    std::atomic<unsigned> &NumBanditPulls(MctNodeIndex const node);
+    std::atomic<unsigned> const &NumBanditPulls(MctNodeIndex const node) const;
+    unsigned &NumVirtualLosses(MctNodeIndex const node);
+    unsigned const &NumVirtualLosses(MctNodeIndex const node) const;
+    float const &HeuristicPolicyWeight(MctNodeIndex const node) const;
+
+    GomokuActionId ArrivedThruActionId(MctNodeIndex const node) const;
+    PlayerSide ActionPerformedBy(MctNodeIndex const node) const;
+    GameResult GameResultAt(MctNodeIndex const node) const;
 
-    MctNode(MctNode const &) = default;
-    MctNode(MctNode &&) = default;
-    ~MctNode() = default;
+    /**
+     * @brief FirstChild Index of the first child. The children occupy the indices [FirstChild(),
+     * FirstChild() + NumChildren()).
+     */
+    MctNodeIndex FirstChild(MctNodeIndex const node) const;
+    unsigned NumChildren(MctNodeIndex const node) const;
 
     /**
-     * @brief operator < Orders the node by the upper confidence bound.
+     * @brief SetChildren Attaches the span of children, allocated by one Allocate() call, to the
+     * node.
      */
-    bool operator<(MctNode const &rhs) const;
+    void SetChildren(MctNodeIndex const node, MctNodeIndex const first_child,
+                     unsigned const num_children);
+
+  private:
+    MctNodeBlock *BlockOf(MctNodeIndex const node);
+    MctNodeBlock const *BlockOf(MctNodeIndex const node) const;
+
+    // Sized to the maximum number of blocks up front so that looking a block up never races with
+    // the allocation of another block.
+    std::vector<std::unique_ptr<MctNodeBlock>> blocks_;
+    unsigned num_allocated_blocks_;
+    MctNodeIndex num_nodes_;
+    std::mutex mutex_;
 };
 
-/**
- * @brief AllocateMctNodeId Allocate a node ID which will be unique over the lifetime of the
- * process.
- */
-MctNodeId AllocateMctNodeId();
+inline MctNodeBlock *MctNodeArena::BlockOf(MctNodeIndex const node) {
+    return blocks_[node >> kLog2MctNodeBlockSize].get();
+}
+
+inline MctNodeBlock const *MctNodeArena::BlockOf(MctNodeIndex const node) const {
+    return blocks_[node >> kLog2MctNodeBlockSize].get();
+}
+
+inline float &MctNodeArena::SummedReward(MctNodeIndex const node) {
+    return this->BlockOf(node)->summed_reward[node & (kMctNodeBlockSize - 1)];
+}
+
+inline float const &MctNodeArena::SummedReward(MctNodeIndex const node) const {
+    return this->BlockOf(node)->summed_reward[node & (kMctNodeBlockSize - 1)];
+}
+
+inline std::atomic<unsigned> &MctNodeArena::NumBanditPulls(MctNodeIndex const node) {
+    return this->BlockOf(node)->num_bandit_pulls[node & (kMctNodeBlockSize - 1)];
+}
+
+inline std::atomic<unsigned> const &MctNodeArena::NumBanditPulls(MctNodeIndex const node) const {
+    return this->BlockOf(node)->num_bandit_pulls[node & (kMctNodeBlockSize - 1)];
+}
+
+inline unsigned &MctNodeArena::NumVirtualLosses(MctNodeIndex const node) {
+    return this->BlockOf(node)->num_virtual_losses[node & (kMctNodeBlockSize - 1)];
+}
+
+inline unsigned const &MctNodeArena::NumVirtualLosses(MctNodeIndex const node) const {
+    return this->BlockOf(node)->num_virtual_losses[node & (kMctNodeBlockSize - 1)];
+}
+
+inline float const &MctNodeArena::HeuristicPolicyWeight(MctNodeIndex const node) const {
+    return this->BlockOf(node)->heuristic_policy_weight[node & (kMctNodeBlockSize - 1)];
+}
+
+inline GomokuActionId MctNodeArena::ArrivedThruActionId(MctNodeIndex const node) const {
+    return this->BlockOf(node)->arrived_thru_action_id[node & (kMctNodeBlockSize - 1)];
+}
+
+inline PlayerSide MctNodeArena::ActionPerformedBy(MctNodeIndex const node) const {
+    return static_cast<PlayerSide>(
+        this->BlockOf(node)->action_performed_by[node & (kMctNodeBlockSize - 1)]);
+}
+
+inline GameResult MctNodeArena::GameResultAt(MctNodeIndex const node) const {
+    return static_cast<GameResult>(
+        this->BlockOf(node)->game_result[node & (kMctNodeBlockSize - 1)]);
+}
+
+inline MctNodeIndex MctNodeArena::FirstChild(MctNodeIndex const node) const {
+    return this->BlockOf(node)->first_child[node & (kMctNodeBlockSize - 1)];
+}
+
+inline unsigned MctNodeArena::NumChildren(MctNodeIndex const node) const {
+    return this->BlockOf(node)->num_children[node & (kMctNodeBlockSize - 1)];
+}
 
 } // namespace e8
 
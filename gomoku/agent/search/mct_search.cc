@@ -17,78 +17,136 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <cmath>
 #include <iostream>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
-#include "common/container/mutable_priority_queue.h"
 #include "common/random/random_source.h"
 #include "common/random/sample.h"
+#include "common/thread/thread_pool.h"
+#include "common/time_util/time_util.h"
 #include "gomoku/agent/heuristics/evaluator.h"
 #include "gomoku/agent/search/mct_node.h"
 #include "gomoku/agent/search/mct_search.h"
+#include "gomoku/agent/search/puct_selection.h"
+#include "gomoku/agent/search/transposition_table.h"
 #include "gomoku/game/board_state.h"
 
 namespace e8 {
 namespace {
 
+unsigned const kLog2TranspositionTableSize = 20;
+unsigned const kNumNodeLockStripes = 1024;
+unsigned const kEarlyStoppingCheckInterval = 64;
+
 struct EvaluationResult {
     std::array<float, 2> reward_viewed_by_player;
 };
 
-float UpperConfidenceBound(float const exploration_factor, MctNode const &parent,
-                           MctNode const &node) {
-    float q_value;
-    float uncertainty;
+/**
+ * @brief The SearchContext struct What's shared by the searches descending the tree.
+ */
+struct SearchContext {
+    MctNodeArena *tree;
+    GomokuEvaluatorInterface *evaluator;
+    TranspositionTable *transposition_table;
+    std::vector<std::mutex> *node_locks;
 
-    if (node.num_bandit_pulls > 0) {
-        q_value = node.summed_reward / (node.num_bandit_pulls);
-        uncertainty = exploration_factor * std::sqrt(1.0f + parent.num_bandit_pulls) /
-                      (node.num_bandit_pulls);
-    } else {
-        q_value = 0.0f;
-        uncertainty = exploration_factor;
-    }
+    // Serializes the evaluator calls. It's nullptr if the calls don't need to be serialized.
+    std::mutex *evaluator_lock;
+
+    // Whether there are concurrent or pending searches to be steered away from the current path.
+    bool apply_virtual_loss;
+};
 
-    assert(q_value < 1.05f && q_value > -1.05f);
-    assert(!std::isinf(q_value));
-    assert(!std::isnan(q_value));
-    assert(!std::isinf(uncertainty));
-    assert(!std::isnan(uncertainty));
+/**
+ * @brief The PathNode struct A node on the path of a search.
+ */
+struct PathNode {
+    MctNodeIndex node;
 
-    return q_value + node.heuristic_policy_weight * uncertainty;
+    // Zobrist key of the position at the node.
+    uint64_t position_hash;
+};
+
+/**
+ * @brief The Leaf struct Where a search descending from the root stops, which is either a
+ * terminal state or a node to be expanded.
+ */
+struct Leaf {
+    GomokuBoardState state;
+    std::vector<PathNode> path;
+};
+
+std::mutex *NodeLockOf(MctNodeIndex const node, SearchContext const &context) {
+    return &(*context.node_locks)[node % context.node_locks->size()];
 }
 
-void UpdateMctNode(EvaluationResult const &eval, float const exploration_factor, MctNode *parent,
-                   MctNode *node) {
-    assert(node->action_performed_by.has_value());
-    node->summed_reward += eval.reward_viewed_by_player[*node->action_performed_by];
-    node->num_bandit_pulls += 1;
-    node->upper_confidence_bound = UpperConfidenceBound(exploration_factor, *parent, *node);
+/**
+ * @brief StateIdOf The ID evaluators see for the state. It's the Zobrist key of the position so
+ * that the evaluator caches are shared by transpositions.
+ */
+MctNodeId StateIdOf(GomokuBoardState const &state) {
+    return static_cast<MctNodeId>(state.Hash());
 }
 
-void BackPropagate(EvaluationResult const &eval, float const exploration_factor,
-                   std::vector<MutablePriorityQueue<MctNode>::iterator> *propagation_path) {
-    for (int i = propagation_path->size() - 1; i >= 1; --i) {
-        MctNode *parent = &(*(*propagation_path)[i - 1]);
-        MctNode *node = &(*(*propagation_path)[i]);
-        UpdateMctNode(eval, exploration_factor, parent, node);
+/**
+ * @brief ChildrenOf Statistics of the node's children. They must be read under the node's lock.
+ */
+PuctChildren ChildrenOf(MctNodeArena const &tree, MctNodeIndex const node) {
+    static_assert(sizeof(std::atomic<unsigned>) == sizeof(unsigned));
+    static_assert(std::atomic<unsigned>::is_always_lock_free);
+
+    // The pull counts of the children are only written under the node's lock, so they can be read
+    // as plain integers.
+    MctNodeIndex const first_child = tree.FirstChild(node);
+    return PuctChildren{&tree.SummedReward(first_child),
+                        reinterpret_cast<unsigned const *>(&tree.NumBanditPulls(first_child)),
+                        &tree.NumVirtualLosses(first_child),
+                        &tree.HeuristicPolicyWeight(first_child), tree.NumChildren(node)};
+}
 
-        parent->children.reprioritize((*propagation_path)[i]);
+void UpdateMctNode(EvaluationResult const &eval, bool const remove_virtual_loss,
+                   MctNodeIndex const node, MctNodeArena *tree) {
+    tree->SummedReward(node) += eval.reward_viewed_by_player[tree->ActionPerformedBy(node)];
+    tree->NumBanditPulls(node).fetch_add(1, std::memory_order_relaxed);
+    if (remove_virtual_loss) {
+        assert(tree->NumVirtualLosses(node) > 0);
+        --tree->NumVirtualLosses(node);
     }
-    (*propagation_path)[0]->num_bandit_pulls += 1;
 }
 
-EvaluationResult Evaluate(GomokuBoardState const &state, MctNode const *parent_mct_node,
-                          MctNode const &state_mct_node, GomokuEvaluatorInterface *evaluator) {
+void BackPropagate(EvaluationResult const &eval, SearchContext const &context,
+                   std::vector<PathNode> const &propagation_path) {
+    for (int i = propagation_path.size() - 1; i >= 1; --i) {
+        MctNodeIndex const parent = propagation_path[i - 1].node;
+        MctNodeIndex const node = propagation_path[i].node;
 
-    GameResult game_result = state.CurrentGameResult();
+        std::mutex *lock = NodeLockOf(parent, context);
+        lock->lock();
+        UpdateMctNode(eval, context.apply_virtual_loss, node, context.tree);
+        lock->unlock();
+    }
+    context.tree->NumBanditPulls(propagation_path[0].node)
+        .fetch_add(1, std::memory_order_relaxed);
+
+    if (context.transposition_table != nullptr) {
+        for (PathNode const &path_node : propagation_path) {
+            context.transposition_table->Accumulate(
+                path_node.position_hash, eval.reward_viewed_by_player[PlayerSide::PS_PLAYER_A]);
+        }
+    }
+}
 
+EvaluationResult TerminalResult(GameResult const game_result) {
     EvaluationResult result;
 
     switch (game_result) {
@@ -108,20 +166,7 @@ EvaluationResult Evaluate(GomokuBoardState const &state, MctNode const *parent_m
         break;
     }
     case GR_UNDETERMINED: {
-        float est_reward;
-        if (parent_mct_node != nullptr) {
-            est_reward = evaluator->EvaluateReward(state, parent_mct_node->id, state_mct_node.id);
-        } else {
-            est_reward = evaluator->EvaluateReward(state, /*parent_state_id=*/std::nullopt,
-                                                   state_mct_node.id);
-        }
-
-        assert(est_reward < 1.05f && est_reward > -1.05f);
-        assert(!std::isinf(est_reward));
-        assert(!std::isnan(est_reward));
-
-        result.reward_viewed_by_player[state.CurrentPlayerSide()] = est_reward;
-        result.reward_viewed_by_player[(state.CurrentPlayerSide() + 1) & 1] = -est_reward;
+        assert(false);
         break;
     }
     }
@@ -129,24 +174,35 @@ EvaluationResult Evaluate(GomokuBoardState const &state, MctNode const *parent_m
     return result;
 }
 
-void Expand(MctNode *parent, MctNode *node, GomokuBoardState *state,
-            GomokuEvaluatorInterface *evaluator) {
-    std::unordered_map<GomokuActionId, GomokuAction> actions = state->LegalActions();
+EvaluationResult EstimatedResult(PlayerSide const player_side, float const est_reward) {
+    assert(est_reward < 1.05f && est_reward > -1.05f);
+    assert(!std::isinf(est_reward));
+    assert(!std::isnan(est_reward));
 
-    std::unordered_map<GomokuActionId, float> heuristics_policy;
-    if (parent != nullptr) {
-        heuristics_policy = evaluator->EvaluatePolicy(*state, parent->id, node->id);
-    } else {
-        heuristics_policy =
-            evaluator->EvaluatePolicy(*state, /*parent_state_id=*/std::nullopt, node->id);
+    EvaluationResult result;
+    result.reward_viewed_by_player[player_side] = est_reward;
+    result.reward_viewed_by_player[(player_side + 1) & 1] = -est_reward;
+    return result;
+}
+
+void Expand(std::unordered_map<GomokuActionId, float> const &heuristics_policy,
+            MctNodeIndex const node, GomokuBoardState const &state, SearchContext const &context) {
+    unsigned const num_children = state.LegalActions().size();
+    if (num_children == 0) {
+        return;
+    }
+
+    std::optional<MctNodeIndex> first_child = context.tree->Allocate(num_children);
+    if (!first_child.has_value()) {
+        // The tree is full. The node stays a leaf.
+        return;
     }
 
     // Expand the node and assign the heuristics policy as the bandits' prior.
-    PlayerSide const action_performer = state->CurrentPlayerSide();
-    for (auto const &[action_id, _] : actions) {
-        GameResult game_result = state->ApplyAction(action_id,
-                                                    /*cached_game_result=*/std::nullopt);
-        state->RetractAction();
+    PlayerSide const action_performer = state.CurrentPlayerSide();
+    MctNodeIndex child = *first_child;
+    for (auto const &[action_id, _] : state.LegalActions()) {
+        GameResult game_result = state.GameResultAfter(action_id);
 
         float policy_weight = 0.0f;
         auto policy_weight_it = heuristics_policy.find(action_id);
@@ -154,48 +210,298 @@ void Expand(MctNode *parent, MctNode *node, GomokuBoardState *state,
             policy_weight = policy_weight_it->second;
         }
 
-        MctNodeId const node_id = AllocateMctNodeId();
-        MctNode child(node_id, action_id, action_performer, game_result, policy_weight);
-        child.upper_confidence_bound =
-            UpperConfidenceBound(evaluator->ExplorationFactor(), *node, child);
-        node->children.push(child);
+        context.tree->Initialize(child, action_id, action_performer, game_result, policy_weight);
+        ++child;
     }
+
+    std::mutex *lock = NodeLockOf(node, context);
+    lock->lock();
+
+    // Another search may have expanded the node while the policy was being evaluated, in which case
+    // the span allocated here is left unused.
+    if (context.tree->NumChildren(node) == 0) {
+        context.tree->SetChildren(node, *first_child, num_children);
+    }
+
+    lock->unlock();
 }
 
-void SelectFrom(MctNode *parent, MctNode *node, GomokuBoardState *state,
-                GomokuEvaluatorInterface *evaluator,
-                std::vector<MutablePriorityQueue<MctNode>::iterator> *propagation_path) {
-    if (state->CurrentGameResult() != GR_UNDETERMINED) {
-        EvaluationResult eval = Evaluate(*state, parent, *node, evaluator);
-        BackPropagate(eval, evaluator->ExplorationFactor(), propagation_path);
-        return;
+/**
+ * @brief Descend Walks down from the root through the children of the highest upper confidence
+ * bound until it reaches a leaf. The leaf's state has to start at the root state. See Rewind().
+ */
+void Descend(PathNode const &root, SearchContext const &context, Leaf *leaf) {
+    leaf->path.clear();
+    leaf->path.push_back(root);
+
+    MctNodeArena *tree = context.tree;
+    MctNodeIndex node = root.node;
+    while (leaf->state.CurrentGameResult() == GR_UNDETERMINED) {
+        std::mutex *lock = NodeLockOf(node, context);
+        lock->lock();
+
+        if (tree->NumChildren(node) == 0) {
+            lock->unlock();
+            break;
+        }
+
+        // The scores are computed afresh since the parent's pull count changes the exploration
+        // term of every child.
+        MctNodeIndex const candidate =
+            tree->FirstChild(node) +
+            HighestPuctScore(context.evaluator->ExplorationFactor(),
+                             tree->NumBanditPulls(node).load(std::memory_order_relaxed),
+                             ChildrenOf(*tree, node));
+        if (context.apply_virtual_loss) {
+            ++tree->NumVirtualLosses(candidate);
+        }
+        lock->unlock();
+
+        leaf->state.ApplyAction(tree->ArrivedThruActionId(candidate),
+                                tree->GameResultAt(candidate));
+        leaf->path.push_back(PathNode{candidate, leaf->state.Hash()});
+        node = candidate;
     }
+}
 
-    if (node->children.empty()) {
-        Expand(parent, node, state, evaluator);
-        EvaluationResult eval = Evaluate(*state, parent, *node, evaluator);
-        BackPropagate(eval, evaluator->ExplorationFactor(), propagation_path);
-        return;
+/**
+ * @brief Rewind Retracts the leaf's state back to the root state.
+ */
+void Rewind(Leaf *leaf) {
+    for (unsigned i = 1; i < leaf->path.size(); ++i) {
+        leaf->state.RetractAction();
     }
+}
 
-    auto candidate_it = node->children.front();
-    state->ApplyAction(*candidate_it->arrived_thru_action_id, candidate_it->game_result);
-    propagation_path->push_back(candidate_it);
+/**
+ * @brief EvaluateLeaves Evaluates the non-terminal leaves through one evaluator call, then expands
+ * and back propagates each of them. A leaf whose position has been visited through another action
+ * sequence takes the position's mean reward, which is more informed than a fresh evaluation.
+ */
+void EvaluateLeaves(std::vector<Leaf> const &leaves, unsigned const num_leaves,
+                    SearchContext const &context) {
+    std::vector<GomokuEvaluationRequest> requests(num_leaves);
+    std::vector<float> transposition_rewards(num_leaves);
+    for (unsigned i = 0; i < num_leaves; ++i) {
+        Leaf const &leaf = leaves[i];
+
+        requests[i].state = &leaf.state;
+        requests[i].parent_state_id = std::nullopt;
+        if (leaf.path.size() > 1) {
+            requests[i].parent_state_id =
+                static_cast<MctNodeId>(leaf.path[leaf.path.size() - 2].position_hash);
+        }
+        requests[i].state_id = static_cast<MctNodeId>(leaf.path.back().position_hash);
+        requests[i].reward_needed = true;
+
+        if (context.transposition_table != nullptr) {
+            std::optional<TranspositionStats> stats =
+                context.transposition_table->Probe(leaf.path.back().position_hash);
+            if (stats.has_value()) {
+                transposition_rewards[i] = stats->summed_reward / stats->num_visits;
+                requests[i].reward_needed = false;
+            }
+        }
+    }
 
-    SelectFrom(node, &(*candidate_it), state, evaluator, propagation_path);
+    if (context.evaluator_lock != nullptr) {
+        context.evaluator_lock->lock();
+    }
+    std::vector<GomokuEvaluation> evaluations = context.evaluator->EvaluateBatch(requests);
+    if (context.evaluator_lock != nullptr) {
+        context.evaluator_lock->unlock();
+    }
+    assert(evaluations.size() == num_leaves);
+
+    for (unsigned i = 0; i < num_leaves; ++i) {
+        Leaf const &leaf = leaves[i];
+        Expand(evaluations[i].policy, leaf.path.back().node, leaf.state, context);
 
-    propagation_path->pop_back();
-    state->RetractAction();
+        EvaluationResult eval;
+        if (requests[i].reward_needed) {
+            eval = EstimatedResult(leaf.state.CurrentPlayerSide(), evaluations[i].reward);
+        } else {
+            eval = EstimatedResult(PlayerSide::PS_PLAYER_A, transposition_rewards[i]);
+        }
+        BackPropagate(eval, context, leaf.path);
+    }
+}
+
+/**
+ * @brief The SearchLimits struct When the searches descending the tree should stop.
+ */
+struct SearchLimits {
+    unsigned max_num_simulations;
+    std::optional<TimestampMicros> deadline;
+    bool early_stopping;
+
+    // Set by another thread to stop the searches.
+    std::atomic<bool> const *stop_requested;
+};
+
+/**
+ * @brief The SearchProgress struct What's been done by the searches descending the tree.
+ */
+struct SearchProgress {
+    TimestampMicros start;
+    std::atomic<unsigned> num_started;
+    std::atomic<bool> stopped_early;
+};
+
+/**
+ * @brief Overtakable Whether the second most visited child of the root could still overtake the
+ * most visited one in the remaining simulations.
+ */
+bool Overtakable(MctNodeIndex const root, SearchContext const &context,
+                 unsigned const num_remaining) {
+    MctNodeArena const &tree = *context.tree;
+
+    std::mutex *lock = NodeLockOf(root, context);
+    lock->lock();
+
+    unsigned most_visits = 0;
+    unsigned second_most_visits = 0;
+    for (unsigned i = 0; i < tree.NumChildren(root); ++i) {
+        unsigned num_visits =
+            tree.NumBanditPulls(tree.FirstChild(root) + i).load(std::memory_order_relaxed);
+        if (num_visits > most_visits) {
+            second_most_visits = most_visits;
+            most_visits = num_visits;
+        } else if (num_visits > second_most_visits) {
+            second_most_visits = num_visits;
+        }
+    }
+
+    lock->unlock();
+
+    return most_visits - second_most_visits <= num_remaining;
 }
 
-std::unordered_map<GomokuActionId, float> ExtractStochasticPolicy(MctNode const &root,
+/**
+ * @brief StartSimulation Claims a simulation from the budget.
+ *
+ * @return false if the searches should stop. The first simulation is always granted so that
+ * there is a policy to return.
+ */
+bool StartSimulation(MctNodeIndex const root, SearchContext const &context,
+                     SearchLimits const &limits, SearchProgress *progress) {
+    unsigned const num_started = progress->num_started.fetch_add(1, std::memory_order_relaxed);
+    if (num_started == 0) {
+        return true;
+    }
+    if (num_started >= limits.max_num_simulations ||
+        limits.stop_requested->load(std::memory_order_relaxed) ||
+        progress->stopped_early.load(std::memory_order_relaxed)) {
+        return false;
+    }
+
+    TimestampMicros now = 0;
+    if (limits.deadline.has_value()) {
+        now = CurrentTimestampMicros();
+        if (now >= *limits.deadline) {
+            return false;
+        }
+    }
+
+    if (limits.early_stopping && num_started % kEarlyStoppingCheckInterval == 0) {
+        unsigned num_remaining = limits.max_num_simulations - num_started;
+        if (limits.deadline.has_value() && now > progress->start) {
+            // Extrapolates from the rate so far.
+            double rate = static_cast<double>(num_started) / (now - progress->start);
+            num_remaining = std::min(
+                num_remaining, static_cast<unsigned>(rate * (*limits.deadline - now)) + 1);
+        }
+        if (!Overtakable(root, context, num_remaining)) {
+            progress->stopped_early.store(true, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief RunSimulations Keeps searching from the root until the limits are reached. The leaves are
+ * evaluated in batches of the evaluator's preferred size, whereas terminal states are back
+ * propagated right away.
+ */
+void RunSimulations(GomokuBoardState const &state, PathNode const &root,
+                    SearchContext const &context, SearchLimits const &limits,
+                    SearchProgress *progress) {
+    unsigned const batch_size = context.evaluator->EvaluationBatchSize();
+    assert(batch_size > 0);
+
+    std::vector<Leaf> leaves(batch_size, Leaf{state, /*path=*/{}});
+
+    bool budget_left = true;
+    while (budget_left) {
+        unsigned num_pending = 0;
+        while (num_pending < batch_size) {
+            budget_left = StartSimulation(root.node, context, limits, progress);
+            if (!budget_left) {
+                break;
+            }
+
+            Leaf *leaf = &leaves[num_pending];
+            Descend(root, context, leaf);
+
+            GameResult game_result = leaf->state.CurrentGameResult();
+            if (game_result != GR_UNDETERMINED) {
+                BackPropagate(TerminalResult(game_result), context, leaf->path);
+                Rewind(leaf);
+            } else {
+                ++num_pending;
+            }
+        }
+
+        if (num_pending > 0) {
+            EvaluateLeaves(leaves, num_pending, context);
+            for (unsigned i = 0; i < num_pending; ++i) {
+                Rewind(&leaves[i]);
+            }
+        }
+    }
+}
+
+class SearchData : public TaskStorageInterface {
+  public:
+    SearchData(GomokuBoardState const &state, PathNode const &root, SearchContext const &context,
+               SearchLimits const &limits, SearchProgress *progress);
+
+    GomokuBoardState const state;
+    PathNode const root;
+    SearchContext const context;
+    SearchLimits const limits;
+    SearchProgress *const progress;
+};
+
+SearchData::SearchData(GomokuBoardState const &state, PathNode const &root,
+                       SearchContext const &context, SearchLimits const &limits,
+                       SearchProgress *progress)
+    : state(state), root(root), context(context), limits(limits), progress(progress) {}
+
+class SearchTask : public TaskInterface {
+  public:
+    void Run(TaskStorageInterface *storage) const override;
+    bool DropResourceOnCompletion() const override;
+};
+
+void SearchTask::Run(TaskStorageInterface *storage) const {
+    SearchData *data = static_cast<SearchData *>(storage);
+    RunSimulations(data->state, data->root, data->context, data->limits, data->progress);
+}
+
+bool SearchTask::DropResourceOnCompletion() const { return false; }
+
+std::unordered_map<GomokuActionId, float> ExtractStochasticPolicy(MctNodeArena const &tree,
+                                                                  MctNodeIndex const root,
                                                                   float const temperature) {
-    std::unordered_map<GomokuActionId, float> policy(root.children.size());
+    std::unordered_map<GomokuActionId, float> policy(tree.NumChildren(root));
     unsigned total_num_bandit_pulls = 0;
-    for (auto const &child : root.children) {
-        assert(child.arrived_thru_action_id.has_value());
-        float exp_count = std::pow(child.num_bandit_pulls, 1 / temperature);
-        policy[*child.arrived_thru_action_id] = exp_count;
+    for (unsigned i = 0; i < tree.NumChildren(root); ++i) {
+        MctNodeIndex const child = tree.FirstChild(root) + i;
+        float exp_count = std::pow(tree.NumBanditPulls(child).load(), 1 / temperature);
+        policy[tree.ArrivedThruActionId(child)] = exp_count;
         total_num_bandit_pulls += exp_count;
     }
 
@@ -208,13 +514,15 @@ std::unordered_map<GomokuActionId, float> ExtractStochasticPolicy(MctNode const
     return policy;
 }
 
-void PrintMctsStats(MctNode const &root, GomokuBoardState const &state) {
+void PrintMctsStats(MctNodeArena const &tree, MctNodeIndex const root,
+                    GomokuBoardState const &state, float const exploration_factor) {
     std::cout << "--------------------------------" << std::endl;
 
-    for (auto const &child : root.children) {
-        if (child.num_bandit_pulls > 0) {
-            assert(child.arrived_thru_action_id.has_value());
-            GomokuAction const &action = state.LegalActions().at(*child.arrived_thru_action_id);
+    for (unsigned i = 0; i < tree.NumChildren(root); ++i) {
+        MctNodeIndex const child = tree.FirstChild(root) + i;
+        unsigned const num_bandit_pulls = tree.NumBanditPulls(child);
+        if (num_bandit_pulls > 0) {
+            GomokuAction const &action = state.LegalActions().at(tree.ArrivedThruActionId(child));
 
             if (action.stone_pos.has_value()) {
                 std::cout << "(" << static_cast<int>(action.stone_pos->x) << ","
@@ -251,9 +559,13 @@ void PrintMctsStats(MctNode const &root, GomokuBoardState const &state) {
                 }
             }
 
-            std::cout << "|reward=" << child.summed_reward / child.num_bandit_pulls
-                      << "|n=" << child.num_bandit_pulls << "|ucb=" << child.upper_confidence_bound
-                      << "|p=" << child.heuristic_policy_weight << std::endl;
+            float const upper_confidence_bound =
+                PuctScore(exploration_factor, tree.NumBanditPulls(root), tree.SummedReward(child),
+                          num_bandit_pulls, tree.NumVirtualLosses(child),
+                          tree.HeuristicPolicyWeight(child));
+            std::cout << "|reward=" << tree.SummedReward(child) / num_bandit_pulls
+                      << "|n=" << num_bandit_pulls << "|ucb=" << upper_confidence_bound
+                      << "|p=" << tree.HeuristicPolicyWeight(child) << std::endl;
         }
     }
 
@@ -263,63 +575,193 @@ void PrintMctsStats(MctNode const &root, GomokuBoardState const &state) {
 } // namespace
 
 MctSearcher::MctSearcher(std::shared_ptr<GomokuEvaluatorInterface> const &evaluator,
-                         bool const print_stats)
-    : evaluator_(evaluator), print_stats_(print_stats) {
+                         bool const print_stats, bool const use_transposition_table,
+                         unsigned const num_search_threads)
+    : tree_(std::make_unique<MctNodeArena>()), spare_tree_(std::make_unique<MctNodeArena>()),
+      evaluator_(evaluator), node_locks_(kNumNodeLockStripes), stop_requested_(false),
+      stop_pondering_(false), print_stats_(print_stats) {
+    assert(num_search_threads > 0);
+    if (use_transposition_table) {
+        transposition_table_ = std::make_unique<TranspositionTable>(kLog2TranspositionTableSize);
+    }
+    if (num_search_threads > 1) {
+        search_threads_ = std::make_unique<ThreadPool>(num_search_threads);
+    }
     this->Reset();
 }
 
+MctSearcher::~MctSearcher() { this->StopPondering(); }
+
 std::unordered_map<GomokuActionId, float> MctSearcher::SearchFrom(GomokuBoardState state,
                                                                   float const temperature) {
-    assert(current_node_it_.has_value());
-    evaluator_->ClearCache();
+    SearchBudget budget;
+    budget.max_num_simulations = evaluator_->NumSimulations();
+    budget.early_stopping = false;
+    return this->SearchFrom(state, temperature, budget);
+}
 
-    MutablePriorityQueue<MctNode>::iterator *root = &current_node_it_.value();
+std::unordered_map<GomokuActionId, float>
+MctSearcher::SearchFrom(GomokuBoardState state, float const temperature,
+                        SearchBudget const &budget) {
+    this->StopPondering();
+    stop_requested_.store(false);
 
-    std::vector<MutablePriorityQueue<MctNode>::iterator> propagation_path{*root};
-    for (unsigned i = 0; i < evaluator_->NumSimulations(); ++i) {
-        SelectFrom(/*parent=*/nullptr, &(**root), &state, evaluator_.get(), &propagation_path);
+    if (state.CurrentGameResult() != GR_UNDETERMINED) {
+        // There is nothing to search for once the game is decided.
+        last_search_stats_ = SearchStats();
+        return std::unordered_map<GomokuActionId, float>();
     }
 
+    TimestampMicros start = CurrentTimestampMicros();
+    unsigned const num_reused_simulations = tree_->NumBanditPulls(root_).load();
+
+    bool stopped_early;
+    this->Search(state, budget, &stop_requested_, &stopped_early);
+
+    last_search_stats_.num_simulations =
+        tree_->NumBanditPulls(root_).load() - num_reused_simulations;
+    last_search_stats_.num_reused_simulations = num_reused_simulations;
+    last_search_stats_.latency = CurrentTimestampMicros() - start;
+    last_search_stats_.stopped_early = stopped_early;
+
     if (print_stats_) {
-        PrintMctsStats(**root, state);
+        PrintMctsStats(*tree_, root_, state, evaluator_->ExplorationFactor());
+        std::cout << "simulations=" << last_search_stats_.num_simulations
+                  << "|reused=" << last_search_stats_.num_reused_simulations
+                  << "|latency_ms=" << last_search_stats_.latency / 1000
+                  << "|stopped_early=" << last_search_stats_.stopped_early << std::endl;
     }
 
-    return ExtractStochasticPolicy(**root, temperature);
+    return ExtractStochasticPolicy(*tree_, root_, temperature);
+}
+
+void MctSearcher::Stop() { stop_requested_.store(true); }
+
+SearchStats MctSearcher::LastSearchStats() const { return last_search_stats_; }
+
+void MctSearcher::StartPondering(GomokuBoardState const &state) {
+    this->StopPondering();
+    stop_pondering_.store(false);
+
+    if (state.CurrentGameResult() != GR_UNDETERMINED) {
+        return;
+    }
+
+    ponder_thread_ = std::thread([this, state]() {
+        SearchBudget budget;
+        budget.max_num_simulations = std::numeric_limits<unsigned>::max();
+        budget.early_stopping = false;
+
+        bool stopped_early;
+        this->Search(state, budget, &stop_pondering_, &stopped_early);
+    });
+}
+
+void MctSearcher::StopPondering() {
+    if (ponder_thread_.joinable()) {
+        stop_pondering_.store(true);
+        ponder_thread_.join();
+    }
+}
+
+void MctSearcher::Search(GomokuBoardState const &state, SearchBudget const &budget,
+                         std::atomic<bool> const *stop_requested, bool *stopped_early) {
+    assert(budget.max_num_simulations.has_value() || budget.max_duration.has_value());
+    evaluator_->ClearCache();
+
+    bool const parallel = search_threads_ != nullptr;
+    std::mutex *evaluator_lock =
+        parallel && !evaluator_->ThreadSafe() ? &evaluator_lock_ : nullptr;
+    bool const apply_virtual_loss = parallel || evaluator_->EvaluationBatchSize() > 1;
+    SearchContext const context{tree_.get(), evaluator_.get(), transposition_table_.get(),
+                                &node_locks_, evaluator_lock, apply_virtual_loss};
+
+    SearchProgress progress{CurrentTimestampMicros(), /*num_started=*/{0},
+                            /*stopped_early=*/{false}};
+    SearchLimits limits{std::numeric_limits<unsigned>::max(), std::nullopt, budget.early_stopping,
+                        stop_requested};
+    if (budget.max_num_simulations.has_value()) {
+        limits.max_num_simulations = *budget.max_num_simulations;
+    }
+    if (budget.max_duration.has_value()) {
+        limits.deadline = progress.start + *budget.max_duration;
+    }
+
+    PathNode const root_path_node{root_, state.Hash()};
+
+    if (!parallel) {
+        RunSimulations(state, root_path_node, context, limits, &progress);
+    } else {
+        auto task = std::make_shared<SearchTask>();
+        std::vector<std::unique_ptr<TaskStorageInterface>> searches;
+        for (unsigned i = 0; i < search_threads_->NumWorkers(); ++i) {
+            searches.push_back(
+                std::make_unique<SearchData>(state, root_path_node, context, limits, &progress));
+        }
+        search_threads_->ScheduleMany(task, std::move(searches));
+
+        for (unsigned i = 0; i < search_threads_->NumWorkers(); ++i) {
+            search_threads_->WaitForNextCompleted();
+        }
+    }
+
+    *stopped_early = progress.stopped_early.load();
 }
 
 void MctSearcher::SelectAction(GomokuBoardState state, GomokuActionId const action_id) {
-    assert(current_node_it_.has_value());
     assert(state.LegalActions().find(action_id) != state.LegalActions().end());
-
-    if (current_node_it_.value()->children.empty()) {
-        Expand(/*parent=*/nullptr, &(*current_node_it_.value()), &state, evaluator_.get());
+    this->StopPondering();
+
+    if (tree_->NumChildren(root_) == 0) {
+        SearchContext const context{tree_.get(),
+                                    evaluator_.get(),
+                                    transposition_table_.get(),
+                                    &node_locks_,
+                                    /*evaluator_lock=*/nullptr,
+                                    /*apply_virtual_loss=*/false};
+        std::unordered_map<GomokuActionId, float> heuristics_policy = evaluator_->EvaluatePolicy(
+            state, /*parent_state_id=*/std::nullopt, StateIdOf(state));
+        Expand(heuristics_policy, root_, state, context);
     }
 
-    MutablePriorityQueue<MctNode>::iterator next_node;
-    for (auto it = current_node_it_.value()->children.begin();
-         it != current_node_it_.value()->children.end(); ++it) {
-        assert(it->arrived_thru_action_id.has_value());
-        if (*it->arrived_thru_action_id == action_id) {
-            next_node = it;
-        } else {
-            it->children.clear();
+    std::optional<MctNodeIndex> next_node;
+    for (unsigned i = 0; i < tree_->NumChildren(root_); ++i) {
+        MctNodeIndex const child = tree_->FirstChild(root_) + i;
+        if (tree_->ArrivedThruActionId(child) == action_id) {
+            next_node = child;
+            break;
         }
     }
 
-    current_node_it_ = next_node;
+    // Keeps only the selected subtree.
+    spare_tree_->Clear();
+    std::optional<MctNodeIndex> new_root;
+    if (next_node.has_value()) {
+        new_root = spare_tree_->CopySubtree(*tree_, *next_node);
+    }
+    tree_->Clear();
+    std::swap(tree_, spare_tree_);
+
+    if (new_root.has_value()) {
+        root_ = *new_root;
+    } else {
+        // The subtree couldn't be kept, so the search restarts from a fresh root.
+        tree_->Clear();
+        root_ = *tree_->Allocate(1);
+        tree_->InitializeRoot(root_);
+    }
 }
 
 void MctSearcher::Reset() {
-    root_.clear();
-
-    MctNodeId const node_id = AllocateMctNodeId();
-    root_.push(MctNode(node_id,
-                       /*arrived_thru_action_id=*/std::nullopt,
-                       /*action_performed_by=*/std::nullopt,
-                       /*game_result=*/GameResult::GR_UNDETERMINED,
-                       /*heuristic_policy_weight=*/std::numeric_limits<float>::infinity()));
+    this->StopPondering();
+    tree_->Clear();
+    spare_tree_->Clear();
+    if (transposition_table_ != nullptr) {
+        transposition_table_->Clear();
+    }
 
-    current_node_it_ = root_.begin();
+    root_ = *tree_->Allocate(1);
+    tree_->InitializeRoot(root_);
 }
 
 GomokuActionId BestAction(std::unordered_map<GomokuActionId, float> const &policy) {
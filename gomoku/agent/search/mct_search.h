@@ -18,18 +18,59 @@
 #ifndef MCT_SEARCH_H
 #define MCT_SEARCH_H
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
-#include "common/container/mutable_priority_queue.h"
 #include "common/random/random_source.h"
+#include "common/thread/thread_pool.h"
+#include "common/time_util/time_util.h"
 #include "gomoku/agent/heuristics/evaluator.h"
 #include "gomoku/agent/search/mct_node.h"
+#include "gomoku/agent/search/transposition_table.h"
 #include "gomoku/game/board_state.h"
 
 namespace e8 {
 
+/**
+ * @brief The SearchBudget struct Limits how long a SearchFrom() call may search. The search stops
+ * at whichever limit is reached first. At least one of the limits has to be set.
+ */
+struct SearchBudget {
+    // The maximum number of simulations to run.
+    std::optional<unsigned> max_num_simulations;
+
+    // The maximum wall time to search for.
+    std::optional<TimestampMicros> max_duration;
+
+    // Whether to stop as soon as the most visited action can no longer be overtaken by the second
+    // within what's left of the budget.
+    bool early_stopping = true;
+};
+
+/**
+ * @brief The SearchStats struct Instrumentation of a SearchFrom() call.
+ */
+struct SearchStats {
+    // The number of simulations run by the call.
+    unsigned num_simulations = 0;
+
+    // The number of simulations the root had been through before the call, by the searches and
+    // the pondering from the ancestor states.
+    unsigned num_reused_simulations = 0;
+
+    // Wall time the call took.
+    TimestampMicros latency = 0;
+
+    // Whether the call stopped before exhausting the budget because the most visited action could
+    // no longer be overtaken.
+    bool stopped_early = false;
+};
+
 /**
  * @brief The MctSearcher class Holds a Monte Carlo search tree for a sequence of tree search
  * operations.
@@ -42,15 +83,23 @@ class MctSearcher {
      *
      * @param evaluator Heuristics to help guide the tree search.
      * @param print_stats Whether to print the internal stats after each SearchFrom() call.
+     * @param use_transposition_table Whether to share the statistics of a position among the tree
+     * nodes reaching it through different action sequences. A leaf whose position has been visited
+     * takes the position's mean reward instead of being evaluated again.
+     * @param num_search_threads The number of threads descending the search tree concurrently in
+     * SearchFrom(). With more than one thread, each search applies a virtual loss to the nodes on
+     * its path so that the others are steered towards different paths. The evaluator calls are
+     * serialized unless the evaluator is thread safe.
      */
-    MctSearcher(std::shared_ptr<GomokuEvaluatorInterface> const &evaluator, bool const print_stats);
+    MctSearcher(std::shared_ptr<GomokuEvaluatorInterface> const &evaluator, bool const print_stats,
+                bool const use_transposition_table = true, unsigned const num_search_threads = 1);
     MctSearcher(MctSearcher const &) = delete;
     MctSearcher(MctSearcher &&) = delete;
-    ~MctSearcher() = default;
+    ~MctSearcher();
 
     /**
-     * @brief Reset Clear the existing search tree if there is one. All the currently holding
-     * iterators will be invalidated. Then point the internal tree node iterator to the new root.
+     * @brief Reset Clear the existing search tree if there is one, as well as the transposition
+     * table. Then point the internal tree node to the new root.
      */
     void Reset();
 
@@ -64,25 +113,82 @@ class MctSearcher {
      * @param temperature Controls how "flat" the output policy distribution should be. The
      * resulting policy PMF is normalized as policy_pmf[action_id] =
      * visit_count[action_id]^(1/temperature) / sum(visit_count[action_id]^(1/temperature))
-     * @return A stochastic policy.
+     * @return A stochastic policy, or an empty one without searching if the game has been decided
+     * at the state.
      */
     std::unordered_map<GomokuActionId, float> SearchFrom(GomokuBoardState state,
                                                          float const temperature);
 
+    /**
+     * @brief SearchFrom Same as above except that the search runs within the budget instead of
+     * the evaluator's NumSimulations(). The policy of whatever has been searched is returned when
+     * the budget runs out or Stop() is called.
+     */
+    std::unordered_map<GomokuActionId, float>
+    SearchFrom(GomokuBoardState state, float const temperature, SearchBudget const &budget);
+
+    /**
+     * @brief Stop Makes the SearchFrom() call in progress return as soon as the simulations
+     * running finish. It can be called from any thread.
+     */
+    void Stop();
+
+    /**
+     * @brief LastSearchStats Instrumentation of the last SearchFrom() call.
+     */
+    SearchStats LastSearchStats() const;
+
+    /**
+     * @brief StartPondering Keeps searching from the state in the background, typically on the
+     * opponent's time, until StopPondering() is called. The searcher's other operations stop the
+     * pondering first. SelectAction() keeps the statistics gathered for the subtree of the action
+     * taken. Nothing is searched if the game has been decided at the state.
+     *
+     * @param state Board state to search from. It must correspond to the internal tree node.
+     */
+    void StartPondering(GomokuBoardState const &state);
+
+    /**
+     * @brief StopPondering Waits for the background search to stop, if there is one.
+     */
+    void StopPondering();
+
     /**
      * @brief SelectAction Explicitly transition to a state. If the internal from_state_node has
      * not yet expanded by the MctSearcher's SearchFrom() call, this function will force an
      * expansion with policy evaluation even though the selection has nothing to do with the
-     * heuristic policy. The transition will free the memory allocated for the rest of the children.
+     * heuristic policy. The subtree of the selected child is compacted into a fresh tree and the
+     * rest of the tree is released at once.
      *
      * @param from_state_node The parent node to transition from.
      */
     void SelectAction(GomokuBoardState state, GomokuActionId const action_id);
 
   private:
-    MutablePriorityQueue<MctNode> root_;
-    std::optional<MutablePriorityQueue<MctNode>::iterator> current_node_it_;
+    void Search(GomokuBoardState const &state, SearchBudget const &budget,
+                std::atomic<bool> const *stop_requested, bool *stopped_early);
+
+    // The subtree kept by SelectAction() is compacted into the spare tree, then the two are
+    // swapped.
+    std::unique_ptr<MctNodeArena> tree_;
+    std::unique_ptr<MctNodeArena> spare_tree_;
+    MctNodeIndex root_;
+
     std::shared_ptr<GomokuEvaluatorInterface> evaluator_;
+    std::unique_ptr<TranspositionTable> transposition_table_;
+
+    // A node's lock stripe, picked by the node's index, guards the node's children span as well as
+    // the statistics of the children.
+    std::vector<std::mutex> node_locks_;
+    std::mutex evaluator_lock_;
+    std::unique_ptr<ThreadPool> search_threads_;
+
+    std::atomic<bool> stop_requested_;
+    SearchStats last_search_stats_;
+
+    std::thread ponder_thread_;
+    std::atomic<bool> stop_pondering_;
+
     bool const print_stats_;
 };
 
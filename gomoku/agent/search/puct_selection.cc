@@ -0,0 +1,162 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "gomoku/agent/search/puct_selection.h"
+
+namespace e8 {
+
+float PuctScore(float const exploration_factor, unsigned const parent_num_bandit_pulls,
+                float const summed_reward, unsigned const num_bandit_pulls,
+                unsigned const num_virtual_losses, float const heuristic_policy_weight) {
+    float q_value;
+    float uncertainty;
+
+    unsigned const num_pulls = num_bandit_pulls + num_virtual_losses;
+    if (num_pulls > 0) {
+        q_value = (summed_reward - num_virtual_losses) / num_pulls;
+        uncertainty = exploration_factor * std::sqrt(1.0f + parent_num_bandit_pulls) / num_pulls;
+    } else {
+        q_value = 0.0f;
+        uncertainty = exploration_factor;
+    }
+
+    assert(q_value < 1.05f && q_value > -1.05f);
+    assert(!std::isinf(q_value));
+    assert(!std::isnan(q_value));
+    assert(!std::isinf(uncertainty));
+    assert(!std::isnan(uncertainty));
+
+    return q_value + heuristic_policy_weight * uncertainty;
+}
+
+unsigned HighestPuctScoreScalar(float const exploration_factor,
+                                unsigned const parent_num_bandit_pulls,
+                                PuctChildren const &children) {
+    assert(children.num_children > 0);
+
+    unsigned best = 0;
+    float best_score = -std::numeric_limits<float>::infinity();
+    for (unsigned i = 0; i < children.num_children; ++i) {
+        float score = PuctScore(exploration_factor, parent_num_bandit_pulls,
+                                children.summed_rewards[i], children.num_bandit_pulls[i],
+                                children.num_virtual_losses[i],
+                                children.heuristic_policy_weights[i]);
+        if (score > best_score) {
+            best = i;
+            best_score = score;
+        }
+    }
+    return best;
+}
+
+#ifdef __AVX2__
+
+unsigned HighestPuctScore(float const exploration_factor, unsigned const parent_num_bandit_pulls,
+                          PuctChildren const &children) {
+    assert(children.num_children > 0);
+
+    unsigned const kNumLanes = 8;
+
+    __m256 const exploration = _mm256_set1_ps(exploration_factor);
+    __m256 const scaled_exploration =
+        _mm256_set1_ps(exploration_factor * std::sqrt(1.0f + parent_num_bandit_pulls));
+    __m256i const lane_offsets = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    __m256 best_scores = _mm256_set1_ps(-std::numeric_limits<float>::infinity());
+    __m256i best_indices = _mm256_setzero_si256();
+
+    unsigned i = 0;
+    for (; i + kNumLanes <= children.num_children; i += kNumLanes) {
+        __m256 summed_rewards = _mm256_loadu_ps(children.summed_rewards + i);
+        __m256i num_bandit_pulls = _mm256_loadu_si256(
+            reinterpret_cast<__m256i const *>(children.num_bandit_pulls + i));
+        __m256i num_virtual_losses = _mm256_loadu_si256(
+            reinterpret_cast<__m256i const *>(children.num_virtual_losses + i));
+        __m256 weights = _mm256_loadu_ps(children.heuristic_policy_weights + i);
+
+        __m256i num_pulls = _mm256_add_epi32(num_bandit_pulls, num_virtual_losses);
+        __m256 num_pulls_f = _mm256_cvtepi32_ps(num_pulls);
+        __m256 q_values = _mm256_div_ps(
+            _mm256_sub_ps(summed_rewards, _mm256_cvtepi32_ps(num_virtual_losses)), num_pulls_f);
+        __m256 uncertainties = _mm256_div_ps(scaled_exploration, num_pulls_f);
+
+        // Children never pulled have a Q value of zero and the bare exploration factor as the
+        // uncertainty. The lanes divided by zero are discarded here.
+        __m256 unpulled =
+            _mm256_castsi256_ps(_mm256_cmpeq_epi32(num_pulls, _mm256_setzero_si256()));
+        q_values = _mm256_blendv_ps(q_values, _mm256_setzero_ps(), unpulled);
+        uncertainties = _mm256_blendv_ps(uncertainties, exploration, unpulled);
+
+        __m256 scores = _mm256_add_ps(q_values, _mm256_mul_ps(weights, uncertainties));
+
+        __m256 better = _mm256_cmp_ps(scores, best_scores, _CMP_GT_OQ);
+        best_scores = _mm256_blendv_ps(best_scores, scores, better);
+        best_indices =
+            _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(best_indices),
+                                                 _mm256_castsi256_ps(_mm256_add_epi32(
+                                                     _mm256_set1_epi32(i), lane_offsets)),
+                                                 better));
+    }
+
+    alignas(32) float lane_scores[kNumLanes];
+    alignas(32) unsigned lane_indices[kNumLanes];
+    _mm256_store_ps(lane_scores, best_scores);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lane_indices), best_indices);
+
+    unsigned best = 0;
+    float best_score = -std::numeric_limits<float>::infinity();
+    for (unsigned lane = 0; lane < kNumLanes; ++lane) {
+        if (lane_scores[lane] > best_score ||
+            (lane_scores[lane] == best_score && lane_indices[lane] < best)) {
+            best = lane_indices[lane];
+            best_score = lane_scores[lane];
+        }
+    }
+
+    // The children which don't fill up a vector.
+    for (; i < children.num_children; ++i) {
+        float score = PuctScore(exploration_factor, parent_num_bandit_pulls,
+                                children.summed_rewards[i], children.num_bandit_pulls[i],
+                                children.num_virtual_losses[i],
+                                children.heuristic_policy_weights[i]);
+        if (score > best_score) {
+            best = i;
+            best_score = score;
+        }
+    }
+
+    return best;
+}
+
+#else
+
+unsigned HighestPuctScore(float const exploration_factor, unsigned const parent_num_bandit_pulls,
+                          PuctChildren const &children) {
+    return HighestPuctScoreScalar(exploration_factor, parent_num_bandit_pulls, children);
+}
+
+#endif // __AVX2__
+
+} // namespace e8
@@ -0,0 +1,66 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PUCT_SELECTION_H
+#define PUCT_SELECTION_H
+
+namespace e8 {
+
+/**
+ * @brief The PuctChildren struct Statistics of the children of a node. Each field points to a
+ * contiguous array of num_children elements.
+ */
+struct PuctChildren {
+    float const *summed_rewards;
+    unsigned const *num_bandit_pulls;
+    unsigned const *num_virtual_losses;
+    float const *heuristic_policy_weights;
+    unsigned num_children;
+};
+
+/**
+ * @brief PuctScore The upper confidence bound on the Q value of a child, in which each virtual loss
+ * counts as a pull with a reward of -1.
+ *
+ * @param exploration_factor How exaggerated the upper confidence bound should be.
+ * @param parent_num_bandit_pulls The number of times the parent has been pulled.
+ */
+float PuctScore(float const exploration_factor, unsigned const parent_num_bandit_pulls,
+                float const summed_reward, unsigned const num_bandit_pulls,
+                unsigned const num_virtual_losses, float const heuristic_policy_weight);
+
+/**
+ * @brief HighestPuctScore Finds the child of the highest PuctScore() by evaluating the score of
+ * every child. It runs on AVX2 when the target supports it and falls back to
+ * HighestPuctScoreScalar() otherwise. Children whose scores differ by rounding only may be picked
+ * differently by the two.
+ *
+ * @return The position of the child in the arrays. Ties go to the first child.
+ */
+unsigned HighestPuctScore(float const exploration_factor, unsigned const parent_num_bandit_pulls,
+                          PuctChildren const &children);
+
+/**
+ * @brief HighestPuctScoreScalar Same as HighestPuctScore() but evaluates one child at a time.
+ */
+unsigned HighestPuctScoreScalar(float const exploration_factor,
+                                unsigned const parent_num_bandit_pulls,
+                                PuctChildren const &children);
+
+} // namespace e8
+
+#endif // PUCT_SELECTION_H
@@ -0,0 +1,93 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+
+#include "gomoku/agent/search/transposition_table.h"
+
+namespace e8 {
+namespace {
+
+// Layout of a slot: | tag (16 bits) | number of visits (16 bits) | summed reward (float32) |.
+unsigned const kTagShift = 48;
+unsigned const kNumVisitsShift = 32;
+uint64_t const kMaxNumVisits = 0xFFFF;
+
+uint64_t TagOf(uint64_t const key) { return key >> kTagShift; }
+
+uint64_t Pack(uint64_t const tag, uint64_t const num_visits, float const summed_reward) {
+    uint32_t reward_bits;
+    std::memcpy(&reward_bits, &summed_reward, sizeof(reward_bits));
+    return tag << kTagShift | num_visits << kNumVisitsShift | reward_bits;
+}
+
+uint64_t NumVisitsOf(uint64_t const slot) { return (slot >> kNumVisitsShift) & kMaxNumVisits; }
+
+float SummedRewardOf(uint64_t const slot) {
+    uint32_t reward_bits = static_cast<uint32_t>(slot);
+    float summed_reward;
+    std::memcpy(&summed_reward, &reward_bits, sizeof(summed_reward));
+    return summed_reward;
+}
+
+} // namespace
+
+TranspositionTable::TranspositionTable(unsigned const log2_num_slots)
+    : slots_(std::make_unique<std::atomic<uint64_t>[]>(uint64_t(1) << log2_num_slots)),
+      index_mask_((uint64_t(1) << log2_num_slots) - 1) {
+    assert(log2_num_slots <= kTagShift);
+    this->Clear();
+}
+
+std::optional<TranspositionStats> TranspositionTable::Probe(uint64_t const key) const {
+    uint64_t slot = slots_[key & index_mask_].load(std::memory_order_relaxed);
+    if (TagOf(slot) != TagOf(key) || NumVisitsOf(slot) == 0) {
+        return std::nullopt;
+    }
+    return TranspositionStats{SummedRewardOf(slot), static_cast<unsigned>(NumVisitsOf(slot))};
+}
+
+void TranspositionTable::Accumulate(uint64_t const key, float const reward) {
+    std::atomic<uint64_t> *slot = &slots_[key & index_mask_];
+
+    uint64_t current = slot->load(std::memory_order_relaxed);
+    uint64_t updated;
+    do {
+        if (TagOf(current) != TagOf(key) || NumVisitsOf(current) == 0) {
+            updated = Pack(TagOf(key), /*num_visits=*/1, reward);
+        } else if (NumVisitsOf(current) == kMaxNumVisits) {
+            updated = Pack(TagOf(key), (kMaxNumVisits + 1) / 2,
+                           (SummedRewardOf(current) + reward) / 2);
+        } else {
+            updated =
+                Pack(TagOf(key), NumVisitsOf(current) + 1, SummedRewardOf(current) + reward);
+        }
+    } while (!slot->compare_exchange_weak(current, updated, std::memory_order_relaxed));
+}
+
+void TranspositionTable::Clear() {
+    for (uint64_t i = 0; i <= index_mask_; ++i) {
+        slots_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+} // namespace e8
@@ -0,0 +1,80 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+namespace e8 {
+
+/**
+ * @brief The TranspositionStats struct Statistics accumulated for a position over all the tree
+ * nodes which reach it.
+ */
+struct TranspositionStats {
+    float summed_reward;
+    unsigned num_visits;
+};
+
+/**
+ * @brief The TranspositionTable class A fixed size, lock-free table of TranspositionStats keyed by
+ * the Zobrist key of the position. Each slot is a single 64-bit word holding a 16-bit tag of the
+ * key, the visit count and the summed reward, and it's updated by compare-and-swap, so concurrent
+ * readers never see a torn entry. A position colliding with the resident of its slot replaces it.
+ * A 16-bit tag mismatch is the only check on the key, so stats may occasionally be attributed to
+ * a different position, which is tolerable for search statistics. This table guarantees thread
+ * safety.
+ */
+class TranspositionTable {
+  public:
+    /**
+     * @brief TranspositionTable Constructs an empty table of 2^log2_num_slots slots.
+     */
+    explicit TranspositionTable(unsigned const log2_num_slots);
+    TranspositionTable(TranspositionTable const &) = delete;
+    ~TranspositionTable() = default;
+
+    /**
+     * @brief Probe Looks up the stats of the position.
+     *
+     * @return nullopt if the position hasn't been visited or has been replaced.
+     */
+    std::optional<TranspositionStats> Probe(uint64_t const key) const;
+
+    /**
+     * @brief Accumulate Adds one visit with the reward to the stats of the position. When the visit
+     * count saturates, both the count and the summed reward are halved so that the mean is kept.
+     */
+    void Accumulate(uint64_t const key, float const reward);
+
+    /**
+     * @brief Clear Empties every slot. It must not run concurrently with other operations.
+     */
+    void Clear();
+
+  private:
+    std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+    uint64_t const index_mask_;
+};
+
+} // namespace e8
+
+#endif // TRANSPOSITION_TABLE_H
@@ -15,6 +15,7 @@
  * not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cassert>
 #include <chrono>
 #include <list>
@@ -25,6 +26,8 @@
 #include <unordered_map>
 #include <vector>
 
+#include "common/time_util/time_util.h"
+#include "gomoku/agent/heuristics/batching_evaluator.h"
 #include "gomoku/agent/heuristics/shl_feature.h"
 #include "gomoku/agent/search/mct_node.h"
 #include "gomoku/agent/search/mct_search.h"
@@ -40,6 +43,24 @@
 namespace e8 {
 namespace {
 
+// How long a game's leaf evaluations may wait for the other games' to fill up a batch.
+TimestampMicros const kMaxBatchingDelay = 2000;
+
+// How many finished games may wait for the log writer before the games are held back.
+unsigned const kMaxNumPendingLoggedGames = 64;
+
+/**
+ * @brief NextScheduleId Allocates a schedule ID after the specified one. Allocations within the
+ * same microsecond may otherwise collide.
+ */
+GameInstanceContainer::ScheduleId NextScheduleId(GameInstanceContainer::ScheduleId last) {
+    GameInstanceContainer::ScheduleId id;
+    do {
+        id = AllocateGameInstanceContainerScheduleId();
+    } while (id <= last);
+    return id;
+}
+
 /**
  * @brief The LearningMaterialGeneratorSharedData struct Data shared between the two
  * LearningMaterialGenerator players so that only one copy of data is required to be maintained.
@@ -144,24 +165,15 @@ void LearningMaterialGenerator::OnGomokuGameBegin(GomokuBoardState const & /*boa
 }
 
 std::optional<std::unordered_map<GomokuActionId, float>>
-FindWinningPolicy(GomokuBoardState board_state) {
-    PlayerSide player_side = board_state.CurrentPlayerSide();
-    std::unordered_map<GomokuActionId, GomokuAction> actions = board_state.LegalActions();
-
-    for (auto [action_id, _] : actions) {
-        GameResult game_result =
-            board_state.ApplyAction(action_id, /*cached_game_result=*/std::nullopt);
-        board_state.RetractAction();
-
-        if ((game_result == GameResult::GR_PLAYER_A_WIN &&
-             player_side == PlayerSide::PS_PLAYER_A) ||
-            (game_result == GameResult::GR_PLAYER_B_WIN &&
-             player_side == PlayerSide::PS_PLAYER_B)) {
-            return std::unordered_map<GomokuActionId, float>({std::make_pair(action_id, 1.0f)});
-        }
+FindWinningPolicy(GomokuBoardState const &board_state) {
+    GomokuLegalActionSet winning_actions =
+        board_state.WinningActions(board_state.CurrentPlayerSide());
+    if (winning_actions.empty()) {
+        return std::nullopt;
     }
 
-    return std::nullopt;
+    GomokuActionId action_id = winning_actions.begin()->first;
+    return std::unordered_map<GomokuActionId, float>({std::make_pair(action_id, 1.0f)});
 }
 
 GomokuActionId LearningMaterialGenerator::NextPlayerAction(GomokuBoardState const &board_state) {
@@ -283,27 +295,58 @@ bool LearningMaterialGenerator::WantAnotherGame() {
 void GenerateLearningMaterial(GameLogPurpose log_purpose, std::optional<ModelId> model_id,
                               std::shared_ptr<GomokuEvaluatorInterface> const &evaluator,
                               bool early_termination, GameInstanceContainer::ScheduleId schedule_id,
-                              unsigned target_num_games, std::string const &db_host_name,
-                              std::string const &db_name, GameInstanceContainer *container) {
+                              unsigned target_num_games, unsigned num_concurrent_games,
+                              std::string const &db_host_name, std::string const &db_name,
+                              GameInstanceContainer *container) {
+    assert(num_concurrent_games > 0);
+
     PooledConnectionReservoir conns(
         ConnectionFactory(ConnectionFactory::PQ, db_host_name, db_name));
 
-    GameLogStore log_store(&conns);
+    // The games are written once they end, and the store is flushed on destruction.
+    GameLogStore log_store(&conns, kMaxNumPendingLoggedGames);
 
-    auto searcher = std::make_unique<MctSearcher>(evaluator, /*print_stats=*/true);
-    auto generator_data = std::make_shared<LearningMaterialGeneratorSharedData>(
-        log_purpose, model_id, target_num_games, std::move(searcher), early_termination,
-        &log_store);
+    unsigned num_games = std::min(num_concurrent_games, target_num_games);
 
-    auto generator_game = std::make_unique<GomokuGame>(
-        std::make_shared<LearningMaterialGenerator>(generator_data, PlayerSide::PS_PLAYER_A),
-        std::make_shared<LearningMaterialGenerator>(generator_data, PlayerSide::PS_PLAYER_B));
-    container->ScheduleToRun(schedule_id, std::move(generator_game));
+    std::shared_ptr<GomokuEvaluatorInterface> shared_evaluator = evaluator;
+    if (num_games > 1) {
+        shared_evaluator = std::make_shared<GomokuBatchingEvaluator>(
+            evaluator, num_games * evaluator->EvaluationBatchSize(), kMaxBatchingDelay);
+    }
 
-    while (container->ScheduledGame(schedule_id) != nullptr) {
-        // Wait for the generator to hit the target number games.
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+    std::vector<GameInstanceContainer::ScheduleId> schedule_ids;
+    for (unsigned i = 0; i < num_games; ++i) {
+        // Spreads the target evenly over the games.
+        unsigned game_target_num_games =
+            target_num_games / num_games + (i < target_num_games % num_games ? 1 : 0);
+
+        auto searcher = std::make_unique<MctSearcher>(shared_evaluator,
+                                                      /*print_stats=*/num_games == 1);
+        auto generator_data = std::make_shared<LearningMaterialGeneratorSharedData>(
+            log_purpose, model_id, game_target_num_games, std::move(searcher), early_termination,
+            &log_store);
+
+        auto generator_game = std::make_unique<GomokuGame>(
+            std::make_shared<LearningMaterialGenerator>(generator_data, PlayerSide::PS_PLAYER_A),
+            std::make_shared<LearningMaterialGenerator>(generator_data, PlayerSide::PS_PLAYER_B));
+
+        if (i == 0) {
+            schedule_ids.push_back(schedule_id);
+        } else {
+            schedule_ids.push_back(NextScheduleId(schedule_ids.back()));
+        }
+        container->ScheduleToRun(schedule_ids.back(), std::move(generator_game));
     }
+
+    for (GameInstanceContainer::ScheduleId id : schedule_ids) {
+        while (container->ScheduledGame(id) != nullptr) {
+            // Wait for the generator to hit the target number games.
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+        }
+    }
+
+    // The batching evaluator leaves the cache to its owner, since the searchers share it.
+    evaluator->ClearCache();
 }
 
 } // namespace e8
@@ -41,8 +41,12 @@ namespace e8 {
  * @param early_termination Terminate the self play by making the winning move if there exists one
  * for any one of the players.
  * @param schedule_id An unused schedule slot in the game intance container for this function to
- * launch games in.
+ * launch games in. The other concurrent games are launched in newly allocated slots.
  * @param target_num_games Target number of games to generate.
+ * @param num_concurrent_games The number of independent games to play at the same time, each with
+ * its own Monte Carlo tree searcher. Their leaf evaluations go through one shared batching queue
+ * in front of the evaluator, see GomokuBatchingEvaluator. The container should be able to run as
+ * many games at a time.
  * @param db_host_name Host name of the database to log the game data towards.
  * @param db_name Name of the database to log game data towards.
  * @param container A game instance container to for this function to launch game into.
@@ -50,8 +54,9 @@ namespace e8 {
 void GenerateLearningMaterial(GameLogPurpose log_purpose, std::optional<ModelId> model_id,
                               std::shared_ptr<GomokuEvaluatorInterface> const &evaluator,
                               bool early_termination, GameInstanceContainer::ScheduleId schedule_id,
-                              unsigned target_num_games, std::string const &db_host_name,
-                              std::string const &db_name, GameInstanceContainer *container);
+                              unsigned target_num_games, unsigned num_concurrent_games,
+                              std::string const &db_host_name, std::string const &db_name,
+                              GameInstanceContainer *container);
 
 } // namespace e8
 
@@ -107,7 +107,8 @@ GomokuModelEntity InitializeFirstModel(std::string const &model_class,
 
 void IterateFromLastPolicy(GameInstanceContainer::ScheduleId schedule_id,
                            std::string const &model_class, unsigned num_iterations,
-                           unsigned num_games_per_iteration, std::string const &source_tree_root,
+                           unsigned num_games_per_iteration, unsigned num_concurrent_games,
+                           std::string const &source_tree_root,
                            std::string const &model_storage_path, std::string const &db_host_name,
                            std::string const &db_name, GameInstanceContainer *container) {
     ConnectionFactory conn_fact(ConnectionFactory::PQ, db_host_name, db_name);
@@ -131,7 +132,8 @@ void IterateFromLastPolicy(GameInstanceContainer::ScheduleId schedule_id,
 
         GenerateLearningMaterial(GameLogPurpose::GLP_LEARNING_DATA, *last_model->id.Value(),
                                  evaluator, /*early_termination=*/false, schedule_id,
-                                 num_games_per_iteration, db_host_name, db_name, container);
+                                 num_games_per_iteration, num_concurrent_games, db_host_name,
+                                 db_name, container);
 
         if ((i + 1) * num_games_per_iteration < kNumWarmUpGames) {
             std::cout << "Skip training during warming up phase." << std::endl;
@@ -15,9 +15,11 @@
  * not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cassert>
 #include <stdlib.h>
 #include <string>
+#include <thread>
 
 #include "common/flags/parse_flags.h"
 #include "gomoku/agent_classroom/policy_iterator.h"
@@ -28,6 +30,7 @@ static char const kDbHostNameFlag[] = "db_host_name";
 static char const kDbNameFlag[] = "db_name";
 static char const kNumIterationsFlag[] = "num_iterations";
 static char const kNumGamesPerIterationFlag[] = "num_games_per_iteration";
+static char const kNumConcurrentGamesFlag[] = "num_concurrent_games";
 static char const kSourceTreeRootFlag[] = "source_tree_root";
 static char const kModelStoragePathFlag[] = "model_storage_path";
 
@@ -47,6 +50,9 @@ int main(int argc, char *argv[]) {
         e8::ReadFlag(kNumIterationsFlag, unsigned(0), e8::FromString<unsigned>);
     unsigned num_games_per_iteration =
         e8::ReadFlag(kNumGamesPerIterationFlag, unsigned(0), e8::FromString<unsigned>);
+    unsigned num_concurrent_games =
+        e8::ReadFlag(kNumConcurrentGamesFlag, std::max(1U, std::thread::hardware_concurrency()),
+                     e8::FromString<unsigned>);
     std::string source_tree_root =
         e8::ReadFlag(kSourceTreeRootFlag, std::string(), e8::FromString<std::string>);
     std::string model_storage_path =
@@ -57,14 +63,18 @@ int main(int argc, char *argv[]) {
     assert(!db_name.empty());
     assert(num_iterations > 0);
     assert(num_games_per_iteration > 0);
+    assert(num_concurrent_games > 0);
     assert(!source_tree_root.empty());
     assert(!model_storage_path.empty());
 
+    // Self-play games block on the shared evaluator most of the time, so they aren't capped at the
+    // default container's concurrency.
+    e8::GameInstanceContainer container(num_concurrent_games);
     e8::GameInstanceContainer::ScheduleId schedule_id =
         e8::AllocateGameInstanceContainerScheduleId();
     e8::IterateFromLastPolicy(schedule_id, model_class, num_iterations, num_games_per_iteration,
-                              source_tree_root, model_storage_path, db_host_name, db_name,
-                              e8::DefaultGameInstanceContainer());
+                              num_concurrent_games, source_tree_root, model_storage_path,
+                              db_host_name, db_name, &container);
 
     return 0;
 }
@@ -31,7 +31,7 @@ void GenerateRepresentativeData(GameInstanceContainer::ScheduleId schedule_id,
     auto evaluator = std::make_shared<GomokuShlRolloutEvaluator>();
     GenerateLearningMaterial(GameLogPurpose::GLP_REPRESENTATIVE_DATA, /*model_id=*/std::nullopt,
                              evaluator, /*early_termination=*/false, schedule_id, target_num_games,
-                             db_host_name, db_name, container);
+                             /*num_concurrent_games=*/1, db_host_name, db_name, container);
 }
 
 } // namespace e8
@@ -45,57 +45,282 @@ GomokuActionRecord::GomokuActionRecord(GamePhase const game_phase, PlayerSide co
                                        GomokuActionId const action_id, GomokuAction const &action)
     : game_phase(game_phase), side(side), action(std::make_pair(action_id, action)) {}
 
+namespace {
+
+// Addressable stone states for ChessPieceStateAt(), indexed by StoneType.
+StoneState const kStoneStates[] = {ST_NONE, ST_BLACK, ST_WHITE};
+
+/**
+ * @brief The ZobristKeys struct Random keys of every component of a position.
+ */
+struct ZobristKeys {
+    // Indexed by stone type starting from ST_BLACK, then by the cell's action ID.
+    std::array<std::array<uint64_t, 19 * 19>, 2> stones;
+    std::array<uint64_t, 5> game_phases;
+    std::array<uint64_t, 2> player_sides;
+    // Indexed by player side then stone type.
+    std::array<std::array<uint64_t, 3>, 2> player_stone_types;
+};
+
+constexpr uint64_t SplitMix64(uint64_t *state) {
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+constexpr ZobristKeys GenerateZobristKeys() {
+    ZobristKeys keys{};
+    uint64_t state = 0x67c2d5f1a3b4e809ULL;
+    for (auto &keys_of_stone_type : keys.stones) {
+        for (uint64_t &key : keys_of_stone_type) {
+            key = SplitMix64(&state);
+        }
+    }
+    for (uint64_t &key : keys.game_phases) {
+        key = SplitMix64(&state);
+    }
+    for (uint64_t &key : keys.player_sides) {
+        key = SplitMix64(&state);
+    }
+    for (auto &keys_of_player_side : keys.player_stone_types) {
+        for (uint64_t &key : keys_of_player_side) {
+            key = SplitMix64(&state);
+        }
+    }
+    return keys;
+}
+
+constexpr ZobristKeys kZobristKeys = GenerateZobristKeys();
+
+// Unit steps of the horizontal, vertical, diagonal and anti-diagonal axes.
+int8_t const kAxisDx[] = {1, 0, 1, 1};
+int8_t const kAxisDy[] = {0, 1, 1, -1};
+unsigned const kNumAxes = 4;
+
+} // namespace
+
+bool GomokuBitboard::Test(GomokuActionId const i) const {
+    return (words_[i >> 6] >> (i & 63)) & 1;
+}
+
+void GomokuBitboard::Set(GomokuActionId const i) { words_[i >> 6] |= uint64_t(1) << (i & 63); }
+
+void GomokuBitboard::Reset(GomokuActionId const i) {
+    words_[i >> 6] &= ~(uint64_t(1) << (i & 63));
+}
+
+unsigned GomokuBitboard::Count() const {
+    unsigned count = 0;
+    for (uint64_t word : words_) {
+        count += __builtin_popcountll(word);
+    }
+    return count;
+}
+
+GomokuActionId GomokuBitboard::Next(GomokuActionId const i) const {
+    unsigned word_index = i >> 6;
+    if (word_index >= kNumWords) {
+        return kMaxNumBits;
+    }
+
+    // Masks out the bits before i in the first word.
+    uint64_t word = words_[word_index] & (~uint64_t(0) << (i & 63));
+    while (word == 0) {
+        if (++word_index == kNumWords) {
+            return kMaxNumBits;
+        }
+        word = words_[word_index];
+    }
+    return word_index * 64 + __builtin_ctzll(word);
+}
+
+GomokuRunLengthTable::GomokuRunLengthTable(int16_t const width, int16_t const height)
+    : width_(width), height_(height) {
+    assert(width * height <= static_cast<int>(kMaxNumCells));
+}
+
+uint8_t GomokuRunLengthTable::LongestRunThrough(GomokuActionId const cell) const {
+    Arms const &arms = arms_[cell];
+    uint8_t longest_run = 0;
+    for (unsigned axis = 0; axis < kNumAxes; ++axis) {
+        uint8_t run = arms[2 * axis] + arms[2 * axis + 1] + 1;
+        if (run > longest_run) {
+            longest_run = run;
+        }
+    }
+    return longest_run;
+}
+
+void GomokuRunLengthTable::Place(GomokuActionId const cell) {
+    int const x = cell % width_;
+    int const y = cell / width_;
+    Arms const &arms = arms_[cell];
+    for (unsigned axis = 0; axis < kNumAxes; ++axis) {
+        int const negative = arms[2 * axis];
+        int const positive = arms[2 * axis + 1];
+        uint8_t const run = negative + positive + 1;
+
+        // The stone joins the runs on both sides of it.
+        this->SetArm(x + kAxisDx[axis] * (positive + 1), y + kAxisDy[axis] * (positive + 1),
+                     2 * axis, run);
+        this->SetArm(x - kAxisDx[axis] * (negative + 1), y - kAxisDy[axis] * (negative + 1),
+                     2 * axis + 1, run);
+    }
+}
+
+void GomokuRunLengthTable::Remove(GomokuActionId const cell) {
+    int const x = cell % width_;
+    int const y = cell / width_;
+
+    // The cell's own entries haven't changed since it was placed.
+    Arms const &arms = arms_[cell];
+    for (unsigned axis = 0; axis < kNumAxes; ++axis) {
+        int const negative = arms[2 * axis];
+        int const positive = arms[2 * axis + 1];
+
+        this->SetArm(x + kAxisDx[axis] * (positive + 1), y + kAxisDy[axis] * (positive + 1),
+                     2 * axis, positive);
+        this->SetArm(x - kAxisDx[axis] * (negative + 1), y - kAxisDy[axis] * (negative + 1),
+                     2 * axis + 1, negative);
+    }
+}
+
+void GomokuRunLengthTable::SetArm(int const x, int const y, unsigned const direction,
+                                  uint8_t const length) {
+    if (x < 0 || x >= width_ || y < 0 || y >= height_) {
+        return;
+    }
+    arms_[x + y * width_][direction] = length;
+}
+
+GomokuLegalActionSet::value_type const *
+GomokuLegalActionSet::const_iterator::ArrowProxy::operator->() const {
+    return &value;
+}
+
+GomokuLegalActionSet::const_iterator::const_iterator(GomokuLegalActionSet const *set,
+                                                     GomokuActionId const action_id)
+    : set_(set), action_id_(action_id) {}
+
+GomokuLegalActionSet::value_type GomokuLegalActionSet::const_iterator::operator*() const {
+    return std::make_pair(action_id_, set_->at(action_id_));
+}
+
+GomokuLegalActionSet::const_iterator::ArrowProxy
+GomokuLegalActionSet::const_iterator::operator->() const {
+    return ArrowProxy{**this};
+}
+
+GomokuLegalActionSet::const_iterator &GomokuLegalActionSet::const_iterator::operator++() {
+    action_id_ = set_->next_[action_id_];
+    return *this;
+}
+
+bool GomokuLegalActionSet::const_iterator::operator==(const_iterator const &other) const {
+    return action_id_ == other.action_id_;
+}
+
+bool GomokuLegalActionSet::const_iterator::operator!=(const_iterator const &other) const {
+    return action_id_ != other.action_id_;
+}
+
+GomokuLegalActionSet::GomokuLegalActionSet(int16_t const width, int16_t const height)
+    : width_(width), num_cells_(width * height) {
+    assert(num_cells_ + 3 + 2 <= static_cast<int>(GomokuBitboard::kMaxNumBits));
+    next_[kListHead] = kListHead;
+    prev_[kListHead] = kListHead;
+}
+
+GomokuLegalActionSet::const_iterator GomokuLegalActionSet::begin() const {
+    return const_iterator(this, next_[kListHead]);
+}
+
+GomokuLegalActionSet::const_iterator GomokuLegalActionSet::end() const {
+    return const_iterator(this, kListHead);
+}
+
+GomokuLegalActionSet::const_iterator
+GomokuLegalActionSet::find(GomokuActionId const action_id) const {
+    if (!this->contains(action_id)) {
+        return this->end();
+    }
+    return const_iterator(this, action_id);
+}
+
+bool GomokuLegalActionSet::contains(GomokuActionId const action_id) const {
+    return action_id >= 0 && action_id < num_cells_ + 3 + 2 && action_ids_.Test(action_id);
+}
+
+size_t GomokuLegalActionSet::size() const { return action_ids_.Count(); }
+
+bool GomokuLegalActionSet::empty() const { return next_[kListHead] == kListHead; }
+
+GomokuAction GomokuLegalActionSet::at(GomokuActionId const action_id) const {
+    assert(this->contains(action_id));
+
+    if (action_id < num_cells_) {
+        return GomokuAction(MovePosition(action_id % width_, action_id / width_));
+    }
+    if (action_id < num_cells_ + 3) {
+        return GomokuAction(static_cast<Swap2Decision>(action_id - num_cells_));
+    }
+    return GomokuAction(static_cast<StoneTypeDecision>(action_id - num_cells_ - 3));
+}
+
+void GomokuLegalActionSet::insert(GomokuActionId const action_id) {
+    if (this->contains(action_id)) {
+        return;
+    }
+    action_ids_.Set(action_id);
+
+    // Links the action in front of the others.
+    GomokuActionId const first = next_[kListHead];
+    next_[action_id] = first;
+    prev_[action_id] = kListHead;
+    prev_[first] = action_id;
+    next_[kListHead] = action_id;
+}
+
+void GomokuLegalActionSet::erase(GomokuActionId const action_id) {
+    if (!this->contains(action_id)) {
+        return;
+    }
+    action_ids_.Reset(action_id);
+
+    next_[prev_[action_id]] = next_[action_id];
+    prev_[next_[action_id]] = prev_[action_id];
+}
+
 GomokuBoardState::GomokuBoardState(int16_t const width, int16_t const height)
     : width_(width), height_(height), game_result_(GameResult::GR_UNDETERMINED),
       current_game_phase_(GP_PLACE_3_STONES), current_player_side_(OffensiveSide()),
-      board_(std::unique_ptr<StoneState[]>(new StoneState[width * height])),
+      runs_{GomokuRunLengthTable(width, height), GomokuRunLengthTable(width, height)},
+      stones_hash_(0),
       player_stone_type_({StoneType::ST_BLACK, StoneType::ST_NONE}),
-      standard_gomoku_legal_actions_(2 * width * height) {
-    for (int16_t i = 0; i < this->Width() * this->Height(); ++i) {
-        board_[i] = StoneState();
-    }
-
+      swap2_decision_legal_actions_(width, height),
+      stone_type_decision_legal_actions_(width, height),
+      standard_gomoku_legal_actions_(width, height) {
     for (int16_t y = 0; y < this->Height(); ++y) {
         for (int16_t x = 0; x < this->Width(); ++x) {
-            MovePosition pos(x, y);
-            GomokuActionId id = this->MovePositionToActionId(pos);
-            standard_gomoku_legal_actions_.insert(std::make_pair(id, GomokuAction(pos)));
+            standard_gomoku_legal_actions_.insert(this->MovePositionToActionId(MovePosition(x, y)));
         }
     }
 
     swap2_decision_legal_actions_.insert(
-        std::make_pair(this->Swap2DecisionToActionId(Swap2Decision::SW2D_CHOOSE_WHITE),
-                       GomokuAction(Swap2Decision::SW2D_CHOOSE_WHITE)));
+        this->Swap2DecisionToActionId(Swap2Decision::SW2D_CHOOSE_WHITE));
     swap2_decision_legal_actions_.insert(
-        std::make_pair(this->Swap2DecisionToActionId(Swap2Decision::SW2D_CHOOSE_BLACK),
-                       GomokuAction(Swap2Decision::SW2D_CHOOSE_BLACK)));
+        this->Swap2DecisionToActionId(Swap2Decision::SW2D_CHOOSE_BLACK));
     swap2_decision_legal_actions_.insert(
-        std::make_pair(this->Swap2DecisionToActionId(Swap2Decision::SW2D_PLACE_2_STONES),
-                       GomokuAction(Swap2Decision::SW2D_PLACE_2_STONES)));
+        this->Swap2DecisionToActionId(Swap2Decision::SW2D_PLACE_2_STONES));
 
     stone_type_decision_legal_actions_.insert(
-        std::make_pair(this->StoneTypeDecisionToActionId(StoneTypeDecision::STD_CHOOSE_WHITE),
-                       GomokuAction(StoneTypeDecision::STD_CHOOSE_WHITE)));
+        this->StoneTypeDecisionToActionId(StoneTypeDecision::STD_CHOOSE_WHITE));
     stone_type_decision_legal_actions_.insert(
-        std::make_pair(this->StoneTypeDecisionToActionId(StoneTypeDecision::STD_CHOOSE_BLACK),
-                       GomokuAction(StoneTypeDecision::STD_CHOOSE_BLACK)));
-}
-
-GomokuBoardState::GomokuBoardState(GomokuBoardState const &other)
-    : width_(other.width_), height_(other.height_), game_result_(other.game_result_),
-      current_game_phase_(other.current_game_phase_),
-      current_player_side_(other.current_player_side_),
-      board_(std::unique_ptr<StoneState[]>(new StoneState[other.width_ * other.height_])),
-      player_stone_type_(other.player_stone_type_), history_(other.history_),
-      swap2_decision_legal_actions_(other.swap2_decision_legal_actions_),
-      stone_type_decision_legal_actions_(other.stone_type_decision_legal_actions_),
-      standard_gomoku_legal_actions_(other.standard_gomoku_legal_actions_) {
-    for (int16_t i = 0; i < this->Width() * this->Height(); ++i) {
-        board_[i] = other.board_[i];
-    }
+        this->StoneTypeDecisionToActionId(StoneTypeDecision::STD_CHOOSE_BLACK));
 }
 
-std::unordered_map<GomokuActionId, GomokuAction> const &GomokuBoardState::LegalActions() const {
+GomokuLegalActionSet const &GomokuBoardState::LegalActions() const {
     switch (this->CurrentGamePhase()) {
     case GP_PLACE_3_STONES:
     case GP_SWAP2_PLACE_2_STONES:
@@ -138,39 +363,16 @@ GameResult GomokuBoardState::ApplyAction(GomokuActionId const action_id,
                                          std::optional<GameResult> const cached_game_result) {
     assert(game_result_ == GameResult::GR_UNDETERMINED);
 
-    std::unordered_map<GomokuActionId, GomokuAction>::const_iterator action_it;
-    switch (this->CurrentGamePhase()) {
-    case GP_PLACE_3_STONES:
-    case GP_SWAP2_PLACE_2_STONES:
-    case GP_STANDARD_GOMOKU: {
-        action_it = standard_gomoku_legal_actions_.find(action_id);
-        assert(action_it != standard_gomoku_legal_actions_.end());
-        break;
-    }
-    case GP_SWAP2_DECISION: {
-        action_it = swap2_decision_legal_actions_.find(action_id);
-        assert(action_it != swap2_decision_legal_actions_.end());
-        break;
-    }
-    case GP_STONE_TYPE_DECISION: {
-        action_it = stone_type_decision_legal_actions_.find(action_id);
-        assert(action_it != stone_type_decision_legal_actions_.end());
-        break;
-    }
-    default:
-        assert(false);
-        break;
-    }
+    assert(this->LegalActions().contains(action_id));
+    GomokuAction const action = this->LegalActions().at(action_id);
 
-    history_.push_back(GomokuActionRecord(this->CurrentGamePhase(), this->CurrentPlayerSide(),
-                                          action_it->first, action_it->second));
+    history_.push_back(
+        GomokuActionRecord(this->CurrentGamePhase(), this->CurrentPlayerSide(), action_id, action));
 
     switch (this->CurrentGamePhase()) {
     case GP_PLACE_3_STONES: {
         assert(player_stone_type_[this->CurrentPlayerSide()] != StoneType::ST_NONE);
-        assert(*this->ChessPieceStateAt(*action_it->second.stone_pos) == StoneType::ST_NONE);
-        *this->ChessPieceStateAt(*action_it->second.stone_pos) =
-            player_stone_type_[this->CurrentPlayerSide()];
+        this->PlaceStone(action_id, player_stone_type_[this->CurrentPlayerSide()]);
 
         if (history_.size() == 2) {
             player_stone_type_[PlayerSide::PS_PLAYER_A] = StoneType::ST_WHITE;
@@ -179,12 +381,10 @@ GameResult GomokuBoardState::ApplyAction(GomokuActionId const action_id,
             current_game_phase_ = GamePhase::GP_SWAP2_DECISION;
             current_player_side_ = PlayerSide::PS_PLAYER_B;
         }
-
-        standard_gomoku_legal_actions_.erase(action_it);
         break;
     }
     case GP_SWAP2_DECISION: {
-        switch (*action_it->second.swap2_decision) {
+        switch (*action.swap2_decision) {
         case SW2D_CHOOSE_WHITE: {
             player_stone_type_[PlayerSide::PS_PLAYER_A] = StoneType::ST_BLACK;
             player_stone_type_[PlayerSide::PS_PLAYER_B] = StoneType::ST_WHITE;
@@ -212,9 +412,7 @@ GameResult GomokuBoardState::ApplyAction(GomokuActionId const action_id,
     }
     case GP_SWAP2_PLACE_2_STONES: {
         assert(player_stone_type_[this->CurrentPlayerSide()] != StoneType::ST_NONE);
-        assert(*this->ChessPieceStateAt(*action_it->second.stone_pos) == StoneType::ST_NONE);
-        *this->ChessPieceStateAt(*action_it->second.stone_pos) =
-            StoneState(player_stone_type_[this->CurrentPlayerSide()]);
+        this->PlaceStone(action_id, player_stone_type_[this->CurrentPlayerSide()]);
 
         if (history_.size() == 5) {
             player_stone_type_[PlayerSide::PS_PLAYER_B] = StoneType::ST_BLACK;
@@ -223,12 +421,10 @@ GameResult GomokuBoardState::ApplyAction(GomokuActionId const action_id,
             current_game_phase_ = GamePhase::GP_STONE_TYPE_DECISION;
             current_player_side_ = PlayerSide::PS_PLAYER_A;
         }
-
-        standard_gomoku_legal_actions_.erase(action_it);
         break;
     }
     case GP_STONE_TYPE_DECISION: {
-        switch (*action_it->second.stone_type_decision) {
+        switch (*action.stone_type_decision) {
         case STD_CHOOSE_WHITE: {
             player_stone_type_[PlayerSide::PS_PLAYER_A] = StoneType::ST_WHITE;
             player_stone_type_[PlayerSide::PS_PLAYER_B] = StoneType::ST_BLACK;
@@ -246,33 +442,17 @@ GameResult GomokuBoardState::ApplyAction(GomokuActionId const action_id,
     }
     case GP_STANDARD_GOMOKU: {
         assert(player_stone_type_[this->CurrentPlayerSide()] != StoneType::ST_NONE);
-        assert(*this->ChessPieceStateAt(*action_it->second.stone_pos) == StoneType::ST_NONE);
-        *this->ChessPieceStateAt(*action_it->second.stone_pos) =
-            StoneState(player_stone_type_[this->CurrentPlayerSide()]);
 
         if (cached_game_result.has_value()) {
             game_result_ = *cached_game_result;
         } else {
-            unsigned max_connected_stones = this->MaxConnectedStonesFrom(
-                *action_it->second.stone_pos, player_stone_type_[this->CurrentPlayerSide()]);
-            if (max_connected_stones == 5) {
-                switch (current_player_side_) {
-                case PS_PLAYER_A:
-                    game_result_ = GameResult::GR_PLAYER_A_WIN;
-                    break;
-                case PS_PLAYER_B:
-                    game_result_ = GameResult::GR_PLAYER_B_WIN;
-                    break;
-                }
-            } else if (max_connected_stones > 5 || this->LegalActions().size() == 1) {
-                game_result_ = GameResult::GR_TIE;
-            }
+            game_result_ = this->GameResultAfter(action_id);
         }
 
+        this->PlaceStone(action_id, player_stone_type_[this->CurrentPlayerSide()]);
+
         current_player_side_ =
             static_cast<PlayerSide>((static_cast<unsigned>(current_player_side_) + 1) & 1);
-
-        standard_gomoku_legal_actions_.erase(action_it);
         break;
     }
     }
@@ -280,6 +460,46 @@ GameResult GomokuBoardState::ApplyAction(GomokuActionId const action_id,
     return this->CurrentGameResult();
 }
 
+GameResult GomokuBoardState::GameResultAfter(GomokuActionId const action_id) const {
+    assert(game_result_ == GameResult::GR_UNDETERMINED);
+    assert(this->LegalActions().contains(action_id));
+
+    if (this->CurrentGamePhase() != GP_STANDARD_GOMOKU) {
+        return GameResult::GR_UNDETERMINED;
+    }
+
+    uint8_t longest_run =
+        this->RunsOf(player_stone_type_[this->CurrentPlayerSide()])->LongestRunThrough(action_id);
+    if (longest_run == 5) {
+        switch (this->CurrentPlayerSide()) {
+        case PS_PLAYER_A:
+            return GameResult::GR_PLAYER_A_WIN;
+        case PS_PLAYER_B:
+            return GameResult::GR_PLAYER_B_WIN;
+        }
+    }
+    if (longest_run > 5 || this->LegalActions().size() == 1) {
+        return GameResult::GR_TIE;
+    }
+    return GameResult::GR_UNDETERMINED;
+}
+
+GomokuLegalActionSet GomokuBoardState::WinningActions(PlayerSide const player_side) const {
+    GomokuLegalActionSet winning_actions(width_, height_);
+    if (this->CurrentGamePhase() != GP_STANDARD_GOMOKU ||
+        game_result_ != GameResult::GR_UNDETERMINED) {
+        return winning_actions;
+    }
+
+    GomokuRunLengthTable const *runs = this->RunsOf(player_stone_type_[player_side]);
+    for (auto const &[action_id, _] : standard_gomoku_legal_actions_) {
+        if (runs->LongestRunThrough(action_id) == 5) {
+            winning_actions.insert(action_id);
+        }
+    }
+    return winning_actions;
+}
+
 std::optional<GomokuActionRecord> GomokuBoardState::RetractAction() {
     if (history_.empty()) {
         return std::nullopt;
@@ -293,8 +513,7 @@ std::optional<GomokuActionRecord> GomokuBoardState::RetractAction() {
     case GP_PLACE_3_STONES: {
         current_game_phase_ = GP_PLACE_3_STONES;
 
-        *this->ChessPieceStateAt(*record.action.second.stone_pos) = StoneState();
-        standard_gomoku_legal_actions_.insert(record.action);
+        this->RemoveStone(record.action.first);
 
         current_player_side_ = PlayerSide::PS_PLAYER_A;
 
@@ -318,8 +537,7 @@ std::optional<GomokuActionRecord> GomokuBoardState::RetractAction() {
     case GP_SWAP2_PLACE_2_STONES: {
         current_game_phase_ = GP_SWAP2_PLACE_2_STONES;
 
-        *this->ChessPieceStateAt(*record.action.second.stone_pos) = StoneState();
-        standard_gomoku_legal_actions_.insert(record.action);
+        this->RemoveStone(record.action.first);
 
         current_player_side_ = PlayerSide::PS_PLAYER_B;
 
@@ -343,8 +561,7 @@ std::optional<GomokuActionRecord> GomokuBoardState::RetractAction() {
     case GP_STANDARD_GOMOKU: {
         current_game_phase_ = GP_STANDARD_GOMOKU;
 
-        *this->ChessPieceStateAt(*record.action.second.stone_pos) = StoneState();
-        standard_gomoku_legal_actions_.insert(record.action);
+        this->RemoveStone(record.action.first);
 
         current_player_side_ =
             static_cast<PlayerSide>((static_cast<unsigned>(current_player_side_) + 1) & 1);
@@ -368,6 +585,13 @@ std::optional<GomokuActionRecord> GomokuBoardState::LastAction() const {
 
 GameResult GomokuBoardState::CurrentGameResult() const { return game_result_; }
 
+uint64_t GomokuBoardState::Hash() const {
+    return stones_hash_ ^ kZobristKeys.game_phases[current_game_phase_] ^
+           kZobristKeys.player_sides[current_player_side_] ^
+           kZobristKeys.player_stone_types[PS_PLAYER_A][player_stone_type_[PS_PLAYER_A]] ^
+           kZobristKeys.player_stone_types[PS_PLAYER_B][player_stone_type_[PS_PLAYER_B]];
+}
+
 std::vector<GomokuActionRecord> const &GomokuBoardState::History() const { return history_; }
 
 int16_t GomokuBoardState::Width() const { return width_; }
@@ -407,114 +631,53 @@ void GomokuBoardState::PrintBoard() const {
     }
 }
 
-StoneState *GomokuBoardState::ChessPieceStateAt(MovePosition const &pos) {
-    return &board_[pos.x + pos.y * width_];
-}
-
 StoneState const *GomokuBoardState::ChessPieceStateAt(MovePosition const &pos) const {
     assert(pos.x >= 0 && pos.x < this->Width() && pos.y >= 0 && pos.y < this->Height());
-    return &board_[pos.x + pos.y * width_];
-}
-
-uint8_t GomokuBoardState::MaxConnectedStonesFrom(MovePosition const &move_pos,
-                                                 StoneType const stone_type) const {
-    int8_t max_connected_stones = 0;
-
-    {
-        int8_t num_connected_stones;
-
-        // Counter clockwise 135 degrees.
-        MovePosition pos(move_pos.x - 1, move_pos.y - 1);
-        while (pos.x >= 0 && pos.y >= 0 && *this->ChessPieceStateAt(pos) == stone_type) {
-            --pos.x;
-            --pos.y;
-        }
-        num_connected_stones = move_pos.x - pos.x - 1;
-
-        // Counter clockwise -45 degrees.
-        pos.x = move_pos.x + 1;
-        pos.y = move_pos.y + 1;
-        while (pos.x < width_ && pos.y < height_ && *this->ChessPieceStateAt(pos) == stone_type) {
-            ++pos.x;
-            ++pos.y;
-        }
-        num_connected_stones += pos.x - move_pos.x;
-
-        if (num_connected_stones > max_connected_stones) {
-            max_connected_stones = num_connected_stones;
-        }
+    GomokuActionId const action_id = this->MovePositionToActionId(pos);
+    if (stones_[0].Test(action_id)) {
+        return &kStoneStates[ST_BLACK];
     }
-    {
-        int8_t num_connected_stones;
-
-        // Counter clockwise 90 degrees.
-        MovePosition pos(move_pos.x, move_pos.y - 1);
-        while (pos.y >= 0 && *this->ChessPieceStateAt(pos) == stone_type) {
-            --pos.y;
-        }
-        num_connected_stones = move_pos.y - pos.y - 1;
-
-        // Counter clockwise -90 degrees.
-        pos.x = move_pos.x;
-        pos.y = move_pos.y + 1;
-        while (pos.y < height_ && *this->ChessPieceStateAt(pos) == stone_type) {
-            ++pos.y;
-        }
-        num_connected_stones += pos.y - move_pos.y;
-
-        if (num_connected_stones > max_connected_stones) {
-            max_connected_stones = num_connected_stones;
-        }
+    if (stones_[1].Test(action_id)) {
+        return &kStoneStates[ST_WHITE];
     }
-    {
-        int8_t num_connected_stones;
+    return &kStoneStates[ST_NONE];
+}
 
-        // Counter clockwise 45 degrees.
-        MovePosition pos(move_pos.x + 1, move_pos.y - 1);
-        while (pos.x < width_ && pos.y >= 0 && *this->ChessPieceStateAt(pos) == stone_type) {
-            ++pos.x;
-            --pos.y;
-        }
-        num_connected_stones = pos.x - move_pos.x - 1;
-
-        // Counter clockwise -135 degrees.
-        pos.x = move_pos.x - 1;
-        pos.y = move_pos.y + 1;
-        while (pos.x >= 0 && pos.y < height_ && *this->ChessPieceStateAt(pos) == stone_type) {
-            --pos.x;
-            ++pos.y;
-        }
-        num_connected_stones += move_pos.x - pos.x;
+GomokuBitboard *GomokuBoardState::StonesOf(StoneType const stone_type) {
+    assert(stone_type != ST_NONE);
+    return &stones_[stone_type - ST_BLACK];
+}
 
-        if (num_connected_stones > max_connected_stones) {
-            max_connected_stones = num_connected_stones;
-        }
-    }
-    {
-        int8_t num_connected_stones;
+GomokuBitboard const *GomokuBoardState::StonesOf(StoneType const stone_type) const {
+    assert(stone_type != ST_NONE);
+    return &stones_[stone_type - ST_BLACK];
+}
 
-        // Counter clockwise 180 degrees.
-        MovePosition pos(move_pos.x - 1, move_pos.y);
-        while (pos.x >= 0 && *this->ChessPieceStateAt(pos) == stone_type) {
-            --pos.x;
-        }
-        num_connected_stones = move_pos.x - pos.x - 1;
+GomokuRunLengthTable *GomokuBoardState::RunsOf(StoneType const stone_type) {
+    assert(stone_type != ST_NONE);
+    return &runs_[stone_type - ST_BLACK];
+}
 
-        // Counter clockwise 0 degrees.
-        pos.x = move_pos.x + 1;
-        pos.y = move_pos.y;
-        while (pos.x < width_ && *this->ChessPieceStateAt(pos) == stone_type) {
-            ++pos.x;
-        }
-        num_connected_stones += pos.x - move_pos.x;
+GomokuRunLengthTable const *GomokuBoardState::RunsOf(StoneType const stone_type) const {
+    assert(stone_type != ST_NONE);
+    return &runs_[stone_type - ST_BLACK];
+}
 
-        if (num_connected_stones > max_connected_stones) {
-            max_connected_stones = num_connected_stones;
-        }
-    }
+void GomokuBoardState::PlaceStone(GomokuActionId const action_id, StoneType const stone_type) {
+    assert(standard_gomoku_legal_actions_.contains(action_id));
+    this->StonesOf(stone_type)->Set(action_id);
+    this->RunsOf(stone_type)->Place(action_id);
+    stones_hash_ ^= kZobristKeys.stones[stone_type - ST_BLACK][action_id];
+    standard_gomoku_legal_actions_.erase(action_id);
+}
 
-    assert(max_connected_stones >= 0);
-    return max_connected_stones;
+void GomokuBoardState::RemoveStone(GomokuActionId const action_id) {
+    StoneType const stone_type = stones_[0].Test(action_id) ? ST_BLACK : ST_WHITE;
+    assert(this->StonesOf(stone_type)->Test(action_id));
+    this->StonesOf(stone_type)->Reset(action_id);
+    this->RunsOf(stone_type)->Remove(action_id);
+    stones_hash_ ^= kZobristKeys.stones[stone_type - ST_BLACK][action_id];
+    standard_gomoku_legal_actions_.insert(action_id);
 }
 
 } // namespace e8
@@ -132,10 +132,153 @@ struct GomokuActionRecord {
                        GomokuActionId const action_id, GomokuAction const &action);
 };
 
+/**
+ * @brief The GomokuBitboard class A fixed capacity bitset over the action ID space, in which bit i
+ * corresponds to action i. Board cells come first in the order of MovePositionToActionId(), then
+ * the swap2 and stone type decisions. It's large enough for boards of up to 19x19.
+ */
+class GomokuBitboard {
+  public:
+    static constexpr unsigned kMaxNumBits = 19 * 19 + 3 + 2;
+    static constexpr unsigned kNumWords = (kMaxNumBits + 63) / 64;
+
+    bool Test(GomokuActionId const i) const;
+    void Set(GomokuActionId const i);
+    void Reset(GomokuActionId const i);
+
+    /**
+     * @brief Count The number of set bits.
+     */
+    unsigned Count() const;
+
+    /**
+     * @brief Next The first set bit at or after i.
+     *
+     * @return kMaxNumBits if there is none.
+     */
+    GomokuActionId Next(GomokuActionId const i) const;
+
+  private:
+    std::array<uint64_t, kNumWords> words_ = {};
+};
+
+/**
+ * @brief The GomokuRunLengthTable class Tracks the runs of consecutive stones of one stone type.
+ * For every cell, it keeps the number of consecutive stones right next to it in each of the 8
+ * directions. Placing or removing a stone only changes the entries of the cells just past the two
+ * ends of the run through it along every axis, so the table is maintained in O(1) per move, and
+ * the run a stone would complete is known before it's placed.
+ */
+class GomokuRunLengthTable {
+  public:
+    GomokuRunLengthTable(int16_t const width, int16_t const height);
+
+    /**
+     * @brief LongestRunThrough The length of the longest run, over the 4 axes, going through the
+     * cell if a stone of this type were placed at it.
+     */
+    uint8_t LongestRunThrough(GomokuActionId const cell) const;
+
+    /**
+     * @brief Place Updates the table for a stone of this type placed at an empty cell.
+     */
+    void Place(GomokuActionId const cell);
+
+    /**
+     * @brief Remove Undoes the last Place() call that hasn't been undone, which must be the one at
+     * the cell.
+     */
+    void Remove(GomokuActionId const cell);
+
+  private:
+    static constexpr unsigned kMaxNumCells = 19 * 19;
+
+    // Directions 2*axis and 2*axis + 1 are the negative and the positive side of the axis.
+    using Arms = std::array<uint8_t, 8>;
+
+    void SetArm(int const x, int const y, unsigned const direction, uint8_t const length);
+
+    std::array<Arms, kMaxNumCells> arms_ = {};
+    int16_t width_;
+    int16_t height_;
+};
+
+/**
+ * @brief The GomokuLegalActionSet class A set of legal actions backed by a GomokuBitboard. It's
+ * copied by value and mimics the read-only interface of an
+ * std::unordered_map<GomokuActionId, GomokuAction>, except that the actions are materialized from
+ * the action IDs on access. The iteration goes from the most recently inserted action to the
+ * least, which is the order the unordered_map it replaces had when it held an action per bucket,
+ * so the searches visit the actions in the same order as before.
+ */
+class GomokuLegalActionSet {
+  public:
+    using value_type = std::pair<GomokuActionId, GomokuAction>;
+
+    /**
+     * @brief The const_iterator class Forward iterator yielding the (action ID, action) pairs by
+     * value.
+     */
+    class const_iterator {
+      public:
+        /**
+         * @brief The ArrowProxy struct Keeps the materialized pair alive for operator->().
+         */
+        struct ArrowProxy {
+            value_type value;
+            value_type const *operator->() const;
+        };
+
+        const_iterator(GomokuLegalActionSet const *set, GomokuActionId const action_id);
+
+        value_type operator*() const;
+        ArrowProxy operator->() const;
+        const_iterator &operator++();
+        bool operator==(const_iterator const &other) const;
+        bool operator!=(const_iterator const &other) const;
+
+      private:
+        GomokuLegalActionSet const *set_;
+        GomokuActionId action_id_;
+    };
+
+    using iterator = const_iterator;
+
+    GomokuLegalActionSet(int16_t const width, int16_t const height);
+
+    const_iterator begin() const;
+    const_iterator end() const;
+    const_iterator find(GomokuActionId const action_id) const;
+    bool contains(GomokuActionId const action_id) const;
+    size_t size() const;
+    bool empty() const;
+
+    /**
+     * @brief at Materializes the action of a contained action ID.
+     */
+    GomokuAction at(GomokuActionId const action_id) const;
+
+    void insert(GomokuActionId const action_id);
+    void erase(GomokuActionId const action_id);
+
+  private:
+    // Slot kMaxNumBits is the head of the circular list linking the actions in iteration order.
+    static constexpr GomokuActionId kListHead = GomokuBitboard::kMaxNumBits;
+
+    GomokuBitboard action_ids_;
+    std::array<GomokuActionId, GomokuBitboard::kMaxNumBits + 1> next_;
+    std::array<GomokuActionId, GomokuBitboard::kMaxNumBits + 1> prev_;
+    int16_t width_;
+    int16_t num_cells_;
+};
+
 /**
  * @brief The GomokuBoardState class Represents the state of the chess board.
  *
- * The board state is defined by the tuple <ChessBoard, PlayerSide, GamePhase, GameResult>.
+ * The board state is defined by the tuple <ChessBoard, PlayerSide, GamePhase, GameResult>. Stones
+ * are kept as one bitboard per stone type, and the empty cells double as the legal stone
+ * placements, so copying a board doesn't allocate except for the history. A run length table per
+ * stone type makes the win check after a move O(1).
  * Thread-safety is not guaranteed.
  */
 class GomokuBoardState {
@@ -148,7 +291,7 @@ class GomokuBoardState {
      */
     GomokuBoardState(int16_t const width, int16_t const height);
 
-    GomokuBoardState(GomokuBoardState const &other);
+    GomokuBoardState(GomokuBoardState const &other) = default;
     GomokuBoardState(GomokuBoardState &&other) = default;
     ~GomokuBoardState() = default;
 
@@ -156,8 +299,7 @@ class GomokuBoardState {
      * @brief LegalActions The set of legal actions that can be made by the CurrentPlayerSide()
      * given the board state.
      */
-    std::unordered_map<GomokuActionId, GomokuAction> const &LegalActions() const;
-
+    GomokuLegalActionSet const &LegalActions() const;
     /**
      * @brief ActionIdRange Since action IDs are compact. Knowing the range the action IDs this
      * board will take makes flattening action data possible.
@@ -213,6 +355,19 @@ class GomokuBoardState {
     GameResult ApplyAction(GomokuActionId const action_id,
                            std::optional<GameResult> const cached_game_result);
 
+    /**
+     * @brief GameResultAfter Predicts the game result of applying the legal action without applying
+     * it. It takes O(1).
+     */
+    GameResult GameResultAfter(GomokuActionId const action_id) const;
+
+    /**
+     * @brief WinningActions The stone placements with which the player side would immediately win
+     * if it were its turn. It's empty outside of the standard gomoku phase. No action is applied,
+     * it looks up the run of every empty cell instead.
+     */
+    GomokuLegalActionSet WinningActions(PlayerSide const player_side) const;
+
     /**
      * @brief RetractAction Undo the last action made to the board and restore the state.
      *
@@ -234,12 +389,14 @@ class GomokuBoardState {
     /**
      * @brief ChessPieceStateAt Retrieve the state of the move position.
      */
-    StoneState *ChessPieceStateAt(MovePosition const &pos);
+    StoneState const *ChessPieceStateAt(MovePosition const &pos) const;
 
     /**
-     * @brief ChessPieceStateAt Constant version of the above function.
+     * @brief Hash Zobrist key of the position, which covers the stones, the game phase, the player
+     * to move and the stone types of the players. The same position reached through different
+     * action sequences has the same key. It's maintained incrementally, so it takes O(1).
      */
-    StoneState const *ChessPieceStateAt(MovePosition const &pos) const;
+    uint64_t Hash() const;
 
     /**
      * @brief History Returns a history of action records.
@@ -263,7 +420,12 @@ class GomokuBoardState {
     void PrintBoard() const;
 
   private:
-    uint8_t MaxConnectedStonesFrom(MovePosition const &pos, StoneType const stone_type) const;
+    GomokuBitboard *StonesOf(StoneType const stone_type);
+    GomokuBitboard const *StonesOf(StoneType const stone_type) const;
+    GomokuRunLengthTable *RunsOf(StoneType const stone_type);
+    GomokuRunLengthTable const *RunsOf(StoneType const stone_type) const;
+    void PlaceStone(GomokuActionId const action_id, StoneType const stone_type);
+    void RemoveStone(GomokuActionId const action_id);
 
     int16_t const width_;
     int16_t const height_;
@@ -271,14 +433,17 @@ class GomokuBoardState {
     GamePhase current_game_phase_;
     PlayerSide current_player_side_;
 
-    std::unique_ptr<StoneState[]> board_;
+    // Indexed by stone type starting from ST_BLACK.
+    std::array<GomokuBitboard, 2> stones_;
+    std::array<GomokuRunLengthTable, 2> runs_;
+    uint64_t stones_hash_;
     std::array<StoneType, 2> player_stone_type_;
 
     std::vector<GomokuActionRecord> history_;
 
-    std::unordered_map<GomokuActionId, GomokuAction> swap2_decision_legal_actions_;
-    std::unordered_map<GomokuActionId, GomokuAction> stone_type_decision_legal_actions_;
-    std::unordered_map<GomokuActionId, GomokuAction> standard_gomoku_legal_actions_;
+    GomokuLegalActionSet swap2_decision_legal_actions_;
+    GomokuLegalActionSet stone_type_decision_legal_actions_;
+    GomokuLegalActionSet standard_gomoku_legal_actions_;
 };
 
 } // namespace e8
@@ -15,6 +15,8 @@
  * not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <mutex>
@@ -68,7 +70,7 @@ bool GameRunnerTask::DropResourceOnCompletion() const { return false; }
 void CleanUpCompletedGames(ThreadPool *thread_pool,
                            std::unordered_map<GameInstanceContainer::ScheduleId,
                                               std::shared_ptr<GomokuGame>> *scheduled_games,
-                           std::shared_mutex *lock, bool *cleanup_thread_running) {
+                           std::shared_mutex *lock, std::atomic<bool> *cleanup_thread_running) {
     while (*cleanup_thread_running) {
         std::unique_ptr<TaskStorageInterface> storage = thread_pool->WaitForNextCompleted();
 
@@ -93,7 +95,7 @@ struct GameInstanceContainer::GameInstanceContainerInternal {
     std::unordered_map<ScheduleId, std::shared_ptr<GomokuGame>> scheduled_games;
     std::shared_mutex lock;
 
-    bool cleanup_thread_running;
+    std::atomic<bool> cleanup_thread_running;
     std::thread cleanup_thread;
 };
 
@@ -115,6 +117,8 @@ GameInstanceContainer::GameInstanceContainerInternal::~GameInstanceContainerInte
 GameInstanceContainer::GameInstanceContainer(unsigned max_concurrent_games)
     : pimpl_(std::make_unique<GameInstanceContainerInternal>(max_concurrent_games)) {}
 
+GameInstanceContainer::~GameInstanceContainer() = default;
+
 void GameInstanceContainer::ScheduleToRun(ScheduleId schedule_id,
                                           std::unique_ptr<GomokuGame> &&game) {
     pimpl_->lock.lock();
@@ -150,7 +154,8 @@ GameInstanceContainer::ScheduleId AllocateGameInstanceContainerScheduleId() { re
 GameInstanceContainer *DefaultGameInstanceContainer() {
     gContainerPtrLock.lock();
     if (gGameContainer == nullptr) {
-        gGameContainer = std::make_unique<GameInstanceContainer>(/*max_concurrent_games=*/4);
+        gGameContainer = std::make_unique<GameInstanceContainer>(
+            /*max_concurrent_games=*/std::max(1U, std::thread::hardware_concurrency()));
     }
     gContainerPtrLock.unlock();
 
@@ -41,6 +41,7 @@ class GameInstanceContainer {
     GameInstanceContainer(unsigned max_concurrent_games);
     GameInstanceContainer(GameInstanceContainer const &) = delete;
     GameInstanceContainer(GameInstanceContainer &&) = delete;
+    ~GameInstanceContainer();
 
     /**
      * @brief ScheduleForRun Add a new game instance into the container and schedule to run whenever
@@ -67,7 +68,7 @@ GameInstanceContainer::ScheduleId AllocateGameInstanceContainerScheduleId();
 
 /**
  * @brief DefaultGameContainer Returns a pointer to the global instance of a
- * GameInstanceContainer.
+ * GameInstanceContainer. It runs as many games at a time as there are hardware threads.
  */
 GameInstanceContainer *DefaultGameInstanceContainer();
 
@@ -9,13 +9,22 @@ SUBDIRS = \
         service/gomoku_service.pro \
         gui_main/gui_main.pro \
         _test_game/_test_board_state/_test_board_state.pro \
+        _test_game/_test_board_state_benchmark/_test_board_state_benchmark.pro \
         _test_game/_test_game_instance_container/_test_game_instance_container.pro \
+        _test_logging/_test_game_log_store_benchmark/_test_game_log_store_benchmark.pro \
+        _test_agent/_test_heuristics/_test_batching_evaluator/_test_batching_evaluator.pro \
+        _test_agent/_test_heuristics/_test_batching_evaluator_benchmark/_test_batching_evaluator_benchmark.pro \
         _test_agent/_test_heuristics/_test_contour/_test_contour.pro \
         _test_agent/_test_heuristics/_test_shl_feature/_test_shl_feature.pro \
         _test_agent/_test_heuristics/_test_light_rollout_evaluator/_test_light_rollout_evaluator.pro \
         _test_agent/_test_heuristics/_test_tflite_zero_prior_evaluator/_test_tflite_zero_prior_evaluator.pro \
         _test_agent/_test_heuristics/_test_tf_zero_prior_evaluator/_test_tf_zero_prior_evaluator.pro \
+        _test_agent/_test_heuristics/_test_tf_zero_prior_evaluator_benchmark/_test_tf_zero_prior_evaluator_benchmark.pro \
         _test_agent/_test_heuristics/_test_shl_model_evaluator/_test_shl_model_evaluator.pro \
-        _test_agent/_test_search/_test_mct_search/_test_mct_search.pro
+        _test_agent/_test_search/_test_mct_node/_test_mct_node.pro \
+        _test_agent/_test_search/_test_mct_search/_test_mct_search.pro \
+        _test_agent/_test_search/_test_mct_search_benchmark/_test_mct_search_benchmark.pro \
+        _test_agent/_test_search/_test_puct_selection/_test_puct_selection.pro \
+        _test_agent/_test_search/_test_transposition_table/_test_transposition_table.pro
 
 CONFIG += ordered
@@ -16,12 +16,17 @@
  */
 
 #include <cassert>
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "common/time_util/time_util.h"
@@ -188,7 +193,34 @@ std::string ExtractBoardFeatures(GomokuBoardState const &board) {
 
 } // namespace
 
-GameLogStore::GameLogStore(ConnectionReservoirInterface *conns) : conns_(conns) {}
+struct GameLogStore::PendingGame {
+    GomokuGameEntity game;
+    std::vector<GomokuGameActionEntity> actions;
+};
+
+GameLogStore::GameLogStore(ConnectionReservoirInterface *conns)
+    : conns_(conns), buffered_(false), max_num_pending_games_(0), num_games_being_written_(0),
+      writer_stopping_(false) {}
+
+GameLogStore::GameLogStore(ConnectionReservoirInterface *conns, unsigned max_num_pending_games)
+    : conns_(conns), buffered_(true), max_num_pending_games_(max_num_pending_games),
+      num_games_being_written_(0), writer_stopping_(false) {
+    assert(max_num_pending_games_ > 0);
+    writer_ = std::thread(&GameLogStore::RunWriter, this);
+}
+
+GameLogStore::~GameLogStore() {
+    if (!buffered_) {
+        return;
+    }
+
+    mutex_.lock();
+    writer_stopping_ = true;
+    mutex_.unlock();
+    game_finished_.notify_all();
+
+    writer_.join();
+}
 
 GameId GameLogStore::LogNewGeneratorGame(GameLogPurpose game_purpose,
                                          std::optional<ModelId> player_a_model_id,
@@ -202,10 +234,23 @@ GameId GameLogStore::LogNewGeneratorGame(GameLogPurpose game_purpose,
     *entity.num_steps.ValuePtr() = 0;
     *entity.created_at.ValuePtr() = CurrentTimestampMicros();
 
+    GameId game_id = *entity.id.Value();
+
+    if (buffered_) {
+        auto game = std::make_unique<PendingGame>();
+        game->game = entity;
+
+        mutex_.lock();
+        open_games_[game_id] = std::move(game);
+        mutex_.unlock();
+
+        return game_id;
+    }
+
     uint64_t num_rows = Update(entity, kGomokuTableName, /*replace=*/false, conns_);
     assert(num_rows == 1);
 
-    return *entity.id.Value();
+    return game_id;
 }
 
 void GameLogStore::LogGameAction(GameId game_id, GameStepNumber step_number,
@@ -228,12 +273,44 @@ void GameLogStore::LogGameAction(GameId game_id, GameStepNumber step_number,
     *entity.stochastic_policy.ValuePtr() = stochastic_policy;
     *entity.created_at.ValuePtr() = CurrentTimestampMicros();
 
+    if (buffered_) {
+        mutex_.lock();
+
+        auto it = open_games_.find(game_id);
+        assert(it != open_games_.end());
+        it->second->actions.push_back(entity);
+
+        mutex_.unlock();
+        return;
+    }
+
     uint64_t num_rows = Update(entity, kGomokuActionTableName, /*replace=*/false, conns_);
     assert(num_rows == 1);
 }
 
 void GameLogStore::LogGameActionValue(GameId game_id, GameStepNumber step_number,
                                       float final_value) {
+    if (buffered_) {
+        mutex_.lock();
+
+        auto it = open_games_.find(game_id);
+        assert(it != open_games_.end());
+
+        // A game has at most a board full of actions, so a linear scan is cheap.
+        bool found = false;
+        for (GomokuGameActionEntity &action : it->second->actions) {
+            if (static_cast<GameStepNumber>(*action.step_number.Value()) == step_number) {
+                *action.final_value.ValuePtr() = final_value;
+                found = true;
+                break;
+            }
+        }
+        assert(found);
+
+        mutex_.unlock();
+        return;
+    }
+
     std::optional<GomokuGameActionEntity> game_action =
         FetchGameAction(game_id, step_number, conns_);
     assert(game_action.has_value());
@@ -244,6 +321,29 @@ void GameLogStore::LogGameActionValue(GameId game_id, GameStepNumber step_number
 }
 
 void GameLogStore::LogGameEnd(GameId game_id, GameStepNumber num_steps, GameResult game_result) {
+    if (buffered_) {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        auto it = open_games_.find(game_id);
+        assert(it != open_games_.end());
+
+        std::unique_ptr<PendingGame> game = std::move(it->second);
+        open_games_.erase(it);
+
+        *game->game.game_result.ValuePtr() = game_result;
+        *game->game.num_steps.ValuePtr() = num_steps;
+        *game->game.end_at.ValuePtr() = CurrentTimestampMicros();
+
+        // Backpressure: the caller has to wait when the writer can't keep up.
+        game_written_.wait(lock,
+                           [this] { return finished_games_.size() < max_num_pending_games_; });
+        finished_games_.push_back(std::move(game));
+
+        lock.unlock();
+        game_finished_.notify_one();
+        return;
+    }
+
     std::optional<GomokuGameEntity> game = FetchGame(game_id, conns_);
     assert(game.has_value());
 
@@ -254,4 +354,57 @@ void GameLogStore::LogGameEnd(GameId game_id, GameStepNumber num_steps, GameResu
     Update(*game, kGomokuTableName, /*replace=*/true, conns_);
 }
 
+void GameLogStore::Flush() {
+    if (!buffered_) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    game_written_.wait(
+        lock, [this] { return finished_games_.empty() && num_games_being_written_ == 0; });
+}
+
+void GameLogStore::RunWriter() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        game_finished_.wait(lock, [this] { return writer_stopping_ || !finished_games_.empty(); });
+        if (finished_games_.empty()) {
+            // Stopping and everything has been written.
+            break;
+        }
+
+        // Takes whatever has piled up so that the games are written together.
+        std::vector<std::unique_ptr<PendingGame>> games;
+        while (!finished_games_.empty()) {
+            games.push_back(std::move(finished_games_.front()));
+            finished_games_.pop_front();
+        }
+        num_games_being_written_ = games.size();
+        lock.unlock();
+        game_written_.notify_all();
+
+        std::vector<SqlEntityInterface const *> game_entities;
+        std::vector<SqlEntityInterface const *> action_entities;
+        for (std::unique_ptr<PendingGame> const &game : games) {
+            game_entities.push_back(&game->game);
+            for (GomokuGameActionEntity const &action : game->actions) {
+                action_entities.push_back(&action);
+            }
+        }
+
+        // The game entries go first as the actions refer to them.
+        uint64_t num_game_rows =
+            UpdateBatch(game_entities, kGomokuTableName, /*replace=*/false, conns_);
+        assert(num_game_rows == game_entities.size());
+
+        uint64_t num_action_rows =
+            UpdateBatch(action_entities, kGomokuActionTableName, /*replace=*/false, conns_);
+        assert(num_action_rows == action_entities.size());
+
+        lock.lock();
+        num_games_being_written_ = 0;
+        game_written_.notify_all();
+    }
+}
+
 } // namespace e8
@@ -18,7 +18,13 @@
 #ifndef GAME_LOG_STORE_H
 #define GAME_LOG_STORE_H
 
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "gomoku/game/board_state.h"
@@ -30,15 +36,35 @@ namespace e8 {
 /**
  * @brief The GameLogStore class Handles game data logging. The logs will be written to the
  * database.
+ *
+ * In buffered mode, a game and its actions are kept in memory until LogGameEnd() is called. The
+ * finished game is then handed to a background writer which saves the game entry and all of its
+ * actions in a few multi-row insertions. So, unlike the unbuffered mode, an unfinished game is
+ * never visible from the database. This class guarantees thread safety in both modes.
  */
 class GameLogStore {
   public:
     /**
      * @brief GameLogStore All the logs will be written to the specified connection reservoir
-     * target.
+     * target, one row per call.
      */
     explicit GameLogStore(ConnectionReservoirInterface *conns);
 
+    /**
+     * @brief GameLogStore Constructs a buffered log store.
+     *
+     * @param max_num_pending_games The maximum number of finished games waiting to be written.
+     * LogGameEnd() blocks when the background writer falls this much behind.
+     */
+    GameLogStore(ConnectionReservoirInterface *conns, unsigned max_num_pending_games);
+    GameLogStore(GameLogStore const &) = delete;
+
+    /**
+     * @brief ~GameLogStore Writes all the finished games before returning. Games which haven't
+     * ended are discarded in buffered mode.
+     */
+    ~GameLogStore();
+
     /**
      * @brief LogNewGeneratorGame Creates a new game entry and returns an ID pointing to the entry.
      */
@@ -67,8 +93,29 @@ class GameLogStore {
      */
     void LogGameEnd(GameId game_id, GameStepNumber num_steps, GameResult game_result);
 
+    /**
+     * @brief Flush Blocks until all the finished games are written to the database. It has no
+     * effect in unbuffered mode.
+     */
+    void Flush();
+
   private:
+    struct PendingGame;
+
+    void RunWriter();
+
     ConnectionReservoirInterface *const conns_;
+    bool const buffered_;
+    unsigned const max_num_pending_games_;
+
+    std::unordered_map<GameId, std::unique_ptr<PendingGame>> open_games_;
+    std::deque<std::unique_ptr<PendingGame>> finished_games_;
+    unsigned num_games_being_written_;
+    bool writer_stopping_;
+    std::mutex mutex_;
+    std::condition_variable game_finished_;
+    std::condition_variable game_written_;
+    std::thread writer_;
 };
 
 } // namespace e8
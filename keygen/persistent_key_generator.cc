@@ -26,7 +26,7 @@
 #include <tuple>
 #include <vector>
 
-#include "common/container/lru_hash_map.h"
+#include "common/container/sharded_lru_hash_map.h"
 #include "keygen/key_generator_interface.h"
 #include "keygen/persistent_key_generator.h"
 #include "postgres/query_runner/connection/connection_factory.h"
@@ -67,7 +67,8 @@ template <> struct hash<KeyUser> {
 namespace e8 {
 namespace {
 
-static unsigned const kNumCachedKeys = 10000;
+static unsigned const kNumCachedKeyShards = 16;
+static unsigned const kNumCachedKeysPerShard = 1024;
 static char const kKeyPersistenceTableName[] = "key_persistence";
 
 class KeyPersistenceEntity : public SqlEntityInterface {
@@ -141,13 +142,14 @@ class OnEvict {
 class PersistentKeyGenerator::PersistentKeyGeneratorImpl {
   public:
     PersistentKeyGeneratorImpl(std::unique_ptr<ConnectionReservoirInterface> reservoir)
-        : crypto_key_cache(kNumCachedKeys, OnFetch(reservoir.get()), OnEvict()),
+        : crypto_key_cache(kNumCachedKeyShards, kNumCachedKeysPerShard, OnFetch(reservoir.get()),
+                           OnEvict()),
           reservoir_(std::move(reservoir)) {}
 
     Key GenerateKey(KeyUser const &key_user);
 
   public:
-    LruHashMap<KeyUser, Key, OnFetch, OnEvict> crypto_key_cache;
+    ShardedLruHashMap<KeyUser, Key, OnFetch, OnEvict> crypto_key_cache;
 
   private:
     Key GenerateAlphaNumeric(unsigned length);
@@ -15,12 +15,17 @@
  * not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <chrono>
 #include <thread>
+#include <vector>
 
 #include "common/unit_test_util/unit_test_util.h"
+#include "message_queue/common/entity.h"
 #include "message_queue/message_queue/module/message_queue_store.h"
 #include "proto_cc/real_time_message.pb.h"
 
+std::chrono::milliseconds const kWaitIndefinitely(-1);
+
 bool StorageInstanceNotNullTest() {
     e8::MessageQueueStore *store_instance = e8::MessageQueueStoreInstance();
     TEST_CONDITION(store_instance != nullptr);
@@ -42,12 +47,12 @@ bool EnqueueAndDequeueTest() {
 
     e8::RealTimeMessage fetched_old_message;
     e8::MessageQueueStore::MessageQueue *queue =
-        e8::MessageQueueStoreInstance()->BeginBlockingDequeue(/*key=*/1, /*wait_for_secs=*/-1,
+        e8::MessageQueueStoreInstance()->BeginBlockingDequeue(/*key=*/1, kWaitIndefinitely,
                                                               &fetched_old_message);
     e8::MessageQueueStoreInstance()->EndBlockingDequeue(queue, /*dequeue=*/true);
 
     e8::RealTimeMessage fetched_new_message;
-    queue = e8::MessageQueueStoreInstance()->BeginBlockingDequeue(/*key=*/1, /*wait_for_secs=*/-1,
+    queue = e8::MessageQueueStoreInstance()->BeginBlockingDequeue(/*key=*/1, kWaitIndefinitely,
                                                                   &fetched_new_message);
     e8::MessageQueueStoreInstance()->EndBlockingDequeue(queue, /*dequeue=*/true);
 
@@ -76,7 +81,7 @@ bool DequeueFutureMessageTest() {
 
     e8::RealTimeMessage future_message;
     e8::MessageQueueStore::MessageQueue *queue =
-        e8::MessageQueueStoreInstance()->BeginBlockingDequeue(/*key=*/1, /*wait_for_secs=*/-1,
+        e8::MessageQueueStoreInstance()->BeginBlockingDequeue(/*key=*/1, kWaitIndefinitely,
                                                               &future_message);
     e8::MessageQueueStoreInstance()->EndBlockingDequeue(queue, /*dequeue=*/true);
     TEST_CONDITION(future_message.real_time_message_id() == 10);
@@ -96,13 +101,13 @@ bool PeekOnlyTest() {
 
     e8::RealTimeMessage fetched_old_message;
     e8::MessageQueueStore::MessageQueue *queue =
-        e8::MessageQueueStoreInstance()->BeginBlockingDequeue(/*key=*/1, /*wait_for_secs=*/-1,
+        e8::MessageQueueStoreInstance()->BeginBlockingDequeue(/*key=*/1, kWaitIndefinitely,
                                                               &fetched_old_message);
     e8::MessageQueueStoreInstance()->EndBlockingDequeue(queue, /*dequeue=*/false);
     TEST_CONDITION(old_message.real_time_message_id() ==
                    fetched_old_message.real_time_message_id());
 
-    queue = e8::MessageQueueStoreInstance()->BeginBlockingDequeue(/*key=*/1, /*wait_for_secs=*/-1,
+    queue = e8::MessageQueueStoreInstance()->BeginBlockingDequeue(/*key=*/1, kWaitIndefinitely,
                                                                   &fetched_old_message);
     e8::MessageQueueStoreInstance()->EndBlockingDequeue(queue, /*dequeue=*/true);
     TEST_CONDITION(old_message.real_time_message_id() ==
@@ -111,12 +116,118 @@ bool PeekOnlyTest() {
     return true;
 }
 
+bool DequeueTimeOutTest() {
+    e8::MessageQueueStoreInstance()->Clear();
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    e8::RealTimeMessage message;
+    e8::MessageQueueStore::MessageQueue *queue =
+        e8::MessageQueueStoreInstance()->BeginBlockingDequeue(
+            /*key=*/1, /*wait_for=*/std::chrono::milliseconds(50), &message);
+    std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - begin;
+
+    TEST_CONDITION(queue == nullptr);
+    TEST_CONDITION(elapsed >= std::chrono::milliseconds(50));
+    TEST_CONDITION(elapsed < std::chrono::milliseconds(500));
+
+    return true;
+}
+
+bool EnqueueWhileMessageHeldTest() {
+    e8::MessageQueueStoreInstance()->Clear();
+
+    e8::RealTimeMessage message;
+    message.set_real_time_message_id(10);
+    e8::MessageQueueStoreInstance()->Enqueue(/*key=*/1, message);
+
+    e8::RealTimeMessage fetched_message;
+    e8::MessageQueueStore::MessageQueue *queue =
+        e8::MessageQueueStoreInstance()->BeginBlockingDequeue(/*key=*/1, kWaitIndefinitely,
+                                                              &fetched_message);
+
+    // Neither writers nor other readers are blocked by the held message.
+    message.set_real_time_message_id(11);
+    e8::MessageQueueStoreInstance()->Enqueue(/*key=*/1, message);
+    TEST_CONDITION(e8::MessageQueueStoreInstance()->ListQueue(/*key=*/1).size() == 2);
+    TEST_CONDITION(e8::MessageQueueStoreInstance()->TryBeginDequeue(/*key=*/1, &fetched_message) ==
+                   nullptr);
+
+    // The held message is released from another thread.
+    std::thread thr([queue] {
+        e8::MessageQueueStoreInstance()->EndBlockingDequeue(queue, /*dequeue=*/true);
+    });
+    queue = e8::MessageQueueStoreInstance()->BeginBlockingDequeue(
+        /*key=*/1, /*wait_for=*/std::chrono::milliseconds(1000), &fetched_message);
+    thr.join();
+
+    TEST_CONDITION(queue != nullptr);
+    TEST_CONDITION(fetched_message.real_time_message_id() == 11);
+    e8::MessageQueueStoreInstance()->EndBlockingDequeue(queue, /*dequeue=*/true);
+
+    return true;
+}
+
+class RecordingListener : public e8::MessageQueueStore::ListenerInterface {
+  public:
+    void OnReadable(e8::MessageKey const key) override { readable_keys.push_back(key); }
+
+    std::vector<e8::MessageKey> readable_keys;
+};
+
+bool ListenAndTryDequeueTest() {
+    e8::MessageQueueStoreInstance()->Clear();
+
+    e8::RealTimeMessage message;
+    message.set_real_time_message_id(10);
+    e8::MessageQueueStoreInstance()->Enqueue(/*key=*/1, message);
+
+    // A readable queue is reported as soon as the listener is added.
+    RecordingListener listener;
+    e8::MessageQueueStoreInstance()->AddListener(/*key=*/1, &listener);
+    e8::MessageQueueStoreInstance()->AddListener(/*key=*/2, &listener);
+    TEST_CONDITION(listener.readable_keys == std::vector<e8::MessageKey>{1});
+
+    e8::RealTimeMessage fetched_message;
+    TEST_CONDITION(e8::MessageQueueStoreInstance()->TryBeginDequeue(/*key=*/2, &fetched_message) ==
+                   nullptr);
+
+    e8::MessageQueueStore::MessageQueue *queue =
+        e8::MessageQueueStoreInstance()->TryBeginDequeue(/*key=*/1, &fetched_message);
+    TEST_CONDITION(queue != nullptr);
+    TEST_CONDITION(fetched_message.real_time_message_id() == 10);
+
+    // Putting the message back makes the queue readable again.
+    e8::MessageQueueStoreInstance()->EndBlockingDequeue(queue, /*dequeue=*/false);
+    TEST_CONDITION((listener.readable_keys == std::vector<e8::MessageKey>{1, 1}));
+
+    queue = e8::MessageQueueStoreInstance()->TryBeginDequeue(/*key=*/1, &fetched_message);
+    TEST_CONDITION(queue != nullptr);
+    e8::MessageQueueStoreInstance()->EndBlockingDequeue(queue, /*dequeue=*/true);
+    TEST_CONDITION((listener.readable_keys == std::vector<e8::MessageKey>{1, 1}));
+    TEST_CONDITION(e8::MessageQueueStoreInstance()->TryBeginDequeue(/*key=*/1, &fetched_message) ==
+                   nullptr);
+
+    e8::MessageQueueStoreInstance()->Enqueue(/*key=*/2, message);
+    TEST_CONDITION((listener.readable_keys == std::vector<e8::MessageKey>{1, 1, 2}));
+
+    e8::MessageQueueStoreInstance()->RemoveListener(/*key=*/2, &listener);
+    e8::MessageQueueStoreInstance()->Enqueue(/*key=*/2, message);
+    TEST_CONDITION((listener.readable_keys == std::vector<e8::MessageKey>{1, 1, 2}));
+
+    e8::MessageQueueStoreInstance()->RemoveListener(/*key=*/1, &listener);
+
+    return true;
+}
+
 int main() {
     e8::BeginTestSuite("message_queue_store");
     e8::RunTest("StorageInstanceNotNullTest", StorageInstanceNotNullTest);
     e8::RunTest("EnqueueAndDequeueTest", EnqueueAndDequeueTest);
     e8::RunTest("DequeueFutureMessageTest", DequeueFutureMessageTest);
     e8::RunTest("PeekOnlyTest", PeekOnlyTest);
+    e8::RunTest("DequeueTimeOutTest", DequeueTimeOutTest);
+    e8::RunTest("EnqueueWhileMessageHeldTest", EnqueueWhileMessageHeldTest);
+    e8::RunTest("ListenAndTryDequeueTest", ListenAndTryDequeueTest);
     e8::EndTestSuite();
     return 0;
 }
@@ -0,0 +1,194 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <grpcpp/grpcpp.h>
+#include <grpcpp/resource_quota.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/unit_test_util/unit_test_util.h"
+#include "message_queue/message_queue/module/message_queue_store.h"
+#include "message_queue/message_queue/service/message_queue_async_service.h"
+#include "proto_cc/real_time_message.pb.h"
+#include "proto_cc/service_message_queue.grpc.pb.h"
+#include "proto_cc/service_message_queue.pb.h"
+
+namespace {
+
+unsigned const kNumWaitingDequeues = 256;
+int const kMaxServerThreads = 8;
+unsigned const kNumThreadsPerCompletionQueue = 1;
+
+using DequeueStream =
+    grpc::ClientAsyncReaderWriter<e8::DequeueMessageRequest, e8::DequeueMessageResponse>;
+
+/**
+ * @brief DrainEvents Waits for the specified number of successful completion queue events.
+ */
+bool DrainEvents(grpc::CompletionQueue *cq, unsigned num_events) {
+    for (unsigned i = 0; i < num_events; ++i) {
+        void *tag;
+        bool ok;
+        if (!cq->Next(&tag, &ok) || !ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool WaitingDequeuesHoldNoThreadTest() {
+    e8::MessageQueueStoreInstance()->Clear();
+
+    // The synchronous methods are served by a thread pool much smaller than the number of waiting
+    // dequeues.
+    e8::MessageQueueAsyncServiceImpl service;
+    int port = 0;
+    grpc::ServerBuilder builder;
+    builder.AddListeningPort("127.0.0.1:0", grpc::InsecureServerCredentials(), &port);
+    grpc::ResourceQuota quota;
+    quota.SetMaxThreads(kMaxServerThreads);
+    builder.SetResourceQuota(quota);
+    builder.RegisterService(&service);
+    std::unique_ptr<grpc::ServerCompletionQueue> server_cq = builder.AddCompletionQueue();
+    std::unique_ptr<grpc::Server> server = builder.BuildAndStart();
+    TEST_CONDITION(server != nullptr);
+    service.Serve({server_cq.get()}, kNumThreadsPerCompletionQueue);
+
+    std::shared_ptr<grpc::Channel> channel = grpc::CreateChannel(
+        "127.0.0.1:" + std::to_string(port), grpc::InsecureChannelCredentials());
+    std::unique_ptr<e8::MessageQueueService::Stub> stub = e8::MessageQueueService::NewStub(channel);
+
+    grpc::CompletionQueue cq;
+    std::vector<std::unique_ptr<grpc::ClientContext>> contexts;
+    std::vector<std::unique_ptr<DequeueStream>> streams;
+    for (unsigned i = 0; i < kNumWaitingDequeues; ++i) {
+        contexts.push_back(std::make_unique<grpc::ClientContext>());
+        streams.push_back(stub->PrepareAsyncDequeueMessage(contexts.back().get(), &cq));
+        streams.back()->StartCall(streams.back().get());
+    }
+    TEST_CONDITION(DrainEvents(&cq, kNumWaitingDequeues));
+
+    for (unsigned i = 0; i < kNumWaitingDequeues; ++i) {
+        e8::DequeueMessageRequest request;
+        request.set_user_id(i + 1);
+        request.set_wait_duration_secs(30);
+        streams[i]->Write(request, streams[i].get());
+    }
+    TEST_CONDITION(DrainEvents(&cq, kNumWaitingDequeues));
+
+    // Every dequeue is waiting on an empty queue. The enqueues still get served.
+    for (unsigned i = 0; i < kNumWaitingDequeues; ++i) {
+        grpc::ClientContext context;
+        context.set_deadline(std::chrono::system_clock::now() + std::chrono::seconds(10));
+        e8::EnqueueMessageRequest request;
+        request.set_user_id(i + 1);
+        request.add_messages()->set_real_time_message_id(i + 1);
+        e8::EnqueueMessageResponse response;
+        TEST_CONDITION(stub->EnqueueMessage(&context, request, &response).ok());
+    }
+
+    std::vector<e8::DequeueMessageResponse> responses(kNumWaitingDequeues);
+    for (unsigned i = 0; i < kNumWaitingDequeues; ++i) {
+        streams[i]->Read(&responses[i], streams[i].get());
+    }
+    TEST_CONDITION(DrainEvents(&cq, kNumWaitingDequeues));
+    for (unsigned i = 0; i < kNumWaitingDequeues; ++i) {
+        TEST_CONDITION(responses[i].message().real_time_message_id() == i + 1);
+    }
+
+    // Acknowledges the deliveries and ends the dequeues.
+    for (unsigned i = 0; i < kNumWaitingDequeues; ++i) {
+        e8::DequeueMessageRequest request;
+        request.set_user_id(i + 1);
+        request.set_previous_message_delivered(true);
+        request.set_end_operation(true);
+        streams[i]->Write(request, streams[i].get());
+    }
+    TEST_CONDITION(DrainEvents(&cq, kNumWaitingDequeues));
+
+    std::vector<grpc::Status> statuses(kNumWaitingDequeues);
+    for (unsigned i = 0; i < kNumWaitingDequeues; ++i) {
+        streams[i]->Finish(&statuses[i], streams[i].get());
+    }
+    TEST_CONDITION(DrainEvents(&cq, kNumWaitingDequeues));
+    for (unsigned i = 0; i < kNumWaitingDequeues; ++i) {
+        TEST_CONDITION(statuses[i].error_code() == grpc::StatusCode::ABORTED);
+        TEST_CONDITION(e8::MessageQueueStoreInstance()->ListQueue(i + 1).empty());
+    }
+
+    server->Shutdown();
+    server_cq->Shutdown();
+    service.Wait();
+    cq.Shutdown();
+    void *tag;
+    bool ok;
+    while (cq.Next(&tag, &ok)) {
+    }
+
+    return true;
+}
+
+bool DequeueTimesOutTest() {
+    e8::MessageQueueStoreInstance()->Clear();
+
+    e8::MessageQueueAsyncServiceImpl service;
+    int port = 0;
+    grpc::ServerBuilder builder;
+    builder.AddListeningPort("127.0.0.1:0", grpc::InsecureServerCredentials(), &port);
+    builder.RegisterService(&service);
+    std::unique_ptr<grpc::ServerCompletionQueue> server_cq = builder.AddCompletionQueue();
+    std::unique_ptr<grpc::Server> server = builder.BuildAndStart();
+    TEST_CONDITION(server != nullptr);
+    service.Serve({server_cq.get()}, kNumThreadsPerCompletionQueue);
+
+    std::shared_ptr<grpc::Channel> channel = grpc::CreateChannel(
+        "127.0.0.1:" + std::to_string(port), grpc::InsecureChannelCredentials());
+    std::unique_ptr<e8::MessageQueueService::Stub> stub = e8::MessageQueueService::NewStub(channel);
+
+    grpc::ClientContext context;
+    std::unique_ptr<grpc::ClientReaderWriter<e8::DequeueMessageRequest, e8::DequeueMessageResponse>>
+        stream = stub->DequeueMessage(&context);
+
+    e8::DequeueMessageRequest request;
+    request.set_user_id(1);
+    request.set_wait_duration_secs(1);
+    TEST_CONDITION(stream->Write(request));
+
+    e8::DequeueMessageResponse response;
+    TEST_CONDITION(!stream->Read(&response));
+    grpc::Status status = stream->Finish();
+    TEST_CONDITION(status.error_code() == grpc::StatusCode::ABORTED);
+    TEST_CONDITION(status.error_message() == "Time out.");
+
+    server->Shutdown();
+    server_cq->Shutdown();
+    service.Wait();
+
+    return true;
+}
+
+int main() {
+    e8::BeginTestSuite("message_queue_async_service");
+    e8::RunTest("WaitingDequeuesHoldNoThreadTest", WaitingDequeuesHoldNoThreadTest);
+    e8::RunTest("DequeueTimesOutTest", DequeueTimesOutTest);
+    e8::EndTestSuite();
+    return 0;
+}
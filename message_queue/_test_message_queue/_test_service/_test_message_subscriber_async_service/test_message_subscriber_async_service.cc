@@ -0,0 +1,405 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <grpcpp/grpcpp.h>
+#include <grpcpp/resource_quota.h>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/time_util/time_util.h"
+#include "common/unit_test_util/unit_test_util.h"
+#include "distributor/distributor/distribute.h"
+#include "distributor/store/node_state_store.h"
+#include "identity/auth_key.h"
+#include "identity/trustable_identity.h"
+#include "keygen/key_generator_interface.h"
+#include "keygen/persistent_key_generator.h"
+#include "message_queue/common/entity.h"
+#include "message_queue/message_queue/module/message_queue_store.h"
+#include "message_queue/message_queue/service/message_queue_service.h"
+#include "message_queue/subscriber/environment/environment_context_interface.h"
+#include "message_queue/subscriber/module/message_queue_multiplexer.h"
+#include "message_queue/subscriber/service/message_subscriber_async_service.h"
+#include "proto_cc/identity.pb.h"
+#include "proto_cc/node.pb.h"
+#include "proto_cc/real_time_message.pb.h"
+#include "proto_cc/service_message_queue.grpc.pb.h"
+#include "proto_cc/service_message_queue.pb.h"
+#include "proto_cc/service_message_subscriber.grpc.pb.h"
+#include "proto_cc/service_message_subscriber.pb.h"
+
+namespace {
+
+unsigned const kNumIdleSubscribers = 256;
+unsigned const kNumRequests = 4000;
+unsigned const kNumClientThreads = 4;
+int const kMaxServerThreads = 32;
+unsigned const kNumCompletionQueues = 2;
+unsigned const kNumThreadsPerCompletionQueue = 1;
+int const kRequestDeadlineSecs = 10;
+unsigned const kNumRelayedSubscribers = 16;
+unsigned const kNumMessagesPerSubscriber = 3;
+int const kRelayWaitDurationSecs = 1;
+
+/**
+ * @brief The IdleMessageQueueService class A message queue node which never receives any message.
+ * It keeps track of the users subscribed through multiplexed dequeue streams.
+ */
+class IdleMessageQueueService : public e8::MessageQueueService::Service {
+  public:
+    grpc::Status MultiplexedDequeueMessage(
+        grpc::ServerContext * /*context*/,
+        grpc::ServerReaderWriter<e8::MultiplexedDequeueMessageResponse,
+                                 e8::MultiplexedDequeueMessageRequest> *stream) override {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ++num_streams_;
+        lock.unlock();
+
+        e8::MultiplexedDequeueMessageRequest request;
+        while (stream->Read(&request)) {
+            lock.lock();
+            num_subscribed_users_ += request.subscribe_user_ids_size();
+            num_subscribed_users_ -= request.unsubscribe_user_ids_size();
+            cv_.notify_all();
+            lock.unlock();
+        }
+
+        return grpc::Status::OK;
+    }
+
+    grpc::Status GetQueueStats(grpc::ServerContext * /*context*/,
+                               e8::GetQueueStatsRequest const * /*request*/,
+                               e8::GetQueueStatsResponse * /*response*/) override {
+        return grpc::Status::OK;
+    }
+
+    bool WaitForSubscribedUsers(int num_subscribed_users, std::chrono::seconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cv_.wait_for(lock, timeout, [this, num_subscribed_users] {
+            return num_subscribed_users_ == num_subscribed_users;
+        });
+    }
+
+    unsigned NumStreams() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return num_streams_;
+    }
+
+  private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    unsigned num_streams_ = 0;
+    int num_subscribed_users_ = 0;
+};
+
+/**
+ * @brief The LocalNodeDistributor class Distributes every key to the node on the local host.
+ */
+class LocalNodeDistributor : public e8::DistributorInterface {
+  public:
+    std::optional<e8::NodeState> Distribute(std::string const & /*key*/,
+                                            std::optional<e8::NodeFunction> const /*function*/,
+                                            e8::NodeStateStoreInterface * /*store*/) override {
+        e8::NodeState node;
+        node.set_ip_address(std::string("\x7f\x00\x00\x01", 4));
+        return node;
+    }
+};
+
+class LoadTestEnvironmentContext : public e8::SubscriberEnvironmentContextInterface {
+  public:
+    explicit LoadTestEnvironmentContext(e8::MessageQueueServicePort message_queue_service_port)
+        : key_gen_(std::make_unique<e8::PersistentKeyGenerator>("localhost")),
+          message_queue_service_port_(message_queue_service_port) {}
+
+    Environment EnvironmentType() const override { return Environment::TEST; }
+    e8::KeyGeneratorInterface *KeyGen() override { return key_gen_.get(); }
+    e8::NodeStateStoreInterface *NodeStateStorage() override { return nullptr; }
+    e8::DistributorInterface *Distributor() override { return &distributor_; }
+    e8::MessageQueueServicePort GetMessageQueueServicePort() override {
+        return message_queue_service_port_;
+    }
+    e8::MessageQueueMultiplexerPool *MessageQueueMultiplexers() override {
+        return &message_queue_multiplexers_;
+    }
+
+  private:
+    std::unique_ptr<e8::KeyGeneratorInterface> key_gen_;
+    LocalNodeDistributor distributor_;
+    e8::MessageQueueServicePort message_queue_service_port_;
+    e8::MessageQueueMultiplexerPool message_queue_multiplexers_;
+};
+
+/**
+ * @brief IssueRequests Sends unary requests from several client threads.
+ *
+ * @return The number of successful requests.
+ */
+unsigned IssueRequests(std::shared_ptr<grpc::Channel> const &channel) {
+    std::atomic<unsigned> num_successes(0);
+    std::vector<std::thread> clients;
+    for (unsigned i = 0; i < kNumClientThreads; ++i) {
+        clients.emplace_back([&channel, &num_successes] {
+            std::unique_ptr<e8::MessageQueueService::Stub> stub =
+                e8::MessageQueueService::NewStub(channel);
+            for (unsigned j = 0; j < kNumRequests / kNumClientThreads; ++j) {
+                grpc::ClientContext context;
+                context.set_deadline(std::chrono::system_clock::now() +
+                                     std::chrono::seconds(kRequestDeadlineSecs));
+                e8::GetQueueStatsRequest request;
+                e8::GetQueueStatsResponse response;
+                if (stub->GetQueueStats(&context, request, &response).ok()) {
+                    ++num_successes;
+                }
+            }
+        });
+    }
+    for (std::thread &client : clients) {
+        client.join();
+    }
+    return num_successes;
+}
+
+} // namespace
+
+bool IdleSubscribersDontStarveRequestsTest() {
+    // The message queue node which the subscriptions are relayed to.
+    IdleMessageQueueService message_queue_service;
+    int message_queue_port = 0;
+    grpc::ServerBuilder message_queue_builder;
+    message_queue_builder.AddListeningPort("127.0.0.1:0", grpc::InsecureServerCredentials(),
+                                           &message_queue_port);
+    message_queue_builder.RegisterService(&message_queue_service);
+    std::unique_ptr<grpc::Server> message_queue_server = message_queue_builder.BuildAndStart();
+    TEST_CONDITION(message_queue_server != nullptr);
+
+    LoadTestEnvironmentContext env(static_cast<e8::MessageQueueServicePort>(message_queue_port));
+    e8::RegisterEnvironment(&env);
+
+    // The front server serves subscriptions asynchronously and unary requests from a thread pool
+    // much smaller than the number of subscribers.
+    e8::MessageSubscriberAsyncServiceImpl subscriber_service;
+    IdleMessageQueueService request_service;
+    int front_port = 0;
+    grpc::ServerBuilder front_builder;
+    front_builder.AddListeningPort("127.0.0.1:0", grpc::InsecureServerCredentials(), &front_port);
+    grpc::ResourceQuota quota;
+    quota.SetMaxThreads(kMaxServerThreads);
+    front_builder.SetResourceQuota(quota);
+    front_builder.RegisterService(&subscriber_service);
+    front_builder.RegisterService(&request_service);
+    std::vector<std::unique_ptr<grpc::ServerCompletionQueue>> cqs;
+    std::vector<grpc::ServerCompletionQueue *> cq_ptrs;
+    for (unsigned i = 0; i < kNumCompletionQueues; ++i) {
+        cqs.push_back(front_builder.AddCompletionQueue());
+        cq_ptrs.push_back(cqs.back().get());
+    }
+    std::unique_ptr<grpc::Server> front_server = front_builder.BuildAndStart();
+    TEST_CONDITION(front_server != nullptr);
+    subscriber_service.Serve(cq_ptrs, kNumThreadsPerCompletionQueue);
+
+    std::shared_ptr<grpc::Channel> channel = grpc::CreateChannel(
+        "127.0.0.1:" + std::to_string(front_port), grpc::InsecureChannelCredentials());
+
+    e8::TimestampMicros begin = e8::CurrentTimestampMicros();
+    unsigned num_successes = IssueRequests(channel);
+    e8::TimestampMicros baseline_elapsed = e8::CurrentTimestampMicros() - begin;
+    TEST_CONDITION(num_successes == kNumRequests);
+
+    // Opens the idle subscriptions.
+    std::unique_ptr<e8::MessageSubscriberService::Stub> subscriber_stub =
+        e8::MessageSubscriberService::NewStub(channel);
+    grpc::CompletionQueue subscriber_cq;
+    std::vector<std::unique_ptr<grpc::ClientContext>> subscriber_contexts;
+    std::vector<std::unique_ptr<grpc::ClientAsyncReader<e8::SubscribeRealTimeMessageQueueResponse>>>
+        subscriptions;
+    for (unsigned i = 0; i < kNumIdleSubscribers; ++i) {
+        e8::Identity identity;
+        identity.set_user_id(i + 1);
+        std::optional<e8::SignedIdentity> signed_identity =
+            e8::SignIdentity(identity, env.KeyGen());
+        TEST_CONDITION(signed_identity.has_value());
+
+        subscriber_contexts.push_back(std::make_unique<grpc::ClientContext>());
+        subscriber_contexts.back()->AddMetadata(e8::kDemoWebUserAuthorizationKey,
+                                                *signed_identity);
+
+        e8::SubscribeRealTimeMessageQueueRequest request;
+        request.set_wait_duration_secs(-1);
+        subscriptions.push_back(subscriber_stub->PrepareAsyncSubscribeRealTimeMessageQueue(
+            subscriber_contexts.back().get(), request, &subscriber_cq));
+        subscriptions.back()->StartCall(subscriptions.back().get());
+    }
+    TEST_CONDITION(message_queue_service.WaitForSubscribedUsers(kNumIdleSubscribers,
+                                                                std::chrono::seconds(30)));
+    // All the subscriptions share one stream to the message queue node.
+    TEST_CONDITION(message_queue_service.NumStreams() == 1);
+
+    begin = e8::CurrentTimestampMicros();
+    num_successes = IssueRequests(channel);
+    e8::TimestampMicros loaded_elapsed = e8::CurrentTimestampMicros() - begin;
+    TEST_CONDITION(num_successes == kNumRequests);
+
+    std::cout << "max_server_threads=" << kMaxServerThreads
+              << " completion_queues=" << kNumCompletionQueues
+              << " threads_per_completion_queue=" << kNumThreadsPerCompletionQueue << std::endl;
+    std::cout << "idle_subscribers=0 requests=" << kNumRequests
+              << " elapsed=" << baseline_elapsed << "us"
+              << " qps=" << kNumRequests * 1000000.0 / baseline_elapsed << std::endl;
+    std::cout << "idle_subscribers=" << kNumIdleSubscribers << " requests=" << kNumRequests
+              << " elapsed=" << loaded_elapsed << "us"
+              << " qps=" << kNumRequests * 1000000.0 / loaded_elapsed << std::endl;
+
+    // Subscribers going away are unsubscribed from the message queue node.
+    std::vector<grpc::Status> subscription_statuses(kNumIdleSubscribers);
+    for (unsigned i = 0; i < kNumIdleSubscribers; ++i) {
+        subscriber_contexts[i]->TryCancel();
+        subscriptions[i]->Finish(&subscription_statuses[i], &subscription_statuses[i]);
+    }
+    void *tag;
+    bool ok;
+    for (unsigned i = 0; i < 2 * kNumIdleSubscribers; ++i) {
+        TEST_CONDITION(subscriber_cq.Next(&tag, &ok));
+    }
+    for (grpc::Status const &status : subscription_statuses) {
+        TEST_CONDITION(status.error_code() == grpc::StatusCode::CANCELLED);
+    }
+    TEST_CONDITION(message_queue_service.WaitForSubscribedUsers(0, std::chrono::seconds(30)));
+
+    front_server->Shutdown();
+    for (auto const &cq : cqs) {
+        cq->Shutdown();
+    }
+    subscriber_service.Wait();
+    // Cancels the multiplexed stream rather than waiting for it.
+    message_queue_server->Shutdown(std::chrono::system_clock::now());
+    subscriber_cq.Shutdown();
+    while (subscriber_cq.Next(&tag, &ok)) {
+    }
+
+    return true;
+}
+
+bool RelayMessagesThroughMultiplexedStreamTest() {
+    e8::MessageQueueStoreInstance()->Clear();
+
+    e8::MessageQueueServiceImpl message_queue_service;
+    int message_queue_port = 0;
+    grpc::ServerBuilder message_queue_builder;
+    message_queue_builder.AddListeningPort("127.0.0.1:0", grpc::InsecureServerCredentials(),
+                                           &message_queue_port);
+    message_queue_builder.RegisterService(&message_queue_service);
+    std::unique_ptr<grpc::Server> message_queue_server = message_queue_builder.BuildAndStart();
+    TEST_CONDITION(message_queue_server != nullptr);
+
+    LoadTestEnvironmentContext env(static_cast<e8::MessageQueueServicePort>(message_queue_port));
+    e8::RegisterEnvironment(&env);
+
+    e8::MessageSubscriberAsyncServiceImpl subscriber_service;
+    int front_port = 0;
+    grpc::ServerBuilder front_builder;
+    front_builder.AddListeningPort("127.0.0.1:0", grpc::InsecureServerCredentials(), &front_port);
+    front_builder.RegisterService(&subscriber_service);
+    std::unique_ptr<grpc::ServerCompletionQueue> cq = front_builder.AddCompletionQueue();
+    std::unique_ptr<grpc::Server> front_server = front_builder.BuildAndStart();
+    TEST_CONDITION(front_server != nullptr);
+    subscriber_service.Serve({cq.get()}, kNumThreadsPerCompletionQueue);
+
+    // The first message of each user is queued up before the subscription is made.
+    for (unsigned i = 0; i < kNumRelayedSubscribers; ++i) {
+        e8::RealTimeMessage message;
+        message.set_created_at(0);
+        e8::MessageQueueStoreInstance()->Enqueue(i + 1, message);
+    }
+
+    std::shared_ptr<grpc::Channel> channel = grpc::CreateChannel(
+        "127.0.0.1:" + std::to_string(front_port), grpc::InsecureChannelCredentials());
+    std::unique_ptr<e8::MessageSubscriberService::Stub> subscriber_stub =
+        e8::MessageSubscriberService::NewStub(channel);
+
+    std::vector<std::unique_ptr<grpc::ClientContext>> subscriber_contexts;
+    std::vector<std::unique_ptr<grpc::ClientReader<e8::SubscribeRealTimeMessageQueueResponse>>>
+        subscriptions;
+    for (unsigned i = 0; i < kNumRelayedSubscribers; ++i) {
+        e8::Identity identity;
+        identity.set_user_id(i + 1);
+        std::optional<e8::SignedIdentity> signed_identity =
+            e8::SignIdentity(identity, env.KeyGen());
+        TEST_CONDITION(signed_identity.has_value());
+
+        subscriber_contexts.push_back(std::make_unique<grpc::ClientContext>());
+        subscriber_contexts.back()->AddMetadata(e8::kDemoWebUserAuthorizationKey,
+                                                *signed_identity);
+
+        e8::SubscribeRealTimeMessageQueueRequest request;
+        request.set_wait_duration_secs(kRelayWaitDurationSecs);
+        subscriptions.push_back(subscriber_stub->SubscribeRealTimeMessageQueue(
+            subscriber_contexts.back().get(), request));
+    }
+
+    for (unsigned j = 1; j < kNumMessagesPerSubscriber; ++j) {
+        for (unsigned i = 0; i < kNumRelayedSubscribers; ++i) {
+            e8::RealTimeMessage message;
+            message.set_created_at(j);
+            e8::MessageQueueStoreInstance()->Enqueue(i + 1, message);
+        }
+    }
+
+    // Every subscriber receives its own messages in order.
+    for (unsigned i = 0; i < kNumRelayedSubscribers; ++i) {
+        for (unsigned j = 0; j < kNumMessagesPerSubscriber; ++j) {
+            e8::SubscribeRealTimeMessageQueueResponse response;
+            TEST_CONDITION(subscriptions[i]->Read(&response));
+            TEST_CONDITION(response.message().created_at() == j);
+        }
+    }
+
+    // The subscriptions end after being idle for the wait duration.
+    for (unsigned i = 0; i < kNumRelayedSubscribers; ++i) {
+        e8::SubscribeRealTimeMessageQueueResponse response;
+        TEST_CONDITION(!subscriptions[i]->Read(&response));
+        TEST_CONDITION(subscriptions[i]->Finish().ok());
+    }
+
+    // Delivered messages are removed from the queues.
+    for (unsigned i = 0; i < kNumRelayedSubscribers; ++i) {
+        TEST_CONDITION(e8::MessageQueueStoreInstance()->ListQueue(i + 1).empty());
+    }
+
+    front_server->Shutdown();
+    cq->Shutdown();
+    subscriber_service.Wait();
+    message_queue_server->Shutdown(std::chrono::system_clock::now());
+
+    return true;
+}
+
+int main() {
+    e8::BeginTestSuite("message_subscriber_async_service");
+    e8::RunTest("IdleSubscribersDontStarveRequestsTest", IdleSubscribersDontStarveRequestsTest);
+    e8::RunTest("RelayMessagesThroughMultiplexedStreamTest",
+                RelayMessagesThroughMultiplexedStreamTest);
+    e8::EndTestSuite();
+    return 0;
+}
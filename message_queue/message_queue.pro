@@ -5,6 +5,8 @@ SUBDIRS = \
     message_queue/message_queue_service_main.pro \
     publisher/publisher.pro \
     subscriber/subscriber_service.pro \
-    _test_message_queue/_test_module/_test_message_queue_store/_test_message_queue_store.pro
+    _test_message_queue/_test_module/_test_message_queue_store/_test_message_queue_store.pro \
+    _test_message_queue/_test_service/_test_message_queue_async_service/_test_message_queue_async_service.pro \
+    _test_message_queue/_test_service/_test_message_subscriber_async_service/_test_message_subscriber_async_service.pro
 
 CONFIG += ordered
@@ -16,17 +16,29 @@
  */
 
 #include "common/flags/parse_flags.h"
+#include "message_queue/message_queue/service/message_queue_async_service.h"
 #include "message_queue/message_queue/service/message_queue_service.h"
 
+#include <cassert>
 #include <grpcpp/ext/proto_server_reflection_plugin.h>
 #include <grpcpp/grpcpp.h>
 #include <grpcpp/health_check_service_interface.h>
 #include <iostream>
+#include <memory>
+#include <vector>
 
 static char const kPortFlag[] = "port";
+static char const kAsyncServerFlag[] = "async_server";
+static char const kNumCompletionQueuesFlag[] = "num_completion_queues";
+static char const kNumCompletionQueueThreadsFlag[] = "num_completion_queue_threads";
+
 static int const kDefaultPort = 40041;
+static bool const kDefaultAsyncServer = true;
+static int const kDefaultNumCompletionQueues = 1;
+static int const kDefaultNumCompletionQueueThreads = 2;
 
 static e8::MessageQueueServiceImpl gMessageQueueService;
+static e8::MessageQueueAsyncServiceImpl gMessageQueueAsyncService;
 
 int main(int argc, char *argv[]) {
     e8::Argv(argc, argv);
@@ -39,11 +51,39 @@ int main(int argc, char *argv[]) {
 
     grpc::ServerBuilder builder;
     builder.AddListeningPort(server_address, grpc::InsecureServerCredentials());
-    builder.RegisterService(&gMessageQueueService);
+
+    // In the async mode, dequeue calls waiting on empty queues are woken up by the queue listeners
+    // instead of each blocking a thread.
+    bool async_server = e8::ReadFlag(kAsyncServerFlag, kDefaultAsyncServer, e8::FromString<bool>);
+    std::vector<std::unique_ptr<grpc::ServerCompletionQueue>> cqs;
+    if (async_server) {
+        int num_cqs = e8::ReadFlag(kNumCompletionQueuesFlag, kDefaultNumCompletionQueues,
+                                   e8::FromString<int>);
+        assert(num_cqs > 0);
+
+        builder.RegisterService(&gMessageQueueAsyncService);
+        for (int i = 0; i < num_cqs; ++i) {
+            cqs.push_back(builder.AddCompletionQueue());
+        }
+    } else {
+        builder.RegisterService(&gMessageQueueService);
+    }
 
     std::unique_ptr<grpc::Server> server(builder.BuildAndStart());
     std::cout << "Server listening on " << server_address << std::endl;
 
+    if (async_server) {
+        int num_cq_threads = e8::ReadFlag(kNumCompletionQueueThreadsFlag,
+                                          kDefaultNumCompletionQueueThreads, e8::FromString<int>);
+        assert(num_cq_threads > 0);
+
+        std::vector<grpc::ServerCompletionQueue *> cq_ptrs;
+        for (auto const &cq : cqs) {
+            cq_ptrs.push_back(cq.get());
+        }
+        gMessageQueueAsyncService.Serve(cq_ptrs, static_cast<unsigned>(num_cq_threads));
+    }
+
     server->Wait();
 
     return 0;
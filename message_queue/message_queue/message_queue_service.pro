@@ -17,9 +17,11 @@ INCLUDEPATH += ../../
 
 SOURCES += \
     module/message_queue_store.cc \
+    service/message_queue_async_service.cc \
     service/message_queue_service.cc
 HEADERS += \
     module/message_queue_store.h \
+    service/message_queue_async_service.h \
     service/message_queue_service.h
 
 # Default rules for deployment.
@@ -15,15 +15,15 @@
  * not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <deque>
 #include <memory>
 #include <mutex>
 #include <optional>
-#include <semaphore.h>
-#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -36,9 +36,9 @@ static MessageQueueStore gMessageQueueStore;
 
 } // namespace
 
-MessageQueueStore::MessageQueue::MessageQueue() { sem_init(&queue_resource_count, 0, 0); }
+MessageQueueStore::MessageQueue::MessageQueue(MessageKey const key) : key(key) {}
 
-MessageQueueStore::MessageQueue::~MessageQueue() { sem_destroy(&queue_resource_count); }
+bool MessageQueueStore::MessageQueue::Readable() const { return !queue.empty() && !front_in_use; }
 
 MessageQueueStore::MessageQueue *MessageQueueStore::FetchQueue(MessageKey const key) {
     MessageQueue *queue;
@@ -52,7 +52,8 @@ MessageQueueStore::MessageQueue *MessageQueueStore::FetchQueue(MessageKey const
         map_lock_.unlock_shared();
 
         map_lock_.lock();
-        auto write_it = queues_.insert(std::make_pair(key, std::make_shared<MessageQueue>())).first;
+        auto write_it =
+            queues_.insert(std::make_pair(key, std::make_shared<MessageQueue>(key))).first;
         queue = write_it->second.get();
         map_lock_.unlock();
     }
@@ -68,35 +69,28 @@ void MessageQueueStore::Enqueue(MessageKey const key, RealTimeMessage const &mes
     message_queue->queue.push_back(message);
     message_queue->queue_lock.unlock();
 
-    sem_post(&message_queue->queue_resource_count);
+    this->NotifyIfReadable(message_queue);
 }
 
-MessageQueueStore::MessageQueue *MessageQueueStore::BeginBlockingDequeue(MessageKey const key,
-                                                                         int const wait_for_secs,
-                                                                         RealTimeMessage *message) {
+MessageQueueStore::MessageQueue *
+MessageQueueStore::BeginBlockingDequeue(MessageKey const key, std::chrono::milliseconds wait_for,
+                                        RealTimeMessage *message) {
     MessageQueue *message_queue = FetchQueue(key);
-
-    int rc;
-    if (wait_for_secs > 0) {
-        std::time_t expiry_timestamp;
-        std::time(&expiry_timestamp);
-        expiry_timestamp += wait_for_secs;
-
-        timespec ts;
-        ts.tv_sec = expiry_timestamp;
-        ts.tv_nsec = 0;
-        rc = sem_timedwait(&message_queue->queue_resource_count, &ts);
+    auto readable = [message_queue] { return message_queue->Readable(); };
+
+    std::unique_lock<std::mutex> lock(message_queue->queue_lock);
+    if (wait_for.count() > 0) {
+        // The steady clock isn't affected by adjustments to the system time.
+        std::chrono::steady_clock::time_point deadline =
+            std::chrono::steady_clock::now() + wait_for;
+        if (!message_queue->readable.wait_until(lock, deadline, readable)) {
+            return nullptr;
+        }
     } else {
-        rc = sem_wait(&message_queue->queue_resource_count);
-    }
-
-    if (rc == -1 && errno == ETIMEDOUT) {
-        return nullptr;
+        message_queue->readable.wait(lock, readable);
     }
 
-    assert(rc == 0);
-
-    message_queue->queue_lock.lock();
+    message_queue->front_in_use = true;
     *message = message_queue->queue.front();
 
     return message_queue;
@@ -105,12 +99,72 @@ MessageQueueStore::MessageQueue *MessageQueueStore::BeginBlockingDequeue(Message
 void MessageQueueStore::EndBlockingDequeue(MessageQueue *message_queue, bool dequeue) {
     assert(message_queue != nullptr);
 
+    message_queue->queue_lock.lock();
+    assert(message_queue->front_in_use);
     if (dequeue) {
         message_queue->queue.pop_front();
-    } else {
-        sem_post(&message_queue->queue_resource_count);
     }
+    message_queue->front_in_use = false;
     message_queue->queue_lock.unlock();
+
+    this->NotifyIfReadable(message_queue);
+}
+
+MessageQueueStore::MessageQueue *MessageQueueStore::TryBeginDequeue(MessageKey const key,
+                                                                    RealTimeMessage *message) {
+    MessageQueue *message_queue = FetchQueue(key);
+
+    message_queue->queue_lock.lock();
+    if (!message_queue->Readable()) {
+        message_queue->queue_lock.unlock();
+        return nullptr;
+    }
+    message_queue->front_in_use = true;
+    *message = message_queue->queue.front();
+    message_queue->queue_lock.unlock();
+
+    return message_queue;
+}
+
+void MessageQueueStore::AddListener(MessageKey const key, ListenerInterface *listener) {
+    MessageQueue *message_queue = FetchQueue(key);
+
+    message_queue->listener_lock.lock();
+    message_queue->listeners.push_back(listener);
+    message_queue->listener_lock.unlock();
+
+    this->NotifyIfReadable(message_queue);
+}
+
+void MessageQueueStore::RemoveListener(MessageKey const key, ListenerInterface *listener) {
+    MessageQueue *message_queue = FetchQueue(key);
+
+    message_queue->listener_lock.lock();
+    auto it = std::find(message_queue->listeners.begin(), message_queue->listeners.end(), listener);
+    if (it != message_queue->listeners.end()) {
+        message_queue->listeners.erase(it);
+    }
+    message_queue->listener_lock.unlock();
+}
+
+void MessageQueueStore::NotifyIfReadable(MessageQueue *message_queue) {
+    message_queue->queue_lock.lock();
+    bool readable = message_queue->Readable();
+    message_queue->queue_lock.unlock();
+
+    if (!readable) {
+        return;
+    }
+
+    // Both a blocked reader and the listeners are woken up. Whoever begins the dequeue first gets
+    // the message, and the rest will be notified again once it's released.
+    message_queue->readable.notify_one();
+
+    message_queue->listener_lock.lock();
+    for (ListenerInterface *listener : message_queue->listeners) {
+        listener->OnReadable(message_queue->key);
+    }
+    message_queue->listener_lock.unlock();
 }
 
 std::vector<RealTimeMessage> MessageQueueStore::ListQueue(MessageKey const key) {
@@ -18,13 +18,13 @@
 #ifndef MESSAGE_QUEUE_STORE_H
 #define MESSAGE_QUEUE_STORE_H
 
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
-#include <ctime>
 #include <deque>
 #include <memory>
 #include <mutex>
 #include <optional>
-#include <semaphore.h>
 #include <shared_mutex>
 #include <unordered_map>
 #include <vector>
@@ -37,24 +37,53 @@ namespace e8 {
 
 /**
  * @brief The MessageQueueStore class A thread-safe FIFO message queue store. It stores a set of
- * message queues identfied by a unique key.
+ * message queues identfied by a unique key. A reader either blocks on a queue until it becomes
+ * readable, or registers a listener and gets called back, so a single thread can wait on any
+ * number of queues.
  */
 class MessageQueueStore {
   public:
+    /**
+     * @brief The ListenerInterface class Gets notified when a queue it listens to may have a
+     * message ready for dequeuing.
+     */
+    class ListenerInterface {
+      public:
+        virtual ~ListenerInterface() = default;
+
+        /**
+         * @brief OnReadable Called when a message is enqueued or put back to the queue pointed
+         * to by the key. The implementation must not block and must not call back into the store
+         * from within this function.
+         */
+        virtual void OnReadable(MessageKey const key) = 0;
+    };
+
     struct MessageQueue {
-        MessageQueue();
-        ~MessageQueue();
+        explicit MessageQueue(MessageKey const key);
+        ~MessageQueue() = default;
+
+        /**
+         * @brief Readable Whether the oldest element is there and isn't held by any reader. The
+         * queue_lock has to be held by the caller.
+         */
+        bool Readable() const;
 
+        MessageKey const key;
         std::deque<RealTimeMessage> queue;
+        bool front_in_use = false;
 
         std::mutex queue_lock;
-        sem_t queue_resource_count;
+        std::condition_variable readable;
+
+        std::vector<ListenerInterface *> listeners;
+        std::mutex listener_lock;
     };
 
     /**
      * @brief Enqueue Add a new message to the queue pointed by the parameter key. If there are
      * readers calling BlockingDequeue on an empty queue, this operation will unblock one of the
-     * readers.
+     * readers, and the listeners of the queue will be notified.
      *
      * @param key A unique ID pointing to the queue to add message to.
      * @param message Message to be added.
@@ -64,27 +93,51 @@ class MessageQueueStore {
     /**
      * @brief BlockingDequeue Read the oldest element from the queue pointed to by the key. If the
      * queue is empty, this function will block until it becomes non-empty. If the element exists,
-     * this function will exclusively block concurrent access until EndBlockingDequeue() is called.
+     * this function will hold it exclusively from other readers until EndBlockingDequeue() is
+     * called. Writers are not blocked in the meantime.
      *
      * @param key A unique ID pointing to the queue to read the message from.
-     * @param wait_for_secs The number of seconds to wait before returning an empty queue if there
-     * isn't anything coming into the queue for at least this duration.
+     * @param wait_for The duration, measured by a monotonic clock, to wait before returning an
+     * empty queue if there isn't anything coming into the queue. It waits indefinitely if the
+     * duration isn't positive.
      * @param message returns the The oldest message from the queue.
      * @return A pointer to the message queue pointed to by the message key.
      */
-    MessageQueue *BeginBlockingDequeue(MessageKey const key, int const wait_for_secs,
+    MessageQueue *BeginBlockingDequeue(MessageKey const key, std::chrono::milliseconds wait_for,
                                        RealTimeMessage *message);
 
     /**
-     * @brief EndBlockingDequeue Unblock the queue's concurrent access and potentially remove the
-     * oldest element depending on the "dequeue" argument.
+     * @brief EndBlockingDequeue Release the oldest element to other readers and potentially remove
+     * it depending on the "dequeue" argument. It can be called from any thread.
      *
-     * @param message_queue Pointer to the queue to be unblocked the concurrent access.
-     * @param dequeue Whether or not to remove the oldest element before the concurrent access is
-     * recovered.
+     * @param message_queue Pointer to the queue of which the oldest element is to be released.
+     * @param dequeue Whether or not to remove the oldest element before it's released.
      */
     void EndBlockingDequeue(MessageQueue *message_queue, bool dequeue);
 
+    /**
+     * @brief TryBeginDequeue Non-blocking counterpart of BeginBlockingDequeue(). The access has to
+     * be ended by EndBlockingDequeue() as well.
+     *
+     * @param key A unique ID pointing to the queue to read the message from.
+     * @param message returns the The oldest message from the queue.
+     * @return A pointer to the message queue pointed to by the message key, or nullptr if no
+     * message is ready for dequeuing right now.
+     */
+    MessageQueue *TryBeginDequeue(MessageKey const key, RealTimeMessage *message);
+
+    /**
+     * @brief AddListener Starts notifying the listener about the queue pointed to by the key. If
+     * the queue has messages ready for dequeuing, the listener will be notified immediately.
+     */
+    void AddListener(MessageKey const key, ListenerInterface *listener);
+
+    /**
+     * @brief RemoveListener Stops notifying the listener about the queue pointed to by the key.
+     * Once it returns, the listener will not be called for the queue anymore.
+     */
+    void RemoveListener(MessageKey const key, ListenerInterface *listener);
+
     /**
      * @brief ListQueue Returns all the messages in the queue pointed by the key.
      */
@@ -102,6 +155,7 @@ class MessageQueueStore {
 
   private:
     MessageQueue *FetchQueue(MessageKey const key);
+    void NotifyIfReadable(MessageQueue *message_queue);
 
     std::unordered_map<MessageKey, std::shared_ptr<MessageQueue>> queues_;
     std::shared_mutex map_lock_;
@@ -0,0 +1,437 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <grpc/support/time.h>
+#include <grpcpp/alarm.h>
+#include <grpcpp/grpcpp.h>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "message_queue/common/entity.h"
+#include "message_queue/message_queue/module/message_queue_store.h"
+#include "message_queue/message_queue/service/message_queue_async_service.h"
+#include "proto_cc/real_time_message.pb.h"
+#include "proto_cc/service_message_queue.grpc.pb.h"
+#include "proto_cc/service_message_queue.pb.h"
+
+namespace e8 {
+namespace {
+
+class DequeueCall;
+
+/**
+ * @brief The Tag struct Completion queue tag of one kind of operation of a dequeue call.
+ */
+struct Tag {
+    enum Event {
+        ACCEPTED,
+        READ,
+        WRITTEN,
+        WOKEN_UP,
+        TIMER_EXPIRED,
+        DONE,
+        FINISHED,
+    };
+
+    DequeueCall *call;
+    Event event;
+};
+
+/**
+ * @brief The DequeueCall class State machine of a single DequeueMessage call. It follows the same
+ * protocol as MessageQueueServiceImpl::DequeueMessage(). When the queue is empty, it listens to the
+ * queue and gets woken up through an alarm on its completion queue. Whichever operation ends the
+ * wait owns the next stream operation. It deletes itself once none of its operations is pending.
+ */
+class DequeueCall : public MessageQueueStore::ListenerInterface {
+  public:
+    DequeueCall(MessageQueueAsyncServiceImpl *service, grpc::ServerCompletionQueue *cq);
+    DequeueCall(DequeueCall const &) = delete;
+    ~DequeueCall() override = default;
+
+    /**
+     * @brief Proceed Advances the call upon the completion of an operation.
+     *
+     * @param ok Whether the operation succeeded.
+     */
+    void Proceed(Tag::Event event, bool ok);
+
+    void OnReadable(MessageKey const key) override;
+
+  private:
+    void ReadRequest();
+    void OnRequest(bool ok);
+    void OnWritten(bool ok);
+    void OnWokenUp();
+    void OnTimerExpired(bool ok);
+    void OnDone();
+    void BeginWait();
+    bool EndWaitLocked();
+    void Write(RealTimeMessage const &message);
+    void PutBack();
+    void Finish(grpc::Status const &status);
+
+    MessageQueueAsyncServiceImpl *service_;
+    grpc::ServerCompletionQueue *cq_;
+
+    grpc::ServerContext context_;
+    grpc::ServerAsyncReaderWriter<DequeueMessageResponse, DequeueMessageRequest> stream_;
+    DequeueMessageRequest request_;
+    grpc::Alarm wake_up_;
+    grpc::Alarm timer_;
+
+    Tag accepted_tag_;
+    Tag read_tag_;
+    Tag written_tag_;
+    Tag woken_up_tag_;
+    Tag timer_expired_tag_;
+    Tag done_tag_;
+    Tag finished_tag_;
+
+    // Only accessed by the owner of the next stream operation.
+    MessageKey user_id_ = 0;
+    MessageQueueStore::MessageQueue *queue_ = nullptr;
+
+    bool done_ = false;
+    bool waiting_ = false;
+    // Set when the queue becomes readable while BeginWait() is registering the listener.
+    bool readable_ = false;
+    bool wake_up_pending_ = false;
+    bool timer_pending_ = false;
+    bool rearm_timer_ = false;
+    gpr_timespec wait_deadline_;
+    bool finish_started_ = false;
+    // The done notification is pending from the moment the call is accepted.
+    unsigned num_pending_ops_ = 1;
+    std::mutex mutex_;
+};
+
+DequeueCall::DequeueCall(MessageQueueAsyncServiceImpl *service, grpc::ServerCompletionQueue *cq)
+    : service_(service), cq_(cq), stream_(&context_), accepted_tag_{this, Tag::ACCEPTED},
+      read_tag_{this, Tag::READ}, written_tag_{this, Tag::WRITTEN},
+      woken_up_tag_{this, Tag::WOKEN_UP}, timer_expired_tag_{this, Tag::TIMER_EXPIRED},
+      done_tag_{this, Tag::DONE}, finished_tag_{this, Tag::FINISHED} {
+    context_.AsyncNotifyWhenDone(&done_tag_);
+    service_->RequestDequeueMessage(&context_, &stream_, cq_, cq_, &accepted_tag_);
+}
+
+void DequeueCall::Proceed(Tag::Event event, bool ok) {
+    switch (event) {
+    case Tag::ACCEPTED: {
+        if (!ok) {
+            // The server is shutting down.
+            delete this;
+            return;
+        }
+
+        // Keeps accepting new calls.
+        new DequeueCall(service_, cq_);
+
+        this->ReadRequest();
+        return;
+    }
+    case Tag::READ: {
+        this->OnRequest(ok);
+        break;
+    }
+    case Tag::WRITTEN: {
+        this->OnWritten(ok);
+        break;
+    }
+    case Tag::WOKEN_UP: {
+        this->OnWokenUp();
+        break;
+    }
+    case Tag::TIMER_EXPIRED: {
+        this->OnTimerExpired(ok);
+        break;
+    }
+    case Tag::DONE: {
+        this->OnDone();
+        break;
+    }
+    case Tag::FINISHED: {
+        break;
+    }
+    }
+
+    mutex_.lock();
+    --num_pending_ops_;
+    bool completed = finish_started_ && num_pending_ops_ == 0;
+    mutex_.unlock();
+
+    if (completed) {
+        delete this;
+    }
+}
+
+void DequeueCall::OnReadable(MessageKey const /*key*/) {
+    // It's called by the store, so the dequeue is deferred to a polling thread.
+    mutex_.lock();
+    if (!waiting_) {
+        readable_ = true;
+    } else if (!wake_up_pending_) {
+        wake_up_pending_ = true;
+        ++num_pending_ops_;
+        wake_up_.Set(cq_, gpr_now(GPR_CLOCK_MONOTONIC), &woken_up_tag_);
+    }
+    mutex_.unlock();
+}
+
+void DequeueCall::ReadRequest() {
+    mutex_.lock();
+    ++num_pending_ops_;
+    stream_.Read(&request_, &read_tag_);
+    mutex_.unlock();
+}
+
+void DequeueCall::OnRequest(bool ok) {
+    if (!ok) {
+        this->PutBack();
+        this->Finish(grpc::Status(grpc::StatusCode::ABORTED, "Stream closed."));
+        return;
+    }
+
+    // Guarantees that the user_id is consistent over the request stream.
+    if (user_id_ != 0 && user_id_ != request_.user_id()) {
+        this->PutBack();
+        this->Finish(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                                  "Can't operate on different queues."));
+        return;
+    }
+    user_id_ = request_.user_id();
+    assert(user_id_ != 0);
+
+    // Remove the oldest element only when the client successfully delivered the message.
+    if (queue_ != nullptr) {
+        MessageQueueStoreInstance()->EndBlockingDequeue(
+            queue_, /*dequeue=*/request_.previous_message_delivered());
+        queue_ = nullptr;
+    }
+
+    if (request_.end_operation()) {
+        this->Finish(grpc::Status(grpc::StatusCode::ABORTED,
+                                  "Client asks to halt the dequeue operation."));
+        return;
+    }
+
+    RealTimeMessage message;
+    queue_ = MessageQueueStoreInstance()->TryBeginDequeue(user_id_, &message);
+    if (queue_ != nullptr) {
+        this->Write(message);
+        return;
+    }
+
+    this->BeginWait();
+}
+
+void DequeueCall::OnWritten(bool ok) {
+    if (!ok) {
+        this->PutBack();
+        this->Finish(grpc::Status(grpc::StatusCode::ABORTED, "Stream closed."));
+        return;
+    }
+    this->ReadRequest();
+}
+
+void DequeueCall::OnWokenUp() {
+    mutex_.lock();
+    wake_up_pending_ = false;
+    if (!waiting_) {
+        mutex_.unlock();
+        return;
+    }
+
+    RealTimeMessage message;
+    MessageQueueStore::MessageQueue *queue =
+        MessageQueueStoreInstance()->TryBeginDequeue(user_id_, &message);
+    if (queue == nullptr) {
+        // Another reader took the message first. The listener will be notified again once it's
+        // released.
+        mutex_.unlock();
+        return;
+    }
+
+    this->EndWaitLocked();
+    queue_ = queue;
+    mutex_.unlock();
+
+    MessageQueueStoreInstance()->RemoveListener(user_id_, this);
+    this->Write(message);
+}
+
+void DequeueCall::OnTimerExpired(bool ok) {
+    mutex_.lock();
+    timer_pending_ = false;
+
+    if (rearm_timer_) {
+        // It's the expiry of a previous wait. The timer of the current wait starts now.
+        rearm_timer_ = false;
+        if (waiting_) {
+            timer_pending_ = true;
+            ++num_pending_ops_;
+            timer_.Set(cq_, wait_deadline_, &timer_expired_tag_);
+        }
+        mutex_.unlock();
+        return;
+    }
+
+    if (!ok || !this->EndWaitLocked()) {
+        mutex_.unlock();
+        return;
+    }
+    mutex_.unlock();
+
+    MessageQueueStoreInstance()->RemoveListener(user_id_, this);
+    this->Finish(grpc::Status(grpc::StatusCode::ABORTED, "Time out."));
+}
+
+void DequeueCall::OnDone() {
+    // While the call is waiting, no stream operation would notice the client going away.
+    mutex_.lock();
+    done_ = true;
+    if (!this->EndWaitLocked()) {
+        mutex_.unlock();
+        return;
+    }
+    mutex_.unlock();
+
+    MessageQueueStoreInstance()->RemoveListener(user_id_, this);
+    this->Finish(grpc::Status::CANCELLED);
+}
+
+void DequeueCall::BeginWait() {
+    mutex_.lock();
+    if (done_) {
+        mutex_.unlock();
+        this->Finish(grpc::Status::CANCELLED);
+        return;
+    }
+    readable_ = false;
+    mutex_.unlock();
+
+    // The listener has to be registered before the wait is published. Otherwise, whichever ends the
+    // wait would remove the listener before it's added, then finish and delete the call.
+    MessageQueueStoreInstance()->AddListener(user_id_, this);
+
+    mutex_.lock();
+    if (done_) {
+        // The client went away during the registration.
+        mutex_.unlock();
+        MessageQueueStoreInstance()->RemoveListener(user_id_, this);
+        this->Finish(grpc::Status::CANCELLED);
+        return;
+    }
+
+    waiting_ = true;
+    if (request_.wait_duration_secs() > 0) {
+        // The deadline is measured by the monotonic clock.
+        wait_deadline_ =
+            gpr_time_add(gpr_now(GPR_CLOCK_MONOTONIC),
+                         gpr_time_from_seconds(request_.wait_duration_secs(), GPR_TIMESPAN));
+        if (timer_pending_) {
+            rearm_timer_ = true;
+        } else {
+            timer_pending_ = true;
+            ++num_pending_ops_;
+            timer_.Set(cq_, wait_deadline_, &timer_expired_tag_);
+        }
+    }
+
+    // A readable queue notifies the listener right away, which happens before the wait is
+    // published.
+    if (readable_ && !wake_up_pending_) {
+        wake_up_pending_ = true;
+        ++num_pending_ops_;
+        wake_up_.Set(cq_, gpr_now(GPR_CLOCK_MONOTONIC), &woken_up_tag_);
+    }
+    mutex_.unlock();
+}
+
+bool DequeueCall::EndWaitLocked() {
+    if (!waiting_) {
+        return false;
+    }
+    waiting_ = false;
+
+    if (timer_pending_) {
+        rearm_timer_ = false;
+        timer_.Cancel();
+    }
+    return true;
+}
+
+void DequeueCall::Write(RealTimeMessage const &message) {
+    DequeueMessageResponse response;
+    *response.mutable_message() = message;
+
+    mutex_.lock();
+    ++num_pending_ops_;
+    stream_.Write(response, &written_tag_);
+    mutex_.unlock();
+}
+
+void DequeueCall::PutBack() {
+    if (queue_ != nullptr) {
+        MessageQueueStoreInstance()->EndBlockingDequeue(queue_, /*dequeue=*/false);
+        queue_ = nullptr;
+    }
+}
+
+void DequeueCall::Finish(grpc::Status const &status) {
+    mutex_.lock();
+    finish_started_ = true;
+    ++num_pending_ops_;
+    stream_.Finish(status, &finished_tag_);
+    mutex_.unlock();
+}
+
+void PollCompletionQueue(grpc::ServerCompletionQueue *cq) {
+    void *tag;
+    bool ok;
+    while (cq->Next(&tag, &ok)) {
+        Tag *call_tag = static_cast<Tag *>(tag);
+        call_tag->call->Proceed(call_tag->event, ok);
+    }
+}
+
+} // namespace
+
+MessageQueueAsyncServiceImpl::~MessageQueueAsyncServiceImpl() { this->Wait(); }
+
+void MessageQueueAsyncServiceImpl::Serve(std::vector<grpc::ServerCompletionQueue *> const &cqs,
+                                         unsigned num_threads_per_queue) {
+    assert(num_threads_per_queue > 0);
+
+    for (grpc::ServerCompletionQueue *cq : cqs) {
+        new DequeueCall(this, cq);
+        for (unsigned i = 0; i < num_threads_per_queue; ++i) {
+            pollers_.emplace_back(PollCompletionQueue, cq);
+        }
+    }
+}
+
+void MessageQueueAsyncServiceImpl::Wait() {
+    for (std::thread &poller : pollers_) {
+        poller.join();
+    }
+    pollers_.clear();
+}
+
+} // namespace e8
@@ -0,0 +1,64 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MESSAGE_QUEUE_ASYNC_SERVICE_H
+#define MESSAGE_QUEUE_ASYNC_SERVICE_H
+
+#include <grpcpp/grpcpp.h>
+#include <thread>
+#include <vector>
+
+#include "message_queue/message_queue/service/message_queue_service.h"
+#include "proto_cc/service_message_queue.grpc.pb.h"
+#include "proto_cc/service_message_queue.pb.h"
+
+namespace e8 {
+
+/**
+ * @brief The MessageQueueAsyncServiceImpl class Serves DequeueMessage off completion queues. A
+ * dequeue waiting on an empty queue listens to the queue instead of blocking a thread, so any
+ * number of waiting consumers can be served by a small, fixed set of polling threads. The rest of
+ * the methods are inherited from the MessageQueueServiceImpl.
+ */
+class MessageQueueAsyncServiceImpl
+    : public MessageQueueService::WithAsyncMethod_DequeueMessage<MessageQueueServiceImpl> {
+  public:
+    MessageQueueAsyncServiceImpl() = default;
+    MessageQueueAsyncServiceImpl(MessageQueueAsyncServiceImpl const &) = delete;
+    ~MessageQueueAsyncServiceImpl() override;
+
+    /**
+     * @brief Serve Starts accepting dequeue calls from the completion queues. Each completion
+     * queue is polled by num_threads_per_queue threads. It must be called after the server which
+     * the service and the completion queues are registered to has been started.
+     */
+    void Serve(std::vector<grpc::ServerCompletionQueue *> const &cqs,
+               unsigned num_threads_per_queue);
+
+    /**
+     * @brief Wait Blocks until all the completion queues have been shut down and drained. The
+     * server has to be shut down before the completion queues.
+     */
+    void Wait();
+
+  private:
+    std::vector<std::thread> pollers_;
+};
+
+} // namespace e8
+
+#endif // MESSAGE_QUEUE_ASYNC_SERVICE_H
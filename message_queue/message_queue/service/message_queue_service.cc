@@ -15,9 +15,17 @@
  * not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <grpcpp/grpcpp.h>
+#include <mutex>
 #include <optional>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
+#include "message_queue/common/entity.h"
 #include "message_queue/message_queue/module/message_queue_store.h"
 #include "message_queue/message_queue/service/message_queue_service.h"
 #include "proto_cc/real_time_message.pb.h"
@@ -41,6 +49,178 @@ WriteToStream(RealTimeMessage const &message,
     return grpc::Status::OK;
 }
 
+using MultiplexedDequeueStream =
+    grpc::ServerReaderWriter<MultiplexedDequeueMessageResponse, MultiplexedDequeueMessageRequest>;
+
+/**
+ * @brief The MultiplexedDequeueSession class Pushes the messages of every user subscribed through
+ * a multiplexed dequeue stream. The requests are read by a dedicated thread, whereas the message
+ * queues are only accessed by the thread serving the stream, which is woken up by the queue
+ * listener.
+ */
+class MultiplexedDequeueSession : public MessageQueueStore::ListenerInterface {
+  public:
+    explicit MultiplexedDequeueSession(MultiplexedDequeueStream *stream);
+    MultiplexedDequeueSession(MultiplexedDequeueSession const &) = delete;
+    ~MultiplexedDequeueSession() override = default;
+
+    void OnReadable(MessageKey const key) override;
+
+    /**
+     * @brief Serve Serves the stream until it's closed. All the unacknowledged messages are put
+     * back to their queues before it returns.
+     */
+    grpc::Status Serve();
+
+  private:
+    void ReadRequests();
+    void Apply(MultiplexedDequeueMessageRequest const &request);
+    bool Dispatch(MessageKey const key);
+
+    MultiplexedDequeueStream *stream_;
+
+    std::deque<MultiplexedDequeueMessageRequest> pending_requests_;
+    std::unordered_set<MessageKey> readable_keys_;
+    bool stream_closed_ = false;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+
+    // Only accessed by the thread serving the stream.
+    std::unordered_set<MessageKey> subscribed_keys_;
+    std::unordered_map<MessageKey, MessageQueueStore::MessageQueue *> in_flight_;
+};
+
+MultiplexedDequeueSession::MultiplexedDequeueSession(MultiplexedDequeueStream *stream)
+    : stream_(stream) {}
+
+void MultiplexedDequeueSession::OnReadable(MessageKey const key) {
+    mutex_.lock();
+    readable_keys_.insert(key);
+    mutex_.unlock();
+
+    cv_.notify_one();
+}
+
+grpc::Status MultiplexedDequeueSession::Serve() {
+    std::thread reader(&MultiplexedDequeueSession::ReadRequests, this);
+
+    grpc::Status status = grpc::Status::OK;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (status.ok()) {
+        cv_.wait(lock, [this] {
+            return stream_closed_ || !pending_requests_.empty() || !readable_keys_.empty();
+        });
+        if (stream_closed_) {
+            break;
+        }
+
+        std::deque<MultiplexedDequeueMessageRequest> requests;
+        requests.swap(pending_requests_);
+        std::unordered_set<MessageKey> readable_keys;
+        readable_keys.swap(readable_keys_);
+        lock.unlock();
+
+        for (auto const &request : requests) {
+            this->Apply(request);
+        }
+        for (MessageKey key : readable_keys) {
+            if (!this->Dispatch(key)) {
+                status = grpc::Status(grpc::StatusCode::ABORTED, "Stream closed.");
+                break;
+            }
+        }
+
+        lock.lock();
+    }
+    lock.unlock();
+
+    for (MessageKey key : subscribed_keys_) {
+        MessageQueueStoreInstance()->RemoveListener(key, this);
+    }
+    // Put the messages back.
+    for (auto const &[key, queue] : in_flight_) {
+        MessageQueueStoreInstance()->EndBlockingDequeue(queue, /*dequeue=*/false);
+    }
+
+    reader.join();
+
+    return status;
+}
+
+void MultiplexedDequeueSession::ReadRequests() {
+    MultiplexedDequeueMessageRequest request;
+    while (stream_->Read(&request)) {
+        mutex_.lock();
+        pending_requests_.push_back(request);
+        mutex_.unlock();
+
+        cv_.notify_one();
+    }
+
+    mutex_.lock();
+    stream_closed_ = true;
+    mutex_.unlock();
+
+    cv_.notify_one();
+}
+
+void MultiplexedDequeueSession::Apply(MultiplexedDequeueMessageRequest const &request) {
+    for (MessageKey key : request.subscribe_user_ids()) {
+        if (subscribed_keys_.insert(key).second) {
+            MessageQueueStoreInstance()->AddListener(key, this);
+        }
+    }
+
+    // Remove the oldest element only when the client successfully delivered the message.
+    for (MessageDeliveryAck const &ack : request.acks()) {
+        auto it = in_flight_.find(ack.user_id());
+        if (it == in_flight_.end()) {
+            continue;
+        }
+        MessageQueueStoreInstance()->EndBlockingDequeue(it->second,
+                                                        /*dequeue=*/ack.delivered());
+        in_flight_.erase(it);
+    }
+
+    for (MessageKey key : request.unsubscribe_user_ids()) {
+        if (subscribed_keys_.erase(key) == 0) {
+            continue;
+        }
+        MessageQueueStoreInstance()->RemoveListener(key, this);
+
+        auto it = in_flight_.find(key);
+        if (it != in_flight_.end()) {
+            MessageQueueStoreInstance()->EndBlockingDequeue(it->second, /*dequeue=*/false);
+            in_flight_.erase(it);
+        }
+    }
+}
+
+bool MultiplexedDequeueSession::Dispatch(MessageKey const key) {
+    if (subscribed_keys_.find(key) == subscribed_keys_.end() ||
+        in_flight_.find(key) != in_flight_.end()) {
+        // The next message will be pushed after the in-flight one gets acknowledged.
+        return true;
+    }
+
+    MultiplexedDequeueMessageResponse response;
+    MessageQueueStore::MessageQueue *queue =
+        MessageQueueStoreInstance()->TryBeginDequeue(key, response.mutable_message());
+    if (queue == nullptr) {
+        return true;
+    }
+
+    response.set_user_id(key);
+    if (!stream_->Write(response)) {
+        MessageQueueStoreInstance()->EndBlockingDequeue(queue, /*dequeue=*/false);
+        return false;
+    }
+
+    in_flight_[key] = queue;
+    return true;
+}
+
 } // namespace
 
 grpc::Status MessageQueueServiceImpl::EnqueueMessage(grpc::ServerContext * /*context*/,
@@ -91,7 +271,7 @@ grpc::Status MessageQueueServiceImpl::DequeueMessage(
         }
 
         queue = MessageQueueStoreInstance()->BeginBlockingDequeue(
-            user_id, request.wait_duration_secs(), &message);
+            user_id, std::chrono::seconds(request.wait_duration_secs()), &message);
 
         if (queue == nullptr) {
             current_status = grpc::Status(grpc::StatusCode::ABORTED, "Time out.");
@@ -125,4 +305,12 @@ grpc::Status MessageQueueServiceImpl::GetQueueStats(grpc::ServerContext * /*cont
     return grpc::Status::OK;
 }
 
+grpc::Status MessageQueueServiceImpl::MultiplexedDequeueMessage(
+    grpc::ServerContext * /*context*/,
+    grpc::ServerReaderWriter<MultiplexedDequeueMessageResponse, MultiplexedDequeueMessageRequest>
+        *stream) {
+    MultiplexedDequeueSession session(stream);
+    return session.Serve();
+}
+
 } // namespace e8
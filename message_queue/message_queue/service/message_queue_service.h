@@ -46,6 +46,11 @@ class MessageQueueServiceImpl : public MessageQueueService::Service {
 
     grpc::Status GetQueueStats(grpc::ServerContext *context, GetQueueStatsRequest const *request,
                                GetQueueStatsResponse *response) override;
+
+    grpc::Status MultiplexedDequeueMessage(
+        grpc::ServerContext *context,
+        grpc::ServerReaderWriter<MultiplexedDequeueMessageResponse,
+                                 MultiplexedDequeueMessageRequest> *stream) override;
 };
 
 } // namespace e8
@@ -46,7 +46,7 @@ bool E8MessagePublisher::Publish(MessageKey key, RealTimeMessage const &message)
     }
 
     std::unique_ptr<MessageQueueService::Stub> stub =
-        CREATE_GRPC_STUB(MessageQueueService, *node, message_queue_service_port_);
+        CREATE_SHARED_GRPC_STUB(MessageQueueService, *node, message_queue_service_port_);
 
     grpc::ClientContext context;
 
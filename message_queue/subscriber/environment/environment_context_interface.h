@@ -24,6 +24,7 @@
 #include "distributor/store/node_state_store.h"
 #include "keygen/key_generator_interface.h"
 #include "message_queue/common/entity.h"
+#include "message_queue/subscriber/module/message_queue_multiplexer.h"
 
 namespace e8 {
 
@@ -66,6 +67,11 @@ class SubscriberEnvironmentContextInterface {
      * queue service.
      */
     virtual MessageQueueServicePort GetMessageQueueServicePort() = 0;
+
+    /**
+     * @brief MessageQueueMultiplexers Shared subscription streams to the message queue nodes.
+     */
+    virtual MessageQueueMultiplexerPool *MessageQueueMultiplexers() = 0;
 };
 
 /**
@@ -25,6 +25,7 @@
 #include "message_queue/common/message_queue_distributor.h"
 #include "message_queue/subscriber/environment/environment_context_interface.h"
 #include "message_queue/subscriber/environment/prod_environment_context.h"
+#include "message_queue/subscriber/module/message_queue_multiplexer.h"
 
 namespace e8 {
 
@@ -54,4 +55,8 @@ MessageQueueServicePort SubscriberProductionEnvironmentContext::GetMessageQueueS
     return message_queue_port_;
 }
 
+MessageQueueMultiplexerPool *SubscriberProductionEnvironmentContext::MessageQueueMultiplexers() {
+    return &message_queue_multiplexers_;
+}
+
 } // namespace e8
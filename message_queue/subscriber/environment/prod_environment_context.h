@@ -25,6 +25,7 @@
 #include "distributor/store/node_state_store.h"
 #include "keygen/key_generator_interface.h"
 #include "message_queue/subscriber/environment/environment_context_interface.h"
+#include "message_queue/subscriber/module/message_queue_multiplexer.h"
 
 namespace e8 {
 
@@ -49,10 +50,13 @@ class SubscriberProductionEnvironmentContext : public SubscriberEnvironmentConte
 
     MessageQueueServicePort GetMessageQueueServicePort() override;
 
+    MessageQueueMultiplexerPool *MessageQueueMultiplexers() override;
+
   private:
     std::unique_ptr<NodeStateStoreInterface> node_states_;
     std::unique_ptr<KeyGeneratorInterface> key_gen_;
     std::unique_ptr<DistributorInterface> distributor_;
+    MessageQueueMultiplexerPool message_queue_multiplexers_;
     MessageQueueServicePort const message_queue_port_;
 };
 
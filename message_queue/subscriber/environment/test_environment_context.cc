@@ -24,6 +24,7 @@
 #include "message_queue/common/message_queue_distributor.h"
 #include "message_queue/subscriber/environment/environment_context_interface.h"
 #include "message_queue/subscriber/environment/test_environment_context.h"
+#include "message_queue/subscriber/module/message_queue_multiplexer.h"
 
 namespace e8 {
 
@@ -47,4 +48,8 @@ DistributorInterface *SubscriberTestEnvironmentContext::Distributor() { return d
 
 MessageQueueServicePort SubscriberTestEnvironmentContext::GetMessageQueueServicePort() { return 0; }
 
+MessageQueueMultiplexerPool *SubscriberTestEnvironmentContext::MessageQueueMultiplexers() {
+    return &message_queue_multiplexers_;
+}
+
 } // namespace e8
@@ -25,6 +25,7 @@
 #include "distributor/store/node_state_store.h"
 #include "keygen/key_generator_interface.h"
 #include "message_queue/subscriber/environment/environment_context_interface.h"
+#include "message_queue/subscriber/module/message_queue_multiplexer.h"
 
 namespace e8 {
 
@@ -47,10 +48,13 @@ class SubscriberTestEnvironmentContext : public SubscriberEnvironmentContextInte
 
     MessageQueueServicePort GetMessageQueueServicePort() override;
 
+    MessageQueueMultiplexerPool *MessageQueueMultiplexers() override;
+
   private:
     std::unique_ptr<NodeStateStoreInterface> node_states_;
     std::unique_ptr<KeyGeneratorInterface> key_gen_;
     std::unique_ptr<DistributorInterface> distributor_;
+    MessageQueueMultiplexerPool message_queue_multiplexers_;
 };
 
 } // namespace e8
@@ -0,0 +1,266 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <grpcpp/grpcpp.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "distributor/distributor/grpc_stub.h"
+#include "message_queue/common/entity.h"
+#include "message_queue/subscriber/module/message_queue_multiplexer.h"
+#include "proto_cc/node.pb.h"
+#include "proto_cc/real_time_message.pb.h"
+#include "proto_cc/service_message_queue.grpc.pb.h"
+#include "proto_cc/service_message_queue.pb.h"
+
+namespace e8 {
+
+MessageQueueMultiplexer::MessageQueueMultiplexer(std::shared_ptr<grpc::Channel> const &channel)
+    : stub_(MessageQueueService::NewStub(channel)) {}
+
+MessageQueueMultiplexer::~MessageQueueMultiplexer() {
+    mutex_.lock();
+    if (connected_) {
+        context_->TryCancel();
+    }
+    mutex_.unlock();
+
+    if (reader_.joinable()) {
+        reader_.join();
+    }
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+}
+
+bool MessageQueueMultiplexer::Subscribe(MessageKey const user_id, MessageSinkInterface *sink) {
+    mutex_.lock();
+
+    if (!connected_) {
+        this->Connect();
+    }
+
+    Subscription *subscription = &subscriptions_[user_id];
+    subscription->sinks.push_back(sink);
+    if (subscription->sinks.size() > 1) {
+        // The user's messages have already been pushed through the stream.
+        mutex_.unlock();
+        return true;
+    }
+
+    MultiplexedDequeueMessageRequest request;
+    request.add_subscribe_user_ids(user_id);
+    if (!this->Send(request)) {
+        subscriptions_.erase(user_id);
+        mutex_.unlock();
+        return false;
+    }
+
+    mutex_.unlock();
+    return true;
+}
+
+void MessageQueueMultiplexer::Unsubscribe(MessageKey const user_id, MessageSinkInterface *sink) {
+    mutex_.lock();
+
+    auto it = subscriptions_.find(user_id);
+    if (it == subscriptions_.end()) {
+        // The stream has been broken.
+        mutex_.unlock();
+        return;
+    }
+
+    Subscription *subscription = &it->second;
+    auto sink_it = std::find(subscription->sinks.begin(), subscription->sinks.end(), sink);
+    if (sink_it == subscription->sinks.end()) {
+        mutex_.unlock();
+        return;
+    }
+    subscription->sinks.erase(sink_it);
+
+    MultiplexedDequeueMessageRequest request;
+    if (subscription->holder == sink) {
+        subscription->holder = nullptr;
+
+        MessageDeliveryAck *ack = request.add_acks();
+        ack->set_user_id(user_id);
+        ack->set_delivered(false);
+    }
+    if (subscription->sinks.empty()) {
+        subscriptions_.erase(it);
+        request.add_unsubscribe_user_ids(user_id);
+    }
+    if (request.acks_size() > 0 || request.unsubscribe_user_ids_size() > 0) {
+        this->Send(request);
+    }
+
+    mutex_.unlock();
+}
+
+void MessageQueueMultiplexer::Acknowledge(MessageKey const user_id, MessageSinkInterface *sink,
+                                          bool delivered) {
+    mutex_.lock();
+
+    auto it = subscriptions_.find(user_id);
+    if (it == subscriptions_.end() || it->second.holder != sink) {
+        mutex_.unlock();
+        return;
+    }
+    it->second.holder = nullptr;
+
+    MultiplexedDequeueMessageRequest request;
+    MessageDeliveryAck *ack = request.add_acks();
+    ack->set_user_id(user_id);
+    ack->set_delivered(delivered);
+    this->Send(request);
+
+    mutex_.unlock();
+}
+
+void MessageQueueMultiplexer::Connect() {
+    // The threads of the previous stream have nothing left to do once it's disconnected.
+    if (reader_.joinable()) {
+        reader_.join();
+    }
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+
+    context_ = std::make_unique<grpc::ClientContext>();
+    stream_ = stub_->MultiplexedDequeueMessage(context_.get());
+    connected_ = true;
+
+    outgoing_mutex_.lock();
+    outgoing_.clear();
+    stream_closed_ = false;
+    outgoing_mutex_.unlock();
+
+    reader_ = std::thread(&MessageQueueMultiplexer::ReadMessages, this);
+    writer_ = std::thread(&MessageQueueMultiplexer::WriteRequests, this);
+}
+
+void MessageQueueMultiplexer::ReadMessages() {
+    MultiplexedDequeueMessageResponse response;
+    while (stream_->Read(&response)) {
+        mutex_.lock();
+
+        bool accepted = false;
+        auto it = subscriptions_.find(response.user_id());
+        if (it != subscriptions_.end() && it->second.holder == nullptr) {
+            // Spreads the messages over the sinks of the user.
+            Subscription *subscription = &it->second;
+            for (unsigned i = 0; i < subscription->sinks.size() && !accepted; ++i) {
+                unsigned sink_index = (subscription->next_sink + i) % subscription->sinks.size();
+                MessageSinkInterface *sink = subscription->sinks[sink_index];
+                if (sink->Deliver(response.message())) {
+                    subscription->holder = sink;
+                    subscription->next_sink = sink_index + 1;
+                    accepted = true;
+                }
+            }
+        }
+
+        if (!accepted) {
+            MultiplexedDequeueMessageRequest request;
+            MessageDeliveryAck *ack = request.add_acks();
+            ack->set_user_id(response.user_id());
+            ack->set_delivered(false);
+            this->Send(request);
+        }
+
+        mutex_.unlock();
+    }
+
+    mutex_.lock();
+    connected_ = false;
+    for (auto const &[user_id, subscription] : subscriptions_) {
+        for (MessageSinkInterface *sink : subscription.sinks) {
+            sink->Close();
+        }
+    }
+    subscriptions_.clear();
+    mutex_.unlock();
+
+    // Lets the writer thread finish the stream.
+    outgoing_mutex_.lock();
+    stream_closed_ = true;
+    outgoing_mutex_.unlock();
+    outgoing_ready_.notify_one();
+}
+
+void MessageQueueMultiplexer::WriteRequests() {
+    bool writable = true;
+    while (true) {
+        std::unique_lock<std::mutex> lock(outgoing_mutex_);
+        outgoing_ready_.wait(lock, [this] { return !outgoing_.empty() || stream_closed_; });
+        if (stream_closed_) {
+            break;
+        }
+
+        MultiplexedDequeueMessageRequest request = std::move(outgoing_.front());
+        outgoing_.pop_front();
+        lock.unlock();
+
+        if (writable && !stream_->Write(request)) {
+            // Makes sure the reader finds out about the broken stream.
+            writable = false;
+            context_->TryCancel();
+        }
+    }
+
+    // The reader has stopped, so nothing else operates on the stream.
+    stream_->Finish();
+}
+
+bool MessageQueueMultiplexer::Send(MultiplexedDequeueMessageRequest const &request) {
+    if (!connected_) {
+        return false;
+    }
+
+    outgoing_mutex_.lock();
+    outgoing_.push_back(request);
+    outgoing_mutex_.unlock();
+    outgoing_ready_.notify_one();
+
+    return true;
+}
+
+MessageQueueMultiplexer *MessageQueueMultiplexerPool::Get(NodeState const &node,
+                                                          MessageQueueServicePort const port) {
+    std::string target = grpc_stub_internal::NodeToTargetStr(node, port);
+
+    mutex_.lock();
+
+    std::unique_ptr<MessageQueueMultiplexer> &multiplexer = multiplexers_[target];
+    if (multiplexer == nullptr) {
+        multiplexer = std::make_unique<MessageQueueMultiplexer>(SharedGrpcChannel(node, port));
+    }
+    MessageQueueMultiplexer *result = multiplexer.get();
+
+    mutex_.unlock();
+
+    return result;
+}
+
+} // namespace e8
@@ -0,0 +1,154 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MESSAGE_QUEUE_MULTIPLEXER_H
+#define MESSAGE_QUEUE_MULTIPLEXER_H
+
+#include <condition_variable>
+#include <deque>
+#include <grpcpp/grpcpp.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "message_queue/common/entity.h"
+#include "proto_cc/node.pb.h"
+#include "proto_cc/real_time_message.pb.h"
+#include "proto_cc/service_message_queue.grpc.pb.h"
+#include "proto_cc/service_message_queue.pb.h"
+
+namespace e8 {
+
+/**
+ * @brief The MessageSinkInterface class Receives the messages dequeued for a subscribed user.
+ */
+class MessageSinkInterface {
+  public:
+    virtual ~MessageSinkInterface() = default;
+
+    /**
+     * @brief Deliver Hands over a message of the subscribed user. An accepted message has to be
+     * acknowledged through MessageQueueMultiplexer::Acknowledge(), and no other message of the
+     * user will be handed over before that. The implementation must not block and must not call
+     * back into the multiplexer from within this function.
+     *
+     * @return Whether the sink accepts the message. A rejected message is put back to the queue.
+     */
+    virtual bool Deliver(RealTimeMessage const &message) = 0;
+
+    /**
+     * @brief Close Called when the stream to the message queue node breaks. The sink has been
+     * unsubscribed by then. The implementation must not block and must not call back into the
+     * multiplexer from within this function.
+     */
+    virtual void Close() = 0;
+};
+
+/**
+ * @brief The MessageQueueMultiplexer class Subscribes to the message queues of many users on a
+ * message queue node through one MultiplexedDequeueMessage stream, then demultiplexes the pushed
+ * messages to the sinks of the users. The stream is opened by the first subscription, and it's
+ * reopened by the next subscription after it breaks. Requests to the node are queued and written by
+ * a writer thread of the stream, so the subscriptions aren't locked while the stream blocks. This
+ * class guarantees thread safety.
+ */
+class MessageQueueMultiplexer {
+  public:
+    explicit MessageQueueMultiplexer(std::shared_ptr<grpc::Channel> const &channel);
+    MessageQueueMultiplexer(MessageQueueMultiplexer const &) = delete;
+    ~MessageQueueMultiplexer();
+
+    /**
+     * @brief Subscribe Starts delivering the messages of the user to the sink. When the user has
+     * more than one sink, each message is delivered to one of them.
+     *
+     * @return false if the stream to the message queue node isn't usable.
+     */
+    bool Subscribe(MessageKey const user_id, MessageSinkInterface *sink);
+
+    /**
+     * @brief Unsubscribe Stops delivering messages to the sink. If the sink holds an
+     * unacknowledged message, the message is put back to the queue. Once it returns, the sink will
+     * not be called anymore.
+     */
+    void Unsubscribe(MessageKey const user_id, MessageSinkInterface *sink);
+
+    /**
+     * @brief Acknowledge Releases the message the sink accepted.
+     *
+     * @param delivered Whether the message was delivered. Only a delivered message is removed from
+     * the queue.
+     */
+    void Acknowledge(MessageKey const user_id, MessageSinkInterface *sink, bool delivered);
+
+  private:
+    struct Subscription {
+        std::vector<MessageSinkInterface *> sinks;
+        MessageSinkInterface *holder = nullptr;
+        unsigned next_sink = 0;
+    };
+
+    void Connect();
+    void ReadMessages();
+    void WriteRequests();
+    bool Send(MultiplexedDequeueMessageRequest const &request);
+
+    std::unique_ptr<MessageQueueService::Stub> stub_;
+    std::unique_ptr<grpc::ClientContext> context_;
+    std::unique_ptr<grpc::ClientReaderWriter<MultiplexedDequeueMessageRequest,
+                                             MultiplexedDequeueMessageResponse>>
+        stream_;
+    std::thread reader_;
+    std::thread writer_;
+    bool connected_ = false;
+
+    std::unordered_map<MessageKey, Subscription> subscriptions_;
+    std::mutex mutex_;
+
+    // Requests waiting for the writer thread. It's locked after mutex_ when both are needed.
+    std::deque<MultiplexedDequeueMessageRequest> outgoing_;
+    bool stream_closed_ = false;
+    std::condition_variable outgoing_ready_;
+    std::mutex outgoing_mutex_;
+};
+
+/**
+ * @brief The MessageQueueMultiplexerPool class Keeps one multiplexer per message queue node so
+ * that all the subscriptions to a node share a single channel and stream.
+ */
+class MessageQueueMultiplexerPool {
+  public:
+    MessageQueueMultiplexerPool() = default;
+    MessageQueueMultiplexerPool(MessageQueueMultiplexerPool const &) = delete;
+    ~MessageQueueMultiplexerPool() = default;
+
+    /**
+     * @brief Get Returns the multiplexer of the message queue node, creating it on first use.
+     */
+    MessageQueueMultiplexer *Get(NodeState const &node, MessageQueueServicePort const port);
+
+  private:
+    std::unordered_map<std::string, std::unique_ptr<MessageQueueMultiplexer>> multiplexers_;
+    std::mutex mutex_;
+};
+
+} // namespace e8
+
+#endif // MESSAGE_QUEUE_MULTIPLEXER_H
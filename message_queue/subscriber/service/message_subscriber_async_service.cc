@@ -0,0 +1,377 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <chrono>
+#include <grpcpp/alarm.h>
+#include <grpcpp/grpcpp.h>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "distributor/distributor/distribute.h"
+#include "identity/auth_key.h"
+#include "identity/extract_identity_from_metadata.h"
+#include "message_queue/common/entity.h"
+#include "message_queue/subscriber/environment/environment_context_interface.h"
+#include "message_queue/subscriber/module/message_queue_multiplexer.h"
+#include "message_queue/subscriber/service/message_subscriber_async_service.h"
+#include "proto_cc/identity.pb.h"
+#include "proto_cc/node.pb.h"
+#include "proto_cc/real_time_message.pb.h"
+#include "proto_cc/service_message_subscriber.grpc.pb.h"
+#include "proto_cc/service_message_subscriber.pb.h"
+
+namespace e8 {
+namespace {
+
+class SubscriptionCall;
+
+/**
+ * @brief The Tag struct Completion queue tag of one kind of operation of a subscription.
+ */
+struct Tag {
+    enum Event {
+        ACCEPTED,
+        WRITTEN,
+        TIMER_EXPIRED,
+        DONE,
+        FINISHED,
+    };
+
+    SubscriptionCall *call;
+    Event event;
+};
+
+/**
+ * @brief The SubscriptionCall class State of a single subscription. It's fed with the
+ * subscriber's messages by the multiplexed stream to the message queue node and writes them to
+ * the subscriber stream one at a time. A message may arrive while other operations are pending,
+ * so each kind of operation has its own tag. It deletes itself once none of its operations is
+ * pending and it's no longer subscribed.
+ */
+class SubscriptionCall : public MessageSinkInterface {
+  public:
+    SubscriptionCall(MessageSubscriberAsyncServiceImpl *service, grpc::ServerCompletionQueue *cq);
+    SubscriptionCall(SubscriptionCall const &) = delete;
+    ~SubscriptionCall() override = default;
+
+    /**
+     * @brief Proceed Advances the subscription upon the completion of an operation.
+     *
+     * @param ok Whether the operation succeeded.
+     */
+    void Proceed(Tag::Event event, bool ok);
+
+    bool Deliver(RealTimeMessage const &message) override;
+
+    void Close() override;
+
+  private:
+    void Start();
+    void Unsubscribe();
+    void SetTimerLocked(std::chrono::system_clock::time_point deadline);
+    bool BeginFinishLocked(grpc::Status const &status);
+    bool WrapUpLocked();
+
+    MessageSubscriberAsyncServiceImpl *service_;
+    grpc::ServerCompletionQueue *cq_;
+
+    grpc::ServerContext context_;
+    SubscribeRealTimeMessageQueueRequest request_;
+    grpc::ServerAsyncWriter<SubscribeRealTimeMessageQueueResponse> writer_;
+    grpc::Alarm timer_;
+
+    Tag accepted_tag_;
+    Tag written_tag_;
+    Tag timer_expired_tag_;
+    Tag done_tag_;
+    Tag finished_tag_;
+
+    MessageKey user_id_ = 0;
+    MessageQueueMultiplexer *multiplexer_ = nullptr;
+
+    // The done notification and the start-up are pending from the moment the call is accepted.
+    unsigned num_pending_ops_ = 2;
+    bool subscribed_ = false;
+    bool writing_ = false;
+    bool timer_set_ = false;
+    bool finishing_ = false;
+    bool finish_started_ = false;
+    grpc::Status status_;
+    std::chrono::system_clock::time_point last_activity_;
+    std::mutex mutex_;
+};
+
+SubscriptionCall::SubscriptionCall(MessageSubscriberAsyncServiceImpl *service,
+                                   grpc::ServerCompletionQueue *cq)
+    : service_(service), cq_(cq), writer_(&context_), accepted_tag_{this, Tag::ACCEPTED},
+      written_tag_{this, Tag::WRITTEN}, timer_expired_tag_{this, Tag::TIMER_EXPIRED},
+      done_tag_{this, Tag::DONE}, finished_tag_{this, Tag::FINISHED} {
+    context_.AsyncNotifyWhenDone(&done_tag_);
+    service_->RequestSubscribeRealTimeMessageQueue(&context_, &request_, &writer_, cq_, cq_,
+                                                   &accepted_tag_);
+}
+
+void SubscriptionCall::Proceed(Tag::Event event, bool ok) {
+    if (event == Tag::ACCEPTED) {
+        if (!ok) {
+            // The server is shutting down.
+            delete this;
+            return;
+        }
+
+        // Keeps accepting new subscriptions.
+        new SubscriptionCall(service_, cq_);
+
+        this->Start();
+        return;
+    }
+
+    bool unsubscribe = false;
+    bool acknowledge = false;
+
+    mutex_.lock();
+    --num_pending_ops_;
+
+    switch (event) {
+    case Tag::WRITTEN: {
+        writing_ = false;
+        acknowledge = true;
+        last_activity_ = std::chrono::system_clock::now();
+        if (!ok) {
+            unsubscribe = this->BeginFinishLocked(grpc::Status::OK);
+        }
+        break;
+    }
+    case Tag::TIMER_EXPIRED: {
+        timer_set_ = false;
+        if (!ok || finishing_) {
+            // Cancelled.
+            break;
+        }
+
+        std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
+        std::chrono::system_clock::time_point deadline =
+            last_activity_ + std::chrono::seconds(request_.wait_duration_secs());
+        if (writing_) {
+            this->SetTimerLocked(now + std::chrono::seconds(request_.wait_duration_secs()));
+        } else if (now < deadline) {
+            this->SetTimerLocked(deadline);
+        } else {
+            unsubscribe = this->BeginFinishLocked(grpc::Status::OK);
+        }
+        break;
+    }
+    case Tag::DONE: {
+        unsubscribe = this->BeginFinishLocked(grpc::Status::CANCELLED);
+        break;
+    }
+    case Tag::FINISHED: {
+        break;
+    }
+    case Tag::ACCEPTED: {
+        assert(false);
+        break;
+    }
+    }
+
+    bool completed = this->WrapUpLocked();
+    MessageKey user_id = user_id_;
+    MessageQueueMultiplexer *multiplexer = multiplexer_;
+    mutex_.unlock();
+
+    if (acknowledge) {
+        multiplexer->Acknowledge(user_id, this, ok);
+    }
+    if (unsubscribe) {
+        this->Unsubscribe();
+        return;
+    }
+    if (completed) {
+        delete this;
+    }
+}
+
+bool SubscriptionCall::Deliver(RealTimeMessage const &message) {
+    mutex_.lock();
+    if (finishing_ || writing_) {
+        mutex_.unlock();
+        return false;
+    }
+
+    SubscribeRealTimeMessageQueueResponse response;
+    *response.mutable_message() = message;
+
+    writing_ = true;
+    ++num_pending_ops_;
+    last_activity_ = std::chrono::system_clock::now();
+    writer_.Write(response, &written_tag_);
+
+    mutex_.unlock();
+    return true;
+}
+
+void SubscriptionCall::Close() {
+    // The thread which unsubscribes is responsible for the clean-up, so it never completes the
+    // subscription here.
+    mutex_.lock();
+    subscribed_ = false;
+    this->BeginFinishLocked(
+        grpc::Status(grpc::StatusCode::UNAVAILABLE, "Lost the message queue node."));
+    this->WrapUpLocked();
+    mutex_.unlock();
+}
+
+void SubscriptionCall::Start() {
+    grpc::Status status;
+    std::optional<Identity> identity = ExtractIdentityFromContext(
+        context_, kDemoWebUserAuthorizationKey, SubscriberEnvironment()->KeyGen(), &status);
+
+    std::optional<NodeState> node;
+    if (identity.has_value()) {
+        node = SubscriberEnvironment()->Distributor()->Distribute(
+            std::to_string(identity->user_id()), NDF_MESSAGE_QUEUE,
+            SubscriberEnvironment()->NodeStateStorage());
+        if (!node.has_value()) {
+            status = grpc::Status(grpc::StatusCode::UNAVAILABLE,
+                                  "No node is available for subscription.");
+        }
+    }
+
+    bool subscribed = false;
+    if (node.has_value()) {
+        mutex_.lock();
+        user_id_ = identity->user_id();
+        multiplexer_ = SubscriberEnvironment()->MessageQueueMultiplexers()->Get(
+            *node, SubscriberEnvironment()->GetMessageQueueServicePort());
+        last_activity_ = std::chrono::system_clock::now();
+        mutex_.unlock();
+
+        subscribed = multiplexer_->Subscribe(user_id_, this);
+        if (!subscribed) {
+            status = grpc::Status(grpc::StatusCode::UNAVAILABLE,
+                                  "The message queue node is unavailable.");
+        }
+    }
+
+    mutex_.lock();
+    --num_pending_ops_;
+
+    bool unsubscribe = false;
+    if (subscribed) {
+        subscribed_ = true;
+        if (finishing_) {
+            // The subscriber has gone away in the meantime.
+            unsubscribe = true;
+        } else if (request_.wait_duration_secs() > 0) {
+            this->SetTimerLocked(last_activity_ +
+                                 std::chrono::seconds(request_.wait_duration_secs()));
+        }
+    } else {
+        this->BeginFinishLocked(status);
+    }
+
+    bool completed = this->WrapUpLocked();
+    mutex_.unlock();
+
+    if (unsubscribe) {
+        this->Unsubscribe();
+        return;
+    }
+    if (completed) {
+        delete this;
+    }
+}
+
+void SubscriptionCall::Unsubscribe() {
+    multiplexer_->Unsubscribe(user_id_, this);
+
+    mutex_.lock();
+    subscribed_ = false;
+    bool completed = this->WrapUpLocked();
+    mutex_.unlock();
+
+    if (completed) {
+        delete this;
+    }
+}
+
+void SubscriptionCall::SetTimerLocked(std::chrono::system_clock::time_point deadline) {
+    timer_set_ = true;
+    ++num_pending_ops_;
+    timer_.Set(cq_, deadline, &timer_expired_tag_);
+}
+
+bool SubscriptionCall::BeginFinishLocked(grpc::Status const &status) {
+    if (finishing_) {
+        return false;
+    }
+    finishing_ = true;
+    status_ = status;
+
+    if (timer_set_) {
+        timer_.Cancel();
+    }
+
+    // The caller has to unsubscribe.
+    return subscribed_;
+}
+
+bool SubscriptionCall::WrapUpLocked() {
+    if (finishing_ && !writing_ && !finish_started_) {
+        finish_started_ = true;
+        ++num_pending_ops_;
+        writer_.Finish(status_, &finished_tag_);
+    }
+    return finish_started_ && num_pending_ops_ == 0 && !subscribed_;
+}
+
+void PollCompletionQueue(grpc::ServerCompletionQueue *cq) {
+    void *tag;
+    bool ok;
+    while (cq->Next(&tag, &ok)) {
+        Tag *call_tag = static_cast<Tag *>(tag);
+        call_tag->call->Proceed(call_tag->event, ok);
+    }
+}
+
+} // namespace
+MessageSubscriberAsyncServiceImpl::~MessageSubscriberAsyncServiceImpl() { this->Wait(); }
+
+void MessageSubscriberAsyncServiceImpl::Serve(std::vector<grpc::ServerCompletionQueue *> const &cqs,
+                                              unsigned num_threads_per_queue) {
+    assert(num_threads_per_queue > 0);
+
+    for (grpc::ServerCompletionQueue *cq : cqs) {
+        new SubscriptionCall(this, cq);
+        for (unsigned i = 0; i < num_threads_per_queue; ++i) {
+            pollers_.emplace_back(PollCompletionQueue, cq);
+        }
+    }
+}
+
+void MessageSubscriberAsyncServiceImpl::Wait() {
+    for (std::thread &poller : pollers_) {
+        poller.join();
+    }
+    pollers_.clear();
+}
+
+} // namespace e8
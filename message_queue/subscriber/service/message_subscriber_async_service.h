@@ -0,0 +1,65 @@
+/**
+ * e8yes demo web.
+ *
+ * <p>Copyright (C) 2020 Chifeng Wen {daviesx66@gmail.com}
+ *
+ * <p>This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * <p>This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * <p>You should have received a copy of the GNU General Public License along with this program. If
+ * not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MESSAGE_SUBSCRIBER_ASYNC_SERVICE_H
+#define MESSAGE_SUBSCRIBER_ASYNC_SERVICE_H
+
+#include <grpcpp/grpcpp.h>
+#include <thread>
+#include <vector>
+
+#include "proto_cc/service_message_subscriber.grpc.pb.h"
+#include "proto_cc/service_message_subscriber.pb.h"
+
+namespace e8 {
+
+/**
+ * @brief The MessageSubscriberAsyncServiceImpl class Completion queue based counterpart of the
+ * MessageSubscriberServiceImpl. The subscriber streams are driven by completion queue events and
+ * fed by the multiplexed streams to the message queue nodes, so a subscription holds neither a
+ * thread nor a connection of its own while it waits for real-time messages. Any number of idle
+ * subscribers can then be served by a small, fixed set of polling threads.
+ */
+class MessageSubscriberAsyncServiceImpl
+    : public MessageSubscriberService::WithAsyncMethod_SubscribeRealTimeMessageQueue<
+          MessageSubscriberService::Service> {
+  public:
+    MessageSubscriberAsyncServiceImpl() = default;
+    MessageSubscriberAsyncServiceImpl(MessageSubscriberAsyncServiceImpl const &) = delete;
+    ~MessageSubscriberAsyncServiceImpl() override;
+
+    /**
+     * @brief Serve Starts accepting subscriptions from the completion queues. Each completion
+     * queue is polled by num_threads_per_queue threads. It must be called after the server which
+     * the service and the completion queues are registered to has been started.
+     */
+    void Serve(std::vector<grpc::ServerCompletionQueue *> const &cqs,
+               unsigned num_threads_per_queue);
+
+    /**
+     * @brief Wait Blocks until all the completion queues have been shut down and drained. The
+     * server has to be shut down before the completion queues.
+     */
+    void Wait();
+
+  private:
+    std::vector<std::thread> pollers_;
+};
+
+} // namespace e8
+
+#endif // MESSAGE_SUBSCRIBER_ASYNC_SERVICE_H
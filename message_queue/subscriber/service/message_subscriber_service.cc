@@ -15,28 +15,107 @@
  * not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <grpcpp/grpcpp.h>
-#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 
 #include "distributor/distributor/distribute.h"
-#include "distributor/distributor/grpc_stub.h"
 #include "identity/auth_key.h"
 #include "identity/extract_identity_from_metadata.h"
 #include "identity/trustable_identity.h"
 #include "message_queue/subscriber/environment/environment_context_interface.h"
+#include "message_queue/subscriber/module/message_queue_multiplexer.h"
 #include "message_queue/subscriber/service/message_subscriber_service.h"
 #include "proto_cc/identity.pb.h"
 #include "proto_cc/node.pb.h"
-#include "proto_cc/service_message_queue.grpc.pb.h"
-#include "proto_cc/service_message_queue.pb.h"
+#include "proto_cc/real_time_message.pb.h"
 #include "proto_cc/service_message_subscriber.grpc.pb.h"
 #include "proto_cc/service_message_subscriber.pb.h"
 
 namespace e8 {
+namespace {
+
+// How often a waiting subscription checks whether the client has gone away.
+std::chrono::seconds const kCancellationCheckInterval(1);
+
+/**
+ * @brief The BlockingMessageSink class Hands the messages over to a thread which waits for them.
+ */
+class BlockingMessageSink : public MessageSinkInterface {
+  public:
+    BlockingMessageSink() = default;
+    ~BlockingMessageSink() override = default;
+
+    bool Deliver(RealTimeMessage const &message) override;
+    void Close() override;
+
+    /**
+     * @brief Wait Waits for the next message.
+     *
+     * @param wait_duration_secs The number of seconds to wait for. It waits indefinitely if it's
+     * not positive.
+     * @return The message if it arrives before the wait is over, the sink is closed or the client
+     * cancels the call. Otherwise, nullopt.
+     */
+    std::optional<RealTimeMessage> Wait(int wait_duration_secs, grpc::ServerContext *context);
+
+  private:
+    std::optional<RealTimeMessage> message_;
+    bool closed_ = false;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+};
+
+bool BlockingMessageSink::Deliver(RealTimeMessage const &message) {
+    mutex_.lock();
+    if (closed_ || message_.has_value()) {
+        mutex_.unlock();
+        return false;
+    }
+    message_ = message;
+    mutex_.unlock();
+
+    cv_.notify_one();
+    return true;
+}
+
+void BlockingMessageSink::Close() {
+    mutex_.lock();
+    closed_ = true;
+    mutex_.unlock();
+
+    cv_.notify_one();
+}
+
+std::optional<RealTimeMessage> BlockingMessageSink::Wait(int wait_duration_secs,
+                                                         grpc::ServerContext *context) {
+    std::chrono::steady_clock::time_point deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(wait_duration_secs);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!message_.has_value() && !closed_ && !context->IsCancelled()) {
+        std::chrono::steady_clock::time_point wake_up =
+            std::chrono::steady_clock::now() + kCancellationCheckInterval;
+        if (wait_duration_secs > 0) {
+            if (std::chrono::steady_clock::now() >= deadline) {
+                break;
+            }
+            wake_up = std::min(wake_up, deadline);
+        }
+        cv_.wait_until(lock, wake_up);
+    }
+
+    std::optional<RealTimeMessage> message = message_;
+    message_.reset();
+    return message;
+}
+
+} // namespace
 
-// TODO: Make this function testable.
 grpc::Status MessageSubscriberServiceImpl::SubscribeRealTimeMessageQueue(
     grpc::ServerContext *context, SubscribeRealTimeMessageQueueRequest const *request,
     grpc::ServerWriter<SubscribeRealTimeMessageQueueResponse> *writer) {
@@ -55,32 +134,28 @@ grpc::Status MessageSubscriberServiceImpl::SubscribeRealTimeMessageQueue(
                             "No node is available for subscription.");
     }
 
-    std::unique_ptr<MessageQueueService::Stub> stub = CREATE_GRPC_STUB(
-        MessageQueueService, *node, SubscriberEnvironment()->GetMessageQueueServicePort());
-
-    grpc::ClientContext client_context;
-
-    std::unique_ptr<grpc::ClientReaderWriter<DequeueMessageRequest, DequeueMessageResponse>>
-        stream = stub->DequeueMessage(&client_context);
+    MessageQueueMultiplexer *multiplexer = SubscriberEnvironment()->MessageQueueMultiplexers()->Get(
+        *node, SubscriberEnvironment()->GetMessageQueueServicePort());
 
-    DequeueMessageRequest dequeue_request;
-    dequeue_request.set_user_id(identity->user_id());
-    dequeue_request.set_wait_duration_secs(request->wait_duration_secs());
-    dequeue_request.set_previous_message_delivered(false);
-    dequeue_request.set_end_operation(false);
+    BlockingMessageSink sink;
+    if (!multiplexer->Subscribe(identity->user_id(), &sink)) {
+        return grpc::Status(grpc::StatusCode::UNAVAILABLE,
+                            "The message queue node is unavailable.");
+    }
 
-    DequeueMessageResponse dequeue_response;
-    while (stream->Write(dequeue_request) && stream->Read(&dequeue_response)) {
+    std::optional<RealTimeMessage> message;
+    while ((message = sink.Wait(request->wait_duration_secs(), context)).has_value()) {
         SubscribeRealTimeMessageQueueResponse subscriber_response;
-        *subscriber_response.mutable_message() = dequeue_response.message();
-        if (writer->Write(subscriber_response)) {
-            dequeue_request.set_previous_message_delivered(true);
-        } else {
-            dequeue_request.set_previous_message_delivered(false);
-            dequeue_request.set_end_operation(true);
+        *subscriber_response.mutable_message() = *message;
+        bool delivered = writer->Write(subscriber_response);
+        multiplexer->Acknowledge(identity->user_id(), &sink, delivered);
+        if (!delivered) {
+            break;
         }
     }
 
+    multiplexer->Unsubscribe(identity->user_id(), &sink);
+
     return grpc::Status::OK;
 }
 
@@ -19,11 +19,15 @@ SOURCES += \
     environment/environment_context_interface.cc \
     environment/prod_environment_context.cc \
     environment/test_environment_context.cc \
+    module/message_queue_multiplexer.cc \
+    service/message_subscriber_async_service.cc \
     service/message_subscriber_service.cc
 HEADERS += \
     environment/environment_context_interface.h \
     environment/prod_environment_context.h \
     environment/test_environment_context.h \
+    module/message_queue_multiplexer.h \
+    service/message_subscriber_async_service.h \
     service/message_subscriber_service.h
 
 # Default rules for deployment.
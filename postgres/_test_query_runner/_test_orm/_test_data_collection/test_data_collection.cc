@@ -19,6 +19,7 @@
 #include <optional>
 #include <string>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 #include "common/unit_test_util/unit_test_util.h"
@@ -111,9 +112,70 @@ bool ToEntityTupleTest() {
     return true;
 }
 
+bool ToGroupedEntityTuplesTest() {
+    e8::MockResultSet rs(/*num_cells=*/2 + 3);
+    rs.AddRecord(e8::MockResultSet::Record{// User record.
+                                           std::make_shared<e8::SqlInt>(1, "id"),
+                                           std::make_shared<e8::SqlStr>("user1", "user_name"),
+                                           // Credit card record.
+                                           nullptr, nullptr, nullptr});
+    rs.AddRecord(e8::MockResultSet::Record{
+        // User record.
+        std::make_shared<e8::SqlInt>(2, "id"),
+        std::make_shared<e8::SqlStr>("user2", "user_name"),
+        // Credit card record.
+        std::make_shared<e8::SqlInt>(101, "id"),
+        std::make_shared<e8::SqlInt>(2, "user_id"),
+        std::make_shared<e8::SqlStr>("1010101002", "card_number"),
+    });
+    rs.AddRecord(e8::MockResultSet::Record{
+        // User record.
+        std::make_shared<e8::SqlInt>(2, "id"),
+        std::make_shared<e8::SqlStr>("user2", "user_name"),
+        // Credit card record.
+        std::make_shared<e8::SqlInt>(102, "id"),
+        std::make_shared<e8::SqlInt>(2, "user_id"),
+        nullptr,
+    });
+    rs.AddRecord(e8::MockResultSet::Record{
+        // User record.
+        std::make_shared<e8::SqlInt>(3, "id"),
+        std::make_shared<e8::SqlStr>("user3", "user_name"),
+        // Credit card record.
+        std::make_shared<e8::SqlInt>(103, "id"),
+        std::make_shared<e8::SqlInt>(3, "user_id"),
+        std::make_shared<e8::SqlStr>("1010101003", "card_number"),
+    });
+
+    std::vector<std::pair<std::tuple<User>, std::vector<std::tuple<CreditCard>>>> results =
+        e8::ToGroupedEntityTuples<std::tuple<User>, std::tuple<CreditCard>>(&rs);
+
+    TEST_CONDITION(results.size() == 3);
+
+    TEST_CONDITION(std::get<0>(results[0].first).id.Value() == std::optional<int32_t>(1));
+    TEST_CONDITION(results[0].second.empty());
+
+    TEST_CONDITION(std::get<0>(results[1].first).id.Value() == std::optional<int32_t>(2));
+    TEST_CONDITION(std::get<0>(results[1].first).user_name.Value() ==
+                   std::optional<std::string>("user2"));
+    TEST_CONDITION(results[1].second.size() == 2);
+    TEST_CONDITION(std::get<0>(results[1].second[0]).id.Value() == std::optional<int32_t>(101));
+    TEST_CONDITION(std::get<0>(results[1].second[0]).card_number.Value() ==
+                   std::optional<std::string>("1010101002"));
+    TEST_CONDITION(std::get<0>(results[1].second[1]).id.Value() == std::optional<int32_t>(102));
+    TEST_CONDITION(!std::get<0>(results[1].second[1]).card_number.Value().has_value());
+
+    TEST_CONDITION(std::get<0>(results[2].first).id.Value() == std::optional<int32_t>(3));
+    TEST_CONDITION(results[2].second.size() == 1);
+    TEST_CONDITION(std::get<0>(results[2].second[0]).user_id.Value() == std::optional<int32_t>(3));
+
+    return true;
+}
+
 int main() {
     e8::BeginTestSuite("data_collection");
     e8::RunTest("ToEntityTupleTest", ToEntityTupleTest);
+    e8::RunTest("ToGroupedEntityTuplesTest", ToGroupedEntityTuplesTest);
     e8::EndTestSuite();
     return 0;
 }
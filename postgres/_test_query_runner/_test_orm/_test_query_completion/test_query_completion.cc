@@ -85,11 +85,55 @@ bool GenerateUpsertQueryTest() {
     return true;
 }
 
+bool GenerateBatchInsertQueryTest() {
+    User user0;
+    *user0.id.ValuePtr() = 1;
+    *user0.user_name.ValuePtr() = "user0";
+
+    User user1;
+    *user1.id.ValuePtr() = 2;
+    *user1.user_name.ValuePtr() = "user1";
+
+    e8::InsertQueryAndParams query_and_params = e8::GenerateBatchInsertQuery(
+        /*table_name=*/"AUser", {&user0, &user1}, /*with_upsert=*/false);
+    TEST_CONDITION(query_and_params.query ==
+                   "INSERT INTO AUser(id,user_name)VALUES($1,$2),($3,$4)ON CONFLICT DO NOTHING");
+
+    TEST_CONDITION(*query_and_params.query_params.GetParam(0) == user0.id);
+    TEST_CONDITION(*query_and_params.query_params.GetParam(1) == user0.user_name);
+    TEST_CONDITION(*query_and_params.query_params.GetParam(2) == user1.id);
+    TEST_CONDITION(*query_and_params.query_params.GetParam(3) == user1.user_name);
+
+    return true;
+}
+
+bool GenerateBatchUpsertQueryTest() {
+    User user0;
+    *user0.id.ValuePtr() = 1;
+    *user0.user_name.ValuePtr() = "user0";
+
+    User user1;
+    *user1.id.ValuePtr() = 2;
+    *user1.user_name.ValuePtr() = "user1";
+
+    e8::InsertQueryAndParams query_and_params = e8::GenerateBatchInsertQuery(
+        /*table_name=*/"AUser", {&user0, &user1}, /*with_upsert=*/true);
+    TEST_CONDITION(query_and_params.query ==
+                   "INSERT INTO AUser(id,user_name)VALUES($1,$2),($3,$4)ON CONFLICT ON "
+                   "CONSTRAINT AUser_pkey DO UPDATE SET "
+                   "id=EXCLUDED.id,user_name=EXCLUDED.user_name");
+    TEST_CONDITION(query_and_params.query_params.NumSlots() == 4);
+
+    return true;
+}
+
 int main() {
     e8::BeginTestSuite("query_completion");
     e8::RunTest("SelectQueryCompletionTest", SelectQueryCompletionTest);
     e8::RunTest("GenerateInsertQueryTest", GenerateInsertQueryTest);
     e8::RunTest("GenerateUpsertQueryTest", GenerateUpsertQueryTest);
+    e8::RunTest("GenerateBatchInsertQueryTest", GenerateBatchInsertQueryTest);
+    e8::RunTest("GenerateBatchUpsertQueryTest", GenerateBatchUpsertQueryTest);
     e8::EndTestSuite();
     return 0;
 }
@@ -16,6 +16,8 @@
  */
 
 #include <cstdint>
+#include <memory>
+#include <optional>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -222,11 +224,146 @@ bool InsertThenExistsTest() {
     return true;
 }
 
+bool InsertThenCountTest() {
+    e8::ConnectionFactory factory = CreateConnectionFactory();
+    e8::BasicConnectionReservoir reservoir(factory);
+    e8::ConnectionInterface *conn = reservoir.Take();
+
+    // Prepare schema.
+    DropSchema(conn);
+    CreateSchema(conn);
+
+    // Prepare test data.
+    for (int32_t i = 1; i <= 3; ++i) {
+        User user;
+        *user.id.ValuePtr() = i;
+        *user.user_name.ValuePtr() = "user" + std::to_string(i);
+        uint64_t num_rows_affected = e8::Update(user,
+                                                /*tableName=*/"QueryRunnerTestUser",
+                                                /*replace=*/true, &reservoir);
+        TEST_CONDITION(num_rows_affected == 1);
+    }
+
+    // Run "count" query.
+    TEST_CONDITION(e8::Count(e8::SqlQueryBuilder().QueryPiece("QueryRunnerTestUser"),
+                             &reservoir) == 3);
+    TEST_CONDITION(e8::Count(e8::SqlQueryBuilder().QueryPiece("QueryRunnerTestUser WHERE id>1"),
+                             &reservoir) == 2);
+    TEST_CONDITION(e8::Count(e8::SqlQueryBuilder().QueryPiece("QueryRunnerTestUser WHERE id>3"),
+                             &reservoir) == 0);
+
+    // Clean up.
+    DropSchema(conn);
+    reservoir.Put(conn);
+
+    return true;
+}
+
+bool BatchInsertThenCountTest() {
+    e8::ConnectionFactory factory = CreateConnectionFactory();
+    e8::BasicConnectionReservoir reservoir(factory);
+    e8::ConnectionInterface *conn = reservoir.Take();
+
+    // Prepare schema.
+    DropSchema(conn);
+    CreateSchema(conn);
+
+    // Insert more users than a single statement can hold.
+    std::vector<User> users(40000);
+    std::vector<e8::SqlEntityInterface const *> entities;
+    for (int32_t i = 0; i < static_cast<int32_t>(users.size()); ++i) {
+        *users[i].id.ValuePtr() = i + 1;
+        *users[i].user_name.ValuePtr() = "user" + std::to_string(i + 1);
+        entities.push_back(&users[i]);
+    }
+    uint64_t num_rows_affected = e8::UpdateBatch(entities,
+                                                 /*table_name=*/"QueryRunnerTestUser",
+                                                 /*replace=*/false, &reservoir);
+    TEST_CONDITION(num_rows_affected == users.size());
+    TEST_CONDITION(e8::Count(e8::SqlQueryBuilder().QueryPiece("QueryRunnerTestUser"),
+                             &reservoir) == users.size());
+
+    // Upsert existing users.
+    *users[0].user_name.ValuePtr() = "renamed";
+    num_rows_affected = e8::UpdateBatch({&users[0], &users[1]},
+                                        /*table_name=*/"QueryRunnerTestUser",
+                                        /*replace=*/true, &reservoir);
+    TEST_CONDITION(num_rows_affected == 2);
+    e8::SqlQueryBuilder renamed_users;
+    renamed_users.QueryPiece("QueryRunnerTestUser WHERE user_name='renamed'");
+    TEST_CONDITION(e8::Count(renamed_users, &reservoir) == 1);
+
+    // Clean up.
+    DropSchema(conn);
+    reservoir.Put(conn);
+
+    return true;
+}
+
+bool InsertWithClauseThenQueryTest() {
+    e8::ConnectionFactory factory = CreateConnectionFactory();
+    e8::BasicConnectionReservoir reservoir(factory);
+    e8::ConnectionInterface *conn = reservoir.Take();
+
+    // Prepare schema.
+    DropSchema(conn);
+    CreateSchema(conn);
+
+    User user;
+    *user.id.ValuePtr() = 1;
+    *user.user_name.ValuePtr() = "user0";
+    uint64_t num_rows_affected = e8::Update(user,
+                                            /*tableName=*/"QueryRunnerTestUser",
+                                            /*replace=*/true, &reservoir);
+    TEST_CONDITION(num_rows_affected == 1);
+
+    // Insert a card and read it back along with its owner in one statement.
+    e8::SqlQueryBuilder query;
+    e8::SqlQueryBuilder::Placeholder<e8::SqlInt> card_id_ph;
+    e8::SqlQueryBuilder::Placeholder<e8::SqlInt> user_id_ph;
+    e8::SqlQueryBuilder::Placeholder<e8::SqlStr> card_number_ph;
+    query.QueryPiece("WITH new_card AS (INSERT INTO QueryRunnerTestCard(id,user_id,card_number)")
+        .QueryPiece("VALUES(")
+        .Holder(&card_id_ph)
+        .QueryPiece(",")
+        .Holder(&user_id_ph)
+        .QueryPiece(",")
+        .Holder(&card_number_ph)
+        .QueryPiece(")RETURNING *) ")
+        .EndWithClause()
+        .QueryPiece("new_card card JOIN QueryRunnerTestUser u ON u.id=card.user_id WHERE u.id=")
+        .Holder(&user_id_ph);
+
+    query.SetValueToPlaceholder(card_id_ph, std::make_shared<e8::SqlInt>(10));
+    query.SetValueToPlaceholder(user_id_ph, std::make_shared<e8::SqlInt>(1));
+    query.SetValueToPlaceholder(card_number_ph, std::make_shared<e8::SqlStr>("1234"));
+
+    std::vector<std::tuple<User, CreditCard>> results =
+        e8::Query<User, CreditCard>(query, {"u", "card"}, &reservoir);
+
+    TEST_CONDITION(results.size() == 1);
+    TEST_CONDITION(std::get<0>(results[0]).user_name.Value() == std::optional<std::string>("user0"));
+    TEST_CONDITION(*std::get<1>(results[0]).id.Value() == 10);
+    TEST_CONDITION(std::get<1>(results[0]).card_number.Value() == std::optional<std::string>("1234"));
+
+    TEST_CONDITION(e8::Count(e8::SqlQueryBuilder().QueryPiece("QueryRunnerTestCard"),
+                             &reservoir) == 1);
+
+    // Clean up.
+    DropSchema(conn);
+    reservoir.Put(conn);
+
+    return true;
+}
+
 int main() {
     e8::BeginTestSuite("sql_runner");
     e8::RunTest("InsertThenQueryTest", InsertThenQueryTest);
     e8::RunTest("InsertThenDeleteTest", InsertThenDeleteTest);
     e8::RunTest("InsertThenExistsTest", InsertThenExistsTest);
+    e8::RunTest("InsertThenCountTest", InsertThenCountTest);
+    e8::RunTest("BatchInsertThenCountTest", BatchInsertThenCountTest);
+    e8::RunTest("InsertWithClauseThenQueryTest", InsertWithClauseThenQueryTest);
     e8::EndTestSuite();
     return 0;
 }
@@ -20,6 +20,7 @@
 #include <optional>
 #include <pqxx/pqxx>
 
+#include "common/container/eviction_policy.h"
 #include "common/container/lru_hash_map.h"
 #include "postgres/query_runner/connection/connection_interface.h"
 #include "postgres/query_runner/connection/pq_connection.h"
@@ -80,7 +81,12 @@ class PqConnection::PqConnectionImpl {
                                                  OnEvict(this->conn.get())) {}
 
     std::unique_ptr<pqxx::connection> const conn;
-    LruHashMap<ParameterizedQuery, StatementId, OnFetch, OnEvict> statement_cache;
+
+    // One-off queries, e.g. the ones with a varying number of array parameters, shouldn't push the
+    // frequently run statements out of the cache.
+    LruHashMap<ParameterizedQuery, StatementId, OnFetch, OnEvict,
+               WTinyLfuEvictionPolicy<ParameterizedQuery>>
+        statement_cache;
 };
 
 PqConnection::PqConnection(std::string const &host_name, std::string const &db_name)
@@ -19,6 +19,7 @@
 #define DATA_COLLECTION_H
 
 #include <tuple>
+#include <utility>
 #include <vector>
 
 #include "postgres/query_runner/reflection/sql_entity_interface.h"
@@ -44,6 +45,31 @@ void SetRecordsToEntities(ResultSetInterface *rs, unsigned *base_record_idx, Ent
     SetRecordsToEntities(rs, base_record_idx, entity2, others...);
 }
 
+template <typename EntityTuple>
+void SetRecordsToEntityTuple(ResultSetInterface *rs, unsigned *base_record_idx,
+                             EntityTuple *entity_tuple) {
+    std::apply(
+        [rs, base_record_idx](auto &&... entities) {
+            SetRecordsToEntities(rs, base_record_idx, entities...);
+        },
+        *entity_tuple);
+}
+
+inline bool CellsAreNull(ResultSetInterface *rs, unsigned begin, unsigned end) {
+    for (unsigned i = begin; i < end; ++i) {
+        if (!rs->IsNull(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename GroupTuple> bool SameGroup(GroupTuple const &a, GroupTuple const &b) {
+    SqlPrimitiveInterface const *a_key = std::get<0>(a).Fields()[0];
+    SqlPrimitiveInterface const *b_key = std::get<0>(b).Fields()[0];
+    return *a_key == *b_key;
+}
+
 } // namespace data_collection_internal
 
 /**
@@ -69,6 +95,44 @@ std::vector<std::tuple<EntityType, Others...>> ToEntityTuples(ResultSetInterface
     return records;
 }
 
+/**
+ * @brief ToGroupedEntityTuples Similar to ToEntityTuples(), but every record is split into a
+ * leading group tuple followed by an element tuple, as produced by a one-to-many (LATERAL) join.
+ * Consecutive records whose leading entity has the same first field, typically its primary key,
+ * are collapsed into one group that collects their elements in order. The element side is
+ * nullable: a record whose element cells are all NULL, as produced by a LEFT JOIN without a match,
+ * contributes no element, so the group is kept with an empty element list.
+ *
+ * Example usage:
+ * ToGroupedEntityTuples<std::tuple<User>, std::tuple<CreditCard>>(rs);
+ *
+ * @param rs Result set ordered such that the records of a group are adjacent.
+ * @return A list of (group tuple, element tuples) pairs in the order the groups appear.
+ */
+template <typename GroupTuple, typename ElementTuple>
+std::vector<std::pair<GroupTuple, std::vector<ElementTuple>>>
+ToGroupedEntityTuples(ResultSetInterface *rs) {
+    std::vector<std::pair<GroupTuple, std::vector<ElementTuple>>> groups;
+    for (; rs->HasNext(); rs->Next()) {
+        GroupTuple group_tuple;
+        unsigned base_record_idx = 0;
+        data_collection_internal::SetRecordsToEntityTuple(rs, &base_record_idx, &group_tuple);
+
+        if (groups.empty() ||
+            !data_collection_internal::SameGroup(groups.back().first, group_tuple)) {
+            groups.push_back(std::make_pair(group_tuple, std::vector<ElementTuple>()));
+        }
+
+        ElementTuple element_tuple;
+        unsigned element_begin = base_record_idx;
+        data_collection_internal::SetRecordsToEntityTuple(rs, &base_record_idx, &element_tuple);
+        if (!data_collection_internal::CellsAreNull(rs, element_begin, base_record_idx)) {
+            groups.back().second.push_back(element_tuple);
+        }
+    }
+    return groups;
+}
+
 } // namespace e8
 
 #endif // DATA_COLLECTION_H
@@ -83,6 +83,50 @@ ConnectionInterface::QueryParams ConstructQueryParams(SqlEntityInterface const &
     return params;
 }
 
+std::string ConstructBatchInsertQuery(std::string const &table_name, unsigned num_entities,
+                                      SqlEntityInterface const &entity, bool with_upsert) {
+    std::vector<SqlPrimitiveInterface *> const &fields = entity.Fields();
+    assert(!fields.empty());
+    assert(num_entities > 0);
+
+    std::string query = "INSERT INTO ";
+    query += table_name;
+    query += "(";
+    query += fields[0]->FieldName();
+    for (unsigned i = 1; i < fields.size(); i++) {
+        query += ',';
+        query += fields[i]->FieldName();
+    }
+    query += ")VALUES";
+
+    unsigned slot = 1;
+    for (unsigned k = 0; k < num_entities; k++) {
+        if (k > 0) {
+            query += ',';
+        }
+        query += "($" + std::to_string(slot++);
+        for (unsigned i = 1; i < fields.size(); i++) {
+            query += ",$" + std::to_string(slot++);
+        }
+        query += ')';
+    }
+
+    if (with_upsert) {
+        // Update records on primary key conflict with the values proposed for insertion.
+        query += "ON CONFLICT ON CONSTRAINT ";
+        query += table_name + "_pkey DO UPDATE SET ";
+        query += fields[0]->FieldName() + "=EXCLUDED." + fields[0]->FieldName();
+        for (unsigned i = 1; i < fields.size(); i++) {
+            query += ',';
+            query += fields[i]->FieldName() + "=EXCLUDED." + fields[i]->FieldName();
+        }
+    } else {
+        query += "ON CONFLICT DO NOTHING";
+    }
+
+    return query;
+}
+
 } // namespace
 
 InsertQueryAndParams GenerateInsertQuery(std::string const &table_name,
@@ -94,4 +138,25 @@ InsertQueryAndParams GenerateInsertQuery(std::string const &table_name,
     return query_and_params;
 }
 
+InsertQueryAndParams
+GenerateBatchInsertQuery(std::string const &table_name,
+                         std::vector<SqlEntityInterface const *> const &entities,
+                         bool with_upsert) {
+    assert(!entities.empty());
+
+    InsertQueryAndParams query_and_params;
+    query_and_params.query =
+        ConstructBatchInsertQuery(table_name, entities.size(), *entities[0], with_upsert);
+
+    unsigned slot = 0;
+    for (SqlEntityInterface const *entity : entities) {
+        assert(entity->Fields().size() == entities[0]->Fields().size());
+        for (SqlPrimitiveInterface const *field : entity->Fields()) {
+            query_and_params.query_params.SetParamPtr(slot++, field);
+        }
+    }
+
+    return query_and_params;
+}
+
 } // namespace e8
@@ -21,6 +21,7 @@
 #include <cassert>
 #include <initializer_list>
 #include <string>
+#include <vector>
 
 #include "postgres/query_runner/connection/connection_interface.h"
 #include "postgres/query_runner/reflection/sql_entity_interface.h"
@@ -112,6 +113,21 @@ struct InsertQueryAndParams {
 InsertQueryAndParams GenerateInsertQuery(std::string const &table_name,
                                          SqlEntityInterface const &entity, bool with_upsert);
 
+/**
+ * @brief GenerateBatchInsertQuery Similar to the above function, but it constructs one multi-row
+ * insertion query for all the entities, which must be of the same type. The query parameters
+ * refer to the entities' fields, so the entities have to outlive the query.
+ *
+ * @param table_name Name of the table the entities are going to insert to.
+ * @param entities The non-empty list of entities to be inserted.
+ * @param with_upsert Whether or not to generate a query that will update the entity records if
+ * they exist.
+ * @return The insertion query and its parameters.
+ */
+InsertQueryAndParams
+GenerateBatchInsertQuery(std::string const &table_name,
+                         std::vector<SqlEntityInterface const *> const &entities, bool with_upsert);
+
 } // namespace e8
 
 #endif // QUERY_COMPLETION_H
@@ -29,4 +29,9 @@ void MockResultSet::SetField(unsigned i, SqlPrimitiveInterface *field) {
     *field = *cell;
 }
 
+bool MockResultSet::IsNull(unsigned i) const {
+    assert(i < num_cells_);
+    return records_[cur_record_][i] == nullptr;
+}
+
 } // namespace e8
@@ -35,6 +35,7 @@ class MockResultSet : public ResultSetInterface {
     void Next() override;
     bool HasNext() const override;
     void SetField(unsigned i, SqlPrimitiveInterface *field) override;
+    bool IsNull(unsigned i) const override;
 
   private:
     std::vector<Record> records_;
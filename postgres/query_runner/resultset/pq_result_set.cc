@@ -33,4 +33,6 @@ void PqResultSet::SetField(unsigned i, SqlPrimitiveInterface *field) {
     field->ImportFromField((*it_)[i]);
 }
 
+bool PqResultSet::IsNull(unsigned i) const { return (*it_)[i].is_null(); }
+
 } // namespace e8
@@ -39,6 +39,7 @@ class PqResultSet : public ResultSetInterface {
     void Next() override;
     bool HasNext() const override;
     void SetField(unsigned i, SqlPrimitiveInterface *field) override;
+    bool IsNull(unsigned i) const override;
 
   private:
     pqxx::result rs_;
@@ -52,6 +52,13 @@ class ResultSetInterface {
      * @param field The field to assign value to.
      */
     virtual void SetField(unsigned i, SqlPrimitiveInterface *field) = 0;
+
+    /**
+     * @brief Check if the ith cell at the current row cursor position is NULL.
+     *
+     * @param i The i-th(zero-offset) cell to check.
+     */
+    virtual bool IsNull(unsigned i) const = 0;
 };
 
 } // namespace e8
@@ -15,6 +15,7 @@
  * not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstddef>
 #include <string>
 
 #include "postgres/query_runner/sql_query_builder.h"
@@ -26,6 +27,13 @@ SqlQueryBuilder &SqlQueryBuilder::QueryPiece(std::string const &piece) {
     return *this;
 }
 
+SqlQueryBuilder &SqlQueryBuilder::EndWithClause() {
+    with_clause_length_ = query_.size();
+    return *this;
+}
+
+std::size_t SqlQueryBuilder::WithClauseLength() const { return with_clause_length_; }
+
 std::string const &SqlQueryBuilder::PsqlQuery() const { return query_; }
 
 ConnectionInterface::QueryParams const &SqlQueryBuilder::QueryParams() const { return params_; }
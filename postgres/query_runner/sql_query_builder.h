@@ -17,6 +17,7 @@
 #ifndef SQL_QUERY_BUILDER_H
 #define SQL_QUERY_BUILDER_H
 
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <vector>
@@ -87,6 +88,22 @@ class SqlQueryBuilder {
         }
     }
 
+    /**
+     * @brief EndWithClause Marks the pieces appended so far as a leading WITH clause of common
+     * table expressions. When the query is completed by Query(), the select list will be inserted
+     * right after the WITH clause rather than at the very beginning of the query. Placeholders in
+     * the WITH clause share the same parameter slots as the rest of the query.
+     *
+     * @return The current builder.
+     */
+    SqlQueryBuilder &EndWithClause();
+
+    /**
+     * @brief WithClauseLength The length of the leading WITH clause in the exported query. It's 0
+     * if there is no WITH clause.
+     */
+    std::size_t WithClauseLength() const;
+
     /**
      * @brief Export a postgres-compliant query from the previously appended pieces.
      *
@@ -103,6 +120,7 @@ class SqlQueryBuilder {
 
   private:
     std::string query_;
+    std::size_t with_clause_length_ = 0;
     ConnectionInterface::QueryParams params_;
 };
 
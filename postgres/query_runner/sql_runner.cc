@@ -15,6 +15,8 @@
  * not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <cassert>
 #include <chrono>
 #include <cstdint>
 #include <exception>
@@ -22,6 +24,7 @@
 #include <memory>
 #include <string>
 #include <unordered_set>
+#include <vector>
 
 #include "common/time_util/time_util.h"
 #include "postgres/query_runner/connection/connection_interface.h"
@@ -34,6 +37,9 @@
 namespace e8 {
 namespace sql_runner_internal {
 
+// Postgres' wire protocol allows at most this many parameters in a statement.
+unsigned const kMaxNumQueryParams = 65535;
+
 int64_t ReverseBytes(int64_t original) {
     return (original & 0xFF) << 56 | ((original >> 8) & 0xFF) << 48 |
            ((original >> 16) & 0xFF) << 40 | ((original >> 24) & 0xFF) << 32 |
@@ -71,15 +77,21 @@ void TokenizePlainTextQuery(std::string *plain_text) {
         plain_text->resize(i_writer);
     }
 }
-std::string ToSearchQuery(std::string const &target_collection, std::string const &full_text_query,
-                          bool prefix_search, bool rank_result, std::optional<unsigned> limit,
-                          std::optional<unsigned> offset,
-                          ConnectionInterface::QueryParams *query_params) {
+
+std::string ToTsQuery(std::string const &full_text_query, bool prefix_search) {
     std::string pq_ts_query = full_text_query;
     TokenizePlainTextQuery(&pq_ts_query);
     if (prefix_search && !pq_ts_query.empty()) {
         pq_ts_query += ":*";
     }
+    return pq_ts_query;
+}
+
+std::string ToSearchQuery(std::string const &target_collection, std::string const &full_text_query,
+                          bool prefix_search, bool rank_result, std::optional<unsigned> limit,
+                          std::optional<unsigned> offset,
+                          ConnectionInterface::QueryParams *query_params) {
+    std::string pq_ts_query = ToTsQuery(full_text_query, prefix_search);
 
     // TODO: Make this full text argument parameterizable.
     //    ConnectionInterface::QueryParams::SlotId full_text_slot = query_params->AllocateSlot();
@@ -120,6 +132,39 @@ uint64_t Update(SqlEntityInterface const &entity, std::string const &table_name,
     return numRowsUpdated;
 }
 
+uint64_t UpdateBatch(std::vector<SqlEntityInterface const *> const &entities,
+                     std::string const &table_name, bool replace,
+                     ConnectionReservoirInterface *reservoir) {
+    if (entities.empty()) {
+        return 0;
+    }
+
+    unsigned max_num_entities_per_statement =
+        sql_runner_internal::kMaxNumQueryParams / entities[0]->Fields().size();
+    assert(max_num_entities_per_statement > 0);
+
+    ConnectionInterface *conn = reservoir->Take();
+
+    uint64_t num_rows_updated = 0;
+    for (unsigned begin = 0; begin < entities.size(); begin += max_num_entities_per_statement) {
+        unsigned end = std::min(begin + max_num_entities_per_statement,
+                                static_cast<unsigned>(entities.size()));
+        std::vector<SqlEntityInterface const *> chunk(entities.begin() + begin,
+                                                      entities.begin() + end);
+
+        InsertQueryAndParams query_and_params =
+            GenerateBatchInsertQuery(table_name, chunk, replace);
+
+        // The statement varies with the number of entities, so it isn't worth caching.
+        num_rows_updated += conn->RunUpdate(query_and_params.query, query_and_params.query_params,
+                                            /*cache_on=*/false);
+    }
+
+    reservoir->Put(conn);
+
+    return num_rows_updated;
+}
+
 uint64_t Delete(std::string const &table_name, SqlQueryBuilder const &query,
                 ConnectionReservoirInterface *reservoir) {
     std::string completed_query = "DELETE FROM " + table_name + " " + query.PsqlQuery();
@@ -144,6 +189,23 @@ bool Exists(SqlQueryBuilder const &query, ConnectionReservoirInterface *reservoi
     return exists;
 }
 
+uint64_t Count(SqlQueryBuilder const &query, ConnectionReservoirInterface *reservoir) {
+    std::string count_query = "SELECT COUNT(*) FROM " + query.PsqlQuery();
+
+    ConnectionInterface *conn = reservoir->Take();
+
+    std::unique_ptr<ResultSetInterface> rs = conn->RunQuery(count_query, query.QueryParams());
+    assert(rs->HasNext());
+
+    SqlLong count("count");
+    rs->SetField(0, &count);
+    assert(count.Value().has_value());
+
+    reservoir->Put(conn);
+
+    return static_cast<uint64_t>(count.Value().value());
+}
+
 std::unordered_set<std::string> Tables(ConnectionReservoirInterface *reservoir) {
     ConnectionInterface *conn = reservoir->Take();
     std::string reflection_query =
@@ -25,6 +25,7 @@
 #include <string>
 #include <tuple>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "postgres/query_runner/connection/connection_interface.h"
@@ -43,6 +44,23 @@ std::string ToSearchQuery(std::string const &target_collection, std::string cons
                           std::optional<unsigned> offset,
                           ConnectionInterface::QueryParams *query_params);
 
+/**
+ * @brief ToTsQuery Converts raw text into a postgres text search query where every word has to be
+ * matched.
+ */
+std::string ToTsQuery(std::string const &full_text_query, bool prefix_search);
+
+template <typename GroupTuple, typename ElementTuple> struct GroupedSelectQuery;
+
+template <typename... GroupEntityTypes, typename... ElementEntityTypes>
+struct GroupedSelectQuery<std::tuple<GroupEntityTypes...>, std::tuple<ElementEntityTypes...>> {
+    static std::string Complete(std::string const &partial_query,
+                                std::initializer_list<std::string> const &entity_aliases) {
+        return CompleteSelectQuery<GroupEntityTypes..., ElementEntityTypes...>(partial_query,
+                                                                             entity_aliases);
+    }
+};
+
 } // namespace sql_runner_internal
 
 /**
@@ -56,7 +74,9 @@ std::string ToSearchQuery(std::string const &target_collection, std::string cons
  * "card"}, reservoir);
  *
  * @param query Partial query where the select list is unspecified. Example: "AUser auser JOIN
- * CreditCard card ON card.user_id = auser.id WHERE auser.join_date > '2020-1-1'"
+ * CreditCard card ON card.user_id = auser.id WHERE auser.join_date > '2020-1-1'". It may start
+ * with a WITH clause marked by SqlQueryBuilder::EndWithClause(), in which case the select list is
+ * inserted after it.
  * @param entity_aliases A list of aliases corresponding to the entities specified in the template
  * arguments.
  * @param reservoir Connection reservoir to allocate database connections.
@@ -67,8 +87,11 @@ template <typename EntityType, typename... Others>
 std::vector<std::tuple<EntityType, Others...>>
 Query(SqlQueryBuilder const &query, std::initializer_list<std::string> const &entity_aliases,
       ConnectionReservoirInterface *reservoir) {
+    std::string const &partial_query = query.PsqlQuery();
     std::string select_query =
-        CompleteSelectQuery<EntityType, Others...>(query.PsqlQuery(), entity_aliases);
+        partial_query.substr(0, query.WithClauseLength()) +
+        CompleteSelectQuery<EntityType, Others...>(
+            partial_query.substr(query.WithClauseLength()), entity_aliases);
 
     ConnectionInterface *conn = reservoir->Take();
     std::unique_ptr<ResultSetInterface> rs = conn->RunQuery(select_query, query.QueryParams());
@@ -81,6 +104,43 @@ Query(SqlQueryBuilder const &query, std::initializer_list<std::string> const &en
     return results;
 }
 
+/**
+ * @brief GroupedQuery Similar to the Query() function above, but it collapses the one-to-many
+ * records into groups. See ToGroupedEntityTuples() for how records are grouped. It lets a query
+ * fetch the parent entities along with their nullable child entities in one round trip.
+ *
+ * Example usage:
+ * std::vector<std::pair<std::tuple<User>, std::vector<std::tuple<CreditCard>>>> results =
+ * GroupedQuery<std::tuple<User>, std::tuple<CreditCard>>(query, {"auser", "card"}, reservoir);
+ *
+ * @param query Partial query where the select list is unspecified. The records of a group must be
+ * adjacent, usually by ordering on the group's primary key.
+ * @param entity_aliases A list of aliases corresponding to the group entities followed by the
+ * element entities.
+ * @param reservoir Connection reservoir to allocate database connections.
+ * @return A list of (group tuple, element tuples) pairs.
+ */
+template <typename GroupTuple, typename ElementTuple>
+std::vector<std::pair<GroupTuple, std::vector<ElementTuple>>>
+GroupedQuery(SqlQueryBuilder const &query, std::initializer_list<std::string> const &entity_aliases,
+             ConnectionReservoirInterface *reservoir) {
+    std::string const &partial_query = query.PsqlQuery();
+    std::string select_query =
+        partial_query.substr(0, query.WithClauseLength()) +
+        sql_runner_internal::GroupedSelectQuery<GroupTuple, ElementTuple>::Complete(
+            partial_query.substr(query.WithClauseLength()), entity_aliases);
+
+    ConnectionInterface *conn = reservoir->Take();
+    std::unique_ptr<ResultSetInterface> rs = conn->RunQuery(select_query, query.QueryParams());
+
+    std::vector<std::pair<GroupTuple, std::vector<ElementTuple>>> results =
+        ToGroupedEntityTuples<GroupTuple, ElementTuple>(rs.get());
+
+    reservoir->Put(conn);
+
+    return results;
+}
+
 /**
  * @brief Search Similar to the Query() function above, it constructs a full text search query with
  * partial information defining the collection of records to search from and synchronously returns
@@ -142,6 +202,17 @@ Search(SqlQueryBuilder const &query, std::initializer_list<std::string> const &e
 uint64_t Update(SqlEntityInterface const &entity, std::string const &table_name, bool replace,
                 ConnectionReservoirInterface *reservoir);
 
+/**
+ * @brief UpdateBatch Similar to the Update() function above, but it saves all the entities, which
+ * must be of the same type, through multi-row insertions on one connection. The entities are sent
+ * in as few statements as postgres' limit on the number of query parameters allows.
+ *
+ * @return The number of SQL rows affected by this update.
+ */
+uint64_t UpdateBatch(std::vector<SqlEntityInterface const *> const &entities,
+                     std::string const &table_name, bool replace,
+                     ConnectionReservoirInterface *reservoir);
+
 /**
  * @brief Delete Runs a deletion SQL query on the specified table.
  *
@@ -163,6 +234,16 @@ uint64_t Delete(std::string const &table_name, SqlQueryBuilder const &query,
  */
 bool Exists(SqlQueryBuilder const &query, ConnectionReservoirInterface *reservoir);
 
+/**
+ * @brief Count Counts the number of records the query returns.
+ *
+ * @param query The query is a partial SQL query where the SELECT ... FROM part is omitted. Example:
+ * Candidates candids WHERE candids.duration > [placeholder].
+ * @param reservoir Connection reservoir to allocate database connections.
+ * @return The number of records.
+ */
+uint64_t Count(SqlQueryBuilder const &query, ConnectionReservoirInterface *reservoir);
+
 /**
  * @brief Tables Get the name of all tables in a database.
  *